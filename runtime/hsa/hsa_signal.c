@@ -366,36 +366,27 @@ hsa_signal_value_t HSA_API
                             uint64_t timeout_hint,
                             hsa_wait_state_t wait_state_hint)
 {
-	uint64_t signal_value;
-	while (1)
+	struct __attribute__ ((packed))
 	{
-		// Get signal value
-		signal_value = hsa_signal_load_relaxed(signal);
-		// printf("Signal value %lld\n", signal_value);
-
-		// Check if condition satisfies
-		if (condition == HSA_SIGNAL_CONDITION_EQ)
-		{
-			if (signal_value == compare_value)
-				break;
-		}
-		else if (condition == HSA_SIGNAL_CONDITION_NE)
-		{
-			if (signal_value != compare_value)
-				break;
-		}
-		else if (condition == HSA_SIGNAL_CONDITION_LT)
-		{
-			if (signal_value < compare_value)
-				break;
-		}
-		else if (condition == HSA_SIGNAL_CONDITION_GTE)
-		{
-			if (signal_value >= compare_value)
-				break;
-		}
-	}
-	return 0;
+		int64_t value;
+		uint64_t signal;
+		uint32_t condition;
+		int64_t compare_value;
+		uint64_t timeout_hint;
+		uint32_t wait_state_hint;
+	} data;
+	data.signal = signal.handle;
+	data.condition = condition;
+	data.compare_value = compare_value;
+	data.timeout_hint = timeout_hint;
+	data.wait_state_hint = wait_state_hint;
+
+	// Call driver function. The calling thread is suspended by the
+	// simulator until the condition is satisfied or the timeout expires.
+	ioctl(hsa_runtime->fd, SignalWaitAcquire, &data);
+
+	// Return value
+	return data.value;
 }
 
 
@@ -406,6 +397,24 @@ hsa_signal_value_t HSA_API
                             uint64_t timeout_hint,
                             hsa_wait_state_t wait_state_hint)
 {
-	__HSA_RUNTIME_NOT_IMPLEMENTED__
-	return 0;
+	struct __attribute__ ((packed))
+	{
+		int64_t value;
+		uint64_t signal;
+		uint32_t condition;
+		int64_t compare_value;
+		uint64_t timeout_hint;
+		uint32_t wait_state_hint;
+	} data;
+	data.signal = signal.handle;
+	data.condition = condition;
+	data.compare_value = compare_value;
+	data.timeout_hint = timeout_hint;
+	data.wait_state_hint = wait_state_hint;
+
+	// Call driver function
+	ioctl(hsa_runtime->fd, SignalWaitRelaxed, &data);
+
+	// Return value
+	return data.value;
 }
@@ -68,6 +68,7 @@ struct opencl_command_queue_t *opencl_command_queue_create(void)
 	/* Initialize */
 	command_queue = xcalloc(1, sizeof(struct opencl_command_queue_t));
 	command_queue->command_list = list_create();
+	command_queue->deferred_event_list = list_create();
 	pthread_mutex_init(&command_queue->lock, NULL);
 	pthread_cond_init(&command_queue->cond_process, NULL);
 
@@ -95,6 +96,10 @@ void opencl_command_queue_free(struct opencl_command_queue_t *command_queue)
 	pthread_join(command_queue->queue_thread, NULL);
 	assert(!command_queue->command_list->count);
 
+	/* Wait for commands still completing */
+	opencl_command_queue_wait_deferred(command_queue);
+	list_free(command_queue->deferred_event_list);
+
 	pthread_mutex_destroy(&command_queue->lock);
 	pthread_cond_destroy(&command_queue->cond_process);
 
@@ -130,6 +135,43 @@ void opencl_command_queue_flush(struct opencl_command_queue_t *command_queue)
 }
 
 
+void opencl_command_queue_defer(struct opencl_command_queue_t *command_queue,
+		struct opencl_event_t *event)
+{
+	/* The list keeps a reference to the event */
+	if (clRetainEvent(event) != CL_SUCCESS)
+		fatal("%s: clRetainEvent failed on deferred event",
+				__FUNCTION__);
+
+	pthread_mutex_lock(&command_queue->lock);
+	list_add(command_queue->deferred_event_list, event);
+	pthread_mutex_unlock(&command_queue->lock);
+}
+
+
+void opencl_command_queue_wait_deferred(
+		struct opencl_command_queue_t *command_queue)
+{
+	struct opencl_event_t *event;
+
+	for (;;)
+	{
+		/* Get next deferred event */
+		pthread_mutex_lock(&command_queue->lock);
+		event = list_remove_at(command_queue->deferred_event_list, 0);
+		pthread_mutex_unlock(&command_queue->lock);
+		if (!event)
+			break;
+
+		/* Wait for it */
+		opencl_event_wait(event);
+		if (clReleaseEvent(event) != CL_SUCCESS)
+			fatal("%s: clReleaseEvent failed on deferred event",
+					__FUNCTION__);
+	}
+}
+
+
 struct opencl_command_t *
 opencl_command_queue_dequeue(struct opencl_command_queue_t *command_queue)
 {
@@ -42,6 +42,10 @@ struct opencl_command_queue_t
 	pthread_cond_t cond_process;
 
 	volatile int process;
+
+	/* Events of commands that returned before completing, waited for
+	 * in 'clFinish'. Elements are of type 'opencl_event_t'. */
+	struct list_t *deferred_event_list;
 };
 
 
@@ -55,5 +59,10 @@ struct opencl_command_t *opencl_command_queue_dequeue(
 		struct opencl_command_queue_t *command_queue);
 void opencl_command_queue_flush(struct opencl_command_queue_t *command_queue);
 
+void opencl_command_queue_defer(struct opencl_command_queue_t *command_queue,
+		struct opencl_event_t *event);
+void opencl_command_queue_wait_deferred(
+		struct opencl_command_queue_t *command_queue);
+
 
 #endif
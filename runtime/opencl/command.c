@@ -380,6 +380,13 @@ struct opencl_command_t *opencl_command_create_ndrange(
 		device, kernel, work_dim, global_work_offset,
 		global_work_size, local_work_size);
 
+	/* ND-Ranges always have a completion event, even if not requested by
+	 * the application, so that the device can complete them
+	 * asynchronously and let the command queue move on. */
+	if (!command->done_event)
+		command->done_event = opencl_event_create(command_queue,
+				opencl_command_launch_ndrange);
+
 	/* Return */
 	return command;
 }
@@ -418,6 +425,13 @@ void opencl_command_run(struct opencl_command_t *command)
 	}
 	if (command->func)
 		command->func(command);
+	if (command->done_event && command->done_event->deferred)
+	{
+		/* Completed later by the device */
+		opencl_command_queue_defer(command->command_queue,
+				command->done_event);
+		return;
+	}
 	if (command->done_event)
 	{
 		opencl_event_set_status(command->done_event, CL_COMPLETE);
@@ -404,6 +404,9 @@ cl_int clFinish(
 	opencl_command_queue_enqueue(command_queue, command);
 	opencl_event_wait(event);
 
+	/* Wait for commands that completed asynchronously */
+	opencl_command_queue_wait_deferred(command_queue);
+
 	/* Free event and return */
 	clReleaseEvent(event);
 	return CL_SUCCESS;	
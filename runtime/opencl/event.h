@@ -39,6 +39,12 @@ struct opencl_event_t
 	cl_ulong time_submit;
 	cl_ulong time_start;
 	cl_ulong time_end;
+
+	/* Set by an architecture-specific ND-Range launch that completes
+	 * asynchronously. The command queue then does not complete the event
+	 * when the command returns, and the event is added to the list of
+	 * deferred events of the command queue. */
+	int deferred;
 };
 
 
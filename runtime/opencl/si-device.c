@@ -17,12 +17,15 @@
  *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <assert.h>
 #include <fcntl.h>
 #include <limits.h>
 #include <sys/ioctl.h>
+#include <time.h>
 
 #include "debug.h"
 #include "device.h"
+#include "event.h"
 #include "list.h"
 #include "mhandle.h"
 #include "x86-device.h"
@@ -30,6 +33,55 @@
 #include "si-kernel.h"
 #include "si-program.h"
 
+static void *opencl_si_device_retire_thread_func(void *user_data)
+{
+	struct opencl_si_device_t *device = user_data;
+	struct opencl_si_ndrange_t *ndrange;
+	struct opencl_event_t *event;
+	struct timespec end;
+
+	cl_ulong cltime;
+
+	for (;;)
+	{
+		/* Wait for a pending ND-Range */
+		pthread_mutex_lock(&device->lock);
+		while (!device->pending_list->count &&
+				!device->retire_thread_exit)
+			pthread_cond_wait(&device->cond_pending, &device->lock);
+		ndrange = list_remove_at(device->pending_list, 0);
+		pthread_mutex_unlock(&device->lock);
+		if (!ndrange)
+			break;
+
+		/* Wait for the driver to complete it. ND-Ranges are retired in
+		 * order of launch, which does not prevent out-of-order queues
+		 * from running them concurrently on the device. */
+		opencl_si_device_wait(device, ndrange->packet_index);
+		opencl_debug("[%s] nd-range %d retired", __FUNCTION__,
+				ndrange->id);
+
+		/* Complete event */
+		event = ndrange->event;
+		clock_gettime(CLOCK_MONOTONIC, &end);
+		cltime = (cl_ulong)end.tv_sec;
+		cltime *= 1000000000;
+		cltime += (cl_ulong)end.tv_nsec;
+		event->time_end = cltime;
+		opencl_event_set_status(event, CL_COMPLETE);
+		if (clReleaseEvent(event) != CL_SUCCESS)
+			fatal("%s: clReleaseEvent failed on nd-range event",
+					__FUNCTION__);
+
+		/* The driver already freed its ND-Range */
+		free(ndrange);
+	}
+
+	/* End */
+	return NULL;
+}
+
+
 struct opencl_si_device_t *opencl_si_device_create(struct opencl_device_t *parent)
 {
 	struct opencl_si_device_t *device;
@@ -205,6 +257,15 @@ struct opencl_si_device_t *opencl_si_device_create(struct opencl_device_t *paren
 			"Multi2Sim OpenCL driver version and the version of the simulator.\n"
 			"Please download the latest versions and retry.");
 
+	/* Create command queue shared with the driver */
+	device->ring = xcalloc(1, sizeof(struct opencl_si_ring_t));
+	device->ring->num_packets = OPENCL_SI_RING_SIZE;
+	unsigned args[2] = {(unsigned) device->ring, OPENCL_SI_RING_SIZE};
+	device->ring_id = ioctl(parent->fd, SICommandQueueCreate, args);
+	pthread_mutex_init(&device->lock, NULL);
+	pthread_cond_init(&device->cond_pending, NULL);
+	device->pending_list = list_create();
+
 	/* Return */
 	return device;
 }
@@ -212,10 +273,92 @@ struct opencl_si_device_t *opencl_si_device_create(struct opencl_device_t *paren
 
 void opencl_si_device_free(struct opencl_si_device_t *device)
 {
+	/* Retire pending ND-Ranges */
+	if (device->retire_thread_started)
+	{
+		pthread_mutex_lock(&device->lock);
+		device->retire_thread_exit = 1;
+		pthread_cond_signal(&device->cond_pending);
+		pthread_mutex_unlock(&device->lock);
+		pthread_join(device->retire_thread, NULL);
+	}
+	assert(!device->pending_list->count);
+
+	/* Free command queue */
+	unsigned args[1] = {device->ring_id};
+	ioctl(device->parent->fd, SICommandQueueFree, args);
+	list_free(device->pending_list);
+	pthread_cond_destroy(&device->cond_pending);
+	pthread_mutex_destroy(&device->lock);
+	free(device->ring);
+
 	free(device);
 }
 
 
+unsigned int opencl_si_device_post(struct opencl_si_device_t *device,
+		enum opencl_si_packet_type_t type, unsigned int flags,
+		unsigned int arg0, unsigned int arg1, unsigned int arg2)
+{
+	struct opencl_si_ring_t *ring = device->ring;
+	struct opencl_si_packet_t *packet;
+	unsigned int index;
+
+	pthread_mutex_lock(&device->lock);
+
+	/* Wait for a free slot. The oldest packet must have completed before
+	 * its slot is reused. */
+	index = ring->write_index;
+	if (index - ring->read_index >= ring->num_packets)
+		opencl_si_device_wait(device, index - ring->num_packets);
+
+	/* Fill packet */
+	packet = &ring->packets[index % ring->num_packets];
+	packet->type = type;
+	packet->flags = flags;
+	packet->args[0] = arg0;
+	packet->args[1] = arg1;
+	packet->args[2] = arg2;
+	packet->args[3] = 0;
+	packet->completion_ptr = 0;
+
+	/* Publish it */
+	ring->write_index = index + 1;
+	pthread_mutex_unlock(&device->lock);
+
+	/* Return packet index */
+	return index;
+}
+
+
+void opencl_si_device_wait(struct opencl_si_device_t *device,
+		unsigned int index)
+{
+	unsigned args[2] = {device->ring_id, index};
+	ioctl(device->parent->fd, SICommandQueueWait, args);
+}
+
+
+void opencl_si_device_defer(struct opencl_si_device_t *device,
+		struct opencl_si_ndrange_t *ndrange)
+{
+	pthread_mutex_lock(&device->lock);
+
+	/* Start retire thread the first time */
+	if (!device->retire_thread_started)
+	{
+		pthread_create(&device->retire_thread, NULL,
+			opencl_si_device_retire_thread_func, device);
+		device->retire_thread_started = 1;
+	}
+
+	/* Add ND-Range to pending list */
+	list_add(device->pending_list, ndrange);
+	pthread_cond_signal(&device->cond_pending);
+	pthread_mutex_unlock(&device->lock);
+}
+
+
 void *opencl_si_device_mem_alloc(struct opencl_si_device_t *device,
 		unsigned int size)
 {
@@ -240,25 +383,40 @@ void opencl_si_device_mem_free(struct opencl_si_device_t *device,
 void opencl_si_device_mem_read(struct opencl_si_device_t *device,
 		void *host_ptr, void *device_ptr, unsigned int size)
 {
-	unsigned args[3] = {(unsigned) host_ptr, (unsigned) device_ptr, size};
-	/* Invoke 'mem_read' ABI call */
-	ioctl(device->parent->fd, SIMemRead, args);
+	unsigned int index;
+
+	/* Post packet after all previous ones and wait for it, since the
+	 * host buffer is only valid during the call. */
+	index = opencl_si_device_post(device, opencl_si_packet_mem_read,
+			OPENCL_SI_PACKET_FLAG_BARRIER, (unsigned) host_ptr,
+			(unsigned) device_ptr, size);
+	opencl_si_device_wait(device, index);
 }
 
 
 void opencl_si_device_mem_write(struct opencl_si_device_t *device,
 		void *device_ptr, void *host_ptr, unsigned int size)
 {
-	/* Invoke 'mem_write' ABI call */
-	unsigned args[3] = {(unsigned) device_ptr, (unsigned) host_ptr, size};
-	ioctl(device->parent->fd, SIMemWrite, args);
+	unsigned int index;
+
+	/* Post packet after all previous ones and wait for it */
+	index = opencl_si_device_post(device, opencl_si_packet_mem_write,
+			OPENCL_SI_PACKET_FLAG_BARRIER, (unsigned) device_ptr,
+			(unsigned) host_ptr, size);
+	opencl_si_device_wait(device, index);
 }
 
 
 void opencl_si_device_mem_copy(struct opencl_si_device_t *device,
 		void *device_dest_ptr, void *device_src_ptr, unsigned int size)
 {
-	fatal("%s: not implemented", __FUNCTION__);
+	unsigned int index;
+
+	/* Post packet after all previous ones and wait for it */
+	index = opencl_si_device_post(device, opencl_si_packet_mem_copy,
+			OPENCL_SI_PACKET_FLAG_BARRIER, (unsigned) device_dest_ptr,
+			(unsigned) device_src_ptr, size);
+	opencl_si_device_wait(device, index);
 }
 
 int opencl_si_device_preferred_workgroups(struct opencl_si_device_t *device)
@@ -23,6 +23,48 @@
 #include "opencl.h"
 
 
+/* Forward declarations */
+struct opencl_si_ndrange_t;
+
+/* Packet types and flags of the command queue shared with the driver. The
+ * layout of the ring must match class 'SI::CommandQueue' in
+ * 'src/arch/southern-islands/driver/CommandQueue.h'. */
+enum opencl_si_packet_type_t
+{
+	opencl_si_packet_invalid = 0,
+	opencl_si_packet_mem_write,
+	opencl_si_packet_mem_read,
+	opencl_si_packet_mem_copy,
+	opencl_si_packet_ndrange_launch
+};
+
+#define OPENCL_SI_PACKET_FLAG_BARRIER  1
+
+/* Number of packets in the ring */
+#define OPENCL_SI_RING_SIZE  64
+
+struct opencl_si_packet_t
+{
+	unsigned int type;  /* Of type 'enum opencl_si_packet_type_t' */
+	unsigned int flags;
+	unsigned int args[4];
+	unsigned int completion_ptr;
+	unsigned int reserved;
+};
+
+struct opencl_si_ring_t
+{
+	/* Header. The write index is advanced by the runtime, and the read
+	 * index by the driver. */
+	volatile unsigned int write_index;
+	volatile unsigned int read_index;
+	unsigned int num_packets;
+	unsigned int reserved;
+
+	struct opencl_si_packet_t packets[OPENCL_SI_RING_SIZE];
+};
+
+
 struct opencl_si_device_t
 {
 	/* Object type. NOTE: must be first field */
@@ -30,6 +72,23 @@ struct opencl_si_device_t
 
 	/* Parent generic device object */
 	struct opencl_device_t *parent;
+
+	/* Command queue shared with the driver, and its ID in the driver */
+	struct opencl_si_ring_t *ring;
+	int ring_id;
+
+	/* Lock protecting the ring and the list of pending ND-Ranges */
+	pthread_mutex_t lock;
+	pthread_cond_t cond_pending;
+
+	/* ND-Ranges launched asynchronously and not retired yet. Elements are
+	 * of type 'struct opencl_si_ndrange_t'. */
+	struct list_t *pending_list;
+
+	/* Thread retiring pending ND-Ranges */
+	pthread_t retire_thread;
+	int retire_thread_started;
+	int retire_thread_exit;
 };
 
 
@@ -50,5 +109,13 @@ void opencl_si_device_mem_copy(struct opencl_si_device_t *device,
 		void *device_dest_ptr, void *device_src_ptr,
 		unsigned int size);
 
+unsigned int opencl_si_device_post(struct opencl_si_device_t *device,
+		enum opencl_si_packet_type_t type, unsigned int flags,
+		unsigned int arg0, unsigned int arg1, unsigned int arg2);
+void opencl_si_device_wait(struct opencl_si_device_t *device,
+		unsigned int index);
+void opencl_si_device_defer(struct opencl_si_device_t *device,
+		struct opencl_si_ndrange_t *ndrange);
+
 #endif
 
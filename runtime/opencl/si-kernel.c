@@ -20,6 +20,7 @@
 #include <assert.h>
 #include <sys/ioctl.h>
 
+#include "command-queue.h"
 #include "debug.h"
 #include "device.h"
 #include "elf-format.h"
@@ -31,6 +32,7 @@
 #include "misc.h"
 #include "object.h"
 #include "platform.h"
+#include "si-device.h"
 #include "si-kernel.h"
 #include "si-program.h"
 #include "string.h"
@@ -440,12 +442,16 @@ void opencl_si_ndrange_run_partial(struct opencl_si_ndrange_t *ndrange,
 void opencl_si_ndrange_run(struct opencl_si_ndrange_t *ndrange,
 	struct opencl_event_t *event)
 {
+	struct opencl_si_device_t *device = opencl_si_device->arch_device;
+	struct opencl_command_queue_t *command_queue;
 	struct sched_param sched_param_old;
 	struct sched_param sched_param_new;
-	struct timespec start, end;
+	struct timespec start;
 
 	cl_ulong cltime;
 
+	unsigned int flags;
+
 	int sched_policy_new;
 	int sched_policy_old;
 
@@ -460,43 +466,51 @@ void opencl_si_ndrange_run(struct opencl_si_ndrange_t *ndrange,
 	pthread_setschedparam(pthread_self(), sched_policy_new, 
 		&sched_param_new);
 
-	ioctl(opencl_si_device->fd, SINDRangeStart);
-
 	/* Record start time */
 	if (event)
 	{
 		clock_gettime(CLOCK_MONOTONIC, &start);
 	}
 
-	/* Run all of the work groups */
-	opencl_si_ndrange_run_partial(ndrange, 0, ndrange->total_num_groups);
-
-	/* Wait for the nd-range to complete and then flush the cache */
-	opencl_si_ndrange_finish(ndrange);
-
-	/* Record end time */
-	if (event)
-	{
-		clock_gettime(CLOCK_MONOTONIC, &end);
-		
-		ioctl(opencl_si_device->fd, SINDRangeEnd);
-
-		cltime = (cl_ulong)start.tv_sec;
-		cltime *= 1000000000;
-		cltime += (cl_ulong)start.tv_nsec;
-		event->time_start = cltime;
-
-		cltime = (cl_ulong)end.tv_sec;
-		cltime *= 1000000000;
-		cltime += (cl_ulong)end.tv_nsec;
-		event->time_end = cltime;
-	}
+	/* Launch all of the work groups through the command queue shared
+	 * with the driver. The launch waits for all previous packets, unless
+	 * the command comes from an out-of-order queue. */
+	flags = OPENCL_SI_PACKET_FLAG_BARRIER;
+	command_queue = event ? event->command_queue : NULL;
+	if (command_queue && (command_queue->properties &
+			CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE))
+		flags = 0;
+	ndrange->packet_index = opencl_si_device_post(device,
+		opencl_si_packet_ndrange_launch, flags, ndrange->id, 0, 0);
+	opencl_debug("[%s] nd-range %d launched at %llu", __FUNCTION__,
+			ndrange->id, opencl_get_time());
 
 	/* Reset old scheduling parameters */
 	pthread_setschedparam(pthread_self(), sched_policy_old, 
 		&sched_param_old);
 
-	/* Free the nd-range */
-	opencl_si_ndrange_free(ndrange);
+	/* Without an event, wait for the nd-range to complete. The driver
+	 * frees its nd-range when it completes. */
+	if (!event)
+	{
+		opencl_si_device_wait(device, ndrange->packet_index);
+		free(ndrange);
+		return;
+	}
+
+	/* Record start time */
+	cltime = (cl_ulong)start.tv_sec;
+	cltime *= 1000000000;
+	cltime += (cl_ulong)start.tv_nsec;
+	event->time_start = cltime;
+
+	/* Let the device retire the nd-range and complete the event later,
+	 * so that the command queue can move on to the next command. */
+	if (clRetainEvent(event) != CL_SUCCESS)
+		fatal("%s: clRetainEvent failed on nd-range event",
+				__FUNCTION__);
+	ndrange->event = event;
+	event->deferred = 1;
+	opencl_si_device_defer(device, ndrange);
 }
 
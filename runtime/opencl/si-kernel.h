@@ -116,6 +116,12 @@ struct opencl_si_ndrange_t
 
 	void *table_ptr;
 	void *cb_ptr;
+
+	/* Asynchronous launch. Index of the launch packet in the command
+	 * queue shared with the driver, and event completed when the
+	 * ND-Range is retired. */
+	unsigned int packet_index;
+	struct opencl_event_t *event;
 };
 
 /* Kernel callbacks */
@@ -807,6 +807,25 @@ unsigned AsmService::getSizeInByteByRegisterName(const std::string &name)
 }
 
 
+unsigned AsmService::getSizeInByteByRegisterKind(BrigRegisterKind kind)
+{
+	switch (kind)
+	{
+	case BRIG_REGISTER_KIND_CONTROL:
+		return 1;
+	case BRIG_REGISTER_KIND_SINGLE:
+		return 4;
+	case BRIG_REGISTER_KIND_DOUBLE:
+		return 8;
+	case BRIG_REGISTER_KIND_QUAD:
+		return 16;
+	default:
+		throw misc::Panic(misc::fmt("Unknown register kind %d\n",
+				kind));
+	}
+}
+
+
 void AsmService::DumpUnderscore(const std::string &string, 
 		std::ostream &os = std::cout)
 {
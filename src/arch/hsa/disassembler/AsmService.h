@@ -197,6 +197,9 @@ public:
 	/// Get register size in bytes by its name
 	static unsigned getSizeInByteByRegisterName(const std::string &name);
 
+	/// Get register size in bytes by its kind
+	static unsigned getSizeInByteByRegisterKind(BrigRegisterKind kind);
+
 
 
 
@@ -879,7 +879,25 @@ int Driver::CallSignalWaitRelaxed(comm::Context *context,
 		mem::Memory *memory,
 		unsigned args_ptr)
 {
-	__UNIMPLEMENTED__
+	struct __attribute__ ((packed))
+	{
+		int64_t value;
+		uint64_t signal;
+		uint32_t condition;
+		int64_t compare_value;
+		uint64_t timeout_hint;
+		uint32_t wait_state_hint;
+	} data;
+
+	// Retrieve data
+	memory->Read(args_ptr, sizeof(data), (char *)&data);
+
+	// Wait on the signal, suspending the context if needed. The signal
+	// value is returned in the first field of the arguments. The wait
+	// state hint is ignored, since the context never spins.
+	signal_manager->Wait(context, memory, args_ptr, data.signal,
+			data.condition, data.compare_value,
+			data.timeout_hint);
 	return 0;
 }
 
@@ -888,8 +906,8 @@ int Driver::CallSignalWaitAcquire(comm::Context *context,
 		mem::Memory *memory,
 		unsigned args_ptr)
 {
-	__UNIMPLEMENTED__
-	return 0;
+	// Memory is sequentially consistent in the emulator
+	return CallSignalWaitRelaxed(context, memory, args_ptr);
 }
 
 
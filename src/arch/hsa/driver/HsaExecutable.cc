@@ -17,6 +17,8 @@
  *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <vector>
+
 #include <lib/cpp/Misc.h>
 #include <lib/cpp/String.h>
 #include <lib/cpp/Error.h>
@@ -108,22 +110,52 @@ void HsaExecutable::preprocessRegisters(
 			continue;
 		}
 
-		// Traverse each operands of an instruction
+		// Traverse each operands of an instruction. Registers are also
+		// referenced by address operands and operand lists.
 		for (unsigned int j = 0; j < entry->getOperandCount(); j++)
 		{
 			auto operand = entry->getOperand(j);
 			if (!operand.get()) break;
 
-			// operand->Dump(entry->getOperandType(j), std::cout);
-			if (operand->getKind() != BRIG_KIND_OPERAND_REGISTER)
-				continue;
+			// Collect register operands
+			std::vector<std::unique_ptr<BrigOperandEntry>> registers;
+			switch (operand->getKind())
+			{
+			case BRIG_KIND_OPERAND_REGISTER:
+				registers.push_back(std::move(operand));
+				break;
 
-			BrigRegisterKind kind = operand->getRegKind();
-			unsigned short number = operand->getRegNumber() + 1;
-			if (number > max_reg[kind])
+			case BRIG_KIND_OPERAND_ADDRESS:
 			{
-				max_reg[kind] = number;
+				auto reg = operand->getReg();
+				if (reg.get())
+					registers.push_back(std::move(reg));
+				break;
+			}
 
+			case BRIG_KIND_OPERAND_OPERAND_LIST:
+				for (unsigned k = 0; k < operand->getElementCount();
+						k++)
+				{
+					auto element = operand->getOperandElement(k);
+					if (element->getKind() ==
+							BRIG_KIND_OPERAND_REGISTER)
+						registers.push_back(
+								std::move(element));
+				}
+				break;
+
+			default:
+				break;
+			}
+
+			// Record the maximum register number of each kind
+			for (auto &reg : registers)
+			{
+				BrigRegisterKind kind = reg->getRegKind();
+				unsigned short number = reg->getRegNumber() + 1;
+				if (number > max_reg[kind])
+					max_reg[kind] = number;
 			}
 		}
 
@@ -202,6 +234,9 @@ void HsaExecutable::parseFunction(BrigFile *file,
 	function->setFirstEntry(std::move(first_entry));
 	function->setFunctionDirective(std::move(entry));
 
+	// Lower function body
+	function->Lower();
+
 	if (Emulator::loader_debug)
 		function->Dump(Emulator::loader_debug);
 
@@ -17,9 +17,16 @@
  *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <ctime>
+
+#include <arch/x86/emulator/Context.h>
+#include <arch/x86/emulator/Emulator.h>
 #include <lib/cpp/String.h>
 #include <lib/cpp/Error.h>
+#include <memory/Memory.h>
 
+#include "../../../../runtime/include/hsa.h"
+#include "Driver.h"
 #include "SignalManager.h"
 
 namespace HSA
@@ -52,6 +59,19 @@ uint64_t SignalManager::CreateSignal(int64_t initial_value)
 
 void SignalManager::DestorySignal(uint64_t handler)
 {
+	// Release contexts waiting on the signal
+	for (auto it = waiters.begin(); it != waiters.end(); )
+	{
+		if (it->handler != handler)
+		{
+			++it;
+			continue;
+		}
+		Wakeup(*it);
+		it = waiters.erase(it);
+	}
+
+	// Destroy signal
 	signals.erase(handler);
 }
 
@@ -59,6 +79,134 @@ void SignalManager::DestorySignal(uint64_t handler)
 void SignalManager::ChangeValue(uint64_t handler, int64_t value)
 {
 	signals[handler]->setValue(value);
+	WakeupWaiters(handler);
+}
+
+
+bool SignalManager::isConditionSatisfied(int64_t value, int condition,
+		int64_t compare_value)
+{
+	switch (condition)
+	{
+	case HSA_SIGNAL_CONDITION_EQ:
+		return value == compare_value;
+	case HSA_SIGNAL_CONDITION_NE:
+		return value != compare_value;
+	case HSA_SIGNAL_CONDITION_LT:
+		return value < compare_value;
+	case HSA_SIGNAL_CONDITION_GTE:
+		return value >= compare_value;
+	default:
+		throw misc::Panic(misc::fmt("Invalid signal condition (%d)",
+				condition));
+	}
+}
+
+
+void SignalManager::Wakeup(const Waiter &waiter)
+{
+	// Waiter no longer accounts for a deadline
+	if (waiter.deadline)
+		num_deadlines--;
+
+	// Look up context. It may have been killed while it was waiting.
+	x86::Context *context = x86::Emulator::getInstance()->getContext(
+			waiter.pid);
+	if (!context || !context->isSuspended())
+	{
+		Driver::debug << misc::fmt("	context %d waiting on signal "
+				"%lld no longer suspended\n", waiter.pid,
+				(long long) waiter.handler);
+		return;
+	}
+
+	// Return current value of the signal
+	auto it = signals.find(waiter.handler);
+	int64_t value = it == signals.end() ? 0 : it->second->getValue();
+	context->getMemory()->Write(waiter.value_ptr, sizeof(value),
+			(char *) &value);
+
+	// Resume context
+	Driver::debug << misc::fmt("	context %d woken up from wait on "
+			"signal %lld (value %lld)\n", waiter.pid,
+			(long long) waiter.handler, (long long) value);
+	context->Wakeup();
+}
+
+
+void SignalManager::WakeupWaiters(uint64_t handler)
+{
+	int64_t value = signals[handler]->getValue();
+	for (auto it = waiters.begin(); it != waiters.end(); )
+	{
+		if (it->handler != handler || !isConditionSatisfied(value,
+				it->condition, it->compare_value))
+		{
+			++it;
+			continue;
+		}
+		Wakeup(*it);
+		it = waiters.erase(it);
+	}
+}
+
+
+void SignalManager::Wait(comm::Context *context, mem::Memory *memory,
+		unsigned value_ptr, uint64_t handler, int condition,
+		int64_t compare_value, uint64_t timeout_hint)
+{
+	// Check signal
+	if (!isValidSignalHandler(handler))
+		throw misc::Error(misc::fmt("Invalid signal handler (%lld)",
+				(long long) handler));
+
+	// Return right away if the condition is satisfied or the timeout is
+	// zero
+	int64_t value = signals[handler]->getValue();
+	if (isConditionSatisfied(value, condition, compare_value) ||
+			!timeout_hint)
+	{
+		memory->Write(value_ptr, sizeof(value), (char *) &value);
+		return;
+	}
+
+	// Compute deadline in units of the system timestamp
+	uint64_t deadline = 0;
+	if (timeout_hint != UINT64_MAX)
+	{
+		uint64_t now = time(nullptr);
+		deadline = timeout_hint > UINT64_MAX - now ?
+				UINT64_MAX : now + timeout_hint;
+		num_deadlines++;
+	}
+
+	// Suspend context
+	Driver::debug << misc::fmt("	context %d suspended waiting on "
+			"signal %lld\n", context->getId(), (long long) handler);
+	context->Suspend();
+	waiters.push_back({context->getId(), value_ptr, handler, condition,
+			compare_value, deadline});
+}
+
+
+void SignalManager::ProcessTimeouts()
+{
+	// Nothing to do if no wait has a timeout
+	if (!num_deadlines)
+		return;
+
+	// Wake up contexts whose deadline expired
+	uint64_t now = time(nullptr);
+	for (auto it = waiters.begin(); it != waiters.end(); )
+	{
+		if (!it->deadline || it->deadline > now)
+		{
+			++it;
+			continue;
+		}
+		Wakeup(*it);
+		it = waiters.erase(it);
+	}
 }
 
 
@@ -20,11 +20,23 @@
 #ifndef ARCH_HSA_DRIVER_SIGNALMANAGER_H
 #define ARCH_HSA_DRIVER_SIGNALMANAGER_H
 
+#include <list>
 #include <memory>
 #include <unordered_map>
 
 #include "Signal.h"
 
+
+namespace comm
+{
+class Context;
+}
+
+namespace mem
+{
+class Memory;
+}
+
 namespace HSA
 {
 
@@ -40,6 +52,49 @@ private:
 	// The handler to allocate next
 	uint64_t handler_to_allocate = 0;
 
+	// Guest context suspended until a signal satisfies a condition
+	struct Waiter
+	{
+		// Identifier of the suspended x86 context. The context is
+		// looked up when it is woken up, since it may have been
+		// destroyed in the meantime.
+		int pid;
+
+		// Address in the memory of the context where the value of the
+		// signal is returned when the context wakes up
+		unsigned value_ptr;
+
+		// Signal handler
+		uint64_t handler;
+
+		// Condition, as a value of type hsa_signal_condition_t, and
+		// value to compare the signal with
+		int condition;
+		int64_t compare_value;
+
+		// Host timestamp at which the context is woken up even if the
+		// condition is not satisfied, or 0 for no timeout
+		uint64_t deadline;
+	};
+
+	// Contexts suspended waiting on signals
+	std::list<Waiter> waiters;
+
+	// Number of waiters with a deadline
+	int num_deadlines = 0;
+
+	// Return whether a signal value satisfies a wait condition
+	static bool isConditionSatisfied(int64_t value, int condition,
+			int64_t compare_value);
+
+	// Return the value of the signal to the context and wake it up. The
+	// waiter is ignored if its context no longer exists or is no longer
+	// suspended.
+	void Wakeup(const Waiter &waiter);
+
+	// Wake up contexts waiting on a signal whose condition is satisfied
+	void WakeupWaiters(uint64_t handler);
+
 public:
 
 	/// Constructor
@@ -66,6 +121,45 @@ public:
 
 	/// Get the value of a signal
 	int64_t GetValue(uint64_t handler);
+
+	/// Wait until the value of a signal satisfies a condition. If the
+	/// condition is not satisfied right away, the guest context is
+	/// suspended, and woken up as soon as the value of the signal changes
+	/// to satisfy it, or when the timeout expires.
+	///
+	/// \param context
+	///	Guest context invoking the wait. Only its identifier is
+	///	recorded, and the x86 context with that identifier is woken up.
+	///
+	/// \param memory
+	///	Memory of the guest context.
+	///
+	/// \param value_ptr
+	///	Address in guest memory where the 64-bit value of the signal is
+	///	written when the wait completes.
+	///
+	/// \param handler
+	///	Signal handler.
+	///
+	/// \param condition
+	///	Condition, as a value of type hsa_signal_condition_t.
+	///
+	/// \param compare_value
+	///	Value to compare the signal with.
+	///
+	/// \param timeout_hint
+	///	Maximum time to wait, in units of the system timestamp, or
+	///	UINT64_MAX to wait with no timeout.
+	void Wait(comm::Context *context, mem::Memory *memory,
+			unsigned value_ptr, uint64_t handler, int condition,
+			int64_t compare_value, uint64_t timeout_hint);
+
+	/// Wake up contexts whose wait timed out. This function is invoked
+	/// periodically by the emulator.
+	void ProcessTimeouts();
+
+	/// Return the number of contexts waiting on signals
+	int getNumWaiters() const { return waiters.size(); }
 };
 
 }
@@ -40,21 +40,10 @@ BrInstructionWorker::~BrInstructionWorker()
 
 void BrInstructionWorker::Execute(BrigCodeEntry *instruction)
 {
-	// Retrieve 1st operand
-	auto operand0 = instruction->getOperand(0);
-	if (operand0->getKind() == BRIG_KIND_OPERAND_CODE_REF)
-	{
-		auto label = operand0->getRef();
-
-		// Redirect pc to a certain label
-		stack_frame->setPc(std::move(label));
-		return;
-	}else{
-		throw misc::Panic("Unsupported operand type for CBR.");
-	}
-
-	// Move PC forward
-	work_item->MovePcForwardByOne();
+	// Redirect pc to the label, resolved when the function was lowered
+	Function *function = stack_frame->getFunction();
+	stack_frame->setPc(function->getBranchTarget(
+			stack_frame->getPcIndex()));
 }
 
 }  // namespace HSA
@@ -50,20 +50,14 @@ void CbrInstructionWorker::Execute(BrigCodeEntry *instruction)
 	unsigned char condition;
 	operand_value_retriever->Retrieve(instruction, 0, &condition);
 
-	// Jump if condition is true
-	if (condition){
-		// Retrieve 1st operand
-		auto operand1 = instruction->getOperand(1);
-		if (operand1->getKind() == BRIG_KIND_OPERAND_CODE_REF)
-		{
-			auto label = operand1->getRef();
-
-			// Redirect pc to a certain label
-			stack_frame->setPc(std::move(label));
-			return;
-		}else{
-			throw misc::Panic("Unsupported operand type for CBR.");
-		}
+	// Jump if condition is true, to the label resolved when the function
+	// was lowered
+	if (condition)
+	{
+		Function *function = stack_frame->getFunction();
+		stack_frame->setPc(function->getBranchTarget(
+				stack_frame->getPcIndex()));
+		return;
 	}
 
 	// Move PC forward
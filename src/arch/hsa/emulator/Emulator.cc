@@ -21,6 +21,7 @@
 
 #include <lib/cpp/Misc.h>
 #include <arch/hsa/disassembler/Disassembler.h>
+#include <arch/hsa/driver/Driver.h>
 
 #include "Emulator.h"
 #include "AQLQueue.h"
@@ -182,6 +183,9 @@ bool Emulator::Run()
 			active = true;
 	}
 
+	// Wake up contexts whose wait on a signal timed out
+	Driver::getInstance()->getSignalManager()->ProcessTimeouts();
+
 	// Process list of suspended contexts
 	// ProcessEvents();
 		
@@ -22,6 +22,7 @@
 #include <lib/cpp/String.h>
 #include <arch/hsa/disassembler/BrigCodeEntry.h>
 #include <arch/hsa/disassembler/BrigFile.h>
+#include <arch/hsa/disassembler/BrigImmed.h>
 #include <arch/hsa/disassembler/BrigOperandEntry.h>
 #include <arch/hsa/disassembler/AsmService.h>
 
@@ -60,6 +61,127 @@ std::unique_ptr<BrigCodeEntry> Function::getLastEntry() const
 }
 
 
+void Function::Lower()
+{
+	// Collect entries of the function body, recording the index of each
+	// entry given its offset in the code section
+	std::map<unsigned, unsigned> index_of_offset;
+	auto last_entry = getLastEntry();
+	auto entry = getFirstEntry();
+	while (entry.get() && last_entry.get() &&
+			entry->getOffset() <= last_entry->getOffset())
+	{
+		auto next_entry = entry->Next();
+		index_of_offset[entry->getOffset()] = code.size();
+		code.emplace_back();
+		code.back().entry = std::move(entry);
+		entry = std::move(next_entry);
+	}
+
+	// Decode operands and resolve branch targets
+	for (unsigned i = 0; i < code.size(); i++)
+	{
+		// Only instructions
+		LoweredInstruction &instruction = code[i];
+		BrigCodeEntry *inst = instruction.entry.get();
+		if (!inst->isInstruction())
+			continue;
+		LowerOperands(instruction);
+
+		// Only branches
+		unsigned label_index;
+		if (inst->getOpcode() == BRIG_OPCODE_BR)
+			label_index = 0;
+		else if (inst->getOpcode() == BRIG_OPCODE_CBR)
+			label_index = 1;
+		else
+			continue;
+
+		// Find the label
+		auto operand = inst->getOperand(label_index);
+		if (operand->getKind() != BRIG_KIND_OPERAND_CODE_REF)
+			continue;
+		auto label = operand->getRef();
+		auto it = index_of_offset.find(label->getOffset());
+		if (it == index_of_offset.end())
+			throw Error(misc::fmt("Label %s out of function %s",
+					label->getName().c_str(),
+					name.c_str()));
+		instruction.branch_target = it->second;
+	}
+}
+
+
+void Function::LowerOperands(LoweredInstruction &instruction) const
+{
+	BrigCodeEntry *inst = instruction.entry.get();
+	unsigned num_operands = inst->getOperandCount();
+	instruction.operands.resize(num_operands);
+	for (unsigned i = 0; i < num_operands; i++)
+	{
+		// Null operands are left with no kind
+		auto operand = inst->getOperand(i);
+		if (!operand.get())
+			continue;
+		LoweredOperand &lowered = instruction.operands[i];
+		lowered.kind = operand->getKind();
+
+		// Decode the operand, resolving registers into slots
+		switch (lowered.kind)
+		{
+		case BRIG_KIND_OPERAND_CONSTANT_BYTES:
+
+		{
+			BrigImmed immed(operand->getBytes(),
+					inst->getOperandType(i));
+			lowered.immediate.resize(immed.getSize());
+			immed.getImmedValue(lowered.immediate.data());
+			break;
+		}
+
+		case BRIG_KIND_OPERAND_REGISTER:
+
+			lowered.reg = getRegisterSlot(operand->getRegKind(),
+					operand->getRegNumber());
+			break;
+
+		case BRIG_KIND_OPERAND_ADDRESS:
+
+		{
+			auto symbol = operand->getSymbol();
+			if (symbol.get())
+				lowered.symbol = symbol->getName();
+			auto reg = operand->getReg();
+			if (reg.get())
+				lowered.reg = getRegisterSlot(reg->getRegKind(),
+						reg->getRegNumber());
+			lowered.offset = operand->getOffset();
+			break;
+		}
+
+		case BRIG_KIND_OPERAND_OPERAND_LIST:
+
+			// Elements other than registers are left with an empty
+			// slot, and rejected when accessed
+			lowered.elements.resize(operand->getElementCount());
+			for (unsigned j = 0; j < lowered.elements.size(); j++)
+			{
+				auto element = operand->getOperandElement(j);
+				if (element->getKind() ==
+						BRIG_KIND_OPERAND_REGISTER)
+					lowered.elements[j] = getRegisterSlot(
+							element->getRegKind(),
+							element->getRegNumber());
+			}
+			break;
+
+		default:
+			break;
+		}
+	}
+}
+
+
 void Function::addArgument(std::unique_ptr<Variable> argument)
 {
 
@@ -94,6 +216,7 @@ void Function::addRegister(BrigRegisterKind kind, unsigned short number)
 	switch(kind)
 	{
 	case BRIG_REGISTER_KIND_CONTROL:
+		register_size += 1;
 		break;
 	case BRIG_REGISTER_KIND_SINGLE:
 		register_size += 4;
@@ -122,11 +245,21 @@ unsigned int Function::getRegisterOffset(const std::string &name) const
 
 void Function::AllocateRegister(unsigned int *max_register)
 {
-	for (unsigned int i = 0; i < 4; i++)
+	// Allocate the widest registers first, so that every register is
+	// aligned to its size
+	const BrigRegisterKind kinds[] = {
+		BRIG_REGISTER_KIND_QUAD,
+		BRIG_REGISTER_KIND_DOUBLE,
+		BRIG_REGISTER_KIND_SINGLE,
+		BRIG_REGISTER_KIND_CONTROL
+	};
+	for (BrigRegisterKind kind : kinds)
 	{
-		for(unsigned int j = 0; j < max_register[i]; j++)
+		register_base[kind] = register_size;
+		register_count[kind] = max_register[kind];
+		for(unsigned int j = 0; j < max_register[kind]; j++)
 		{
-			addRegister((BrigRegisterKind)i, j);
+			addRegister(kind, j);
 		}
 	}
 }
@@ -23,9 +23,12 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <vector>
 
+#include <arch/hsa/disassembler/AsmService.h>
 #include <arch/hsa/disassembler/BrigCodeEntry.h>
 
+#include "LoweredInstruction.h"
 #include "Variable.h"
 
 
@@ -66,6 +69,21 @@ class Function
 
 
 
+	//
+	// Fields related with the lowered function body
+	//
+
+	// Entries of the function body, from the first to the last entry,
+	// indexed by their position in the body. Program counters are
+	// indexes into this array.
+	std::vector<LoweredInstruction> code;
+
+	// Decode the operands of an instruction entry
+	void LowerOperands(LoweredInstruction &instruction) const;
+
+
+
+
 	//
 	// Fields related with arguments
 	//
@@ -87,9 +105,18 @@ class Function
 	// Allocated register size
 	unsigned int register_size = 0;
 
-	// Maps register
+	// Maps register names to their offsets. Only used for debugging,
+	// since register operands are resolved into register slots when the
+	// function is lowered.
 	std::map<std::string, unsigned int> register_info;
 
+	// Offset of the first register of each kind in the register storage,
+	// indexed by BrigRegisterKind
+	unsigned int register_base[4] = {0, 0, 0, 0};
+
+	// Number of allocated registers of each kind
+	unsigned int register_count[4] = {0, 0, 0, 0};
+
 	// Add register information into table
 	void addRegister(BrigRegisterKind kind, unsigned short number);
 
@@ -123,6 +150,40 @@ public:
 	/// Return pointer to the last entry
 	std::unique_ptr<BrigCodeEntry> getLastEntry() const;
 
+	/// Lower the function body into an array of code entries addressed
+	/// by index, resolving branch targets into indexes and register
+	/// operands into register slots. This function must be called once,
+	/// after the first and last entries are set and the registers are
+	/// allocated.
+	void Lower();
+
+	/// Return the number of entries in the lowered function body
+	unsigned getCodeSize() const { return code.size(); }
+
+	/// Return the code entry at position \a index of the lowered
+	/// function body, or null if the index is out of range
+	BrigCodeEntry *getCodeEntry(unsigned index) const
+	{
+		return index < code.size() ? code[index].entry.get() : nullptr;
+	}
+
+	/// Return the entry at position \a index of the lowered function
+	/// body, or null if the index is out of range
+	const LoweredInstruction *getInstruction(unsigned index) const
+	{
+		return index < code.size() ? &code[index] : nullptr;
+	}
+
+	/// Return the index of the entry that the branch instruction at
+	/// position \a index jumps to
+	unsigned getBranchTarget(unsigned index) const
+	{
+		if (index >= code.size() || code[index].branch_target < 0)
+			throw misc::Panic(misc::fmt("Entry %d is not a branch",
+					index));
+		return code[index].branch_target;
+	}
+
 	/// Set the directive
 	void setFunctionDirective(std::unique_ptr<BrigCodeEntry> directive)
 	{
@@ -151,6 +212,22 @@ public:
 	/// return -1.
 	unsigned int getRegisterOffset(const std::string &name) const;
 
+	/// Return the slot of a register given its kind and number, as
+	/// encoded in a register operand. Registers of the same kind are
+	/// allocated contiguously, so no table lookup is needed.
+	RegisterSlot getRegisterSlot(BrigRegisterKind kind,
+			unsigned short number) const
+	{
+		if (number >= register_count[kind])
+			throw misc::Panic(misc::fmt("Register %s not found",
+					AsmService::RegisterToString(kind,
+					number).c_str()));
+		RegisterSlot slot;
+		slot.size = AsmService::getSizeInByteByRegisterKind(kind);
+		slot.offset = register_base[kind] + number * slot.size;
+		return slot;
+	}
+
 	/// Return the size of register required
 	unsigned int getRegisterSize() const { return register_size; }
 
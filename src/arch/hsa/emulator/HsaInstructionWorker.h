@@ -34,7 +34,10 @@ class BrigCodeEntry;
 class OperandValueRetriever;
 class OperandValueWriter;
 
-/// An HsaInstructionWorker is a unit that emulates an instruction
+/// An HsaInstructionWorker is a unit that emulates an instruction. Workers
+/// keep no state across instructions, so one worker per opcode is shared
+/// by all work items, and bound to the work item and stack frame of each
+/// instruction before running it.
 class HsaInstructionWorker
 {
 protected:
@@ -60,6 +63,16 @@ public:
 	/// Execute the instruction
 	virtual void Execute(BrigCodeEntry *instruction) = 0;
 
+	/// Set the work item and stack frame that the next instructions
+	/// run for
+	void Bind(WorkItem *work_item, StackFrame *stack_frame)
+	{
+		this->work_item = work_item;
+		this->stack_frame = stack_frame;
+		operand_value_retriever->Bind(work_item, stack_frame);
+		operand_value_writer->Bind(work_item, stack_frame);
+	}
+
 	/// Set the operand value retriever
 	void setOperandValueRetriever(OperandValueRetriever *retriever)
 	{
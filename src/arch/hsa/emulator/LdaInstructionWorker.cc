@@ -44,13 +44,13 @@ LdaInstructionWorker::~LdaInstructionWorker()
 template<typename T>
 void LdaInstructionWorker::Inst_LDA_Aux(BrigCodeEntry *instruction)
 {
-	// Retrieve operand
-	auto address_operand = instruction->getOperand(1);
-	auto symbol = address_operand->getSymbol();
-	std::string name = symbol->getName();
+	// Retrieve operand, decoded when the function was lowered
+	const LoweredOperand &address_operand =
+			stack_frame->getInstruction()->operands.at(1);
+	const std::string &name = address_operand.symbol;
 
 	// Get offset
-	uint64_t offset = address_operand->getOffset();
+	uint64_t offset = address_operand.offset;
 
 	// Declare addres
 	unsigned address;
@@ -0,0 +1,90 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef ARCH_HSA_EMULATOR_LOWEREDINSTRUCTION_H
+#define ARCH_HSA_EMULATOR_LOWEREDINSTRUCTION_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <arch/hsa/disassembler/Brig.h>
+#include <arch/hsa/disassembler/BrigCodeEntry.h>
+
+
+namespace HSA
+{
+
+/// Location of a register in the register storage of a stack frame,
+/// resolved from the kind and number of a register operand when its
+/// function is lowered
+struct RegisterSlot
+{
+	/// Offset of the register in the register storage
+	unsigned offset = 0;
+
+	/// Size of the register in bytes, or 0 if there is no register
+	unsigned size = 0;
+};
+
+
+/// An operand of a lowered instruction, decoded once from its BRIG entry
+/// so that instructions can access it without going through the operand
+/// section
+struct LoweredOperand
+{
+	/// Kind of the BRIG operand
+	BrigKind kind = BRIG_KIND_NONE;
+
+	/// Register of a register operand, or base register of an address
+	/// operand
+	RegisterSlot reg;
+
+	/// Registers in an operand list
+	std::vector<RegisterSlot> elements;
+
+	/// Value of an immediate operand, with the size of the operand type
+	std::vector<unsigned char> immediate;
+
+	/// Name of the variable of an address operand, or empty if the
+	/// address has no symbol
+	std::string symbol;
+
+	/// Constant offset of an address operand
+	unsigned long long offset = 0;
+};
+
+
+/// An entry of a lowered function body
+struct LoweredInstruction
+{
+	/// The code entry, an instruction or a directive
+	std::unique_ptr<BrigCodeEntry> entry;
+
+	/// Operands of an instruction, empty for directives
+	std::vector<LoweredOperand> operands;
+
+	/// Index of the entry that a branch instruction jumps to, or -1 for
+	/// entries that are not branches
+	int branch_target = -1;
+};
+
+}  // namespace HSA
+
+#endif
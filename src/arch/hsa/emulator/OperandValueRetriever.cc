@@ -17,9 +17,9 @@
  *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <cstring>
+
 #include <arch/hsa/disassembler/BrigCodeEntry.h>
-#include <arch/hsa/disassembler/BrigOperandEntry.h>
-#include <arch/hsa/disassembler/BrigImmed.h>
 
 #include "OperandValueRetriever.h"
 #include "StackFrame.h"
@@ -42,23 +42,38 @@ OperandValueRetriever::~OperandValueRetriever()
 }
 
 
+void OperandValueRetriever::Bind(WorkItem *work_item,
+		StackFrame *stack_frame)
+{
+	this->work_item = work_item;
+	this->stack_frame = stack_frame;
+	lowered_instruction = stack_frame->getInstruction();
+}
+
+
+const LoweredOperand &OperandValueRetriever::getOperand(unsigned index) const
+{
+	if (!lowered_instruction ||
+			index >= lowered_instruction->operands.size())
+		throw misc::Panic("Operand index out of range");
+	return lowered_instruction->operands[index];
+}
+
+
 void OperandValueRetriever::Retrieve(BrigCodeEntry *instruction,
 		unsigned int index, void *buffer)
 {
-	// Get the operand entry
-	auto operand = instruction->getOperand(index);
+	// Get the decoded operand
+	const LoweredOperand &lowered = getOperand(index);
 
 	// Do corresponding action according to the type of operand
-	switch (operand->getKind())
+	switch (lowered.kind)
 	{
 	case BRIG_KIND_OPERAND_CONSTANT_BYTES:
 
-	{
-		BrigImmed immed(operand->getBytes(),
-				instruction->getOperandType(index));
-		immed.getImmedValue(buffer);
+		memcpy(buffer, lowered.immediate.data(),
+				lowered.immediate.size());
 		return;
-	}
 
 	case BRIG_KIND_OPERAND_WAVESIZE:
 
@@ -67,52 +82,44 @@ void OperandValueRetriever::Retrieve(BrigCodeEntry *instruction,
 
 	case BRIG_KIND_OPERAND_REGISTER:
 
-	{
-		std::string register_name = operand->getRegisterName();
-		stack_frame->getRegisterValue(register_name, buffer);
+		stack_frame->getRegisterValue(lowered.reg, buffer);
 		return;
-	}
 
 	case BRIG_KIND_OPERAND_ADDRESS:
 
 	{
 		unsigned long long address = 0;
-		unsigned long long offset = operand->getOffset();
-		if (operand->getSymbol().get())
+		if (!lowered.symbol.empty())
 		{
-			auto symbol = operand->getSymbol();
-			std::string name = symbol->getName();
-
 			// Get the variable
 			Variable *variable =
-				stack_frame->getSymbol(name);
+				stack_frame->getSymbol(lowered.symbol);
 
 			// If the variable is not found in stack frame
 			// try kernel argument
 			if (!variable)
 				variable = work_item->getGrid()->
-						getKernelArgument(name);
+						getKernelArgument(
+						lowered.symbol);
 
 			// If the variable is still not found
 			if (!variable)
 				throw misc::Error(misc::fmt(
 						"Symbol %s is not"
 						" defined",
-						name.c_str()));
+						lowered.symbol.c_str()));
 
 
 			address += variable->getAddress();
 		}
-		if(operand->getReg().get())
+		if (lowered.reg.size)
 		{
-			std::string register_name = operand->getReg()
-						->getRegisterName();
 			unsigned long long reg_address = 0;
-			stack_frame->getRegisterValue(register_name,
+			stack_frame->getRegisterValue(lowered.reg,
 					&reg_address);
 			address += reg_address;
 		}
-		address += offset;
+		address += lowered.offset;
 		*(uint32_t *)buffer = address;
 		return;
 	}
@@ -120,34 +127,15 @@ void OperandValueRetriever::Retrieve(BrigCodeEntry *instruction,
 	case BRIG_KIND_OPERAND_OPERAND_LIST:
 
 	{
-		// Get the vector modifier
-		unsigned vector_size = instruction->getVectorModifier();
-		for (unsigned int i = 0; i < vector_size; i++)
+		// Copy the registers one after the other
+		unsigned char *element_buffer = (unsigned char *)buffer;
+		for (const RegisterSlot &slot : lowered.elements)
 		{
-			auto op_item = operand->getOperandElement(i);
-			switch (op_item->getKind())
-			{
-			case BRIG_KIND_OPERAND_REGISTER:
-
-			{
-				std::string register_name =
-						op_item->
-						getRegisterName();
-				unsigned size = AsmService::getSizeInByteByRegisterName(
-								register_name);
-				stack_frame->getRegisterValue
-						(register_name,
-						(unsigned char *)buffer
-						+ i * size);
-				break;
-			}
-
-			default:
-				throw misc::Panic(misc::fmt(
-						"Unsupported operand "
-						"type in operand list")
-						);
-			}
+			if (!slot.size)
+				throw misc::Panic("Unsupported operand "
+						"type in operand list");
+			stack_frame->getRegisterValue(slot, element_buffer);
+			element_buffer += slot.size;
 		}
 		break;
 	}
@@ -25,16 +25,30 @@ namespace HSA
 class WorkItem;
 class StackFrame;
 class BrigCodeEntry;
+struct LoweredInstruction;
+struct LoweredOperand;
 
 class OperandValueRetriever
 {
 	WorkItem *work_item;
 	StackFrame *stack_frame;
+
+	// Lowered instruction at the program counter of the stack frame when
+	// it was bound, holding the decoded operands
+	const LoweredInstruction *lowered_instruction = nullptr;
+
+	// Return a decoded operand of the bound instruction
+	const LoweredOperand &getOperand(unsigned index) const;
 public:
 	OperandValueRetriever(WorkItem *work_item, StackFrame *stack_frame);
 	virtual ~OperandValueRetriever();
 	virtual void Retrieve(BrigCodeEntry *instruction,
 			unsigned int index, void *buffer);
+
+	/// Set the work item and stack frame that operands are read from,
+	/// and the instruction that the stack frame program counter points
+	/// to as the instruction whose operands are accessed
+	void Bind(WorkItem *work_item, StackFrame *stack_frame);
 };
 
 }
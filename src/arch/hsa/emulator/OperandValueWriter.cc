@@ -18,7 +18,6 @@
  */
 
 #include <arch/hsa/disassembler/BrigCodeEntry.h>
-#include <arch/hsa/disassembler/BrigOperandEntry.h>
 
 #include "OperandValueWriter.h"
 #include "StackFrame.h"
@@ -38,53 +37,47 @@ OperandValueWriter::~OperandValueWriter()
 {
 }
 
+void OperandValueWriter::Bind(WorkItem *work_item, StackFrame *stack_frame)
+{
+	this->work_item = work_item;
+	this->stack_frame = stack_frame;
+	lowered_instruction = stack_frame->getInstruction();
+}
+
+const LoweredOperand &OperandValueWriter::getOperand(unsigned index) const
+{
+	if (!lowered_instruction ||
+			index >= lowered_instruction->operands.size())
+		throw misc::Panic("Operand index out of range");
+	return lowered_instruction->operands[index];
+}
+
 void OperandValueWriter::Write(BrigCodeEntry *instruction,
 		unsigned int index, void *buffer)
 {
-	// Get the operand entry
-	auto operand = instruction->getOperand(index);
+	// Get the decoded operand
+	const LoweredOperand &lowered = getOperand(index);
 
 	// Do corresponding action according to the type of operand
-	switch (operand->getKind())
+	switch (lowered.kind)
 	{
 	case BRIG_KIND_OPERAND_REGISTER:
 
-	{
-		std::string register_name = operand->getRegisterName();
-		stack_frame->setRegisterValue(register_name, buffer);
+		stack_frame->setRegisterValue(lowered.reg, buffer);
 		break;
-	}
 
 	case BRIG_KIND_OPERAND_OPERAND_LIST:
 
 	{
-		// Get the vector modifier
-		unsigned vector_size = instruction->getVectorModifier();
-		for (unsigned int i = 0; i < vector_size; i++)
+		// Copy the registers one after the other
+		unsigned char *element_buffer = (unsigned char *)buffer;
+		for (const RegisterSlot &slot : lowered.elements)
 		{
-			auto op_item = operand->getOperandElement(i);
-			switch (op_item->getKind())
-			{
-			case BRIG_KIND_OPERAND_REGISTER:
-
-			{
-				std::string register_name =
-						op_item->
-						getRegisterName();
-				unsigned size = AsmService::getSizeInByteByRegisterName(
-						register_name);
-				stack_frame->setRegisterValue
-						(register_name,
-						 (unsigned char *)buffer + i * size);
-				break;
-			}
-
-			default:
-				throw misc::Panic(misc::fmt(
-						"Unsupported operand "
-						"type in operand list")
-						);
-			}
+			if (!slot.size)
+				throw misc::Panic("Unsupported operand "
+						"type in operand list");
+			stack_frame->setRegisterValue(slot, element_buffer);
+			element_buffer += slot.size;
 		}
 		break;
 	}
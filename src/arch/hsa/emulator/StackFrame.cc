@@ -35,13 +35,10 @@ StackFrame::StackFrame(Function *function, WorkItem *work_item,
 	// Set work item
 	this->work_item = work_item;
 
-	// Set the program counter to be pointing to the first entry of the
-	// function
-	pc = function->getFirstEntry();
-
 	// Allocate register space
 	register_storage = misc::new_unique_array<char>(
 			function->getRegisterSize());
+	registers = register_storage.get();
 
 	// Set the function argument segment
 	this->function_argument_segment = function_argument_segment;
@@ -71,9 +68,25 @@ StackFrame::~StackFrame()
 }
 
 
-void StackFrame::setPc(std::unique_ptr<BrigCodeEntry> pc)
+void StackFrame::setRegisterFile(char *register_file, unsigned lane,
+		unsigned num_lanes)
 {
-	this->pc = std::move(pc);
+	// Copy register values
+	for (auto it = function->getRegisterBegin();
+			it != function->getRegisterEnd(); it++)
+	{
+		unsigned offset = it->second;
+		unsigned size = AsmService::getSizeInByteByRegisterName(
+				it->first);
+		memcpy(register_file + offset * num_lanes + lane * size,
+				getRegisterAddress(offset, size), size);
+	}
+
+	// Switch to the register file
+	registers = register_file;
+	this->lane = lane;
+	this->num_lanes = num_lanes;
+	register_storage.reset();
 }
 
 
@@ -105,9 +118,13 @@ void StackFrame::Dump(std::ostream &os = std::cout) const
 	os << misc::fmt("  Function: %s,\n", function->getName().c_str());
 
 	// Dump program counter and current instruction
-	os << misc::fmt("  Program counter (offset in code section): 0x%x, ",
-			pc->getOffset());
-	pc->Dump(os);
+	BrigCodeEntry *entry = getPc();
+	if (entry)
+	{
+		os << misc::fmt("  Program counter (offset in code "
+				"section): 0x%x, ", entry->getOffset());
+		entry->Dump(os);
+	}
 	os << "\n";
 
 	// Dump Register status
@@ -204,9 +221,8 @@ void StackFrame::DumpRegister(const std::string &name,
 			{
 				os << ", ";
 			}
-			os << misc::fmt("0x%x",
-					*(this->register_storage.get()
-							+ offset + i));
+			os << misc::fmt("0x%x", (unsigned char)
+					getRegisterAddress(offset, 16)[i]);
 		}
 		break;
 	}
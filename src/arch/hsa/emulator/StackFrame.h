@@ -40,8 +40,8 @@ class StackFrame
 	// The work item that this stack frame belongs to
 	WorkItem *work_item;
 
-	// Pointer to the instruction to be executed
-	std::unique_ptr<BrigCodeEntry> pc;
+	// Index of the entry to be executed in the lowered function body
+	unsigned pc = 0;
 
 	// Function input and output arguments
 	std::map<std::string, std::unique_ptr<Variable>> function_arguments;
@@ -61,11 +61,26 @@ class StackFrame
 	// All variables declared in private, group and global segment
 	std::map<std::string, std::unique_ptr<Variable>> variables;
 
- 	// Register storage
+	// Register storage owned by the stack frame, unless the frame uses
+	// the register file of its wavefront. C registers use an 8-bit char
+	// for each 1-bit boolean value.
 	std::unique_ptr<char[]> register_storage;
 
-	// C registers, use a 8 bit char for each 1 bit boolean value
-	unsigned char c_registers[8];
+	// Registers of the frame, in its own storage or in the register file
+	// of a wavefront. The values of each register for all lanes are
+	// stored contiguously, in lane order, starting at the register
+	// offset times the number of lanes.
+	char *registers;
+
+	// Lane of the frame in the register file, and number of lanes
+	unsigned lane = 0;
+	unsigned num_lanes = 1;
+
+	// Return the address of the value of a register in this lane
+	char *getRegisterAddress(unsigned offset, unsigned size) const
+	{
+		return registers + offset * num_lanes + lane * size;
+	}
 
 public:
 
@@ -93,11 +108,23 @@ public:
 	/// Return the function
 	Function *getFunction() const { return function; }
 
-	/// Return the program counter
-	BrigCodeEntry *getPc() const { return pc.get(); }
+	/// Return the entry pointed to by the program counter, or null if
+	/// the program counter is past the end of the function
+	BrigCodeEntry *getPc() const { return function->getCodeEntry(pc); }
 
-	/// Set the program counter
-	void setPc(std::unique_ptr<BrigCodeEntry> pc);
+	/// Return the lowered instruction pointed to by the program counter,
+	/// or null if the program counter is past the end of the function
+	const LoweredInstruction *getInstruction() const
+	{
+		return function->getInstruction(pc);
+	}
+
+	/// Return the program counter, as an index in the lowered function
+	/// body
+	unsigned getPcIndex() const { return pc; }
+
+	/// Set the program counter to an index in the lowered function body
+	void setPc(unsigned pc) { this->pc = pc; }
 
 	/// Dump stack frame information
 	void Dump(std::ostream &os) const;
@@ -113,17 +140,35 @@ public:
 	/// Dump the information of a register by name
 	void DumpRegister(const std::string &name, std::ostream &os) const;
 
-	/// Return register value
-	void getRegisterValue(const std::string &name, void *buffer) const
+	/// Make the frame use the register file of a wavefront with \a
+	/// num_lanes lanes, in which its registers are those of lane \a lane.
+	/// The register file must be large enough to hold the registers of
+	/// the function for all lanes. The current register values are
+	/// copied into the register file.
+	void setRegisterFile(char *register_file, unsigned lane,
+			unsigned num_lanes);
+
+	/// Return the value of the register in a register slot, as resolved
+	/// from a register operand when the function was lowered
+	void getRegisterValue(const RegisterSlot &slot, void *buffer) const
 	{
-		// Do special action for c registers
-		if (name[1] == 'c')
-		{
-			unsigned int index = name[2] - '0';
-			*(unsigned char *)buffer = c_registers[index];
-			return;
-		}
+		memcpy(buffer, getRegisterAddress(slot.offset, slot.size),
+				slot.size);
+	}
 
+	/// Set the value of the register in a register slot, as resolved
+	/// from a register operand when the function was lowered
+	void setRegisterValue(const RegisterSlot &slot, const void *value)
+	{
+		memcpy(getRegisterAddress(slot.offset, slot.size), value,
+				slot.size);
+	}
+
+	/// Return register value by name. This function is slower than
+	/// the version taking a register slot, and is meant for debugging
+	/// purposes.
+	void getRegisterValue(const std::string &name, void *buffer) const
+	{
 		// Get the offset of the register
 		unsigned int offset = function->getRegisterOffset(name);
 
@@ -131,23 +176,14 @@ public:
 		unsigned size = AsmService::getSizeInByteByRegisterName(name);
 
 		// Copy the value of the register
-		memcpy(buffer, register_storage.get() + offset, size);
-
-		// Return the value of the register
-		return;
+		memcpy(buffer, getRegisterAddress(offset, size), size);
 	}
 
-	/// Set a registers value
+	/// Set a register value by name. This function is slower than the
+	/// version taking a register slot, and is meant for debugging
+	/// purposes.
 	void setRegisterValue(const std::string &name, void *value)
 	{
-		// Do special action for c registers
-		if (name[1] == 'c')
-		{
-			unsigned int index = name[2] - '0';
-			c_registers[index] = *(unsigned char *)value;
-			return;
-		}
-
 		// Get the offset of the register
 		unsigned int offset = function->getRegisterOffset(name);
 
@@ -155,10 +191,7 @@ public:
 		unsigned size = AsmService::getSizeInByteByRegisterName(name);
 
 		// Copy the value to the register
-		memcpy(register_storage.get() + offset, value, size);
-
-		// Set the value of the register
-		return;
+		memcpy(getRegisterAddress(offset, size), value, size);
 	}
 
 	/// Start an argument scope, when a '{' appears. Requires the size to
@@ -17,6 +17,10 @@
  *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <algorithm>
+
+#include "Component.h"
+#include "Grid.h"
 #include "Wavefront.h"
 
 namespace HSA
@@ -34,15 +38,100 @@ Wavefront::~Wavefront()
 }
 
 
+void Wavefront::ExecuteDivergent()
+{
+	instruction = nullptr;
+	for (unsigned lane = 0; lane < work_items.size(); lane++)
+	{
+		WorkItem *work_item = work_items[lane].get();
+		exec_mask[lane] = !work_item->isFinished() &&
+				work_item->getStatue() ==
+				WorkItem::WorkItemStatusActive;
+		work_item->Execute();
+	}
+}
+
+
 bool Wavefront::Execute()
 {
+	// Find the lowest program counter among active lanes, and check
+	// whether they are all in the same function
+	StackFrame *first_frame = nullptr;
+	unsigned first_depth = 0;
+	unsigned pc = 0;
 	bool on_going = false;
-	for (auto it = work_items.begin(); it != work_items.end(); it++)
+	for (auto &work_item : work_items)
 	{
-		if ((*it)->Execute())
-			on_going = true;
+		// Skip finished and suspended lanes
+		if (work_item->isFinished())
+			continue;
+		on_going = true;
+		if (work_item->getStatue() != WorkItem::WorkItemStatusActive)
+			continue;
+
+		// First active lane
+		StackFrame *frame = work_item->getStackTop();
+		if (!first_frame)
+		{
+			first_frame = frame;
+			first_depth = work_item->getStackDepth();
+			pc = frame->getPcIndex();
+			continue;
+		}
+
+		// Lanes in different functions run independently
+		if (work_item->getStackDepth() != first_depth ||
+				frame->getFunction() !=
+				first_frame->getFunction())
+		{
+			ExecuteDivergent();
+			return true;
+		}
+
+		// Lowest program counter
+		pc = std::min(pc, frame->getPcIndex());
 	}
-	return on_going;
+
+	// Nothing to run
+	exec_mask.assign(work_items.size(), false);
+	instruction = nullptr;
+	if (!first_frame)
+		return on_going;
+
+	// Build execution mask
+	for (unsigned lane = 0; lane < work_items.size(); lane++)
+	{
+		WorkItem *work_item = work_items[lane].get();
+		exec_mask[lane] = !work_item->isFinished() &&
+				work_item->getStatue() ==
+				WorkItem::WorkItemStatusActive &&
+				work_item->getStackTop()->getPcIndex() == pc;
+	}
+
+	// Directives and the end of a function are handled by each lane
+	instruction = first_frame->getFunction()->getCodeEntry(pc);
+	if (!instruction || !instruction->isInstruction())
+	{
+		for (unsigned lane = 0; lane < work_items.size(); lane++)
+			if (exec_mask[lane])
+				work_items[lane]->Execute();
+		return true;
+	}
+
+	// Decode the instruction once, and run it on all lanes in the mask
+	HsaInstructionWorker *instruction_worker = nullptr;
+	for (unsigned lane = 0; lane < work_items.size(); lane++)
+	{
+		if (!exec_mask[lane])
+			continue;
+		WorkItem *work_item = work_items[lane].get();
+		if (!instruction_worker)
+			instruction_worker = work_item->getInstructionWorker(
+					instruction);
+		work_item->ExecuteInstruction(instruction_worker,
+				instruction);
+	}
+	return true;
 }
 
 
@@ -71,7 +160,28 @@ void Wavefront::Dump(std::ostream &os = std::cout) const
 
 void Wavefront::addWorkItem(std::unique_ptr<WorkItem> work_item)
 {
+	// Create the register file for the root function of the first
+	// work item, with one lane per work item in a wavefront
+	unsigned lane = work_items.size();
+	StackFrame *frame = work_item->isFinished() ? nullptr :
+			work_item->getStackTop();
+	if (!register_file && frame && work_item->getStackDepth() == 1)
+	{
+		root_function = frame->getFunction();
+		num_lanes = std::max(1u, work_group->getGrid()->
+				getComponent()->getWavesize());
+		register_file = misc::new_unique_array<char>(
+				root_function->getRegisterSize() * num_lanes);
+	}
+
+	// Move the registers of the work item into its lane
+	if (frame && work_item->getStackDepth() == 1 &&
+			frame->getFunction() == root_function &&
+			lane < num_lanes)
+		frame->setRegisterFile(register_file.get(), lane, num_lanes);
+
 	this->work_items.push_back(std::move(work_item));
+	exec_mask.push_back(false);
 }
 
 }  // namespace HSA
@@ -20,6 +20,8 @@
 #ifndef ARCH_HSA_EMULATOR_WAVEFRONT_H
 #define ARCH_HSA_EMULATOR_WAVEFRONT_H
 
+#include <vector>
+
 #include "WorkItem.h"
 #include "WorkGroup.h"
 
@@ -38,9 +40,29 @@ class Wavefront
 	// The work group it belongs to
 	WorkGroup *work_group;
 
-	// List of work items
-	// FIXME: vector
-	std::list<std::unique_ptr<WorkItem>> work_items;
+	// Work items, one per lane
+	std::vector<std::unique_ptr<WorkItem>> work_items;
+
+	// Registers of the root function for all lanes. The values of each
+	// register for all lanes are stored contiguously, in lane order, so
+	// that an instruction run in lock-step accesses them together.
+	std::unique_ptr<char[]> register_file;
+
+	// Function whose registers are in the register file
+	Function *root_function = nullptr;
+
+	// Number of lanes in the register file
+	unsigned num_lanes = 0;
+
+	// Execution mask of the last instruction, with one entry per lane
+	std::vector<bool> exec_mask;
+
+	// Last instruction executed in lock-step by the lanes in the
+	// execution mask, or null if lanes last ran independently
+	BrigCodeEntry *instruction = nullptr;
+
+	// Run one instruction on each lane independently
+	void ExecuteDivergent();
 
 public:
 
@@ -50,9 +72,35 @@ public:
 	/// Destructor
 	~Wavefront();
 
-	/// Execute instructions
+	/// Execute one instruction in lock-step on all active lanes whose
+	/// program counter points to it. Lanes run the instruction with the
+	/// lowest program counter first, so that lanes that diverged on a
+	/// branch wait for the rest and reconverge at the first instruction
+	/// that all of them reach. Lanes only run independently when they
+	/// are at different function call levels.
+	///
+	/// \return
+	///	False if all work items in the wavefront have finished.
 	bool Execute();
 
+	/// Return the last instruction executed in lock-step, or null if the
+	/// lanes last ran independently
+	BrigCodeEntry *getInstruction() const { return instruction; }
+
+	/// Return whether the lane with the given index executed the last
+	/// instruction
+	bool isLaneActive(unsigned lane) const { return exec_mask[lane]; }
+
+	/// Return the values of a register of the root function for all
+	/// lanes, stored contiguously in lane order, or null if the lanes
+	/// keep their registers in their own stack frames
+	const char *getRegister(const RegisterSlot &slot) const
+	{
+		if (!register_file)
+			return nullptr;
+		return register_file.get() + slot.offset * num_lanes;
+	}
+
 	/// Activate all work items
 	void ActivateAllWorkItems();
 
@@ -67,7 +115,9 @@ public:
 	/// Dump wavefront formation
 	void Dump(std::ostream &os) const;
 
-	/// Add work item into list
+	/// Add work item into list, as the next lane. A work item that has
+	/// not called any function yet keeps its registers in the register
+	/// file of the wavefront.
 	void addWorkItem(std::unique_ptr<WorkItem> work_item);
 };
 
@@ -54,6 +54,9 @@
 namespace HSA
 {
 
+std::vector<std::unique_ptr<HsaInstructionWorker>> WorkItem::instruction_workers;
+
+
 WorkItem::WorkItem()
 {
 }
@@ -113,21 +116,17 @@ bool WorkItem::MovePcForwardByOne()
 	// Retrieve the stack top
 	StackFrame *stack_top = stack.back().get();
 
-	// Set the stackframe's pc to the next instuction
-	auto next_pc = stack_top->getPc()->Next();
-
 	// If next pc is beyond last inst, the last instruction of the function
 	// is executed. Return the function.
-	if (!next_pc ||
-		next_pc->getOffset() >
-		stack_top->getFunction()->getLastEntry()->getOffset())
+	unsigned next_pc = stack_top->getPcIndex() + 1;
+	if (next_pc >= stack_top->getFunction()->getCodeSize())
 	{
 		ReturnFunction();
 		return false;
 	}
 
 	// Set program counter to next instruction
-	stack_top->setPc(std::move(next_pc));
+	stack_top->setPc(next_pc);
 
 	// Returns true to tell the caller that the function is not returned
 	return true;
@@ -262,16 +261,19 @@ void WorkItem::ExecuteDirective()
 	case BRIG_KIND_DIRECTIVE_ARG_BLOCK_START:
 
 	{
-		auto dir = pc->Next();
+		Function *function = stack_top->getFunction();
+		unsigned index = stack_top->getPcIndex() + 1;
+		BrigCodeEntry *dir = function->getCodeEntry(index);
 		unsigned size = 0;
-		while (dir->getKind() != BRIG_KIND_DIRECTIVE_ARG_BLOCK_END)
+		while (dir && dir->getKind() !=
+				BRIG_KIND_DIRECTIVE_ARG_BLOCK_END)
 		{
 			if (dir->getKind() == BRIG_KIND_DIRECTIVE_VARIABLE)
 			{
 				size += AsmService::TypeToSize(
 						dir->getType());
 			}
-			dir = dir->Next();
+			dir = function->getCodeEntry(++index);
 		}
 		stack_top->StartArgumentScope(size);
 
@@ -523,10 +525,26 @@ void WorkItem::DeclareVariable()
 }
 
 
-std::unique_ptr<HsaInstructionWorker> WorkItem::getInstructionWorker(
-		BrigCodeEntry *instruction) 
+HsaInstructionWorker *WorkItem::getInstructionWorker(
+		BrigCodeEntry *instruction)
 {
+	// Create worker the first time the opcode is found
 	BrigOpcode opcode = instruction->getOpcode();
+	if (instruction_workers.size() <= (unsigned) opcode)
+		instruction_workers.resize(opcode + 1);
+	auto &instruction_worker = instruction_workers[opcode];
+	if (!instruction_worker)
+		instruction_worker = createInstructionWorker(opcode);
+
+	// Bind it to the current stack frame
+	instruction_worker->Bind(this, getStackTop());
+	return instruction_worker.get();
+}
+
+
+std::unique_ptr<HsaInstructionWorker> WorkItem::createInstructionWorker(
+		BrigOpcode opcode)
+{
 	StackFrame *stack_top = getStackTop();
 	switch(opcode) 
 	{
@@ -661,56 +679,21 @@ bool WorkItem::Execute()
 		return false;
 	}
 
-	// Retrieve stack top
-	StackFrame *stack_top = getStackTop();
-
-	// Increase instruction counter
-	Emulator::getInstance()->incNumInstructions();
-
 	// Execute the instruction or directory
-	BrigCodeEntry *inst = stack_top->getPc();
+	BrigCodeEntry *inst = getStackTop()->getPc();
 	if (inst && inst->isInstruction())
 	{
-		if (getAbsoluteFlattenedId() == 0)
-		{
-			Emulator::isa_debug << misc::fmt("WorkItem: %d\n",
-					getAbsoluteFlattenedId());
-			Emulator::isa_debug << "Executing: ";
-			Emulator::isa_debug << *inst;
-
-//			Emulator::isa_debug << "Before: ";
-//			if (Emulator::isa_debug)
-//				stack_top->Dump(Emulator::isa_debug);
-//			Emulator::isa_debug << "\n";
-		}
-
 		// Get the function according to the opcode and perform the inst
-		auto instruction_worker = getInstructionWorker(inst);
-		if (instruction_worker.get())
-		{
-			instruction_worker->Execute(inst);
-		}
-
-		// Return false if execution finished
-		if (stack.empty())
-			return false;
-		
-		// Record frame status after the instruction is executed
-		stack_top = getStackTop();
-		if (getAbsoluteFlattenedId() == 0)
-		{
-			if (Emulator::isa_debug)
-				stack_top->Dump(Emulator::isa_debug);
-			Emulator::isa_debug << "\n";
-		}
-
+		ExecuteInstruction(getInstructionWorker(inst), inst);
 	}
 	else if (inst && !inst->isInstruction())
 	{
+		Emulator::getInstance()->incNumInstructions();
 		ExecuteDirective();
 	}
 	else
 	{
+		Emulator::getInstance()->incNumInstructions();
 		if(!MovePcForwardByOne())
 		{
 			return false;
@@ -726,6 +709,37 @@ bool WorkItem::Execute()
 }
 
 
+void WorkItem::ExecuteInstruction(HsaInstructionWorker *instruction_worker,
+		BrigCodeEntry *inst)
+{
+	// Increase instruction counter
+	Emulator::getInstance()->incNumInstructions();
+
+	// Debug
+	if (getAbsoluteFlattenedId() == 0)
+	{
+		Emulator::isa_debug << misc::fmt("WorkItem: %d\n",
+				getAbsoluteFlattenedId());
+		Emulator::isa_debug << "Executing: ";
+		Emulator::isa_debug << *inst;
+	}
+
+	// Perform the instruction on this work item
+	instruction_worker->Bind(this, getStackTop());
+	instruction_worker->Execute(inst);
+	if (stack.empty())
+		return;
+
+	// Record frame status after the instruction is executed
+	if (getAbsoluteFlattenedId() == 0)
+	{
+		if (Emulator::isa_debug)
+			getStackTop()->Dump(Emulator::isa_debug);
+		Emulator::isa_debug << "\n";
+	}
+}
+
+
 Grid *WorkItem::getGrid() const 
 {
 	return work_group->getGrid();
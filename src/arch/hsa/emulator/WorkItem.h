@@ -21,6 +21,7 @@
 #define ARCH_HSA_EMULATOR_WORKITEM_H
 
 #include <memory>
+#include <vector>
 
 #include <arch/hsa/disassembler/BrigCodeEntry.h>
 #include <arch/hsa/disassembler/BrigDataEntry.h>
@@ -101,9 +102,15 @@ private:
  	// Process directives befor an instruction
  	void ExecuteDirective();
 
-	// Get HSA instruction worker according to the instruction
-	std::unique_ptr<HsaInstructionWorker> getInstructionWorker(
-			BrigCodeEntry *instruction);
+	// Instruction workers shared by all work items, indexed by opcode
+	// and created the first time an opcode is executed
+	static std::vector<std::unique_ptr<HsaInstructionWorker>>
+			instruction_workers;
+
+	// Create a HSA instruction worker for an opcode
+	std::unique_ptr<HsaInstructionWorker> createInstructionWorker(
+			BrigOpcode opcode);
+
 
 
 
@@ -150,6 +157,16 @@ public:
  	/// Run one instruction for the workitem at the position pointed 
  	bool Execute();
 
+	/// Return the instruction worker for the opcode of an instruction,
+	/// bound to this work item and its stack top
+	HsaInstructionWorker *getInstructionWorker(BrigCodeEntry *instruction);
+
+	/// Run the instruction that the program counter points to with an
+	/// instruction worker already retrieved for its opcode. Wavefronts
+	/// use it to decode an instruction once for all their active lanes.
+	void ExecuteInstruction(HsaInstructionWorker *instruction_worker,
+			BrigCodeEntry *instruction);
+
  	/// Move the program counter by one. Return false if current PC is
  	/// at the end of the function
  	virtual bool MovePcForwardByOne();
@@ -157,6 +174,12 @@ public:
  	/// Dump backtrace information
  	void Backtrace(std::ostream &os) const;
 
+	/// Return whether the work item has returned from its root function
+	bool isFinished() const { return stack.empty(); }
+
+	/// Return the number of frames in the stack
+	unsigned getStackDepth() const { return stack.size(); }
+
 	/// Return the stack top stack frame
 	StackFrame* getStackTop() const
 	{
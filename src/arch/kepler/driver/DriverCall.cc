@@ -23,6 +23,7 @@
 #include <arch/kepler/disassembler/Disassembler.h>
 #include <arch/kepler/emulator/Emulator.h>
 #include <arch/kepler/emulator/Grid.h>
+#include <arch/kepler/timing/Timing.h>
 #include <lib/cpp/String.h>
 #include <lib/util/string.h>
 #include <memory/Memory.h>
@@ -166,9 +167,7 @@ int Driver::CallMemRead(comm::Context *context,
 		throw Error("Accessing device memory not allocated");
 
 	// Read memory from device to host
-	std::unique_ptr<char> buffer(new char[size]);
-	global_mem->Read(device_ptr, size, buffer.get());
-	memory->Write(host_ptr, size, buffer.get());
+	memory->CopyFrom(host_ptr, *global_mem, device_ptr, size);
 
 	// Return
 	return 0;
@@ -215,10 +214,8 @@ int Driver::CallMemWrite(comm::Context *context,
 	//if (device_ptr + size > kpl_emu->getGlobalMemTop())
 	//	throw Error("Accessing device memory not allocated");
 
-	// Read memory from host to device
-	std::unique_ptr<char> buffer(new char[size]);
-	memory->Read(host_ptr, size, buffer.get());
-	global_mem->Write(device_ptr, size, buffer.get());
+	// Write memory from host to device
+	global_mem->CopyFrom(device_ptr, *memory, host_ptr, size);
 
 	// Return
 	return 0;
@@ -362,6 +359,15 @@ int Driver::CallLaunchKernel(comm::Context *context,
 	// Add to pending list
 	kpl_emu->PushPendingGrid(grid);
 
+	// In a detailed simulation, the grid runs over several cycles of the
+	// timing simulator. Suspend the context until it completes, since
+	// the constant memory and the results are shared with the host.
+	if (Timing::getSimKind() == comm::Arch::SimDetailed)
+	{
+		context->Suspend();
+		grid->setSuspendedContext(context);
+	}
+
 	// Return value
 	return 0;
 }
@@ -17,6 +17,8 @@
  *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <algorithm>
+#include <cassert>
 #include <iostream>
 #include <list>
 #include <memory>
@@ -43,8 +45,10 @@ namespace Kepler
 // Debugger file
 std::string Emulator::isa_debug_file;
 
-// Simulation kind
-comm::Arch::SimKind Emulator::sim_kind = comm::Arch::SimFunctional;
+// Streaming multiprocessors and residency limits
+int Emulator::num_sms = 15;
+int Emulator::max_thread_blocks_per_sm = 16;
+int Emulator::max_warps_per_sm = 64;
 
 
 
@@ -65,6 +69,13 @@ Emulator *Emulator::getInstance()
 	return instance.get();
 }
 
+
+void Emulator::Destroy()
+{
+	instance = nullptr;
+}
+
+
 Emulator::Emulator() : comm::Emulator("Kepler")
 {
 	// Initialize disassembler
@@ -112,52 +123,49 @@ bool Emulator::Run()
 	if (!pending_grids.size())
 		return false;
 
-	// Remove grid and its thread blocks from pending list, and add them to
-	// running list
-	Grid *grid;
-	std::unique_ptr<ThreadBlock> thread_block;
-	int thread_block_id;
-	unsigned thread_block_3d_id[3];
+	// Run pending grids to completion
 	while (pending_grids.size())
 	{
-		grid = pending_grids.front();
+		Grid *grid = pending_grids.front();
 		pending_grids.pop_front();
-		thread_block_id = 0;
-		while (grid->getPendThreadBlocksize())
+		unsigned max_resident = getMaxResidentThreadBlocks(grid);
+		while (grid->getPendThreadBlocksize() ||
+				grid->getRunningThreadBlocksize())
 		{
-			// Threadblock.X
-			thread_block_3d_id[0] = thread_block_id /
-					(grid->getThreadBlockCount3(1) *
-							grid->getThreadBlockCount3(2));
-
-			// Threadblock.Y
-			thread_block_3d_id[1] = (thread_block_id %
-					(grid->getThreadBlockCount3(1) *
-							grid->getThreadBlockCount3(2))) /
-								grid->getThreadBlockCount3(2);
-
-			// ThreadBlock.Z
-			thread_block_3d_id[2] = ((thread_block_id %
-					(grid->getThreadBlockCount3(1) *
-							grid->getThreadBlockCount3(2))) %
-								grid->getThreadBlockCount3(2))  ;
-			grid->WaitingToRunning(thread_block_id, thread_block_3d_id);
-			thread_block_id ++;
-			thread_block.reset(grid->getRunningThreadBlocksBegin()->release());
-			while (thread_block.get()->getNumWarpsCompletedEmu()
-					!= thread_block.get()->getWarpCount())
+			// Start pending thread-blocks up to the residency limit.
+			// Thread-blocks are only materialized at this point.
+			while (grid->getPendThreadBlocksize() &&
+					grid->getRunningThreadBlocksize() <
+					max_resident)
+				grid->StartThreadBlock();
+
+			// Execute one instruction of each warp of each resident
+			// thread-block
+			for (auto it = grid->getRunningThreadBlocksBegin();
+					it != grid->getRunningThreadBlocksEnd(); )
 			{
-				for (auto wp_p = thread_block.get()->WarpsBegin(); wp_p <
-					thread_block.get()->WarpsEnd(); ++wp_p)
+				ThreadBlock *thread_block = it->get();
+				thread_block->Activate();
+				for (auto wp_p = thread_block->WarpsBegin(); wp_p <
+					thread_block->WarpsEnd(); ++wp_p)
 				{
 					if ((*wp_p)->getFinishedEmu() || (*wp_p)->getAtBarrier())
 						continue;
 					(*wp_p)->Execute();
 				}
+
+				// Recycle finished thread-block
+				if (thread_block->getNumWarpsCompletedEmu() ==
+						thread_block->getWarpCount())
+				{
+					thread_block->setFinishedEmu(true);
+					it = grid->FinishThreadBlock(it);
+				}
+				else
+				{
+					++it;
+				}
 			}
-			thread_block.get()->setFinishedEmu(true);
-			grid->PopRunningThreadBlock();
-			thread_block.reset(); // free the memory of thread block
 		}
 		finished_grids.push_back(grid);
 	}
@@ -171,12 +179,73 @@ bool Emulator::Run()
 }
 
 
+void Emulator::setSmConfiguration(int num_sms,
+		int max_thread_blocks_per_sm,
+		int max_warps_per_sm)
+{
+	assert(num_sms > 0);
+	assert(max_thread_blocks_per_sm > 0);
+	assert(max_warps_per_sm > 0);
+	Emulator::num_sms = num_sms;
+	Emulator::max_thread_blocks_per_sm = max_thread_blocks_per_sm;
+	Emulator::max_warps_per_sm = max_warps_per_sm;
+}
+
+
+unsigned Emulator::getMaxResidentThreadBlocks(Grid *grid) const
+{
+	// Thread-blocks per streaming multiprocessor, limited by the number of
+	// warps, with at least one
+	unsigned warps_per_thread_block = (grid->getThreadBlockSize() +
+			warp_size - 1) / warp_size;
+	warps_per_thread_block = std::max(1u, warps_per_thread_block);
+	unsigned max_thread_blocks = std::min((unsigned)
+			max_thread_blocks_per_sm,
+			max_warps_per_sm / warps_per_thread_block);
+	max_thread_blocks = std::max(1u, max_thread_blocks);
+	return max_thread_blocks * num_sms;
+}
+
+
+std::unique_ptr<ThreadBlock> Emulator::AllocateThreadBlock(Grid *grid,
+		int id, unsigned *id_3d)
+{
+	// Create a new thread-block if the pool is empty
+	if (thread_block_pool.empty())
+		return std::unique_ptr<ThreadBlock>(new ThreadBlock(grid, id,
+				id_3d));
+
+	// Recycle a thread-block from the pool
+	std::unique_ptr<ThreadBlock> thread_block =
+			std::move(thread_block_pool.back());
+	thread_block_pool.pop_back();
+	thread_block->Reset(grid, id, id_3d);
+	return thread_block;
+}
+
+
+void Emulator::ReleaseThreadBlock(std::unique_ptr<ThreadBlock> thread_block)
+{
+	thread_block_pool.push_back(std::move(thread_block));
+}
+
+
 void Emulator::PushPendingGrid(Grid *grid)
 {
 	pending_grids.push_back(grid);
 }
 
 
+Grid *Emulator::PopPendingGrid()
+{
+	if (pending_grids.empty())
+		return nullptr;
+	Grid *grid = pending_grids.front();
+	pending_grids.pop_front();
+	return grid;
+}
+
+
 Grid *Emulator::addGrid(Function *function)
 {
 	// Create the grid and add it to the grid list
@@ -193,12 +262,6 @@ void Emulator::RegisterOptions()
 	// Category
 	command_line->setCategory("Kepler");
 
-	// Option --kpl-sim <kind>
-	command_line->RegisterEnum("--kpl-sim {functional|detailed} "
-			"(default = functional)",
-			(int &) sim_kind, comm::Arch::SimKindMap,
-			"Level of accuracy of kepler simulation");
-
 	// Option --kpl-debug-isa <kind>
 	command_line->RegisterString("--kpl-debug-isa <file>",isa_debug_file,
 			"Dump debug information about Kepler isa implementation");
@@ -207,11 +270,6 @@ void Emulator::RegisterOptions()
 
 void Emulator::ProcessOptions()
 {
-	// Throw an error for now if the si-sim detailed is invoked
-	if (sim_kind == comm::Arch::SimDetailed)
-		throw misc::Error("The detailed Kepler simulation is not currently "
-				"supported in Multi2Sim.");
-
 	// Set the path for the debug files
 	isa_debug.setPath(isa_debug_file);
 	isa_debug.setPrefix("[Kepler emulator]");
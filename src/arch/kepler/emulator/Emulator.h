@@ -49,8 +49,15 @@ class Emulator : public comm::Emulator
 	// Debugger file
 	static std::string isa_debug_file;
 
-	// Simulation kind
-	static comm::Arch::SimKind sim_kind;
+	// Number of streaming multiprocessors
+	static int num_sms;
+
+	// Maximum number of resident thread-blocks per streaming
+	// multiprocessor
+	static int max_thread_blocks_per_sm;
+
+	// Maximum number of resident warps per streaming multiprocessor
+	static int max_warps_per_sm;
 
 	// Emu singleton instance
 	static std::unique_ptr<Emulator> instance;
@@ -66,6 +73,10 @@ class Emulator : public comm::Emulator
 	std::list<Grid *> running_grids;
 	std::list<Grid *> finished_grids;
 
+	// Pool of thread-blocks that finished, recycled when new thread-blocks
+	// are started
+	std::vector<std::unique_ptr<ThreadBlock>> thread_block_pool;
+
 	// Memory
 	std::unique_ptr<mem::Memory> global_memory;
 	std::unique_ptr<mem::Memory> constant_memory;
@@ -127,6 +138,26 @@ public:
 	/// Warp size
 	static const int warp_size = 32;
 
+	/// Return the number of streaming multiprocessors
+	static int getNumSms() { return num_sms; }
+
+	/// Return the maximum number of resident thread-blocks per streaming
+	/// multiprocessor
+	static int getMaxThreadBlocksPerSm() { return max_thread_blocks_per_sm; }
+
+	/// Return the maximum number of resident warps per streaming
+	/// multiprocessor
+	static int getMaxWarpsPerSm() { return max_warps_per_sm; }
+
+	/// Set the number of streaming multiprocessors and their residency
+	/// limits. These values are read from the Kepler configuration file
+	/// (option '--kpl-config'), and shared by the emulator, which bounds
+	/// the number of resident thread-blocks with them, and the timing
+	/// model.
+	static void setSmConfiguration(int num_sms,
+			int max_thread_blocks_per_sm,
+			int max_warps_per_sm);
+
 	// Field initialized in constructor. Global memory top address
 	unsigned global_memory_top;
 
@@ -138,6 +169,9 @@ public:
 	/// end of the execution.
 	static Emulator *getInstance();
 
+	/// Destroy the singleton if allocated.
+	static void Destroy();
+
 	/// Get grid list size
 	unsigned getGridSize() { return grids.size(); }
 
@@ -257,6 +291,24 @@ public:
 	/// Push an element into pending grid list
 	void PushPendingGrid(Grid *grid);
 
+	/// Remove the first grid from the pending list and return it, or
+	/// return null if there are no pending grids. This is used by the
+	/// timing simulator, which runs grids itself instead of Run().
+	Grid *PopPendingGrid();
+
+	/// Return the maximum number of thread-blocks of a grid that can be
+	/// resident at the same time, based on the number of streaming
+	/// multiprocessors and their residency limits.
+	unsigned getMaxResidentThreadBlocks(Grid *grid) const;
+
+	/// Return a thread-block initialized with the given arguments, taken
+	/// from the pool of recycled thread-blocks if available.
+	std::unique_ptr<ThreadBlock> AllocateThreadBlock(Grid *grid, int id,
+			unsigned *id_3d);
+
+	/// Return a finished thread-block to the pool
+	void ReleaseThreadBlock(std::unique_ptr<ThreadBlock> thread_block);
+
 	/// Create a new grid to the grid list and return a pointer to it.
 	Grid *addGrid(Function *function);
 
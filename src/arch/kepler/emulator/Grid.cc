@@ -17,6 +17,10 @@
  *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <arch/x86/emulator/Context.h>
+#include <arch/x86/emulator/Emulator.h>
+#include <lib/cpp/Error.h>
+
 #include "Emulator.h"
 #include "Grid.h"
 #include "ThreadBlock.h"
@@ -27,16 +31,25 @@
 namespace Kepler
 {
 
-Grid::Grid(Function *function)
+Grid::Grid(Function *function) :
+		Grid(function->getName(), function->getTextBuffer(),
+				function->getTextSize())
+{
+}
+
+
+Grid::Grid(const std::string &kernel_function_name,
+		const char *text_buffer,
+		int text_size) :
+		kernel_function_name(kernel_function_name)
 {
 	// Initialization
 	this->emulator = emulator->getInstance();
 	id = emulator->getGridSize();
 	const char * temp_buffer;
-	temp_buffer = function->getTextBuffer();
-	instruction_buffer_size = function->getTextSize();
+	temp_buffer = text_buffer;
+	instruction_buffer_size = text_size;
 	instruction_buffer.resize(instruction_buffer_size);
-	kernel_function_name = function->getName();
 
 	// Instruction byte
 	unsigned long long inst_byte;
@@ -87,14 +100,8 @@ void Grid::SetupSize(unsigned *thread_block_count,
 	thread_count = thread_count3[0] * thread_count3[1] *
 			thread_count3[2];
 
-	// Create lists
-
-	//this->pending_thread_blocks = new std::list<std::unique_ptr<ThreadBlock>>;
-	for (unsigned i = 0; i < this->thread_block_count; ++i)
-	{
-		std::unique_ptr<ThreadBlock> tb;
-		pending_thread_blocks.push_back(std::move(tb));
-	}
+	// All thread-blocks pending
+	next_thread_block_id = 0;
 }
 
 
@@ -109,22 +116,59 @@ void Grid::GridSetupConstantMemory()
 					(const char *) &v);
 }
 
-void Grid::WaitingToRunning(int thread_block_id, unsigned *id_3d)
+ThreadBlock *Grid::StartThreadBlock()
+{
+	// Compute 3D identifier
+	assert(next_thread_block_id < thread_block_count);
+	unsigned id = next_thread_block_id++;
+	unsigned id_3d[3];
+	id_3d[0] = id / (thread_block_count3[1] * thread_block_count3[2]);
+	id_3d[1] = (id % (thread_block_count3[1] * thread_block_count3[2])) /
+			thread_block_count3[2];
+	id_3d[2] = (id % (thread_block_count3[1] * thread_block_count3[2])) %
+			thread_block_count3[2];
+
+	// Materialize thread-block
+	running_thread_blocks.push_back(emulator->AllocateThreadBlock(this,
+			id, id_3d));
+	return running_thread_blocks.back().get();
+}
+
+
+std::list<std::unique_ptr<ThreadBlock>>::iterator Grid::FinishThreadBlock(
+		std::list<std::unique_ptr<ThreadBlock>>::iterator it)
 {
-	running_thread_blocks.push_back
-		(std::unique_ptr<ThreadBlock>(new ThreadBlock(this, thread_block_id,
-					id_3d)));
-	pending_thread_blocks.pop_front();
+	emulator->ReleaseThreadBlock(std::move(*it));
+	return running_thread_blocks.erase(it);
 }
 
-void Grid::PushFinishedThreadBlock(std::unique_ptr<ThreadBlock> threadblock)
+
+void Grid::FinishThreadBlock(ThreadBlock *thread_block)
 {
-	finished_thread_blocks.push_back(std::move(threadblock));
+	for (auto it = running_thread_blocks.begin(),
+			e = running_thread_blocks.end(); it != e; ++it)
+	{
+		if (it->get() == thread_block)
+		{
+			FinishThreadBlock(it);
+			return;
+		}
+	}
+	throw misc::Panic("Thread-block not running");
 }
 
-void Grid::PopRunningThreadBlock()
+
+void Grid::WakeupContext()
 {
-	running_thread_blocks.pop_front();
+	if (suspended_pid < 0)
+		return;
+
+	// Resume the context, unless it was killed while waiting
+	x86::Context *context = x86::Emulator::getInstance()->
+			getContext(suspended_pid);
+	if (context && context->isSuspended())
+		context->Wakeup();
+	suspended_pid = -1;
 }
 
 }	//namespace
@@ -20,12 +20,14 @@
 #ifndef ARCH_KEPLER_EMU_GRID_H
 #define ARCH_KEPLER_EMU_GRID_H
 
+#include <cassert>
 #include <iostream>
 #include <list>
 #include <memory>
 #include <vector>
 #include <memory/Memory.h>
 
+#include <arch/common/Context.h>
 #include <arch/kepler/driver/Function.h>
 
 #include "Emulator.h"
@@ -74,10 +76,13 @@ class Grid
 	// GPR usage by a thread
 	unsigned gpr_count;
 
-	// Thread-blocks
-	std::list<std::unique_ptr<ThreadBlock>> pending_thread_blocks;
+	// Identifier of the next thread-block to start. Thread-blocks with a
+	// higher identifier are pending, and are only materialized when
+	// started.
+	unsigned next_thread_block_id = 0;
+
+	// Running thread-blocks
 	std::list<std::unique_ptr<ThreadBlock>> running_thread_blocks;
-	std::list<std::unique_ptr<ThreadBlock>> finished_thread_blocks;
 
 	// Iterators
 	std::list<Grid *>::iterator grid_list_iter;
@@ -94,10 +99,21 @@ class Grid
 	// Shared memory top pointer
 	unsigned shared_memory_top;
 
+	// Pid of the x86 context suspended until the grid completes, or -1 if
+	// none. The context is looked up when the grid completes, since it may
+	// have been destroyed in the meantime.
+	int suspended_pid = -1;
+
 public:
 	/// Constructor
 	Grid(Function *function);
 
+	/// Constructor for a kernel given its name and the ISA section of
+	/// the kernel binary
+	Grid(const std::string &kernel_function_name,
+			const char *text_buffer,
+			int text_size);
+
 	/// Dump the state of the grid in a plain-text format into an output
 	/// stream.
 	void Dump(std::ostream &os = std::cout) const;
@@ -154,10 +170,10 @@ public:
 		return instruction_buffer_size;
 	}
 
-	/// Get pending_thread_blocks size
+	/// Get number of pending thread-blocks
 	unsigned getPendThreadBlocksize() const
 	{
-		return pending_thread_blocks.size();
+		return thread_block_count - next_thread_block_id;
 	}
 
 	/// Get running_thread_blocks size
@@ -173,6 +189,13 @@ public:
 		return running_thread_blocks.begin();
 	}
 
+	/// Get running thread blocks list end
+	std::list<std::unique_ptr<ThreadBlock>>::iterator
+			getRunningThreadBlocksEnd()
+	{
+		return running_thread_blocks.end();
+	}
+
 	// Setters
 	//
 
@@ -187,15 +210,36 @@ public:
 	/// Write initial values into constant memory. Used by driver.
 	void GridSetupConstantMemory();
 
-	/// pop an element from pending thread block list,
-	/// and create a new thread block pushing into running thread block list
-	void WaitingToRunning(int thread_block_id, unsigned *id_3d);
+	/// Start the next pending thread-block, obtaining a thread-block
+	/// object from the emulator pool and adding it to the running list.
+	ThreadBlock *StartThreadBlock();
 
-	/// push a thread block into finished thread block list
-	void PushFinishedThreadBlock(std::unique_ptr<ThreadBlock> threadblock);
+	/// Remove a finished thread-block from the running list, returning it
+	/// to the emulator pool. The function returns an iterator to the next
+	/// running thread-block.
+	std::list<std::unique_ptr<ThreadBlock>>::iterator FinishThreadBlock(
+			std::list<std::unique_ptr<ThreadBlock>>::iterator it);
+
+	/// Remove the given finished thread-block from the running list,
+	/// returning it to the emulator pool.
+	void FinishThreadBlock(ThreadBlock *thread_block);
+
+	/// Return whether all thread-blocks of the grid have finished
+	bool isFinished() const
+	{
+		return !getPendThreadBlocksize() && running_thread_blocks.empty();
+	}
+
+	/// Record a guest context that is suspended until the grid completes.
+	/// The context is woken up by a call to WakeupContext().
+	void setSuspendedContext(comm::Context *context)
+	{
+		assert(suspended_pid < 0);
+		suspended_pid = context->getId();
+	}
 
-	/// pop the front thread block out of running thread block list
-	void PopRunningThreadBlock();
+	/// Wake up the context suspended on this grid, if any
+	void WakeupContext();
 };
 
 }   //namespace
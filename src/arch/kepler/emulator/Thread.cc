@@ -27,10 +27,38 @@
 namespace Kepler
 {
 
+Thread::InstFunc Thread::inst_func[Instruction::OpcodeCount];
+
+bool Thread::inst_func_initialized = false;
+
+
 Thread::Thread(Warp *warp, int id)
 {
 	// Initialization
 	this->emulator = emulator->getInstance();
+
+	// Local Memory Initialization
+	local_memory = misc::new_unique<mem::Memory>();
+	local_memory->setSafe(false);
+
+	// Initialization instruction table
+	if (!inst_func_initialized)
+	{
+#define DEFINST(_name, _fmt_str, ...) \
+		inst_func[Instruction::INST_##_name] = &Thread::ExecuteInst_##_name;
+#include "../disassembler/Instruction.def"
+#undef DEFINST
+		inst_func_initialized = true;
+	}
+
+	// Initialize state
+	Reset(warp, id);
+}
+
+
+void Thread::Reset(Warp *warp, int id)
+{
+	// Initialization
 	this->warp = warp;
 	thread_block = warp->getThreadBlock();
 	grid = thread_block->getGrid();
@@ -38,9 +66,8 @@ Thread::Thread(Warp *warp, int id)
 	id_in_warp = id % warp_size;
 	id_in_thread_block = id;
 
-	// Local Memory Initialization
-	local_memory = misc::new_unique<mem::Memory>();
-	local_memory->setSafe(false);
+	// Discard local memory contents of a previous use
+	local_memory->Clear();
 	local_memory_size = 1 << 20; // current 1MB for local memory
 	local_memory_top_address = 0;
 	local_memory_top_generic_address = local_memory_top_address + id *
@@ -51,12 +78,6 @@ Thread::Thread(Warp *warp, int id)
 	emulator->WriteConstantMemory(0x24, sizeof(unsigned),
 			(const char *) &local_memory_top_generic_address);
 
-	// Initialization instruction table
-#define DEFINST(_name, _fmt_str, ...) \
-		inst_func[Instruction::INST_##_name] = &Thread::ExecuteInst_##_name;
-#include "../disassembler/Instruction.def"
-#undef DEFINST
-
 	// Initialize  general purpose registers
 	for (int i = 0; i < 256; ++i)
 		WriteGPR(i, 0);
@@ -119,6 +140,9 @@ Thread::Thread(Warp *warp, int id)
 
 void Thread::Execute(Instruction::Opcode opcode, Instruction *inst)
 {
+	// Forget last global memory access
+	global_memory_access_size = 0;
+
 	(this->*(inst_func[opcode]))(inst);
 }
 
@@ -89,9 +89,11 @@ private:
 	// Registers
 	Register registers;
 
-	// Last global memory access
-	unsigned global_memory_access_address;
-	unsigned global_memory_access_size;
+	// Global memory access performed by the last instruction, used by
+	// the timing simulator. The size is 0 if the last instruction did not
+	// access global memory.
+	unsigned global_memory_access_address = 0;
+	unsigned global_memory_access_size = 0;
 
 	// Local Memory
 	std::unique_ptr<mem::Memory> local_memory;
@@ -117,9 +119,10 @@ private:
 	// FIXME in the future
 	void ExecuteInst_Special();
 
-	// Instruction execution table
+	// Instruction execution table, shared by all threads
 	typedef void (Thread::*InstFunc)(Instruction *inst);
-	InstFunc inst_func[Instruction::OpcodeCount];
+	static InstFunc inst_func[Instruction::OpcodeCount];
+	static bool inst_func_initialized;
 
 	// Error massage for unimplemented instructions
 	static void ISAUnimplemented(Instruction *inst);
@@ -135,6 +138,10 @@ public :
 	/// \id Global 1D identifier of the thread
 	Thread(Warp *warp, int id);
 
+	/// Reinitialize the thread as if it was just constructed with the
+	/// given arguments. Used when thread-blocks are recycled.
+	void Reset(Warp *warp, int id);
+
 	/// Get global id
 	unsigned getId() const { return id; }
 
@@ -227,6 +234,21 @@ public :
 	/// Get the warp the thread belong to
 	Warp* getWarp() const { return warp; }
 
+	/// Return the global memory address accessed by the last instruction
+	/// executed by the thread
+	unsigned getGlobalMemoryAccessAddress() const
+	{
+		return global_memory_access_address;
+	}
+
+	/// Return the number of bytes of global memory accessed by the last
+	/// instruction executed by the thread, or 0 if the instruction did not
+	/// access global memory
+	unsigned getGlobalMemoryAccessSize() const
+	{
+		return global_memory_access_size;
+	}
+
 	/// Set value of the active thread mask
 	/// \param value Value given as an \a unsigned typed value
 	void SetActive(unsigned value);
@@ -34,10 +34,20 @@ namespace Kepler
 
 ThreadBlock::ThreadBlock(Grid *grid, int id, unsigned *id_3d)
 {
-
-	//Warp *warp;
-	//Thread *thread;
+	// Initialization
 	this->emulator = emulator->getInstance();
+
+	// Shared Memory Initialization
+	shared_memory = misc::new_unique<mem::Memory>();
+	shared_memory->setSafe(false);
+
+	// Initialize state
+	Reset(grid, id, id_3d);
+}
+
+
+void ThreadBlock::Reset(Grid *grid, int id, unsigned *id_3d)
+{
 	int warp_count;
 	int thread_count;
 
@@ -47,18 +57,36 @@ ThreadBlock::ThreadBlock(Grid *grid, int id, unsigned *id_3d)
 	for(int i = 0; i < 3; i++)
 		this->id_3d[i] = id_3d[i];
 
-	// Create warps
+	// Warps and threads are reused if the thread-block size did not
+	// change since the last use of the thread-block. Otherwise, they are
+	// created again.
 	warp_count = (grid->getThreadBlockSize() + warp_size - 1) /
 			warp_size;
-	for (int i = 0; i < warp_count; ++i)
-		warps.push_back(std::unique_ptr<Warp>(new
-				Warp(this, i)));
-
-	// Create threads
 	thread_count = grid->getThreadBlockSize();
-	for (int i = 0; i < thread_count; ++i)
-		threads.push_back(std::unique_ptr<Thread>(new
-				Thread(warps[i / warp_size].get(), i)));
+	if ((int) threads.size() == thread_count)
+	{
+		// Reset warps
+		for (int i = 0; i < warp_count; ++i)
+			warps[i]->Reset(this, i);
+
+		// Reset threads
+		for (int i = 0; i < thread_count; ++i)
+			threads[i]->Reset(warps[i / warp_size].get(), i);
+	}
+	else
+	{
+		// Create warps
+		warps.clear();
+		for (int i = 0; i < warp_count; ++i)
+			warps.push_back(std::unique_ptr<Warp>(new
+					Warp(this, i)));
+
+		// Create threads
+		threads.clear();
+		for (int i = 0; i < thread_count; ++i)
+			threads.push_back(std::unique_ptr<Thread>(new
+					Thread(warps[i / warp_size].get(), i)));
+	}
 
 	/* Set warps' beginning thread and ending thread */
 	for (int i = 0; i < warp_count - 1; ++i)
@@ -71,18 +99,15 @@ ThreadBlock::ThreadBlock(Grid *grid, int id, unsigned *id_3d)
 	warps[warp_count - 1]->setThreadEnd
 		(threads.end());
 
-	// Shared Memory Initialization
-	shared_memory = misc::new_unique<mem::Memory>();
-	shared_memory->setSafe(false);
+	// Discard shared memory contents of a previous use
+	shared_memory->Clear();
 	shared_memory_size = (1 << 20); // current 1MB for local memory
 	shared_memory_top_address = 0;
 	shared_memory_top_generic_address = shared_memory_top_address + id *
 				shared_memory_size + emulator->getGlobalMemoryTotalSize();
 
 	// Shared memory top generic address is recorded in constant memory
-	// c[0x0][0x20]
-	emulator->WriteConstantMemory(0x20, sizeof(unsigned),
-			(char *) &shared_memory_top_generic_address);
+	Activate();
 
 	/* Flags */
 	finished_emu = false;
@@ -93,6 +118,15 @@ ThreadBlock::ThreadBlock(Grid *grid, int id, unsigned *id_3d)
 	num_warps_completed_timing = 0;
 }
 
+
+void ThreadBlock::Activate()
+{
+	// Shared memory top generic address is recorded in constant memory
+	// c[0x0][0x20]
+	emulator->WriteConstantMemory(0x20, sizeof(unsigned),
+			(char *) &shared_memory_top_generic_address);
+}
+
 unsigned ThreadBlock::getWarpCount() const
 {
     return (grid->getThreadBlockSize() + warp_size - 1) /
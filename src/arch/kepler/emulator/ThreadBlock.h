@@ -109,6 +109,18 @@ public:
 	/// \param id Thread-block global 1D ID
 	ThreadBlock(Grid *grid, int id, unsigned *id_3d);
 
+	/// Reinitialize the thread-block as if it was just constructed with
+	/// the given arguments. Warps, threads, and memories are reused when
+	/// possible. Used to recycle thread-blocks through the pool kept by
+	/// the emulator.
+	void Reset(Grid *grid, int id, unsigned *id_3d);
+
+	/// Write the thread-block specific values of constant memory. Since
+	/// the constant memory is shared by all thread-blocks, this function
+	/// must be invoked before executing instructions of a thread-block
+	/// when several thread-blocks are resident.
+	void Activate();
+
 	/// Dump thread-block in human readable format into output stream
 	void Dump(std::ostream &os = std::cout) const;
 
@@ -3415,7 +3415,13 @@ void Thread::ExecuteInst_LD(Instruction *inst)
 			thread_block->ReadFromSharedMemory(shared_memory_addr, 4, (char*)dst);
 		}
 		else
-			emulator->ReadGlobalMemory(addr, 4, (char*)dst); // Global Memory
+		{
+			// Global Memory
+			emulator->ReadGlobalMemory(addr, 4, (char*)dst);
+			global_memory_access_address = addr;
+			global_memory_access_size = data_type > 5 ? 16 :
+					data_type > 4 ? 8 : 4;
+		}
 
 		// Data type > 4
 		if (data_type > 4)
@@ -3800,7 +3806,13 @@ void Thread::ExecuteInst_ST(Instruction *inst)
 			thread_block->WriteToSharedMemory(shared_memory_addr, 4, (char*)src);
 		}
 		else
+		{
+			// Global Memory
 			emulator->WriteGlobalMemory(addr, 4, (char*)src);
+			global_memory_access_address = addr;
+			global_memory_access_size = data_type > 5 ? 16 :
+					data_type > 4 ? 8 : 4;
+		}
 
 		// Data type > 4
 		if (data_type > 4)
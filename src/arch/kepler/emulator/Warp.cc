@@ -36,7 +36,12 @@ namespace Kepler
 
 Warp::Warp(ThreadBlock *thread_block, unsigned id):inst(Instruction())
 {
+	Reset(thread_block, id);
+}
+
 
+void Warp::Reset(ThreadBlock *thread_block, unsigned id)
+{
 	unsigned am = 0;
 
 	// Initialization
@@ -150,6 +150,10 @@ public:
 	///	Global 1D identifier of the warp
 	Warp(ThreadBlock *thread_block, unsigned id);
 
+	/// Reinitialize the warp as if it was just constructed with the
+	/// given arguments. Used when thread-blocks are recycled.
+	void Reset(ThreadBlock *thread_block, unsigned id);
+
 	/// Return the global warp 1D ID
 	int getId() const { return id; }
 
@@ -197,6 +201,15 @@ public:
 	/// Get inst_size
 	int getInstructionSize() const {return inst_size;}
 
+	/// Return the last instruction decoded by Execute(). This is used by
+	/// the timing simulator to classify the instruction just emulated.
+	Instruction *getInstruction() { return &inst; }
+
+	/// Return whether the instruction at the current program counter is
+	/// a scheduling control word, which is emulated by Execute() but does
+	/// not correspond to an actual instruction.
+	bool isControlWord() const { return !(pc % 64); }
+
 	//////////////////////////////////////////////////////////////
 
 	// Setters
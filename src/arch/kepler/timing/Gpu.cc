@@ -0,0 +1,107 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <arch/kepler/emulator/Emulator.h>
+#include <arch/kepler/emulator/Grid.h>
+#include <lib/cpp/Misc.h>
+
+#include "Gpu.h"
+#include "Timing.h"
+
+
+namespace Kepler
+{
+
+long long Gpu::max_cycles = 0;
+
+
+Gpu::Gpu(Timing *timing) : timing(timing)
+{
+	// Create streaming multiprocessors
+	for (int i = 0; i < Emulator::getNumSms(); i++)
+		sms.emplace_back(misc::new_unique<SM>(this, i));
+
+	// Create MMU and the address space of the global memory
+	mmu = misc::new_unique<mem::Mmu>("Kepler");
+	address_space = mmu->newSpace("Kepler");
+}
+
+
+void Gpu::MapThreadBlocks()
+{
+	while (grid->getPendThreadBlocksize())
+	{
+		// Find a streaming multiprocessor with room, starting after
+		// the one that received the last thread-block
+		SM *sm = nullptr;
+		int num_sms = sms.size();
+		for (int i = 0; i < num_sms; i++)
+		{
+			SM *candidate = sms[(next_sm + i) % num_sms].get();
+			if (candidate->canMapThreadBlock(grid))
+			{
+				sm = candidate;
+				break;
+			}
+		}
+		if (!sm)
+			return;
+
+		// Start thread-block and map it
+		ThreadBlock *thread_block = grid->StartThreadBlock();
+		sm->MapThreadBlock(thread_block);
+		next_sm = (sm->getIndex() + 1) % num_sms;
+	}
+}
+
+
+bool Gpu::Run()
+{
+	// Start next grid
+	if (!grid)
+	{
+		Emulator *emulator = Emulator::getInstance();
+		grid = emulator->PopPendingGrid();
+		if (!grid)
+			return false;
+		num_grids++;
+		Timing::pipeline_debug << misc::fmt("\t\t@%lld grid=%d "
+				"start\n", timing->getCycle(), grid->getID());
+	}
+
+	// Map thread-blocks and run streaming multiprocessors
+	MapThreadBlocks();
+	for (auto &sm : sms)
+		sm->Run();
+
+	// Grid finished, wake up the guest context waiting for it
+	if (grid->isFinished())
+	{
+		Timing::pipeline_debug << misc::fmt("\t\t@%lld grid=%d "
+				"finish\n", timing->getCycle(), grid->getID());
+		grid->WakeupContext();
+		grid = nullptr;
+	}
+
+	// Still running
+	return true;
+}
+
+
+}  // namespace Kepler
@@ -0,0 +1,112 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef ARCH_KEPLER_TIMING_GPU_H
+#define ARCH_KEPLER_TIMING_GPU_H
+
+#include <cassert>
+#include <memory>
+#include <vector>
+
+#include <memory/Mmu.h>
+
+#include "SM.h"
+
+
+namespace Kepler
+{
+
+// Forward declarations
+class Grid;
+class Timing;
+
+
+/// Class representing a Kepler GPU device
+class Gpu
+{
+	// Timing simulator the GPU belongs to
+	Timing *timing;
+
+	// Streaming multiprocessors
+	std::vector<std::unique_ptr<SM>> sms;
+
+	// MMU used by this GPU
+	std::unique_ptr<mem::Mmu> mmu;
+
+	// Address space of the global memory
+	mem::Mmu::Space *address_space;
+
+	// Grid currently running, or null if none. Grids run one at a time,
+	// since they share the constant memory.
+	Grid *grid = nullptr;
+
+	// Streaming multiprocessor considered first for the next thread-block
+	int next_sm = 0;
+
+	// Map pending thread-blocks of the running grid to streaming
+	// multiprocessors with room for them
+	void MapThreadBlocks();
+
+public:
+
+	/// Maximum number of cycles, as set by option '--kpl-max-cycles'
+	static long long max_cycles;
+
+	/// Number of grids run
+	long long num_grids = 0;
+
+	/// Constructor
+	Gpu(Timing *timing);
+
+	/// Return the timing simulator the GPU belongs to
+	Timing *getTiming() const { return timing; }
+
+	/// Return the MMU
+	mem::Mmu *getMmu() const { return mmu.get(); }
+
+	/// Return the address space of the global memory
+	mem::Mmu::Space *getAddressSpace() const { return address_space; }
+
+	/// Return the streaming multiprocessor with the given index
+	SM *getSM(int index) const
+	{
+		assert(index >= 0 && index < (int) sms.size());
+		return sms[index].get();
+	}
+
+	/// Return an iterator to the first streaming multiprocessor
+	std::vector<std::unique_ptr<SM>>::const_iterator getSMsBegin() const
+	{
+		return sms.begin();
+	}
+
+	/// Return a past-the-end iterator to the streaming multiprocessors
+	std::vector<std::unique_ptr<SM>>::const_iterator getSMsEnd() const
+	{
+		return sms.end();
+	}
+
+	/// Run one cycle of the GPU. Return false if there was no grid to run.
+	bool Run();
+};
+
+
+}  // namespace Kepler
+
+#endif
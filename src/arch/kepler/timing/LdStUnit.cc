@@ -0,0 +1,117 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "Gpu.h"
+#include "LdStUnit.h"
+#include "SM.h"
+#include "Timing.h"
+
+
+namespace Kepler
+{
+
+int LdStUnit::width = 4;
+int LdStUnit::max_in_flight_instructions = 16;
+int LdStUnit::shared_memory_latency = 24;
+
+
+void LdStUnit::Accept(std::unique_ptr<Uop> uop)
+{
+	// Shared and local memory complete after a fixed latency
+	uop->ready_cycle = sm->getCycle() + shared_memory_latency;
+	uops.push_back(std::move(uop));
+}
+
+
+int LdStUnit::IssueAccesses(Uop *uop, int max_accesses)
+{
+	Gpu *gpu = sm->getGpu();
+	int num_accesses = 0;
+	while (num_accesses < max_accesses &&
+			!uop->global_memory_addresses.empty())
+	{
+		// Translate address
+		unsigned address = uop->global_memory_addresses.front();
+		unsigned physical_address = gpu->getMmu()->
+				TranslateVirtualAddress(gpu->getAddressSpace(),
+				address);
+
+		// Stall if the cache cannot accept the access
+		if (!sm->cache->canAccess(physical_address))
+			break;
+
+		// Access
+		uop->global_memory_witness--;
+		sm->cache->Access(uop->access_type, physical_address,
+				&uop->global_memory_witness);
+		uop->global_memory_addresses.pop_front();
+		sm->num_cache_accesses++;
+		num_accesses++;
+
+		// Debug
+		Timing::pipeline_debug << misc::fmt("\t\t@%lld sm=%d "
+				"uop=%lld access addr=0x%x\n",
+				sm->getCycle(), sm->getIndex(), uop->getId(),
+				address);
+	}
+	return num_accesses;
+}
+
+
+void LdStUnit::Run()
+{
+	long long cycle = sm->getCycle();
+	int num_accesses = 0;
+	for (auto it = uops.begin(); it != uops.end(); )
+	{
+		// Issue pending accesses of global memory instructions, in
+		// program order and up to the width of the unit
+		Uop *uop = it->get();
+		bool complete;
+		if (uop->getType() == Uop::TypeGlobalMemory)
+		{
+			num_accesses += IssueAccesses(uop, width - num_accesses);
+			complete = uop->global_memory_addresses.empty() &&
+					!uop->global_memory_witness;
+		}
+		else
+		{
+			complete = cycle >= uop->ready_cycle;
+		}
+
+		// Not complete yet
+		if (!complete)
+		{
+			++it;
+			continue;
+		}
+
+		// Release the warp
+		WarpScheduler::WarpEntry *warp_entry = uop->getWarpEntry();
+		warp_entry->ready_cycle = cycle;
+		warp_entry->in_flight = false;
+		Timing::pipeline_debug << misc::fmt("\t\t@%lld sm=%d uop=%lld "
+				"complete\n", cycle, sm->getIndex(),
+				uop->getId());
+		it = uops.erase(it);
+	}
+}
+
+
+}  // namespace Kepler
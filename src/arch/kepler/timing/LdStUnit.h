@@ -0,0 +1,90 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef ARCH_KEPLER_TIMING_LD_ST_UNIT_H
+#define ARCH_KEPLER_TIMING_LD_ST_UNIT_H
+
+#include <list>
+#include <memory>
+
+#include "Uop.h"
+
+
+namespace Kepler
+{
+
+// Forward declarations
+class SM;
+
+
+/// Load/store unit of a streaming multiprocessor. Global memory instructions
+/// access the memory hierarchy through the entry module of the streaming
+/// multiprocessor, one coalesced cache block at a time. Shared and local
+/// memory instructions complete after a fixed latency.
+class LdStUnit
+{
+	// Streaming multiprocessor the unit belongs to
+	SM *sm;
+
+	// Instructions in flight
+	std::list<std::unique_ptr<Uop>> uops;
+
+	// Issue pending cache accesses of a global memory instruction, up to
+	// the given number of accesses. Return the number of accesses issued.
+	int IssueAccesses(Uop *uop, int max_accesses);
+
+public:
+
+	/// Number of cache accesses issued per cycle, as set in the
+	/// configuration file
+	static int width;
+
+	/// Maximum number of instructions in flight, as set in the
+	/// configuration file
+	static int max_in_flight_instructions;
+
+	/// Latency of shared memory instructions in cycles, as set in the
+	/// configuration file
+	static int shared_memory_latency;
+
+	/// Constructor
+	LdStUnit(SM *sm) : sm(sm)
+	{
+	}
+
+	/// Return whether the unit can accept a new instruction
+	bool canAccept() const
+	{
+		return (int) uops.size() < max_in_flight_instructions;
+	}
+
+	/// Return whether no instruction is in flight
+	bool isEmpty() const { return uops.empty(); }
+
+	/// Accept a memory instruction dispatched by the operand collector
+	void Accept(std::unique_ptr<Uop> uop);
+
+	/// Issue memory accesses and complete instructions, run once per cycle
+	void Run();
+};
+
+
+}  // namespace Kepler
+
+#endif
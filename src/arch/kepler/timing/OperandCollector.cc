@@ -0,0 +1,140 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <lib/cpp/Error.h>
+
+#include "OperandCollector.h"
+#include "SM.h"
+#include "Timing.h"
+
+
+namespace Kepler
+{
+
+int OperandCollector::num_banks = 4;
+int OperandCollector::num_units = 8;
+
+
+OperandCollector::OperandCollector(SM *sm) : sm(sm)
+{
+	units.resize(num_units);
+}
+
+
+bool OperandCollector::canAccept() const
+{
+	for (auto &uop : units)
+		if (!uop)
+			return true;
+	return false;
+}
+
+
+void OperandCollector::Accept(std::unique_ptr<Uop> uop)
+{
+	for (auto &unit : units)
+	{
+		if (!unit)
+		{
+			unit = std::move(uop);
+			return;
+		}
+	}
+	throw misc::Panic("No free collector unit");
+}
+
+
+bool OperandCollector::Dispatch(std::unique_ptr<Uop> &uop)
+{
+	// Memory instructions go to the load/store unit
+	long long cycle = sm->getCycle();
+	Uop::Type type = uop->getType();
+	if (type == Uop::TypeSharedMemory || type == Uop::TypeGlobalMemory)
+	{
+		LdStUnit *ldst_unit = sm->getLdStUnit();
+		if (!ldst_unit->canAccept())
+			return false;
+		ldst_unit->Accept(std::move(uop));
+		return true;
+	}
+
+	// Other instructions complete after the latency of their unit
+	int latency;
+	switch (type)
+	{
+	case Uop::TypeAlu: latency = SM::alu_latency; break;
+	case Uop::TypeSfu: latency = SM::sfu_latency; break;
+	case Uop::TypeBranch: latency = SM::branch_latency; break;
+	default: throw misc::Panic("Invalid uop type");
+	}
+	WarpScheduler::WarpEntry *warp_entry = uop->getWarpEntry();
+	warp_entry->ready_cycle = cycle + latency;
+	warp_entry->in_flight = false;
+
+	// Debug
+	Timing::pipeline_debug << misc::fmt("\t\t@%lld sm=%d uop=%lld "
+			"dispatch latency=%d\n", cycle, sm->getIndex(),
+			uop->getId(), latency);
+
+	// Done
+	uop = nullptr;
+	return true;
+}
+
+
+void OperandCollector::Run()
+{
+	// Banks read in this cycle
+	std::vector<bool> bank_busy(num_banks);
+
+	// Collector units are served in rotating priority order
+	for (int i = 0; i < num_units; i++)
+	{
+		std::unique_ptr<Uop> &uop = units[(next_unit + i) % num_units];
+		if (!uop)
+			continue;
+
+		// Read operands from free banks
+		auto &source_registers = uop->source_registers;
+		for (auto it = source_registers.begin();
+				it != source_registers.end(); )
+		{
+			int bank = *it % num_banks;
+			if (bank_busy[bank])
+			{
+				sm->num_bank_conflicts++;
+				++it;
+				continue;
+			}
+			bank_busy[bank] = true;
+			sm->num_register_reads++;
+			it = source_registers.erase(it);
+		}
+
+		// Dispatch when all operands are read
+		if (source_registers.empty())
+			Dispatch(uop);
+	}
+
+	// Rotate priority
+	next_unit = (next_unit + 1) % num_units;
+}
+
+
+}  // namespace Kepler
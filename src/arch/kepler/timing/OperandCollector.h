@@ -0,0 +1,81 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef ARCH_KEPLER_TIMING_OPERAND_COLLECTOR_H
+#define ARCH_KEPLER_TIMING_OPERAND_COLLECTOR_H
+
+#include <memory>
+#include <vector>
+
+#include "Uop.h"
+
+
+namespace Kepler
+{
+
+// Forward declarations
+class SM;
+
+
+/// Operand collector of a streaming multiprocessor. Issued instructions are
+/// held in collector units while their source operands are read from the
+/// banks of the register file. Each bank serves one read per cycle, so
+/// instructions reading registers from the same bank are delayed. Once all
+/// operands are read, the instruction is dispatched to its functional unit.
+class OperandCollector
+{
+	// Streaming multiprocessor the collector belongs to
+	SM *sm;
+
+	// Collector units, each holding one instruction or null
+	std::vector<std::unique_ptr<Uop>> units;
+
+	// Collector unit given priority for register file banks in the next
+	// cycle, rotated every cycle so that no unit starves
+	int next_unit = 0;
+
+	// Dispatch an instruction whose operands were all read. Return false
+	// if the functional unit cannot accept it in this cycle.
+	bool Dispatch(std::unique_ptr<Uop> &uop);
+
+public:
+
+	/// Number of register file banks, as set in the configuration file
+	static int num_banks;
+
+	/// Number of collector units, as set in the configuration file
+	static int num_units;
+
+	/// Constructor
+	OperandCollector(SM *sm);
+
+	/// Return whether a collector unit is free
+	bool canAccept() const;
+
+	/// Place an issued instruction in a free collector unit
+	void Accept(std::unique_ptr<Uop> uop);
+
+	/// Read operands and dispatch instructions, run once per cycle
+	void Run();
+};
+
+
+}  // namespace Kepler
+
+#endif
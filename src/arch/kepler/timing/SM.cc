@@ -0,0 +1,154 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+
+#include <arch/kepler/emulator/Grid.h>
+#include <arch/kepler/emulator/ThreadBlock.h>
+#include <arch/kepler/emulator/Warp.h>
+#include <lib/cpp/Misc.h>
+
+#include "Gpu.h"
+#include "SM.h"
+#include "Timing.h"
+
+
+namespace Kepler
+{
+
+misc::StringMap SM::scheduling_policy_map =
+{
+	{ "LRR", SchedulingPolicyLrr },
+	{ "GTO", SchedulingPolicyGto }
+};
+
+int SM::num_warp_schedulers = 4;
+SM::SchedulingPolicy SM::scheduling_policy = SchedulingPolicyGto;
+int SM::alu_latency = 9;
+int SM::sfu_latency = 18;
+int SM::branch_latency = 6;
+
+
+SM::SM(Gpu *gpu, int index) :
+		gpu(gpu),
+		index(index)
+{
+	// Create pipeline
+	for (int i = 0; i < num_warp_schedulers; i++)
+		warp_schedulers.emplace_back(misc::new_unique<WarpScheduler>(
+				this, i));
+	operand_collector = misc::new_unique<OperandCollector>(this);
+	ldst_unit = misc::new_unique<LdStUnit>(this);
+}
+
+
+long long SM::getCycle() const
+{
+	return gpu->getTiming()->getCycle();
+}
+
+
+bool SM::canMapThreadBlock(Grid *grid) const
+{
+	int warps_per_thread_block = (grid->getThreadBlockSize() +
+			Emulator::warp_size - 1) / Emulator::warp_size;
+	return (int) thread_blocks.size() <
+			Emulator::getMaxThreadBlocksPerSm() &&
+			num_warps + warps_per_thread_block <=
+			Emulator::getMaxWarpsPerSm();
+}
+
+
+void SM::MapThreadBlock(ThreadBlock *thread_block)
+{
+	// Distribute warps among schedulers
+	for (auto it = thread_block->WarpsBegin(), e = thread_block->WarpsEnd();
+			it != e; ++it)
+	{
+		warp_schedulers[next_warp_scheduler]->AddWarp(it->get(),
+				num_mapped_warps++);
+		next_warp_scheduler = (next_warp_scheduler + 1) %
+				num_warp_schedulers;
+	}
+
+	// Make resident
+	thread_blocks.push_back(thread_block);
+	num_warps += thread_block->getWarpCount();
+	num_mapped_thread_blocks++;
+
+	// Debug
+	Timing::pipeline_debug << misc::fmt("\t\t@%lld sm=%d "
+			"thread_block=%d mapped warps=%d\n",
+			getCycle(), index, thread_block->getId(),
+			thread_block->getWarpCount());
+}
+
+
+void SM::UnmapFinishedThreadBlocks()
+{
+	for (auto it = thread_blocks.begin(); it != thread_blocks.end(); )
+	{
+		// Check that all warps finished, and that their last
+		// instructions left the pipeline
+		ThreadBlock *thread_block = *it;
+		bool finished = thread_block->getNumWarpsCompletedEmu() ==
+				thread_block->getWarpCount();
+		for (auto &warp_scheduler : warp_schedulers)
+			if (warp_scheduler->isInFlight(thread_block))
+				finished = false;
+		if (!finished)
+		{
+			++it;
+			continue;
+		}
+
+		// Debug
+		Timing::pipeline_debug << misc::fmt("\t\t@%lld sm=%d "
+				"thread_block=%d finished\n",
+				getCycle(), index, thread_block->getId());
+
+		// Release thread-block
+		for (auto &warp_scheduler : warp_schedulers)
+			warp_scheduler->RemoveWarps(thread_block);
+		num_warps -= thread_block->getWarpCount();
+		it = thread_blocks.erase(it);
+		thread_block->getGrid()->FinishThreadBlock(thread_block);
+	}
+}
+
+
+void SM::Run()
+{
+	// Nothing to do
+	if (thread_blocks.empty())
+		return;
+
+	// Pipeline stages run in reverse order, so that an instruction
+	// advances at most one stage per cycle
+	ldst_unit->Run();
+	operand_collector->Run();
+	for (auto &warp_scheduler : warp_schedulers)
+		warp_scheduler->Run();
+
+	// Release finished thread-blocks
+	UnmapFinishedThreadBlocks();
+}
+
+
+}  // namespace Kepler
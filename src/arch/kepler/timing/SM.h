@@ -0,0 +1,196 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef ARCH_KEPLER_TIMING_SM_H
+#define ARCH_KEPLER_TIMING_SM_H
+
+#include <list>
+#include <memory>
+#include <vector>
+
+#include <lib/cpp/String.h>
+#include <memory/Module.h>
+
+#include "LdStUnit.h"
+#include "OperandCollector.h"
+#include "WarpScheduler.h"
+
+
+namespace Kepler
+{
+
+// Forward declarations
+class Gpu;
+class Grid;
+class ThreadBlock;
+
+
+/// Streaming multiprocessor of a Kepler GPU
+class SM
+{
+public:
+
+	/// Warp scheduling policy
+	enum SchedulingPolicy
+	{
+		SchedulingPolicyInvalid = 0,
+		SchedulingPolicyLrr,
+		SchedulingPolicyGto
+	};
+
+	/// String map for SchedulingPolicy
+	static misc::StringMap scheduling_policy_map;
+
+private:
+
+	// GPU the streaming multiprocessor belongs to
+	Gpu *gpu;
+
+	// Index of the streaming multiprocessor in the GPU
+	int index;
+
+	// Warp schedulers
+	std::vector<std::unique_ptr<WarpScheduler>> warp_schedulers;
+
+	// Operand collector
+	std::unique_ptr<OperandCollector> operand_collector;
+
+	// Load/store unit
+	std::unique_ptr<LdStUnit> ldst_unit;
+
+	// Resident thread-blocks
+	std::list<ThreadBlock *> thread_blocks;
+
+	// Number of resident warps
+	int num_warps = 0;
+
+	// Number of warps that became resident so far, used to assign ages
+	long long num_mapped_warps = 0;
+
+	// Number of uops created so far, used to assign identifiers
+	long long num_uops = 0;
+
+	// Warp scheduler that receives the next warp
+	int next_warp_scheduler = 0;
+
+	// Release resident thread-blocks whose warps have all finished
+	void UnmapFinishedThreadBlocks();
+
+public:
+
+	//
+	// Configuration
+	//
+
+	/// Number of warp schedulers
+	static int num_warp_schedulers;
+
+	/// Warp scheduling policy
+	static SchedulingPolicy scheduling_policy;
+
+	/// Latency of arithmetic instructions
+	static int alu_latency;
+
+	/// Latency of special function unit instructions
+	static int sfu_latency;
+
+	/// Latency of branch and control instructions
+	static int branch_latency;
+
+
+	//
+	// Statistics
+	//
+
+	/// Number of thread-blocks mapped
+	long long num_mapped_thread_blocks = 0;
+
+	/// Number of instructions issued
+	long long num_instructions = 0;
+
+	/// Number of arithmetic instructions issued
+	long long num_alu_instructions = 0;
+
+	/// Number of special function unit instructions issued
+	long long num_sfu_instructions = 0;
+
+	/// Number of branch and control instructions issued
+	long long num_branch_instructions = 0;
+
+	/// Number of shared and local memory instructions issued
+	long long num_shared_memory_instructions = 0;
+
+	/// Number of global memory instructions issued
+	long long num_global_memory_instructions = 0;
+
+	/// Number of cache accesses issued to the memory hierarchy
+	long long num_cache_accesses = 0;
+
+	/// Number of register file reads
+	long long num_register_reads = 0;
+
+	/// Number of register reads delayed by a bank conflict
+	long long num_bank_conflicts = 0;
+
+
+	/// Entry module into the memory hierarchy
+	mem::Module *cache = nullptr;
+
+	/// Constructor
+	SM(Gpu *gpu, int index);
+
+	/// Return the GPU the streaming multiprocessor belongs to
+	Gpu *getGpu() const { return gpu; }
+
+	/// Return the index of the streaming multiprocessor in the GPU
+	int getIndex() const { return index; }
+
+	/// Return the operand collector
+	OperandCollector *getOperandCollector() const
+	{
+		return operand_collector.get();
+	}
+
+	/// Return the load/store unit
+	LdStUnit *getLdStUnit() const { return ldst_unit.get(); }
+
+	/// Return the current cycle in the frequency domain of the GPU
+	long long getCycle() const;
+
+	/// Return a new unique identifier for a uop
+	long long getNewUopId() { return num_uops++; }
+
+	/// Return whether there is room for a thread-block of the grid
+	bool canMapThreadBlock(Grid *grid) const;
+
+	/// Make a thread-block resident, distributing its warps among the
+	/// warp schedulers
+	void MapThreadBlock(ThreadBlock *thread_block);
+
+	/// Return whether no thread-block is resident
+	bool isIdle() const { return thread_blocks.empty(); }
+
+	/// Run one cycle of the pipeline
+	void Run();
+};
+
+
+}  // namespace Kepler
+
+#endif
@@ -0,0 +1,616 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <arch/common/Arch.h>
+#include <arch/kepler/emulator/Emulator.h>
+#include <lib/cpp/CommandLine.h>
+#include <memory/System.h>
+
+#include "Timing.h"
+
+
+namespace Kepler
+{
+
+// Singleton instance
+std::unique_ptr<Timing> Timing::instance;
+
+
+//
+// Configuration options
+//
+
+std::string Timing::config_file;
+
+comm::Arch::SimKind Timing::sim_kind = comm::Arch::SimFunctional;
+
+std::string Timing::report_file;
+
+std::string Timing::pipeline_debug_file;
+
+misc::Debug Timing::pipeline_debug;
+
+bool Timing::help = false;
+
+int Timing::frequency = 706;
+
+const std::string Timing::help_message =
+	"The Kepler GPU configuration file is a plain text INI file defining\n"
+	"the parameters of the Kepler model for a detailed (architectural)\n"
+	"simulation. This file is passed to Multi2Sim with the '--kpl-config\n"
+	"<file>' option, and should always be used together with option\n"
+	"'--kpl-sim detailed'. The number of streaming multiprocessors and\n"
+	"their residency limits also bound the number of thread-blocks kept\n"
+	"in memory during functional simulation.\n"
+	"\n"
+	"The following is a list of the sections allowed in the GPU "
+	"configuration\n"
+	"file, along with the list of variables for each section.\n"
+	"\n"
+	"Section '[ Device ]': parameters for the GPU.\n"
+	"\n"
+	"  Frequency = <value> (Default = 706)\n"
+	"      Frequency for the Kepler GPU in MHz.\n"
+	"  NumSMs = <num> (Default = 15)\n"
+	"      Number of streaming multiprocessors in the GPU.\n"
+	"\n"
+	"Section '[ SM ]': parameters for the streaming multiprocessors.\n"
+	"\n"
+	"  NumWarpSchedulers = <num> (Default = 4)\n"
+	"      Number of warp schedulers per streaming multiprocessor. Each\n"
+	"      scheduler issues at most one instruction per cycle.\n"
+	"  MaxThreadBlocks = <num> (Default = 16)\n"
+	"      Maximum number of resident thread-blocks.\n"
+	"  MaxWarps = <num> (Default = 64)\n"
+	"      Maximum number of resident warps.\n"
+	"  SchedulingPolicy = {LRR|GTO} (Default = GTO)\n"
+	"      Warp scheduling policy. With LRR (loose round-robin), warp\n"
+	"      schedulers take turns among ready warps. With GTO\n"
+	"      (greedy-then-oldest), a scheduler keeps issuing from the same\n"
+	"      warp until it stalls, and then switches to the oldest ready\n"
+	"      warp.\n"
+	"  AluLatency = <cycles> (Default = 9)\n"
+	"      Latency of arithmetic instructions.\n"
+	"  SfuLatency = <cycles> (Default = 18)\n"
+	"      Latency of instructions executed in the special function units.\n"
+	"  BranchLatency = <cycles> (Default = 6)\n"
+	"      Latency of branch and control instructions.\n"
+	"\n"
+	"Section '[ RegisterFile ]': parameters for the register file and the\n"
+	"operand collector.\n"
+	"\n"
+	"  NumBanks = <num> (Default = 4)\n"
+	"      Number of register file banks. Each bank serves one register\n"
+	"      read per cycle.\n"
+	"  NumCollectorUnits = <num> (Default = 8)\n"
+	"      Number of collector units holding issued instructions while\n"
+	"      their source operands are read.\n"
+	"\n"
+	"Section '[ LdStUnit ]': parameters for the load/store unit.\n"
+	"\n"
+	"  Width = <num> (Default = 4)\n"
+	"      Number of cache accesses issued to the memory hierarchy per\n"
+	"      cycle. The accesses of the threads of a warp to the same cache\n"
+	"      block are coalesced into one.\n"
+	"  MaxInflightInstructions = <num> (Default = 16)\n"
+	"      Maximum number of memory instructions in flight.\n"
+	"  SharedMemoryLatency = <cycles> (Default = 24)\n"
+	"      Latency of shared and local memory instructions.\n"
+	"\n"
+	"The entries from the streaming multiprocessors into the memory\n"
+	"hierarchy are given in the memory configuration file with sections\n"
+	"'[ Entry <name> ]' containing variables 'Arch = Kepler', 'SM = <index>',\n"
+	"and 'Module = <name>'.\n"
+	"\n";
+
+
+Timing::Timing() : comm::Timing("Kepler")
+{
+	// Make sure the emulator exists, since it provides the grids
+	Emulator::getInstance();
+
+	// Configure frequency domain with the frequency given by the user
+	ConfigureFrequencyDomain(frequency);
+
+	// Create GPU
+	gpu = misc::new_unique<Gpu>(this);
+}
+
+
+Timing *Timing::getInstance()
+{
+	// Instance already exists
+	if (instance.get())
+		return instance.get();
+
+	// Create instance
+	instance = misc::new_unique<Timing>();
+	return instance.get();
+}
+
+
+void Timing::RegisterOptions()
+{
+	// Get command line object
+	misc::CommandLine *command_line = misc::CommandLine::getInstance();
+
+	// Category
+	command_line->setCategory("Kepler");
+
+	// Option --kpl-sim <kind>
+	command_line->RegisterEnum("--kpl-sim {functional|detailed} "
+			"(default = functional)",
+			(int &) sim_kind, comm::Arch::SimKindMap,
+			"Level of accuracy of Kepler simulation.");
+
+	// Option --kpl-config <file>
+	command_line->RegisterString("--kpl-config <file>", config_file,
+			"Configuration file for the Kepler GPU timing model, "
+			"including parameters such as number of streaming "
+			"multiprocessors, warp schedulers, or register file "
+			"banks. Type 'm2s --kpl-help' for details on the file "
+			"format.");
+
+	// Option --kpl-report <file>
+	command_line->RegisterString("--kpl-report <file>", report_file,
+			"File to dump a report of the GPU pipeline, including "
+			"statistics such as instructions issued per streaming "
+			"multiprocessor, memory accesses, or register file bank "
+			"conflicts. Use together with a detailed GPU simulation "
+			"(option '--kpl-sim detailed').");
+
+	// Option --kpl-max-cycles <int>
+	command_line->RegisterInt64("--kpl-max-cycles <cycles>",
+			Gpu::max_cycles,
+			"Maximum number of cycles for the timing simulator "
+			"to run. If this maximum is reached, the simulation "
+			"will finish with the KeplerMaxCycles string.");
+
+	// Option --kpl-help
+	command_line->RegisterBool("--kpl-help", help,
+			"Display a help message describing the format of the "
+			"Kepler GPU configuration file.");
+
+	// Option --kpl-debug-pipeline <file>
+	command_line->RegisterString("--kpl-debug-pipeline <file>",
+			pipeline_debug_file,
+			"Reports the details of the Kepler pipeline units in "
+			"every cycle.");
+}
+
+
+void Timing::ProcessOptions()
+{
+	// Print configuration INI file format
+	if (help)
+	{
+		std::cerr << help_message;
+		exit(0);
+	}
+
+	// Configuration file passed with option '--kpl-config'
+	misc::IniFile ini_file;
+	if (!config_file.empty())
+		ini_file.Load(config_file);
+
+	// Parse configuration, initializing the static configuration
+	// variables of all classes. This is also done in functional
+	// simulation, since the emulator bounds the number of resident
+	// thread-blocks with the number of streaming multiprocessors and
+	// their residency limits.
+	ParseConfiguration(&ini_file);
+
+	// Instantiate timing simulator if '--kpl-sim detailed' is present
+	if (sim_kind == comm::Arch::SimDetailed)
+	{
+		// Set the debug file only if this is a detailed simulation
+		pipeline_debug.setPath(pipeline_debug_file);
+		pipeline_debug.setPrefix("[Kepler pipeline]");
+
+		// Create the instance
+		getInstance();
+	}
+}
+
+
+// Read a positive integer from the configuration file
+static int ReadPositiveInt(misc::IniFile *ini_file,
+		const std::string &section,
+		const std::string &variable,
+		int value)
+{
+	value = ini_file->ReadInt(section, variable, value);
+	if (value < 1)
+		throw Timing::Error(misc::fmt("%s: section [%s]: invalid "
+				"value for '%s' (%d)",
+				ini_file->getPath().c_str(),
+				section.c_str(),
+				variable.c_str(),
+				value));
+	return value;
+}
+
+
+void Timing::ParseConfiguration(misc::IniFile *ini_file)
+{
+	// Section [Device]
+	std::string section = "Device";
+	frequency = ini_file->ReadInt(section, "Frequency", frequency);
+	if (!esim::Engine::isValidFrequency(frequency))
+		throw Error(misc::fmt("%s: The value for 'Frequency' "
+				"must be between 1MHz and 1000GHz.\n",
+				ini_file->getPath().c_str()));
+	int num_sms = ReadPositiveInt(ini_file, section, "NumSMs",
+			Emulator::getNumSms());
+
+	// Section [SM]. The number of streaming multiprocessors and their
+	// residency limits are stored in the emulator, which also uses them.
+	section = "SM";
+	SM::num_warp_schedulers = ReadPositiveInt(ini_file, section,
+			"NumWarpSchedulers", SM::num_warp_schedulers);
+	int max_thread_blocks = ReadPositiveInt(ini_file, section,
+			"MaxThreadBlocks",
+			Emulator::getMaxThreadBlocksPerSm());
+	int max_warps = ReadPositiveInt(ini_file, section,
+			"MaxWarps", Emulator::getMaxWarpsPerSm());
+	Emulator::setSmConfiguration(num_sms, max_thread_blocks, max_warps);
+	SM::scheduling_policy = (SM::SchedulingPolicy) ini_file->ReadEnum(
+			section, "SchedulingPolicy",
+			SM::scheduling_policy_map, SM::scheduling_policy);
+	SM::alu_latency = ReadPositiveInt(ini_file, section,
+			"AluLatency", SM::alu_latency);
+	SM::sfu_latency = ReadPositiveInt(ini_file, section,
+			"SfuLatency", SM::sfu_latency);
+	SM::branch_latency = ReadPositiveInt(ini_file, section,
+			"BranchLatency", SM::branch_latency);
+
+	// Section [RegisterFile]
+	section = "RegisterFile";
+	OperandCollector::num_banks = ReadPositiveInt(ini_file, section,
+			"NumBanks", OperandCollector::num_banks);
+	OperandCollector::num_units = ReadPositiveInt(ini_file, section,
+			"NumCollectorUnits", OperandCollector::num_units);
+
+	// Section [LdStUnit]
+	section = "LdStUnit";
+	LdStUnit::width = ReadPositiveInt(ini_file, section,
+			"Width", LdStUnit::width);
+	LdStUnit::max_in_flight_instructions = ReadPositiveInt(ini_file,
+			section, "MaxInflightInstructions",
+			LdStUnit::max_in_flight_instructions);
+	LdStUnit::shared_memory_latency = ReadPositiveInt(ini_file, section,
+			"SharedMemoryLatency", LdStUnit::shared_memory_latency);
+}
+
+
+void Timing::WriteMemoryConfiguration(misc::IniFile *ini_file)
+{
+	// Number of L2 banks
+	const int num_l2_banks = 4;
+
+	// Cache geometry for L1
+	std::string section = "CacheGeometry kpl-geo-l1";
+	ini_file->WriteInt(section, "Sets", 32);
+	ini_file->WriteInt(section, "Assoc", 4);
+	ini_file->WriteInt(section, "BlockSize", 128);
+	ini_file->WriteInt(section, "Latency", 1);
+	ini_file->WriteString(section, "Policy", "LRU");
+
+	// Cache geometry for L2
+	section = "CacheGeometry kpl-geo-l2";
+	ini_file->WriteInt(section, "Sets", 256);
+	ini_file->WriteInt(section, "Assoc", 16);
+	ini_file->WriteInt(section, "BlockSize", 128);
+	ini_file->WriteInt(section, "Latency", 10);
+	ini_file->WriteString(section, "Policy", "LRU");
+
+	// Names of L2 banks
+	std::string l2_names;
+	for (int i = 0; i < num_l2_banks; i++)
+		l2_names += misc::fmt("%skpl-l2-%d", i ? " " : "", i);
+
+	// L1 caches and entries from streaming multiprocessors
+	for (int i = 0; i < Emulator::getNumSms(); i++)
+	{
+		section = misc::fmt("Module kpl-l1-%d", i);
+		ini_file->WriteString(section, "Type", "Cache");
+		ini_file->WriteString(section, "Geometry", "kpl-geo-l1");
+		ini_file->WriteString(section, "LowNetwork", "kpl-net-l1-l2");
+		ini_file->WriteString(section, "LowModules", l2_names);
+
+		section = misc::fmt("Entry kpl-sm-%d", i);
+		ini_file->WriteString(section, "Arch", "Kepler");
+		ini_file->WriteInt(section, "SM", i);
+		ini_file->WriteString(section, "Module",
+				misc::fmt("kpl-l1-%d", i));
+	}
+
+	// Network connecting L1s and L2s
+	section = "Network kpl-net-l1-l2";
+	ini_file->WriteInt(section, "DefaultInputBufferSize", 1056);
+	ini_file->WriteInt(section, "DefaultOutputBufferSize", 1056);
+	ini_file->WriteInt(section, "DefaultBandwidth", 528);
+
+	// L2 banks, each connected to its own global memory bank
+	for (int i = 0; i < num_l2_banks; i++)
+	{
+		std::string network = misc::fmt("kpl-net-l2-%d-gm-%d", i, i);
+		std::string address_range = misc::fmt(
+				"ADDR DIV 128 MOD %d EQ %d", num_l2_banks, i);
+
+		section = misc::fmt("Module kpl-l2-%d", i);
+		ini_file->WriteString(section, "Type", "Cache");
+		ini_file->WriteString(section, "Geometry", "kpl-geo-l2");
+		ini_file->WriteString(section, "HighNetwork", "kpl-net-l1-l2");
+		ini_file->WriteString(section, "LowNetwork", network);
+		ini_file->WriteString(section, "LowModules",
+				misc::fmt("kpl-gm-%d", i));
+		ini_file->WriteString(section, "AddressRange", address_range);
+
+		section = misc::fmt("Module kpl-gm-%d", i);
+		ini_file->WriteString(section, "Type", "MainMemory");
+		ini_file->WriteString(section, "HighNetwork", network);
+		ini_file->WriteInt(section, "BlockSize", 128);
+		ini_file->WriteInt(section, "Latency", 100);
+		ini_file->WriteString(section, "AddressRange", address_range);
+
+		section = "Network " + network;
+		ini_file->WriteInt(section, "DefaultInputBufferSize", 1056);
+		ini_file->WriteInt(section, "DefaultOutputBufferSize", 1056);
+		ini_file->WriteInt(section, "DefaultBandwidth", 528);
+	}
+}
+
+
+void Timing::ParseMemoryConfigurationEntry(misc::IniFile *ini_file,
+		const std::string &section)
+{
+	// Read streaming multiprocessor
+	int sm_id = ini_file->ReadInt(section, "SM", -1);
+	if (sm_id < 0)
+		throw Error(misc::fmt("%s: section [%s]: invalid or missing "
+				"value for 'SM'",
+				ini_file->getPath().c_str(),
+				section.c_str()));
+
+	// Check streaming multiprocessor boundaries
+	if (sm_id >= Emulator::getNumSms())
+	{
+		misc::Warning("%s: section [%s] ignored, referring to Kepler "
+				"streaming multiprocessor %d. This section "
+				"refers to a streaming multiprocessor that does "
+				"not currently exist. Please review your Kepler "
+				"configuration file if this is not the desired "
+				"behavior.",
+				ini_file->getPath().c_str(),
+				section.c_str(),
+				sm_id);
+		return;
+	}
+
+	// Check that entry has not been assigned before
+	SM *sm = gpu->getSM(sm_id);
+	if (sm->cache)
+		throw Error(misc::fmt("%s: section [%s]: entry from "
+				"streaming multiprocessor %d already assigned. "
+				"A different [Entry <name>] section in the "
+				"memory configuration file has already "
+				"assigned an entry for this particular "
+				"streaming multiprocessor. Please review your "
+				"configuration file to avoid duplicates.",
+				ini_file->getPath().c_str(),
+				section.c_str(),
+				sm_id));
+
+	// Read module
+	std::string module_name = ini_file->ReadString(section, "Module");
+	if (module_name.empty())
+		throw Error(misc::fmt("%s: section [%s]: variable 'Module' "
+				"missing.",
+				ini_file->getPath().c_str(),
+				section.c_str()));
+	mem::System *mem_system = mem::System::getInstance();
+	sm->cache = mem_system->getModule(module_name);
+	if (!sm->cache)
+		throw Error(misc::fmt("%s: [%s]: '%s' is not a valid "
+				"module name. The given module name must match "
+				"a module declared in a section [Module <name>] "
+				"in the memory configuration file.\n",
+				ini_file->getPath().c_str(),
+				section.c_str(),
+				module_name.c_str()));
+
+	// Add module to list of memory entries
+	entry_modules.push_back(sm->cache);
+
+	// Debug
+	mem::System::debug << misc::fmt("\tKepler SM %d\n", sm_id)
+			<< "\t\tEntry -> " << sm->cache->getName() << '\n'
+			<< '\n';
+}
+
+
+void Timing::CheckMemoryConfiguration(misc::IniFile *ini_file)
+{
+	// Check that all streaming multiprocessors have an entry to the
+	// memory hierarchy
+	for (auto it = gpu->getSMsBegin(), e = gpu->getSMsEnd(); it != e; ++it)
+	{
+		SM *sm = it->get();
+		if (!sm->cache)
+			throw Error(misc::fmt("%s: Kepler streaming "
+					"multiprocessor %d has no entry to "
+					"memory. Please add a new [Entry <name>] "
+					"section in your memory configuration "
+					"file to associate this streaming "
+					"multiprocessor with a memory module.\n",
+					ini_file->getPath().c_str(),
+					sm->getIndex()));
+	}
+}
+
+
+void Timing::DumpConfiguration(std::ostream &os) const
+{
+	// Device
+	os << "[ Config.Device ]\n";
+	os << misc::fmt("Frequency = %d\n", frequency);
+	os << misc::fmt("NumSMs = %d\n", Emulator::getNumSms());
+	os << '\n';
+
+	// Streaming multiprocessor
+	os << "[ Config.SM ]\n";
+	os << misc::fmt("NumWarpSchedulers = %d\n", SM::num_warp_schedulers);
+	os << misc::fmt("MaxThreadBlocks = %d\n",
+			Emulator::getMaxThreadBlocksPerSm());
+	os << misc::fmt("MaxWarps = %d\n", Emulator::getMaxWarpsPerSm());
+	os << misc::fmt("SchedulingPolicy = %s\n",
+			SM::scheduling_policy_map[SM::scheduling_policy]);
+	os << misc::fmt("AluLatency = %d\n", SM::alu_latency);
+	os << misc::fmt("SfuLatency = %d\n", SM::sfu_latency);
+	os << misc::fmt("BranchLatency = %d\n", SM::branch_latency);
+	os << '\n';
+
+	// Register file
+	os << "[ Config.RegisterFile ]\n";
+	os << misc::fmt("NumBanks = %d\n", OperandCollector::num_banks);
+	os << misc::fmt("NumCollectorUnits = %d\n",
+			OperandCollector::num_units);
+	os << '\n';
+
+	// Load/store unit
+	os << "[ Config.LdStUnit ]\n";
+	os << misc::fmt("Width = %d\n", LdStUnit::width);
+	os << misc::fmt("MaxInflightInstructions = %d\n",
+			LdStUnit::max_in_flight_instructions);
+	os << misc::fmt("SharedMemoryLatency = %d\n",
+			LdStUnit::shared_memory_latency);
+	os << "\n\n";
+}
+
+
+void Timing::DumpSummary(std::ostream &os) const
+{
+	// Simulated time in nanoseconds
+	esim::FrequencyDomain *frequency_domain = getFrequencyDomain();
+	double cycle_time = (double) frequency_domain->getCycleTime() / 1e3;
+	os << misc::fmt("SimTime = %.2f [ns]\n", getCycle() * cycle_time);
+
+	// Frequency
+	os << misc::fmt("Frequency = %d [MHz]\n", frequency_domain->getFrequency());
+
+	// Cycles
+	os << misc::fmt("Cycles = %lld\n", getCycle());
+
+	// Cycles per second
+	Emulator *emulator = Emulator::getInstance();
+	double time_in_seconds = (double) emulator->getTimerValue() / 1e6;
+	double cycles_per_second = time_in_seconds > 0.0 ?
+			(double) getCycle() / time_in_seconds : 0.0;
+	os << misc::fmt("CyclesPerSecond = %.0f\n", cycles_per_second);
+}
+
+
+void Timing::DumpReport() const
+{
+	// Check if the report file has been set
+	if (report_file.empty())
+		return;
+
+	// Open file for writing
+	std::ofstream report(report_file);
+	if (!report)
+		throw Error(misc::fmt("%s: cannot open report file",
+				report_file.c_str()));
+
+	// Dump GPU configuration
+	report << ";\n; GPU Configuration\n;\n\n";
+	DumpConfiguration(report);
+
+	// Totals over all streaming multiprocessors
+	long long num_thread_blocks = 0;
+	long long num_instructions = 0;
+	for (auto it = gpu->getSMsBegin(), e = gpu->getSMsEnd(); it != e; ++it)
+	{
+		num_thread_blocks += (*it)->num_mapped_thread_blocks;
+		num_instructions += (*it)->num_instructions;
+	}
+
+	// Report for device
+	long long cycles = getCycle();
+	report << ";\n; Simulation Statistics\n;\n\n";
+	report << "[ Device ]\n\n";
+	report << misc::fmt("GridCount = %lld\n", gpu->num_grids);
+	report << misc::fmt("ThreadBlockCount = %lld\n", num_thread_blocks);
+	report << misc::fmt("Instructions = %lld\n", num_instructions);
+	report << misc::fmt("Cycles = %lld\n", cycles);
+	report << misc::fmt("InstructionsPerCycle = %.4g\n", cycles ?
+			(double) num_instructions / cycles : 0.0);
+	report << "\n\n";
+
+	// Report for streaming multiprocessors
+	for (auto it = gpu->getSMsBegin(), e = gpu->getSMsEnd(); it != e; ++it)
+	{
+		SM *sm = it->get();
+		report << misc::fmt("[ SM %d ]\n\n", sm->getIndex());
+		report << misc::fmt("ThreadBlockCount = %lld\n",
+				sm->num_mapped_thread_blocks);
+		report << misc::fmt("Instructions = %lld\n",
+				sm->num_instructions);
+		report << misc::fmt("AluInstructions = %lld\n",
+				sm->num_alu_instructions);
+		report << misc::fmt("SfuInstructions = %lld\n",
+				sm->num_sfu_instructions);
+		report << misc::fmt("BranchInstructions = %lld\n",
+				sm->num_branch_instructions);
+		report << misc::fmt("SharedMemoryInstructions = %lld\n",
+				sm->num_shared_memory_instructions);
+		report << misc::fmt("GlobalMemoryInstructions = %lld\n",
+				sm->num_global_memory_instructions);
+		report << misc::fmt("InstructionsPerCycle = %.4g\n", cycles ?
+				(double) sm->num_instructions / cycles : 0.0);
+		report << '\n';
+		report << misc::fmt("CacheAccesses = %lld\n",
+				sm->num_cache_accesses);
+		report << misc::fmt("RegisterReads = %lld\n",
+				sm->num_register_reads);
+		report << misc::fmt("BankConflicts = %lld\n",
+				sm->num_bank_conflicts);
+		report << "\n\n";
+	}
+}
+
+
+bool Timing::Run()
+{
+	// Stop if maximum number of GPU cycles exceeded
+	esim::Engine *esim_engine = esim::Engine::getInstance();
+	if (Gpu::max_cycles && getCycle() >= Gpu::max_cycles)
+		esim_engine->Finish("KeplerMaxCycles");
+
+	// Stop if any reason met
+	if (esim_engine->hasFinished())
+		return true;
+
+	// Run one cycle of the GPU
+	return gpu->Run();
+}
+
+
+}  // namespace Kepler
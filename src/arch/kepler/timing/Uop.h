@@ -0,0 +1,105 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef ARCH_KEPLER_TIMING_UOP_H
+#define ARCH_KEPLER_TIMING_UOP_H
+
+#include <list>
+#include <vector>
+
+#include <memory/Module.h>
+
+#include "WarpScheduler.h"
+
+
+namespace Kepler
+{
+
+/// Instruction of a warp in flight in the pipeline of a streaming
+/// multiprocessor. The instruction is emulated when it is issued, and the
+/// uop carries the information needed to model its timing.
+class Uop
+{
+public:
+
+	/// Functional unit executing the instruction
+	enum Type
+	{
+		TypeInvalid = 0,
+		TypeAlu,
+		TypeSfu,
+		TypeBranch,
+		TypeSharedMemory,
+		TypeGlobalMemory
+	};
+
+private:
+
+	// Unique identifier in the streaming multiprocessor
+	long long id;
+
+	// Warp that issued the instruction
+	WarpScheduler::WarpEntry *warp_entry;
+
+	// Functional unit
+	Type type;
+
+public:
+
+	/// Source registers still to be read by the operand collector
+	std::vector<int> source_registers;
+
+	/// Type of access for global memory instructions
+	mem::Module::AccessType access_type = mem::Module::AccessLoad;
+
+	/// Virtual addresses of the cache blocks still to be accessed by a
+	/// global memory instruction, after coalescing the accesses of all
+	/// threads in the warp
+	std::list<unsigned> global_memory_addresses;
+
+	/// Number of global memory accesses in flight. The counter is
+	/// decremented when an access is issued, and incremented by the
+	/// memory hierarchy when it completes.
+	int global_memory_witness = 0;
+
+	/// Cycle when a shared memory instruction completes
+	long long ready_cycle = 0;
+
+	/// Constructor
+	Uop(long long id, WarpScheduler::WarpEntry *warp_entry, Type type) :
+			id(id),
+			warp_entry(warp_entry),
+			type(type)
+	{
+	}
+
+	/// Return the unique identifier of the uop
+	long long getId() const { return id; }
+
+	/// Return the warp entry the uop belongs to
+	WarpScheduler::WarpEntry *getWarpEntry() const { return warp_entry; }
+
+	/// Return the functional unit executing the instruction
+	Type getType() const { return type; }
+};
+
+
+}  // namespace Kepler
+
+#endif
@@ -0,0 +1,333 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+
+#include <arch/kepler/disassembler/Instruction.h>
+#include <arch/kepler/emulator/Thread.h>
+#include <arch/kepler/emulator/ThreadBlock.h>
+#include <arch/kepler/emulator/Warp.h>
+#include <lib/cpp/Misc.h>
+
+#include "Gpu.h"
+#include "SM.h"
+#include "Timing.h"
+#include "Uop.h"
+#include "WarpScheduler.h"
+
+
+namespace Kepler
+{
+
+// Register RZ, always reading zero, which does not access the register file
+static const int register_zero = 255;
+
+
+// Return the functional unit executing an instruction with the given opcode,
+// not considering global memory, which depends on the accessed addresses.
+static Uop::Type getUopType(Instruction::Opcode opcode)
+{
+	switch (opcode)
+	{
+
+	case Instruction::INST_LD:
+	case Instruction::INST_ST:
+	case Instruction::INST_LDS:
+	case Instruction::INST_STS:
+
+		return Uop::TypeSharedMemory;
+
+	case Instruction::INST_MUFU:
+
+		return Uop::TypeSfu;
+
+	case Instruction::INST_EXIT:
+	case Instruction::INST_BRA:
+	case Instruction::INST_BAR:
+	case Instruction::INST_JMX:
+	case Instruction::INST_JMP:
+	case Instruction::INST_JCAL:
+	case Instruction::INST_BRX:
+	case Instruction::INST_CAL:
+	case Instruction::INST_PRET:
+	case Instruction::INST_PLONGJMP:
+	case Instruction::INST_SSY:
+	case Instruction::INST_PBK:
+	case Instruction::INST_PCNT:
+	case Instruction::INST_LONGJMP:
+	case Instruction::INST_RET:
+	case Instruction::INST_KIL:
+	case Instruction::INST_BRK:
+	case Instruction::INST_CONT:
+	case Instruction::INST_RTT:
+
+		return Uop::TypeBranch;
+
+	default:
+
+		return Uop::TypeAlu;
+	}
+}
+
+
+// Return whether the instruction encodes a 32-bit immediate in place of its
+// second source register
+static bool hasImmediate32(Instruction::Opcode opcode)
+{
+	switch (opcode)
+	{
+
+	case Instruction::INST_MOV32I:
+	case Instruction::INST_LOP32I:
+	case Instruction::INST_IADD32I:
+	case Instruction::INST_FADD32I:
+	case Instruction::INST_FFMA32I:
+	case Instruction::INST_IMAD32I:
+	case Instruction::INST_ISCADD32I:
+
+		return true;
+
+	default:
+
+		return false;
+	}
+}
+
+
+// Add a source register to the uop, ignoring RZ and duplicates
+static void AddSourceRegister(Uop *uop, int source_register)
+{
+	if (source_register == register_zero)
+		return;
+	auto &source_registers = uop->source_registers;
+	if (std::find(source_registers.begin(), source_registers.end(),
+			source_register) == source_registers.end())
+		source_registers.push_back(source_register);
+}
+
+
+void WarpScheduler::AddWarp(Warp *warp, long long age)
+{
+	warp_entries.emplace_back(warp, age);
+}
+
+
+bool WarpScheduler::isInFlight(ThreadBlock *thread_block) const
+{
+	for (auto &warp_entry : warp_entries)
+		if (warp_entry.warp->getThreadBlock() == thread_block &&
+				warp_entry.in_flight)
+			return true;
+	return false;
+}
+
+
+void WarpScheduler::RemoveWarps(ThreadBlock *thread_block)
+{
+	for (auto it = warp_entries.begin(); it != warp_entries.end(); )
+	{
+		if (it->warp->getThreadBlock() != thread_block)
+		{
+			++it;
+			continue;
+		}
+		if (it->warp == last_warp)
+			last_warp = nullptr;
+		it = warp_entries.erase(it);
+	}
+}
+
+
+bool WarpScheduler::isReady(WarpEntry *warp_entry, long long cycle) const
+{
+	Warp *warp = warp_entry->warp;
+	return !warp_entry->in_flight &&
+			warp_entry->ready_cycle <= cycle &&
+			!warp->getFinishedEmu() &&
+			!warp->getAtBarrier();
+}
+
+
+WarpScheduler::WarpEntry *WarpScheduler::Select(long long cycle)
+{
+	switch (SM::scheduling_policy)
+	{
+
+	case SM::SchedulingPolicyLrr:
+	{
+		// Start after the warp that issued last
+		auto start = warp_entries.begin();
+		for (auto it = warp_entries.begin(); it != warp_entries.end();
+				++it)
+		{
+			if (it->warp == last_warp)
+			{
+				start = std::next(it);
+				break;
+			}
+		}
+
+		// Find the first ready warp, wrapping around
+		for (unsigned i = 0; i < warp_entries.size(); i++)
+		{
+			if (start == warp_entries.end())
+				start = warp_entries.begin();
+			if (isReady(&*start, cycle))
+				return &*start;
+			++start;
+		}
+		return nullptr;
+	}
+
+	case SM::SchedulingPolicyGto:
+	{
+		// Keep issuing from the same warp while it is ready, or switch
+		// to the oldest ready warp otherwise. Warps are kept in the
+		// order they became resident, so the first ready one is the
+		// oldest.
+		WarpEntry *oldest = nullptr;
+		for (auto &warp_entry : warp_entries)
+		{
+			if (!isReady(&warp_entry, cycle))
+				continue;
+			if (warp_entry.warp == last_warp)
+				return &warp_entry;
+			if (!oldest)
+				oldest = &warp_entry;
+		}
+		return oldest;
+	}
+
+	default:
+
+		throw misc::Panic("Invalid scheduling policy");
+	}
+}
+
+
+std::unique_ptr<Uop> WarpScheduler::Issue(WarpEntry *warp_entry)
+{
+	// Thread-block specific constant memory must be in place before
+	// emulating, since several thread-blocks are resident
+	Warp *warp = warp_entry->warp;
+	warp->getThreadBlock()->Activate();
+
+	// Scheduling control words are emulated right away, with no cost
+	while (warp->isControlWord() && !warp->getFinishedEmu())
+		warp->Execute();
+	if (warp->getFinishedEmu())
+		return nullptr;
+
+	// Emulate instruction
+	unsigned pc = warp->getPC();
+	warp->Execute();
+	Instruction *inst = warp->getInstruction();
+	Instruction::Opcode opcode = (Instruction::Opcode) inst->getOpcode();
+
+	// Global memory addresses accessed by the threads of the warp,
+	// coalesced into cache blocks
+	std::list<unsigned> addresses;
+	Uop::Type type = getUopType(opcode);
+	if (type == Uop::TypeSharedMemory)
+	{
+		unsigned block_mask = ~(sm->cache->getBlockSize() - 1);
+		for (auto it = warp->ThreadsBegin(), e = warp->ThreadsEnd();
+				it != e; ++it)
+		{
+			Thread *thread = it->get();
+			unsigned size = thread->getGlobalMemoryAccessSize();
+			if (!size)
+				continue;
+			unsigned address = thread->getGlobalMemoryAccessAddress();
+			addresses.push_back(address & block_mask);
+			addresses.push_back((address + size - 1) & block_mask);
+		}
+		addresses.sort();
+		addresses.unique();
+		if (!addresses.empty())
+			type = Uop::TypeGlobalMemory;
+	}
+
+	// Create uop
+	auto uop = misc::new_unique<Uop>(sm->getNewUopId(), warp_entry, type);
+	uop->global_memory_addresses = std::move(addresses);
+	uop->access_type = opcode == Instruction::INST_ST ?
+			mem::Module::AccessStore :
+			mem::Module::AccessLoad;
+
+	// Source registers. The fields at bits 10-17 and 23-30 hold source
+	// registers in most encodings. Stores also read the register at bits
+	// 2-9.
+	if (type != Uop::TypeBranch)
+	{
+		Instruction::BytesGeneral0 format = inst->getInstBytes().general0;
+		AddSourceRegister(uop.get(), format.mod0 & 0xff);
+		if (!hasImmediate32(opcode))
+			AddSourceRegister(uop.get(), format.srcB & 0xff);
+		if (opcode == Instruction::INST_ST ||
+				opcode == Instruction::INST_STS)
+			AddSourceRegister(uop.get(), format.dst);
+	}
+
+	// Statistics
+	sm->num_instructions++;
+	switch (type)
+	{
+	case Uop::TypeAlu: sm->num_alu_instructions++; break;
+	case Uop::TypeSfu: sm->num_sfu_instructions++; break;
+	case Uop::TypeBranch: sm->num_branch_instructions++; break;
+	case Uop::TypeSharedMemory: sm->num_shared_memory_instructions++; break;
+	case Uop::TypeGlobalMemory: sm->num_global_memory_instructions++; break;
+	default: throw misc::Panic("Invalid uop type");
+	}
+
+	// Debug
+	Timing::pipeline_debug << misc::fmt("\t\t@%lld sm=%d sched=%d "
+			"uop=%lld warp=%d pc=0x%x inst=%s issue\n",
+			sm->getCycle(), sm->getIndex(), index,
+			uop->getId(), warp->getId(), pc, inst->getName());
+
+	// Return
+	return uop;
+}
+
+
+void WarpScheduler::Run()
+{
+	// Structural hazard on the operand collector
+	OperandCollector *operand_collector = sm->getOperandCollector();
+	if (!operand_collector->canAccept())
+		return;
+
+	// Select warp
+	WarpEntry *warp_entry = Select(sm->getCycle());
+	if (!warp_entry)
+		return;
+
+	// Issue its next instruction
+	last_warp = warp_entry->warp;
+	std::unique_ptr<Uop> uop = Issue(warp_entry);
+	if (!uop)
+		return;
+	warp_entry->in_flight = true;
+	operand_collector->Accept(std::move(uop));
+}
+
+
+}  // namespace Kepler
@@ -0,0 +1,124 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef ARCH_KEPLER_TIMING_WARP_SCHEDULER_H
+#define ARCH_KEPLER_TIMING_WARP_SCHEDULER_H
+
+#include <list>
+#include <memory>
+
+
+namespace Kepler
+{
+
+// Forward declarations
+class SM;
+class ThreadBlock;
+class Uop;
+class Warp;
+
+
+/// Warp scheduler of a streaming multiprocessor. Each scheduler owns a
+/// subset of the resident warps, and issues at most one instruction per
+/// cycle from one of them into the operand collector.
+class WarpScheduler
+{
+public:
+
+	/// Timing state of a warp owned by the scheduler
+	struct WarpEntry
+	{
+		/// Warp
+		Warp *warp;
+
+		/// Order in which the warp became resident, used by the
+		/// greedy-then-oldest policy
+		long long age;
+
+		/// Cycle when the result of the last instruction issued by the
+		/// warp is available. The warp does not issue again before.
+		long long ready_cycle = 0;
+
+		/// Whether the last instruction issued by the warp is still in
+		/// the operand collector or the LD/ST unit
+		bool in_flight = false;
+
+		/// Constructor
+		WarpEntry(Warp *warp, long long age) : warp(warp), age(age)
+		{
+		}
+	};
+
+private:
+
+	// Streaming multiprocessor the scheduler belongs to
+	SM *sm;
+
+	// Index of the scheduler in the streaming multiprocessor
+	int index;
+
+	// Warps owned by the scheduler, in the order they became resident
+	std::list<WarpEntry> warp_entries;
+
+	// Warp that issued last, or null
+	Warp *last_warp = nullptr;
+
+	// Return whether the warp can issue an instruction in this cycle
+	bool isReady(WarpEntry *warp_entry, long long cycle) const;
+
+	// Select a warp to issue from according to the scheduling policy, or
+	// return null if no warp is ready
+	WarpEntry *Select(long long cycle);
+
+	// Emulate the next instruction of the warp and create the uop modeling
+	// its timing. Return null if the warp finished while emulating
+	// scheduling control words.
+	std::unique_ptr<Uop> Issue(WarpEntry *warp_entry);
+
+public:
+
+	/// Constructor
+	WarpScheduler(SM *sm, int index) : sm(sm), index(index)
+	{
+	}
+
+	/// Return the index of the scheduler in the streaming multiprocessor
+	int getIndex() const { return index; }
+
+	/// Return the number of warps owned by the scheduler
+	int getNumWarps() const { return warp_entries.size(); }
+
+	/// Add a warp to the scheduler
+	void AddWarp(Warp *warp, long long age);
+
+	/// Return whether any warp of the thread-block has an instruction in
+	/// flight
+	bool isInFlight(ThreadBlock *thread_block) const;
+
+	/// Remove all warps of the thread-block from the scheduler
+	void RemoveWarps(ThreadBlock *thread_block);
+
+	/// Issue stage, run once per cycle
+	void Run();
+};
+
+
+}  // namespace Kepler
+
+#endif
@@ -0,0 +1,312 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cstddef>
+
+#include <arch/southern-islands/emulator/Emulator.h>
+#include <arch/southern-islands/emulator/NDRange.h>
+#include <arch/x86/emulator/Context.h>
+#include <arch/x86/emulator/Emulator.h>
+#include <memory/Memory.h>
+
+#include "CommandQueue.h"
+#include "Driver.h"
+
+
+namespace SI
+{
+
+
+CommandQueue::CommandQueue(int id, mem::Memory *memory, unsigned address,
+		unsigned num_packets) :
+		id(id),
+		memory(memory),
+		address(address),
+		num_packets(num_packets)
+{
+	// Check ring
+	static_assert(sizeof(Header) == 16, "Invalid header size");
+	static_assert(sizeof(Packet) == 32, "Invalid packet size");
+	if (!num_packets)
+		throw Driver::Error("Command queue with no packets");
+
+	// Keep track of the lifetime of the guest memory
+	try
+	{
+		memory_ref = memory->shared_from_this();
+	}
+	catch (std::bad_weak_ptr &e)
+	{
+		throw Driver::Error("Command queue not in guest memory");
+	}
+}
+
+
+bool CommandQueue::isCompleted(unsigned index) const
+{
+	// Not read yet. Indexes wrap around, so they are compared with a
+	// signed difference.
+	if ((int) (index - read_index) >= 0)
+		return false;
+
+	// Still in flight
+	for (const InFlight &packet : in_flight)
+		if (packet.index == index)
+			return false;
+
+	// Completed
+	return true;
+}
+
+
+bool CommandQueue::isIdle() const
+{
+	unsigned write_index;
+	memory->Read(address + offsetof(Header, write_index),
+			sizeof write_index, (char *) &write_index);
+	return in_flight.empty() && write_index == read_index;
+}
+
+
+void CommandQueue::Complete(unsigned index, unsigned completion_ptr)
+{
+	// Set completion word
+	Driver::debug << misc::fmt("\tcommand queue %d: packet %u "
+			"completed\n", id, index);
+	if (completion_ptr)
+	{
+		unsigned value = 1;
+		memory->Write(completion_ptr, sizeof value, (char *) &value);
+	}
+}
+
+
+NDRange *CommandQueue::ProcessPacket(unsigned index, const Packet &packet)
+{
+	Emulator *emulator = Emulator::getInstance();
+	mem::Memory *video_memory = emulator->getVideoMemory();
+	unsigned video_memory_top = emulator->getVideoMemoryTop();
+	switch (packet.type)
+	{
+
+	case PacketMemWrite:
+	{
+		unsigned device_ptr = packet.args[0];
+		unsigned host_ptr = packet.args[1];
+		unsigned size = packet.args[2];
+		Driver::debug << misc::fmt("\tcommand queue %d: packet %u: "
+				"mem write, device_ptr = 0x%x, host_ptr = 0x%x, "
+				"size = %u\n", id, index, device_ptr, host_ptr,
+				size);
+		if (device_ptr + size > video_memory_top)
+			throw Driver::Error("Device memory not allocated");
+		video_memory->CopyFrom(device_ptr, *memory, host_ptr, size);
+		return nullptr;
+	}
+
+	case PacketMemRead:
+	{
+		unsigned host_ptr = packet.args[0];
+		unsigned device_ptr = packet.args[1];
+		unsigned size = packet.args[2];
+		Driver::debug << misc::fmt("\tcommand queue %d: packet %u: "
+				"mem read, host_ptr = 0x%x, device_ptr = 0x%x, "
+				"size = %u\n", id, index, host_ptr, device_ptr,
+				size);
+		if (device_ptr + size > video_memory_top)
+			throw Driver::Error("Device memory not allocated");
+		memory->CopyFrom(host_ptr, *video_memory, device_ptr, size);
+		return nullptr;
+	}
+
+	case PacketMemCopy:
+	{
+		unsigned dest_ptr = packet.args[0];
+		unsigned src_ptr = packet.args[1];
+		unsigned size = packet.args[2];
+		Driver::debug << misc::fmt("\tcommand queue %d: packet %u: "
+				"mem copy, dest_ptr = 0x%x, src_ptr = 0x%x, "
+				"size = %u\n", id, index, dest_ptr, src_ptr,
+				size);
+		if (src_ptr + size > video_memory_top ||
+				dest_ptr + size > video_memory_top)
+			throw Driver::Error("Device memory not allocated");
+		video_memory->CopyFrom(dest_ptr, *video_memory, src_ptr, size);
+		return nullptr;
+	}
+
+	case PacketNDRangeLaunch:
+	{
+		// Get ND-Range
+		int ndrange_id = packet.args[0];
+		NDRange *ndrange = emulator->getNDRangeById(ndrange_id);
+		if (!ndrange)
+			throw Driver::Error(misc::fmt("Invalid ND-Range ID "
+					"(%d)", ndrange_id));
+		Driver::debug << misc::fmt("\tcommand queue %d: packet %u: "
+				"launch nd-range %d\n", id, index, ndrange_id);
+
+		// Send all work groups
+		unsigned num_work_groups = ndrange->getGroupCount(0) *
+				ndrange->getGroupCount(1) *
+				ndrange->getGroupCount(2);
+		for (unsigned work_group_id = 0;
+				work_group_id < num_work_groups;
+				work_group_id++)
+			ndrange->AddWorkgroupIdToWaitingList(work_group_id);
+		ndrange->setLastWorkgroupSent(true);
+		emulator->incNDRangesRunning();
+		return ndrange;
+	}
+
+	default:
+		throw Driver::Error(misc::fmt("Invalid packet type (%u)",
+				packet.type));
+	}
+}
+
+
+void CommandQueue::WakeupWaiters()
+{
+	for (auto it = waiters.begin(); it != waiters.end(); )
+	{
+		if (!isCompleted(it->index))
+		{
+			++it;
+			continue;
+		}
+
+		// Resume the context, unless it was killed while waiting
+		x86::Context *context = x86::Emulator::getInstance()->
+				getContext(it->pid);
+		if (context && context->isSuspended())
+			context->Wakeup();
+		it = waiters.erase(it);
+	}
+}
+
+
+void CommandQueue::Wait(comm::Context *context, unsigned index)
+{
+	// Check index
+	unsigned write_index;
+	memory->Read(address + offsetof(Header, write_index),
+			sizeof write_index, (char *) &write_index);
+	if ((int) (index - write_index) >= 0)
+		throw Driver::Error(misc::fmt("Waiting on packet %u not "
+				"written yet", index));
+
+	// Nothing to do if packet completed
+	if (isCompleted(index))
+		return;
+
+	// Suspend context
+	Driver::debug << misc::fmt("\tcommand queue %d: waiting for packet "
+			"%u (blocking)\n", id, index);
+	context->Suspend();
+	waiters.push_back({context->getId(), index});
+}
+
+
+bool CommandQueue::RetireNDRanges()
+{
+	Emulator *emulator = Emulator::getInstance();
+	bool retired = false;
+	for (auto it = in_flight.begin(); it != in_flight.end(); )
+	{
+		NDRange *ndrange = it->ndrange;
+		if (!ndrange->isWaitingWorkGroupsEmpty() ||
+				!ndrange->isRunningWorkGroupsEmpty())
+		{
+			++it;
+			continue;
+		}
+		if (!isOrphan())
+			Complete(it->index, it->completion_ptr);
+		emulator->decNDRangesRunning();
+		emulator->RemoveNDRange(ndrange);
+		it = in_flight.erase(it);
+		retired = true;
+	}
+	return retired;
+}
+
+
+bool CommandQueue::Drain()
+{
+	// Nobody waits for the results of the ND-Ranges anymore, so stop
+	// scheduling their work groups
+	for (InFlight &packet : in_flight)
+		packet.ndrange->ClearWaitingWorkGroups();
+
+	// Contexts waiting on the queue are gone with the guest memory
+	waiters.clear();
+
+	// Retire ND-Ranges once their running work groups finish
+	RetireNDRanges();
+	return !in_flight.empty();
+}
+
+
+bool CommandQueue::Process()
+{
+	// Retire ND-Ranges whose work groups all finished
+	bool completed = RetireNDRanges();
+
+	// Read new packets
+	unsigned write_index;
+	memory->Read(address + offsetof(Header, write_index),
+			sizeof write_index, (char *) &write_index);
+	while (read_index != write_index)
+	{
+		// Read packet
+		Packet packet;
+		unsigned slot = read_index % num_packets;
+		memory->Read(address + sizeof(Header) + slot * sizeof(Packet),
+				sizeof packet, (char *) &packet);
+
+		// A barrier waits for all previous packets
+		if ((packet.flags & FlagBarrier) && !in_flight.empty())
+			break;
+
+		// Process packet
+		NDRange *ndrange = ProcessPacket(read_index, packet);
+		if (ndrange)
+			in_flight.push_back({read_index, packet.completion_ptr,
+					ndrange});
+		else
+			Complete(read_index, packet.completion_ptr);
+		read_index++;
+		completed = true;
+	}
+
+	// Publish read index and wake up waiting contexts
+	if (completed)
+	{
+		memory->Write(address + offsetof(Header, read_index),
+				sizeof read_index, (char *) &read_index);
+		WakeupWaiters();
+	}
+
+	// Work left
+	return !in_flight.empty() || read_index != write_index;
+}
+
+
+}  // namespace SI
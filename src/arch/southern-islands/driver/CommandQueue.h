@@ -0,0 +1,218 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef ARCH_SOUTHERN_ISLANDS_DRIVER_COMMAND_QUEUE_H
+#define ARCH_SOUTHERN_ISLANDS_DRIVER_COMMAND_QUEUE_H
+
+#include <list>
+#include <memory>
+
+
+namespace comm
+{
+class Context;
+}
+
+namespace mem
+{
+class Memory;
+}
+
+
+namespace SI
+{
+
+// Forward declarations
+class NDRange;
+
+
+/// Ring of commands shared between the OpenCL runtime and the driver. The
+/// ring lives in the memory of the guest context that created it. The
+/// runtime appends packets and advances the write index, while the driver
+/// drains them asynchronously, once per iteration of the emulation loop,
+/// and advances the read index. Memory transfers complete as soon as they
+/// are processed, while ND-Range launches stay in flight until all their
+/// work groups finish, so that several of them can run concurrently.
+///
+/// The layout of the ring in guest memory is a Header followed by an array
+/// of Packet entries, shared with the runtime in
+/// 'runtime/opencl/si-device.h'.
+class CommandQueue
+{
+public:
+
+	/// Packet types
+	enum PacketType
+	{
+		PacketInvalid = 0,
+		PacketMemWrite,
+		PacketMemRead,
+		PacketMemCopy,
+		PacketNDRangeLaunch
+	};
+
+	/// Packet flag forcing all previous packets to complete before the
+	/// packet is processed
+	static const unsigned FlagBarrier = 1;
+
+	/// Ring header in guest memory
+	struct Header
+	{
+		// Index of the next packet to be written by the runtime
+		unsigned write_index;
+
+		// Index of the next packet to be read by the driver
+		unsigned read_index;
+
+		// Number of packets in the ring
+		unsigned num_packets;
+
+		// Padding
+		unsigned reserved;
+	};
+
+	/// Packet in guest memory. The arguments are, for each packet type:
+	///
+	/// - PacketMemWrite: device pointer, host pointer, size.
+	/// - PacketMemRead: host pointer, device pointer, size.
+	/// - PacketMemCopy: destination and source device pointers, size.
+	/// - PacketNDRangeLaunch: ND-Range identifier, as returned by ABI
+	///   call 'NDRangeCreate'. The ND-Range is freed when it completes.
+	struct Packet
+	{
+		// Packet type, of type PacketType
+		unsigned type;
+
+		// Bitmap of flags
+		unsigned flags;
+
+		// Arguments
+		unsigned args[4];
+
+		// Address of a 32-bit word in guest memory set to 1 by the
+		// driver when the packet completes, or 0 for none
+		unsigned completion_ptr;
+
+		// Padding
+		unsigned reserved;
+	};
+
+private:
+
+	// Queue identifier
+	int id;
+
+	// Guest memory containing the ring
+	mem::Memory *memory;
+
+	// Reference used to detect that the guest program exited
+	std::weak_ptr<mem::Memory> memory_ref;
+
+	// Address of the ring header
+	unsigned address;
+
+	// Number of packets in the ring
+	unsigned num_packets;
+
+	// Index of the next packet to read
+	unsigned read_index = 0;
+
+	// Packet in flight
+	struct InFlight
+	{
+		unsigned index;
+		unsigned completion_ptr;
+		NDRange *ndrange;
+	};
+
+	// ND-Range launches in flight, in order of arrival
+	std::list<InFlight> in_flight;
+
+	// Context suspended until a packet completes. The x86 context is
+	// identified by its pid and looked up when the packet completes,
+	// since it may have been destroyed in the meantime.
+	struct Waiter
+	{
+		int pid;
+		unsigned index;
+	};
+
+	// Suspended contexts
+	std::list<Waiter> waiters;
+
+	// Mark a packet as completed
+	void Complete(unsigned index, unsigned completion_ptr);
+
+	// Retire ND-Ranges whose work groups all finished. Completion words
+	// are only set if the guest memory still exists. The function returns
+	// whether any ND-Range was retired.
+	bool RetireNDRanges();
+
+	// Process a packet. The function returns the ND-Range launched by the
+	// packet, or null if the packet completed right away.
+	NDRange *ProcessPacket(unsigned index, const Packet &packet);
+
+	// Wake up contexts waiting on completed packets
+	void WakeupWaiters();
+
+public:
+
+	/// Create a command queue for the ring found at address \a address
+	/// of guest memory \a memory, with \a num_packets entries. The memory
+	/// must be owned by a shared pointer.
+	CommandQueue(int id, mem::Memory *memory, unsigned address,
+			unsigned num_packets);
+
+	/// Return the queue identifier
+	int getId() const { return id; }
+
+	/// Return whether the guest memory containing the ring was freed,
+	/// because the guest program exited without freeing the queue
+	bool isOrphan() const { return memory_ref.expired(); }
+
+	/// Return whether the packet with the given index has completed
+	bool isCompleted(unsigned index) const;
+
+	/// Return whether the queue has no packets left to read and no
+	/// ND-Range in flight
+	bool isIdle() const;
+
+	/// Suspend \a context until the packet with the given index completes.
+	/// If it already completed, the context is not suspended.
+	void Wait(comm::Context *context, unsigned index);
+
+	/// Retire completed ND-Ranges, and process new packets written by the
+	/// runtime. This function is invoked once per iteration of the
+	/// emulation loop. It returns \c true if there is work left. The
+	/// queue must not be an orphan.
+	bool Process();
+
+	/// Wind down an orphan queue. Work groups of the ND-Ranges in flight
+	/// that were not scheduled yet are discarded, and ND-Ranges whose
+	/// running work groups finished are retired. This function is invoked
+	/// once per iteration of the emulation loop instead of Process(). It
+	/// returns \c true while ND-Ranges are still in flight, and the queue
+	/// can be freed once it returns \c false.
+	bool Drain();
+};
+
+
+}  // namespace SI
+
+#endif
@@ -131,5 +131,37 @@ Kernel *Driver::AddKernel(int kernel_id, const std::string &func, Program *progr
 }
 
 
+bool Driver::ProcessCommandQueues()
+{
+	bool active = false;
+	for (auto &command_queue : command_queues)
+	{
+		// Skip freed queues
+		if (!command_queue)
+			continue;
+
+		// Free queues of guest programs that exited, once their
+		// ND-Ranges in flight are retired
+		if (command_queue->isOrphan())
+		{
+			if (command_queue->Drain())
+			{
+				active = true;
+				continue;
+			}
+			debug << misc::fmt("Command queue %d freed on guest "
+					"exit\n", command_queue->getId());
+			command_queue.reset();
+			continue;
+		}
+
+		// Process packets
+		if (command_queue->Process())
+			active = true;
+	}
+	return active;
+}
+
+
 }  // namepsace SI
 
@@ -26,6 +26,7 @@
 #include <lib/cpp/CommandLine.h>
 #include <lib/cpp/Debug.h>
 
+#include "CommandQueue.h"
 #include "Program.h"
 #include "Kernel.h"
 
@@ -51,6 +52,10 @@ class Driver : public comm::Driver
 	// Primary list of Kernels
 	std::vector<std::unique_ptr<Kernel>> kernels;
 
+	// Command queues, indexed by their identifier. Freed queues leave a
+	// null entry behind.
+	std::vector<std::unique_ptr<CommandQueue>> command_queues;
+
 	// Indicates whether memory is fused or not
 	bool fused = false;
 
@@ -140,6 +145,9 @@ public:
 	/// Obtain instance of the singleton
 	static Driver *getInstance();
 
+	/// Destroy the driver singleton if allocated
+	static void Destroy() { instance = nullptr; }
+
 	/// Register command-line options
 	static void RegisterOptions();
 
@@ -188,6 +196,18 @@ public:
 		assert(id < kernels.size());
 		return kernels[id].get();
 	}
+
+	/// Get command queue by its identifier, or null if it does not exist
+	CommandQueue *getCommandQueueById(unsigned id)
+	{
+		return id < command_queues.size() ?
+				command_queues[id].get() : nullptr;
+	}
+
+	/// Process the packets of all command queues. This function is
+	/// invoked once per iteration of the Southern Islands emulation loop.
+	/// It returns \c true if any command queue has work left.
+	bool ProcessCommandQueues();
 };
 
 
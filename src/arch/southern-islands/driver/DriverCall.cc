@@ -125,10 +125,8 @@ int Driver::CallMemRead(comm::Context *context,
 		throw Error(misc::fmt("%s: accessing device memory not "
 				"allocated", __FUNCTION__));                                   
 
-	// Read memory from host to device
-	auto buffer = misc::new_unique_array<char>(size);
-	video_memory->Read(device_ptr, size, buffer.get());
-	memory->Write(host_ptr, size, buffer.get());
+	// Read memory from device to host
+	memory->CopyFrom(host_ptr, *video_memory, device_ptr, size);
 	
 	// Return                                                         
 	return 0; 
@@ -173,10 +171,8 @@ int Driver::CallMemWrite(comm::Context *context,
 	if (device_ptr + size > emulator->getVideoMemoryTop())
 		throw Error(misc::fmt("Device not allocated"));
 
-	// Read memory from host to device
-	auto buffer = misc::new_unique_array<char>(size);
-	memory->Read(host_ptr, size, buffer.get());
-	video_memory->Write(device_ptr, size, buffer.get());
+	// Write memory from host to device
+	video_memory->CopyFrom(device_ptr, *memory, host_ptr, size);
 
 	// Return
 	return 0;
@@ -219,10 +215,8 @@ int Driver::CallMemCopy(comm::Context *context,
 		throw Error(misc::fmt("%s: accessing device memory not "
 				"allocated", __FUNCTION__));                                   
 
-	// Read memory from host to device
-	auto buffer = misc::new_unique_array<char>(size);
-	video_memory->Read(src_ptr, size, buffer.get());
-	video_memory->Write(dest_ptr, size, buffer.get());
+	// Copy memory within the device
+	video_memory->CopyFrom(dest_ptr, *video_memory, src_ptr, size);
 
 	// Return
 	return 0;  
@@ -957,5 +951,129 @@ int Driver::CallRuntimeDebug(comm::Context *context,
 	return 0;
 }
 
+
+// ABI Call 'CommandQueueCreate'
+//
+// Create a command queue for a ring of packets allocated by the runtime in
+// guest memory. The ring starts with a header (see CommandQueue::Header)
+// followed by the packets.
+//
+// @param unsigned int ring_ptr
+//	Address of the ring in guest memory.
+//
+// @param unsigned int num_packets
+//	Number of packets in the ring.
+//
+// @return int
+//	The function returns the identifier of the new command queue.
+int Driver::CallCommandQueueCreate(comm::Context *context,
+		mem::Memory *memory,
+		unsigned args_ptr)
+{
+	unsigned ring_ptr;
+	unsigned num_packets;
+
+	// Read arguments
+	memory->Read(args_ptr, sizeof(unsigned), (char *) &ring_ptr);
+	memory->Read(args_ptr + 4, sizeof(unsigned), (char *) &num_packets);
+	debug << misc::fmt("\tring_ptr = 0x%x, num_packets = %u\n",
+			ring_ptr, num_packets);
+
+	// Let the emulator drain the command queues once per iteration
+	SI::Emulator *emulator = SI::Emulator::getInstance();
+	emulator->setCommandQueueHandler([this]()
+	{
+		return ProcessCommandQueues();
+	});
+
+	// Create command queue
+	int id = command_queues.size();
+	command_queues.emplace_back(misc::new_unique<CommandQueue>(id,
+			memory, ring_ptr, num_packets));
+	debug << misc::fmt("\tcommand queue %d created\n", id);
+
+	// Return
+	return id;
+}
+
+
+// ABI Call 'CommandQueueWait'
+//
+// Block the calling context until a packet of a command queue completes.
+//
+// @param int command_queue_id
+//	Command queue identifier, as returned by 'CommandQueueCreate'.
+//
+// @param unsigned int index
+//	Index of the packet, as written by the runtime into the ring header
+//	before posting the packet.
+//
+// @return int
+//	The function always returns 0.
+int Driver::CallCommandQueueWait(comm::Context *context,
+		mem::Memory *memory,
+		unsigned args_ptr)
+{
+	int command_queue_id;
+	unsigned index;
+
+	// Read arguments
+	memory->Read(args_ptr, sizeof(int), (char *) &command_queue_id);
+	memory->Read(args_ptr + 4, sizeof(unsigned), (char *) &index);
+	debug << misc::fmt("\tcommand_queue_id = %d, index = %u\n",
+			command_queue_id, index);
+
+	// Get command queue
+	CommandQueue *command_queue = getCommandQueueById(command_queue_id);
+	if (!command_queue)
+		throw Error(misc::fmt("%s: invalid command queue ID (%d)",
+				__FUNCTION__, command_queue_id));
+
+	// Process pending packets first, so that memory transfers posted
+	// right before the call do not need to wait for the next iteration
+	// of the emulation loop.
+	command_queue->Process();
+	command_queue->Wait(context, index);
+
+	// Return
+	return 0;
+}
+
+
+// ABI Call 'CommandQueueFree'
+//
+// Free a command queue. The runtime must have waited for all its packets.
+//
+// @param int command_queue_id
+//	Command queue identifier.
+//
+// @return int
+//	The function always returns 0.
+int Driver::CallCommandQueueFree(comm::Context *context,
+		mem::Memory *memory,
+		unsigned args_ptr)
+{
+	int command_queue_id;
+
+	// Read arguments
+	memory->Read(args_ptr, sizeof(int), (char *) &command_queue_id);
+	debug << misc::fmt("\tcommand_queue_id = %d\n", command_queue_id);
+
+	// Get command queue
+	CommandQueue *command_queue = getCommandQueueById(command_queue_id);
+	if (!command_queue)
+		throw Error(misc::fmt("%s: invalid command queue ID (%d)",
+				__FUNCTION__, command_queue_id));
+	if (!command_queue->isIdle())
+		throw Error(misc::fmt("%s: command queue %d not idle",
+				__FUNCTION__, command_queue_id));
+
+	// Free
+	command_queues[command_queue_id].reset();
+
+	// Return
+	return 0;
+}
+
 }  // namepsace SI
 
@@ -90,10 +90,13 @@ void Emulator::DumpSummary(std::ostream &os) const
 
 bool Emulator::Run()
 {
+	// Drain the command queues shared with the runtime
+	bool active = ProcessCommandQueues();
+
 	// For efficiency when no Southern Islands emulation is selected, 
 	// exit here if the list of existing ND-Ranges is empty. 
 	if (!getNumNDRanges())
-		return false;
+		return active;
 
 	// NDRange list is shared by CL/GL driver
 	for (auto it = getNDRangesBegin(), e = getNDRangesEnd(); it !=e; ++it)
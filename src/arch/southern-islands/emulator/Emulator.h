@@ -20,6 +20,7 @@
 #ifndef ARCH_SOUTHERN_ISLANDS_EMULATOR_EMULATOR_H
 #define ARCH_SOUTHERN_ISLANDS_EMULATOR_EMULATOR_H
 
+#include <functional>
 #include <iostream>
 #include <list>
 #include <memory>
@@ -128,6 +129,10 @@ private:
 
 	// Number of ndranges currently running
 	int ndranges_running = 0;
+
+	// Function installed by the driver to process the command queues
+	// shared with the runtime
+	std::function<bool()> command_queue_handler;
 	
 public:
 
@@ -282,6 +287,22 @@ public:
 
 	/// Set global_memory
 	void setGlobalMemory(mem::Memory *memory) { global_memory = memory; }
+
+	/// Install a function processing the command queues of the driver.
+	/// The function returns \c true if any command queue has work left.
+	void setCommandQueueHandler(std::function<bool()> handler)
+	{
+		command_queue_handler = handler;
+	}
+
+	/// Process the command queues of the driver, if any. This function
+	/// is invoked at the beginning of every iteration of the functional
+	/// and timing simulation loops. It returns \c true if there is work
+	/// left in any command queue.
+	bool ProcessCommandQueues()
+	{
+		return command_queue_handler && command_queue_handler();
+	}
 	
 	/// Set work_group_count
 	void setWorkGroupCount(long long count) { num_work_groups = count; }
@@ -309,6 +330,9 @@ public:
 			StopTimer();
 	}
 	
+	/// Return the number of ND-Ranges running
+	int getNumNDRangesRunning() const { return ndranges_running; }
+
 	/// Increment work_group_count
 	void incWorkGroupCount() { num_work_groups++; }
 
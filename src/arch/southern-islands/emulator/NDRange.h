@@ -408,6 +408,9 @@ public:
 		return work_group_id;
 	} 
 
+	/// Discard all work groups that were not scheduled yet
+	void ClearWaitingWorkGroups() { waiting_work_groups.clear(); }
+
 	/// Get empty status of running_work_groups
 	bool isWaitingWorkGroupsEmpty() const 
 	{ 
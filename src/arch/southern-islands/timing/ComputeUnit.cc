@@ -74,12 +74,41 @@ ComputeUnit::ComputeUnit(int index, Gpu *gpu) :
 		fetch_buffers[i] = misc::new_unique<FetchBuffer>(i, this);
 		simd_units[i] = misc::new_unique<SimdUnit>(this);
 	}
+
+	// Create wavefront scheduler
+	wavefront_scheduler = WavefrontScheduler::Create(this);
+}
+
+
+FetchBuffer::QueueType ComputeUnit::getIssueQueue(Uop *uop) const
+{
+	// Branch and scalar instructions are checked first, since their
+	// instruction formats overlap
+	if (branch_unit.isValidUop(uop))
+		return FetchBuffer::QueueBranch;
+	if (scalar_unit.isValidUop(uop))
+		return FetchBuffer::QueueScalar;
+
+	// All SIMD units accept the same instructions
+	if (simd_units.size() && simd_units[0]->isValidUop(uop))
+		return FetchBuffer::QueueSimd;
+	if (vector_memory_unit.isValidUop(uop))
+		return FetchBuffer::QueueVectorMemory;
+	if (lds_unit.isValidUop(uop))
+		return FetchBuffer::QueueLds;
+
+	// Not accepted by any execution unit
+	return FetchBuffer::QueueOther;
 }
 
 
 void ComputeUnit::IssueToExecutionUnit(FetchBuffer *fetch_buffer,
+		FetchBuffer::QueueType queue_type,
 		ExecutionUnit *execution_unit)
 {
+	// Issue queue for this type of execution unit
+	FetchBuffer::Queue &queue = fetch_buffer->getQueue(queue_type);
+
 	// Issue at most 'max_instructions_per_type'
 	for (int num_issued_instructions = 0;
 			num_issued_instructions < max_instructions_issued_per_type;
@@ -89,42 +118,24 @@ void ComputeUnit::IssueToExecutionUnit(FetchBuffer *fetch_buffer,
 		if (!execution_unit->canIssue())
 			break;
 
-		// Find oldest uop
-		auto oldest_uop_iterator = fetch_buffer->end();
-		for (auto it = fetch_buffer->begin(),
-				e = fetch_buffer->end();
-				it != e;
-				++it)
-		{
-			// Discard uop if it is not suitable for this execution
-			// unit
-			Uop *uop = it->get();
-			if (!execution_unit->isValidUop(uop))
-				continue;
-
-			// Skip uops that have not completed fetch
-			if (timing->getCycle() < uop->fetch_ready)
-				continue;
-
-			// Save oldest uop
-			if (oldest_uop_iterator == fetch_buffer->end() ||
-					uop->getWavefront()->getId() <
-					(*oldest_uop_iterator)->getWavefront()->getId())
-				oldest_uop_iterator = it;
-		}
+		// Select uop according to the scheduling policy
+		auto uop_iterator = wavefront_scheduler->Select(fetch_buffer,
+				queue_type, timing->getCycle());
 
 		// Stop if no instruction found
-		if (oldest_uop_iterator == fetch_buffer->end())
+		if (uop_iterator == queue.end())
 			break;
 
-		Uop *uop = oldest_uop_iterator->get();
+		Uop *uop = uop_iterator->get();
+		assert(execution_unit->isValidUop(uop));
 		long long compute_unit_id = uop->getIdInComputeUnit();
 		int wavefront_id = uop->getWavefront()->getId();
 		long long id_in_wavefront = uop->getIdInWavefront();
 
 		// Erase from fetch buffer, issue to execution unit
-		execution_unit->Issue(std::move(*oldest_uop_iterator));
-		fetch_buffer->Remove(oldest_uop_iterator);
+		wavefront_scheduler->Issued(fetch_buffer, queue_type, uop);
+		execution_unit->Issue(fetch_buffer->Remove(queue_type,
+				uop_iterator));
 
 		// Trace
 		Timing::trace << misc::fmt("si.inst "
@@ -144,46 +155,28 @@ void ComputeUnit::IssueToExecutionUnit(FetchBuffer *fetch_buffer,
 void ComputeUnit::Issue(FetchBuffer *fetch_buffer)
 {
 	// Issue instructions to branch unit
-	IssueToExecutionUnit(fetch_buffer, &branch_unit);
+	IssueToExecutionUnit(fetch_buffer, FetchBuffer::QueueBranch,
+			&branch_unit);
 
 	// Issue instructions to scalar unit
-	IssueToExecutionUnit(fetch_buffer, &scalar_unit);
+	IssueToExecutionUnit(fetch_buffer, FetchBuffer::QueueScalar,
+			&scalar_unit);
 
 	// Issue instructions to SIMD units
 	for (auto &simd_unit : simd_units)
-		IssueToExecutionUnit(fetch_buffer, simd_unit.get());
+		IssueToExecutionUnit(fetch_buffer, FetchBuffer::QueueSimd,
+				simd_unit.get());
 
 	// Issue instructions to vector memory unit
-	IssueToExecutionUnit(fetch_buffer, &vector_memory_unit);
+	IssueToExecutionUnit(fetch_buffer, FetchBuffer::QueueVectorMemory,
+			&vector_memory_unit);
 
 	// Issue instructions to LDS unit
-	IssueToExecutionUnit(fetch_buffer, &lds_unit);
+	IssueToExecutionUnit(fetch_buffer, FetchBuffer::QueueLds,
+			&lds_unit);
 
 	// Update visualization states for all instructions not issued
-	for (auto it = fetch_buffer->begin(),
-			e = fetch_buffer->end();
-			it != e;
-			++it)
-	{
-		// Get Uop
-		Uop *uop = it->get();
-
-		// Skip uops that have not completed fetch
-		if (timing->getCycle() < uop->fetch_ready)
-			continue;
-
-		// Trace
-		Timing::trace << misc::fmt("si.inst "
-				"id=%lld "
-				"cu=%d "
-				"wf=%d "
-				"uop_id=%lld "
-				"stg=\"s\"\n",
-				uop->getIdInComputeUnit(),
-				index,
-				uop->getWavefront()->getId(),
-				uop->getIdInWavefront());
-	}
+	UpdateFetchVisualization(fetch_buffer);
 }
 
 
@@ -403,7 +396,8 @@ void ComputeUnit::Fetch(FetchBuffer *fetch_buffer,
 
 		// Insert uop into fetch buffer
 		uop->getWorkGroup()->inflight_instructions++;
-		fetch_buffer->addUop(std::move(uop));
+		FetchBuffer::QueueType queue_type = getIssueQueue(uop.get());
+		fetch_buffer->addUop(queue_type, std::move(uop));
 
 		instructions_processed++;
 		num_total_instructions++;
@@ -579,49 +573,55 @@ void ComputeUnit::UnmapWorkGroup(WorkGroup *work_group)
 	// Unmap wavefronts from instruction buffer
 	work_group->wavefront_pool->UnmapWavefronts(work_group);
 	
-	// If compute unit is not already in the available list, place
-	// it there. The vector list of work groups does not shrink,
-	// when we unmap a workgroup.
-	assert((int) work_groups.size() <= gpu->getWorkGroupsPerComputeUnit());
-	if (!in_available_compute_units)
-		gpu->InsertInAvailableComputeUnits(this);
+	// The list of available compute units and the ND-Range are shared
+	// with other compute units, so the rest of the unmapping is deferred
+	// when compute units run in parallel.
+	esim::Engine *esim_engine = esim::Engine::getInstance();
+	esim_engine->Defer([this, gpu, work_group]()
+	{
+		// If compute unit is not already in the available list, place
+		// it there. The vector list of work groups does not shrink,
+		// when we unmap a workgroup.
+		assert((int) work_groups.size() <=
+				gpu->getWorkGroupsPerComputeUnit());
+		if (!in_available_compute_units)
+			gpu->InsertInAvailableComputeUnits(this);
 
-	// Trace
-	Timing::trace << misc::fmt("si.unmap_wg cu=%d wg=%d\n", index,
-			work_group->getId());
+		// Trace
+		Timing::trace << misc::fmt("si.unmap_wg cu=%d wg=%d\n", index,
+				work_group->getId());
 
-	// Remove the work group from the running work groups list
-	NDRange *ndrange = work_group->getNDRange();
-	ndrange->RemoveWorkGroup(work_group);
+		// Remove the work group from the running work groups list
+		NDRange *ndrange = work_group->getNDRange();
+		ndrange->RemoveWorkGroup(work_group);
+	});
 }
 
 
 void ComputeUnit::UpdateFetchVisualization(FetchBuffer *fetch_buffer)
 {
-	for (auto it = fetch_buffer->begin(),
-			e = fetch_buffer->end();
-			it != e;
-			++it)
+	for (int i = 0; i < FetchBuffer::QueueCount; i++)
 	{
-		// Get uop
-		Uop *uop = it->get();
-		assert(uop);
-
-		// Skip all uops that have not yet completed the fetch
-		if (timing->getCycle() < uop->fetch_ready)
-			break;
+		auto queue_type = (FetchBuffer::QueueType) i;
+		for (auto &uop : fetch_buffer->getQueue(queue_type))
+		{
+			// Skip all uops that have not yet completed the fetch
+			assert(uop);
+			if (timing->getCycle() < uop->fetch_ready)
+				continue;
 
-		// Trace
-		Timing::trace << misc::fmt("si.inst "
-				"id=%lld "
-				"cu=%d "
-				"wf=%d "
-				"uop_id=%lld "
-				"stg=\"s\"\n",
-				uop->getIdInComputeUnit(),
-				index,
-				uop->getWavefront()->getId(),
-				uop->getIdInWavefront());
+			// Trace
+			Timing::trace << misc::fmt("si.inst "
+					"id=%lld "
+					"cu=%d "
+					"wf=%d "
+					"uop_id=%lld "
+					"stg=\"s\"\n",
+					uop->getIdInComputeUnit(),
+					index,
+					uop->getWavefront()->getId(),
+					uop->getIdInWavefront());
+		}
 	}
 }
 
@@ -629,9 +629,17 @@ void ComputeUnit::UpdateFetchVisualization(FetchBuffer *fetch_buffer)
 void ComputeUnit::Run()
 {
 	// Return if no work groups are mapped to this compute unit
-	if (!work_groups.size())
+	if (!isActive())
 		return;
-	
+
+	// Advance all stages
+	RunExecutionUnits();
+	RunFetch();
+}
+
+
+void ComputeUnit::RunExecutionUnits()
+{
 	// Save timing simulator
 	timing = Timing::getInstance();
 
@@ -666,7 +674,11 @@ void ComputeUnit::Run()
 			UpdateFetchVisualization(fetch_buffers[i].get());
 		}
 	}
+}
 
+
+void ComputeUnit::RunFetch()
+{
 	// Fetch
 	for (int i = 0; i < num_wavefront_pools; i++)
 		Fetch(fetch_buffers[i].get(), wavefront_pools[i].get());
@@ -31,6 +31,7 @@
 #include "ScalarUnit.h"
 #include "VectorMemoryUnit.h"
 #include "WavefrontPool.h"
+#include "WavefrontScheduler.h"
 
 
 namespace SI
@@ -53,9 +54,14 @@ class ComputeUnit
 	// appropriate execution unit.
 	void Issue(FetchBuffer *fetch_buffer);
 
-	// Issue a set of instructions from the given fetch buffer into the
-	// given execution unit.
+	// Return the issue queue of a fetch buffer where the given uop is
+	// inserted, based on the execution unit that can absorb it.
+	FetchBuffer::QueueType getIssueQueue(Uop *uop) const;
+
+	// Issue a set of instructions from the given issue queue of a fetch
+	// buffer into the given execution unit.
 	void IssueToExecutionUnit(FetchBuffer *fetch_buffer,
+			FetchBuffer::QueueType queue_type,
 			ExecutionUnit *execution_unit);
 
 	// Update the visualization states for non-issued instructions
@@ -95,6 +101,9 @@ class ComputeUnit
 	// One instance of the vector memory unit
 	VectorMemoryUnit vector_memory_unit;
 
+	// Wavefront scheduler selecting the uops to issue
+	std::unique_ptr<WavefrontScheduler> wavefront_scheduler;
+
 	// Associated LDS module
 	std::unique_ptr<mem::Module> lds_module;
 
@@ -161,6 +170,20 @@ public:
 	/// Advance compute unit state by one cycle
 	void Run();
 
+	/// Advance the execution units and the issue stage by one cycle. This
+	/// part of the cycle does not invoke the functional emulator, and can
+	/// run in parallel with other compute units within a parallel region
+	/// of the event-driven simulator.
+	void RunExecutionUnits();
+
+	/// Advance the fetch stage by one cycle. Fetching runs the functional
+	/// emulator, so compute units must fetch sequentially.
+	void RunFetch();
+
+	/// Return whether work groups have ever been mapped to the compute
+	/// unit. Idle compute units are not simulated.
+	bool isActive() const { return work_groups.size(); }
+
 	/// Return the index of this compute unit in the GPU
 	int getIndex() const { return index; }
 
@@ -173,6 +196,12 @@ public:
 
 	/// Return the associated timing simulator
 	Timing *getTiming() const { return timing; }
+
+	/// Return the wavefront scheduler of the compute unit
+	WavefrontScheduler *getWavefrontScheduler() const
+	{
+		return wavefront_scheduler.get();
+	}
 	
 	/// Map a work group to the compute unit
 	void MapWorkGroup(WorkGroup *work_group);
@@ -202,6 +231,9 @@ public:
 	/// Flag to indicate if the compute unit is currently available or not
 	bool in_available_compute_units = false;
 
+	/// Last cycle when a uop completed execution in this compute unit
+	long long last_complete_cycle = 0;
+
 
 
 
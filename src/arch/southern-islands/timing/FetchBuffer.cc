@@ -18,6 +18,9 @@
  */
 
 #include <cassert>
+#include <iterator>
+
+#include <arch/southern-islands/emulator/Wavefront.h>
 
 #include "FetchBuffer.h"
 
@@ -25,11 +28,34 @@
 namespace SI
 {
 
-void FetchBuffer::Remove(std::list<std::unique_ptr<Uop>>::iterator it)
+void FetchBuffer::addUop(QueueType queue_type, std::unique_ptr<Uop> uop)
 {
-	assert(it != buffer.end());
-	buffer.erase(it);
+	// Find position after all uops from older or equal wavefronts. In the
+	// common case the uop is the youngest and it is appended.
+	assert(queue_type >= 0 && queue_type < QueueCount);
+	Queue &queue = queues[queue_type];
+	int wavefront_id = uop->getWavefront()->getId();
+	auto it = queue.end();
+	while (it != queue.begin() &&
+			(*std::prev(it))->getWavefront()->getId() > wavefront_id)
+		--it;
+
+	// Insert
+	queue.insert(it, std::move(uop));
+	size++;
 }
 
+
+std::unique_ptr<Uop> FetchBuffer::Remove(QueueType queue_type,
+		Queue::iterator it)
+{
+	assert(queue_type >= 0 && queue_type < QueueCount);
+	Queue &queue = queues[queue_type];
+	assert(it != queue.end());
+	std::unique_ptr<Uop> uop = std::move(*it);
+	queue.erase(it);
+	size--;
+	return uop;
 }
 
+}
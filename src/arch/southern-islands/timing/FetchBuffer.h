@@ -20,8 +20,8 @@
 #ifndef ARCH_SOUTHERN_ISLANDS_TIMING_FETCH_BUFFER_H
 #define ARCH_SOUTHERN_ISLANDS_TIMING_FETCH_BUFFER_H
 
+#include <deque>
 #include <memory>
-#include <list>
 
 #include "Uop.h"
 
@@ -33,17 +33,44 @@ namespace SI
 class ComputeUnit;
 
 
-/// Class representing a fetch buffer in the compute unit front-end
+/// Class representing a fetch buffer in the compute unit front-end. Fetched
+/// uops are classified by the type of execution unit that can absorb them,
+/// and stored in one issue queue per type. Each queue is kept ordered by age
+/// (wavefront identifier), so that the issue stage can select the oldest
+/// ready uop for an execution unit without scanning uops of other types.
 class FetchBuffer
 {
+public:
+
+	/// Issue queues, one per execution unit type
+	enum QueueType
+	{
+		QueueBranch = 0,
+		QueueScalar,
+		QueueSimd,
+		QueueVectorMemory,
+		QueueLds,
+		QueueOther,
+		QueueCount
+	};
+
+	/// Issue queue type, ordered by age
+	using Queue = std::deque<std::unique_ptr<Uop>>;
+
+private:
+
 	// Global fetch buffer identifier, assigned in constructor
 	int id;
 
 	// Compute unit that it belongs to, assigned in constructor
 	ComputeUnit *compute_unit;
 
-	// Buffer of instructions
-	std::list<std::unique_ptr<Uop>> buffer;
+	// Issue queues. Queue 'QueueOther' holds uops that cannot be
+	// absorbed by any execution unit.
+	Queue queues[QueueCount];
+
+	// Total number of uops in all queues
+	int size = 0;
 
 public:
 	
@@ -56,34 +83,27 @@ public:
 	}
 
 	/// Return the number of uops in the fetch buffer
-	int getSize() { return buffer.size(); }
+	int getSize() const { return size; }
 
 	/// Return the identifier for this fetch buffer
 	int getId() const { return id; }
 
-	/// Add instruction to the end of the buffer
-	void addUop(std::unique_ptr<SI::Uop> uop)
-	{
-		buffer.push_back(std::move(uop));
-	}
-
-	/// Return an iterator to the first uop in the fetch buffer
-	std::list<std::unique_ptr<Uop>>::iterator begin()
-	{
-		return buffer.begin();
-	}
+	/// Add a uop to the given issue queue, in the position given by the
+	/// identifier of its wavefront. Uops from the same wavefront are kept
+	/// in fetch order.
+	void addUop(QueueType queue_type, std::unique_ptr<Uop> uop);
 
-	/// Return a past-the-end iterator to the fetch buffer
-	std::list<std::unique_ptr<Uop>>::iterator end()
+	/// Return the issue queue of the given type
+	Queue &getQueue(QueueType queue_type)
 	{
-		return buffer.end();
+		return queues[queue_type];
 	}
 
-	/// Remove the uop pointed to by the given iterator.
-	void Remove(std::list<std::unique_ptr<Uop>>::iterator it);
+	/// Remove the uop pointed to by the given iterator of an issue queue,
+	/// and return it.
+	std::unique_ptr<Uop> Remove(QueueType queue_type, Queue::iterator it);
 };
 
 }
 
 #endif
-
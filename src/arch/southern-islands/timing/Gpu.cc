@@ -17,6 +17,8 @@
  *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <algorithm>
+
 #include <arch/southern-islands/emulator/Emulator.h>
 #include <arch/southern-islands/emulator/NDRange.h>
 
@@ -59,6 +61,12 @@ Gpu::Gpu()
 		ComputeUnit *compute_unit = compute_units.back().get();
 		InsertInAvailableComputeUnits(compute_unit);
 	}
+
+	// Host threads
+	num_partitions = std::min(esim::Engine::getNumHostThreads(),
+			num_compute_units);
+	if (num_partitions > 1)
+		thread_pool = misc::new_unique<misc::ThreadPool>(num_partitions);
 }
 
 
@@ -197,11 +205,60 @@ void Gpu::CalcGetWorkGroupsPerWavefrontPool(int work_items_per_work_group,
 }
 
 
+void Gpu::RunParallel()
+{
+	// Compute units with work
+	active_compute_units.clear();
+	for (auto &compute_unit : compute_units)
+		if (compute_unit->isActive())
+			active_compute_units.push_back(compute_unit.get());
+	if (active_compute_units.empty())
+		return;
+
+	// Run execution units for groups of consecutive compute units in
+	// parallel. Accesses to the memory hierarchy and updates of shared
+	// state are deferred until the end of the parallel region. Pipeline
+	// traces and debug information are written in compute unit order
+	// within each stage, so they require a single group. The region is
+	// used even with a single group, so that the order of deferred
+	// actions does not depend on the number of host threads.
+	int num_active = active_compute_units.size();
+	int num_groups = Timing::trace || Timing::pipeline_debug ||
+			Emulator::scheduler_debug ? 1 :
+			std::min(num_partitions, num_active);
+	auto run_group = [this, num_groups, num_active](int partition)
+	{
+		esim::Engine::setPartition(partition);
+		int first = partition * num_active / num_groups;
+		int last = (partition + 1) * num_active / num_groups;
+		for (int i = first; i < last; i++)
+			active_compute_units[i]->RunExecutionUnits();
+	};
+	esim::Engine *esim_engine = esim::Engine::getInstance();
+	esim_engine->BeginParallel(num_groups);
+	thread_pool->Run(num_groups, run_group);
+	esim_engine->EndParallel();
+
+	// Fetch runs the functional emulator, so it is sequential
+	for (ComputeUnit *compute_unit : active_compute_units)
+		compute_unit->RunFetch();
+}
+
+
 void Gpu::Run()
 {
-	// Advance one cycle in each compute unit
+	// Advance one cycle in each compute unit. Without host threads, all
+	// stages of one compute unit run before moving to the next one.
+	if (thread_pool)
+		RunParallel();
+	else
+		for (auto &compute_unit : compute_units)
+			compute_unit->Run();
+
+	// Last cycle when a uop completed in any compute unit
 	for (auto &compute_unit : compute_units)
-		compute_unit->Run();
+		last_complete_cycle = std::max(last_complete_cycle,
+				compute_unit->last_complete_cycle);
 }
 
 }
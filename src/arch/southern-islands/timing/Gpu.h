@@ -23,6 +23,7 @@
 #include <vector>
 
 #include <lib/cpp/Misc.h>
+#include <lib/cpp/ThreadPool.h>
 #include <memory/Mmu.h>
 
 #include "ComputeUnit.h"
@@ -73,6 +74,20 @@ private:
 	/// Number of work_groups allowed in a compute unit
 	int work_groups_per_compute_unit = 0;
 
+	// Pool of host threads running groups of compute units in parallel,
+	// or null if compute units run sequentially.
+	std::unique_ptr<misc::ThreadPool> thread_pool;
+
+	// Number of groups of consecutive compute units run in parallel
+	int num_partitions = 1;
+
+	// Compute units active in the current cycle
+	std::vector<ComputeUnit *> active_compute_units;
+
+	// Advance one cycle in each active compute unit, running the execution
+	// units in a parallel region of the event-driven engine.
+	void RunParallel();
+
 public:
 
 	//
@@ -322,11 +322,18 @@ void LdsUnit::Mem()
 					throw misc::Panic("Invalid lds access");
 				}
 
-				// Start access
-				compute_unit->getLdsModule()->Access(
-						access_type,
-						work_item_info->lds_access[i].addr,
-						&uop->lds_witness);
+				// Start access, deferred when compute units run
+				// in parallel
+				unsigned address = work_item_info->lds_access[i].addr;
+				int *witness = &uop->lds_witness;
+				esim::Engine::getInstance()->Defer([compute_unit,
+						access_type, address, witness]()
+				{
+					compute_unit->getLdsModule()->Access(
+							access_type,
+							address,
+							witness);
+				});
 				uop->lds_witness--;
 			}
 		}
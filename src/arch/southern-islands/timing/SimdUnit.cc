@@ -77,7 +77,6 @@ void SimdUnit::Complete()
 {
 	// Get useful objects
 	ComputeUnit *compute_unit = getComputeUnit();
-	Gpu *gpu = compute_unit->getGpu();
 
 	// Sanity check exec buffer
 	assert(int(exec_buffer.size()) <= exec_buffer_size);
@@ -107,7 +106,7 @@ void SimdUnit::Complete()
 
 		// Statistics
 		num_instructions++;
-		gpu->last_complete_cycle = compute_unit->getTiming()->getCycle();
+		compute_unit->last_complete_cycle = compute_unit->getTiming()->getCycle();
 
 		// Remove uop from the exec buffer and get the iterator to the
 		// next element
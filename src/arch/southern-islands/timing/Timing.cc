@@ -24,6 +24,7 @@
 
 #include "ComputeUnit.h"
 #include "Timing.h"
+#include "WavefrontScheduler.h"
 
 
 namespace SI
@@ -103,6 +104,24 @@ const std::string Timing::help_message =
 	"  MaxInstIssuedPerType = <num> (Default = 1)\n"
 	"      Maximum number of instructions that can be issued of each type\n"
 	"      (SIMD, scalar, etc.) in a single cycle.\n"
+	"  IssuePolicy = {Oldest|GTO|LRR|TwoLevel|CCWS} (Default = Oldest)\n"
+	"      Policy selecting the wavefront that issues to each execution\n"
+	"      unit: oldest wavefront first, greedy-then-oldest, loose\n"
+	"      round-robin, two-level with a small active set of wavefronts,\n"
+	"      or cache-conscious, throttling vector memory instructions of\n"
+	"      wavefronts that lose locality in the vector cache.\n"
+	"  TwoLevelActiveWavefronts = <num> (Default = 4)\n"
+	"      Number of wavefronts per wavefront pool in the active set of\n"
+	"      the two-level policy.\n"
+	"  CCWSVictimTagEntries = <num> (Default = 16)\n"
+	"      Number of entries in the victim tag array of each wavefront\n"
+	"      for the cache-conscious policy.\n"
+	"  CCWSCacheBlocks = <num> (Default = 256)\n"
+	"      Number of vector cache blocks tracked by the cache-conscious\n"
+	"      policy to detect lost locality.\n"
+	"  CCWSLostLocalityScore = <num> (Default = 32)\n"
+	"      Score added to a wavefront every time it loses locality, for\n"
+	"      the cache-conscious policy.\n"
 	"\n"
 	"Section '[ SIMDUnit ]': parameters for the SIMD Units.\n"
 	"\n"
@@ -749,6 +768,32 @@ void Timing::ParseConfiguration(misc::IniFile *ini_file)
 	ComputeUnit::max_instructions_issued_per_type = ini_file->ReadInt(section,
 					"MaxInstructionsIssuedPerType",
 					ComputeUnit::max_instructions_issued_per_type);
+	WavefrontScheduler::policy = (WavefrontScheduler::Policy)
+			ini_file->ReadEnum(section, "IssuePolicy",
+			WavefrontScheduler::policy_map,
+			WavefrontScheduler::policy);
+	WavefrontScheduler::two_level_active_wavefronts = ini_file->ReadInt(
+			section, "TwoLevelActiveWavefronts",
+			WavefrontScheduler::two_level_active_wavefronts);
+	WavefrontScheduler::ccws_victim_tag_entries = ini_file->ReadInt(
+			section, "CCWSVictimTagEntries",
+			WavefrontScheduler::ccws_victim_tag_entries);
+	WavefrontScheduler::ccws_cache_blocks = ini_file->ReadInt(
+			section, "CCWSCacheBlocks",
+			WavefrontScheduler::ccws_cache_blocks);
+	WavefrontScheduler::ccws_lost_locality_score = ini_file->ReadInt(
+			section, "CCWSLostLocalityScore",
+			WavefrontScheduler::ccws_lost_locality_score);
+	if (WavefrontScheduler::two_level_active_wavefronts < 1)
+		throw Error(misc::fmt("%s: The value for "
+				"'TwoLevelActiveWavefronts' must be greater "
+				"than 0.\n", ini_file->getPath().c_str()));
+	if (WavefrontScheduler::ccws_victim_tag_entries < 1 ||
+			WavefrontScheduler::ccws_cache_blocks < 1)
+		throw Error(misc::fmt("%s: The values for "
+				"'CCWSVictimTagEntries' and 'CCWSCacheBlocks' "
+				"must be greater than 0.\n",
+				ini_file->getPath().c_str()));
 
 	// Section [SimdUnit]
 	section = "SimdUnit";
@@ -894,6 +939,9 @@ void Timing::DumpConfiguration(std::ofstream &os) const
 	os << misc::fmt("IssueWidth = %d\n", ComputeUnit::issue_width);
 	os << misc::fmt("MaxInstIssuedPerType = %d\n",
 			ComputeUnit::max_instructions_issued_per_type);
+	os << misc::fmt("IssuePolicy = %s\n",
+			WavefrontScheduler::policy_map[
+			WavefrontScheduler::policy]);
 	os << misc::fmt("\n");
 
 	// SIMD Unit
@@ -1095,6 +1143,8 @@ void Timing::DumpReport() const
 		report << misc::fmt("VectorRegWrites= %lld\n",                            
 				compute_unit->num_vreg_writes);                         
 		report << misc::fmt("\n");                                                
+		compute_unit->getWavefrontScheduler()->DumpReport(report);
+		report << misc::fmt("\n");
 		report << misc::fmt("LDS.Accesses = %lld\n",                              
 				compute_unit->getLdsModule()->num_reads 
 				+ compute_unit->getLdsModule()->num_writes);                       
@@ -1117,10 +1167,13 @@ bool Timing::Run()
 	// Get SI Driver
 	Emulator *emulator = Emulator::getInstance();
 
+	// Drain the command queues shared with the runtime
+	bool active = emulator->ProcessCommandQueues();
+
 	// For efficiency when no Southern Islands emulation is selected, 
 	// exit here if the list of existing ND-Ranges is empty. 
 	if (!emulator->getNumNDRanges())
-		return false;
+		return active;
 
 	// Add any available work groups to the waiting list
 	for (auto it = emulator->getNDRangesBegin();
@@ -84,7 +84,6 @@ void VectorMemoryUnit::Complete()
 {
 	// Get compute unit and GPU objects
 	ComputeUnit *compute_unit = getComputeUnit();
-	Gpu *gpu = compute_unit->getGpu();
 
 	// Sanity check the write buffer
 	assert((int) write_buffer.size() <= width);
@@ -121,7 +120,7 @@ void VectorMemoryUnit::Complete()
 
 		// Statistics
 		num_instructions++;
-		gpu->last_complete_cycle = compute_unit->getTiming()->getCycle();
+		compute_unit->last_complete_cycle = compute_unit->getTiming()->getCycle();
 	}
 }
 
@@ -337,30 +336,43 @@ void VectorMemoryUnit::Memory()
 				if (work_item_info->accessed_cache)	
 					continue;
 
-				// Translate virtual address to a physical 
-				// address
-				unsigned physical_address = compute_unit->
-						getGpu()->
-						getMmu()->
-						TranslateVirtualAddress(
+				// Make sure we can access the vector cache. If 
+				// so, translate the virtual address to a
+				// physical address and submit the access. The
+				// MMU and the memory hierarchy are shared, so
+				// this is deferred when compute units run in
+				// parallel. If we can access the cache, mark
+				// the accessed flag of the work item info
+				// struct.
+				mem::Mmu::Space *address_space =
 						uop->getWorkGroup()->
 						getNDRange()->
-						address_space,
-						work_item_info->
-						global_memory_access_address);
-		
-
-				// Make sure we can access the vector cache. If 
-				// so, submit the access. If we can access the
-				// cache, mark the accessed flag of the work 
-				// item info struct.
+						address_space;
+				unsigned address = work_item_info->
+						global_memory_access_address;
 				if (compute_unit->vector_cache->
-						canAccess(physical_address))
+						canAccess(address))
 				{
-					compute_unit->vector_cache->Access(
+					int *witness = &uop->global_memory_witness;
+					esim::Engine::getInstance()->Defer(
+							[compute_unit,
 							module_access_type,
-							physical_address, 
-							&uop->global_memory_witness);
+							address_space,
+							address,
+							witness]()
+					{
+						unsigned physical_address =
+								compute_unit->
+								getGpu()->
+								getMmu()->
+								TranslateVirtualAddress(
+								address_space,
+								address);
+						compute_unit->vector_cache->Access(
+								module_access_type,
+								physical_address,
+								witness);
+					});
 					work_item_info->accessed_cache = true;
 
 					// Access global memory
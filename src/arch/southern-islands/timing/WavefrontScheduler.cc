@@ -0,0 +1,512 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include <cassert>
+
+#include <arch/southern-islands/emulator/Wavefront.h>
+#include <lib/cpp/Error.h>
+#include <lib/cpp/Misc.h>
+#include <memory/Module.h>
+
+#include "ComputeUnit.h"
+#include "Timing.h"
+#include "Uop.h"
+#include "WavefrontScheduler.h"
+
+
+namespace SI
+{
+
+misc::StringMap WavefrontScheduler::policy_map =
+{
+	{ "Oldest", PolicyOldest },
+	{ "GTO", PolicyGto },
+	{ "LRR", PolicyLrr },
+	{ "TwoLevel", PolicyTwoLevel },
+	{ "CCWS", PolicyCcws }
+};
+
+WavefrontScheduler::Policy WavefrontScheduler::policy = PolicyOldest;
+int WavefrontScheduler::two_level_active_wavefronts = 4;
+int WavefrontScheduler::ccws_victim_tag_entries = 16;
+int WavefrontScheduler::ccws_cache_blocks = 256;
+int WavefrontScheduler::ccws_lost_locality_score = 32;
+
+
+
+//
+// Class 'WavefrontScheduler'
+//
+
+std::unique_ptr<WavefrontScheduler> WavefrontScheduler::Create(
+		ComputeUnit *compute_unit)
+{
+	switch (policy)
+	{
+
+	case PolicyOldest:
+		return misc::new_unique<WavefrontSchedulerOldest>(compute_unit);
+
+	case PolicyGto:
+		return misc::new_unique<WavefrontSchedulerGto>(compute_unit);
+
+	case PolicyLrr:
+		return misc::new_unique<WavefrontSchedulerLrr>(compute_unit);
+
+	case PolicyTwoLevel:
+		return misc::new_unique<WavefrontSchedulerTwoLevel>(
+				compute_unit);
+
+	case PolicyCcws:
+		return misc::new_unique<WavefrontSchedulerCcws>(compute_unit);
+
+	default:
+		throw misc::Panic("Invalid wavefront scheduling policy");
+	}
+}
+
+
+bool WavefrontScheduler::isReady(Uop *uop, long long cycle)
+{
+	return cycle >= uop->fetch_ready;
+}
+
+
+FetchBuffer::Queue::iterator WavefrontScheduler::SelectOldest(
+		FetchBuffer::Queue &queue,
+		long long cycle)
+{
+	return std::find_if(queue.begin(), queue.end(),
+			[cycle](const std::unique_ptr<Uop> &uop)
+			{
+				return isReady(uop.get(), cycle);
+			});
+}
+
+
+FetchBuffer::Queue::iterator WavefrontScheduler::Select(
+		FetchBuffer *fetch_buffer,
+		FetchBuffer::QueueType queue_type,
+		long long cycle)
+{
+	// Apply policy
+	FetchBuffer::Queue &queue = fetch_buffer->getQueue(queue_type);
+	auto it = SelectUop(fetch_buffer, queue_type, cycle);
+
+	// Record whether the policy held back uops ready to issue
+	if (it == queue.end() && SelectOldest(queue, cycle) != queue.end())
+		num_held++;
+	return it;
+}
+
+
+void WavefrontScheduler::Issued(FetchBuffer *fetch_buffer,
+		FetchBuffer::QueueType queue_type,
+		Uop *uop)
+{
+	num_selected++;
+	UopIssued(fetch_buffer, queue_type, uop);
+}
+
+
+void WavefrontScheduler::DumpReport(std::ostream &os) const
+{
+	os << misc::fmt("Scheduler.Policy = %s\n",
+			policy_map[scheduler_policy]);
+	os << misc::fmt("Scheduler.Issued = %lld\n", num_selected);
+	os << misc::fmt("Scheduler.Held = %lld\n", num_held);
+}
+
+
+
+//
+// Class 'WavefrontSchedulerOldest'
+//
+
+FetchBuffer::Queue::iterator WavefrontSchedulerOldest::SelectUop(
+		FetchBuffer *fetch_buffer,
+		FetchBuffer::QueueType queue_type,
+		long long cycle)
+{
+	return SelectOldest(fetch_buffer->getQueue(queue_type), cycle);
+}
+
+
+
+//
+// Class 'WavefrontSchedulerGto'
+//
+
+WavefrontSchedulerGto::WavefrontSchedulerGto(ComputeUnit *compute_unit) :
+		WavefrontScheduler(compute_unit, PolicyGto),
+		greedy_wavefront_ids(ComputeUnit::num_wavefront_pools, -1)
+{
+}
+
+
+FetchBuffer::Queue::iterator WavefrontSchedulerGto::SelectUop(
+		FetchBuffer *fetch_buffer,
+		FetchBuffer::QueueType queue_type,
+		long long cycle)
+{
+	// Uop from the greedy wavefront
+	FetchBuffer::Queue &queue = fetch_buffer->getQueue(queue_type);
+	int greedy_wavefront_id = greedy_wavefront_ids[fetch_buffer->getId()];
+	for (auto it = queue.begin(), e = queue.end(); it != e; ++it)
+	{
+		Uop *uop = it->get();
+		if (uop->getWavefront()->getId() == greedy_wavefront_id &&
+				isReady(uop, cycle))
+			return it;
+	}
+
+	// Oldest otherwise
+	return SelectOldest(queue, cycle);
+}
+
+
+void WavefrontSchedulerGto::UopIssued(FetchBuffer *fetch_buffer,
+			FetchBuffer::QueueType queue_type,
+			Uop *uop)
+{
+	// Count greedy issue
+	int &greedy_wavefront_id = greedy_wavefront_ids[fetch_buffer->getId()];
+	int wavefront_id = uop->getWavefront()->getId();
+	if (wavefront_id == greedy_wavefront_id)
+		num_greedy++;
+
+	// The wavefront becomes the greedy one, unless it finished
+	greedy_wavefront_id = uop->wavefront_last_instruction ?
+			-1 : wavefront_id;
+}
+
+
+void WavefrontSchedulerGto::DumpReport(std::ostream &os) const
+{
+	WavefrontScheduler::DumpReport(os);
+	os << misc::fmt("Scheduler.GreedyIssued = %lld\n", num_greedy);
+}
+
+
+
+//
+// Class 'WavefrontSchedulerLrr'
+//
+
+WavefrontSchedulerLrr::WavefrontSchedulerLrr(ComputeUnit *compute_unit) :
+		WavefrontScheduler(compute_unit, PolicyLrr),
+		last_wavefront_ids(ComputeUnit::num_wavefront_pools,
+				std::vector<int>(FetchBuffer::QueueCount, -1))
+{
+}
+
+
+FetchBuffer::Queue::iterator WavefrontSchedulerLrr::SelectUop(
+		FetchBuffer *fetch_buffer,
+		FetchBuffer::QueueType queue_type,
+		long long cycle)
+{
+	// First ready uop from a wavefront after the one that issued last.
+	// The queue is ordered by wavefront identifier.
+	FetchBuffer::Queue &queue = fetch_buffer->getQueue(queue_type);
+	int last_wavefront_id = last_wavefront_ids[fetch_buffer->getId()]
+			[queue_type];
+	for (auto it = queue.begin(), e = queue.end(); it != e; ++it)
+	{
+		Uop *uop = it->get();
+		if (uop->getWavefront()->getId() > last_wavefront_id &&
+				isReady(uop, cycle))
+			return it;
+	}
+
+	// Wrap around
+	return SelectOldest(queue, cycle);
+}
+
+
+void WavefrontSchedulerLrr::UopIssued(FetchBuffer *fetch_buffer,
+			FetchBuffer::QueueType queue_type,
+			Uop *uop)
+{
+	last_wavefront_ids[fetch_buffer->getId()][queue_type] =
+			uop->getWavefront()->getId();
+}
+
+
+
+//
+// Class 'WavefrontSchedulerTwoLevel'
+//
+
+WavefrontSchedulerTwoLevel::WavefrontSchedulerTwoLevel(
+		ComputeUnit *compute_unit) :
+		WavefrontScheduler(compute_unit, PolicyTwoLevel),
+		active_sets(ComputeUnit::num_wavefront_pools)
+{
+}
+
+
+bool WavefrontSchedulerTwoLevel::isActive(const std::deque<int> &active_set,
+		int wavefront_id)
+{
+	return std::find(active_set.begin(), active_set.end(),
+			wavefront_id) != active_set.end();
+}
+
+
+bool WavefrontSchedulerTwoLevel::RemoveActive(std::deque<int> &active_set,
+		int wavefront_id)
+{
+	auto it = std::find(active_set.begin(), active_set.end(),
+			wavefront_id);
+	if (it == active_set.end())
+		return false;
+	active_set.erase(it);
+	return true;
+}
+
+
+FetchBuffer::Queue::iterator WavefrontSchedulerTwoLevel::SelectUop(
+		FetchBuffer *fetch_buffer,
+		FetchBuffer::QueueType queue_type,
+		long long cycle)
+{
+	// Oldest ready uop from the active set. Wavefronts in the pending
+	// set join the active set in age order while there is room.
+	FetchBuffer::Queue &queue = fetch_buffer->getQueue(queue_type);
+	std::deque<int> &active_set = active_sets[fetch_buffer->getId()];
+	for (auto it = queue.begin(), e = queue.end(); it != e; ++it)
+	{
+		// Promote wavefront
+		Uop *uop = it->get();
+		int wavefront_id = uop->getWavefront()->getId();
+		if (!isActive(active_set, wavefront_id))
+		{
+			if ((int) active_set.size() >=
+					two_level_active_wavefronts)
+				continue;
+			active_set.push_back(wavefront_id);
+			num_promotions++;
+		}
+
+		// Select
+		if (isReady(uop, cycle))
+			return it;
+	}
+
+	// No uop ready in the active set
+	return queue.end();
+}
+
+
+void WavefrontSchedulerTwoLevel::UopIssued(FetchBuffer *fetch_buffer,
+		FetchBuffer::QueueType queue_type,
+		Uop *uop)
+{
+	// A wavefront leaves the active set when it finishes, when it issues
+	// a long latency instruction, or when it waits at a barrier. The
+	// wavefronts of a work-group share a wavefront pool, so keeping the
+	// ones at a barrier active would leave their pending siblings unable
+	// to reach it.
+	std::deque<int> &active_set = active_sets[fetch_buffer->getId()];
+	int wavefront_id = uop->getWavefront()->getId();
+	if (uop->wavefront_last_instruction)
+		RemoveActive(active_set, wavefront_id);
+	else if ((uop->vector_memory_read || uop->vector_memory_write ||
+			uop->at_barrier) &&
+			RemoveActive(active_set, wavefront_id))
+		num_demotions++;
+}
+
+
+void WavefrontSchedulerTwoLevel::DumpReport(std::ostream &os) const
+{
+	WavefrontScheduler::DumpReport(os);
+	os << misc::fmt("Scheduler.Promotions = %lld\n", num_promotions);
+	os << misc::fmt("Scheduler.Demotions = %lld\n", num_demotions);
+}
+
+
+
+//
+// Class 'WavefrontSchedulerCcws'
+//
+
+WavefrontSchedulerCcws::WavefrontState *
+WavefrontSchedulerCcws::getWavefrontState(int wavefront_id, long long cycle)
+{
+	// Create state for new wavefronts
+	auto it = wavefront_states.find(wavefront_id);
+	if (it == wavefront_states.end())
+	{
+		it = wavefront_states.emplace(wavefront_id,
+				WavefrontState()).first;
+		it->second.cycle = cycle;
+	}
+
+	// Decay score
+	WavefrontState *state = &it->second;
+	long long decay = cycle - state->cycle;
+	state->score = std::max((long long) base_score,
+			state->score - decay);
+	state->cycle = cycle;
+	return state;
+}
+
+
+bool WavefrontSchedulerCcws::canIssueMemory(int wavefront_id,
+		long long cycle)
+{
+	// Wavefronts are stacked in age order by their scores. Those whose
+	// stacked score exceeds the cutoff, given by the base score of all
+	// wavefronts, are throttled.
+	getWavefrontState(wavefront_id, cycle);
+	long long cutoff = (long long) base_score * wavefront_states.size();
+	long long total_score = 0;
+	for (auto &it : wavefront_states)
+	{
+		WavefrontState *state = getWavefrontState(it.first, cycle);
+		total_score += state->score;
+		if (it.first == wavefront_id)
+			return total_score <= cutoff;
+	}
+
+	// Unreachable
+	throw misc::Panic("Wavefront state not found");
+}
+
+
+void WavefrontSchedulerCcws::AccessBlock(int wavefront_id, unsigned tag,
+		long long cycle)
+{
+	// Hit, make block most recently used
+	auto it = cache_block_map.find(tag);
+	if (it != cache_block_map.end())
+	{
+		cache_blocks.splice(cache_blocks.begin(), cache_blocks,
+				it->second);
+		return;
+	}
+
+	// Miss on a block that the wavefront brought into the cache before
+	// is a loss of intra-wavefront locality
+	WavefrontState *state = getWavefrontState(wavefront_id, cycle);
+	auto victim_it = std::find(state->victim_tags.begin(),
+			state->victim_tags.end(), tag);
+	if (victim_it != state->victim_tags.end())
+	{
+		state->victim_tags.erase(victim_it);
+		state->score += ccws_lost_locality_score;
+		num_lost_locality++;
+	}
+
+	// Evict least recently used block into the victim tag array of the
+	// wavefront that brought it
+	if ((int) cache_blocks.size() >= ccws_cache_blocks)
+	{
+		unsigned victim_tag = cache_blocks.back().first;
+		auto owner_it = wavefront_states.find(
+				cache_blocks.back().second);
+		if (owner_it != wavefront_states.end())
+		{
+			std::deque<unsigned> &victim_tags =
+					owner_it->second.victim_tags;
+			victim_tags.push_back(victim_tag);
+			if ((int) victim_tags.size() > ccws_victim_tag_entries)
+				victim_tags.pop_front();
+		}
+		cache_block_map.erase(victim_tag);
+		cache_blocks.pop_back();
+	}
+
+	// Insert block
+	cache_blocks.emplace_front(tag, wavefront_id);
+	cache_block_map[tag] = cache_blocks.begin();
+}
+
+
+FetchBuffer::Queue::iterator WavefrontSchedulerCcws::SelectUop(
+		FetchBuffer *fetch_buffer,
+		FetchBuffer::QueueType queue_type,
+		long long cycle)
+{
+	// Only vector memory instructions are throttled
+	FetchBuffer::Queue &queue = fetch_buffer->getQueue(queue_type);
+	if (queue_type != FetchBuffer::QueueVectorMemory)
+		return SelectOldest(queue, cycle);
+
+	// Oldest ready uop from a wavefront not throttled
+	for (auto it = queue.begin(), e = queue.end(); it != e; ++it)
+	{
+		Uop *uop = it->get();
+		if (!isReady(uop, cycle))
+			continue;
+		if (canIssueMemory(uop->getWavefront()->getId(), cycle))
+			return it;
+		num_throttled++;
+	}
+
+	// All ready uops throttled
+	return queue.end();
+}
+
+
+void WavefrontSchedulerCcws::UopIssued(FetchBuffer *fetch_buffer,
+			FetchBuffer::QueueType queue_type,
+			Uop *uop)
+{
+	// Discard the state of finished wavefronts
+	Wavefront *wavefront = uop->getWavefront();
+	int wavefront_id = wavefront->getId();
+	if (uop->wavefront_last_instruction)
+	{
+		wavefront_states.erase(wavefront_id);
+		return;
+	}
+
+	// Only vector memory accesses are tracked
+	if (!uop->vector_memory_read && !uop->vector_memory_write)
+		return;
+
+	// Record blocks accessed by active work-items
+	long long cycle = compute_unit->getTiming()->getCycle();
+	unsigned block_size = compute_unit->vector_cache ?
+			compute_unit->vector_cache->getBlockSize() : 64;
+	for (int i = 0; i < (int) uop->work_item_info_list.size(); i++)
+	{
+		if (!wavefront->isWorkItemActive(i))
+			continue;
+		unsigned address = uop->work_item_info_list[i].
+				global_memory_access_address;
+		AccessBlock(wavefront_id, address & ~(block_size - 1), cycle);
+	}
+}
+
+
+void WavefrontSchedulerCcws::DumpReport(std::ostream &os) const
+{
+	WavefrontScheduler::DumpReport(os);
+	os << misc::fmt("Scheduler.LostLocality = %lld\n",
+			num_lost_locality);
+	os << misc::fmt("Scheduler.Throttled = %lld\n", num_throttled);
+}
+
+
+}  // namespace SI
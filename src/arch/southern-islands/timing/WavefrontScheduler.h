@@ -0,0 +1,367 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef ARCH_SOUTHERN_ISLANDS_TIMING_WAVEFRONT_SCHEDULER_H
+#define ARCH_SOUTHERN_ISLANDS_TIMING_WAVEFRONT_SCHEDULER_H
+
+#include <deque>
+#include <list>
+#include <map>
+#include <memory>
+#include <ostream>
+#include <unordered_map>
+#include <vector>
+
+#include <lib/cpp/String.h>
+
+#include "FetchBuffer.h"
+
+
+namespace SI
+{
+
+// Forward declarations
+class ComputeUnit;
+class Uop;
+
+
+/// Wavefront scheduler of a compute unit, selecting which uop of an issue
+/// queue is issued next into an execution unit. This is an abstract class
+/// with one derived class per scheduling policy. New policies are added by
+/// deriving from it, adding a value to enumeration Policy, and instantiating
+/// the derived class in Create().
+class WavefrontScheduler
+{
+public:
+
+	/// Scheduling policy
+	enum Policy
+	{
+		PolicyInvalid = 0,
+		PolicyOldest,
+		PolicyGto,
+		PolicyLrr,
+		PolicyTwoLevel,
+		PolicyCcws
+	};
+
+	/// String map for Policy
+	static misc::StringMap policy_map;
+
+private:
+
+	// Policy implemented by the scheduler
+	Policy scheduler_policy;
+
+	// Number of uops selected for issue
+	long long num_selected = 0;
+
+	// Number of times that the policy selected no uop while the issue
+	// queue contained uops that had completed fetch
+	long long num_held = 0;
+
+protected:
+
+	// Compute unit that the scheduler belongs to
+	ComputeUnit *compute_unit;
+
+	// Return whether the uop has completed fetch
+	static bool isReady(Uop *uop, long long cycle);
+
+	// Return the first uop in the issue queue that has completed fetch,
+	// which is the oldest one since queues are ordered by age.
+	static FetchBuffer::Queue::iterator SelectOldest(
+			FetchBuffer::Queue &queue,
+			long long cycle);
+
+	// Select a uop from an issue queue of a fetch buffer according to the
+	// scheduling policy. Return a past-the-end iterator of the queue if
+	// no uop should be issued.
+	virtual FetchBuffer::Queue::iterator SelectUop(
+			FetchBuffer *fetch_buffer,
+			FetchBuffer::QueueType queue_type,
+			long long cycle) = 0;
+
+	// Notify the policy that a uop selected from the given fetch buffer
+	// is about to be issued. Policies tracking issue history override
+	// this function.
+	virtual void UopIssued(FetchBuffer *fetch_buffer,
+			FetchBuffer::QueueType queue_type,
+			Uop *uop)
+	{
+	}
+
+public:
+
+	//
+	// Static fields
+	//
+
+	/// Scheduling policy, configured by the user
+	static Policy policy;
+
+	/// Number of wavefronts per fetch buffer in the active set of the
+	/// two-level policy
+	static int two_level_active_wavefronts;
+
+	/// Number of block tags per wavefront in the victim tag arrays of the
+	/// cache-conscious policy
+	static int ccws_victim_tag_entries;
+
+	/// Number of blocks of the cache tracked by the cache-conscious policy
+	static int ccws_cache_blocks;
+
+	/// Score added to a wavefront by the cache-conscious policy every time
+	/// that it loses intra-wavefront locality
+	static int ccws_lost_locality_score;
+
+
+	//
+	// Class members
+	//
+
+	/// Constructor
+	WavefrontScheduler(ComputeUnit *compute_unit, Policy scheduler_policy) :
+			scheduler_policy(scheduler_policy),
+			compute_unit(compute_unit)
+	{
+	}
+
+	/// Virtual destructor
+	virtual ~WavefrontScheduler() {}
+
+	/// Create a wavefront scheduler for the compute unit implementing
+	/// the policy configured by the user
+	static std::unique_ptr<WavefrontScheduler> Create(
+			ComputeUnit *compute_unit);
+
+	/// Return the policy implemented by the scheduler
+	Policy getPolicy() const { return scheduler_policy; }
+
+	/// Select the uop to issue next from the given issue queue of a fetch
+	/// buffer. Return a past-the-end iterator of the queue if no uop
+	/// should be issued.
+	FetchBuffer::Queue::iterator Select(FetchBuffer *fetch_buffer,
+			FetchBuffer::QueueType queue_type,
+			long long cycle);
+
+	/// Notify the scheduler that the uop, previously returned by Select(),
+	/// is being issued.
+	void Issued(FetchBuffer *fetch_buffer,
+			FetchBuffer::QueueType queue_type,
+			Uop *uop);
+
+	/// Dump the statistics of the scheduler into the compute unit section
+	/// of the report. Derived classes extend it with statistics specific
+	/// to the policy.
+	virtual void DumpReport(std::ostream &os) const;
+};
+
+
+/// Scheduler issuing the uop of the oldest wavefront
+class WavefrontSchedulerOldest : public WavefrontScheduler
+{
+	FetchBuffer::Queue::iterator SelectUop(FetchBuffer *fetch_buffer,
+			FetchBuffer::QueueType queue_type,
+			long long cycle) override;
+
+public:
+
+	/// Constructor
+	WavefrontSchedulerOldest(ComputeUnit *compute_unit) :
+			WavefrontScheduler(compute_unit, PolicyOldest)
+	{
+	}
+};
+
+
+/// Greedy-then-oldest scheduler. Uops of the wavefront that issued last in
+/// a fetch buffer are prioritized, falling back to the oldest wavefront.
+class WavefrontSchedulerGto : public WavefrontScheduler
+{
+	// Identifier of the wavefront that issued last in each fetch buffer,
+	// or -1 if none
+	std::vector<int> greedy_wavefront_ids;
+
+	// Number of uops issued from the greedy wavefront
+	long long num_greedy = 0;
+
+	FetchBuffer::Queue::iterator SelectUop(FetchBuffer *fetch_buffer,
+			FetchBuffer::QueueType queue_type,
+			long long cycle) override;
+
+	void UopIssued(FetchBuffer *fetch_buffer,
+			FetchBuffer::QueueType queue_type,
+			Uop *uop) override;
+
+public:
+
+	/// Constructor
+	WavefrontSchedulerGto(ComputeUnit *compute_unit);
+
+	/// Dump statistics
+	void DumpReport(std::ostream &os) const override;
+};
+
+
+/// Loose round-robin scheduler. Each issue queue issues from the wavefront
+/// that follows the one that issued last, skipping wavefronts with no uop
+/// ready.
+class WavefrontSchedulerLrr : public WavefrontScheduler
+{
+	// Identifier of the wavefront that issued last from each issue queue
+	// of each fetch buffer, or -1 if none
+	std::vector<std::vector<int>> last_wavefront_ids;
+
+	FetchBuffer::Queue::iterator SelectUop(FetchBuffer *fetch_buffer,
+			FetchBuffer::QueueType queue_type,
+			long long cycle) override;
+
+	void UopIssued(FetchBuffer *fetch_buffer,
+			FetchBuffer::QueueType queue_type,
+			Uop *uop) override;
+
+public:
+
+	/// Constructor
+	WavefrontSchedulerLrr(ComputeUnit *compute_unit);
+};
+
+
+/// Two-level scheduler. Only wavefronts in a small active set issue, oldest
+/// first. A wavefront leaves the active set when it issues a vector memory
+/// instruction or a barrier, and wavefronts join it in age order when there
+/// is room.
+class WavefrontSchedulerTwoLevel : public WavefrontScheduler
+{
+	// Identifiers of the wavefronts in the active set of each fetch
+	// buffer, in the order they joined it
+	std::vector<std::deque<int>> active_sets;
+
+	// Number of wavefronts that joined an active set
+	long long num_promotions = 0;
+
+	// Number of wavefronts that left an active set after issuing a long
+	// latency instruction or a barrier
+	long long num_demotions = 0;
+
+	// Return whether the wavefront is in the active set
+	static bool isActive(const std::deque<int> &active_set,
+			int wavefront_id);
+
+	// Remove a wavefront from the active set, if present
+	static bool RemoveActive(std::deque<int> &active_set,
+			int wavefront_id);
+
+	FetchBuffer::Queue::iterator SelectUop(FetchBuffer *fetch_buffer,
+			FetchBuffer::QueueType queue_type,
+			long long cycle) override;
+
+	void UopIssued(FetchBuffer *fetch_buffer,
+			FetchBuffer::QueueType queue_type,
+			Uop *uop) override;
+
+public:
+
+	/// Constructor
+	WavefrontSchedulerTwoLevel(ComputeUnit *compute_unit);
+
+	/// Dump statistics
+	void DumpReport(std::ostream &os) const override;
+};
+
+
+/// Cache-conscious scheduler. Wavefronts are scheduled oldest first, but the
+/// number of wavefronts allowed to issue vector memory instructions is
+/// throttled when wavefronts lose intra-wavefront locality in the vector
+/// cache. Locality is tracked with a model of the cache contents and one
+/// victim tag array per wavefront, holding the tags of blocks that the
+/// wavefront brought into the cache and were evicted.
+class WavefrontSchedulerCcws : public WavefrontScheduler
+{
+	// Score of wavefronts not losing locality. The score decays towards
+	// this value by one unit per cycle.
+	static const int base_score = 100;
+
+	// Locality state of a wavefront
+	struct WavefrontState
+	{
+		// Lost locality score
+		int score = base_score;
+
+		// Cycle when the score was last decayed
+		long long cycle = 0;
+
+		// Victim tag array, oldest tag first
+		std::deque<unsigned> victim_tags;
+	};
+
+	// Locality state of the wavefronts, ordered by age
+	std::map<int, WavefrontState> wavefront_states;
+
+	// Blocks present in the model of the cache, most recently used
+	// first, with the identifier of the wavefront that brought them
+	std::list<std::pair<unsigned, int>> cache_blocks;
+
+	// Position of each block in 'cache_blocks'
+	std::unordered_map<unsigned, std::list<std::pair<unsigned,
+			int>>::iterator> cache_block_map;
+
+	// Number of lost locality events detected
+	long long num_lost_locality = 0;
+
+	// Number of times that a vector memory uop was held back due to
+	// throttling
+	long long num_throttled = 0;
+
+	// Return the state of a wavefront, with its score decayed up to the
+	// given cycle
+	WavefrontState *getWavefrontState(int wavefront_id, long long cycle);
+
+	// Return whether the wavefront is allowed to issue vector memory
+	// instructions in the given cycle
+	bool canIssueMemory(int wavefront_id, long long cycle);
+
+	// Record an access to a block of the cache by a wavefront
+	void AccessBlock(int wavefront_id, unsigned tag, long long cycle);
+
+	FetchBuffer::Queue::iterator SelectUop(FetchBuffer *fetch_buffer,
+			FetchBuffer::QueueType queue_type,
+			long long cycle) override;
+
+	void UopIssued(FetchBuffer *fetch_buffer,
+			FetchBuffer::QueueType queue_type,
+			Uop *uop) override;
+
+public:
+
+	/// Constructor
+	WavefrontSchedulerCcws(ComputeUnit *compute_unit) :
+			WavefrontScheduler(compute_unit, PolicyCcws)
+	{
+	}
+
+	/// Dump statistics
+	void DumpReport(std::ostream &os) const override;
+};
+
+
+}  // namespace SI
+
+#endif
@@ -445,6 +445,7 @@ void Instruction::Clear()
 	opindex = 0;
 	segment = RegNone;
 	prefixes = 0;
+	lock_prefix = false;
 
 	op_size = 0;
 	addr_size = 0;
@@ -486,7 +487,8 @@ void Instruction::Decode(const char *buffer, unsigned eip)
 		{
 
 		case 0xf0:
-			// lock prefix is ignored
+			// lock prefix is not used for decoding
+			lock_prefix = true;
 			break;
 
 		case 0xf2:
@@ -0,0 +1,93 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <lib/cpp/String.h>
+
+#include "Bbv.h"
+
+
+namespace x86
+{
+
+Bbv::Bbv(const std::string &path, long long interval) :
+		path(path),
+		interval(interval)
+{
+	// Check interval
+	if (interval < 1)
+		throw Error(misc::fmt("Invalid interval length (%lld)",
+				interval));
+
+	// Open output file
+	f.open(path);
+	if (!f)
+		throw Error(misc::fmt("%s: Cannot open file for writing",
+				path.c_str()));
+}
+
+
+Bbv::~Bbv()
+{
+	// Dump last incomplete interval
+	if (num_instructions)
+		DumpInterval();
+}
+
+
+void Bbv::DumpInterval()
+{
+	// Dump one line in SimPoint format
+	f << 'T';
+	for (auto &it : counts)
+		f << ':' << it.first << ':' << it.second << ' ';
+	f << '\n';
+
+	// Start new interval
+	counts.clear();
+	num_instructions = 0;
+	num_intervals++;
+}
+
+
+void Bbv::Record(unsigned address, int num_instructions)
+{
+	// Get block identifier, assigning a new one if this is the first
+	// time the block is executed.
+	auto it = block_ids.find(address);
+	int block_id;
+	if (it == block_ids.end())
+	{
+		block_id = block_ids.size() + 1;
+		block_ids[address] = block_id;
+	}
+	else
+	{
+		block_id = it->second;
+	}
+
+	// Count instructions
+	counts[block_id] += num_instructions;
+	this->num_instructions += num_instructions;
+
+	// Close interval
+	if (this->num_instructions >= interval)
+		DumpInterval();
+}
+
+}  // namespace x86
@@ -0,0 +1,118 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef ARCH_X86_EMULATOR_BBV_H
+#define ARCH_X86_EMULATOR_BBV_H
+
+#include <fstream>
+#include <map>
+#include <unordered_map>
+
+#include <lib/cpp/Error.h>
+
+
+namespace x86
+{
+
+/// Basic block vector profiler. The dynamic instruction stream is divided
+/// in intervals of a fixed number of instructions. For each interval, the
+/// profiler dumps one line in the SimPoint format, containing the number of
+/// instructions executed in each basic block during the interval:
+///
+///	T:<block_id>:<count> :<block_id>:<count> ...
+///
+/// Basic blocks are identified by their start address, and are given
+/// identifiers starting at 1 in the order they are first executed.
+class Bbv
+{
+public:
+
+	/// Exception for the basic block vector profiler
+	class Error : public misc::Error
+	{
+	public:
+
+		Error(const std::string &message) : misc::Error(message)
+		{
+			AppendPrefix("x86 BBV");
+		}
+	};
+
+private:
+
+	// Output file
+	std::string path;
+	std::ofstream f;
+
+	// Number of instructions per interval
+	long long interval;
+
+	// Identifiers of basic blocks, indexed by start address
+	std::unordered_map<unsigned, int> block_ids;
+
+	// Number of instructions executed in each basic block during the
+	// current interval, indexed by block identifier.
+	std::map<int, long long> counts;
+
+	// Number of instructions in the current interval
+	long long num_instructions = 0;
+
+	// Number of intervals dumped so far
+	long long num_intervals = 0;
+
+	// Dump the current interval into the output file and start a new one
+	void DumpInterval();
+
+public:
+
+	/// Constructor
+	///
+	/// \param path
+	///	Output file where basic block vectors are dumped.
+	///
+	/// \param interval
+	///	Number of instructions in each interval.
+	///
+	Bbv(const std::string &path, long long interval);
+
+	/// Destructor. The last interval is dumped even if it is incomplete.
+	~Bbv();
+
+	/// Record the execution of a basic block. Intervals are only closed
+	/// at basic block boundaries, so an interval can slightly exceed its
+	/// nominal length.
+	///
+	/// \param address
+	///	Address of the first instruction of the basic block.
+	///
+	/// \param num_instructions
+	///	Number of instructions executed in the basic block.
+	///
+	void Record(unsigned address, int num_instructions);
+
+	/// Return the number of intervals dumped so far
+	long long getNumIntervals() const { return num_intervals; }
+
+	/// Return the number of distinct basic blocks executed so far
+	int getNumBlocks() const { return block_ids.size(); }
+};
+
+}  // namespace x86
+
+#endif
@@ -0,0 +1,83 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cstring>
+
+#include "BranchTrace.h"
+
+
+namespace x86
+{
+
+const char *BranchTrace::kind_chars = "?bjJcCr";
+
+const misc::StringMap BranchTrace::KindMap =
+{
+	{"Branch", KindBranch},
+	{"Jump", KindJump},
+	{"IndirectJump", KindIndirectJump},
+	{"Call", KindCall},
+	{"IndirectCall", KindIndirectCall},
+	{"Ret", KindRet}
+};
+
+
+BranchTrace::BranchTrace(const std::string &path) :
+		path(path)
+{
+	// Open output file
+	f.open(path);
+	if (!f)
+		throw Error(misc::fmt("%s: Cannot open file for writing",
+				path.c_str()));
+}
+
+
+void BranchTrace::Record(Kind kind, unsigned eip, int size, unsigned neip)
+{
+	// Dump entry
+	f << misc::fmt("%c %x %d %x %lld\n", kind_chars[kind], eip, size,
+			neip, num_instructions);
+
+	// Start counting instructions for next entry
+	num_instructions = 0;
+	num_entries++;
+}
+
+
+bool BranchTrace::Read(std::istream &is, Entry &entry)
+{
+	// Read fields
+	char kind_char;
+	is >> kind_char >> std::hex >> entry.eip >> std::dec >> entry.size
+			>> std::hex >> entry.neip >> std::dec
+			>> entry.num_instructions;
+	if (!is)
+		return false;
+
+	// Decode kind
+	const char *kind = kind_char ? strchr(kind_chars + 1, kind_char) :
+			nullptr;
+	if (!kind)
+		throw Error(misc::fmt("Invalid entry kind '%c'", kind_char));
+	entry.kind = (Kind) (kind - kind_chars);
+	return true;
+}
+
+}  // namespace x86
@@ -0,0 +1,139 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef ARCH_X86_EMULATOR_BRANCH_TRACE_H
+#define ARCH_X86_EMULATOR_BRANCH_TRACE_H
+
+#include <fstream>
+
+#include <lib/cpp/Error.h>
+#include <lib/cpp/String.h>
+
+
+namespace x86
+{
+
+/// Trace of control instructions executed by an x86 program, used to
+/// evaluate branch predictors without running the timing pipeline. Each
+/// non-speculative control instruction is dumped in one line:
+///
+///	<kind> <eip> <size> <neip> <num_instructions>
+///
+/// Field <kind> is one character identifying the control instruction, as
+/// given by enumeration Kind. Fields <eip> and <neip> are the hexadecimal
+/// addresses of the instruction and of the instruction executed after it.
+/// Field <size> is the instruction size in bytes, and <num_instructions>
+/// is the number of instructions executed since the previous line,
+/// including the control instruction itself.
+class BranchTrace
+{
+public:
+
+	/// Exception for the branch trace
+	class Error : public misc::Error
+	{
+	public:
+
+		Error(const std::string &message) : misc::Error(message)
+		{
+			AppendPrefix("x86 branch trace");
+		}
+	};
+
+	/// Kind of control instruction
+	enum Kind
+	{
+		KindInvalid = 0,
+		KindBranch,		// Conditional branch
+		KindJump,		// Direct jump
+		KindIndirectJump,	// Jump to a register or memory target
+		KindCall,		// Direct call
+		KindIndirectCall,	// Call to a register or memory target
+		KindRet			// Return
+	};
+
+	/// Characters used for each kind of control instruction in the trace
+	static const char *kind_chars;
+
+	/// String map for values of type Kind
+	static const misc::StringMap KindMap;
+
+	/// Entry of the trace
+	struct Entry
+	{
+		Kind kind = KindInvalid;
+		unsigned eip = 0;
+		int size = 0;
+		unsigned neip = 0;
+		long long num_instructions = 0;
+	};
+
+private:
+
+	// Output file
+	std::string path;
+	std::ofstream f;
+
+	// Number of instructions executed since the last entry was dumped
+	long long num_instructions = 0;
+
+	// Number of entries dumped so far
+	long long num_entries = 0;
+
+public:
+
+	/// Constructor
+	///
+	/// \param path
+	///	Output file where the trace is dumped.
+	///
+	BranchTrace(const std::string &path);
+
+	/// Record the execution of a control instruction.
+	///
+	/// \param kind
+	///	Kind of control instruction.
+	///
+	/// \param eip
+	///	Address of the instruction.
+	///
+	/// \param size
+	///	Size of the instruction in bytes.
+	///
+	/// \param neip
+	///	Address of the next executed instruction.
+	///
+	void Record(Kind kind, unsigned eip, int size, unsigned neip);
+
+	/// Count one non-speculative instruction executed. This must be
+	/// invoked for every instruction, including control instructions,
+	/// before they are recorded.
+	void incNumInstructions() { num_instructions++; }
+
+	/// Read the next entry of a trace from an input stream. The function
+	/// returns false when the end of the stream is reached.
+	static bool Read(std::istream &is, Entry &entry);
+
+	/// Return the number of entries dumped so far
+	long long getNumEntries() const { return num_entries; }
+};
+
+}  // namespace x86
+
+#endif
@@ -68,7 +68,9 @@ Context::Context() :
 		emulator(Emulator::getInstance())
 {
 	// Micro-instructions
-	uinst_active = Timing::getSimKind() == comm::Arch::SimDetailed;
+	uinst_active = Timing::getSimKind() == comm::Arch::SimDetailed ||
+			emulator->getBranchTrace() ||
+			emulator->hasInstructionStreamOutputs();
 
 	// Initialize emulator list iterators
 	contexts_iterator = emulator->getContextsEnd();
@@ -98,6 +100,9 @@ Context::~Context()
 {
 	// Debug
 	Emulator::context_debug << "Context " << getId() << " destroyed\n";
+
+	// Mutex for concurrent execution
+	pthread_mutex_destroy(&concurrent_mutex);
 }
 
 
@@ -545,119 +550,78 @@ void Context::DebugCallInst()
 }
 
 
-void Context::HostThreadSuspend()
+void Context::HostWaitStart()
 {
 	// Get current time
 	esim::Engine *esim = esim::Engine::getInstance();
 	long long now = esim->getRealTime();
 
-	// Detach this thread - we don't want the parent to have to join it to
-	// release its resources. The thread termination can be observed by
-	// atomically checking the 'host_thread_suspend_active' field of the
-	// context.
-	pthread_detach(pthread_self());
+	// Host file descriptor, events, and timeout in microseconds
+	int host_fd = -1;
+	int events = 0;
+	long long timeout = -1;
 
 	// Suspended in system call 'nanosleep'
 	if (getState(StateNanosleep))
 	{
-		// Calculate remaining sleep time in microseconds
-		long long timeout = syscall_nanosleep_wakeup_time > now ?
+		timeout = syscall_nanosleep_wakeup_time > now ?
 				syscall_nanosleep_wakeup_time - now : 0;
-		usleep(timeout);
-
 	}
 
 	// Suspended in system call 'read'
 	if (getState(StateRead))
 	{
-		// Get file descriptor
 		comm::FileDescriptor *desc = file_table->getFileDescriptor(syscall_read_fd);
 		if (!desc)
 			throw misc::Panic(misc::fmt("Invalid file descriptor "
 					"(%d)", syscall_read_fd));
-
-		// Perform blocking host 'poll'
-		struct pollfd host_fds;
-		host_fds.fd = desc->getHostIndex();
-		host_fds.events = POLLIN;
-		int err = poll(&host_fds, 1, -1);
-		if (err < 0)
-			throw misc::Panic("Unexpected error in host 'poll'");
+		host_fd = desc->getHostIndex();
+		events = POLLIN;
 	}
 
 	// Suspended in system call 'write'
 	if (getState(StateWrite))
 	{
-		// Get file descriptor
 		comm::FileDescriptor *desc = file_table->getFileDescriptor(syscall_write_fd);
 		if (!desc)
 			throw misc::Panic(misc::fmt("Invalid file descriptor "
 					"(%d)", syscall_write_fd));
-
-		// Perform blocking host 'poll'
-		struct pollfd host_fds;
-		host_fds.fd = desc->getHostIndex();
-		host_fds.events = POLLOUT;
-		int err = poll(&host_fds, 1, -1);
-		if (err < 0)
-			throw misc::Panic("Unexpected error in host 'poll'");
+		host_fd = desc->getHostIndex();
+		events = POLLOUT;
 	}
 
 	// Suspended in system call 'poll'
 	if (getState(StatePoll))
 	{
-		// Get file descriptor
 		comm::FileDescriptor *desc = file_table->getFileDescriptor(syscall_poll_fd);
 		if (!desc)
 			throw misc::Panic(misc::fmt("Invalid file descriptor "
 					"(%d)", syscall_poll_fd));
-
-		// Calculate timeout for host call in milliseconds from now
-		int timeout;
-		if (!syscall_poll_time)
-			timeout = -1;
-		else if (syscall_poll_time < now)
-			timeout = 0;
-		else
-			timeout = (syscall_poll_time - now) / 1000;
-
-		// Perform blocking host 'poll'
-		struct pollfd host_fds;
-		host_fds.fd = desc->getHostIndex();
-		host_fds.events = ((syscall_poll_events & 4) ? POLLOUT : 0) |
+		host_fd = desc->getHostIndex();
+		events = ((syscall_poll_events & 4) ? POLLOUT : 0) |
 				((syscall_poll_events & 1) ? POLLIN : 0);
-		int err = poll(&host_fds, 1, timeout);
-		if (err < 0)
-			throw misc::Panic("Unexpected error in host 'poll'");
+		if (syscall_poll_time)
+			timeout = syscall_poll_time > now ?
+					syscall_poll_time - now : 0;
 	}
 
-	// Event occurred - thread finishes
-	emulator->LockMutex();
-	emulator->ProcessEventsScheduleUnsafe();
-	host_thread_suspend_active = false;
-	emulator->UnlockMutex();
+	// Watch events. If they are available right away, check the context
+	// again in the next call to ProcessEvents().
+	if (!emulator->getHostReactor()->Add(this, host_fd, events, timeout))
+		emulator->ProcessEventsScheduleUnsafe();
 }
 
 
-void Context::HostThreadSuspendCancelUnsafe()
+bool Context::isHostWaitActive()
 {
-	if (host_thread_suspend_active)
-	{
-		if (pthread_cancel(host_thread_suspend))
-			throw misc::Panic(misc::fmt("[%s] Error "
-					"canceling host thread",
-					getName().c_str()));
-		host_thread_suspend_active = false;
-	}
-	emulator->ProcessEventsScheduleUnsafe();
+	return emulator->getHostReactor()->isWatching(this);
 }
-	
 
-void Context::HostThreadSuspendCancel()
+
+void Context::HostWaitCancel()
 {
-	emulator->LockMutex();
-	HostThreadSuspendCancelUnsafe();
-	emulator->UnlockMutex();
+	emulator->getHostReactor()->Cancel(this);
+	emulator->ProcessEventsSchedule();
 }
 
 
@@ -729,35 +693,87 @@ void Context::Wakeup()
 }
 
 
-void Context::HostThreadTimerCancelUnsafe()
+void Context::ExecuteFromInstructionStream(
+		InstructionStream *instruction_stream)
 {
-	if (!host_thread_timer_active)
+	// Set last and current instruction addresses
+	ClearUinsts();
+	last_eip = current_eip;
+	current_eip = regs.getEip();
+	target_eip = 0;
+
+	// Speculative instruction, decoded from memory in unsafe mode
+	char buffer[20] = {};
+	if (getState(StateSpecMode))
+	{
+		memory->setSafe(false);
+		memory->Access(current_eip, 20, buffer,
+				mem::Memory::AccessExec);
+		memory->setSafeDefault();
+		inst.Decode(buffer, current_eip);
+		regs.incEip(inst.getSize());
 		return;
-	if (pthread_cancel(host_thread_timer))
-		throw misc::Panic(misc::fmt("[%s] Error canceling "
-				"host thread",
-				getName().c_str()));
-	host_thread_timer_active = false;
-	emulator->ProcessEventsScheduleUnsafe();
-}
+	}
 
+	// Read next instruction. A stream ending before the instruction
+	// that finished the context means that the writer stopped early, for
+	// example at its maximum number of instructions.
+	InstructionStream::Record &record = instruction_stream_record;
+	if (!instruction_stream->Read(record))
+	{
+		Finish(0);
+		return;
+	}
+	if (record.pid != getId())
+		throw Error(misc::fmt("Instruction stream for context %d read "
+				"by context %d. Only programs with one context "
+				"are supported.", record.pid, getId()));
+	if (record.eip != current_eip)
+		throw Error(misc::fmt("Instruction stream at 0x%x, but "
+				"context %d at 0x%x", record.eip, getId(),
+				current_eip));
+
+	// Decode it from its raw bytes, since the program memory is not
+	// updated without emulation
+	memcpy(buffer, record.bytes, record.size);
+	inst.Decode(buffer, current_eip);
+
+	// Advance to the next instruction and take its micro-instructions
+	regs.setEip(record.neip);
+	target_eip = record.target_eip;
+	if (uinst_active)
+		uinsts.insert(uinsts.end(), record.uinsts.begin(),
+				record.uinsts.end());
+
+	// Finish with the exit code of the context that wrote the stream
+	if (record.finished)
+		Finish(record.exit_code);
 
-void Context::HostThreadTimerCancel()
-{
-	emulator->LockMutex();
-	HostThreadTimerCancelUnsafe();
-	emulator->UnlockMutex();
+	// Stats
+	emulator->incNumInstructions();
 }
 
 
 void Context::Execute()
 {
+	// Instructions read from an instruction stream
+	InstructionStream *instruction_stream =
+			emulator->getInstructionStreamInput();
+	if (instruction_stream)
+	{
+		ExecuteFromInstructionStream(instruction_stream);
+		return;
+	}
+
 	// Memory permissions should not be checked if the context is executing in
 	// speculative mode. This will prevent guest segmentation faults to occur.
+	// The safe mode is shared by all contexts using the memory, so it is
+	// left untouched while contexts run concurrently.
 	bool spec_mode = getState(StateSpecMode);
+	bool concurrent = memory->isConcurrent();
 	if (spec_mode)
 		memory->setSafe(false);
-	else
+	else if (!concurrent)
 		memory->setSafeDefault();
 
 	// Read instruction from memory. Memory should be accessed here in unsafe mode
@@ -765,7 +781,14 @@ void Context::Execute()
 	char buffer[20];
 	unsigned char *buffer_ptr = (unsigned char *)memory->getBuffer(
 			regs.getEip(), 20, mem::Memory::AccessExec);
-	if (!buffer_ptr)
+	if (!buffer_ptr && concurrent)
+	{
+		// Instructions crossing a page boundary are fetched with
+		// exclusive access to the memory.
+		exclusive_pending = true;
+		return;
+	}
+	else if (!buffer_ptr)
 	{
 		// Disable safe mode. If a part of the 20 read bytes does not
 		// belong to the actual instruction, and they lie on a page with
@@ -778,7 +801,8 @@ void Context::Execute()
 	}
 
 	// Return to default safe mode
-	memory->setSafeDefault();
+	if (!concurrent)
+		memory->setSafeDefault();
 
 	// Disassemble
 	inst.Decode((char *)buffer_ptr, regs.getEip());
@@ -791,6 +815,26 @@ void Context::Execute()
 				buffer_ptr[2], buffer_ptr[3]));
 	}
 
+	// System calls are run once no other context runs concurrently
+	if ((concurrent || exclusive) &&
+			inst.getOpcode() == Instruction::Opcode_int_imm8)
+	{
+		serial_pending = true;
+		return;
+	}
+
+	// Atomic instructions are run with exclusive access to the memory.
+	// Exchanges with memory are atomic even without a 'lock' prefix.
+	if (concurrent && (inst.hasLockPrefix() ||
+			((inst.getOpcode() == Instruction::Opcode_xchg_rm8_r8 ||
+			inst.getOpcode() == Instruction::Opcode_xchg_rm16_r16 ||
+			inst.getOpcode() == Instruction::Opcode_xchg_rm32_r32) &&
+			inst.getModRmMod() != 3)))
+	{
+		exclusive_pending = true;
+		return;
+	}
+
 	// Clear existing list of microinstructions, though the architectural
 	// simulator might have cleared it already. A new list will be generated
 	// for the next executed x86 instruction.
@@ -858,8 +902,218 @@ void Context::Execute()
 	if (emulator->call_debug)
 		DebugCallInst();
 
-	// Stats
-	emulator->incNumInstructions();
+	// Basic block vector profiling. A basic block ends with a control
+	// instruction, or with any instruction not followed by the next
+	// sequential instruction, such as an iteration of a 'rep' prefix.
+	Bbv *bbv = emulator->getBbv();
+	if (bbv && !spec_mode)
+	{
+		if (!bbv_block_size)
+			bbv_block_eip = current_eip;
+		bbv_block_size++;
+		if (target_eip || regs.getEip() != current_eip + inst.getSize())
+		{
+			bbv->Record(bbv_block_eip, bbv_block_size);
+			bbv_block_size = 0;
+		}
+	}
+
+	// Branch trace. Control instructions are identified by their
+	// micro-instructions, which are also produced in functional simulation
+	// while the trace is captured. Internal branches of string
+	// instructions are not traced.
+	BranchTrace *branch_trace = emulator->getBranchTrace();
+	if (branch_trace && !spec_mode)
+	{
+		branch_trace->incNumInstructions();
+		for (auto &uinst : uinsts)
+		{
+			// Indirect jumps and calls read their target from a
+			// register or memory.
+			bool indirect = uinst->getIDep(0) != Uinst::DepNone ||
+					uinst->getIDep(1) != Uinst::DepNone ||
+					uinst->getIDep(2) != Uinst::DepNone;
+
+			// Classify
+			BranchTrace::Kind kind;
+			switch (uinst->getOpcode())
+			{
+
+			case Uinst::OpcodeBranch:
+
+				kind = BranchTrace::KindBranch;
+				break;
+
+			case Uinst::OpcodeJump:
+
+				kind = indirect ? BranchTrace::KindIndirectJump :
+						BranchTrace::KindJump;
+				break;
+
+			case Uinst::OpcodeCall:
+
+				kind = indirect ? BranchTrace::KindIndirectCall :
+						BranchTrace::KindCall;
+				break;
+
+			case Uinst::OpcodeRet:
+
+				kind = BranchTrace::KindRet;
+				break;
+
+			default:
+
+				continue;
+			}
+
+			// Record
+			branch_trace->Record(kind, current_eip, inst.getSize(),
+					regs.getEip());
+			break;
+		}
+	}
+
+	// Instruction streams, with the raw bytes of the instruction
+	if (emulator->hasInstructionStreamOutputs() && !spec_mode)
+	{
+		InstructionStream::Record &record = instruction_stream_record;
+		record.pid = getId();
+		record.eip = current_eip;
+		record.size = inst.getSize();
+		memcpy(record.bytes, buffer_ptr, record.size);
+		record.neip = regs.getEip();
+		record.target_eip = target_eip;
+		record.finished = getState(StateFinished) ||
+				getState(StateZombie);
+		record.exit_code = exit_code;
+		record.uinsts.assign(uinsts.begin(), uinsts.end());
+		emulator->WriteInstructionStreams(record);
+	}
+
+	// Stats. Instructions run concurrently are accounted for by the
+	// emulator once all contexts have stopped.
+	if (!concurrent)
+		emulator->incNumInstructions();
+}
+
+
+int Context::ExecuteConcurrently(int quantum, bool deterministic)
+{
+	// Buffer memory writes in deterministic mode
+	assert(memory->isConcurrent());
+	if (deterministic)
+		write_buffer = misc::new_unique<mem::WriteBuffer>(memory.get());
+
+	// Run instructions
+	int num_instructions = 0;
+	while (num_instructions < quantum && getState(StateRunning) &&
+			!serial_pending)
+	{
+		// Save state modified by the instruction before it accesses
+		// memory, in case the access conflicts with other contexts.
+		Regs saved_regs = regs;
+		unsigned saved_last_eip = last_eip;
+		unsigned saved_current_eip = current_eip;
+		unsigned saved_target_eip = target_eip;
+		unsigned saved_last_effective_address = last_effective_address;
+		unsigned saved_str_op_esi = str_op_esi;
+		unsigned saved_str_op_edi = str_op_edi;
+		int saved_str_op_dir = str_op_dir;
+		int saved_str_op_count = str_op_count;
+
+		// Run one instruction. Without write buffers, contexts access
+		// the memory directly, so the instruction holds the mutex of
+		// the context to prevent exclusive instructions of other
+		// contexts from running in the middle of it.
+		if (!deterministic)
+			LockConcurrentMutex();
+		try
+		{
+			Execute();
+		}
+		catch (mem::Memory::Conflict &e)
+		{
+			// Roll back the instruction. It will be run again with
+			// exclusive access to the memory.
+			regs = saved_regs;
+			last_eip = saved_last_eip;
+			current_eip = saved_current_eip;
+			target_eip = saved_target_eip;
+			last_effective_address = saved_last_effective_address;
+			str_op_esi = saved_str_op_esi;
+			str_op_edi = saved_str_op_edi;
+			str_op_dir = saved_str_op_dir;
+			str_op_count = saved_str_op_count;
+			exclusive_pending = true;
+		}
+		catch (...)
+		{
+			if (!deterministic)
+				UnlockConcurrentMutex();
+			throw;
+		}
+		if (!deterministic)
+			UnlockConcurrentMutex();
+
+		// Instruction completed
+		if (!serial_pending && !exclusive_pending)
+		{
+			num_instructions++;
+			continue;
+		}
+
+		// Instructions needing exclusive access to the memory are run
+		// in the serial phase in deterministic mode, since writes of
+		// other contexts are not visible until then.
+		if (exclusive_pending && deterministic)
+		{
+			exclusive_pending = false;
+			serial_pending = true;
+		}
+		else if (exclusive_pending)
+		{
+			exclusive_pending = false;
+			ExecuteExclusive();
+		}
+	}
+
+	// Done
+	return num_instructions;
+}
+
+
+void Context::ExecuteExclusive()
+{
+	// Stop all other contexts running concurrently at their next
+	// instruction boundary. The memory can be modified freely in the
+	// meantime, as long as no other part of the emulator is accessed.
+	emulator->BeginExclusive();
+	memory->setConcurrent(false);
+	exclusive = true;
+	try
+	{
+		Execute();
+	}
+	catch (...)
+	{
+		exclusive = false;
+		memory->setConcurrent(true);
+		emulator->EndExclusive();
+		throw;
+	}
+	exclusive = false;
+	memory->setConcurrent(true);
+	emulator->EndExclusive();
+}
+
+
+void Context::CommitWrites()
+{
+	// Apply buffered writes and stop buffering
+	if (!write_buffer)
+		return;
+	write_buffer->Commit();
+	write_buffer.reset();
 }
 
 
@@ -891,8 +1145,7 @@ void Context::FinishGroup(int exit_code)
 			context->setState(StateFinished);
 		if (context->getState(StateHandler))
 			context->ReturnFromSignalHandler();
-		context->HostThreadSuspendCancel();
-		context->HostThreadTimerCancel();
+		context->HostWaitCancel();
 
 		// Child context of 'context' goes to state 'finished'.
 		// Context 'context' goes to state 'zombie' or 'finished' if it has a parent
@@ -914,9 +1167,8 @@ void Context::Finish(int exit_code)
 	if (getState(StateFinished) || getState(StateZombie))
 		return;
 
-	// If context is waiting for host events, cancel spawned host threads
-	HostThreadSuspendCancel();
-	HostThreadTimerCancel();
+	// If context is waiting for host events, cancel the watch
+	HostWaitCancel();
 
 	// From now on, all children have lost their parent. If a child is
 	// already zombie, finish it, since its parent won't be able to waitpid it
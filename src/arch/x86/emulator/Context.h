@@ -33,7 +33,9 @@
 #include <memory/Memory.h>
 #include <memory/Mmu.h>
 #include <memory/SpecMem.h>
+#include <memory/WriteBuffer.h>
 
+#include "InstructionStream.h"
 #include "Regs.h"
 #include "Signal.h"
 #include "Uinst.h"
@@ -168,6 +170,33 @@ private:
 	// it with the actual memory, known only at context creation.
 	std::unique_ptr<mem::SpecMem> spec_mem;
 
+	// Buffer of memory writes performed during deterministic concurrent
+	// execution, or null if writes go to memory directly.
+	std::unique_ptr<mem::WriteBuffer> write_buffer;
+
+	// Flag set when the context stopped running concurrently with other
+	// contexts because its next instruction needs exclusive access to
+	// the emulator.
+	bool serial_pending = false;
+
+	// Flag set when the next instruction of a context running
+	// concurrently needs exclusive access to the memory, but not to the
+	// rest of the emulator (e.g., atomic instructions).
+	bool exclusive_pending = false;
+
+	// Flag set while the context runs an instruction with exclusive
+	// access to the memory, during concurrent execution
+	bool exclusive = false;
+
+	// Mutex held by the context while it runs an instruction concurrently
+	// with other contexts. Instructions with exclusive access to the
+	// memory hold the mutexes of all contexts.
+	pthread_mutex_t concurrent_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+	// Run the instruction that set 'exclusive_pending' while all other
+	// contexts running concurrently are stopped
+	void ExecuteExclusive();
+
 	// Register file. Each context has its own copy always.
 	Regs regs;
 
@@ -189,6 +218,20 @@ private:
 	// Target address for branch, even if not taken
 	unsigned target_eip = 0;
 
+	// Address and number of instructions executed so far of the basic
+	// block being profiled for the basic block vectors
+	unsigned bbv_block_eip = 0;
+	int bbv_block_size = 0;
+
+	// Last instruction written into or read from an instruction stream
+	InstructionStream::Record instruction_stream_record;
+
+	// Run the next instruction read from an instruction stream, instead
+	// of emulating it. Speculative instructions are not part of the
+	// stream. They are only decoded from memory, and produce no
+	// micro-instructions.
+	void ExecuteFromInstructionStream(InstructionStream *instruction_stream);
+
 	// Parent context
 	Context *parent = nullptr;
 
@@ -232,20 +275,6 @@ private:
 	// Segment size for glibc
 	unsigned glibc_segment_limit = 0;
 
-	// Host thread that suspends and then schedules call to ProcessEvents()
-	// The 'host_thread_suspend_active' flag is set when a 'host_thread_suspend' thread
-	// is launched for this context (by caller).
-	// It is clear when the context finished (by the host thread).
-	// It should be accessed safely by locking the emulator mutex
-	pthread_t host_thread_suspend;  // Thread
-	bool host_thread_suspend_active = false;  // Thread-spawned flag
-
-	// Host thread that lets time elapse and schedules call to
-	// ProcessEvents()
-	pthread_t host_thread_timer;
-	int host_thread_timer_active = false;
-	long long host_thread_timer_wakeup;
-
 	// Address of futex where context is suspended
 	unsigned wakeup_futex;
 
@@ -273,21 +302,27 @@ private:
 	// Dump debug information about a call instruction
 	void DebugCallInst();
 
-	// Host thread function
-	void HostThreadSuspend();
-	static void *HostThreadSuspend(void *data)
-	{
-		((Context *) data)->HostThreadSuspend();
-		return nullptr;
-	}
-	
-	// Cancel host thread
-	void HostThreadSuspendCancel();
-	void HostThreadSuspendCancelUnsafe();
+	// Transfer data between a host file descriptor and guest memory with
+	// vectored host I/O, without an intermediate buffer. Argument 'access'
+	// is AccessWrite to read from the file into guest memory, or
+	// AccessRead to write guest memory into the file. The function returns
+	// the number of bytes transferred, or a negative error code.
+	int HostTransfer(int host_fd, unsigned address, unsigned size,
+			mem::Memory::AccessType access);
 
-	// Cancel timer thread
-	void HostThreadTimerCancel();
-	void HostThreadTimerCancelUnsafe();
+	// Watch the host file descriptor or timeout that the context is
+	// suspended on, as given by its state, with the emulator host reactor.
+	// This function is invoked from the wakeup checks of suspended
+	// contexts, with the emulator mutex locked.
+	void HostWaitStart();
+
+	// Return whether the host reactor is still watching events for this
+	// context
+	bool isHostWaitActive();
+
+	// Cancel the watch of the emulator host reactor for this context, and
+	// schedule a call to ProcessEvents().
+	void HostWaitCancel();
 
 	// Callbacks for suspended contexts
 	typedef bool (Context::*CanWakeupFn)();
@@ -791,6 +826,9 @@ public:
 	/// Clear flag \a state in the context state
 	void clearState(State state) { UpdateState(this->state & ~state); }
 
+	/// Return the exit code of a finished or zombie context
+	int getExitCode() const { return exit_code; }
+
 	/// If the context has a parent, return the parent's ID. Otherwise,
 	/// return 0.
 	int getParentId() const { return parent ? parent->getId() : 0; }
@@ -844,6 +882,45 @@ public:
 	/// register \c eip.
 	void Execute();
 
+	/// Run up to \a quantum instructions on a host thread, concurrently
+	/// with other contexts. System calls are not run. Instead, the context
+	/// stops and isSerialPending() returns true until the instruction is
+	/// run with a call to Execute() once no other context runs
+	/// concurrently. Atomic instructions and instructions that need to
+	/// modify the memory page table are run right away with exclusive
+	/// access to the memory, stopping the other contexts at their next
+	/// instruction boundary. In deterministic mode, they are handled like
+	/// system calls instead.
+	///
+	/// \param quantum
+	///	Maximum number of instructions to run.
+	///
+	/// \param deterministic
+	///	If true, memory writes are buffered and only become visible to
+	///	other contexts after a call to CommitWrites().
+	///
+	/// \return
+	///	The number of instructions executed.
+	int ExecuteConcurrently(int quantum, bool deterministic);
+
+	/// Apply memory writes buffered during the last deterministic call to
+	/// ExecuteConcurrently().
+	void CommitWrites();
+
+	/// Return whether the next instruction of a context that ran
+	/// concurrently must be run with exclusive access to the emulator.
+	bool isSerialPending() const { return serial_pending; }
+
+	/// Clear the flag returned by isSerialPending()
+	void clearSerialPending() { serial_pending = false; }
+
+	/// Lock the mutex held by the context while it runs an instruction
+	/// concurrently with other contexts
+	void LockConcurrentMutex() { pthread_mutex_lock(&concurrent_mutex); }
+
+	/// Unlock the mutex locked with LockConcurrentMutex()
+	void UnlockConcurrentMutex() { pthread_mutex_unlock(&concurrent_mutex); }
+
 	/// Return a reference of the register file
 	Regs &getRegs() { return regs; }
 
@@ -48,6 +48,13 @@ void Context::MemoryRead(unsigned int address, int size, void *buffer)
 		return;
 	}
 
+	// Read observing buffered writes
+	if (write_buffer)
+	{
+		write_buffer->Read(address, size, (char *) buffer);
+		return;
+	}
+
 	// Read in regular mode
 	memory->Read(address, size, (char *) buffer);
 }
@@ -62,6 +69,13 @@ void Context::MemoryWrite(unsigned int address, int size, void *buffer)
 		return;
 	}
 
+	// Buffered write
+	if (write_buffer)
+	{
+		write_buffer->Write(address, size, (char *) buffer);
+		return;
+	}
+
 	// Write in regular mode
 	memory->Write(address, size, (char *) buffer);
 }
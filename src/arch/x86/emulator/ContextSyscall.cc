@@ -17,6 +17,7 @@
  *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <climits>
 #include <errno.h>
 #include <fcntl.h>
 #include <poll.h>
@@ -34,6 +35,7 @@
 #include <sys/statfs.h>
 #include <sys/time.h>
 #include <sys/times.h>
+#include <sys/uio.h>
 
 #include <lib/cpp/Misc.h>
 #include <arch/common/Driver.h>
@@ -338,14 +340,60 @@ int Context::ExecuteSyscall_fork()
 // System call 'read'
 //
 
+int Context::HostTransfer(int host_fd, unsigned address, unsigned size,
+		mem::Memory::AccessType access)
+{
+	// Obtain guest pages
+	std::vector<struct iovec> spans;
+	memory->getSpans(address, size, access, spans);
+
+	// Transfer in batches of at most IOV_MAX vectors. Batches after the
+	// first one are only transferred if the host file is still ready, so
+	// that the call never blocks.
+	int total = 0;
+	for (unsigned index = 0; index < spans.size(); index += IOV_MAX)
+	{
+		// Check if file is still ready
+		short events = access == mem::Memory::AccessWrite ?
+				POLLIN : POLLOUT;
+		if (index)
+		{
+			struct pollfd fds;
+			fds.fd = host_fd;
+			fds.events = events;
+			if (poll(&fds, 1, 0) <= 0 || !(fds.revents & events))
+				break;
+		}
+
+		// Host call
+		int count = std::min<int>(IOV_MAX, spans.size() - index);
+		int err = access == mem::Memory::AccessWrite ?
+				readv(host_fd, &spans[index], count) :
+				writev(host_fd, &spans[index], count);
+		if (err < 0)
+			return total ? total : -errno;
+		total += err;
+
+		// Stop on short transfer
+		unsigned batch_size = 0;
+		for (int i = 0; i < count; i++)
+			batch_size += spans[index + i].iov_len;
+		if ((unsigned) err < batch_size)
+			break;
+	}
+
+	// Return number of bytes transferred
+	return total;
+}
+
 void Context::SyscallReadWakeup()
 {
 }
 
 bool Context::SyscallReadCanWakeup()
 {
-	// If the host thread is still running for this context, do nothing.
-	if (host_thread_suspend_active)
+	// If the host reactor is still watching this context, do nothing.
+	if (isHostWaitActive())
 		return false;
 
 	// Context received a signal
@@ -378,14 +426,13 @@ bool Context::SyscallReadCanWakeup()
 	{
 		unsigned pbuf = regs.getEcx();
 		int count = regs.getEdx();
-		auto buf = misc::new_unique_array<char>(count);
 
-		count = read(desc->getHostIndex(), buf.get(), count);
+		count = HostTransfer(desc->getHostIndex(), pbuf, count,
+				mem::Memory::AccessWrite);
 		if (count < 0)
 			throw misc::Panic("Unexpected error in host 'read'");
 
 		regs.setEax(count);
-		memory->Write(pbuf, count, buf.get());
 
 		emulator->syscall_debug << misc::fmt("[%s] Syscall 'read' - "
 				"continue\n",
@@ -394,11 +441,8 @@ bool Context::SyscallReadCanWakeup()
 		return true;
 	}
 
-	// Data is not ready. Launch host thread again
-	host_thread_suspend_active = true;
-	if (pthread_create(&host_thread_suspend, nullptr,
-			&Context::HostThreadSuspend, this))
-		throw misc::Panic("Could not launch host thread");
+	// Data is not ready. Watch the file descriptor again
+	HostWaitStart();
 	return false;
 }
 
@@ -420,7 +464,6 @@ int Context::ExecuteSyscall_read()
 	emulator->syscall_debug << misc::fmt("  host_fd=%d\n", host_fd);
 
 	// Poll the file descriptor to check if read is blocking
-	auto buf = misc::new_unique_array<char>(count);
 	struct pollfd fds;
 	fds.fd = host_fd;
 	fds.events = POLLIN;
@@ -431,17 +474,20 @@ int Context::ExecuteSyscall_read()
 	// Non-blocking read
 	if (fds.revents || (desc->getFlags() & O_NONBLOCK))
 	{
-		// Host system call
-		err = read(host_fd, buf.get(), count);
-		if (err == -1)
-			return -errno;
+		// Host system call, writing directly in guest memory
+		err = HostTransfer(host_fd, buf_ptr, count,
+				mem::Memory::AccessWrite);
+		if (err < 0)
+			return err;
 
-		// Write in guest memory
-		if (err > 0)
+		// Debug read data
+		if (err > 0 && emulator->syscall_debug)
 		{
-			memory->Write(buf_ptr, err, buf.get());
-			emulator->syscall_debug << misc::StringBinaryBuffer(buf.get(),
-					count, 40);
+			char buf[41];
+			int size = std::min(err, (int) sizeof buf);
+			memory->Read(buf_ptr, size, buf);
+			emulator->syscall_debug << misc::StringBinaryBuffer(buf,
+					size, 40);
 		}
 
 		// Return number of read bytes
@@ -473,8 +519,8 @@ void Context::SyscallWriteWakeup()
 
 bool Context::SyscallWriteCanWakeup()
 {
-	// If host thread is still running for this context, do nothing.
-	if (host_thread_suspend_active)
+	// If the host reactor is still watching this context, do nothing.
+	if (isHostWaitActive())
 		return false;
 
 	// Context received a signal
@@ -507,10 +553,9 @@ bool Context::SyscallWriteCanWakeup()
 	{
 		unsigned pbuf = regs.getEcx();
 		int count = regs.getEdx();
-		auto buf = misc::new_unique_array<char>(count);
-		
-		memory->Read(pbuf, count, buf.get());
-		count = write(desc->getHostIndex(), buf.get(), count);
+
+		count = HostTransfer(desc->getHostIndex(), pbuf, count,
+				mem::Memory::AccessRead);
 		if (count < 0)
 			throw misc::Panic("Unexpected error in host 'write'");
 
@@ -522,11 +567,8 @@ bool Context::SyscallWriteCanWakeup()
 		return true;
 	}
 
-	// Data is not ready to be written - launch host thread again
-	host_thread_suspend_active = true;
-	if (pthread_create(&host_thread_suspend, nullptr,
-			&Context::HostThreadSuspend, this))
-		throw misc::Panic("Could not create child thread");
+	// Data is not ready to be written - watch the file descriptor again
+	HostWaitStart();
 	
 	// Done
 	return false;
@@ -548,12 +590,16 @@ int Context::ExecuteSyscall_write()
 	int host_fd = desc->getHostIndex();
 	emulator->syscall_debug << misc::fmt("  host_fd=%d\n", host_fd);
 
-	// Read buffer from memory
-	auto buf = misc::new_unique_array<char>(count);
-	memory->Read(buf_ptr, count, buf.get());
-	emulator->syscall_debug << "  buf=\""
-			<< misc::StringBinaryBuffer(buf.get(), count, 40)
-			<< "\"\n";
+	// Debug buffer
+	if (emulator->syscall_debug)
+	{
+		char buf[41];
+		int size = std::min(count, (unsigned) sizeof buf);
+		memory->Read(buf_ptr, size, buf);
+		emulator->syscall_debug << "  buf=\""
+				<< misc::StringBinaryBuffer(buf, size, 40)
+				<< "\"\n";
+	}
 
 	// Poll the file descriptor to check if write is blocking
 	struct pollfd fds;
@@ -564,10 +610,9 @@ int Context::ExecuteSyscall_write()
 	// Non-blocking write
 	if (fds.revents)
 	{
-		// Host write
-		int err = write(host_fd, buf.get(), count);
-		if (err == -1)
-			err = -errno;
+		// Host write, reading directly from guest memory
+		int err = HostTransfer(host_fd, buf_ptr, count,
+				mem::Memory::AccessRead);
 
 		// Return written bytes
 		return err;
@@ -1487,8 +1532,7 @@ int Context::ExecuteSyscall_kill()
 
 	// Send signal
 	context->signal_mask_table.getPending().Add(sig);
-	context->HostThreadSuspendCancel();
-	emulator->ProcessEventsSchedule();
+	context->HostWaitCancel();
 	emulator->ProcessEvents();
 
 	// Success
@@ -4044,8 +4088,8 @@ int Context::ExecuteSyscall_sched_rr_get_interval()
 
 bool Context::SyscallNanosleepCanWakeup()
 {
-	// If suspension thread is still running for this context, do nothing.
-	if (host_thread_suspend_active)
+	// If the host reactor is still watching this context, do nothing.
+	if (isHostWaitActive())
 		return false;
 
 	// Get current time
@@ -4088,11 +4132,8 @@ bool Context::SyscallNanosleepCanWakeup()
 		return true;
 	}
 
-	// No event available, launch host thread again
-	host_thread_suspend_active = true;
-	if (pthread_create(&host_thread_suspend, nullptr,
-			&Context::HostThreadSuspend, this))
-		throw misc::Panic("Could not create child thread");
+	// No event available, watch host events again
+	HostWaitStart();
 	
 	// Done
 	return false;
@@ -4275,8 +4316,8 @@ void Context::SyscallPollWakeup()
 
 bool Context::SyscallPollCanWakeup()
 {
-	// If host thread is still running for this context, do nothing.
-	if (host_thread_suspend_active)
+	// If the host reactor is still watching this context, do nothing.
+	if (isHostWaitActive())
 		return false;
 
 	// Current time
@@ -4355,11 +4396,8 @@ bool Context::SyscallPollCanWakeup()
 		return true;
 	}
 
-	// No event available, launch host thread again
-	host_thread_suspend_active = true;
-	if (pthread_create(&host_thread_suspend, nullptr,
-			&Context::HostThreadSuspend, this))
-		throw misc::Panic("Could not launch host thread");
+	// No event available, watch host events again
+	HostWaitStart();
 	
 	// Done
 	return false;
@@ -6719,8 +6757,7 @@ int Context::ExecuteSyscall_tgkill()
 
 	// Send signal
 	context->signal_mask_table.getPending().Add(sig);
-	context->HostThreadSuspendCancel();
-	emulator->ProcessEventsSchedule();
+	context->HostWaitCancel();
 	emulator->ProcessEvents();
 	return 0;
 }
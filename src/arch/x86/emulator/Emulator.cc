@@ -22,6 +22,7 @@
 
 #include "Context.h"
 #include "Emulator.h"
+#include "SimPoint.h"
 
 
 namespace x86
@@ -35,6 +36,23 @@ std::string Emulator::syscall_debug_file;
 
 long long Emulator::max_instructions;
 
+std::string Emulator::bbv_file;
+long long Emulator::bbv_interval = 10000000;
+
+std::string Emulator::branch_trace_file;
+
+std::string Emulator::instruction_capture_file;
+std::string Emulator::instruction_replay_file;
+
+std::vector<int> Emulator::instruction_stream_output_fds;
+int Emulator::instruction_stream_input_fd = -1;
+
+std::string Emulator::simpoint_file;
+int Emulator::simpoint_max_k = 10;
+
+int Emulator::host_quantum = 10000;
+bool Emulator::deterministic = false;
+
 std::unique_ptr<Emulator> Emulator::instance;
 
 misc::Debug Emulator::call_debug;
@@ -91,6 +109,89 @@ void Emulator::RegisterOptions()
 			"instructions. On x86 detailed simulation, it is given as "
 			"the number of committed (non-speculative) instructions. "
 			"A value of 0 means no limit.");
+
+	// Option --x86-bbv <file>
+	command_line->RegisterString("--x86-bbv <file>", bbv_file,
+			"Collect basic block vectors of the x86 program and dump "
+			"them into <file> in SimPoint format, one line per "
+			"interval of executed instructions. Only non-speculative "
+			"instructions are profiled, so this option can be used "
+			"both in functional and detailed simulation.");
+
+	// Option --x86-bbv-interval <number>
+	command_line->RegisterInt64("--x86-bbv-interval <number> "
+			"(default = 10M)",
+			bbv_interval,
+			"Number of instructions in each interval profiled with "
+			"option '--x86-bbv'.");
+
+	// Option --x86-branch-trace <file>
+	command_line->RegisterString("--x86-branch-trace <file>",
+			branch_trace_file,
+			"Dump a trace of the non-speculative control "
+			"instructions executed by the x86 program into <file>, "
+			"both in functional and detailed simulation. The trace "
+			"can be used to evaluate branch predictors stand-alone "
+			"with option '--x86-branch-eval'.");
+
+	// Option --x86-inst-capture <file>
+	command_line->RegisterString("--x86-inst-capture <file>",
+			instruction_capture_file,
+			"Capture the non-speculative instructions executed by "
+			"the x86 program into compressed trace <file>, together "
+			"with their micro-instructions, register dependences, "
+			"memory addresses, and next instruction addresses. The "
+			"trace can be replayed in detailed simulation with "
+			"option '--x86-inst-replay'.");
+
+	// Option --x86-inst-replay <file>
+	command_line->RegisterString("--x86-inst-replay <file>",
+			instruction_replay_file,
+			"Fetch the instructions of the x86 program from a trace "
+			"captured with option '--x86-inst-capture', instead of "
+			"emulating them. The program is still loaded to create "
+			"its context and to decode instructions fetched in "
+			"mispredicted paths, but its system calls are not "
+			"run, so input files are not needed. Only programs "
+			"running in one context are supported.");
+
+	// Option --x86-simpoint <file>
+	command_line->RegisterString("--x86-simpoint <file>", simpoint_file,
+			"Stand-alone selection of simulation points. Basic "
+			"block vectors are read from <file>, as produced by "
+			"option '--x86-bbv', and clustered with k-means. The "
+			"chosen simulation points and their weights are dumped "
+			"into the standard output, in the format expected by "
+			"variable 'SimPoints' in section [ Sampling ] of the x86 "
+			"configuration file.");
+
+	// Option --x86-simpoint-max-k <number>
+	command_line->RegisterInt32("--x86-simpoint-max-k <number> "
+			"(default = 10)",
+			simpoint_max_k,
+			"Maximum number of clusters, and therefore of "
+			"simulation points, chosen by option '--x86-simpoint'.");
+
+	// Option --x86-host-quantum <number>
+	command_line->RegisterInt32("--x86-host-quantum <number> "
+			"(default = 10000)",
+			host_quantum,
+			"Number of instructions run by each context between "
+			"synchronization points when x86 functional emulation "
+			"runs contexts concurrently on multiple host threads "
+			"(option '--host-threads').");
+
+	// Option --x86-deterministic
+	command_line->RegisterBool("--x86-deterministic",
+			deterministic,
+			"Make the concurrent execution of x86 contexts on "
+			"multiple host threads deterministic. Memory writes "
+			"of each context become visible to the rest only at "
+			"synchronization points, in context order, and atomic "
+			"instructions wait for the next synchronization point, "
+			"so that the guest program behaves the same way in "
+			"every run, for any number of host threads greater "
+			"than one.");
 }
 
 
@@ -102,6 +203,63 @@ void Emulator::ProcessOptions()
 	isa_debug.setPath(isa_debug_file);
 	loader_debug.setPath(loader_debug_file);
 	syscall_debug.setPath(syscall_debug_file);
+
+	// Quantum for concurrent execution
+	if (host_quantum < 1)
+		throw Error(misc::fmt("Invalid value for option "
+				"'--x86-host-quantum' (%d)", host_quantum));
+}
+
+
+void Emulator::SelectSimPoints(std::ostream &os)
+{
+	SimPoint simpoint;
+	simpoint.Read(simpoint_file);
+	simpoint.Cluster(simpoint_max_k);
+	simpoint.Dump(os);
+}
+
+
+Emulator::Emulator() : comm::Emulator("x86")
+{
+	// Basic block vector profiler
+	if (!bbv_file.empty())
+		bbv = misc::new_unique<Bbv>(bbv_file, bbv_interval);
+
+	// Branch trace
+	if (!branch_trace_file.empty())
+		branch_trace = misc::new_unique<BranchTrace>(branch_trace_file);
+
+	// Instruction streams, which own their file descriptors from now on
+	for (int fd : instruction_stream_output_fds)
+		instruction_stream_outputs.emplace_back(
+				misc::new_unique<InstructionStream>(fd, true));
+	if (instruction_stream_input_fd >= 0)
+		instruction_stream_input = misc::new_unique<InstructionStream>(
+				instruction_stream_input_fd, false);
+	instruction_stream_output_fds.clear();
+	instruction_stream_input_fd = -1;
+
+	// Instruction trace capture and replay
+	if (!instruction_capture_file.empty())
+		instruction_stream_outputs.emplace_back(
+				misc::new_unique<InstructionStream>(
+				instruction_capture_file, true));
+	if (!instruction_replay_file.empty())
+	{
+		if (instruction_stream_input)
+			throw Error("Option '--x86-inst-replay' cannot be used "
+					"with an instruction stream input");
+		instruction_stream_input = misc::new_unique<InstructionStream>(
+				instruction_replay_file, false);
+	}
+}
+
+
+void Emulator::CloseInstructionStreams()
+{
+	for (auto &instruction_stream : instruction_stream_outputs)
+		instruction_stream->Close();
 }
 
 
@@ -252,6 +410,18 @@ Context *Emulator::newContext()
 }
 
 
+HostReactor *Emulator::getHostReactor()
+{
+	// Create reactor the first time
+	if (!host_reactor)
+		host_reactor = misc::new_unique<HostReactor>([this]()
+		{
+			ProcessEventsSchedule();
+		});
+	return host_reactor.get();
+}
+
+
 Context *Emulator::getContext(int pid)
 {
 	// Find context
@@ -421,6 +591,106 @@ void Emulator::ProcessEvents()
 }
 
 
+bool Emulator::canRunConcurrently()
+{
+	// Only with multiple host threads, and when debug information or
+	// profiles do not depend on the order of instructions across contexts
+	if (esim::Engine::getNumHostThreads() < 2 ||
+			isa_debug || call_debug || bbv || branch_trace ||
+			hasInstructionStreamOutputs())
+		return false;
+
+	// Only with more than one running context
+	return running_contexts.size() > 1;
+}
+
+
+void Emulator::RunConcurrently()
+{
+	// Create thread pool
+	if (!thread_pool)
+		thread_pool = misc::new_unique<misc::ThreadPool>(
+				esim::Engine::getNumHostThreads());
+
+	// Snapshot of running contexts, in the order of the primary list.
+	// The quantum is limited so as not to exceed the maximum number of
+	// instructions by much.
+	std::vector<Context *> batch;
+	for (auto &context : contexts)
+		if (context->getState(Context::StateRunning))
+			batch.push_back(context.get());
+	int quantum = host_quantum;
+	if (max_instructions)
+		quantum = std::max(1LL, std::min((long long) quantum,
+				(max_instructions - num_instructions) /
+				(long long) batch.size()));
+
+	// Put memories in concurrent mode
+	for (Context *context : batch)
+		context->getMemory()->setConcurrent(true);
+	concurrent_contexts = batch;
+
+	// Run contexts concurrently
+	std::vector<int> num_batch_instructions(batch.size());
+	try
+	{
+		thread_pool->Run(batch.size(), [&](int index)
+		{
+			num_batch_instructions[index] = batch[index]->
+					ExecuteConcurrently(quantum,
+					deterministic);
+		});
+	}
+	catch (...)
+	{
+		for (Context *context : batch)
+			context->getMemory()->setConcurrent(false);
+		concurrent_contexts.clear();
+		throw;
+	}
+
+	// Leave concurrent mode
+	for (Context *context : batch)
+		context->getMemory()->setConcurrent(false);
+	concurrent_contexts.clear();
+
+	// Account for instructions and make buffered writes visible, in the
+	// order of the contexts
+	for (unsigned i = 0; i < batch.size(); i++)
+	{
+		num_instructions += num_batch_instructions[i];
+		batch[i]->CommitWrites();
+	}
+
+	// Run instructions that require exclusive access to the emulator,
+	// such as system calls or atomic instructions
+	for (Context *context : batch)
+	{
+		if (!context->isSerialPending())
+			continue;
+		context->clearSerialPending();
+		if (context->getState(Context::StateRunning))
+			context->Execute();
+	}
+}
+
+
+void Emulator::BeginExclusive()
+{
+	// Mutexes are always locked in the same order, so that two contexts
+	// requesting exclusive access cannot deadlock.
+	for (Context *context : concurrent_contexts)
+		context->LockConcurrentMutex();
+}
+
+
+void Emulator::EndExclusive()
+{
+	for (Context *context : concurrent_contexts)
+		context->UnlockConcurrentMutex();
+}
+
+
 bool Emulator::Run()
 {
 	// Stop if there is no more contexts
@@ -435,17 +705,26 @@ bool Emulator::Run()
 	if (esim->hasFinished())
 		return true;
 
-	// Run an instruction from every running context. During execution, a
-	// context can remove itself from the running list, so traversing the
-	// running list is not an option.
-	for (auto &context : contexts)
+	// Run a batch of instructions from every running context on multiple
+	// host threads
+	if (canRunConcurrently())
 	{
-		// Skip if not running
-		if (!context->getState(Context::StateRunning))
-			continue;
+		RunConcurrently();
+	}
+	else
+	{
+		// Run an instruction from every running context. During
+		// execution, a context can remove itself from the running
+		// list, so traversing the running list is not an option.
+		for (auto &context : contexts)
+		{
+			// Skip if not running
+			if (!context->getState(Context::StateRunning))
+				continue;
 
-		// Run one iteration
-		context->Execute();
+			// Run one iteration
+			context->Execute();
+		}
 	}
 
 	// Free finished contexts
@@ -27,8 +27,13 @@
 #include <lib/cpp/CommandLine.h>
 #include <lib/cpp/Debug.h>
 #include <lib/cpp/Error.h>
+#include <lib/cpp/ThreadPool.h>
 
+#include "Bbv.h"
+#include "BranchTrace.h"
 #include "Context.h"
+#include "HostReactor.h"
+#include "InstructionStream.h"
 
 
 namespace x86
@@ -68,6 +73,30 @@ class Emulator : public comm::Emulator
 	// Maximum number of instructions
 	static long long max_instructions;
 
+	// Basic block vector profiling
+	static std::string bbv_file;
+	static long long bbv_interval;
+
+	// Branch trace capture
+	static std::string branch_trace_file;
+
+	// Instruction trace capture and replay
+	static std::string instruction_capture_file;
+	static std::string instruction_replay_file;
+
+	// File descriptors of the instruction streams written by the
+	// emulator, and of the instruction stream read by it, or -1
+	static std::vector<int> instruction_stream_output_fds;
+	static int instruction_stream_input_fd;
+
+	// Simulation point selection
+	static std::string simpoint_file;
+	static int simpoint_max_k;
+
+	// Concurrent execution of contexts on host threads
+	static int host_quantum;
+	static bool deterministic;
+
 	// Unique instance of singleton
 	static std::unique_ptr<Emulator> instance;
 
@@ -110,6 +139,40 @@ class Emulator : public comm::Emulator
 	// for FIFO wakeups.
 	long long futex_sleep_count = 0;
 
+	// Basic block vector profiler, or null if profiling is not active
+	std::unique_ptr<Bbv> bbv;
+
+	// Trace of control instructions, or null if not captured
+	std::unique_ptr<BranchTrace> branch_trace;
+
+	// Instruction streams written with the executed instructions
+	std::vector<std::unique_ptr<InstructionStream>>
+			instruction_stream_outputs;
+
+	// Instruction stream providing the executed instructions instead of
+	// the emulation, or null
+	std::unique_ptr<InstructionStream> instruction_stream_input;
+
+	// Pool of host threads running contexts concurrently, created the
+	// first time it is needed
+	std::unique_ptr<misc::ThreadPool> thread_pool;
+
+	// Contexts of the batch currently running concurrently, in the order
+	// in which their mutexes are locked for exclusive access
+	std::vector<Context *> concurrent_contexts;
+
+	// Reactor watching host events for suspended contexts, created the
+	// first time it is needed
+	std::unique_ptr<HostReactor> host_reactor;
+
+	// Return whether contexts can run concurrently on host threads in
+	// the current iteration of the emulation loop
+	bool canRunConcurrently();
+
+	// Run one batch of instructions from all running contexts, on as many
+	// host threads as given by option '--host-threads'
+	void RunConcurrently();
+
 
 public:
 
@@ -129,6 +192,33 @@ public:
 	/// Process command-line options
 	static void ProcessOptions();
 
+	/// Return whether option '--x86-simpoint' was given. In this case,
+	/// simulation points are selected with SelectSimPoints() instead of
+	/// running a simulation.
+	static bool isSimPointSelection() { return !simpoint_file.empty(); }
+
+	/// Select simulation points from the basic block vectors given with
+	/// option '--x86-simpoint', and dump them into \a os.
+	static void SelectSimPoints(std::ostream &os = std::cout);
+
+	/// Write the non-speculative instructions executed by all contexts
+	/// into an instruction stream on host file descriptor \a fd. This
+	/// must be invoked before the emulator is created, which takes
+	/// ownership of the descriptor.
+	static void addInstructionStreamOutput(int fd)
+	{
+		instruction_stream_output_fds.push_back(fd);
+	}
+
+	/// Read the instructions executed by the contexts from an instruction
+	/// stream on host file descriptor \a fd, instead of emulating them.
+	/// This must be invoked before the emulator is created, which takes
+	/// ownership of the descriptor.
+	static void setInstructionStreamInput(int fd)
+	{
+		instruction_stream_input_fd = fd;
+	}
+
 	/// Return the maximum number of instructions, as set up by the user
 	static long long getMaxInstructions() { return max_instructions; }
 
@@ -155,7 +245,44 @@ public:
 	//
 
 	/// Constructor
-	Emulator() : comm::Emulator("x86") { }
+	Emulator();
+
+	/// Return the basic block vector profiler, or null if basic block
+	/// vectors are not being collected.
+	Bbv *getBbv() const { return bbv.get(); }
+
+	/// Return the branch trace, or null if control instructions are not
+	/// being traced.
+	BranchTrace *getBranchTrace() const { return branch_trace.get(); }
+
+	/// Return whether executed instructions are written into instruction
+	/// streams
+	bool hasInstructionStreamOutputs() const
+	{
+		return !instruction_stream_outputs.empty();
+	}
+
+	/// Write a non-speculative instruction into all instruction streams
+	void WriteInstructionStreams(const InstructionStream::Record &record)
+	{
+		for (auto &instruction_stream : instruction_stream_outputs)
+			instruction_stream->Write(record);
+	}
+
+	/// Close all instruction streams written by the emulator
+	void CloseInstructionStreams();
+
+	/// Return the instruction stream providing the executed
+	/// instructions, or null if instructions are emulated.
+	InstructionStream *getInstructionStreamInput() const
+	{
+		return instruction_stream_input.get();
+	}
+
+	/// Return the reactor watching host file descriptors and timeouts on
+	/// behalf of contexts suspended in blocking system calls. Its thread
+	/// schedules a call to ProcessEvents() every time a watch fires.
+	HostReactor *getHostReactor();
 
 	/// Create a new context associated with the emulator. The context is
 	/// inserted in the main emulator context list. Its state is set to
@@ -188,6 +315,28 @@ public:
 	/// Unlock the emulator mutex
 	void UnlockMutex() { pthread_mutex_unlock(&mutex); }
 
+	/// Give the calling context exclusive access to the memory while
+	/// contexts run concurrently, by waiting for every other context to
+	/// reach an instruction boundary and stopping it there. The caller
+	/// must not hold its own concurrent mutex.
+	void BeginExclusive();
+
+	/// Let the contexts stopped by BeginExclusive() continue
+	void EndExclusive();
+
+	/// Set the number of instructions that each context runs per batch
+	/// when contexts run concurrently on host threads
+	static void setHostQuantum(int host_quantum)
+	{
+		Emulator::host_quantum = host_quantum;
+	}
+
+	/// Make the concurrent execution of contexts deterministic
+	static void setDeterministic(bool deterministic)
+	{
+		Emulator::deterministic = deterministic;
+	}
+
 	// Check for events detected in spawned host threads, such as waking up
 	// contexts or sending signals. The list is only effectively processed
 	// if events have been scheduled to get processed with a previous call
@@ -0,0 +1,329 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cerrno>
+#include <ctime>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+#include <vector>
+
+#include <lib/cpp/Error.h>
+#include <lib/cpp/Misc.h>
+
+#include "HostReactor.h"
+
+
+namespace x86
+{
+
+
+HostReactor::HostReactor(std::function<void()> notify) :
+		notify(notify)
+{
+	pthread_mutex_init(&mutex, nullptr);
+}
+
+
+HostReactor::~HostReactor()
+{
+	// Stop reactor thread. If the exit event cannot be signaled, the
+	// thread is canceled while it waits in 'epoll_wait'.
+	if (thread_active)
+	{
+		uint64_t value = 1;
+		if (write(exit_fd, &value, sizeof value) != sizeof value)
+		{
+			misc::Warning("Cannot signal host reactor thread, "
+					"canceling it");
+			pthread_cancel(thread);
+		}
+		pthread_join(thread, nullptr);
+	}
+
+	// Close remaining watches
+	for (auto &it : watches)
+		if (it.second.fd >= 0)
+			close(it.second.fd);
+
+	// Close reactor descriptors
+	if (epoll_fd >= 0)
+		close(epoll_fd);
+	if (timer_fd >= 0)
+		close(timer_fd);
+	if (exit_fd >= 0)
+		close(exit_fd);
+	pthread_mutex_destroy(&mutex);
+}
+
+
+long long HostReactor::getTime()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (long long) ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+
+void HostReactor::Start()
+{
+	// Create epoll instance, timer, and exit event
+	epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+	timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+	exit_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (epoll_fd < 0 || timer_fd < 0 || exit_fd < 0)
+		throw misc::Panic("Cannot create host reactor");
+
+	// Register timer and exit event. A null pointer identifies them.
+	struct epoll_event event = {};
+	event.events = EPOLLIN;
+	event.data.ptr = nullptr;
+	if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, timer_fd, &event) ||
+			epoll_ctl(epoll_fd, EPOLL_CTL_ADD, exit_fd, &event))
+		throw misc::Panic("Cannot register host reactor events");
+
+	// Launch thread
+	if (pthread_create(&thread, nullptr, &HostReactor::ThreadMain, this))
+		throw misc::Panic("Cannot launch host reactor thread");
+	thread_active = true;
+}
+
+
+void HostReactor::RemoveUnsafe(Context *context)
+{
+	auto it = watches.find(context);
+	if (it == watches.end())
+		return;
+
+	// Unregister file descriptor
+	Watch &watch = it->second;
+	if (watch.fd >= 0)
+	{
+		epoll_ctl(epoll_fd, EPOLL_CTL_DEL, watch.fd, nullptr);
+		close(watch.fd);
+	}
+
+	// Remove deadline
+	if (watch.deadline)
+		deadlines.erase(std::make_pair(watch.deadline, context));
+	watches.erase(it);
+}
+
+
+bool HostReactor::ArmTimerUnsafe()
+{
+	// Disarm timer if there is no deadline. Otherwise, program it with a
+	// relative time, at least one nanosecond, since zero disarms it.
+	struct itimerspec spec = {};
+	if (!deadlines.empty())
+	{
+		long long timeout = deadlines.begin()->first - getTime();
+		if (timeout <= 0)
+			spec.it_value.tv_nsec = 1;
+		else
+		{
+			spec.it_value.tv_sec = timeout / 1000000;
+			spec.it_value.tv_nsec = timeout % 1000000 * 1000;
+		}
+	}
+	return !timerfd_settime(timer_fd, 0, &spec, nullptr);
+}
+
+
+void HostReactor::Run()
+{
+	const int max_events = 64;
+	struct epoll_event events[max_events];
+	for (;;)
+	{
+		// Wait for events
+		int num_events = epoll_wait(epoll_fd, events, max_events, -1);
+		if (num_events < 0 && errno == EINTR)
+			continue;
+
+		// Record error and notify the emulator, which finds it the
+		// next time it checks a watch
+		pthread_mutex_lock(&mutex);
+		if (num_events < 0)
+		{
+			error = "Unexpected error in host 'epoll_wait'";
+			pthread_mutex_unlock(&mutex);
+			notify();
+			return;
+		}
+
+		// Remove watches that fired
+		bool fired = false;
+		for (int i = 0; i < num_events; i++)
+		{
+			// Watched file descriptor
+			Context *context = (Context *) events[i].data.ptr;
+			if (context)
+			{
+				RemoveUnsafe(context);
+				fired = true;
+				continue;
+			}
+
+			// Exit request
+			uint64_t value;
+			if (read(exit_fd, &value, sizeof value) > 0)
+			{
+				pthread_mutex_unlock(&mutex);
+				return;
+			}
+
+			// Timer. Remove expired deadlines.
+			if (read(timer_fd, &value, sizeof value) > 0)
+			{
+				long long now = getTime();
+				while (!deadlines.empty() &&
+						deadlines.begin()->first <= now)
+				{
+					RemoveUnsafe(deadlines.begin()->second);
+					fired = true;
+				}
+				if (!ArmTimerUnsafe())
+				{
+					error = "Cannot program host reactor "
+							"timer";
+					pthread_mutex_unlock(&mutex);
+					notify();
+					return;
+				}
+			}
+		}
+		pthread_mutex_unlock(&mutex);
+
+		// Notify the emulator without holding the mutex
+		if (fired)
+			notify();
+	}
+}
+
+
+bool HostReactor::Add(Context *context, int host_fd, int events,
+		long long timeout)
+{
+	pthread_mutex_lock(&mutex);
+	try
+	{
+		bool watching = AddUnsafe(context, host_fd, events, timeout);
+		pthread_mutex_unlock(&mutex);
+		return watching;
+	}
+	catch (...)
+	{
+		pthread_mutex_unlock(&mutex);
+		throw;
+	}
+}
+
+
+bool HostReactor::AddUnsafe(Context *context, int host_fd, int events,
+		long long timeout)
+{
+	// Reactor thread stopped
+	if (!error.empty())
+		throw misc::Panic(error);
+	if (!thread_active)
+		Start();
+
+	// Replace previous watch
+	RemoveUnsafe(context);
+	Watch &watch = watches[context];
+
+	// Register a duplicate of the file descriptor, so that several
+	// contexts can watch the same host file descriptor. Files that do not
+	// support epoll, such as regular files, never block, so they are
+	// reported as ready right away.
+	bool ready = false;
+	if (host_fd >= 0)
+	{
+		watch.fd = fcntl(host_fd, F_DUPFD_CLOEXEC, 0);
+		if (watch.fd < 0)
+		{
+			watches.erase(context);
+			throw misc::Panic("Cannot duplicate host file "
+					"descriptor");
+		}
+		struct epoll_event event = {};
+		event.events = EPOLLONESHOT |
+				((events & POLLIN) ? EPOLLIN : 0) |
+				((events & POLLOUT) ? EPOLLOUT : 0);
+		event.data.ptr = context;
+		if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, watch.fd, &event))
+		{
+			if (errno != EPERM)
+			{
+				RemoveUnsafe(context);
+				throw misc::Panic("Cannot watch host file "
+						"descriptor");
+			}
+			close(watch.fd);
+			watch.fd = -1;
+			ready = true;
+		}
+	}
+
+	// Register deadline
+	if (timeout >= 0 && !ready)
+	{
+		watch.deadline = getTime() + timeout;
+		bool earliest = deadlines.empty() ||
+				watch.deadline < deadlines.begin()->first;
+		deadlines.insert(std::make_pair(watch.deadline, context));
+		if (earliest && !ArmTimerUnsafe())
+		{
+			RemoveUnsafe(context);
+			throw misc::Panic("Cannot program host reactor timer");
+		}
+	}
+
+	// Watch already fired
+	if (ready)
+		RemoveUnsafe(context);
+	return !ready;
+}
+
+
+void HostReactor::Cancel(Context *context)
+{
+	pthread_mutex_lock(&mutex);
+	RemoveUnsafe(context);
+	pthread_mutex_unlock(&mutex);
+}
+
+
+bool HostReactor::isWatching(Context *context)
+{
+	pthread_mutex_lock(&mutex);
+	bool watching = watches.count(context);
+	std::string error = this->error;
+	pthread_mutex_unlock(&mutex);
+	if (!error.empty())
+		throw misc::Panic(error);
+	return watching;
+}
+
+
+}  // namespace x86
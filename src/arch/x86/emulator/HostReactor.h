@@ -0,0 +1,163 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef ARCH_X86_EMULATOR_HOST_REACTOR_H
+#define ARCH_X86_EMULATOR_HOST_REACTOR_H
+
+#include <functional>
+#include <pthread.h>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+
+namespace x86
+{
+
+// Forward declarations
+class Context;
+
+
+/// Single host thread waiting for events on behalf of all contexts suspended
+/// in blocking system calls. Each suspended context can watch one host file
+/// descriptor and one timeout. The reactor multiplexes all of them with
+/// \c epoll and a \c timerfd, and invokes a notification function when any
+/// of them fires, so that the emulator can check the suspended contexts
+/// again in its next call to ProcessEvents().
+///
+/// A watch is one-shot: it is removed as soon as it fires, or when it is
+/// explicitly canceled.
+class HostReactor
+{
+	// A context watching host events
+	struct Watch
+	{
+		// Duplicate of the host file descriptor registered with epoll,
+		// or -1 if no file descriptor is watched
+		int fd = -1;
+
+		// Absolute deadline in microseconds of the monotonic host
+		// clock, or 0 for no timeout
+		long long deadline = 0;
+	};
+
+	// Function invoked by the reactor thread when a watch fires
+	std::function<void()> notify;
+
+	// Mutex protecting the fields below. The reactor thread never holds it
+	// while invoking the notification function, so it can be acquired
+	// while holding the emulator mutex.
+	pthread_mutex_t mutex;
+
+	// Reactor thread, started on the first watch
+	pthread_t thread;
+	bool thread_active = false;
+
+	// Error that stopped the reactor thread, or empty if it is running
+	// normally. It is reported to the owning thread by the next call to
+	// Add() or isWatching().
+	std::string error;
+
+	// epoll instance, timer, and event used to stop the reactor thread
+	int epoll_fd = -1;
+	int timer_fd = -1;
+	int exit_fd = -1;
+
+	// Watches, indexed by context
+	std::unordered_map<Context *, Watch> watches;
+
+	// Deadlines of watches with a timeout, sorted by time
+	std::set<std::pair<long long, Context *>> deadlines;
+
+	// Return the current time of the monotonic host clock in microseconds
+	static long long getTime();
+
+	// Create the epoll instance and launch the reactor thread
+	void Start();
+
+	// Add a watch. The mutex must be locked.
+	bool AddUnsafe(Context *context, int host_fd, int events,
+			long long timeout);
+
+	// Remove a watch. The mutex must be locked.
+	void RemoveUnsafe(Context *context);
+
+	// Program the timer to expire at the earliest deadline. The mutex must
+	// be locked. Return false if the timer could not be programmed.
+	bool ArmTimerUnsafe();
+
+	// Main loop of the reactor thread. Errors are not thrown in this
+	// thread, but recorded in field 'error'.
+	void Run();
+	static void *ThreadMain(void *data)
+	{
+		((HostReactor *) data)->Run();
+		return nullptr;
+	}
+
+public:
+
+	/// Create a reactor that invokes function \a notify from the reactor
+	/// thread every time one or more watches fire.
+	explicit HostReactor(std::function<void()> notify);
+
+	/// Destructor. The reactor thread is stopped and joined.
+	~HostReactor();
+
+	/// Watch host events on behalf of a suspended context, replacing any
+	/// previous watch of the same context.
+	///
+	/// \param context
+	///	Context waiting for the events.
+	///
+	/// \param host_fd
+	///	Host file descriptor to watch, or -1 to watch a timeout only.
+	///
+	/// \param events
+	///	Combination of \c POLLIN and \c POLLOUT flags for \a host_fd.
+	///
+	/// \param timeout
+	///	Time in microseconds from now after which the watch fires even
+	///	if no event occurred in \a host_fd, or -1 for no timeout.
+	///
+	/// \return
+	///	The function returns \c false if the events can be observed right
+	///	away, in which case no watch is added and the notification
+	///	function is not invoked. This happens for host files that do not
+	///	support \c epoll, such as regular files, since they never block.
+	///
+	/// \throw
+	///	misc::Panic if the watch cannot be added, or if the reactor
+	///	thread stopped due to an error.
+	bool Add(Context *context, int host_fd, int events, long long timeout);
+
+	/// Cancel the watch of a context, if any
+	void Cancel(Context *context);
+
+	/// Return whether a context has a watch that did not fire yet. This
+	/// function throws misc::Panic if the reactor thread stopped due to
+	/// an error, since the watch would then never fire.
+	bool isWatching(Context *context);
+};
+
+
+}  // namespace x86
+
+#endif
@@ -0,0 +1,302 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include <cassert>
+#include <cstring>
+#include <zlib.h>
+
+#include <lib/cpp/Misc.h>
+#include <lib/cpp/String.h>
+
+#include "InstructionStream.h"
+
+
+namespace x86
+{
+
+const char *InstructionStream::magic = "M2SX86IS";
+
+const unsigned char InstructionStream::version = 2;
+
+
+InstructionStream::InstructionStream(int fd, bool output) :
+		path(misc::fmt("file descriptor %d", fd)),
+		output(output)
+{
+	Open(gzdopen(fd, output ? "wT" : "rb"));
+}
+
+
+InstructionStream::InstructionStream(const std::string &path, bool output) :
+		path(path),
+		output(output)
+{
+	Open(gzopen(path.c_str(), output ? "wb" : "rb"));
+}
+
+
+InstructionStream::~InstructionStream()
+{
+	Close();
+}
+
+
+void InstructionStream::Open(gzFile_s *file)
+{
+	// Check file
+	this->file = file;
+	if (!file)
+		throw Error(misc::fmt("%s: Cannot open %s", path.c_str(),
+				output ? "for writing" : "for reading"));
+	bytes_table.resize(BytesTableSize);
+
+	// The header of an output stream is written right away. The header
+	// of an input stream is read with the first record, so as not to
+	// block on a pipe before the simulation starts.
+	if (output)
+	{
+		gzwrite(file, magic, strlen(magic));
+		gzwrite(file, &version, 1);
+	}
+}
+
+
+void InstructionStream::Close()
+{
+	if (file)
+		gzclose(file);
+	file = nullptr;
+}
+
+
+void InstructionStream::Encode(unsigned value, int size)
+{
+	for (int i = 0; i < size; i++)
+	{
+		buffer.push_back(value & 0xff);
+		value >>= 8;
+	}
+}
+
+
+void InstructionStream::Write(const Record &record)
+{
+	// Ignore after errors
+	assert(output);
+	if (failed || !file)
+		return;
+
+	// Omitted fields
+	int flags = 0;
+	if (record.pid != pid || record.eip != neip)
+		flags |= FlagEip;
+	BytesEntry &entry = bytes_table[record.eip % BytesTableSize];
+	if (entry.eip == record.eip && entry.size == record.size &&
+			!memcmp(entry.bytes, record.bytes, record.size))
+		flags |= FlagCachedBytes;
+	if (record.neip != record.eip + record.size)
+		flags |= FlagNeip;
+	if (record.target_eip)
+		flags |= FlagTarget;
+	if (record.finished)
+		flags |= FlagFinished;
+
+	// Fixed part
+	if (record.uinsts.size() > 255)
+		throw Error(misc::fmt("[0x%x] Too many micro-instructions",
+				record.eip));
+	buffer.clear();
+	Encode(flags, 1);
+	if (flags & FlagEip)
+	{
+		Encode(record.pid, 4);
+		Encode(record.eip, 4);
+	}
+	if (!(flags & FlagCachedBytes))
+	{
+		Encode(record.size, 1);
+		buffer.insert(buffer.end(), record.bytes,
+				record.bytes + record.size);
+		entry.eip = record.eip;
+		entry.size = record.size;
+		memcpy(entry.bytes, record.bytes, record.size);
+	}
+	if (flags & FlagNeip)
+		Encode(record.neip, 4);
+	if (flags & FlagTarget)
+		Encode(record.target_eip, 4);
+	if (flags & FlagFinished)
+		Encode(record.exit_code, 4);
+	Encode(record.uinsts.size(), 1);
+
+	// Micro-instructions
+	for (auto &uinst : record.uinsts)
+	{
+		// Mask of dependences
+		Encode(uinst->getOpcode(), 1);
+		int dep_mask = 0;
+		for (int i = 0; i < Uinst::MaxDeps; i++)
+			if (uinst->getDep(i))
+				dep_mask |= 1 << i;
+		Encode(dep_mask, 1);
+
+		// Dependences
+		for (int i = 0; i < Uinst::MaxDeps; i++)
+		{
+			int dep = uinst->getDep(i);
+			if (dep > 255)
+				throw Error(misc::fmt("[0x%x] Unresolved "
+						"dependence %d", record.eip,
+						dep));
+			if (dep)
+				Encode(dep, 1);
+		}
+
+		// Memory access
+		Encode(uinst->getSize(), 1);
+		if (uinst->getSize())
+			Encode(uinst->getAddress(), 4);
+	}
+
+	// Write
+	if (gzwrite(file, buffer.data(), buffer.size()) != (int) buffer.size())
+		failed = true;
+	pid = record.pid;
+	neip = record.neip;
+	num_records++;
+}
+
+
+bool InstructionStream::ReadBytes(void *data, int size)
+{
+	int count = gzread(file, data, size);
+	if (count < 0)
+		throw Error(misc::fmt("%s: Cannot read stream",
+				path.c_str()));
+	return count == size;
+}
+
+
+unsigned InstructionStream::Decode(int size)
+{
+	unsigned char bytes[4];
+	assert(size <= 4);
+	if (!ReadBytes(bytes, size))
+		throw Error(misc::fmt("%s: Truncated stream", path.c_str()));
+	unsigned value = 0;
+	for (int i = size - 1; i >= 0; i--)
+		value = value << 8 | bytes[i];
+	return value;
+}
+
+
+bool InstructionStream::Read(Record &record)
+{
+	// Header
+	assert(!output);
+	if (!header_read)
+	{
+		char header[16];
+		int size = strlen(magic);
+		if (!ReadBytes(header, size + 1) ||
+				memcmp(header, magic, size))
+			throw Error(misc::fmt("%s: Not an x86 instruction "
+					"stream", path.c_str()));
+		if ((unsigned char) header[size] != version)
+			throw Error(misc::fmt("%s: Unsupported version %d",
+					path.c_str(), header[size]));
+		header_read = true;
+	}
+
+	// Flags. The stream may only end between records.
+	unsigned char flags;
+	if (!ReadBytes(&flags, 1))
+		return false;
+
+	// Context and address
+	record.pid = pid;
+	record.eip = neip;
+	if (flags & FlagEip)
+	{
+		record.pid = Decode(4);
+		record.eip = Decode(4);
+	}
+
+	// Instruction bytes
+	BytesEntry &entry = bytes_table[record.eip % BytesTableSize];
+	if (flags & FlagCachedBytes)
+	{
+		if (entry.eip != record.eip || !entry.size)
+			throw Error(misc::fmt("%s: [0x%x] Invalid instruction "
+					"bytes", path.c_str(), record.eip));
+	}
+	else
+	{
+		entry.eip = record.eip;
+		entry.size = Decode(1);
+		if (entry.size > MaxInstructionSize ||
+				!ReadBytes(entry.bytes, entry.size))
+			throw Error(misc::fmt("%s: Truncated stream",
+					path.c_str()));
+	}
+	record.size = entry.size;
+	memcpy(record.bytes, entry.bytes, entry.size);
+
+	// Next and target address
+	record.neip = flags & FlagNeip ? Decode(4) :
+			record.eip + record.size;
+	record.target_eip = flags & FlagTarget ? Decode(4) : 0;
+
+	// Exit code
+	record.finished = flags & FlagFinished;
+	record.exit_code = record.finished ? (int) Decode(4) : 0;
+
+	// Micro-instructions
+	int num_uinsts = Decode(1);
+	record.uinsts.clear();
+	for (int index = 0; index < num_uinsts; index++)
+	{
+		// Opcode
+		int opcode = Decode(1);
+		if (opcode >= Uinst::OpcodeCount)
+			throw Error(misc::fmt("%s: Invalid micro-instruction "
+					"opcode %d", path.c_str(), opcode));
+		auto uinst = misc::new_shared<Uinst>((Uinst::Opcode) opcode);
+
+		// Dependences
+		int dep_mask = Decode(1);
+		for (int i = 0; i < Uinst::MaxDeps; i++)
+			if (dep_mask & (1 << i))
+				uinst->setDep(i, Decode(1));
+
+		// Memory access
+		int size = Decode(1);
+		if (size)
+			uinst->setMemoryAccess(Decode(4), size);
+		record.uinsts.push_back(uinst);
+	}
+
+	// Done
+	pid = record.pid;
+	neip = record.neip;
+	num_records++;
+	return true;
+}
+
+
+}  // namespace x86
@@ -0,0 +1,228 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef ARCH_X86_EMULATOR_INSTRUCTION_STREAM_H
+#define ARCH_X86_EMULATOR_INSTRUCTION_STREAM_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <lib/cpp/Error.h>
+
+#include "Uinst.h"
+
+
+// Forward declarations
+struct gzFile_s;
+
+
+namespace x86
+{
+
+/// Stream of the non-speculative instructions executed by the functional
+/// emulator. Each instruction is stored together with its raw bytes, the
+/// micro-instructions produced for it, including the addresses of their
+/// memory accesses, and the address of the instruction executed next.
+/// A detailed simulation reading the stream fetches its instructions from
+/// it instead of emulating them. Streams are written either into a pipe,
+/// feeding the timing models of simulations running in other processes,
+/// or into a compressed trace file, replayed later.
+///
+/// The stream starts with a header identifying the format, followed by one
+/// record per instruction. Fields that can be inferred from the previous
+/// records are omitted, as given by a byte of flags in each record:
+///
+///	unsigned char flags
+///	[FlagEip] int pid, unsigned eip
+///	[!FlagCachedBytes] unsigned char size, char bytes[size]
+///	[FlagNeip] unsigned neip
+///	[FlagTarget] unsigned target_eip
+///	[FlagFinished] int exit_code
+///	unsigned char num_uinsts
+///
+/// Fields in brackets are only present with the given flag set or clear.
+/// The instruction address is omitted when it is the address following the
+/// previous record, for the same context. The instruction bytes are
+/// omitted if they match the bytes of the last instruction recorded at the
+/// same address, as found in a small table indexed by address. The next
+/// address is omitted if it is the next sequential instruction. The exit
+/// code is present in the record of the instruction that finished the
+/// context, such as a call to 'exit'. Each
+/// micro-instruction is then encoded as:
+///
+///	unsigned char opcode, unsigned char dep_mask
+///	unsigned char dep[...], one per bit set in 'dep_mask'
+///	unsigned char memory_access_size
+///	[memory_access_size != 0] unsigned address
+///
+/// All multi-byte fields are stored in little-endian byte order.
+class InstructionStream
+{
+public:
+
+	/// Exception for the instruction stream
+	class Error : public misc::Error
+	{
+	public:
+
+		Error(const std::string &message) : misc::Error(message)
+		{
+			AppendPrefix("x86 instruction stream");
+		}
+	};
+
+	/// Maximum size of an x86 instruction in bytes
+	static const int MaxInstructionSize = 15;
+
+	/// Instruction in the stream
+	struct Record
+	{
+		// Context executing the instruction
+		int pid = 0;
+
+		// Address of the instruction
+		unsigned eip = 0;
+
+		// Raw bytes of the instruction
+		int size = 0;
+		char bytes[MaxInstructionSize];
+
+		// Address of the next executed instruction
+		unsigned neip = 0;
+
+		// Target address of a control instruction, or 0
+		unsigned target_eip = 0;
+
+		// Whether the instruction finished the context, and the exit
+		// code of the context in that case
+		bool finished = false;
+		int exit_code = 0;
+
+		// Micro-instructions
+		std::vector<std::shared_ptr<Uinst>> uinsts;
+	};
+
+private:
+
+	// Identifier at the beginning of the stream
+	static const char *magic;
+
+	// Version of the stream format
+	static const unsigned char version;
+
+	// Flags of a record
+	enum Flag
+	{
+		FlagEip = 0x1,
+		FlagCachedBytes = 0x2,
+		FlagNeip = 0x4,
+		FlagTarget = 0x8,
+		FlagFinished = 0x10
+	};
+
+	// Size of the table of instruction bytes
+	static const int BytesTableSize = 1024;
+
+	// Entry of the table of instruction bytes
+	struct BytesEntry
+	{
+		unsigned eip = 0;
+		int size = 0;
+		char bytes[MaxInstructionSize];
+	};
+
+	// File name, or description of the file descriptor
+	std::string path;
+
+	// Compressed file, or plain file for streams written to pipes
+	gzFile_s *file = nullptr;
+
+	// Whether the stream is written
+	bool output;
+
+	// Whether the header was read from an input stream
+	bool header_read = false;
+
+	// Whether an error occurred writing the stream. Further writes are
+	// ignored, since the error is caused by the reader exiting.
+	bool failed = false;
+
+	// Buffer holding an encoded record
+	std::vector<unsigned char> buffer;
+
+	// Context and address of the instruction following the last record
+	int pid = 0;
+	unsigned neip = 0;
+
+	// Last instruction bytes recorded at each address, indexed by
+	// address modulo the table size
+	std::vector<BytesEntry> bytes_table;
+
+	// Number of records written or read so far
+	long long num_records = 0;
+
+	// Open the stream for a file handle created with gzdopen or gzopen
+	void Open(gzFile_s *file);
+
+	// Append a value to the buffer
+	void Encode(unsigned value, int size);
+
+	// Read exactly 'size' bytes, or return false at the end of the stream
+	bool ReadBytes(void *data, int size);
+
+	// Read a value of 'size' bytes, failing at the end of the stream
+	unsigned Decode(int size);
+
+public:
+
+	/// Create a stream on a host file descriptor, typically a pipe.
+	///
+	/// \param fd
+	///	Host file descriptor, owned by the stream from now on.
+	///
+	/// \param output
+	///	Whether the stream is written (true) or read (false). Output
+	///	streams are not compressed, as they are meant to be consumed
+	///	right away through a pipe.
+	///
+	InstructionStream(int fd, bool output);
+
+	/// Create a stream on a trace file. Output streams are compressed.
+	InstructionStream(const std::string &path, bool output);
+
+	/// Destructor, flushing and closing the stream
+	~InstructionStream();
+
+	/// Append a record to an output stream
+	void Write(const Record &record);
+
+	/// Read the next record of an input stream. The function returns
+	/// false when the end of the stream is reached.
+	bool Read(Record &record);
+
+	/// Flush and close the stream, letting the reader see the end of it
+	void Close();
+
+	/// Return the number of records written or read so far
+	long long getNumRecords() const { return num_records; }
+};
+
+}  // namespace x86
+
+#endif
@@ -0,0 +1,367 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <random>
+#include <sstream>
+
+#include <lib/cpp/String.h>
+
+#include "SimPoint.h"
+
+
+namespace x86
+{
+
+double SimPoint::getProjection(int block_id, int dimension)
+{
+	// Mix block identifier and dimension (splitmix64)
+	unsigned long long x = (unsigned long long) block_id
+			* num_dimensions + dimension;
+	x += 0x9e3779b97f4a7c15ull;
+	x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+	x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+	x = x ^ (x >> 31);
+
+	// Map upper 53 bits into [-1, 1]
+	return (double) (x >> 11) / (double) (1ull << 52) - 1.0;
+}
+
+
+double SimPoint::getDistance(const std::vector<double> &a,
+		const std::vector<double> &b)
+{
+	double distance = 0.0;
+	for (unsigned i = 0; i < a.size(); i++)
+		distance += (a[i] - b[i]) * (a[i] - b[i]);
+	return distance;
+}
+
+
+void SimPoint::Read(const std::string &path)
+{
+	std::ifstream f(path);
+	if (!f)
+		throw Error(misc::fmt("%s: Cannot open file", path.c_str()));
+	Read(f);
+}
+
+
+void SimPoint::Read(std::istream &is)
+{
+	std::string line;
+	int line_num = 0;
+	while (std::getline(is, line))
+	{
+		// Skip empty lines and comments
+		line_num++;
+		misc::StringTrim(line);
+		if (line.empty() || line[0] == '#')
+			continue;
+
+		// Vector lines start with 'T'
+		if (line[0] != 'T')
+			throw Error(misc::fmt("Line %d: Invalid basic block "
+					"vector", line_num));
+
+		// Read ':<block_id>:<count>' pairs
+		std::vector<std::pair<int, long long>> counts;
+		long long length = 0;
+		std::istringstream ss(line.substr(1));
+		std::string token;
+		while (ss >> token)
+		{
+			int block_id;
+			long long count;
+			if (sscanf(token.c_str(), ":%d:%lld", &block_id,
+					&count) != 2 || block_id < 1 || count < 0)
+				throw Error(misc::fmt("Line %d: Invalid token "
+						"'%s'", line_num,
+						token.c_str()));
+			counts.emplace_back(block_id, count);
+			length += count;
+		}
+		if (!length)
+			throw Error(misc::fmt("Line %d: Empty basic block "
+					"vector", line_num));
+
+		// Normalize and project vector
+		std::vector<double> vector(num_dimensions, 0.0);
+		for (auto &it : counts)
+		{
+			double value = (double) it.second / length;
+			for (int i = 0; i < num_dimensions; i++)
+				vector[i] += value * getProjection(it.first, i);
+		}
+
+		// Save interval
+		vectors.push_back(vector);
+		starts.push_back(num_instructions);
+		lengths.push_back(length);
+		num_instructions += length;
+	}
+}
+
+
+double SimPoint::KMeans(int k, unsigned seed,
+		std::vector<int> &assignments,
+		std::vector<std::vector<double>> &centroids) const
+{
+	// Initial centroids are k distinct intervals chosen randomly
+	int n = vectors.size();
+	std::vector<int> indexes(n);
+	for (int i = 0; i < n; i++)
+		indexes[i] = i;
+	std::mt19937 generator(seed);
+	std::shuffle(indexes.begin(), indexes.end(), generator);
+	centroids.clear();
+	for (int i = 0; i < k; i++)
+		centroids.push_back(vectors[indexes[i]]);
+
+	// Iterate
+	assignments.assign(n, -1);
+	double distortion = 0.0;
+	for (int iteration = 0; iteration < max_iterations; iteration++)
+	{
+		// Assign each vector to its closest centroid
+		bool changed = false;
+		distortion = 0.0;
+		for (int i = 0; i < n; i++)
+		{
+			int best = 0;
+			double best_distance = getDistance(vectors[i],
+					centroids[0]);
+			for (int j = 1; j < k; j++)
+			{
+				double distance = getDistance(vectors[i],
+						centroids[j]);
+				if (distance < best_distance)
+				{
+					best = j;
+					best_distance = distance;
+				}
+			}
+			if (assignments[i] != best)
+				changed = true;
+			assignments[i] = best;
+			distortion += best_distance;
+		}
+
+		// Converged
+		if (!changed)
+			break;
+
+		// Recompute centroids
+		std::vector<int> sizes(k, 0);
+		for (auto &centroid : centroids)
+			centroid.assign(num_dimensions, 0.0);
+		for (int i = 0; i < n; i++)
+		{
+			sizes[assignments[i]]++;
+			for (int d = 0; d < num_dimensions; d++)
+				centroids[assignments[i]][d] += vectors[i][d];
+		}
+
+		// Average non-empty clusters
+		for (int j = 0; j < k; j++)
+			if (sizes[j])
+				for (int d = 0; d < num_dimensions; d++)
+					centroids[j][d] /= sizes[j];
+
+		// Each empty cluster takes the vector furthest from its
+		// centroid. Distances are measured once all centroids are
+		// averaged, and a vector is not taken by two clusters.
+		std::vector<bool> taken(n, false);
+		for (int j = 0; j < k; j++)
+		{
+			if (sizes[j])
+				continue;
+			int furthest = -1;
+			double furthest_distance = -1.0;
+			for (int i = 0; i < n; i++)
+			{
+				if (taken[i] || !sizes[assignments[i]])
+					continue;
+				double distance = getDistance(vectors[i],
+						centroids[assignments[i]]);
+				if (distance > furthest_distance)
+				{
+					furthest = i;
+					furthest_distance = distance;
+				}
+			}
+			if (furthest < 0)
+				continue;
+			taken[furthest] = true;
+			centroids[j] = vectors[furthest];
+		}
+	}
+
+	// Return sum of squared distances
+	return distortion;
+}
+
+
+double SimPoint::getBic(int k, const std::vector<int> &assignments,
+		double distortion) const
+{
+	// Maximum likelihood estimate of the variance, assuming identical
+	// spherical Gaussians for all clusters.
+	int n = vectors.size();
+	double variance = n > k ? distortion / (n - k) : 0.0;
+	variance = std::max(variance, 1e-12);
+
+	// Cluster sizes
+	std::vector<int> sizes(k, 0);
+	for (int i = 0; i < n; i++)
+		sizes[assignments[i]]++;
+
+	// Log-likelihood of the data
+	double likelihood = 0.0;
+	for (int j = 0; j < k; j++)
+	{
+		double size = sizes[j];
+		if (!size)
+			continue;
+		likelihood += size * std::log(size)
+				- size * std::log((double) n)
+				- size / 2.0 * std::log(2.0 * M_PI)
+				- size * num_dimensions / 2.0 * std::log(variance)
+				- (size - k) / 2.0;
+	}
+
+	// Penalty for the number of free parameters
+	double num_parameters = (k - 1) + num_dimensions * k + 1;
+	return likelihood - num_parameters / 2.0 * std::log((double) n);
+}
+
+
+void SimPoint::Cluster(int max_k)
+{
+	// Check arguments
+	int n = vectors.size();
+	if (!n)
+		throw Error("No basic block vectors");
+	if (max_k < 1)
+		throw Error(misc::fmt("Invalid maximum number of clusters "
+				"(%d)", max_k));
+	max_k = std::min(max_k, n);
+
+	// Best clustering for every value of k
+	std::vector<std::vector<int>> all_assignments(max_k + 1);
+	std::vector<std::vector<std::vector<double>>> all_centroids(max_k + 1);
+	std::vector<double> scores(max_k + 1);
+	for (int k = 1; k <= max_k; k++)
+	{
+		double best_distortion = std::numeric_limits<double>::max();
+		for (int seed = 0; seed < num_seeds; seed++)
+		{
+			std::vector<int> assignments;
+			std::vector<std::vector<double>> centroids;
+			double distortion = KMeans(k, seed + 1, assignments,
+					centroids);
+			if (distortion < best_distortion)
+			{
+				best_distortion = distortion;
+				all_assignments[k] = assignments;
+				all_centroids[k] = centroids;
+			}
+		}
+		scores[k] = getBic(k, all_assignments[k], best_distortion);
+	}
+
+	// Choose the smallest k whose score is within the threshold
+	double min_score = *std::min_element(scores.begin() + 1, scores.end());
+	double max_score = *std::max_element(scores.begin() + 1, scores.end());
+	double threshold = min_score + bic_threshold * (max_score - min_score);
+	num_clusters = max_k;
+	for (int k = 1; k <= max_k; k++)
+	{
+		if (scores[k] >= threshold)
+		{
+			num_clusters = k;
+			break;
+		}
+	}
+
+	// The interval closest to each centroid is the simulation point
+	const std::vector<int> &assignments = all_assignments[num_clusters];
+	const std::vector<std::vector<double>> &centroids =
+			all_centroids[num_clusters];
+	points.clear();
+	for (int j = 0; j < num_clusters; j++)
+	{
+		int closest = -1;
+		double closest_distance = 0.0;
+		long long cluster_instructions = 0;
+		for (int i = 0; i < n; i++)
+		{
+			if (assignments[i] != j)
+				continue;
+			cluster_instructions += lengths[i];
+			double distance = getDistance(vectors[i], centroids[j]);
+			if (closest < 0 || distance < closest_distance)
+			{
+				closest = i;
+				closest_distance = distance;
+			}
+		}
+
+		// Empty cluster
+		if (closest < 0)
+			continue;
+
+		// Add point
+		points.push_back({ closest, starts[closest], lengths[closest],
+				(double) cluster_instructions / num_instructions });
+	}
+
+	// Sort by position
+	std::sort(points.begin(), points.end(),
+			[](const Point &a, const Point &b)
+			{
+				return a.start < b.start;
+			});
+}
+
+
+void SimPoint::Dump(std::ostream &os) const
+{
+	os << "[ SimPoints ]\n";
+	os << misc::fmt("Instructions = %lld\n", num_instructions);
+	os << misc::fmt("Intervals = %d\n", getNumIntervals());
+	os << misc::fmt("Clusters = %d\n", num_clusters);
+	os << misc::fmt("Points = %d\n", (int) points.size());
+	os << '\n';
+	for (unsigned i = 0; i < points.size(); i++)
+	{
+		const Point &point = points[i];
+		os << misc::fmt("[ SimPoint %d ]\n", i);
+		os << misc::fmt("Interval = %d\n", point.interval);
+		os << misc::fmt("Start = %lld\n", point.start);
+		os << misc::fmt("Length = %lld\n", point.length);
+		os << misc::fmt("Weight = %.6f\n", point.weight);
+		os << '\n';
+	}
+}
+
+}  // namespace x86
@@ -0,0 +1,158 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef ARCH_X86_EMULATOR_SIMPOINT_H
+#define ARCH_X86_EMULATOR_SIMPOINT_H
+
+#include <iostream>
+#include <vector>
+
+#include <lib/cpp/Error.h>
+
+
+namespace x86
+{
+
+/// Selection of simulation points from basic block vectors. Vectors are
+/// read from a file produced by the basic block vector profiler, normalized,
+/// and reduced to a small number of dimensions with a random linear
+/// projection. The intervals are then clustered with k-means for a range of
+/// values of k, and the smallest clustering whose Bayesian Information
+/// Criterion (BIC) score is close enough to the best score is chosen. The
+/// interval closest to the centroid of each cluster is its simulation
+/// point, weighted by the fraction of instructions that the cluster covers.
+class SimPoint
+{
+public:
+
+	/// Exception for the simulation point selection
+	class Error : public misc::Error
+	{
+	public:
+
+		Error(const std::string &message) : misc::Error(message)
+		{
+			AppendPrefix("x86 SimPoint");
+		}
+	};
+
+	/// One simulation point
+	struct Point
+	{
+		// Index of the interval
+		int interval;
+
+		// Position of the first instruction of the interval in the
+		// dynamic instruction stream
+		long long start;
+
+		// Number of instructions in the interval
+		long long length;
+
+		// Fraction of the execution represented by this point
+		double weight;
+	};
+
+	/// Number of dimensions of the projected vectors
+	static const int num_dimensions = 15;
+
+	/// Number of random initializations tried for each value of k
+	static const int num_seeds = 5;
+
+	/// Maximum number of iterations of the k-means algorithm
+	static const int max_iterations = 100;
+
+	/// Fraction of the range of BIC scores that the chosen clustering must
+	/// reach, measured from the lowest score.
+	static constexpr double bic_threshold = 0.9;
+
+private:
+
+	// Projected vectors, one per interval
+	std::vector<std::vector<double>> vectors;
+
+	// Position and length of each interval, in instructions
+	std::vector<long long> starts;
+	std::vector<long long> lengths;
+
+	// Total number of instructions
+	long long num_instructions = 0;
+
+	// Number of clusters chosen
+	int num_clusters = 0;
+
+	// Selected simulation points, sorted by position
+	std::vector<Point> points;
+
+	// Return the value of the projection matrix for a block identifier
+	// and a dimension. The matrix is not stored; its values are obtained
+	// from a hash function with values uniformly distributed in [-1, 1].
+	static double getProjection(int block_id, int dimension);
+
+	// Return the squared Euclidean distance between two vectors
+	static double getDistance(const std::vector<double> &a,
+			const std::vector<double> &b);
+
+	// Run k-means with the given number of clusters and random seed.
+	// Cluster assignments and centroids are returned in the last two
+	// arguments. The function returns the sum of squared distances from
+	// each vector to its centroid.
+	double KMeans(int k, unsigned seed,
+			std::vector<int> &assignments,
+			std::vector<std::vector<double>> &centroids) const;
+
+	// Return the BIC score of a clustering
+	double getBic(int k, const std::vector<int> &assignments,
+			double distortion) const;
+
+public:
+
+	/// Read basic block vectors from a file in SimPoint format
+	void Read(const std::string &path);
+
+	/// Read basic block vectors from an input stream in SimPoint format
+	void Read(std::istream &is);
+
+	/// Cluster the intervals and select simulation points.
+	///
+	/// \param max_k
+	///	Maximum number of clusters.
+	///
+	void Cluster(int max_k);
+
+	/// Return the number of intervals
+	int getNumIntervals() const { return vectors.size(); }
+
+	/// Return the total number of instructions of all intervals
+	long long getNumInstructions() const { return num_instructions; }
+
+	/// Return the number of clusters chosen
+	int getNumClusters() const { return num_clusters; }
+
+	/// Return the selected simulation points, sorted by position
+	const std::vector<Point> &getPoints() const { return points; }
+
+	/// Dump the simulation points in the INI format read by the x86
+	/// timing simulator.
+	void Dump(std::ostream &os = std::cout) const;
+};
+
+}  // namespace x86
+
+#endif
@@ -17,7 +17,12 @@
  *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <cmath>
+#include <cstdlib>
+
+#include <arch/x86/emulator/BranchTrace.h>
 #include <lib/cpp/Misc.h>
+#include <lib/cpp/String.h>
 
 #include "BranchPredictor.h"
 #include "Uop.h"
@@ -35,6 +40,24 @@ int BranchPredictor::two_level_l1_size;
 int BranchPredictor::two_level_l2_size;
 int BranchPredictor::two_level_history_size;
 int BranchPredictor::two_level_l2_height;
+int BranchPredictor::tage_num_tables;
+int BranchPredictor::tage_table_size;
+int BranchPredictor::tage_tag_bits;
+int BranchPredictor::tage_min_history;
+int BranchPredictor::tage_max_history;
+int BranchPredictor::perceptron_num_tables;
+int BranchPredictor::perceptron_table_size;
+int BranchPredictor::perceptron_history_size;
+BranchPredictor::IndirectKind BranchPredictor::indirect_kind;
+int BranchPredictor::ittage_num_tables;
+int BranchPredictor::ittage_table_size;
+int BranchPredictor::ittage_tag_bits;
+int BranchPredictor::ittage_min_history;
+int BranchPredictor::ittage_max_history;
+
+const int BranchPredictor::MaxTables;
+const int BranchPredictor::MaxHistorySize;
+const int BranchPredictor::HistoryBufferSize;
 
 misc::StringMap BranchPredictor::KindMap =
 {
@@ -43,9 +66,33 @@ misc::StringMap BranchPredictor::KindMap =
 	{"NotTaken", KindNottaken},
 	{"Bimodal", KindBimod},
 	{"TwoLevel", KindTwoLevel},
-	{"Combined", KindCombined}
+	{"Combined", KindCombined},
+	{"TAGE", KindTage},
+	{"Perceptron", KindPerceptron}
+};
+
+misc::StringMap BranchPredictor::IndirectKindMap =
+{
+	{"BTB", IndirectKindBtb},
+	{"ITTAGE", IndirectKindIttage}
 };
 
+
+// Number of TAGE updates after which useful counters are aged
+static const int tage_useful_reset_period = 1 << 18;
+
+
+// Return the global history length of a table of the TAGE or ITTAGE
+// predictors, following a geometric series between 'min' and 'max'.
+static int getGeometricHistoryLength(int table, int num_tables, int min, int max)
+{
+	if (num_tables == 1)
+		return min;
+	return (int) (min * pow((double) max / min,
+			(double) table / (num_tables - 1)) + 0.5);
+}
+
+
 BranchPredictor::BranchPredictor(const std::string &name)
 	:
 	name(name)
@@ -53,8 +100,8 @@ BranchPredictor::BranchPredictor(const std::string &name)
 	// Initialize
 	ras = misc::new_unique_array<int>(ras_size);
 	
-	// Bimodal predictor
-	if (kind == KindBimod || kind == KindCombined)
+	// Bimodal predictor, also used as the base predictor of TAGE
+	if (kind == KindBimod || kind == KindCombined || kind == KindTage)
 	{
 		bimod = misc::new_unique_array<char>(bimod_size);
 		for (int i = 0; i < bimod_size; i++)
@@ -78,6 +125,59 @@ BranchPredictor::BranchPredictor(const std::string &name)
 			choice[i] = 2;
 	}
 
+	// Global history
+	if (kind == KindTage || kind == KindPerceptron ||
+			indirect_kind == IndirectKindIttage)
+		history = misc::new_unique_array<char>(HistoryBufferSize);
+
+	// TAGE predictor
+	if (kind == KindTage)
+	{
+		tage_tables = misc::new_unique_array<TageEntry>(
+				tage_num_tables * tage_table_size);
+		for (int i = 0; i < tage_num_tables; i++)
+		{
+			int length = getGeometricHistoryLength(i, tage_num_tables,
+					tage_min_history, tage_max_history);
+			tage_history_length[i] = length;
+			tage_index_history[i].length = length;
+			tage_index_history[i].folded_length =
+					misc::LogBase2(tage_table_size);
+			tage_tag_history[0][i].length = length;
+			tage_tag_history[0][i].folded_length = tage_tag_bits;
+			tage_tag_history[1][i].length = length;
+			tage_tag_history[1][i].folded_length = tage_tag_bits - 1;
+		}
+	}
+
+	// Perceptron predictor
+	if (kind == KindPerceptron)
+	{
+		perceptron_weights = misc::new_unique_array<signed char>(
+				perceptron_num_tables * perceptron_table_size);
+		perceptron_threshold = (int) (1.93 * perceptron_num_tables + 14);
+	}
+
+	// ITTAGE predictor
+	if (indirect_kind == IndirectKindIttage)
+	{
+		ittage_tables = misc::new_unique_array<IttageEntry>(
+				ittage_num_tables * ittage_table_size);
+		for (int i = 0; i < ittage_num_tables; i++)
+		{
+			int length = getGeometricHistoryLength(i, ittage_num_tables,
+					ittage_min_history, ittage_max_history);
+			ittage_history_length[i] = length;
+			ittage_index_history[i].length = length;
+			ittage_index_history[i].folded_length =
+					misc::LogBase2(ittage_table_size);
+			ittage_tag_history[0][i].length = length;
+			ittage_tag_history[0][i].folded_length = ittage_tag_bits;
+			ittage_tag_history[1][i].length = length;
+			ittage_tag_history[1][i].folded_length = ittage_tag_bits - 1;
+		}
+	}
+
 	// Allocate BTB and assign LRU counters
 	btb = misc::new_unique_array<BtbEntry>(btb_num_sets * btb_num_ways);
 	for (int i = 0; i < btb_num_sets; i++)
@@ -108,6 +208,27 @@ void BranchPredictor::ParseConfiguration(misc::IniFile *ini_file)
 	// Two-level branch predictor parameter
 	two_level_l2_height = 1 << two_level_history_size;
 
+	// TAGE predictor parameters
+	tage_num_tables = ini_file->ReadInt(section, "TAGE.NumTables", 7);
+	tage_table_size = ini_file->ReadInt(section, "TAGE.TableSize", 1024);
+	tage_tag_bits = ini_file->ReadInt(section, "TAGE.TagBits", 10);
+	tage_min_history = ini_file->ReadInt(section, "TAGE.MinHistory", 5);
+	tage_max_history = ini_file->ReadInt(section, "TAGE.MaxHistory", 130);
+
+	// Perceptron predictor parameters
+	perceptron_num_tables = ini_file->ReadInt(section, "Perceptron.NumTables", 8);
+	perceptron_table_size = ini_file->ReadInt(section, "Perceptron.TableSize", 1024);
+	perceptron_history_size = ini_file->ReadInt(section, "Perceptron.HistorySize", 56);
+
+	// Indirect target predictor parameters
+	indirect_kind = (IndirectKind) ini_file->ReadEnum(section, "Indirect",
+			IndirectKindMap, IndirectKindBtb);
+	ittage_num_tables = ini_file->ReadInt(section, "ITTAGE.NumTables", 4);
+	ittage_table_size = ini_file->ReadInt(section, "ITTAGE.TableSize", 256);
+	ittage_tag_bits = ini_file->ReadInt(section, "ITTAGE.TagBits", 9);
+	ittage_min_history = ini_file->ReadInt(section, "ITTAGE.MinHistory", 4);
+	ittage_max_history = ini_file->ReadInt(section, "ITTAGE.MaxHistory", 64);
+
 	// Integrity
 	if (bimod_size & (bimod_size - 1))
 		throw Error("number of entries in bimodal precitor must be a power of 2");
@@ -123,6 +244,39 @@ void BranchPredictor::ParseConfiguration(misc::IniFile *ini_file)
 		throw Error("two-level predictor sizes must be power of 2");
 	if (two_level_l2_size & (two_level_l2_size - 1))
 		throw Error("two-level predictor sizes must be power of 2");
+	if (tage_num_tables < 1 || tage_num_tables > MaxTables)
+		throw Error(misc::fmt("number of TAGE tables must be >=1 and <=%d",
+				MaxTables));
+	if (tage_table_size < 2 || (tage_table_size & (tage_table_size - 1)))
+		throw Error("TAGE table size must be a power of 2");
+	if (tage_tag_bits < 2 || tage_tag_bits > 16)
+		throw Error("TAGE tag size must be >=2 and <=16 bits");
+	if (tage_min_history < 1 || tage_max_history < tage_min_history ||
+			tage_max_history > MaxHistorySize)
+		throw Error(misc::fmt("TAGE history lengths must be >=1 and <=%d, "
+				"with MinHistory <= MaxHistory", MaxHistorySize));
+	if (perceptron_num_tables < 2 || perceptron_num_tables > MaxTables)
+		throw Error(misc::fmt("number of perceptron tables must be >=2 "
+				"and <=%d", MaxTables));
+	if (perceptron_table_size < 2 ||
+			(perceptron_table_size & (perceptron_table_size - 1)))
+		throw Error("perceptron table size must be a power of 2");
+	if (perceptron_history_size < perceptron_num_tables - 1 ||
+			perceptron_history_size > MaxHistorySize)
+		throw Error(misc::fmt("perceptron history size must be at least "
+				"the number of tables minus 1, and <=%d",
+				MaxHistorySize));
+	if (ittage_num_tables < 1 || ittage_num_tables > MaxTables)
+		throw Error(misc::fmt("number of ITTAGE tables must be >=1 and <=%d",
+				MaxTables));
+	if (ittage_table_size < 2 || (ittage_table_size & (ittage_table_size - 1)))
+		throw Error("ITTAGE table size must be a power of 2");
+	if (ittage_tag_bits < 2 || ittage_tag_bits > 16)
+		throw Error("ITTAGE tag size must be >=2 and <=16 bits");
+	if (ittage_min_history < 1 || ittage_max_history < ittage_min_history ||
+			ittage_max_history > MaxHistorySize)
+		throw Error(misc::fmt("ITTAGE history lengths must be >=1 and <=%d, "
+				"with MinHistory <= MaxHistory", MaxHistorySize));
 }
 
 
@@ -141,6 +295,377 @@ void BranchPredictor::DumpConfiguration(std::ostream &os)
 }
 
 
+unsigned BranchPredictor::getRandom()
+{
+	// Xorshift generator, deterministic across runs
+	random_state ^= random_state << 13;
+	random_state ^= random_state >> 17;
+	random_state ^= random_state << 5;
+	return random_state;
+}
+
+
+bool BranchPredictor::isIndirect(Uop *uop)
+{
+	// Only jumps and calls can be indirect
+	Uinst *uinst = uop->getUinst();
+	if (uinst->getOpcode() != Uinst::OpcodeJump &&
+			uinst->getOpcode() != Uinst::OpcodeCall)
+		return false;
+
+	// Indirect jumps and calls read their target from a register or memory
+	for (int i = 0; i < Uinst::MaxIDeps; i++)
+		if (uinst->getIDep(i) != Uinst::DepNone)
+			return true;
+	return false;
+}
+
+
+void BranchPredictor::UpdateHistory(bool taken)
+{
+	// Shift outcome in
+	history_head = (history_head + HistoryBufferSize - 1) &
+			(HistoryBufferSize - 1);
+	history[history_head] = taken;
+
+	// Update folded histories of the TAGE tables
+	if (tage_tables)
+	{
+		for (int i = 0; i < tage_num_tables; i++)
+		{
+			bool old_bit = getHistoryBit(tage_history_length[i]);
+			tage_index_history[i].Update(taken, old_bit);
+			tage_tag_history[0][i].Update(taken, old_bit);
+			tage_tag_history[1][i].Update(taken, old_bit);
+		}
+	}
+
+	// Update folded histories of the ITTAGE tables
+	if (ittage_tables)
+	{
+		for (int i = 0; i < ittage_num_tables; i++)
+		{
+			bool old_bit = getHistoryBit(ittage_history_length[i]);
+			ittage_index_history[i].Update(taken, old_bit);
+			ittage_tag_history[0][i].Update(taken, old_bit);
+			ittage_tag_history[1][i].Update(taken, old_bit);
+		}
+	}
+}
+
+
+void BranchPredictor::LookupTage(Uop *uop)
+{
+	// Base prediction from the bimodal table
+	int bimod_index = uop->eip & (bimod_size - 1);
+	uop->bimod_index = bimod_index;
+	uop->bimod_prediction = bimod[bimod_index] > 1 ?
+			PredictionTaken :
+			PredictionNotTaken;
+
+	// Compute indexes and tags of all tagged tables
+	int log_size = misc::LogBase2(tage_table_size);
+	unsigned tag_mask = (1u << tage_tag_bits) - 1;
+	for (int i = 0; i < tage_num_tables; i++)
+	{
+		uop->predictor_index[i] = (uop->eip ^
+				(uop->eip >> (std::abs(log_size - i) + 1)) ^
+				tage_index_history[i].value) &
+				(tage_table_size - 1);
+		uop->predictor_tag[i] = (uop->eip ^
+				tage_tag_history[0][i].value ^
+				(tage_tag_history[1][i].value << 1)) & tag_mask;
+	}
+
+	// Find the two matching tables with the longest histories
+	uop->predictor_provider = -1;
+	uop->tage_alt_provider = -1;
+	for (int i = tage_num_tables - 1; i >= 0; i--)
+	{
+		TageEntry &entry = tage_tables[i * tage_table_size +
+				uop->predictor_index[i]];
+		if (entry.tag != uop->predictor_tag[i])
+			continue;
+		if (uop->predictor_provider < 0)
+		{
+			uop->predictor_provider = i;
+			continue;
+		}
+		uop->tage_alt_provider = i;
+		break;
+	}
+
+	// Alternate prediction
+	if (uop->tage_alt_provider >= 0)
+	{
+		TageEntry &entry = tage_tables[uop->tage_alt_provider *
+				tage_table_size + uop->predictor_index[
+				uop->tage_alt_provider]];
+		uop->tage_alt_prediction = entry.counter >= 0 ?
+				PredictionTaken : PredictionNotTaken;
+	}
+	else
+	{
+		uop->tage_alt_prediction = uop->bimod_prediction;
+	}
+
+	// No matching table, use the alternate prediction
+	if (uop->predictor_provider < 0)
+	{
+		uop->prediction = uop->tage_alt_prediction;
+		return;
+	}
+
+	// Provider prediction
+	TageEntry &entry = tage_tables[uop->predictor_provider *
+			tage_table_size + uop->predictor_index[
+			uop->predictor_provider]];
+	uop->tage_provider_prediction = entry.counter >= 0 ?
+			PredictionTaken : PredictionNotTaken;
+
+	// Newly allocated entries have a weak counter and are not useful yet.
+	// The alternate prediction is often more accurate for them.
+	bool weak = entry.counter == 0 || entry.counter == -1;
+	if (weak && !entry.useful && tage_use_alt_on_new_alloc >= 0)
+		uop->prediction = uop->tage_alt_prediction;
+	else
+		uop->prediction = uop->tage_provider_prediction;
+}
+
+
+void BranchPredictor::UpdateTage(Uop *uop, bool taken)
+{
+	// Outcome
+	Prediction outcome = taken ? PredictionTaken : PredictionNotTaken;
+	int provider = uop->predictor_provider;
+
+	// On a misprediction, allocate an entry in a table with a longer
+	// history than the provider, starting at one of the next two tables.
+	if (uop->prediction != outcome && provider < tage_num_tables - 1)
+	{
+		int start = provider + 1;
+		if (start < tage_num_tables - 1 && (getRandom() & 1))
+			start++;
+		bool allocated = false;
+		for (int i = start; i < tage_num_tables; i++)
+		{
+			TageEntry &entry = tage_tables[i * tage_table_size +
+					uop->predictor_index[i]];
+			if (entry.useful)
+				continue;
+			entry.tag = uop->predictor_tag[i];
+			entry.counter = taken ? 0 : -1;
+			allocated = true;
+			break;
+		}
+
+		// Make room for future allocations
+		if (!allocated)
+		{
+			for (int i = provider + 1; i < tage_num_tables; i++)
+			{
+				TageEntry &entry = tage_tables[i * tage_table_size +
+						uop->predictor_index[i]];
+				if (entry.useful)
+					entry.useful--;
+			}
+		}
+	}
+
+	// Update the provider entry
+	if (provider >= 0)
+	{
+		TageEntry &entry = tage_tables[provider * tage_table_size +
+				uop->predictor_index[provider]];
+
+		// Learn whether to trust newly allocated entries
+		bool weak = entry.counter == 0 || entry.counter == -1;
+		if (weak && !entry.useful && uop->tage_provider_prediction !=
+				uop->tage_alt_prediction)
+		{
+			if (uop->tage_alt_prediction == outcome)
+				tage_use_alt_on_new_alloc = std::min(
+						tage_use_alt_on_new_alloc + 1, 7);
+			else
+				tage_use_alt_on_new_alloc = std::max(
+						tage_use_alt_on_new_alloc - 1, -8);
+		}
+
+		// Prediction counter
+		if (taken && entry.counter < 3)
+			entry.counter++;
+		else if (!taken && entry.counter > -4)
+			entry.counter--;
+
+		// Useful counter, updated when the alternate prediction differs
+		if (uop->tage_provider_prediction != uop->tage_alt_prediction)
+		{
+			if (uop->tage_provider_prediction == outcome)
+			{
+				if (entry.useful < 3)
+					entry.useful++;
+			}
+			else if (entry.useful)
+			{
+				entry.useful--;
+			}
+		}
+	}
+	else
+	{
+		// Base bimodal predictor
+		char *bimod_ptr = &bimod[uop->bimod_index];
+		if (taken)
+			*bimod_ptr = *bimod_ptr + 1 > 3 ? 3 : *bimod_ptr + 1;
+		else
+			*bimod_ptr = *bimod_ptr - 1 < 0 ? 0 : *bimod_ptr - 1;
+	}
+
+	// Age useful counters periodically
+	if (++tage_num_updates % tage_useful_reset_period == 0)
+		for (int i = 0; i < tage_num_tables * tage_table_size; i++)
+			tage_tables[i].useful >>= 1;
+}
+
+
+void BranchPredictor::LookupPerceptron(Uop *uop)
+{
+	// Table 0 holds bias weights indexed by the branch address. The rest
+	// of tables are indexed by the address hashed with consecutive
+	// segments of the global history.
+	int log_size = misc::LogBase2(perceptron_table_size);
+	int segment_size = perceptron_history_size / (perceptron_num_tables - 1);
+	int output = 0;
+	for (int i = 0; i < perceptron_num_tables; i++)
+	{
+		// Fold history segment
+		unsigned hash = uop->eip ^ (uop->eip >> log_size);
+		int shift = 0;
+		for (int bit = (i - 1) * segment_size; i && bit < i * segment_size;
+				bit++)
+		{
+			hash ^= (unsigned) getHistoryBit(bit) << shift;
+			if (++shift == log_size)
+				shift = 0;
+		}
+
+		// Accumulate weight
+		int index = hash & (perceptron_table_size - 1);
+		uop->predictor_index[i] = index;
+		output += perceptron_weights[i * perceptron_table_size + index];
+	}
+
+	// Predict
+	uop->perceptron_output = output;
+	uop->prediction = output >= 0 ? PredictionTaken : PredictionNotTaken;
+}
+
+
+void BranchPredictor::UpdatePerceptron(Uop *uop, bool taken)
+{
+	// Train only on mispredictions or when the output is below threshold
+	bool predicted_taken = uop->perceptron_output >= 0;
+	if (predicted_taken == taken &&
+			std::abs(uop->perceptron_output) > perceptron_threshold)
+		return;
+
+	// Update weights
+	for (int i = 0; i < perceptron_num_tables; i++)
+	{
+		signed char &weight = perceptron_weights[i * perceptron_table_size +
+				uop->predictor_index[i]];
+		if (taken && weight < 127)
+			weight++;
+		else if (!taken && weight > -127)
+			weight--;
+	}
+}
+
+
+unsigned BranchPredictor::LookupIttage(Uop *uop)
+{
+	// Compute indexes and tags of all tagged tables
+	int log_size = misc::LogBase2(ittage_table_size);
+	unsigned tag_mask = (1u << ittage_tag_bits) - 1;
+	for (int i = 0; i < ittage_num_tables; i++)
+	{
+		uop->predictor_index[i] = (uop->eip ^
+				(uop->eip >> (std::abs(log_size - i) + 1)) ^
+				ittage_index_history[i].value) &
+				(ittage_table_size - 1);
+		uop->predictor_tag[i] = (uop->eip ^
+				ittage_tag_history[0][i].value ^
+				(ittage_tag_history[1][i].value << 1)) & tag_mask;
+	}
+	uop->ittage_lookup = true;
+
+	// Find the matching table with the longest history
+	uop->predictor_provider = -1;
+	for (int i = ittage_num_tables - 1; i >= 0; i--)
+	{
+		IttageEntry &entry = ittage_tables[i * ittage_table_size +
+				uop->predictor_index[i]];
+		if (entry.tag == uop->predictor_tag[i] && entry.target)
+		{
+			uop->predictor_provider = i;
+			return entry.target;
+		}
+	}
+
+	// No matching entry
+	return 0;
+}
+
+
+void BranchPredictor::UpdateIttage(Uop *uop)
+{
+	// Update the provider entry
+	int provider = uop->predictor_provider;
+	bool mispredicted = true;
+	if (provider >= 0)
+	{
+		IttageEntry &entry = ittage_tables[provider * ittage_table_size +
+				uop->predictor_index[provider]];
+		if (entry.target == uop->neip)
+		{
+			mispredicted = false;
+			entry.useful = 1;
+			if (entry.confidence < 3)
+				entry.confidence++;
+		}
+		else if (entry.confidence)
+		{
+			entry.confidence--;
+		}
+		else
+		{
+			entry.target = uop->neip;
+			entry.useful = 0;
+		}
+	}
+
+	// On a misprediction, allocate an entry in a longer-history table
+	if (!mispredicted)
+		return;
+	for (int i = provider + 1; i < ittage_num_tables; i++)
+	{
+		IttageEntry &entry = ittage_tables[i * ittage_table_size +
+				uop->predictor_index[i]];
+		if (entry.useful)
+			continue;
+		entry.tag = uop->predictor_tag[i];
+		entry.target = uop->neip;
+		entry.confidence = 0;
+		return;
+	}
+
+	// Make room for future allocations
+	for (int i = provider + 1; i < ittage_num_tables; i++)
+		ittage_tables[i * ittage_table_size +
+				uop->predictor_index[i]].useful = 0;
+}
+
+
 BranchPredictor::Prediction BranchPredictor::Lookup(Uop *uop)
 {
 	// Local variable
@@ -222,6 +747,21 @@ BranchPredictor::Prediction BranchPredictor::Lookup(Uop *uop)
 		uop->prediction = choice_prediction;
 	}
 
+	// TAGE
+	if (kind == KindTage)
+		LookupTage(uop);
+
+	// Perceptron
+	if (kind == KindPerceptron)
+		LookupPerceptron(uop);
+
+	// Shift the outcome into the global history. Instructions are emulated
+	// at fetch, so the outcome of non-speculative branches is already
+	// known. This models a history updated with the predicted outcome and
+	// repaired after mispredictions.
+	if (history && !uop->speculative_mode)
+		UpdateHistory(uop->neip != uop->eip + uop->mop_size);
+
 	// Return prediction
 	assert(uop->prediction == PredictionTaken || uop->prediction == PredictionNotTaken);
 	return uop->prediction;
@@ -259,6 +799,39 @@ int BranchPredictor::LookupMultiple(unsigned int eip, int count)
 
 
 void BranchPredictor::Update(Uop *uop)
+{
+	assert(!uop->speculative_mode);
+	assert(uop->getFlags() & Uinst::FlagCtrl);
+
+	// Stats
+	accesses++;
+	if (uop->neip == uop->predicted_neip)
+		hits++;
+
+	// Update tables
+	UpdateTables(uop);
+}
+
+
+void BranchPredictor::Train(Uop *uop)
+{
+	// Only non-speculative control uops train the predictor
+	assert(!uop->speculative_mode);
+	assert(uop->getFlags() & Uinst::FlagCtrl);
+
+	// Read the predictor and the BTB as the fetch stage would do. This
+	// populates the table indexes in the uop and pushes or pops the RAS
+	// for calls and returns.
+	Lookup(uop);
+	LookupBtb(uop);
+
+	// Update as the commit stage would do, without recording statistics
+	UpdateTables(uop);
+	UpdateBtb(uop);
+}
+
+
+void BranchPredictor::UpdateTables(Uop *uop)
 {
 	// Taken/NotTaken flag
 	bool taken;
@@ -275,15 +848,8 @@ void BranchPredictor::Update(Uop *uop)
 	// pointer to combined branch prediction table
 	char *choice_ptr;
 
-	assert(!uop->speculative_mode);
-	assert(uop->getFlags() & Uinst::FlagCtrl);
 	taken = uop->neip != uop->eip + uop->mop_size;
 
-	// Stats
-	accesses++;
-	if (uop->neip == uop->predicted_neip)
-		hits++;
-
 	// Update predictors. This is only done for conditional branches. Thus,
 	// exit now if instruction is a call, ret, or jmp.
 	// No update is performed in a perfect branch predictor either.
@@ -292,6 +858,18 @@ void BranchPredictor::Update(Uop *uop)
 	if (uop->getFlags() & Uinst::FlagUncond)
 		return;
 
+	// TAGE and perceptron predictors. Internal branches did not read them.
+	if (kind == KindTage || kind == KindPerceptron)
+	{
+		if (uop->getUinst()->getOpcode() == Uinst::OpcodeIbranch)
+			return;
+		if (kind == KindTage)
+			UpdateTage(uop, taken);
+		else
+			UpdatePerceptron(uop, taken);
+		return;
+	}
+
 	// Bimodal predictor was used
 	if (kind == KindBimod ||
 			(kind == KindCombined && uop->choice_prediction == PredictionNotTaken))
@@ -382,6 +960,16 @@ unsigned int BranchPredictor::LookupBtb(Uop *uop)
 		target = ras[ras_index];
 	}
 
+	// Indirect jumps and calls take their target from the ITTAGE predictor
+	// when one of its entries matches, instead of the last target recorded
+	// in the BTB.
+	if (indirect_kind == IndirectKindIttage && isIndirect(uop))
+	{
+		unsigned ittage_target = LookupIttage(uop);
+		if (hit && ittage_target)
+			target = ittage_target;
+	}
+
 	// Return
 	return target;
 }
@@ -398,6 +986,10 @@ void BranchPredictor::UpdateBtb(Uop *uop)
 	if (kind == KindPerfect)
 		return;
 
+	// Indirect target predictor
+	if (uop->ittage_lookup)
+		UpdateIttage(uop);
+
 	// Search address in BTB
 	int set = uop->eip & (btb_num_sets - 1);
 	for (int way = 0; way < btb_num_ways; way++)
@@ -441,6 +1033,82 @@ void BranchPredictor::UpdateBtb(Uop *uop)
 }
 
 
+void BranchPredictor::Evaluate(std::istream &is, std::ostream &os)
+{
+	// Micro-instruction modeling each kind of control instruction.
+	// Indirect jumps and calls read their target from a register.
+	const int num_kinds = BranchTrace::KindRet + 1;
+	std::shared_ptr<Uinst> uinsts[num_kinds];
+	uinsts[BranchTrace::KindBranch] = std::make_shared<Uinst>(Uinst::OpcodeBranch);
+	uinsts[BranchTrace::KindJump] = std::make_shared<Uinst>(Uinst::OpcodeJump);
+	uinsts[BranchTrace::KindIndirectJump] = std::make_shared<Uinst>(Uinst::OpcodeJump);
+	uinsts[BranchTrace::KindIndirectJump]->setIDep(0, Uinst::DepEax);
+	uinsts[BranchTrace::KindCall] = std::make_shared<Uinst>(Uinst::OpcodeCall);
+	uinsts[BranchTrace::KindIndirectCall] = std::make_shared<Uinst>(Uinst::OpcodeCall);
+	uinsts[BranchTrace::KindIndirectCall]->setIDep(0, Uinst::DepEax);
+	uinsts[BranchTrace::KindRet] = std::make_shared<Uinst>(Uinst::OpcodeRet);
+
+	// Run trace
+	long long num_instructions = 0;
+	long long num_branches[num_kinds] = {};
+	long long num_mispredictions[num_kinds] = {};
+	BranchTrace::Entry entry;
+	while (BranchTrace::Read(is, entry))
+	{
+		// Uop for the control instruction
+		Uop uop(nullptr, nullptr, uinsts[entry.kind]);
+		uop.eip = entry.eip;
+		uop.neip = entry.neip;
+		uop.mop_size = entry.size;
+
+		// Fetch stage
+		unsigned target = LookupBtb(&uop);
+		bool taken = Lookup(&uop) == PredictionTaken && target;
+		uop.predicted_neip = taken ? target : entry.eip + entry.size;
+
+		// Commit stage
+		Update(&uop);
+		UpdateBtb(&uop);
+
+		// Statistics
+		num_instructions += entry.num_instructions;
+		num_branches[entry.kind]++;
+		if (uop.predicted_neip != uop.neip)
+			num_mispredictions[entry.kind]++;
+	}
+
+	// Totals
+	long long total_branches = 0;
+	long long total_mispredictions = 0;
+	for (int kind = 1; kind < num_kinds; kind++)
+	{
+		total_branches += num_branches[kind];
+		total_mispredictions += num_mispredictions[kind];
+	}
+
+	// Report
+	os << "[ BranchPredictor ]\n";
+	os << "Kind = " << KindMap[kind] << '\n';
+	os << "Indirect = " << IndirectKindMap[indirect_kind] << '\n';
+	os << "Instructions = " << num_instructions << '\n';
+	os << "Branches = " << total_branches << '\n';
+	os << "Mispredictions = " << total_mispredictions << '\n';
+	os << misc::fmt("Accuracy = %.4g\n", total_branches ?
+			(double) (total_branches - total_mispredictions) /
+			total_branches : 0.0);
+	os << misc::fmt("MPKI = %.4g\n", num_instructions ?
+			(double) total_mispredictions * 1000 / num_instructions :
+			0.0);
+	for (int kind = 1; kind < num_kinds; kind++)
+	{
+		std::string name = BranchTrace::KindMap[kind];
+		os << name << ".Count = " << num_branches[kind] << '\n';
+		os << name << ".Mispredictions = " << num_mispredictions[kind] << '\n';
+	}
+	os << '\n';
+}
+
+
 unsigned int BranchPredictor::getNextBranch(unsigned int eip,
 		unsigned int block_size)
 {
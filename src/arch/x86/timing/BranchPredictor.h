@@ -20,6 +20,7 @@
 #ifndef ARCH_X86_TIMING_BRANCH_PREDICTOR_H
 #define ARCH_X86_TIMING_BRANCH_PREDICTOR_H
 
+#include <iostream>
 #include <string>
 
 #include <arch/x86/emulator/Uinst.h>
@@ -54,12 +55,32 @@ public:
 		KindNottaken,
 		KindBimod,
 		KindTwoLevel,
-		KindCombined
+		KindCombined,
+		KindTage,
+		KindPerceptron
 	};
 
 	/// string map of branch predictor kind
 	static misc::StringMap KindMap;
 
+	/// Predictor used for the targets of indirect jumps and calls
+	enum IndirectKind
+	{
+		IndirectKindInvalid = 0,
+		IndirectKindBtb,
+		IndirectKindIttage
+	};
+
+	/// String map for values of type IndirectKind
+	static misc::StringMap IndirectKindMap;
+
+	/// Maximum number of tables in the TAGE, perceptron, and ITTAGE
+	/// predictors
+	static const int MaxTables = 16;
+
+	/// Maximum length of the global history
+	static const int MaxHistorySize = 1024;
+
 private:
 
 	//
@@ -96,6 +117,45 @@ private:
 	// Height of the level 2 table of the two-level predictor
 	static int two_level_l2_height;
 
+	// Number of tagged tables of the TAGE predictor
+	static int tage_num_tables;
+
+	// Number of entries of each tagged table of the TAGE predictor
+	static int tage_table_size;
+
+	// Number of bits of the tags of the TAGE predictor
+	static int tage_tag_bits;
+
+	// Global history length of the first and last TAGE tagged tables.
+	// The rest of tables use lengths in a geometric series.
+	static int tage_min_history;
+	static int tage_max_history;
+
+	// Number of weight tables of the perceptron predictor
+	static int perceptron_num_tables;
+
+	// Number of weights in each table of the perceptron predictor
+	static int perceptron_table_size;
+
+	// Global history length used by the perceptron predictor
+	static int perceptron_history_size;
+
+	// Predictor for indirect branch targets
+	static IndirectKind indirect_kind;
+
+	// Number of tagged tables of the ITTAGE predictor
+	static int ittage_num_tables;
+
+	// Number of entries of each tagged table of the ITTAGE predictor
+	static int ittage_table_size;
+
+	// Number of bits of the tags of the ITTAGE predictor
+	static int ittage_tag_bits;
+
+	// Global history length of the first and last ITTAGE tables
+	static int ittage_min_history;
+	static int ittage_max_history;
+
 
 
 
@@ -138,10 +198,118 @@ private:
 	//   2,3 - Use two-level adaptive predictor
 	std::unique_ptr<char[]> choice;
 
+	// Global history of conditional branch outcomes, used by the TAGE,
+	// perceptron, and ITTAGE predictors. It is stored as a circular
+	// buffer where the most recent outcome is at index 'history_head'.
+	static const int HistoryBufferSize = 2 * MaxHistorySize;
+	std::unique_ptr<char[]> history;
+	int history_head = 0;
+
+	// Return the outcome of the conditional branch executed 'index'
+	// branches ago, where 0 is the most recent one.
+	bool getHistoryBit(int index) const
+	{
+		return history[(history_head + index) & (HistoryBufferSize - 1)];
+	}
+
+	// Global history folded into a smaller number of bits, updated
+	// incrementally as new outcomes are shifted into the global history.
+	struct FoldedHistory
+	{
+		unsigned value = 0;
+		int length = 0;
+		int folded_length = 0;
+
+		// Shift a new outcome in, and the outcome that just left the
+		// window of 'length' outcomes out.
+		void Update(bool new_bit, bool old_bit)
+		{
+			value = (value << 1) | new_bit;
+			value ^= (unsigned) old_bit << (length % folded_length);
+			value ^= value >> folded_length;
+			value &= (1u << folded_length) - 1;
+		}
+	};
+
+	// Shift the outcome of a conditional branch into the global history
+	void UpdateHistory(bool taken);
+
+	// Entry of a TAGE tagged table
+	struct TageEntry
+	{
+		unsigned short tag = 0;
+		signed char counter = 0;  // 3-bit signed, taken if >= 0
+		unsigned char useful = 0;  // 2-bit
+	};
+
+	// TAGE tagged tables, 'tage_num_tables' tables of 'tage_table_size'
+	// entries each, and the history lengths and folded histories used to
+	// compute their indexes and tags.
+	std::unique_ptr<TageEntry[]> tage_tables;
+	int tage_history_length[MaxTables];
+	FoldedHistory tage_index_history[MaxTables];
+	FoldedHistory tage_tag_history[2][MaxTables];
+
+	// Counter deciding whether to trust newly allocated TAGE entries or
+	// the alternate prediction
+	int tage_use_alt_on_new_alloc = 0;
+
+	// Number of TAGE updates, used to periodically age useful counters
+	long long tage_num_updates = 0;
+
+	// Pseudo-random number generator state used for allocations
+	unsigned random_state = 1;
+
+	// Return a pseudo-random number
+	unsigned getRandom();
+
+	// Lookup and update the TAGE predictor
+	void LookupTage(Uop *uop);
+	void UpdateTage(Uop *uop, bool taken);
+
+	// Perceptron weight tables, 'perceptron_num_tables' tables of
+	// 'perceptron_table_size' signed weights each.
+	std::unique_ptr<signed char[]> perceptron_weights;
+
+	// Training threshold of the perceptron predictor
+	int perceptron_threshold = 0;
+
+	// Lookup and update the perceptron predictor
+	void LookupPerceptron(Uop *uop);
+	void UpdatePerceptron(Uop *uop, bool taken);
+
+	// Entry of an ITTAGE tagged table
+	struct IttageEntry
+	{
+		unsigned short tag = 0;
+		unsigned target = 0;
+		unsigned char confidence = 0;  // 2-bit
+		unsigned char useful = 0;  // 1-bit
+	};
+
+	// ITTAGE tagged tables, and history lengths and folded histories
+	std::unique_ptr<IttageEntry[]> ittage_tables;
+	int ittage_history_length[MaxTables];
+	FoldedHistory ittage_index_history[MaxTables];
+	FoldedHistory ittage_tag_history[2][MaxTables];
+
+	// Lookup and update the ITTAGE predictor. The lookup returns the
+	// predicted target, or 0 if no tagged entry matched.
+	unsigned LookupIttage(Uop *uop);
+	void UpdateIttage(Uop *uop);
+
+	// Return whether a control uop is an indirect jump or call
+	static bool isIndirect(Uop *uop);
+
 	// Stats 
 	long long accesses = 0;
 	long long hits = 0;
 
+	// Update the direction predictor tables with the outcome of a
+	// conditional branch, using the indexes recorded in the uop at the
+	// time of the lookup.
+	void UpdateTables(Uop *uop);
+
 public:
 
 	//
@@ -185,6 +353,34 @@ public:
 
 	static int getTwoLevelL2Height() { return two_level_l2_height; }
 
+	static int getTageNumTables() { return tage_num_tables; }
+
+	static int getTageTableSize() { return tage_table_size; }
+
+	static int getTageTagBits() { return tage_tag_bits; }
+
+	static int getTageMinHistory() { return tage_min_history; }
+
+	static int getTageMaxHistory() { return tage_max_history; }
+
+	static int getPerceptronNumTables() { return perceptron_num_tables; }
+
+	static int getPerceptronTableSize() { return perceptron_table_size; }
+
+	static int getPerceptronHistorySize() { return perceptron_history_size; }
+
+	static IndirectKind getIndirectKind() { return indirect_kind; }
+
+	static int getIttageNumTables() { return ittage_num_tables; }
+
+	static int getIttageTableSize() { return ittage_table_size; }
+
+	static int getIttageTagBits() { return ittage_tag_bits; }
+
+	static int getIttageMinHistory() { return ittage_min_history; }
+
+	static int getIttageMaxHistory() { return ittage_max_history; }
+
 
 
 
@@ -247,6 +443,17 @@ public:
 	///
 	void Update(Uop *uop);
 
+	/// Train the branch predictor with a branch that was executed outside
+	/// of the pipeline, such as during the functional phases of a sampled
+	/// simulation. The predictor tables, the BTB, and the RAS are updated
+	/// as if the branch had been fetched and committed, but statistics
+	/// are not recorded.
+	///
+	/// \param uop
+	///	Non-speculative micro-instruction with the branch information.
+	///
+	void Train(Uop *uop);
+
 	/// Lookup BTB. If it contains the uop address, return target. The BTB
 	/// also contains information about the type of branch, i.e., jump,
 	/// call, ret, or conditional. If instruction is call or ret, access RAS
@@ -284,6 +491,20 @@ public:
 	/// 	Next branch address
 	///
 	unsigned int getNextBranch(unsigned int eip, unsigned int block_size);
+
+	/// Run the predictor on a trace of control instructions, as produced
+	/// with option '--x86-branch-trace', without simulating the pipeline.
+	/// Each control instruction looks up the predictor and the BTB and
+	/// updates them right away, as if it was committed right after being
+	/// fetched. A report of the prediction accuracy is dumped into \a os.
+	void Evaluate(std::istream &is, std::ostream &os = std::cout);
+
+	/// Return the number of branches that updated the predictor
+	long long getNumAccesses() const { return accesses; }
+
+	/// Return the number of branches whose next instruction address was
+	/// predicted correctly
+	long long getNumHits() const { return hits; }
 };
 
 }
@@ -48,7 +48,7 @@ void Core::Dump(std::ostream &os) const
 }
 
 
-void Core::InsertInEventQueue(std::shared_ptr<Uop> uop, int latency)
+void Core::InsertInEventQueue(misc::SlabPtr<Uop> uop, int latency)
 {
 	// Sanity
 	assert(!uop->in_event_queue);
@@ -312,7 +312,7 @@ void Core::Writeback()
 			break;
 
 		// Pick uop from the head of the event queue
-		std::shared_ptr<Uop> uop = event_queue.front();
+		misc::SlabPtr<Uop> uop = event_queue.front();
 
 		// If the uop is set to complete later than the current cycle,
 		// there is nothing else to extract from the event queue.
@@ -447,6 +447,28 @@ void Core::Commit()
 
 		throw misc::Panic("Invalid commit kind");
 	}
+
+	// Attribute commit slots to the categories of the CPI stack
+	for (auto &thread : threads)
+		thread->UpdateCommitSlots();
+}
+
+
+long long Core::getNumCommitSlots(Thread::CommitStall stall) const
+{
+	long long num_slots = 0;
+	for (auto &thread : threads)
+		num_slots += thread->getNumCommitSlots(stall);
+	return num_slots;
+}
+
+
+long long Core::getNumCommittedInstructions() const
+{
+	long long num_instructions = 0;
+	for (auto &thread : threads)
+		num_instructions += thread->getNumCommittedInstructions();
+	return num_instructions;
 }
 
 
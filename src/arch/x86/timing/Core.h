@@ -22,9 +22,11 @@
 
 #include <vector>
 #include <list>
+#include <memory>
 #include <string>
 
 #include <arch/x86/emulator/Uinst.h>
+#include <lib/cpp/Slab.h>
 
 #include "Alu.h"
 #include "Thread.h"
@@ -48,6 +50,10 @@ private:
 	// CPU that it belongs to 
 	Cpu *cpu;
 
+	// Slab where the uops of all threads are allocated. It is declared
+	// before all structures holding uops, so that it is destroyed last.
+	misc::Slab uop_slab;
+
 	// Array of threads 
 	std::vector<std::unique_ptr<Thread>> threads;
 
@@ -58,7 +64,7 @@ private:
 	Alu alu;
 
 	// Event queue
-	std::list<std::shared_ptr<Uop>> event_queue;
+	std::list<misc::SlabPtr<Uop>> event_queue;
 
 
 
@@ -217,6 +223,15 @@ public:
 	/// Return a new unique identifier for a uop in this core
 	long long getUopId() { return ++uop_id_counter; }
 
+	/// Create a uop for the given thread in the core's slab of uops
+	misc::SlabPtr<Uop> newUop(Thread *thread,
+			Context *context,
+			std::shared_ptr<Uinst> uinst)
+	{
+		return misc::SlabPtr<Uop>::New(&uop_slab,
+				thread, context, uinst);
+	}
+
 	/// Return the core's arithmetic-logic unit
 	Alu *getAlu() { return &alu; }
 
@@ -288,20 +303,20 @@ public:
 	/// Insert uop into event queue, making it ready to be extract in
 	/// \a latency cycles from now. The uop's field `complete_when` is
 	/// set to the current cycle plus \a latency in the function.
-	void InsertInEventQueue(std::shared_ptr<Uop> uop, int latency);
+	void InsertInEventQueue(misc::SlabPtr<Uop> uop, int latency);
 
 	/// Extract uop from event queue. The given uop must be placed at the
 	/// head of the event queue.
 	void ExtractFromEventQueue(Uop *uop);
 
 	/// Return an iterator to the first element of the event queue
-	std::list<std::shared_ptr<Uop>>::iterator getEventQueueBegin()
+	std::list<misc::SlabPtr<Uop>>::iterator getEventQueueBegin()
 	{
 		return event_queue.begin();
 	}
 
 	/// Return a past-the-end iterator to the event queue
-	std::list<std::shared_ptr<Uop>>::iterator getEventQueueEnd()
+	std::list<misc::SlabPtr<Uop>>::iterator getEventQueueEnd()
 	{
 		return event_queue.end();
 	}
@@ -608,6 +623,14 @@ public:
 	
 	/// Return the number of mispredicted branches
 	long long getNumMispredictedBranches() const { return num_mispredicted_branches; }
+
+	/// Return the number of commit slots of all threads attributed to a
+	/// category of the CPI stack
+	long long getNumCommitSlots(Thread::CommitStall stall) const;
+
+	/// Return the number of x86 macro-instructions committed by all
+	/// threads
+	long long getNumCommittedInstructions() const;
 };
 
 }
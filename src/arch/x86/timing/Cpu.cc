@@ -17,7 +17,13 @@
  *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <algorithm>
+
+#include <arch/x86/emulator/Emulator.h>
+#include <lib/esim/Engine.h>
+
 #include "Cpu.h"
+#include "Thread.h"
 #include "Timing.h"
 
 
@@ -78,6 +84,7 @@ int Cpu::context_quantum;
 int Cpu::thread_quantum;
 int Cpu::thread_switch_penalty;
 long long Cpu::num_fast_forward_instructions;
+long long Cpu::num_functional_warming_instructions;
 long long Cpu::max_cycles = 0;
 int Cpu::recover_penalty;
 Cpu::RecoverKind Cpu::recover_kind;
@@ -97,6 +104,7 @@ Cpu::InstructionQueueKind Cpu::instruction_queue_kind;
 int Cpu::instruction_queue_size;
 Cpu::LoadStoreQueueKind Cpu::load_store_queue_kind;
 int Cpu::load_store_queue_size;
+int Cpu::load_store_queue_forward_latency;
 int Cpu::uop_queue_size;
 
 esim::Event *Cpu::event_memory_access_start;
@@ -124,6 +132,11 @@ Cpu::Cpu(Timing *timing) : timing(timing)
 	cores.reserve(num_cores);
 	for (int i = 0; i < num_cores; i++)
 		cores.emplace_back(misc::new_unique<Core>(this, i));
+
+	// Host threads
+	num_partitions = std::min(esim::Engine::getNumHostThreads(), num_cores);
+	if (num_partitions > 1)
+		thread_pool = misc::new_unique<misc::ThreadPool>(num_partitions);
 }
 
 
@@ -139,6 +152,9 @@ void Cpu::ParseConfiguration(misc::IniFile *ini_file)
 	context_quantum = ini_file->ReadInt(section, "ContextQuantum", 100000);
 	thread_quantum = ini_file->ReadInt(section, "ThreadQuantum", 1000);
 	thread_switch_penalty = ini_file->ReadInt(section, "ThreadSwitchPenalty", 0);
+	num_fast_forward_instructions = ini_file->ReadInt64(section, "FastForward", 0);
+	num_functional_warming_instructions = ini_file->ReadInt64(section,
+			"FunctionalWarming", 0);
 	recover_kind = (RecoverKind)ini_file->ReadEnum(section, "RecoverKind",
 			recover_kind_map, RecoverKindWriteback);
 	recover_penalty = ini_file->ReadInt(section, "RecoverPenalty", 0);
@@ -172,6 +188,8 @@ void Cpu::ParseConfiguration(misc::IniFile *ini_file)
 	load_store_queue_kind = (LoadStoreQueueKind) ini_file->ReadEnum(section, "LsqKind",
 			load_store_queue_kind_map, LoadStoreQueueKindPrivate);
 	load_store_queue_size = ini_file->ReadInt(section, "LsqSize", 20);
+	load_store_queue_forward_latency = ini_file->ReadInt(section,
+			"LsqForwardLatency", 1);
 	uop_queue_size = ini_file->ReadInt(section, "UopQueueSize", 32);
 
 }
@@ -182,16 +200,146 @@ void Cpu::Run()
 	// Invoke scheduler
 	Schedule();
 
-	// Run all cores
+	// Without host threads, run all stages of one core before moving to
+	// the next one
+	if (!thread_pool)
+	{
+		for (auto &core : cores)
+			core->Run();
+		return;
+	}
+
+	// Run cores in parallel
+	RunParallel();
+}
+
+
+void Cpu::RunParallel()
+{
+	// The commit and fetch stages run the functional emulator, so they run
+	// sequentially before and after the rest of the stages.
+	for (auto &core : cores)
+		core->Commit();
+
+	// Run the rest of the stages for groups of consecutive cores in
+	// parallel. Accesses to the memory hierarchy and recoveries of the
+	// emulator are deferred until the end of the parallel region. Pipeline
+	// traces are written in core order within each stage, so they require
+	// a single group. The region is used even with a single group, so that
+	// the order of deferred actions does not depend on the number of host
+	// threads.
+	int num_groups = Timing::trace ? 1 : num_partitions;
+	auto run_group = [this, num_groups](int partition)
+	{
+		esim::Engine::setPartition(partition);
+		int first = partition * num_cores / num_groups;
+		int last = (partition + 1) * num_cores / num_groups;
+		for (int i = first; i < last; i++)
+		{
+			Core *core = cores[i].get();
+			core->Writeback();
+			core->Issue();
+			core->Dispatch();
+			core->Decode();
+		}
+	};
+	esim::Engine *esim_engine = esim::Engine::getInstance();
+	esim_engine->BeginParallel(num_groups);
+	thread_pool->Run(num_groups, run_group);
+	esim_engine->EndParallel();
+
+	// Fetch
+	for (auto &core : cores)
+		core->Fetch();
+}
+
+
+bool Cpu::isDrained() const
+{
 	for (auto &core : cores)
-		core->Run();
+	{
+		// Core event queue
+		if (core->getEventQueueBegin() != core->getEventQueueEnd())
+			return false;
+
+		// Threads
+		for (int i = 0; i < num_threads; i++)
+			if (!core->getThread(i)->isDrained())
+				return false;
+	}
+
+	// Nothing in flight
+	return true;
+}
+
+
+long long Cpu::RunFunctional(long long num_instructions, bool warm)
+{
+	// Without warming, contexts do not need to produce micro-instructions
+	Emulator *emulator = Emulator::getInstance();
+	if (!warm)
+		for (auto it = emulator->getContextsBegin(),
+				e = emulator->getContextsEnd(); it != e; ++it)
+			(*it)->setUinstActive(false);
+
+	// Run instructions
+	esim::Engine *esim_engine = esim::Engine::getInstance();
+	long long count = 0;
+	while (count < num_instructions && !esim_engine->hasFinished())
+	{
+		// Nothing to run if all contexts are suspended or finished. Let
+		// the detailed simulation advance time.
+		if (!emulator->getNumRunningContexts())
+			break;
+
+		// Run one instruction from every running context
+		for (auto it = emulator->getContextsBegin(),
+				e = emulator->getContextsEnd(); it != e; ++it)
+		{
+			// Skip if not running
+			Context *context = it->get();
+			if (!context->getState(Context::StateRunning))
+				continue;
+
+			// Run one instruction
+			Thread *thread = context->thread;
+			if (warm && thread && thread->context == context)
+				thread->Warm();
+			else
+				context->Execute();
+			count++;
+		}
+
+		// Process list of suspended contexts
+		emulator->ProcessEvents();
+	}
+
+	// Free finished contexts that were never mapped to a hardware thread.
+	// Contexts that are mapped are freed by the scheduler once unmapped.
+	for (auto it = emulator->getFinishedContextsBegin();
+			it != emulator->getFinishedContextsEnd(); )
+	{
+		Context *context = *it;
+		++it;
+		if (!context->getState(Context::StateMapped))
+			emulator->FreeContext(context);
+	}
+
+	// Restore generation of micro-instructions
+	if (!warm)
+		for (auto it = emulator->getContextsBegin(),
+				e = emulator->getContextsEnd(); it != e; ++it)
+			(*it)->setUinstActive(true);
+
+	// Return number of instructions executed
+	return count;
 }
 
 
 void Cpu::MemoryAccess(mem::Module *module,
 			mem::Module::AccessType access_type,
 			unsigned address,
-			std::shared_ptr<Uop> uop)
+			misc::SlabPtr<Uop> uop)
 {
 	// New frame
 	auto frame = misc::new_shared<MemoryAccessFrame>();
@@ -214,13 +362,16 @@ void Cpu::MemoryAccessHandler(esim::Event *event, esim::Frame *esim_frame)
 	// Check event
 	if (event == event_memory_access_start)
 	{
-		// Start access
+		// Start access. Loads track the module supplying their data
+		// to attribute commit stalls.
 		mem::Module *module = frame->module;
 		frame->uop->memory_access = module->Access(
 				frame->access_type,
 				frame->address,
 				nullptr,
-				event_memory_access_end);
+				event_memory_access_end,
+				frame->access_type == mem::Module::AccessLoad ?
+				&frame->uop->memory_module : nullptr);
 	}
 	else if (event == event_memory_access_end)
 	{
@@ -242,7 +393,7 @@ long long Cpu::getCycle() const
 }
 
 
-void Cpu::InsertInTraceList(std::shared_ptr<Uop> uop)
+void Cpu::InsertInTraceList(misc::SlabPtr<Uop> uop)
 {
 	assert(Timing::trace == true);
 	assert(!uop->in_trace_list);
@@ -256,7 +407,7 @@ void Cpu::EmptyTraceList()
 	while (trace_list.size())
 	{
 		// Get instruction at the head
-		std::shared_ptr<Uop> uop = trace_list.front();
+		misc::SlabPtr<Uop> uop = trace_list.front();
 		assert(uop->in_trace_list);
 
 		// Remove from trace list
@@ -24,6 +24,7 @@
 #include <list>
 #include <vector>
 
+#include <lib/cpp/ThreadPool.h>
 #include <memory/Mmu.h>
 #include <memory/Module.h>
 #include <arch/x86/emulator/Emulator.h>
@@ -161,6 +162,10 @@ private:
 	// Number of fast forward instructions
 	static long long num_fast_forward_instructions;
 
+	// Number of instructions at the end of the fast-forward that warm up
+	// caches, branch predictors, and trace caches
+	static long long num_functional_warming_instructions;
+
 
 
 	//
@@ -179,11 +184,27 @@ private:
 	// MMU used by this CPU
 	std::shared_ptr<mem::Mmu> mmu;
 
+	// Pool of host threads running groups of cores in parallel, or
+	// null if cores run sequentially.
+	std::unique_ptr<misc::ThreadPool> thread_pool;
+
+	// Number of groups of consecutive cores run in parallel
+	int num_partitions = 1;
+
+	// Simulate one cycle of all cores stage by stage, running the stages
+	// that do not invoke the functional emulator in a parallel region of
+	// the event-driven engine.
+	void RunParallel();
+
 	// Name of currently simulated stage 
 	std::string stage;
 
 	// List containing uops that need to report an 'end_inst' trace event 
-	std::list<std::shared_ptr<Uop>> trace_list;
+	std::list<misc::SlabPtr<Uop>> trace_list;
+
+	// Flag indicating that the pipelines are being drained, so no new
+	// instructions should be fetched.
+	bool draining = false;
 
 
 
@@ -259,7 +280,7 @@ private:
 		unsigned address = -1;
 
 		// Uop associated with the memory access
-		std::shared_ptr<Uop> uop;
+		misc::SlabPtr<Uop> uop;
 	};
 
 	// Event scheduled to start a memory access
@@ -339,6 +360,10 @@ private:
 	// Load/Store queue size
 	static int load_store_queue_size;
 
+	// Latency of a load obtaining its data from an older store in the
+	// store queue
+	static int load_store_queue_forward_latency;
+
 	// Uop queue size
 	static int uop_queue_size;
 
@@ -398,6 +423,9 @@ public:
 	/// Get load/store queue size
 	static int getLoadStoreQueueSize() { return load_store_queue_size; }
 
+	/// Get latency of store-to-load forwarding
+	static int getLoadStoreQueueForwardLatency() { return load_store_queue_forward_latency; }
+
 	/// Return the size of the uop queue, as configured by the user
 	static int getUopQueueSize() { return uop_queue_size; }
 
@@ -438,6 +466,13 @@ public:
 		return num_fast_forward_instructions;
 	}
 
+	/// Return the number of fast-forward instructions that warm up the
+	/// caches and predictors, as configured by the user
+	static long long getNumFunctionalWarmingInstructions()
+	{
+		return num_functional_warming_instructions;
+	}
+
 	/// Return the maximum number of cycles to simulate, as configured by
 	/// the user
 	static long long getMaxCycles() { return max_cycles; }
@@ -480,7 +515,7 @@ public:
 	/// Insert an uop into a list of uops that still need to dump an
 	/// 'end_inst' trace event. This will happen when the trace list is
 	/// emptied with a call to EmptyUopTraceList().
-	void InsertInTraceList(std::shared_ptr<Uop> uop);
+	void InsertInTraceList(misc::SlabPtr<Uop> uop);
 
 	/// Empty the uop trace list and make every uop contained in it dump
 	/// its last 'end_inst' trace event.
@@ -489,6 +524,31 @@ public:
 	/// Simulate one cycle of the CPU for all its cores and threads.
 	void Run();
 
+	/// Start or stop draining the pipelines. While draining, no thread
+	/// fetches new instructions, while in-flight instructions continue
+	/// down the pipeline until they commit.
+	void setDraining(bool draining) { this->draining = draining; }
+
+	/// Return whether the pipelines are being drained
+	bool isDraining() const { return draining; }
+
+	/// Return true if no instruction or memory access is in flight in
+	/// any core or thread.
+	bool isDrained() const;
+
+	/// Execute up to \a num_instructions instructions functionally,
+	/// interleaving all running contexts, without simulating the
+	/// pipelines. If \a warm is true, instructions of contexts allocated
+	/// to hardware threads warm up the caches and predictors of their
+	/// threads. Threads must be restarted with Thread::ResetFetch() before
+	/// detailed simulation resumes.
+	///
+	/// \return
+	///	The number of instructions executed, which is lower than
+	///	\a num_instructions if all contexts finished or got
+	///	suspended, or if the simulation finished.
+	long long RunFunctional(long long num_instructions, bool warm);
+
 	/// Update structure occupancy statistics
 	void UpdateOccupancyStats();
 
@@ -501,7 +561,7 @@ public:
 	void MemoryAccess(mem::Module *module,
 			mem::Module::AccessType access_type,
 			unsigned address,
-			std::shared_ptr<Uop> uop);
+			misc::SlabPtr<Uop> uop);
 
 
 
@@ -544,9 +604,11 @@ public:
 	/// Increment the number of dispatched micro-instructions of a kind
 	void incNumDispatchedUinsts(Uinst::Opcode opcode)
 	{
+		// Cores may dispatch in parallel
 		assert(opcode < Uinst::OpcodeCount);
-		num_dispatched_uinst_array[opcode]++;
-		num_dispatched_uinsts++;
+		__atomic_add_fetch(&num_dispatched_uinst_array[opcode], 1,
+				__ATOMIC_RELAXED);
+		__atomic_add_fetch(&num_dispatched_uinsts, 1, __ATOMIC_RELAXED);
 	}
 
 	/// Return the array of dispatched micro-instructions
@@ -564,9 +626,11 @@ public:
 	/// Increment the number of issued micro-instructions of a kind
 	void incNumIssuedUinsts(Uinst::Opcode opcode)
 	{
+		// Cores may issue in parallel
 		assert(opcode < Uinst::OpcodeCount);
-		num_issued_uinst_array[opcode]++;
-		num_issued_uinsts++;
+		__atomic_add_fetch(&num_issued_uinst_array[opcode], 1,
+				__ATOMIC_RELAXED);
+		__atomic_add_fetch(&num_issued_uinsts, 1, __ATOMIC_RELAXED);
 	}
 
 	/// Return the array of issued micro-instructions
@@ -602,7 +666,11 @@ public:
 	}
 
 	/// Increment the number of squashed micro-instructions
-	void incNumSquashedUinsts() { num_squashed_uinsts++; }
+	void incNumSquashedUinsts()
+	{
+		// Cores may recover in parallel
+		__atomic_add_fetch(&num_squashed_uinsts, 1, __ATOMIC_RELAXED);
+	}
 
 	/// Return the number of squashed micro-instructions
 	long long getNumSquashedUinsts() const { return num_squashed_uinsts; }
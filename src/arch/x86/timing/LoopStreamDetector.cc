@@ -0,0 +1,128 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <lib/cpp/String.h>
+
+#include "LoopStreamDetector.h"
+
+
+namespace x86
+{
+
+bool LoopStreamDetector::present;
+int LoopStreamDetector::size;
+int LoopStreamDetector::num_lock_iterations;
+int LoopStreamDetector::width;
+
+
+void LoopStreamDetector::ParseConfiguration(misc::IniFile *ini_file)
+{
+	// Section
+	std::string section = "LoopStreamDetector";
+
+	// Read variables
+	present = ini_file->ReadBool(section, "Present", false);
+	size = ini_file->ReadInt(section, "Size", 28);
+	num_lock_iterations = ini_file->ReadInt(section, "LockIterations", 2);
+	width = ini_file->ReadInt(section, "Width", 4);
+
+	// Integrity checks
+	if (size < 1)
+		throw Error(misc::fmt("%s: Invalid value for 'Size'", section.c_str()));
+	if (num_lock_iterations < 1)
+		throw Error(misc::fmt("%s: Invalid value for 'LockIterations'", section.c_str()));
+	if (width < 1)
+		throw Error(misc::fmt("%s: Invalid value for 'Width'", section.c_str()));
+}
+
+
+void LoopStreamDetector::DumpConfiguration(std::ostream &os)
+{
+	os << "; Loop stream detector - parameters\n";
+	os << misc::fmt("LoopStreamDetector.Size = %d\n", size);
+	os << misc::fmt("LoopStreamDetector.LockIterations = %d\n", num_lock_iterations);
+	os << misc::fmt("LoopStreamDetector.Width = %d\n", width);
+	os << '\n';
+}
+
+
+LoopStreamDetector::LoopStreamDetector(const std::string &name) :
+		name(name)
+{
+}
+
+
+void LoopStreamDetector::DumpReport(std::ostream &os)
+{
+	// Dump the configuration
+	DumpConfiguration(os);
+
+	// Statistics
+	os << "; Loop stream detector - statistics\n";
+	os << misc::fmt("LoopStreamDetector.Locks = %lld\n", num_locks);
+	os << misc::fmt("LoopStreamDetector.ActiveCycles = %lld\n", num_active_cycles);
+	os << misc::fmt("LoopStreamDetector.Fetched = %lld\n", num_fetched_uinsts);
+	os << misc::fmt("LoopStreamDetector.Committed = %lld\n", num_committed_uinsts);
+	os << '\n';
+}
+
+
+void LoopStreamDetector::RecordTakenBranch(unsigned eip, unsigned target)
+{
+	// Only backward branches close loops
+	if (target > eip)
+		return;
+
+	// A new candidate loop
+	if (eip != branch_eip || target != this->target)
+	{
+		branch_eip = eip;
+		this->target = target;
+		num_iterations = 0;
+		num_uops = 0;
+		return;
+	}
+
+	// One more iteration of the candidate loop. The body must fit in the
+	// detector.
+	if (num_uops > size)
+		num_iterations = 0;
+	else
+		num_iterations++;
+	num_uops = 0;
+
+	// Lock loop
+	if (!locked && num_iterations >= num_lock_iterations)
+	{
+		locked = true;
+		num_locks++;
+	}
+}
+
+
+void LoopStreamDetector::Unlock()
+{
+	locked = false;
+	branch_eip = 0;
+	target = 0;
+	num_iterations = 0;
+	num_uops = 0;
+}
+
+}  // namespace x86
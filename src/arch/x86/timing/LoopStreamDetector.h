@@ -0,0 +1,193 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef ARCH_X86_TIMING_LOOP_STREAM_DETECTOR_H
+#define ARCH_X86_TIMING_LOOP_STREAM_DETECTOR_H
+
+#include <lib/cpp/Error.h>
+#include <lib/cpp/IniFile.h>
+
+
+namespace x86
+{
+
+/// Loop stream detector. It detects loops whose body fits in the uop
+/// queue by watching predicted-taken backward branches in the fetch stage.
+/// After a loop ran the same body for a configurable number of iterations,
+/// the detector locks it, and its uops are streamed from the uop queue
+/// without accessing the instruction cache, the uop cache, or the
+/// decoders. The lock is released when fetch leaves the loop body or the
+/// pipeline recovers from a misprediction.
+class LoopStreamDetector
+{
+public:
+
+	/// Exception for the x86 loop stream detector
+	class Error : public misc::Error
+	{
+	public:
+
+		Error(const std::string &message) : misc::Error(message)
+		{
+			AppendPrefix("x86 loop stream detector");
+		}
+	};
+
+private:
+
+	//
+	// Static fields
+	//
+
+	// Flag indicating whether the loop stream detector is present
+	static bool present;
+
+	// Maximum number of uops in a loop body
+	static int size;
+
+	// Number of iterations before a loop is locked
+	static int num_lock_iterations;
+
+	// Number of uops streamed per cycle
+	static int width;
+
+
+
+
+	//
+	// Class members
+	//
+
+	// Name
+	std::string name;
+
+	// Candidate loop, given by the address of its backward branch and the
+	// target of the branch.
+	unsigned branch_eip = 0;
+	unsigned target = 0;
+
+	// Number of consecutive iterations of the candidate loop
+	int num_iterations = 0;
+
+	// Number of uops fetched since the last backward branch
+	int num_uops = 0;
+
+	// Candidate loop locked
+	bool locked = false;
+
+
+
+
+	//
+	// Statistics
+	//
+
+	// Number of times a loop was locked
+	long long num_locks = 0;
+
+	// Number of cycles fetching from a locked loop
+	long long num_active_cycles = 0;
+
+	// Number of fetched micro-instructions
+	long long num_fetched_uinsts = 0;
+
+	// Number of committed micro-instructions coming from the detector
+	long long num_committed_uinsts = 0;
+
+public:
+
+	//
+	// Static members
+	//
+
+	/// Read configuration from configuration file
+	static void ParseConfiguration(misc::IniFile *ini_file);
+
+	/// Dump configuration
+	static void DumpConfiguration(std::ostream &os = std::cout);
+
+	/// Return whether the loop stream detector was configured as present
+	static bool isPresent() { return present; }
+
+	/// Return the maximum number of uops in a loop body
+	static int getSize() { return size; }
+
+	/// Return the number of iterations before a loop is locked
+	static int getNumLockIterations() { return num_lock_iterations; }
+
+	/// Return the number of uops streamed per cycle
+	static int getWidth() { return width; }
+
+
+
+
+	//
+	// Class members
+	//
+
+	/// Constructor
+	LoopStreamDetector(const std::string &name = "");
+
+	/// Dump the loop stream detector report
+	void DumpReport(std::ostream &os = std::cout);
+
+	/// Record a uop fetched
+	void RecordUop() { num_uops++; }
+
+	/// Record a branch predicted taken in the fetch stage, jumping from
+	/// address \a eip to address \a target.
+	void RecordTakenBranch(unsigned eip, unsigned target);
+
+	/// Return whether a loop is locked
+	bool isLocked() const { return locked; }
+
+	/// Return whether a loop is locked and address \a eip is part of its
+	/// body.
+	bool isInLoop(unsigned eip) const
+	{
+		return locked && eip >= target && eip <= branch_eip;
+	}
+
+	/// Release the locked loop, if any, and forget the candidate loop
+	void Unlock();
+
+
+
+
+	//
+	// Statistics
+	//
+
+	/// Increment the number of cycles fetching from a locked loop
+	void incNumActiveCycles() { num_active_cycles++; }
+
+	/// Increment number of fetched micro-instructions
+	void incNumFetchedUinsts() { num_fetched_uinsts++; }
+
+	/// Increment the number of committed micro-instructions coming from
+	/// the loop stream detector
+	void incNumCommittedUinsts() { num_committed_uinsts++; }
+
+	/// Return the number of times a loop was locked
+	long long getNumLocks() const { return num_locks; }
+};
+
+}  // namespace x86
+
+#endif
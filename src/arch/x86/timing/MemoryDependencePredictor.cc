@@ -0,0 +1,142 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <lib/cpp/Misc.h>
+
+#include "MemoryDependencePredictor.h"
+#include "Uop.h"
+
+
+namespace x86
+{
+
+MemoryDependencePredictor::Kind MemoryDependencePredictor::kind;
+int MemoryDependencePredictor::load_wait_size;
+int MemoryDependencePredictor::load_wait_clear_interval;
+int MemoryDependencePredictor::violation_penalty;
+
+misc::StringMap MemoryDependencePredictor::KindMap =
+{
+	{ "Conservative", KindConservative },
+	{ "Aggressive", KindAggressive },
+	{ "LoadWait", KindLoadWait }
+};
+
+
+MemoryDependencePredictor::MemoryDependencePredictor(const std::string &name)
+	:
+	name(name)
+{
+	// Load wait table
+	if (kind == KindLoadWait)
+	{
+		load_wait_table = misc::new_unique_array<bool>(load_wait_size);
+		for (int i = 0; i < load_wait_size; i++)
+			load_wait_table[i] = false;
+	}
+}
+
+
+void MemoryDependencePredictor::ParseConfiguration(misc::IniFile *ini_file)
+{
+	// Section
+	std::string section = "MemoryDependencePredictor";
+
+	// Read values
+	kind = (Kind) ini_file->ReadEnum(section, "Kind",
+			KindMap, KindLoadWait);
+	load_wait_size = ini_file->ReadInt(section, "LoadWait.Size", 1024);
+	load_wait_clear_interval = ini_file->ReadInt(section,
+			"LoadWait.ClearInterval", 16384);
+	violation_penalty = ini_file->ReadInt(section, "ViolationPenalty", 10);
+
+	// Integrity
+	if (load_wait_size < 1 || (load_wait_size & (load_wait_size - 1)))
+		throw Error("number of entries in the load wait table must be "
+				"a power of 2");
+	if (load_wait_clear_interval < 0)
+		throw Error("load wait table clear interval must be >= 0");
+	if (violation_penalty < 0)
+		throw Error("violation penalty must be >= 0");
+}
+
+
+bool MemoryDependencePredictor::Lookup(Uop *uop, long long cycle)
+{
+	// Statistics
+	num_lookups++;
+
+	// Predict
+	bool wait;
+	switch (kind)
+	{
+
+	case KindConservative:
+
+		wait = true;
+		break;
+
+	case KindAggressive:
+
+		wait = false;
+		break;
+
+	case KindLoadWait:
+	{
+		// Clear the table periodically, so that loads that stopped
+		// conflicting with older stores can issue early again.
+		if (load_wait_clear_interval && cycle - last_clear_cycle >=
+				load_wait_clear_interval)
+		{
+			for (int i = 0; i < load_wait_size; i++)
+				load_wait_table[i] = false;
+			last_clear_cycle = cycle;
+		}
+
+		// Look up entry for the load address
+		wait = load_wait_table[uop->eip & (load_wait_size - 1)];
+		break;
+	}
+
+	default:
+
+		throw misc::Panic("Invalid memory dependence predictor kind");
+	}
+
+	// Statistics
+	if (wait)
+		num_wait_predictions++;
+
+	// Return prediction
+	return wait;
+}
+
+
+void MemoryDependencePredictor::Update(Uop *uop)
+{
+	// Statistics
+	num_violations++;
+
+	// Make the load wait for older stores from now on
+	if (kind == KindLoadWait)
+		load_wait_table[uop->eip & (load_wait_size - 1)] = true;
+}
+
+
+}  // namespace x86
@@ -0,0 +1,174 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef ARCH_X86_TIMING_MEMORY_DEPENDENCE_PREDICTOR_H
+#define ARCH_X86_TIMING_MEMORY_DEPENDENCE_PREDICTOR_H
+
+#include <memory>
+#include <string>
+
+#include <lib/cpp/Error.h>
+#include <lib/cpp/IniFile.h>
+
+
+namespace x86
+{
+
+// Forward declaration
+class Uop;
+
+/// Memory dependence predictor. It is looked up by loads that are ready to
+/// issue while older stores in the store queue have not resolved their
+/// address yet, and decides whether the load should wait for those stores
+/// or issue speculatively.
+class MemoryDependencePredictor
+{
+public:
+
+	/// Predictor kind
+	enum Kind
+	{
+		KindInvalid = 0,
+		KindConservative,
+		KindAggressive,
+		KindLoadWait
+	};
+
+	/// String map for values of type Kind
+	static misc::StringMap KindMap;
+
+private:
+
+	//
+	// Static fields
+	//
+
+	// Predictor kind
+	static Kind kind;
+
+	// Number of entries in the load wait table
+	static int load_wait_size;
+
+	// Number of cycles after which the load wait table is cleared
+	static int load_wait_clear_interval;
+
+	// Number of cycles a load is delayed after a memory ordering violation
+	static int violation_penalty;
+
+
+
+
+	//
+	// Class members
+	//
+
+	// Name of the predictor
+	std::string name;
+
+	// Load wait table, indexed by the address of the load instruction.
+	// An entry is set when the load causes a memory ordering violation.
+	std::unique_ptr<bool[]> load_wait_table;
+
+	// Cycle when the load wait table was last cleared
+	long long last_clear_cycle = 0;
+
+	// Statistics
+	long long num_lookups = 0;
+	long long num_wait_predictions = 0;
+	long long num_violations = 0;
+
+public:
+
+	//
+	// Class Error
+	//
+
+	/// Exception for the x86 memory dependence predictor
+	class Error : public misc::Error
+	{
+	public:
+
+		Error(const std::string &message) : misc::Error(message)
+		{
+			AppendPrefix("X86 memory dependence predictor");
+		}
+	};
+
+
+
+
+	//
+	// Static functions
+	//
+
+	/// Read configuration from configuration file
+	static void ParseConfiguration(misc::IniFile *ini_file);
+
+	/// Return the predictor kind
+	static Kind getKind() { return kind; }
+
+	/// Return the number of entries in the load wait table
+	static int getLoadWaitSize() { return load_wait_size; }
+
+	/// Return the number of cycles between two consecutive clears of the
+	/// load wait table
+	static int getLoadWaitClearInterval() { return load_wait_clear_interval; }
+
+	/// Return the number of cycles that the commit of a load is delayed
+	/// after a memory ordering violation
+	static int getViolationPenalty() { return violation_penalty; }
+
+
+
+
+	//
+	// Class members
+	//
+
+	/// Constructor
+	MemoryDependencePredictor(const std::string &name = "");
+
+	/// Return whether a load should wait for all older stores in the
+	/// store queue to resolve their addresses before issuing.
+	///
+	/// \param uop
+	///	Load micro-instruction.
+	///
+	/// \param cycle
+	///	Current cycle, used to periodically clear the predictor.
+	///
+	bool Lookup(Uop *uop, long long cycle);
+
+	/// Train the predictor after a load was found to have issued before
+	/// an older store writing to the same location.
+	void Update(Uop *uop);
+
+	/// Return the number of lookups
+	long long getNumLookups() const { return num_lookups; }
+
+	/// Return the number of lookups that predicted the load to wait
+	long long getNumWaitPredictions() const { return num_wait_predictions; }
+
+	/// Return the number of memory ordering violations trained
+	long long getNumViolations() const { return num_violations; }
+};
+
+}  // namespace x86
+
+#endif
@@ -54,6 +54,7 @@ RegisterFile::RegisterFile(Thread *thread) :
 
 	// Integer register file
 	integer_registers = misc::new_unique_array<PhysicalRegister>(integer_local_size);
+	integer_pending = newPendingBits(integer_local_size);
 
 	// Free list
 	num_free_integer_registers = integer_local_size;
@@ -65,6 +66,7 @@ RegisterFile::RegisterFile(Thread *thread) :
 
 	// Floating-point register file
 	floating_point_registers = misc::new_unique_array<PhysicalRegister>(floating_point_local_size);
+	floating_point_pending = newPendingBits(floating_point_local_size);
 
 	// Free list
 	num_free_floating_point_registers = floating_point_local_size;
@@ -78,6 +80,7 @@ RegisterFile::RegisterFile(Thread *thread) :
 
 	// XMM register file
 	xmm_registers = misc::new_unique_array<PhysicalRegister>(xmm_local_size);
+	xmm_pending = newPendingBits(xmm_local_size);
 
 	// Free list
 	num_free_xmm_registers = xmm_local_size;
@@ -259,7 +262,7 @@ int RegisterFile::RequestIntegerRegister()
 	core->incNumOccupiedIntegerRegisters();
 	num_occupied_integer_registers++;
 	assert(!integer_registers[physical_register].busy);
-	assert(!integer_registers[physical_register].pending);
+	assert(!isPending(integer_pending.get(), physical_register));
 
 	// Debug
 	debug << misc::fmt("  Integer register %d allocated, %d available\n",
@@ -279,7 +282,7 @@ int RegisterFile::RequestFloatingPointRegister()
 	core->incNumOccupiedFloatingPointRegisters();
 	num_occupied_floating_point_registers++;
 	assert(!floating_point_registers[physical_register].busy);
-	assert(!floating_point_registers[physical_register].pending);
+	assert(!isPending(floating_point_pending.get(), physical_register));
 
 	// Debug
 	debug << misc::fmt("  Floating-point register %d allocated, "
@@ -301,7 +304,7 @@ int RegisterFile::RequestXmmRegister()
 	core->incNumOccupiedXmmRegisters();
 	num_occupied_xmm_registers++;
 	assert(!xmm_registers[physical_register].busy);
-	assert(!xmm_registers[physical_register].pending);
+	assert(!isPending(xmm_pending.get(), physical_register));
 
 	// Debug
 	debug << misc::fmt("  XMM register %d allocated, %d available\n",
@@ -362,8 +365,60 @@ bool RegisterFile::canRename(Uop *uop)
 }
 
 
+void RegisterFile::TakeCheckpoint(Uop *uop)
+{
+	// Save aliasing tables
+	checkpoint.uop_id = uop->getId();
+	for (int i = 0; i < Uinst::DepIntCount; i++)
+		checkpoint.integer_rat[i] = integer_rat[i];
+	for (int i = 0; i < Uinst::DepFpCount; i++)
+		checkpoint.floating_point_rat[i] = floating_point_rat[i];
+	for (int i = 0; i < Uinst::DepXmmCount; i++)
+		checkpoint.xmm_rat[i] = xmm_rat[i];
+	checkpoint.floating_point_top = floating_point_top;
+
+	// Debug
+	debug << misc::fmt("  Checkpoint taken for uop %lld\n", checkpoint.uop_id);
+}
+
+
+void RegisterFile::RestoreCheckpoint()
+{
+	// Restore aliasing tables
+	assert(checkpoint.uop_id >= 0);
+	for (int i = 0; i < Uinst::DepIntCount; i++)
+	{
+		integer_rat[i] = checkpoint.integer_rat[i];
+		assert(integer_registers[integer_rat[i]].busy);
+	}
+	for (int i = 0; i < Uinst::DepFpCount; i++)
+	{
+		floating_point_rat[i] = checkpoint.floating_point_rat[i];
+		assert(floating_point_registers[floating_point_rat[i]].busy);
+	}
+	for (int i = 0; i < Uinst::DepXmmCount; i++)
+	{
+		xmm_rat[i] = checkpoint.xmm_rat[i];
+		assert(xmm_registers[xmm_rat[i]].busy);
+	}
+	floating_point_top = checkpoint.floating_point_top;
+
+	// Debug
+	debug << misc::fmt("  Checkpoint restored for uop %lld\n", checkpoint.uop_id);
+
+	// Invalidate checkpoint
+	checkpoint.uop_id = -1;
+	num_checkpoint_recoveries++;
+}
+
+
 void RegisterFile::Rename(Uop *uop)
 {
+	// Checkpoint the aliasing tables before the first uop of a sequence
+	// of speculative uops. A previous checkpoint, if any, belongs to an
+	// older uop that is squashed along with this one.
+	if (uop->first_speculative_mode)
+		TakeCheckpoint(uop);
 
 	// Update floating-point top of stack
 	if (uop->getOpcode() == Uinst::OpcodeFpPop)
@@ -463,7 +518,7 @@ void RegisterFile::Rename(Uop *uop)
 			// Request a free integer register
 			int physical_register = RequestIntegerRegister();
 			integer_registers[physical_register].busy++;
-			integer_registers[physical_register].pending = true;
+			setPending(integer_pending.get(), physical_register);
 			int old_physical_register = integer_rat[logical_register - Uinst::DepIntFirst];
 			if (flag_physical_register < 0)
 				flag_physical_register = physical_register;
@@ -493,7 +548,7 @@ void RegisterFile::Rename(Uop *uop)
 			// Request a free floating-point register
 			int physical_register = RequestFloatingPointRegister();
 			floating_point_registers[physical_register].busy++;
-			floating_point_registers[physical_register].pending = true;
+			setPending(floating_point_pending.get(), physical_register);
 			int old_physical_register = floating_point_rat[stack_register - Uinst::DepFpFirst];
 
 			// Allocate it
@@ -514,7 +569,7 @@ void RegisterFile::Rename(Uop *uop)
 			// Request a free XMM register
 			int physical_register = RequestXmmRegister();
 			xmm_registers[physical_register].busy++;
-			xmm_registers[physical_register].pending = true;
+			setPending(xmm_pending.get(), physical_register);
 			int old_physical_register = xmm_rat[logical_register - Uinst::DepXmmFirst];
 
 			// Allocate it
@@ -555,7 +610,7 @@ void RegisterFile::Rename(Uop *uop)
 
 			// Rename
 			integer_registers[flag_physical_register].busy++;
-			integer_registers[flag_physical_register].pending = true;
+			setPending(integer_pending.get(), flag_physical_register);
 			int old_physical_register = integer_rat[logical_register - Uinst::DepIntFirst];
 			uop->setOutput(dep, flag_physical_register);
 			uop->setOldOutput(dep, old_physical_register);
@@ -588,17 +643,17 @@ bool RegisterFile::isUopReady(Uop *uop)
 
 		// Integer dependency
 		if (Uinst::isIntegerDependency(logical_register)
-				&& integer_registers[physical_register].pending)
+				&& isPending(integer_pending.get(), physical_register))
 			return false;
 
 		// Floating-point dependency
 		if (Uinst::isFloatingPointDependency(logical_register)
-				&& floating_point_registers[physical_register].pending)
+				&& isPending(floating_point_pending.get(), physical_register))
 			return false;
 
 		// XMM dependency
 		if (Uinst::isXmmDependency(logical_register)
-				&& xmm_registers[physical_register].pending)
+				&& isPending(xmm_pending.get(), physical_register))
 			return false;
 	}
 
@@ -618,11 +673,11 @@ void RegisterFile::WriteUop(Uop *uop)
 		int logical_register = uop->getUinst()->getODep(dep);
 		int physical_register = uop->getOutput(dep);
 		if (Uinst::isIntegerDependency(logical_register))
-			integer_registers[physical_register].pending = false;
+			clearPending(integer_pending.get(), physical_register);
 		else if (Uinst::isFloatingPointDependency(logical_register))
-			floating_point_registers[physical_register].pending = false;
+			clearPending(floating_point_pending.get(), physical_register);
 		else if (Uinst::isXmmDependency(logical_register))
-			xmm_registers[physical_register].pending = false;
+			clearPending(xmm_pending.get(), physical_register);
 	}
 }
 
@@ -633,6 +688,12 @@ void RegisterFile::UndoUop(Uop *uop)
 	// Debug
 	debug << "Undo uop " << *uop << '\n';
 
+	// Uops younger than the checkpoint only release their physical
+	// registers. Their mappings are discarded when the checkpoint is
+	// restored.
+	bool restore_mappings = checkpoint.uop_id < 0 ||
+			uop->getId() < checkpoint.uop_id;
+
 	// Undo mappings in reverse order, in case an instruction has a
 	// duplicated output dependence.
 	assert(uop->speculative_mode);
@@ -645,7 +706,7 @@ void RegisterFile::UndoUop(Uop *uop)
 		{
 			// Decrease busy counter and free if 0.
 			assert(integer_registers[physical_register].busy > 0);
-			assert(!integer_registers[physical_register].pending);
+			assert(!isPending(integer_pending.get(), physical_register));
 			integer_registers[physical_register].busy--;
 			if (!integer_registers[physical_register].busy)
 			{
@@ -668,6 +729,8 @@ void RegisterFile::UndoUop(Uop *uop)
 			}
 
 			// Return to previous mapping
+			if (!restore_mappings)
+				continue;
 			integer_rat[logical_register - Uinst::DepIntFirst] = old_physical_register;
 			assert(integer_registers[old_physical_register].busy);
 
@@ -688,7 +751,7 @@ void RegisterFile::UndoUop(Uop *uop)
 
 			// Decrease busy counter and free if 0.
 			assert(floating_point_registers[physical_register].busy > 0);
-			assert(!floating_point_registers[physical_register].pending);
+			assert(!isPending(floating_point_pending.get(), physical_register));
 			floating_point_registers[physical_register].busy--;
 			if (!floating_point_registers[physical_register].busy)
 			{
@@ -711,6 +774,8 @@ void RegisterFile::UndoUop(Uop *uop)
 			}
 
 			// Return to previous mapping
+			if (!restore_mappings)
+				continue;
 			floating_point_rat[stack_register - Uinst::DepFpFirst] = old_physical_register;
 			assert(floating_point_registers[old_physical_register].busy);
 
@@ -724,7 +789,7 @@ void RegisterFile::UndoUop(Uop *uop)
 		{
 			// Decrease busy counter and free if 0.
 			assert(xmm_registers[physical_register].busy > 0);
-			assert(!xmm_registers[physical_register].pending);
+			assert(!isPending(xmm_pending.get(), physical_register));
 			xmm_registers[physical_register].busy--;
 			if (!xmm_registers[physical_register].busy)
 			{
@@ -747,6 +812,8 @@ void RegisterFile::UndoUop(Uop *uop)
 			}
 
 			// Return to previous mapping
+			if (!restore_mappings)
+				continue;
 			xmm_rat[logical_register - Uinst::DepXmmFirst] = old_physical_register;
 			assert(xmm_registers[old_physical_register].busy);
 
@@ -764,7 +831,17 @@ void RegisterFile::UndoUop(Uop *uop)
 		}
 	}
 
+	// Restore the checkpoint taken for this uop. It also restores the
+	// floating-point top of stack.
+	if (uop->getId() == checkpoint.uop_id)
+	{
+		RestoreCheckpoint();
+		return;
+	}
+
 	// Undo modification in floating-point top of stack
+	if (!restore_mappings)
+		return;
 	if (uop->getOpcode() == Uinst::OpcodeFpPop)
 	{
 		// Inverse-pop floating-point stack
@@ -784,6 +861,10 @@ void RegisterFile::CommitUop(Uop *uop)
 	// Debug
 	debug << "Commit uop " << *uop << '\n';
 
+	// A checkpoint older than a committed uop can no longer be restored
+	if (checkpoint.uop_id >= 0 && uop->getId() >= checkpoint.uop_id)
+		checkpoint.uop_id = -1;
+
 	// Traverse output dependencies
 	assert(!uop->speculative_mode);
 	for (int dep = 0; dep < Uinst::MaxODeps; dep++)
@@ -800,7 +881,7 @@ void RegisterFile::CommitUop(Uop *uop)
 			if (!integer_registers[old_physical_register].busy)
 			{
 				// Sanity
-				assert(!integer_registers[old_physical_register].pending);
+				assert(!isPending(integer_pending.get(), old_physical_register));
 				assert(num_free_integer_registers < integer_local_size);
 				assert(core->getNumOccupiedIntegerRegisters() > 0
 						&& num_occupied_integer_registers > 0);
@@ -826,7 +907,7 @@ void RegisterFile::CommitUop(Uop *uop)
 			if (!floating_point_registers[old_physical_register].busy)
 			{
 				// Sanity
-				assert(!floating_point_registers[old_physical_register].pending);
+				assert(!isPending(floating_point_pending.get(), old_physical_register));
 				assert(num_free_floating_point_registers < floating_point_local_size);
 				assert(core->getNumOccupiedFloatingPointRegisters() > 0
 						&& num_occupied_floating_point_registers > 0);
@@ -852,7 +933,7 @@ void RegisterFile::CommitUop(Uop *uop)
 			if (!xmm_registers[old_physical_register].busy)
 			{
 				// Sanity
-				assert(!xmm_registers[old_physical_register].pending);
+				assert(!isPending(xmm_pending.get(), old_physical_register));
 				assert(num_free_xmm_registers < xmm_local_size);
 				assert(core->getNumOccupiedXmmRegisters() > 0
 						&& num_occupied_xmm_registers > 0);
@@ -887,19 +968,19 @@ void RegisterFile::CheckRegisterFile()
 	{
 		int physical_register = free_integer_registers[i];
 		assert(!integer_registers[physical_register].busy);
-		assert(!integer_registers[physical_register].pending);
+		assert(!isPending(integer_pending.get(), physical_register));
 	}
 	for (int i = 0; i < num_free_floating_point_registers; i++)
 	{
 		int physical_register = free_floating_point_registers[i];
 		assert(!floating_point_registers[physical_register].busy);
-		assert(!floating_point_registers[physical_register].pending);
+		assert(!isPending(floating_point_pending.get(), physical_register));
 	}
 	for (int i = 0; i < num_free_xmm_registers; i++)
 	{
 		int physical_register = free_xmm_registers[i];
 		assert(!xmm_registers[physical_register].busy);
-		assert(!xmm_registers[physical_register].pending);
+		assert(!isPending(xmm_pending.get(), physical_register));
 	}
 
 	// Check that all mapped integer registers are busy
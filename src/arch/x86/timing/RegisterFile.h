@@ -74,14 +74,75 @@ private:
 	// Structure of physical register
 	struct PhysicalRegister
 	{
-		// Flag indicating whether the result of this physical register
-		// is still being computed.
-		bool pending = false;
-
 		// Number of logical registers mapped to this physical register
 		int busy = 0;
 	};
 
+	// Checkpoint of the register aliasing tables
+	struct Checkpoint
+	{
+		// Identifier of the uop that the checkpoint was taken for, or -1
+		// if the checkpoint is not valid
+		long long uop_id = -1;
+
+		// Register aliasing tables before renaming the uop
+		int integer_rat[Uinst::DepIntCount];
+		int floating_point_rat[Uinst::DepFpCount];
+		int xmm_rat[Uinst::DepXmmCount];
+
+		// Floating-point top of stack before renaming the uop
+		int floating_point_top;
+	};
+
+	// Checkpoint taken when renaming the first uop of a sequence of
+	// speculative uops. Squashing these uops restores the aliasing tables
+	// from it, instead of undoing the mappings of each uop.
+	Checkpoint checkpoint;
+
+	// Number of recoveries that restored the checkpoint
+	long long num_checkpoint_recoveries = 0;
+
+	// Take a checkpoint of the aliasing tables before renaming a uop
+	void TakeCheckpoint(Uop *uop);
+
+	// Restore the aliasing tables from the checkpoint, and invalidate it
+	void RestoreCheckpoint();
+
+	// Number of bits in each word of a pending bit vector
+	static const int PendingWordBits = 64;
+
+	// Create a pending bit vector for the given number of registers
+	static std::unique_ptr<unsigned long long[]> newPendingBits(int size)
+	{
+		int num_words = (size + PendingWordBits - 1) / PendingWordBits;
+		auto bits = misc::new_unique_array<unsigned long long>(num_words);
+		for (int i = 0; i < num_words; i++)
+			bits[i] = 0;
+		return bits;
+	}
+
+	// Return whether a physical register is pending in a bit vector
+	static bool isPending(const unsigned long long *bits,
+			int physical_register)
+	{
+		return (bits[physical_register / PendingWordBits] >>
+				(physical_register % PendingWordBits)) & 1;
+	}
+
+	// Mark a physical register as pending in a bit vector
+	static void setPending(unsigned long long *bits, int physical_register)
+	{
+		bits[physical_register / PendingWordBits] |=
+				1ull << (physical_register % PendingWordBits);
+	}
+
+	// Mark a physical register as not pending in a bit vector
+	static void clearPending(unsigned long long *bits, int physical_register)
+	{
+		bits[physical_register / PendingWordBits] &=
+				~(1ull << (physical_register % PendingWordBits));
+	}
+
 
 
 
@@ -95,6 +156,10 @@ private:
 	// Integer physical registers
 	std::unique_ptr<PhysicalRegister[]> integer_registers;
 
+	// Bit vector of integer physical registers whose result is still
+	// being computed
+	std::unique_ptr<unsigned long long[]> integer_pending;
+
 	// List of free integer physical registers
 	std::unique_ptr<int[]> free_integer_registers;
 
@@ -126,6 +191,10 @@ private:
 	// Floating-point physical registers
 	std::unique_ptr<PhysicalRegister[]> floating_point_registers;
 
+	// Bit vector of floating-point physical registers whose result is
+	// still being computed
+	std::unique_ptr<unsigned long long[]> floating_point_pending;
+
 	// List of free floating-point physical registers
 	std::unique_ptr<int[]> free_floating_point_registers;
 
@@ -162,6 +231,10 @@ private:
 	// XMM physical registers
 	std::unique_ptr<PhysicalRegister[]> xmm_registers;
 
+	// Bit vector of XMM physical registers whose result is still being
+	// computed
+	std::unique_ptr<unsigned long long[]> xmm_pending;
+
 	// List of free XMM physical registers
 	std::unique_ptr<int[]> free_xmm_registers;
 
@@ -280,7 +353,9 @@ public:
 
 	/// Perform register renaming on the given uop. This operation renames
 	/// source and destination registers, requesting as many physical
-	/// registers as needed for the uop.
+	/// registers as needed for the uop. The aliasing tables are
+	/// checkpointed before renaming the first uop of a sequence of
+	/// speculative uops.
 	void Rename(Uop *uop);
 
 	/// Check if input dependencies are resolved
@@ -291,7 +366,10 @@ public:
 	void WriteUop(Uop *uop);
 
 	/// Update the state of the register file when an uop is recovered from
-	/// speculative execution
+	/// speculative execution. Uops must be undone from youngest to oldest.
+	/// Uops younger than the checkpoint only release their physical
+	/// registers, and the aliasing tables are restored from the checkpoint
+	/// when the uop that took it is undone.
 	void UndoUop(Uop *uop);
 
 	/// Update the state of the register file when an uop commits
@@ -351,6 +429,13 @@ public:
 
 	/// Return the number of writes to the XMM RAT
 	long long getNumXmmRatWrites() const { return num_xmm_rat_writes; }
+
+	/// Return the number of recoveries that restored the checkpoint of
+	/// the aliasing tables
+	long long getNumCheckpointRecoveries() const
+	{
+		return num_checkpoint_recoveries;
+	}
 };
 
 }
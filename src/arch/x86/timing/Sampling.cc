@@ -0,0 +1,457 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#include <arch/x86/emulator/Emulator.h>
+#include <lib/esim/Engine.h>
+
+#include "Cpu.h"
+#include "Sampling.h"
+#include "Thread.h"
+
+
+namespace x86
+{
+
+const misc::StringMap Sampling::phase_map =
+{
+	{ "Invalid", PhaseInvalid },
+	{ "FastForward", PhaseFastForward },
+	{ "FunctionalWarming", PhaseFunctionalWarming },
+	{ "DetailedWarming", PhaseDetailedWarming },
+	{ "Measurement", PhaseMeasurement },
+	{ "Drain", PhaseDrain }
+};
+
+bool Sampling::present;
+long long Sampling::fast_forward;
+long long Sampling::functional_warming;
+long long Sampling::detailed_warming;
+long long Sampling::measurement;
+int Sampling::max_samples;
+int Sampling::confidence;
+double Sampling::target_error;
+std::string Sampling::simpoints_file;
+std::vector<Sampling::SimPoint> Sampling::simpoints;
+long long Sampling::simpoints_instructions;
+
+
+void Sampling::ParseConfiguration(misc::IniFile *ini_file)
+{
+	// Section
+	std::string section = "Sampling";
+
+	// Read variables
+	present = ini_file->ReadBool(section, "Present", false);
+	fast_forward = ini_file->ReadInt64(section, "FastForward", 0);
+	functional_warming = ini_file->ReadInt64(section, "FunctionalWarming", 1000000);
+	detailed_warming = ini_file->ReadInt64(section, "DetailedWarming", 2000);
+	measurement = ini_file->ReadInt64(section, "Measurement", 1000);
+	max_samples = ini_file->ReadInt(section, "MaxSamples", 0);
+	confidence = ini_file->ReadInt(section, "Confidence", 95);
+	target_error = ini_file->ReadDouble(section, "TargetError", 3.0);
+	simpoints_file = ini_file->ReadString(section, "SimPoints");
+
+	// Integrity checks
+	if (fast_forward < 0 || functional_warming < 0 || detailed_warming < 0)
+		throw Error(misc::fmt("%s: Phase lengths must be positive", section.c_str()));
+	if (measurement < 1)
+		throw Error(misc::fmt("%s: Invalid value for 'Measurement'", section.c_str()));
+	if (max_samples < 0)
+		throw Error(misc::fmt("%s: Invalid value for 'MaxSamples'", section.c_str()));
+	if (confidence != 90 && confidence != 95 && confidence != 99)
+		throw Error(misc::fmt("%s: 'Confidence' must be 90, 95, or 99", section.c_str()));
+	if (target_error <= 0.0)
+		throw Error(misc::fmt("%s: Invalid value for 'TargetError'", section.c_str()));
+
+	// Simulation points
+	simpoints.clear();
+	simpoints_instructions = 0;
+	if (present && !simpoints_file.empty())
+		ReadSimPoints(simpoints_file);
+}
+
+
+void Sampling::ReadSimPoints(const std::string &path)
+{
+	// Load file
+	misc::IniFile ini_file;
+	try
+	{
+		ini_file.Load(path);
+	}
+	catch (misc::Error &e)
+	{
+		throw Error(misc::fmt("%s: Cannot read simulation points",
+				path.c_str()));
+	}
+
+	// General information
+	std::string section = "SimPoints";
+	simpoints_instructions = ini_file.ReadInt64(section, "Instructions", 0);
+	int num_points = ini_file.ReadInt(section, "Points", 0);
+	if (num_points < 1)
+		throw Error(misc::fmt("%s: No simulation points",
+				path.c_str()));
+
+	// Read points
+	for (int i = 0; i < num_points; i++)
+	{
+		section = misc::fmt("SimPoint %d", i);
+		SimPoint simpoint;
+		simpoint.start = ini_file.ReadInt64(section, "Start", -1);
+		simpoint.length = ini_file.ReadInt64(section, "Length", 0);
+		simpoint.weight = ini_file.ReadDouble(section, "Weight", 0.0);
+		if (simpoint.start < 0 || simpoint.length < 1 ||
+				simpoint.weight <= 0.0)
+			throw Error(misc::fmt("%s: Section [ %s ]: Invalid "
+					"simulation point", path.c_str(),
+					section.c_str()));
+		simpoints.push_back(simpoint);
+	}
+
+	// Sort by position
+	std::sort(simpoints.begin(), simpoints.end(),
+			[](const SimPoint &a, const SimPoint &b)
+			{
+				return a.start < b.start;
+			});
+}
+
+
+void Sampling::DumpConfiguration(std::ostream &os)
+{
+	os << "[ Config.Sampling ]\n";
+	os << misc::fmt("Present = %s\n", present ? "True" : "False");
+	os << misc::fmt("FastForward = %lld\n", fast_forward);
+	os << misc::fmt("FunctionalWarming = %lld\n", functional_warming);
+	os << misc::fmt("DetailedWarming = %lld\n", detailed_warming);
+	os << misc::fmt("Measurement = %lld\n", measurement);
+	os << misc::fmt("MaxSamples = %d\n", max_samples);
+	os << misc::fmt("Confidence = %d\n", confidence);
+	os << misc::fmt("TargetError = %.4g\n", target_error);
+	os << misc::fmt("SimPoints = %s\n", simpoints_file.c_str());
+	os << '\n';
+}
+
+
+Sampling::Sampling(Cpu *cpu) : cpu(cpu)
+{
+	// The first period starts by draining the pipelines. This keeps the
+	// fetch stage stalled during the first cycle, while contexts are
+	// allocated to hardware threads, so that functional simulation starts
+	// with empty pipelines.
+	phase = PhaseDrain;
+	cpu->setDraining(true);
+}
+
+
+void Sampling::StartPhase(Phase phase)
+{
+	this->phase = phase;
+	phase_instructions = cpu->getNumCommittedInstructions();
+	phase_cycle = cpu->getCycle();
+}
+
+
+long long Sampling::getNumInstructions() const
+{
+	return cpu->getNumCommittedInstructions()
+			+ num_functional_instructions
+			+ Cpu::getNumFastForwardInstructions();
+}
+
+
+bool Sampling::StartPeriod()
+{
+	// Periodic measurements
+	if (simpoints.empty())
+	{
+		period_fast_forward = fast_forward;
+		period_functional_warming = functional_warming;
+		period_measurement = measurement;
+		period_weight = 1.0;
+		return true;
+	}
+
+	// All simulation points simulated
+	if (next_simpoint >= simpoints.size())
+		return false;
+
+	// Fast-forward and warm up so that the measurement starts at the
+	// beginning of the simulation point. Warming phases are cut short if
+	// the previous period went past their beginning.
+	const SimPoint &simpoint = simpoints[next_simpoint++];
+	long long position = getNumInstructions();
+	long long detailed_start = simpoint.start - detailed_warming;
+	long long functional_start = detailed_start - functional_warming;
+	period_fast_forward = std::max(0LL, functional_start - position);
+	period_functional_warming = std::max(0LL, detailed_start
+			- std::max(position, functional_start));
+	period_measurement = simpoint.length;
+	period_weight = simpoint.weight;
+	return true;
+}
+
+
+void Sampling::RunFunctional(long long num_instructions, bool warm)
+{
+	// Stop when the maximum number of instructions is reached
+	long long max_instructions = Emulator::getMaxInstructions();
+	if (max_instructions)
+		num_instructions = std::min(num_instructions,
+				std::max(0LL, max_instructions - getNumInstructions()));
+
+	// Run instructions
+	num_functional_instructions += cpu->RunFunctional(num_instructions,
+			warm);
+}
+
+
+void Sampling::Run()
+{
+	switch (phase)
+	{
+
+	case PhaseDetailedWarming:
+
+		// Start measurement after enough committed instructions
+		if (cpu->getNumCommittedInstructions() - phase_instructions
+				>= detailed_warming)
+			StartPhase(PhaseMeasurement);
+		break;
+
+	case PhaseMeasurement:
+	{
+		// Measurement not complete yet
+		long long instructions = cpu->getNumCommittedInstructions()
+				- phase_instructions;
+		if (instructions < period_measurement)
+			break;
+
+		// Record sample
+		samples.push_back({ instructions, cpu->getCycle() - phase_cycle,
+				period_weight });
+
+		// Stop simulation after the last sample
+		if (max_samples && getNumSamples() >= max_samples)
+		{
+			esim::Engine *esim_engine = esim::Engine::getInstance();
+			esim_engine->Finish("X86MaxSamples");
+			break;
+		}
+
+		// Drain pipelines before switching to functional simulation
+		cpu->setDraining(true);
+		StartPhase(PhaseDrain);
+		break;
+	}
+
+	case PhaseDrain:
+
+		// Wait until nothing is in flight
+		if (!cpu->isDrained())
+			break;
+
+		// Start next period right away, before the fetch stage has a
+		// chance to run again.
+		cpu->setDraining(false);
+		if (!StartPeriod())
+		{
+			esim::Engine *esim_engine = esim::Engine::getInstance();
+			esim_engine->Finish("X86SimPoints");
+			break;
+		}
+		StartPhase(PhaseFastForward);
+
+		// Fall through
+
+	case PhaseFastForward:
+
+		// Functional simulation with no warming
+		RunFunctional(period_fast_forward, false);
+		StartPhase(PhaseFunctionalWarming);
+
+		// Fall through
+
+	case PhaseFunctionalWarming:
+
+		// Functional simulation warming caches and branch predictors
+		RunFunctional(period_functional_warming, true);
+
+		// Resume fetching where functional simulation stopped
+		for (int i = 0; i < Cpu::getNumCores(); i++)
+			for (int j = 0; j < Cpu::getNumThreads(); j++)
+				cpu->getThread(i, j)->ResetFetch();
+
+		// Start detailed simulation
+		StartPhase(PhaseDetailedWarming);
+		break;
+
+	default:
+
+		throw misc::Panic("Invalid sampling phase");
+	}
+}
+
+
+double Sampling::getZ() const
+{
+	switch (confidence)
+	{
+	case 90: return 1.645;
+	case 95: return 1.960;
+	case 99: return 2.576;
+	default: throw misc::Panic("Invalid confidence level");
+	}
+}
+
+
+double Sampling::getMeanCpi() const
+{
+	// No samples
+	if (samples.empty())
+		return 0.0;
+
+	// Weighted average CPI of all samples
+	double sum = 0.0;
+	double weights = 0.0;
+	for (const Sample &sample : samples)
+	{
+		sum += sample.weight * sample.cycles / sample.instructions;
+		weights += sample.weight;
+	}
+	return sum / weights;
+}
+
+
+double Sampling::getCpiStandardDeviation() const
+{
+	// At least two samples are needed
+	if (samples.size() < 2)
+		return 0.0;
+
+	// Sample standard deviation, with the squared deviations weighted
+	// like the samples in the mean. The correction of the denominator
+	// reduces to n - 1 when all weights are equal.
+	double mean = getMeanCpi();
+	double sum = 0.0;
+	double weights = 0.0;
+	double squared_weights = 0.0;
+	for (const Sample &sample : samples)
+	{
+		double cpi = (double) sample.cycles / sample.instructions;
+		sum += sample.weight * (cpi - mean) * (cpi - mean);
+		weights += sample.weight;
+		squared_weights += sample.weight * sample.weight;
+	}
+	double denominator = weights - squared_weights / weights;
+	if (denominator <= 0.0)
+		return 0.0;
+	return std::sqrt(sum / denominator);
+}
+
+
+double Sampling::getCpiConfidenceInterval() const
+{
+	// No samples
+	if (samples.empty())
+		return 0.0;
+
+	// Half-width of the interval around the mean
+	return getZ() * getCpiStandardDeviation() / std::sqrt(samples.size());
+}
+
+
+long long Sampling::getNumRequiredSamples() const
+{
+	// No estimate of the variation yet
+	double mean = getMeanCpi();
+	if (mean == 0.0)
+		return 0;
+
+	// n = (z * V / e)^2, with V the coefficient of variation
+	double variation = getCpiStandardDeviation() / mean;
+	double n = getZ() * variation / (target_error / 100.0);
+	return (long long) std::ceil(n * n);
+}
+
+
+void Sampling::DumpSummary(std::ostream &os) const
+{
+	double cpi = getMeanCpi();
+	double interval = getCpiConfidenceInterval();
+	os << misc::fmt("FunctionalInstructions = %lld\n", num_functional_instructions);
+	os << misc::fmt("Samples = %d\n", getNumSamples());
+	os << misc::fmt("SampledCPI = %.4g\n", cpi);
+	if (simpoints.empty())
+		os << misc::fmt("SampledCPIError = %.4g [%d%% confidence]\n",
+				interval, confidence);
+	os << misc::fmt("SampledIPC = %.4g\n", cpi > 0.0 ? 1.0 / cpi : 0.0);
+	if (!simpoints.empty())
+		os << misc::fmt("EstimatedCycles = %.0f\n",
+				cpi * simpoints_instructions);
+}
+
+
+void Sampling::DumpReport(std::ostream &os) const
+{
+	// Estimates
+	double cpi = getMeanCpi();
+	double deviation = getCpiStandardDeviation();
+	double interval = getCpiConfidenceInterval();
+	os << "; Sampling\n";
+	os << ";    CPI - Mean CPI of all samples\n";
+	os << ";    CPIError - Half-width of the confidence interval of the CPI\n";
+	os << ";    Variation - Coefficient of variation of the samples' CPI\n";
+	os << ";    RequiredSamples - Samples needed for the target error\n";
+	os << ";    EstimatedCycles - Cycles of the execution represented by the\n";
+	os << ";        simulation points, estimated from the weighted CPI\n";
+	os << ";    Sample[i] - Instructions, cycles, and weight of each sample\n";
+	os << "[ Sampling ]\n";
+	os << misc::fmt("Phase = %s\n", phase_map[phase]);
+	os << misc::fmt("FunctionalInstructions = %lld\n", num_functional_instructions);
+	os << misc::fmt("Samples = %d\n", getNumSamples());
+	os << misc::fmt("CPI = %.4g\n", cpi);
+	os << misc::fmt("IPC = %.4g\n", cpi > 0.0 ? 1.0 / cpi : 0.0);
+	os << misc::fmt("CPIStdDev = %.4g\n", deviation);
+	os << misc::fmt("CPIError = %.4g\n", interval);
+	os << misc::fmt("RelativeError = %.4g\n", cpi > 0.0 ? interval / cpi : 0.0);
+	os << misc::fmt("Variation = %.4g\n", cpi > 0.0 ? deviation / cpi : 0.0);
+	os << misc::fmt("RequiredSamples = %lld\n", getNumRequiredSamples());
+	if (!simpoints.empty())
+	{
+		os << misc::fmt("SimPoints = %d\n", (int) simpoints.size());
+		os << misc::fmt("EstimatedCycles = %.0f\n",
+				cpi * simpoints_instructions);
+	}
+
+	// Individual samples
+	for (int i = 0; i < getNumSamples(); i++)
+		os << misc::fmt("Sample[%d] = %lld %lld %.4g\n", i,
+				samples[i].instructions,
+				samples[i].cycles,
+				samples[i].weight);
+	os << '\n';
+}
+
+}
+
@@ -0,0 +1,271 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef ARCH_X86_TIMING_SAMPLING_H
+#define ARCH_X86_TIMING_SAMPLING_H
+
+#include <iostream>
+#include <vector>
+
+#include <lib/cpp/Error.h>
+#include <lib/cpp/IniFile.h>
+#include <lib/cpp/String.h>
+
+
+namespace x86
+{
+
+// Forward declarations
+class Cpu;
+
+/// Statistical sampling of the detailed simulation. The execution is
+/// divided in periods, each of them composed of a functional fast-forward
+/// phase, a functional warming phase where caches and branch predictors
+/// are updated, a detailed warming phase, a measurement phase, and a final
+/// phase where the pipelines are drained. The CPI of every measurement is
+/// recorded as one sample, and the samples are used to estimate the CPI of
+/// the whole execution together with its confidence interval.
+///
+/// Alternatively, the measurements can be placed on a list of weighted
+/// simulation points selected offline from basic block vectors. Each period
+/// then fast-forwards up to the next simulation point, and the CPI of the
+/// execution is estimated as the weighted average of the samples.
+class Sampling
+{
+public:
+
+	/// Phases of a sampling period
+	enum Phase
+	{
+		PhaseInvalid = 0,
+		PhaseFastForward,
+		PhaseFunctionalWarming,
+		PhaseDetailedWarming,
+		PhaseMeasurement,
+		PhaseDrain
+	};
+
+	/// String map for values of type Phase
+	static const misc::StringMap phase_map;
+
+	/// Exception for the x86 sampled simulation
+	class Error : public misc::Error
+	{
+	public:
+
+		Error(const std::string &message) : misc::Error(message)
+		{
+			AppendPrefix("X86 sampling");
+		}
+	};
+
+private:
+
+	//
+	// Static fields
+	//
+
+	// Flag indicating whether sampling is enabled
+	static bool present;
+
+	// Number of instructions executed functionally with no warming at
+	// the beginning of each period
+	static long long fast_forward;
+
+	// Number of instructions executed functionally while warming up
+	// caches and branch predictors
+	static long long functional_warming;
+
+	// Number of instructions committed in detailed simulation before
+	// starting a measurement
+	static long long detailed_warming;
+
+	// Number of committed instructions in each measurement
+	static long long measurement;
+
+	// Maximum number of samples, or 0 for no limit
+	static int max_samples;
+
+	// Confidence level, given in percentage
+	static int confidence;
+
+	// Target relative error of the CPI estimate
+	static double target_error;
+
+	// One simulation point
+	struct SimPoint
+	{
+		// Position of the first instruction of the simulation point in
+		// the dynamic instruction stream
+		long long start;
+
+		// Number of instructions of the simulation point
+		long long length;
+
+		// Fraction of the execution represented by the point
+		double weight;
+	};
+
+	// File with the simulation points
+	static std::string simpoints_file;
+
+	// Simulation points, sorted by position. If empty, measurements are
+	// taken periodically.
+	static std::vector<SimPoint> simpoints;
+
+	// Total number of instructions of the execution represented by the
+	// simulation points
+	static long long simpoints_instructions;
+
+	// Read the simulation points from a file
+	static void ReadSimPoints(const std::string &path);
+
+
+
+
+	//
+	// Class members
+	//
+
+	// Associated CPU
+	Cpu *cpu;
+
+	// Current phase
+	Phase phase;
+
+	// Number of committed instructions and cycle when the current phase
+	// started
+	long long phase_instructions = 0;
+	long long phase_cycle = 0;
+
+	// Number of instructions executed out of the detailed simulation
+	long long num_functional_instructions = 0;
+
+	// Lengths of the phases and weight of the sample in the current period
+	long long period_fast_forward = 0;
+	long long period_functional_warming = 0;
+	long long period_measurement = 0;
+	double period_weight = 0.0;
+
+	// Index of the next simulation point
+	unsigned next_simpoint = 0;
+
+	// One measurement
+	struct Sample
+	{
+		long long instructions;
+		long long cycles;
+		double weight;
+	};
+
+	// Recorded samples
+	std::vector<Sample> samples;
+
+	// Switch to a new phase
+	void StartPhase(Phase phase);
+
+	// Compute the lengths of the phases of the next period. The function
+	// returns false if all simulation points have been simulated.
+	bool StartPeriod();
+
+	// Return the number of instructions executed so far, both in
+	// functional and detailed simulation
+	long long getNumInstructions() const;
+
+	// Execute the given number of instructions functionally with
+	// Cpu::RunFunctional(), without exceeding the maximum number of
+	// instructions, and count them as functional instructions.
+	void RunFunctional(long long num_instructions, bool warm);
+
+	// Return the value of the standard normal distribution for the
+	// configured confidence level
+	double getZ() const;
+
+public:
+
+	//
+	// Static members
+	//
+
+	/// Read the configuration from section [ Sampling ] of the x86 CPU
+	/// configuration file.
+	static void ParseConfiguration(misc::IniFile *ini_file);
+
+	/// Dump the sampling configuration
+	static void DumpConfiguration(std::ostream &os = std::cout);
+
+	/// Return whether sampling is enabled
+	static bool isPresent() { return present; }
+
+	/// Return whether measurements are placed on simulation points
+	static bool hasSimPoints() { return !simpoints.empty(); }
+
+
+
+
+	//
+	// Class members
+	//
+
+	/// Constructor
+	Sampling(Cpu *cpu);
+
+	/// Advance the sampling state machine. This function is invoked by
+	/// the timing simulator after every simulation cycle. Functional
+	/// phases are run to completion within one call.
+	void Run();
+
+	/// Return the current phase
+	Phase getPhase() const { return phase; }
+
+	/// Return the number of instructions executed functionally
+	long long getNumFunctionalInstructions() const
+	{
+		return num_functional_instructions;
+	}
+
+	/// Return the number of samples collected so far
+	int getNumSamples() const { return samples.size(); }
+
+	/// Return the mean CPI across all samples, weighted by the weights of
+	/// the simulation points, if any.
+	double getMeanCpi() const;
+
+	/// Return the standard deviation of the CPI across all samples,
+	/// weighted like the mean.
+	double getCpiStandardDeviation() const;
+
+	/// Return the half-width of the confidence interval of the mean CPI
+	double getCpiConfidenceInterval() const;
+
+	/// Return the number of samples needed to reach the target error with
+	/// the configured confidence, given the variation observed so far.
+	long long getNumRequiredSamples() const;
+
+	/// Dump the estimates into the statistics summary
+	void DumpSummary(std::ostream &os) const;
+
+	/// Dump a report with the estimates and all samples
+	void DumpReport(std::ostream &os) const;
+};
+
+}
+
+#endif
+
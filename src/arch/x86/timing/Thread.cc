@@ -17,6 +17,8 @@
  *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <algorithm>
+
 #include "Cpu.h"
 #include "Timing.h"
 #include "Thread.h"
@@ -33,7 +35,8 @@ const misc::StringMap Thread::fetch_stall_map =
 	{ "Context", FetchStallContext },
 	{ "Suspended", FetchStallSuspended },
 	{ "FetchQueue", FetchStallFetchQueue },
-	{ "InstructionMemory", FetchStallInstructionMemory }
+	{ "InstructionMemory", FetchStallInstructionMemory },
+	{ "Drain", FetchStallDrain }
 };
 
 
@@ -51,10 +54,32 @@ const misc::StringMap Thread::dispatch_stall_map =
 };
 
 
+const misc::StringMap Thread::commit_stall_map =
+{
+	{ "Invalid", CommitStallInvalid },
+	{ "Used", CommitStallUsed },
+	{ "Context", CommitStallContext },
+	{ "InstructionCache", CommitStallInstructionCache },
+	{ "FrontEnd", CommitStallFrontEnd },
+	{ "BranchMispredict", CommitStallBranchMispredict },
+	{ "ReorderBuffer", CommitStallReorderBuffer },
+	{ "Execution", CommitStallExecution },
+	{ "Store", CommitStallStore },
+	{ "L1", CommitStallL1 },
+	{ "L2", CommitStallL2 },
+	{ "Llc", CommitStallLlc },
+	{ "Memory", CommitStallMemory },
+	{ "Thread", CommitStallThread }
+};
+
+
 Thread::Thread(Core *core,
 		int id_in_core) :
 		core(core),
-		id_in_core(id_in_core)
+		id_in_core(id_in_core),
+		fetch_queue(Cpu::getFetchQueueSize()),
+		uop_queue(Cpu::getUopQueueSize()),
+		reorder_buffer(Cpu::getReorderBufferSize())
 {
 	// Assign name
 	name = misc::fmt("Core %d Thread %d", core->getId(), id_in_core);
@@ -69,11 +94,24 @@ Thread::Thread(Core *core,
 	branch_predictor = misc::new_unique<BranchPredictor>(name +
 			".BranchPredictor");
 
+	// Initialize memory dependence predictor
+	memory_dependence_predictor = misc::new_unique<MemoryDependencePredictor>(
+			name + ".MemoryDependencePredictor");
+
 	// Initialize trace cache
 	if (TraceCache::isPresent())
 		trace_cache = misc::new_unique<TraceCache>(name +
 				".TraceCache");
 
+	// Initialize uop cache
+	if (UopCache::isPresent())
+		uop_cache = misc::new_unique<UopCache>(name + ".UopCache");
+
+	// Initialize loop stream detector
+	if (LoopStreamDetector::isPresent())
+		loop_stream_detector = misc::new_unique<LoopStreamDetector>(
+				name + ".LoopStreamDetector");
+
 	// Initialize register file
 	register_file = misc::new_unique<RegisterFile>(this);
 }
@@ -103,14 +141,33 @@ void Thread::Dump(std::ostream &os) const
 }
 
 
-void Thread::InsertInFetchQueue(std::shared_ptr<Uop> uop)
+bool Thread::isDrained() const
+{
+	// Pipeline queues
+	if (!isPipelineEmpty() || !load_queue.empty() || !store_queue.empty())
+		return false;
+
+	// In-flight accesses to the memory hierarchy
+	if (instruction_module && instruction_module->getAccessListBegin() !=
+			instruction_module->getAccessListEnd())
+		return false;
+	if (data_module && data_module->getAccessListBegin() !=
+			data_module->getAccessListEnd())
+		return false;
+
+	// Nothing in flight
+	return true;
+}
+
+
+void Thread::InsertInFetchQueue(misc::SlabPtr<Uop> uop)
 {
 	// Sanity
 	assert(!uop->in_fetch_queue);
 
 	// Insert in queue
 	uop->in_fetch_queue = true;
-	uop->fetch_queue_iterator = fetch_queue.insert(fetch_queue.end(), uop);
+	fetch_queue.PushBack(uop);
 
 	// Increase occupancy of fetch queue or trace queue
 	if (uop->from_trace_cache)
@@ -119,6 +176,17 @@ void Thread::InsertInFetchQueue(std::shared_ptr<Uop> uop)
 		// inserted in it.
 		trace_cache_queue_occupancy++;
 	}
+	else if (uop->from_uop_cache)
+	{
+		// Uop cache queue occupancy is increased by 1 for each uop
+		uop_cache_queue_occupancy++;
+	}
+	else if (uop->from_loop_stream_detector)
+	{
+		// Loop stream detector queue occupancy is increased by 1 for
+		// each uop
+		loop_stream_detector_queue_occupancy++;
+	}
 	else
 	{
 		// Fetch queue occupancy is increased by the number of bytes
@@ -135,17 +203,12 @@ void Thread::ExtractFromFetchQueue(Uop *uop)
 	// Sanity: uop must be in the fetch queue, and must be either the first
 	// or the last element in it.
 	assert(uop->in_fetch_queue);
-	assert(uop->fetch_queue_iterator != fetch_queue.end());
-	assert(fetch_queue.size() > 0);
-	assert(uop == fetch_queue.front().get() ||
-			uop == fetch_queue.back().get());
+	assert(fetch_queue.getSize() > 0);
+	assert(uop == fetch_queue.Front().get() ||
+			uop == fetch_queue.Back().get());
 	
-	// Save iterator
-	auto it = uop->fetch_queue_iterator;
-
 	// Mark uop as extracted
 	uop->in_fetch_queue = false;
-	uop->fetch_queue_iterator = fetch_queue.end();
 
 	// Decrease occupancy of fetch queue or trace queue
 	if (uop->from_trace_cache)
@@ -155,6 +218,16 @@ void Thread::ExtractFromFetchQueue(Uop *uop)
 		assert(trace_cache_queue_occupancy > 0);
 		trace_cache_queue_occupancy--;
 	}
+	else if (uop->from_uop_cache)
+	{
+		assert(uop_cache_queue_occupancy > 0);
+		uop_cache_queue_occupancy--;
+	}
+	else if (uop->from_loop_stream_detector)
+	{
+		assert(loop_stream_detector_queue_occupancy > 0);
+		loop_stream_detector_queue_occupancy--;
+	}
 	else
 	{
 		// Fetch queue occupancy is decreased by the number of bytes
@@ -168,7 +241,10 @@ void Thread::ExtractFromFetchQueue(Uop *uop)
 	}
 
 	// Extract uop as last step, since uop may be freed here
-	fetch_queue.erase(it);
+	if (uop == fetch_queue.Front().get())
+		fetch_queue.PopFront();
+	else
+		fetch_queue.PopBack();
 }
 
 
@@ -180,16 +256,14 @@ void Thread::DumpFetchQueue(std::ostream &os) const
 	os << std::string(title.size(), '-') << "\n\n";
 
 	// Dump content
-	int index = 0;
-	for (auto &uop : fetch_queue)
+	for (int index = 0; index < fetch_queue.getSize(); index++)
 	{
 		os << misc::fmt("%3d. ", index);
-		os << *uop << '\n';
-		index++;
+		os << *fetch_queue[index] << '\n';
 	}
 
 	// Empty list
-	if (fetch_queue.empty())
+	if (fetch_queue.isEmpty())
 		os << "-Empty-\n";
 
 	// End
@@ -197,11 +271,11 @@ void Thread::DumpFetchQueue(std::ostream &os) const
 }
 
 
-void Thread::InsertInUopQueue(std::shared_ptr<Uop> uop)
+void Thread::InsertInUopQueue(misc::SlabPtr<Uop> uop)
 {
 	assert(!uop->in_uop_queue);
 	uop->in_uop_queue = true;
-	uop->uop_queue_iterator = uop_queue.insert(uop_queue.end(), uop);
+	uop_queue.PushBack(uop);
 }
 
 
@@ -210,18 +284,18 @@ void Thread::ExtractFromUopQueue(Uop *uop)
 	// Sanity: uop must be in the uop queue, and must be either the first
 	// or the last element in it.
 	assert(uop->in_uop_queue);
-	assert(uop_queue.size() > 0);
-	assert(uop == uop_queue.front().get() || uop_queue.back().get());
-
-	// Save iterator
-	auto it = uop->uop_queue_iterator;
+	assert(uop_queue.getSize() > 0);
+	assert(uop == uop_queue.Front().get() ||
+			uop == uop_queue.Back().get());
 
 	// Mark uop as extracted
 	uop->in_uop_queue = false;
-	uop->uop_queue_iterator = uop_queue.end();
 
 	// Extract uop as last step, since this may free it
-	uop_queue.erase(it);
+	if (uop == uop_queue.Front().get())
+		uop_queue.PopFront();
+	else
+		uop_queue.PopBack();
 }
 
 
@@ -233,16 +307,14 @@ void Thread::DumpUopQueue(std::ostream &os) const
 	os << std::string(title.size(), '-') << "\n\n";
 
 	// Dump content
-	int index = 0;
-	for (auto &uop : uop_queue)
+	for (int index = 0; index < uop_queue.getSize(); index++)
 	{
 		os << misc::fmt("%3d. ", index);
-		os << *uop << '\n';
-		index++;
+		os << *uop_queue[index] << '\n';
 	}
 
 	// Empty list
-	if (uop_queue.empty())
+	if (uop_queue.isEmpty())
 		os << "-Empty-\n";
 
 	// End
@@ -260,7 +332,7 @@ bool Thread::canInsertInReorderBuffer()
 		// Return whether the number of instructions in this thread's
 		// ROB is smaller than the ROB size configured by the user,
 		// which is specified as a per-thread ROB size.
-		return (int) reorder_buffer.size() <
+		return reorder_buffer.getSize() <
 				Cpu::getReorderBufferSize();
 
 	case Cpu::ReorderBufferKindShared:
@@ -278,14 +350,15 @@ bool Thread::canInsertInReorderBuffer()
 }
 
 
-void Thread::InsertInReorderBuffer(std::shared_ptr<Uop> uop)
+void Thread::InsertInReorderBuffer(misc::SlabPtr<Uop> uop)
 {
 	// Sanity
 	assert(!uop->in_reorder_buffer);
 
 	// Insert into reorder buffer
 	uop->in_reorder_buffer = true;
-	uop->reorder_buffer_iterator = reorder_buffer.insert(reorder_buffer.end(), uop);
+	reorder_buffer.PushBack(uop);
+	recover_refill = false;
 
 	// Increase per-core counter
 	core->incReorderBufferOccupancy();
@@ -297,18 +370,18 @@ void Thread::ExtractFromReorderBuffer(Uop *uop)
 	// Sanity: uop must be in the reorder buffer, and must be either the
 	// first or the last instruction in that queue.
 	assert(uop->in_reorder_buffer);
-	assert(reorder_buffer.size() > 0);
-	assert(uop == reorder_buffer.front().get() || reorder_buffer.back().get());
-
-	// Save iterator
-	auto it = uop->reorder_buffer_iterator;
+	assert(reorder_buffer.getSize() > 0);
+	assert(uop == reorder_buffer.Front().get() ||
+			uop == reorder_buffer.Back().get());
 
 	// Mark uop as extracted
 	uop->in_reorder_buffer = false;
-	uop->reorder_buffer_iterator = reorder_buffer.end();
 
 	// Extract uop as last step, since this may free it
-	reorder_buffer.erase(it);
+	if (uop == reorder_buffer.Front().get())
+		reorder_buffer.PopFront();
+	else
+		reorder_buffer.PopBack();
 
 	// Decrease per-core counter
 	core->decReorderBufferOccupancy();
@@ -326,13 +399,12 @@ void Thread::DumpReorderBuffer(std::ostream &os) const
 	os << std::string(title.size(), '-') << "\n\n";
 
 	// Dump content
-	int index = 0;
-	for (auto &uop : reorder_buffer)
+	for (int index = 0; index < reorder_buffer.getSize(); index++)
 	{
 		// Instruction
+		Uop *uop = reorder_buffer[index].get();
 		os << misc::fmt("%3d. ", index);
 		os << *uop << '\n';
-		index++;
 
 		// Dispatched
 		if (uop->dispatched)
@@ -360,7 +432,7 @@ void Thread::DumpReorderBuffer(std::ostream &os) const
 	}
 
 	// Empty list
-	if (reorder_buffer.empty())
+	if (reorder_buffer.isEmpty())
 		os << "-Empty-\n";
 
 	// End
@@ -396,7 +468,7 @@ bool Thread::canInsertInInstructionQueue()
 }
 
 
-void Thread::InsertInInstructionQueue(std::shared_ptr<Uop> uop)
+void Thread::InsertInInstructionQueue(misc::SlabPtr<Uop> uop)
 {
 	// Sanity
 	assert(!uop->in_instruction_queue);
@@ -488,7 +560,7 @@ bool Thread::canInsertInLoadStoreQueue()
 }
 
 
-void Thread::InsertInLoadStoreQueue(std::shared_ptr<Uop> uop)
+void Thread::InsertInLoadStoreQueue(misc::SlabPtr<Uop> uop)
 {
 	// Sanity
 	assert(!uop->in_load_queue);
@@ -505,10 +577,22 @@ void Thread::InsertInLoadStoreQueue(std::shared_ptr<Uop> uop)
 		break;
 
 	case Uinst::OpcodeStore:
-
+	{
 		uop->store_queue_iterator = store_queue.insert(store_queue.end(), uop);
 		uop->in_store_queue = true;
+
+		// Index store by the blocks it writes to
+		unsigned first_block;
+		unsigned last_block;
+		getStoreQueueIndexBlocks(uop.get(), first_block, last_block);
+		store_queue_index.emplace(first_block, uop);
+		if (last_block != first_block)
+			store_queue_index.emplace(last_block, uop);
+
+		// Address not resolved yet
+		unresolved_stores.emplace(uop->getId(), uop.get());
 		break;
+	}
 	
 	default:
 
@@ -549,6 +633,28 @@ void Thread::ExtractFromStoreQueue(Uop *uop)
 	assert(!uop->in_load_queue);
 	assert(uop->in_store_queue);
 
+	// Remove from the index
+	auto remove_from_index = [this, uop](unsigned block)
+	{
+		auto range = store_queue_index.equal_range(block);
+		for (auto it = range.first; it != range.second; ++it)
+		{
+			if (it->second.get() == uop)
+			{
+				store_queue_index.erase(it);
+				return;
+			}
+		}
+		throw misc::Panic("Store not found in store queue index");
+	};
+	unsigned first_block;
+	unsigned last_block;
+	getStoreQueueIndexBlocks(uop, first_block, last_block);
+	remove_from_index(first_block);
+	if (last_block != first_block)
+		remove_from_index(last_block);
+	unresolved_stores.erase(uop->getId());
+
 	// Save iterator
 	auto it = uop->store_queue_iterator;
 
@@ -564,6 +670,16 @@ void Thread::ExtractFromStoreQueue(Uop *uop)
 }
 
 
+void Thread::getStoreQueueIndexBlocks(Uop *uop, unsigned &first_block,
+		unsigned &last_block) const
+{
+	unsigned block_size = data_module->getBlockSize();
+	unsigned size = std::max(uop->getUinst()->getSize(), 1);
+	first_block = uop->physical_address / block_size;
+	last_block = (uop->physical_address + size - 1) / block_size;
+}
+
+
 void Thread::DumpLoadStoreQueue(std::ostream &os) const
 {
 	// Load queue
@@ -21,16 +21,22 @@
 #define ARCH_X86_TIMING_THREAD_H
 
 #include <deque>
+#include <map>
 #include <string>
+#include <unordered_map>
 
+#include <lib/cpp/RingBuffer.h>
 #include <memory/Module.h>
 #include <arch/x86/emulator/Uinst.h>
 #include <arch/x86/emulator/Context.h>
 
 #include "Uop.h"
 #include "BranchPredictor.h"
+#include "MemoryDependencePredictor.h"
 #include "RegisterFile.h"
+#include "LoopStreamDetector.h"
 #include "TraceCache.h"
+#include "UopCache.h"
 
 
 namespace x86
@@ -44,6 +50,30 @@ class Timing;
 /// X86 Thread
 class Thread
 {
+public:
+
+	/// Category of the CPI stack that a commit slot is attributed to.
+	/// Slots not used by a committed uop are attributed to the reason
+	/// why the uop at the head of the reorder buffer cannot commit.
+	enum CommitStall
+	{
+		CommitStallInvalid = 0,
+		CommitStallUsed,		// Used by a committed uop
+		CommitStallContext,		// No running context
+		CommitStallInstructionCache,	// Empty ROB, fetch waits for instruction cache
+		CommitStallFrontEnd,		// Empty ROB, front-end delivers no uops
+		CommitStallBranchMispredict,	// Mispredicted path, or ROB refilling after it
+		CommitStallReorderBuffer,	// Head executing, and ROB full
+		CommitStallExecution,		// Head waiting for operands or functional units
+		CommitStallStore,		// Head is a store waiting for its operands
+		CommitStallL1,			// Head is a load served by the L1 cache
+		CommitStallL2,			// Head is a load served by the L2 cache
+		CommitStallLlc,			// Head is a load served by a lower-level cache
+		CommitStallMemory,		// Head is a load served by main memory
+		CommitStallThread,		// Head ready, slot taken by other threads
+		CommitStallMax
+	};
+
 private:
 
 	// Name, assigned in constructor
@@ -81,11 +111,11 @@ private:
 	// Fetch queue
 	//
 
-	// Fetch queue
-	std::list<std::shared_ptr<Uop>> fetch_queue;
+	// Fetch queue, initially sized for one uop per byte of capacity
+	misc::RingBuffer<misc::SlabPtr<Uop>> fetch_queue;
 
 	// Insert a uop into the tail of the fetch queue
-	void InsertInFetchQueue(std::shared_ptr<Uop> uop);
+	void InsertInFetchQueue(misc::SlabPtr<Uop> uop);
 
 	// Extract a uop from the fetch queue. The uop must be located either
 	// at the head or at the tail of the fetch queue.
@@ -101,11 +131,11 @@ private:
 	// Uop queue
 	//
 
-	// Uop queue
-	std::list<std::shared_ptr<Uop>> uop_queue;
+	// Uop queue, sized with the uop queue capacity
+	misc::RingBuffer<misc::SlabPtr<Uop>> uop_queue;
 
 	// Insert a uop into the tail of the uop queue
-	void InsertInUopQueue(std::shared_ptr<Uop> uop);
+	void InsertInUopQueue(misc::SlabPtr<Uop> uop);
 
 	// Extract a uop from the uop queue. The uop must be located either at
 	// the head or at the tail of the uop queue.
@@ -121,11 +151,11 @@ private:
 	// Reorder buffer
 	//
 
-	// Reorder buffer
-	std::list<std::shared_ptr<Uop>> reorder_buffer;
+	// Reorder buffer, sized with the per-thread reorder buffer capacity
+	misc::RingBuffer<misc::SlabPtr<Uop>> reorder_buffer;
 
 	// Insert a uop into the tail of the reorder buffer
-	void InsertInReorderBuffer(std::shared_ptr<Uop> uop);
+	void InsertInReorderBuffer(misc::SlabPtr<Uop> uop);
 
 	// Determine whether a new uop can be inserted into this thread's
 	// reorder buffer, based on whether it is private or shared among
@@ -148,10 +178,10 @@ private:
 	//
 
 	// Instruction queue
-	std::list<std::shared_ptr<Uop>> instruction_queue;
+	std::list<misc::SlabPtr<Uop>> instruction_queue;
 
 	// Insert a uop into the tail of the instruction queue
-	void InsertInInstructionQueue(std::shared_ptr<Uop> uop);
+	void InsertInInstructionQueue(misc::SlabPtr<Uop> uop);
 
 	// Remove a uop from the instruction queue. The uop must be currently
 	// present in said queue.
@@ -173,10 +203,38 @@ private:
 	//
 	
 	// Load queue
-	std::list<std::shared_ptr<Uop>> load_queue;
+	std::list<misc::SlabPtr<Uop>> load_queue;
 
 	// Store queue
-	std::list<std::shared_ptr<Uop>> store_queue;
+	std::list<misc::SlabPtr<Uop>> store_queue;
+
+	// Stores in the store queue indexed by the data memory blocks they
+	// write to. A store crossing a block boundary is present in the entry
+	// of both blocks. This lets loads find older stores to the same
+	// location without traversing the whole store queue.
+	std::unordered_multimap<unsigned, misc::SlabPtr<Uop>> store_queue_index;
+
+	// Stores in the store queue that have not resolved their address yet,
+	// ordered by uop identifier. A store is removed the first time it is
+	// found resolved, so loads check for older unresolved stores without
+	// traversing the store queue.
+	std::map<long long, Uop *> unresolved_stores;
+
+	// Load issued to the memory hierarchy before an older store writing to
+	// the same location had resolved its address
+	struct MemoryDependence
+	{
+		misc::SlabPtr<Uop> load;
+		misc::SlabPtr<Uop> store;
+	};
+
+	// Memory dependences violated by loads that issued speculatively, which
+	// are detected as soon as the store resolves its address
+	std::list<MemoryDependence> memory_dependences;
+
+	// Return the first and last data memory blocks accessed by a memory uop
+	void getStoreQueueIndexBlocks(Uop *uop, unsigned &first_block,
+			unsigned &last_block) const;
 
 	// Determine whether a new uop can be inserted into this thread's
 	// load-store queue, based on whether the queue was configured as
@@ -186,7 +244,7 @@ private:
 	// Insert a uop into the tail of the load-store queue (it is in fact
 	// inserted either at the tail of the load queue or the store queue,
 	// depending on the uop kind).
-	void InsertInLoadStoreQueue(std::shared_ptr<Uop> uop);
+	void InsertInLoadStoreQueue(misc::SlabPtr<Uop> uop);
 
 	// Remove a uop from the load queue. The uop must be currently present
 	// in said queue.
@@ -209,9 +267,18 @@ private:
 	// Branch predictor
 	std::unique_ptr<BranchPredictor> branch_predictor;
 
+	// Memory dependence predictor
+	std::unique_ptr<MemoryDependencePredictor> memory_dependence_predictor;
+
 	// Trace cache
 	std::unique_ptr<TraceCache> trace_cache;
 
+	// Uop cache
+	std::unique_ptr<UopCache> uop_cache;
+
+	// Loop stream detector
+	std::unique_ptr<LoopStreamDetector> loop_stream_detector;
+
 	// Physical register file
 	std::unique_ptr<RegisterFile> register_file;
 
@@ -228,6 +295,12 @@ private:
 	// Current occupancy of the trace cache queue in bytes
 	int trace_cache_queue_occupancy = 0;
 
+	// Current occupancy of the uop cache queue in uops
+	int uop_cache_queue_occupancy = 0;
+
+	// Current occupancy of the loop stream detector queue in uops
+	int loop_stream_detector_queue_occupancy = 0;
+
 	// Current instruction pointer
 	unsigned int fetch_eip = 0;
 	
@@ -253,6 +326,10 @@ private:
 	// Cycle in which last micro-instruction committed
 	long long last_commit_cycle = 0;
 
+	// Whether the reorder buffer is being refilled after a recovery from
+	// a misprediction, with no uop dispatched yet
+	bool recover_refill = false;
+
 
 
 
@@ -300,6 +377,19 @@ private:
 	// Number of mis-predicted branch micro-instructions
 	long long num_mispredicted_branches = 0;
 
+	// Number of committed x86 macro-instructions
+	long long num_committed_instructions = 0;
+
+	// Number of commit slots attributed to each category of the CPI
+	// stack, and number of committed uops already attributed
+	long long num_commit_slots[CommitStallMax] = {};
+	long long commit_slots_num_committed_uinsts = 0;
+
+	// Counters at the end of the last interval dumped in the CPI stack
+	// time series
+	long long interval_num_commit_slots[CommitStallMax] = {};
+	long long interval_num_committed_instructions = 0;
+
 
 
 
@@ -316,6 +406,9 @@ private:
 	long long num_load_store_queue_reads = 0;
 	long long num_load_store_queue_writes = 0;
 
+	long long num_forwarded_loads = 0;
+	long long num_memory_violations = 0;
+
 	long long num_integer_register_reads = 0;
 	long long num_integer_register_writes = 0;
 
@@ -348,10 +441,15 @@ public:
 	/// Return true if there is no uop in the pipeline for this thread
 	bool isPipelineEmpty() const
 	{
-		return fetch_queue.empty()
-				&& uop_queue.empty()
-				&& reorder_buffer.empty();
+		return fetch_queue.isEmpty()
+				&& uop_queue.isEmpty()
+				&& reorder_buffer.isEmpty();
 	}
+
+	/// Return true if the pipeline is empty, there are no pending loads or
+	/// stores, and no memory access is in flight in the thread's entry
+	/// modules to the memory hierarchy.
+	bool isDrained() const;
 	
 	/// Dump a plain-text representation of the object into the given output
 	/// stream, or into the standard output if argument \a os is committed.
@@ -376,6 +474,15 @@ public:
 	/// Return the thread's trace cache
 	TraceCache *getTraceCache() const { return trace_cache.get(); }
 
+	/// Get uop cache, or nullptr if not present
+	UopCache *getUopCache() const { return uop_cache.get(); }
+
+	/// Get loop stream detector, or nullptr if not present
+	LoopStreamDetector *getLoopStreamDetector() const
+	{
+		return loop_stream_detector.get();
+	}
+
 	/// Return the thread's register file
 	RegisterFile *getRegisterFile() const { return register_file.get(); }
 
@@ -412,12 +519,22 @@ public:
 		FetchStallContext,		// No context mapped to thread
 		FetchStallSuspended,		// Mapped context is suspended
 		FetchStallFetchQueue,		// Fetch queue is full
-		FetchStallInstructionMemory	// Instruction memory is busy
+		FetchStallInstructionMemory,	// Instruction memory is busy
+		FetchStallDrain			// Pipeline is being drained
 	};
 
 	/// String map for values of type FetchStall
 	static const misc::StringMap fetch_stall_map;
 
+	/// Front-end structure supplying fetched uops
+	enum FetchSource
+	{
+		FetchSourceInstructionCache = 0,
+		FetchSourceTraceCache,
+		FetchSourceUopCache,
+		FetchSourceLoopStreamDetector
+	};
+
 	/// Set the address in instruction memory used for the next instruction
 	/// fetch cycle.
 	void setFetchNeip(unsigned fetch_neip) { this->fetch_neip = fetch_neip; }
@@ -430,33 +547,45 @@ public:
 	/// its corresponding set of uops, which are stored at the end of the
 	/// fetch queue.
 	///
-	/// \param fetch_from_trace_cache
-	///	Flag indicating whether the uops for the fetched macro-
-	///	instruction are considered to come from the trace cache (true)
-	///	or from instruction memory (false).
+	/// \param fetch_source
+	///	Front-end structure that the uops for the fetched macro-
+	///	instruction are considered to come from.
 	///
 	/// \return
 	///	If any of the uops is a branch, the function returns that uop.
 	///	Otherwise, it returns the first uop created, or nullptr if no
 	///	uop was created.
 	///
-	Uop *FetchInstruction(bool fetch_from_trace_cache);
+	Uop *FetchInstruction(FetchSource fetch_source);
+
+	/// Look up the BTB and branch predictor for a fetched control uop. If
+	/// the branch is predicted taken, set the next fetch address to its
+	/// target and return true.
+	bool PredictFetchedBranch(Uop *uop);
 
 	/// Try to fetch instruction from trace cache.
 	/// Return true if there was a hit and fetching succeeded.
 	bool FetchFromTraceCache();
 
+	/// Try to fetch decoded uops from the uop cache. Return true if the
+	/// next fetch address hit in the uop cache.
+	bool FetchFromUopCache();
+
+	/// Try to stream the uops of a loop locked in the loop stream
+	/// detector. Return true if the next fetch address belongs to it.
+	bool FetchFromLoopStreamDetector();
+
 	/// Fetch stage function
 	void Fetch();
 
 	/// Get the fetch queue size in number of uops
-	int getFetchQueueSize() const { return fetch_queue.size(); }
+	int getFetchQueueSize() const { return fetch_queue.getSize(); }
 
 	/// Get the fetch queue occupancy
 	int getFetchQueueOccupency() const { return fetch_queue_occupancy; }
 
 	/// Get the uop queue size in number of uops
-	int getUopQueueSize() const { return uop_queue.size(); }
+	int getUopQueueSize() const { return uop_queue.getSize(); }
 
 
 
@@ -511,6 +640,25 @@ public:
 	// Issue stage (ThreadIssue.cc)
 	//
 
+	/// Return the youngest store in the store queue older than the given
+	/// load that writes to any of the bytes read by it, or `nullptr` if
+	/// there is none.
+	misc::SlabPtr<Uop> FindOlderStore(Uop *uop);
+
+	/// Return whether there is any store in the store queue older than
+	/// the given load whose address has not been resolved yet.
+	bool hasUnresolvedOlderStore(Uop *uop);
+
+	/// Return the level of the given module in the data memory hierarchy
+	/// of the thread for the given physical address, or
+	/// Uop::MemoryLevelInvalid if \a module is \c nullptr.
+	Uop::MemoryLevel getMemoryLevel(mem::Module *module,
+			unsigned physical_address);
+
+	/// Check whether the stores of pending memory dependences resolved
+	/// their address, recovering from the memory ordering violations.
+	void CheckMemoryDependences();
+
 	/// Issue \a quantum instructions for the thread's load queue, returning
 	/// the remaining qunatum.
 	int IssueLoadQueue(int quantum);
@@ -538,15 +686,67 @@ public:
 	/// Error message for stalls
 	static const char *commit_stall_error;
 
+	/// String map for values of type CommitStall
+	static const misc::StringMap commit_stall_map;
+
 	/// Return true if at least one uop can be committed for the thread
 	bool canCommit();
 
+	/// Return whether the uop at the head of the reorder buffer is ready
+	/// to commit
+	bool isReadyToCommit(Uop *uop);
+
+	/// Return the category of the CPI stack that the commit slots not
+	/// used by the thread in the current cycle are attributed to
+	CommitStall getCommitStall();
+
+	/// Attribute the commit slots of the thread in the current cycle to
+	/// the categories of the CPI stack. This is invoked once per cycle
+	/// after the commit stage.
+	void UpdateCommitSlots();
+
+	/// Return the number of commit slots attributed to a category
+	long long getNumCommitSlots(CommitStall stall) const
+	{
+		assert(stall > CommitStallInvalid && stall < CommitStallMax);
+		return num_commit_slots[stall];
+	}
+
+	/// Return the number of committed x86 macro-instructions
+	long long getNumCommittedInstructions() const
+	{
+		return num_committed_instructions;
+	}
+
+	/// Dump one line of the CPI stack time series, with the contribution
+	/// of each category to the CPI of the thread since the last call.
+	void DumpCpiStackInterval(std::ostream &os);
+
 	/// Commit stage for the thread
 	void Commit(int quantum);
 
 
 
 	
+	//
+	// Functional warming (ThreadWarm.cc)
+	//
+
+	/// Execute one macro-instruction of the allocated context outside of
+	/// the pipeline, and use it to warm up the instruction and data
+	/// caches and the branch predictor. This is used when the timing
+	/// simulation is skipped, for example in the functional warming
+	/// phases of a sampled simulation.
+	void Warm();
+
+	/// Restart fetching at the current instruction pointer of the
+	/// allocated context. This must be invoked after the context ran
+	/// outside of the pipeline, once the pipeline has been drained.
+	void ResetFetch();
+
+
+
+	
 	//
 	// Recovery from mispeculation (ThreadRecover.cc)
 	//
@@ -569,6 +769,12 @@ public:
 	/// Squash mispredicted instructions in event queue
 	void RecoverEventQueue();
 
+	/// Recover from a load that issued before an older store writing to
+	/// the same location. Since instructions are emulated at fetch, the
+	/// replay of the load and its younger instructions is modeled as a
+	/// delay in the commit of the load.
+	void RecoverMemoryViolation(Uop *uop);
+
 	/// Recover from mispeculation
 	void Recover();
 
@@ -699,6 +905,19 @@ public:
 	/// Return the number of writes to load_store queues
 	long long getNumLoadStoreQueueWrites() const { return num_load_store_queue_writes; }
 
+	/// Return the number of loads that obtained their data from an older
+	/// store in the store queue
+	long long getNumForwardedLoads() const { return num_forwarded_loads; }
+
+	/// Return the number of memory ordering violations
+	long long getNumMemoryViolations() const { return num_memory_violations; }
+
+	/// Return the memory dependence predictor
+	MemoryDependencePredictor *getMemoryDependencePredictor() const
+	{
+		return memory_dependence_predictor.get();
+	}
+
 	/// Return the number of reads on integer registers
 	long long getNumIntegerRegisterReads() const { return num_integer_register_reads; }
 
@@ -58,34 +58,160 @@ bool Thread::canCommit()
 	}
 
 	// If there is no instruction in the reorder buffer, cannot commit
-	if (reorder_buffer.empty())
+	if (reorder_buffer.isEmpty())
 		return false;
 
 	// Get instruction from reorder buffer head
-	assert(reorder_buffer.size());
-	std::shared_ptr<Uop> uop = reorder_buffer.front();
+	assert(reorder_buffer.getSize());
+	misc::SlabPtr<Uop> uop = reorder_buffer.Front();
 	assert(uop->getThread() == this);
+	return isReadyToCommit(uop.get());
+}
+
 
+bool Thread::isReadyToCommit(Uop *uop)
+{
 	// Stores must be ready in order to commit
 	if (uop->getOpcode() == Uinst::OpcodeStore)
-		return register_file->isUopReady(uop.get());
+		return register_file->isUopReady(uop);
+
+	// Loads replayed after a memory ordering violation must wait for the
+	// replay to finish
+	if (uop->replay_when > cpu->getCycle())
+		return false;
 	
 	// Instructions other than stores must be completed
 	return uop->completed;
 }
 
 
+Thread::CommitStall Thread::getCommitStall()
+{
+	// No running context
+	if (!context || !context->getState(Context::StateRunning))
+		return CommitStallContext;
+
+	// Empty reorder buffer. The front-end is either refilling the pipeline
+	// after a misprediction, waiting for the instruction cache to supply
+	// the oldest fetched instruction, or not supplying uops fast enough.
+	if (reorder_buffer.isEmpty())
+	{
+		if (recover_refill)
+			return CommitStallBranchMispredict;
+		if (fetch_queue.getSize())
+		{
+			Uop *uop = fetch_queue.Front().get();
+			if (!uop->isDecoded() && instruction_module->
+					isInFlightAccess(uop->fetch_access))
+				return CommitStallInstructionCache;
+		}
+		return CommitStallFrontEnd;
+	}
+
+	// Uop at the head of the reorder buffer in a mispredicted path
+	Uop *uop = reorder_buffer.Front().get();
+	if (uop->speculative_mode)
+		return CommitStallBranchMispredict;
+
+	// Head ready, but the commit slots were used by other threads
+	if (isReadyToCommit(uop))
+		return CommitStallThread;
+
+	// Load waiting for the memory hierarchy
+	switch (getMemoryLevel(uop->memory_module, uop->physical_address))
+	{
+
+	case Uop::MemoryLevelL1:
+
+		return CommitStallL1;
+
+	case Uop::MemoryLevelL2:
+
+		return CommitStallL2;
+
+	case Uop::MemoryLevelLlc:
+
+		return CommitStallLlc;
+
+	case Uop::MemoryLevelMemory:
+
+		return CommitStallMemory;
+
+	default:
+
+		break;
+	}
+
+	// Store waiting for its operands
+	if (uop->getOpcode() == Uinst::OpcodeStore)
+		return CommitStallStore;
+
+	// Head waiting for its operands or for execution, with or without
+	// room in the reorder buffer for younger uops
+	return canInsertInReorderBuffer() ? CommitStallExecution :
+			CommitStallReorderBuffer;
+}
+
+
+void Thread::UpdateCommitSlots()
+{
+	// Slots used by uops committed in this cycle
+	int width = Cpu::getCommitWidth();
+	int num_committed_uinsts = this->num_committed_uinsts -
+			commit_slots_num_committed_uinsts;
+	commit_slots_num_committed_uinsts = this->num_committed_uinsts;
+	assert(num_committed_uinsts <= width);
+	num_commit_slots[CommitStallUsed] += num_committed_uinsts;
+
+	// Rest of the slots
+	if (num_committed_uinsts < width)
+		num_commit_slots[getCommitStall()] += width -
+				num_committed_uinsts;
+}
+
+
+void Thread::DumpCpiStackInterval(std::ostream &os)
+{
+	// Instructions in the interval
+	long long num_instructions = num_committed_instructions -
+			interval_num_committed_instructions;
+	interval_num_committed_instructions = num_committed_instructions;
+	os << misc::fmt("%lld %d %d %lld", cpu->getCycle(), core->getId(),
+			id_in_core, num_instructions);
+
+	// Contribution of each category. The slots of a cycle add up to the
+	// commit width.
+	for (int stall = CommitStallUsed; stall < CommitStallMax; stall++)
+	{
+		long long num_slots = num_commit_slots[stall] -
+				interval_num_commit_slots[stall];
+		interval_num_commit_slots[stall] = num_commit_slots[stall];
+		if (num_instructions)
+			os << misc::fmt(" %.4f", (double) num_slots /
+					Cpu::getCommitWidth() /
+					num_instructions);
+		else
+			os << " -";
+	}
+	os << '\n';
+}
+
+
 void Thread::Commit(int quantum)
 {
 	// Sanity: context must be mapped
 	assert(context);
 
+	// Detect memory ordering violations before committing stores that
+	// resolved their address in the previous cycle
+	CheckMemoryDependences();
+
 	// Commit stage for thread
 	while (quantum && canCommit())
 	{
 		// Get instruction at the head of the reorder buffer
-		assert(reorder_buffer.size());
-		std::shared_ptr<Uop> uop = reorder_buffer.front();
+		assert(reorder_buffer.getSize());
+		misc::SlabPtr<Uop> uop = reorder_buffer.Front();
 		assert(uop->getThread() == this);
 
 		// Recover from mispeculation if this is the first uop of a
@@ -130,11 +256,20 @@ void Thread::Commit(int quantum)
 		core->incNumCommittedUinsts(uop->getOpcode());
 		cpu->incNumCommittedUinsts(uop->getOpcode());
 		if (!uop->mop_index)
+		{
+			num_committed_instructions++;
 			cpu->incNumCommittedInstructions();
+		}
 
 		// Trace cache statistics
 		if (uop->from_trace_cache)
 			trace_cache->incNumCommittedUinsts();
+
+		// Uop cache and loop stream detector statistics
+		if (uop->from_uop_cache)
+			uop_cache->incNumCommittedUinsts();
+		if (uop->from_loop_stream_detector)
+			loop_stream_detector->incNumCommittedUinsts();
 		
 		// Statistics for branch instructions
 		if (uop->getFlags() & Uinst::FlagCtrl)
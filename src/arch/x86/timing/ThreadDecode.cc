@@ -30,21 +30,21 @@ void Thread::Decode()
 	for (int i = 0; i < Cpu::getDecodeWidth(); i++)
 	{
 		// Empty fetch queue
-		if (fetch_queue.size() == 0)
+		if (fetch_queue.isEmpty())
 			break;
 
 		// Full uop queue
-		if ((int) uop_queue.size() >= Cpu::getUopQueueSize())
+		if (uop_queue.getSize() >= Cpu::getUopQueueSize())
 			break;
 
 		// Get uop at the head of the fetch queue
-		assert(!fetch_queue.empty());
-		std::shared_ptr<Uop> uop = fetch_queue.front();
+		assert(!fetch_queue.isEmpty());
+		misc::SlabPtr<Uop> uop = fetch_queue.Front();
 
-		// If instructions come from the trace cache, i.e., are located
-		// in the trace cache queue, copy all of them into the uop queue
-		// in one single decode slot.
-		if (uop->from_trace_cache)
+		// If instructions come from the trace cache, the uop cache, or
+		// the loop stream detector, they are already decoded. Copy all
+		// of them into the uop queue in one single decode slot.
+		if (uop->isDecoded())
 		{
 			do
 			{
@@ -55,14 +55,14 @@ void Thread::Decode()
 				InsertInUopQueue(uop);
 
 				// Done if fetch queue empty
-				if (fetch_queue.empty())
+				if (fetch_queue.isEmpty())
 					break;
 
 				// Next instruction from fetch queue
-				assert(fetch_queue.size());
-				uop = fetch_queue.front();
+				assert(fetch_queue.getSize());
+				uop = fetch_queue.Front();
 
-			} while (uop->from_trace_cache);
+			} while (uop->isDecoded());
 
 			// Consume entire decode width
 			break;
@@ -82,6 +82,10 @@ void Thread::Decode()
 				// Add to uop queue
 				InsertInUopQueue(uop);
 
+				// Fill uop cache with decoded instructions
+				if (uop_cache)
+					uop_cache->RecordUop(uop.get());
+
 				// Trace
 				Timing::trace << misc::fmt("x86.inst "
 						"id=%lld "
@@ -91,12 +95,12 @@ void Thread::Decode()
 						core->getId());
 
 				// Done if no more instructions in fetch queue
-				if (fetch_queue.empty())
+				if (fetch_queue.isEmpty())
 					break;
 
 				// Next instruction in fetch queue
-				assert(fetch_queue.size());
-				uop = fetch_queue.front();
+				assert(fetch_queue.getSize());
+				uop = fetch_queue.Front();
 
 			} while (uop->mop_index);
 		}
@@ -29,7 +29,7 @@ namespace x86
 Thread::DispatchStall Thread::canDispatch()
 {
 	// Uop queue is empty
-	if (uop_queue.empty())
+	if (uop_queue.isEmpty())
 		return !context || !context->getState(Context::StateRunning) ?
 				DispatchStallContext :
 				DispatchStallUopQueue;
@@ -39,7 +39,7 @@ Thread::DispatchStall Thread::canDispatch()
 		return DispatchStallReorderBuffer;
 
 	// Instruction queue is full
-	Uop *uop = uop_queue.front().get();
+	Uop *uop = uop_queue.Front().get();
 	if (!(uop->getFlags() & Uinst::FlagMem) && !canInsertInInstructionQueue())
 		return DispatchStallInstructionQueue;
 
@@ -70,8 +70,8 @@ int Thread::Dispatch(int quantum)
 		}
 
 		// Get uop at the head of the uop queue
-		assert(uop_queue.size());
-		std::shared_ptr<Uop> uop = uop_queue.front();
+		assert(uop_queue.getSize());
+		misc::SlabPtr<Uop> uop = uop_queue.Front();
 	
 		// Extract uop from uop queue
 		ExtractFromUopQueue(uop.get());
@@ -40,6 +40,10 @@ Thread::FetchStall Thread::canFetch()
 	if (context->evict_signal)
 		return FetchStallContext;
 
+	// No new instructions enter the pipeline while it is being drained
+	if (cpu->isDraining())
+		return FetchStallDrain;
+
 	// Fetch queue must have not exceeded the limit of stored bytes to be
 	// able to store new macro-instructions.
 	if (fetch_queue_occupancy >= Cpu::getFetchQueueSize())
@@ -64,7 +68,7 @@ Thread::FetchStall Thread::canFetch()
 }
 
 
-Uop *Thread::FetchInstruction(bool fetch_from_trace_cache)
+Uop *Thread::FetchInstruction(FetchSource fetch_source)
 {
 	// A context must be mapped
 	assert(context);
@@ -81,7 +85,9 @@ Uop *Thread::FetchInstruction(bool fetch_from_trace_cache)
 	// Record new speculative mode
 	bool speculative_mode = context->getState(Context::StateSpecMode);
 
-	// Run emulation
+	// Run emulation. When the instructions are read from an instruction
+	// stream, such as a replayed trace, the context takes the next
+	// instruction and its micro-instructions from the stream instead.
 	context->Execute();
 
 	// Set next fetch instruction pointer to the next instruction
@@ -105,7 +111,7 @@ Uop *Thread::FetchInstruction(bool fetch_from_trace_cache)
 		std::shared_ptr<Uinst> uinst = context->ExtractUinst();
 
 		// Create uop
-		auto uop = misc::new_shared<Uop>(this,
+		auto uop = core->newUop(this,
 				context,
 				uinst);
 
@@ -117,7 +123,10 @@ Uop *Thread::FetchInstruction(bool fetch_from_trace_cache)
 
 		// Other fields
 		uop->eip = fetch_eip;
-		uop->from_trace_cache = fetch_from_trace_cache;
+		uop->from_trace_cache = fetch_source == FetchSourceTraceCache;
+		uop->from_uop_cache = fetch_source == FetchSourceUopCache;
+		uop->from_loop_stream_detector = fetch_source ==
+				FetchSourceLoopStreamDetector;
 		uop->speculative_mode = speculative_mode;
 		uop->fetch_address = fetch_address;
 		uop->fetch_access = fetch_access;
@@ -184,8 +193,16 @@ Uop *Thread::FetchInstruction(bool fetch_from_trace_cache)
 		// Stats
 		cpu->incNumFetchedUinsts();
 		num_fetched_uinsts++;
-		if (fetch_from_trace_cache)
+		if (uop->from_trace_cache)
 			trace_cache->incNumFetchedUinsts();
+		if (uop->from_uop_cache)
+			uop_cache->incNumFetchedUinsts();
+		if (uop->from_loop_stream_detector)
+			loop_stream_detector->incNumFetchedUinsts();
+
+		// Loop stream detector counts the uops of loop bodies
+		if (loop_stream_detector)
+			loop_stream_detector->RecordUop();
 
 		// Next micro-instruction
 		uinst_index++;
@@ -196,6 +213,134 @@ Uop *Thread::FetchInstruction(bool fetch_from_trace_cache)
 }
 
 
+bool Thread::PredictFetchedBranch(Uop *uop)
+{
+	// Look up BTB
+	unsigned target = branch_predictor->LookupBtb(uop);
+
+	// Look up branch predictor
+	BranchPredictor::Prediction prediction = branch_predictor->Lookup(uop);
+	bool taken = prediction == BranchPredictor::PredictionTaken && target;
+	if (!taken)
+		return false;
+
+	// Set next instruction pointer
+	fetch_neip = target;
+	uop->predicted_neip = target;
+
+	// Backward branches are loop candidates for the loop stream detector
+	if (loop_stream_detector)
+		loop_stream_detector->RecordTakenBranch(uop->eip, target);
+	return true;
+}
+
+
+bool Thread::FetchFromUopCache()
+{
+	// While the uop cache queue is full, the front-end waits for the
+	// decoded uops to drain instead of falling back to the decoders.
+	assert(UopCache::isPresent());
+	if (uop_cache_queue_occupancy >= UopCache::getQueueSize())
+		return true;
+
+	// Look up the fetch window
+	if (!uop_cache->Lookup(fetch_neip))
+		return false;
+
+	// Deliver uops from the window up to the first predicted-taken branch
+	unsigned window = UopCache::getWindow(fetch_neip);
+	int num_uops = 0;
+	while (UopCache::getWindow(fetch_neip) == window &&
+			num_uops < UopCache::getWidth())
+	{
+		// If instruction caused context to suspend or finish
+		if (!context->getState(Context::StateRunning))
+			break;
+
+		// Stop if the uop cache queue is full
+		if (uop_cache_queue_occupancy >= UopCache::getQueueSize())
+			break;
+
+		// Fetch instruction
+		int occupancy = uop_cache_queue_occupancy;
+		Uop *uop = FetchInstruction(FetchSourceUopCache);
+		num_uops += uop_cache_queue_occupancy - occupancy;
+
+		// Invalid x86 instruction, no forward progress in loop
+		if (!context->getInstruction()->getSize())
+			break;
+
+		// No uop was produced by this macro-instruction
+		if (!uop)
+			continue;
+
+		// Stop at predicted-taken branches
+		if ((uop->getFlags() & Uinst::FlagCtrl) &&
+				PredictFetchedBranch(uop))
+			break;
+	}
+
+	// Hit
+	return true;
+}
+
+
+bool Thread::FetchFromLoopStreamDetector()
+{
+	// No locked loop
+	assert(LoopStreamDetector::isPresent());
+	if (!loop_stream_detector->isLocked())
+		return false;
+
+	// Fetch left the loop body
+	if (!loop_stream_detector->isInLoop(fetch_neip))
+	{
+		loop_stream_detector->Unlock();
+		return false;
+	}
+
+	// Stream uops of the loop body up to the loop branch
+	loop_stream_detector->incNumActiveCycles();
+	int num_uops = 0;
+	while (num_uops < LoopStreamDetector::getWidth())
+	{
+		// If instruction caused context to suspend or finish
+		if (!context->getState(Context::StateRunning))
+			break;
+
+		// Stop if the loop stream detector queue is full
+		if (loop_stream_detector_queue_occupancy >=
+				LoopStreamDetector::getSize())
+			break;
+
+		// Fetch instruction
+		int occupancy = loop_stream_detector_queue_occupancy;
+		Uop *uop = FetchInstruction(FetchSourceLoopStreamDetector);
+		num_uops += loop_stream_detector_queue_occupancy - occupancy;
+
+		// Invalid x86 instruction, no forward progress in loop
+		if (!context->getInstruction()->getSize())
+			break;
+
+		// No uop was produced by this macro-instruction
+		if (!uop)
+			continue;
+
+		// Stop at predicted-taken branches
+		if ((uop->getFlags() & Uinst::FlagCtrl) &&
+				PredictFetchedBranch(uop))
+			break;
+
+		// Stop when fetch falls out of the loop body
+		if (!loop_stream_detector->isInLoop(fetch_neip))
+			break;
+	}
+
+	// Loop streamed
+	return true;
+}
+
+
 bool Thread::FetchFromTraceCache()
 {
 	// No room in trace cache queue
@@ -230,7 +375,7 @@ bool Thread::FetchFromTraceCache()
 		// simulation, the uop is inserted into the fetch queue, but its
 		// occupancy is not increased.
 		fetch_neip = entry->getMacroInstruction(i);
-		Uop *uop = FetchInstruction(true);
+		Uop *uop = FetchInstruction(FetchSourceTraceCache);
 
 		// No uop was produced by this macro-instruction
 		if (!uop)
@@ -257,9 +402,17 @@ void Thread::Fetch()
 	// Sanity
 	assert(context);
 
+	// Stream a loop locked in the loop stream detector
+	if (LoopStreamDetector::isPresent() && FetchFromLoopStreamDetector())
+		return;
+
 	// Try to fetch from trace cache first
 	if (TraceCache::isPresent() && FetchFromTraceCache())
 		return;
+
+	// Try to fetch decoded uops from the uop cache
+	if (UopCache::isPresent() && FetchFromUopCache())
+		return;
 	
 	// If new block to fetch is not the same as the previously fetched (and
 	// stored) block, access the instruction cache.
@@ -305,7 +458,7 @@ void Thread::Fetch()
 		// point, we use it to decode instruction now and insert uops
 		// into the fetch queue. However, the fetch queue occupancy is
 		// increased with the macro-instruction size.
-		Uop *uop = FetchInstruction(false);
+		Uop *uop = FetchInstruction(FetchSourceInstructionCache);
 
 		// Invalid x86 instruction, no forward progress in loop
 		if (!context->getInstruction()->getSize())
@@ -317,27 +470,10 @@ void Thread::Fetch()
 
 		// Instructions detected as branches by the BTB are checked for
 		// branch direction in the branch predictor. If they are
-		// predicted taken, stop fetching from this block and set new
-		// fetch address.
-		if (uop->getFlags() & Uinst::FlagCtrl)
-		{
-			// Look up BTB
-			unsigned target = branch_predictor->LookupBtb(uop);
-
-			// Look up branch predictor
-			BranchPredictor::Prediction prediction =
-					branch_predictor->Lookup(uop);
-			bool taken = prediction == BranchPredictor::PredictionTaken
-					&& target;
-
-			// Set next instruction pointer
-			if (taken)
-			{
-				fetch_neip = target;
-				uop->predicted_neip = target;
-				break;
-			}
-		}
+		// predicted taken, stop fetching from this block.
+		if ((uop->getFlags() & Uinst::FlagCtrl) &&
+				PredictFetchedBranch(uop))
+			break;
 	}
 }
 
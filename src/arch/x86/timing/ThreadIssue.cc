@@ -17,6 +17,8 @@
  *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <algorithm>
+
 #include <memory/Module.h>
 
 #include "Core.h"
@@ -27,6 +29,108 @@
 namespace x86
 {
 
+misc::SlabPtr<Uop> Thread::FindOlderStore(Uop *uop)
+{
+	// Bytes read by the load
+	unsigned load_address = uop->physical_address;
+	unsigned load_size = std::max(uop->getUinst()->getSize(), 1);
+
+	// Search the index entries of the blocks read by the load
+	misc::SlabPtr<Uop> youngest_store;
+	unsigned first_block;
+	unsigned last_block;
+	getStoreQueueIndexBlocks(uop, first_block, last_block);
+	for (unsigned block = first_block; block <= last_block; block++)
+	{
+		auto range = store_queue_index.equal_range(block);
+		for (auto it = range.first; it != range.second; ++it)
+		{
+			// Only older stores
+			const misc::SlabPtr<Uop> &store = it->second;
+			if (store->getId() > uop->getId())
+				continue;
+
+			// Check overlap
+			unsigned store_address = store->physical_address;
+			unsigned store_size = std::max(store->getUinst()->getSize(), 1);
+			if (store_address >= load_address + load_size ||
+					load_address >= store_address + store_size)
+				continue;
+
+			// Keep youngest
+			if (!youngest_store || store->getId() > youngest_store->getId())
+				youngest_store = store;
+		}
+	}
+
+	// Return youngest older store found
+	return youngest_store;
+}
+
+
+bool Thread::hasUnresolvedOlderStore(Uop *uop)
+{
+	// Stores are ordered by age. Resolved stores are dropped as they are
+	// found, so each store is checked as resolved at most once.
+	auto it = unresolved_stores.begin();
+	while (it != unresolved_stores.end() && it->first < uop->getId())
+	{
+		if (!register_file->isUopReady(it->second))
+			return true;
+		it = unresolved_stores.erase(it);
+	}
+
+	// All older stores resolved
+	return false;
+}
+
+
+void Thread::CheckMemoryDependences()
+{
+	// Traverse pending dependences
+	auto it = memory_dependences.begin();
+	while (it != memory_dependences.end())
+	{
+		// The violation is detected once the store resolves its address
+		MemoryDependence &dependence = *it;
+		if (!register_file->isUopReady(dependence.store.get()))
+		{
+			++it;
+			continue;
+		}
+
+		// Recover
+		RecoverMemoryViolation(dependence.load.get());
+		it = memory_dependences.erase(it);
+	}
+}
+
+
+Uop::MemoryLevel Thread::getMemoryLevel(mem::Module *module,
+		unsigned physical_address)
+{
+	// No access
+	if (!module)
+		return Uop::MemoryLevelInvalid;
+
+	// Main memory
+	if (module->getType() == mem::Module::TypeMainMemory)
+		return Uop::MemoryLevelMemory;
+
+	// Count the levels between the data cache of the thread and the
+	// module. Local memories are treated as first-level caches.
+	int level = 1;
+	for (mem::Module *low_module = data_module;
+			low_module && low_module != module;
+			low_module = low_module->getLowModuleServingAddress(
+			physical_address))
+		level++;
+	return level == 1 ? Uop::MemoryLevelL1 :
+			level == 2 ? Uop::MemoryLevelL2 :
+			Uop::MemoryLevelLlc;
+}
+
+
 int Thread::IssueLoadQueue(int quantum)
 {
 	// List iterators
@@ -37,25 +141,66 @@ int Thread::IssueLoadQueue(int quantum)
 	while (it != e && quantum > 0)
 	{
 		// Get the uop and forward iterator
-		std::shared_ptr<Uop> uop = *it;
+		misc::SlabPtr<Uop> uop = *it;
 		++it;
 
 		// If the uop is not ready, skip it
 		if (!register_file->isUopReady(uop.get()))
 			continue;
 
-		// Check that memory system is accessible
-		if (!data_module->canAccess(uop->physical_address))
+		// If an older store has not resolved its address yet, the
+		// memory dependence predictor decides whether the load can
+		// issue ahead of it.
+		if (hasUnresolvedOlderStore(uop.get()) &&
+				memory_dependence_predictor->Lookup(uop.get(),
+				cpu->getCycle()))
 			continue;
 
-		// Remove uop from load queue
-		ExtractFromLoadQueue(uop.get());
-
-		// Access memory system
-		cpu->MemoryAccess(data_module,
-				mem::Module::AccessLoad,
-				uop->physical_address,
-				uop);
+		// Youngest older store writing to the bytes read by the load
+		misc::SlabPtr<Uop> store = FindOlderStore(uop.get());
+		bool forward = store && register_file->isUopReady(store.get());
+		if (forward)
+		{
+			// If the store does not provide all bytes read by the
+			// load, the load must wait until the store leaves the
+			// store queue.
+			unsigned load_size = std::max(uop->getUinst()->getSize(), 1);
+			unsigned store_size = std::max(store->getUinst()->getSize(), 1);
+			if (uop->physical_address < store->physical_address ||
+					uop->physical_address + load_size >
+					store->physical_address + store_size)
+				continue;
+
+			// Remove uop from load queue
+			ExtractFromLoadQueue(uop.get());
+
+			// Obtain data from the store, skipping the memory system
+			core->InsertInEventQueue(uop,
+					Cpu::getLoadStoreQueueForwardLatency());
+			uop->memory_module = data_module;
+			num_forwarded_loads++;
+		}
+		else
+		{
+			// Check that memory system is accessible
+			if (!data_module->canAccess(uop->physical_address))
+				continue;
+
+			// Remove uop from load queue
+			ExtractFromLoadQueue(uop.get());
+
+			// Access memory system
+			cpu->MemoryAccess(data_module,
+					mem::Module::AccessLoad,
+					uop->physical_address,
+					uop);
+
+			// If an older store with an unresolved address writes to
+			// the same location, the load reads a stale value. The
+			// violation is detected when the store resolves.
+			if (store)
+				memory_dependences.push_back({uop, store});
+		}
 
 		// Mark uop as issued
 		uop->issued = true;
@@ -112,7 +257,7 @@ int Thread::IssueStoreQueue(int quantum)
 	while (it != e && quantum > 0)
 	{
 		// Get the uop and forward iterator
-		std::shared_ptr<Uop> uop = *it;
+		misc::SlabPtr<Uop> uop = *it;
 		++it;
 
 		// Sanity
@@ -174,6 +319,9 @@ int Thread::IssueStoreQueue(int quantum)
 
 int Thread::IssueLoadStoreQueue(int quantum)
 {
+	// Detect memory ordering violations of loads issued early
+	CheckMemoryDependences();
+
 	// Give priority to loads versus stores
 	quantum = IssueLoadQueue(quantum);
 	quantum = IssueStoreQueue(quantum);
@@ -193,7 +341,7 @@ int Thread::IssueInstructionQueue(int quantum)
 	while (it != e && quantum > 0)
 	{
 		// Get the uop and forward iterator
-		std::shared_ptr<Uop> uop = *it;
+		misc::SlabPtr<Uop> uop = *it;
 		++it;
 
 		// Sanity
@@ -27,10 +27,10 @@ namespace x86
 void Thread::RecoverFetchQueue()
 {
 	// Keep squashing instructions from tail
-	while (fetch_queue.size())
+	while (fetch_queue.getSize())
 	{
 		// Get uop from the tail
-		std::shared_ptr<Uop> uop = fetch_queue.back();
+		misc::SlabPtr<Uop> uop = fetch_queue.Back();
 		assert(uop->getThread() == this);
 
 		// Stop if this uop is not in speculative mode anymore
@@ -59,16 +59,18 @@ void Thread::RecoverFetchQueue()
 	// Sanity
 	assert(fetch_queue_occupancy == 0);
 	assert(trace_cache_queue_occupancy == 0);
+	assert(uop_cache_queue_occupancy == 0);
+	assert(loop_stream_detector_queue_occupancy == 0);
 }
 
 
 void Thread::RecoverUopQueue()
 {
 	// Keep squashing uops from the queue
-	while (uop_queue.size())
+	while (uop_queue.getSize())
 	{
 		// Get uop from the back
-		std::shared_ptr<Uop> uop = uop_queue.back();
+		misc::SlabPtr<Uop> uop = uop_queue.Back();
 		assert(uop->getThread() == this);
 
 		// Stop if uop is not in speculative mode
@@ -129,6 +131,12 @@ void Thread::RecoverLoadQueue()
 		if (uop->speculative_mode)
 			ExtractFromLoadQueue(uop);
 	}
+
+	// Discard pending memory dependences of squashed loads
+	memory_dependences.remove_if([](const MemoryDependence &dependence)
+	{
+		return dependence.load->speculative_mode;
+	});
 }
 
 
@@ -168,6 +176,20 @@ void Thread::RecoverEventQueue()
 }
 
 
+void Thread::RecoverMemoryViolation(Uop *uop)
+{
+	// Train memory dependence predictor
+	memory_dependence_predictor->Update(uop);
+	num_memory_violations++;
+
+	// The load and all younger instructions should be squashed and
+	// fetched again. Since the emulator already executed them at fetch,
+	// replaying them is modeled by delaying the commit of the load.
+	uop->replay_when = cpu->getCycle() +
+			MemoryDependencePredictor::getViolationPenalty();
+}
+
+
 void Thread::Recover()
 {
 	// Remove instructions of this thread in fetch queue, uop queue,
@@ -181,10 +203,10 @@ void Thread::Recover()
 
 	// Remove instructions from ROB, restoring the state of the physical
 	// register file.
-	while (reorder_buffer.size())
+	while (reorder_buffer.getSize())
 	{
 		// Get instruction at the reorder buffer tail
-		std::shared_ptr<Uop> uop = reorder_buffer.back();
+		misc::SlabPtr<Uop> uop = reorder_buffer.Back();
 		assert(uop->getThread() == this);
 
 		// If we already removed all speculative instructions, done
@@ -202,7 +224,8 @@ void Thread::Recover()
 		if (!uop->completed)
 			register_file->WriteUop(uop.get());
 
-		// Undo register renaming
+		// Undo register renaming. Uops younger than the checkpoint of
+		// the register aliasing tables only release their registers.
 		register_file->UndoUop(uop.get());
 
 		// Trace
@@ -224,16 +247,31 @@ void Thread::Recover()
 		ExtractFromReorderBuffer(uop.get());
 	}
 
-	// Check state of fetch stage and mapped context, if still any
-	if (context)
+	// A misprediction releases the loop locked in the loop stream detector
+	if (loop_stream_detector)
+		loop_stream_detector->Unlock();
+
+	// Commit slots are attributed to the misprediction until the reorder
+	// buffer receives uops again
+	recover_refill = true;
+
+	// Check state of fetch stage and mapped context, if still any. The
+	// emulator is shared by all cores, so its recovery is deferred when
+	// cores run in parallel.
+	esim::Engine *esim_engine = esim::Engine::getInstance();
+	esim_engine->Defer([this]()
 	{
-		// If we actually fetched wrong instructions, recover emulator
-		if (context->getState(Context::StateSpecMode))
-			context->Recover();
-	
-		// Set next program counter to valid address
-		fetch_neip = context->getRegs().getEip();
-	}
+		if (context)
+		{
+			// If we actually fetched wrong instructions, recover
+			// emulator
+			if (context->getState(Context::StateSpecMode))
+				context->Recover();
+
+			// Set next program counter to valid address
+			fetch_neip = context->getRegs().getEip();
+		}
+	});
 }
 
 }
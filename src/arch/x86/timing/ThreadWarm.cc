@@ -0,0 +1,125 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "Cpu.h"
+#include "Thread.h"
+#include "TraceCache.h"
+#include "UopCache.h"
+
+
+namespace x86
+{
+
+void Thread::Warm()
+{
+	// A context must be allocated
+	assert(context);
+	assert(!context->getState(Context::StateSpecMode));
+
+	// Get MMU
+	mem::Mmu *mmu = context->getMmu();
+	mem::Mmu::Space *mmu_space = context->getMmuSpace();
+
+	// Access the instruction cache when a new block is fetched
+	unsigned eip = context->getRegs().getEip();
+	unsigned block_address = eip & ~(instruction_module->getBlockSize() - 1);
+	if (block_address != fetch_block_address)
+	{
+		fetch_block_address = block_address;
+		instruction_module->WarmAccess(mem::Module::AccessLoad,
+				mmu->TranslateVirtualAddress(mmu_space, eip));
+	}
+
+	// Run emulation
+	context->Execute();
+	unsigned neip = context->getRegs().getEip();
+	int mop_size = context->getInstruction()->getSize();
+
+	// As in the fetch stage, an instruction producing no micro-instruction
+	// is represented with a 'nop', so that traces recorded in the trace
+	// cache and windows recorded in the uop cache are contiguous.
+	bool record_fetch = TraceCache::isPresent() || UopCache::isPresent();
+	if (record_fetch && !context->getNumUinsts())
+		context->newUinst(Uinst::OpcodeNop, 0, 0, 0, 0, 0, 0, 0);
+
+	// Traverse micro-instructions created by the x86 emulator
+	int num_uinsts = context->getNumUinsts();
+	int uinst_index = 0;
+	while (context->getNumUinsts())
+	{
+		// Get micro-instruction from head of list
+		std::shared_ptr<Uinst> uinst = context->ExtractUinst();
+
+		// Memory accesses warm up the data cache
+		if (uinst->getFlags() & Uinst::FlagMem)
+		{
+			mem::Module::AccessType access_type =
+					uinst->getOpcode() == Uinst::OpcodeStore ?
+					mem::Module::AccessStore :
+					mem::Module::AccessLoad;
+			data_module->WarmAccess(access_type,
+					mmu->TranslateVirtualAddress(mmu_space,
+					uinst->getAddress()));
+		}
+
+		// Control micro-instructions train the branch predictor, and the
+		// first micro-instruction of each macro-instruction is recorded
+		// in the trace cache, as done at commit, and in the uop cache,
+		// as done at decode.
+		bool record_uop = !uinst_index && record_fetch;
+		if ((uinst->getFlags() & Uinst::FlagCtrl) || record_uop)
+		{
+			auto uop = core->newUop(this, context, uinst);
+			uop->eip = eip;
+			uop->neip = neip;
+			uop->predicted_neip = neip;
+			uop->target_neip = context->getTargetEip();
+			uop->mop_size = mop_size;
+			uop->mop_count = num_uinsts;
+			uop->mop_id = uop->getId() - uinst_index;
+			uop->mop_index = uinst_index;
+			if (uinst->getFlags() & Uinst::FlagCtrl)
+				branch_predictor->Train(uop.get());
+			if (record_uop && trace_cache)
+				trace_cache->RecordUop(uop.get());
+			if (record_uop && uop_cache)
+				uop_cache->RecordUop(uop.get());
+		}
+
+		// Next micro-instruction
+		uinst_index++;
+	}
+}
+
+
+void Thread::ResetFetch()
+{
+	// Nothing to do if no context is allocated
+	if (!context)
+		return;
+
+	// Fetch at the context's next instruction, forcing a new access to
+	// the instruction cache.
+	assert(isPipelineEmpty());
+	fetch_neip = context->getRegs().getEip();
+	fetch_block_address = -1;
+}
+
+}
+
@@ -47,6 +47,13 @@ comm::Arch::SimKind Timing::sim_kind = comm::Arch::SimFunctional;
 // Report file name
 std::string Timing::report_file;
 
+// Branch trace evaluated with the branch predictor
+std::string Timing::branch_eval_file;
+
+// CPI stack time series
+std::string Timing::cpi_stack_file;
+int Timing::cpi_stack_interval = 10000;
+
 // Message to display with '--x86-help'
 const std::string Timing::help_message =
 		"The x86 Cpu configuration file is a plain text INI file, defining\n"
@@ -69,6 +76,11 @@ const std::string Timing::help_message =
 		"  FastForward = <num_inst> (Default = 0)\n"
 		"      Number of x86 instructions to run with a fast functional simulation before\n"
 		"      the architectural simulation starts.\n"
+		"  FunctionalWarming = <num_inst> (Default = 0)\n"
+		"      Number of instructions at the end of the fast-forward that update the\n"
+		"      caches, directories, branch predictors, and trace caches of the hardware\n"
+		"      threads the contexts are mapped to, without modeling any latency. Must\n"
+		"      not exceed 'FastForward'.\n"
 		"  ContextQuantum = <cycles> (Default = 100k)\n"
 		"      If ContextSwitch is true, maximum number of cycles that a context can occupy\n"
 		"      a Cpu hardware thread before it is replaced by other pending context.\n"
@@ -144,6 +156,9 @@ const std::string Timing::help_message =
 		"      Load-store queue sharing among threads.\n"
 		"  LsqSize = <num_uops> (Default = 20)\n"
 		"      Load-store queue size in number of uops (if private, per-thread LSQ size).\n"
+		"  LsqForwardLatency = <cycles> (Default = 1)\n"
+		"      Latency of a load obtaining its data from an older store in the store\n"
+		"      queue, instead of accessing the memory hierarchy.\n"
 		"  RfKind = {Private|Shared} (Default = Private)\n"
 		"      Register file sharing among threads.\n"
 		"  RfIntSize = <entries> (Default = 80)\n"
@@ -170,6 +185,41 @@ const std::string Timing::help_message =
 		"  QueueSize = <num_uops> (Default = 32)\n"
 		"      Size of the trace queue size in uops.\n"
 		"\n"
+		"Section '[ UopCache ]':\n"
+		"\n"
+		"  Present = {t|f} (Default = False)\n"
+		"      If true, a cache of decoded uops is included in the front-end. Fetch\n"
+		"      addresses hitting in it bypass the instruction cache and the decoders.\n"
+		"      If false, the rest of the options in this section are ignored.\n"
+		"  Sets = <num_sets> (Default = 32)\n"
+		"      Number of sets in the uop cache.\n"
+		"  Assoc = <num_ways> (Default = 8)\n"
+		"      Associativity of the uop cache. Each way holds the uops decoded for\n"
+		"      one fetch window.\n"
+		"  WindowSize = <bytes> (Default = 32)\n"
+		"      Size of the aligned fetch windows used as uop cache tags.\n"
+		"  MaxUops = <num_uops> (Default = 18)\n"
+		"      Maximum number of uops of a window. Windows decoding to more uops are\n"
+		"      not cached.\n"
+		"  Width = <num_uops> (Default = 6)\n"
+		"      Number of uops delivered per cycle by the uop cache.\n"
+		"  QueueSize = <num_uops> (Default = 32)\n"
+		"      Size of the uop cache queue in uops.\n"
+		"\n"
+		"Section '[ LoopStreamDetector ]':\n"
+		"\n"
+		"  Present = {t|f} (Default = False)\n"
+		"      If true, a loop stream detector is included in the front-end. Loops\n"
+		"      locked in it stream their uops without accessing the instruction\n"
+		"      cache, the uop cache, or the decoders.\n"
+		"  Size = <num_uops> (Default = 28)\n"
+		"      Maximum number of uops in the body of a locked loop, and size of the\n"
+		"      loop stream detector queue.\n"
+		"  LockIterations = <num_iterations> (Default = 2)\n"
+		"      Number of consecutive iterations of a loop before it is locked.\n"
+		"  Width = <num_uops> (Default = 4)\n"
+		"      Number of uops streamed per cycle by the loop stream detector.\n"
+		"\n"
 		"Section '[ FunctionalUnits ]':\n"
 		"\n"
 		"  The possible variables in this section follow the format\n"
@@ -213,7 +263,8 @@ const std::string Timing::help_message =
 		"\n"
 		"Section '[ BranchPredictor ]':\n"
 		"\n"
-		"  Kind = {Perfect|Taken|NotTaken|Bimodal|TwoLevel|Combined} (Default = TwoLevel)\n"
+		"  Kind = {Perfect|Taken|NotTaken|Bimodal|TwoLevel|Combined|TAGE|Perceptron}\n"
+		"      (Default = TwoLevel)\n"
 		"      Branch predictor type.\n"
 		"  BTB.Sets = <num_sets> (Default = 256)\n"
 		"      Number of sets in the BTB.\n"
@@ -231,6 +282,83 @@ const std::string Timing::help_message =
 		"      For the two-level adaptive predictor, level 2 size.\n"
 		"  TwoLevel.HistorySize = <size> (Default = 8)\n"
 		"      For the two-level adaptive predictor, level 2 history size.\n"
+		"  TAGE.NumTables = <num> (Default = 7)\n"
+		"      For the TAGE predictor, number of tagged tables, in addition to the\n"
+		"      bimodal table used as the base predictor (of size 'Bimod.Size').\n"
+		"  TAGE.TableSize = <entries> (Default = 1024)\n"
+		"      For the TAGE predictor, number of entries of each tagged table.\n"
+		"  TAGE.TagBits = <bits> (Default = 10)\n"
+		"      For the TAGE predictor, size of the tags in bits.\n"
+		"  TAGE.MinHistory = <length> (Default = 5)\n"
+		"  TAGE.MaxHistory = <length> (Default = 130)\n"
+		"      For the TAGE predictor, global history length used by the first and\n"
+		"      last tagged tables. The rest of tables use lengths in a geometric series.\n"
+		"  Perceptron.NumTables = <num> (Default = 8)\n"
+		"      For the hashed perceptron predictor, number of weight tables. The first\n"
+		"      table is indexed by the branch address, and each of the rest by the\n"
+		"      address hashed with one segment of the global history.\n"
+		"  Perceptron.TableSize = <entries> (Default = 1024)\n"
+		"      For the hashed perceptron predictor, number of weights per table.\n"
+		"  Perceptron.HistorySize = <length> (Default = 56)\n"
+		"      For the hashed perceptron predictor, global history length.\n"
+		"  Indirect = {BTB|ITTAGE} (Default = BTB)\n"
+		"      Predictor for the targets of indirect jumps and calls. With ITTAGE,\n"
+		"      targets predicted by the ITTAGE tables override those in the BTB.\n"
+		"  ITTAGE.NumTables = <num> (Default = 4)\n"
+		"  ITTAGE.TableSize = <entries> (Default = 256)\n"
+		"  ITTAGE.TagBits = <bits> (Default = 9)\n"
+		"  ITTAGE.MinHistory = <length> (Default = 4)\n"
+		"  ITTAGE.MaxHistory = <length> (Default = 64)\n"
+		"      Geometry of the ITTAGE indirect target predictor, with the same\n"
+		"      meaning as the equivalent variables for the TAGE predictor.\n"
+		"\n"
+		"Section '[ MemoryDependencePredictor ]':\n"
+		"\n"
+		"  Kind = {Conservative|Aggressive|LoadWait} (Default = LoadWait)\n"
+		"      Policy for loads that are ready to issue while older stores have not\n"
+		"      resolved their address yet. Conservative loads always wait for them,\n"
+		"      aggressive loads never wait, and LoadWait uses a table indexed by the\n"
+		"      load address, where loads that caused an ordering violation wait.\n"
+		"  LoadWait.Size = <entries> (Default = 1024)\n"
+		"      Number of entries of the load wait table.\n"
+		"  LoadWait.ClearInterval = <cycles> (Default = 16384)\n"
+		"      Number of cycles after which the load wait table is cleared. Use 0 to\n"
+		"      never clear it.\n"
+		"  ViolationPenalty = <cycles> (Default = 10)\n"
+		"      Number of cycles that the commit of a load is delayed when it is found\n"
+		"      to have read a location before an older store wrote to it.\n"
+		"\n"
+		"Section '[ Sampling ]':\n"
+		"\n"
+		"  Present = {t|f} (Default = False)\n"
+		"      If true, the detailed simulation is sampled. Execution is divided in\n"
+		"      periods, each composed of a functional fast-forward phase, a functional\n"
+		"      warming phase, a detailed warming phase, and a measurement. The CPI of all\n"
+		"      measurements is used to estimate the CPI of the complete execution.\n"
+		"  FastForward = <num_inst> (Default = 0)\n"
+		"      Number of instructions executed functionally at the beginning of each\n"
+		"      period, with no warming of caches or branch predictors.\n"
+		"  FunctionalWarming = <num_inst> (Default = 1000000)\n"
+		"      Number of instructions executed functionally while warming up caches,\n"
+		"      directories, and branch predictors.\n"
+		"  DetailedWarming = <num_inst> (Default = 2000)\n"
+		"      Number of instructions committed in detailed simulation before each\n"
+		"      measurement starts.\n"
+		"  Measurement = <num_inst> (Default = 1000)\n"
+		"      Number of committed instructions in each measurement.\n"
+		"  MaxSamples = <num> (Default = 0)\n"
+		"      Stop the simulation after this number of samples. Use 0 for no limit.\n"
+		"  Confidence = {90|95|99} (Default = 95)\n"
+		"      Confidence level in percentage used for the CPI confidence interval.\n"
+		"  TargetError = <percentage> (Default = 3)\n"
+		"      Target relative error of the CPI estimate, used to report the number of\n"
+		"      samples required for the observed variation.\n"
+		"  SimPoints = <file> (Default = '')\n"
+		"      File with weighted simulation points, as produced by option\n"
+		"      '--x86-simpoint'. When given, measurements are taken on the simulation\n"
+		"      points only, variables 'FastForward' and 'Measurement' are ignored, and\n"
+		"      the CPI is estimated as the weighted average of the samples. The\n"
+		"      simulation ends after the last simulation point.\n"
 		"\n";
 
 const char *Timing::error_fast_forward =
@@ -252,11 +380,29 @@ Timing::Timing() : comm::Timing("x86")
 	// Create CPU
 	cpu = misc::new_unique<Cpu>(this);
 
+	// Create sampling controller
+	if (Sampling::isPresent())
+		sampling = misc::new_unique<Sampling>(cpu.get());
+
 	// Create the trace header related to CPU
 	trace.Header(misc::fmt("x86.init version=\"%d.%d\" "
 			"num_cores=%d num_threads=%d\n",
 			trace_version_major, trace_version_minor,
 			cpu->getNumCores(), cpu->getNumThreads()));
+
+	// Open CPI stack time series, with a header listing the columns
+	if (!cpi_stack_file.empty())
+	{
+		cpi_stack_os.open(cpi_stack_file);
+		if (!cpi_stack_os)
+			throw Error(misc::fmt("%s: Cannot open CPI stack file",
+					cpi_stack_file.c_str()));
+		cpi_stack_os << "# cycle core thread instructions";
+		for (int stall = Thread::CommitStallUsed;
+				stall < Thread::CommitStallMax; stall++)
+			cpi_stack_os << ' ' << Thread::commit_stall_map[stall];
+		cpi_stack_os << '\n';
+	}
 }
 
 
@@ -286,10 +432,14 @@ bool Timing::Run()
 			< Cpu::getNumFastForwardInstructions())
 		FastForward();
 
-	// Stop if maximum number of CPU instructions exceeded
+	// Stop if maximum number of CPU instructions exceeded. Instructions
+	// executed functionally in a sampled simulation count as well.
 	esim::Engine *esim_engine = esim::Engine::getInstance();
+	long long num_functional_instructions = sampling ?
+			sampling->getNumFunctionalInstructions() : 0;
 	if (Emulator::getMaxInstructions()
 			&& cpu->getNumCommittedInstructions()
+			+ num_functional_instructions
 			>= Emulator::getMaxInstructions()
 			- Cpu::getNumFastForwardInstructions())
 		esim_engine->Finish("X86MaxInstructions");
@@ -309,9 +459,20 @@ bool Timing::Run()
 	// Run processor stages
 	cpu->Run();
 
+	// Dump CPI stack time series
+	if (cpi_stack_os.is_open() && getCycle() % cpi_stack_interval == 0)
+		for (int i = 0; i < Cpu::getNumCores(); i++)
+			for (int j = 0; j < Cpu::getNumThreads(); j++)
+				cpu->getThread(i, j)->DumpCpiStackInterval(
+						cpi_stack_os);
+
 	// Process host threads generating events
 	emulator->ProcessEvents();
 
+	// Advance sampled simulation
+	if (sampling)
+		sampling->Run();
+
 	// Still simulating
 	return true;
 }
@@ -319,14 +480,29 @@ bool Timing::Run()
 
 void Timing::FastForward()
 {
-	// Fast-forward simulation
+	// Contexts do not need to produce micro-instructions until warming
 	Emulator *emulator = Emulator::getInstance();
 	esim::Engine *esim_engine = esim::Engine::getInstance();
-	while (emulator->getNumInstructions()
-			< Cpu::getNumFastForwardInstructions()
+	for (auto it = emulator->getContextsBegin(),
+			e = emulator->getContextsEnd(); it != e; ++it)
+		(*it)->setUinstActive(false);
+
+	// Fast-forward simulation up to the beginning of functional warming
+	long long warming_start = Cpu::getNumFastForwardInstructions()
+			- Cpu::getNumFunctionalWarmingInstructions();
+	while (emulator->getNumInstructions() < warming_start
 			&& !esim_engine->hasFinished())
 		emulator->Run();
 
+	// Restore generation of micro-instructions
+	for (auto it = emulator->getContextsBegin(),
+			e = emulator->getContextsEnd(); it != e; ++it)
+		(*it)->setUinstActive(true);
+
+	// Functional warming
+	if (Cpu::getNumFunctionalWarmingInstructions())
+		FunctionalWarming();
+
 	// Output warning if simulation finished during fast-forward execution
 	if (esim_engine->hasFinished())
 		misc::Warning("x86 fast-forwarding finished simulation.\n%s",
@@ -334,6 +510,24 @@ void Timing::FastForward()
 }
 
 
+void Timing::FunctionalWarming()
+{
+	// Map contexts to hardware threads, so that their instructions warm up
+	// the structures of the threads where they will run.
+	Emulator *emulator = Emulator::getInstance();
+	cpu->Schedule();
+
+	// Run instructions
+	cpu->RunFunctional(Cpu::getNumFastForwardInstructions()
+			- emulator->getNumInstructions(), true);
+
+	// Resume fetching where functional simulation stopped
+	for (int i = 0; i < Cpu::getNumCores(); i++)
+		for (int j = 0; j < Cpu::getNumThreads(); j++)
+			cpu->getThread(i, j)->ResetFetch();
+}
+
+
 void Timing::WriteMemoryConfiguration(misc::IniFile *ini_file)
 {
 	// Cache geometry for L1
@@ -589,6 +783,29 @@ void Timing::RegisterOptions()
 			"accesses performed on pipeline queues, etc. This option is only valid for "
 			"detailed x86 simulation (option '--x86-sim detailed').");
 
+	// Option --x86-branch-eval <file>
+	command_line->RegisterString("--x86-branch-eval <file>", branch_eval_file,
+			"Run the branch predictor configured in section [ BranchPredictor ] "
+			"of the x86 configuration file on a trace of control instructions "
+			"generated with option '--x86-branch-trace', print a report of its "
+			"accuracy, and exit. The pipeline is not simulated.");
+
+	// Option --x86-cpi-stack <file>
+	command_line->RegisterString("--x86-cpi-stack <file>", cpi_stack_file,
+			"Dump a time series of the CPI stack of every hardware thread "
+			"into a file. Each line contains the cycle, core, thread, and "
+			"number of instructions committed in the last interval, followed "
+			"by the contribution to the CPI of each category of the stack. "
+			"The whole-run CPI stack is included in the report given with "
+			"option '--x86-report'.");
+
+	// Option --x86-cpi-stack-interval <cycles>
+	command_line->RegisterInt32("--x86-cpi-stack-interval <cycles> "
+			"(default = 10000)",
+			cpi_stack_interval,
+			"Number of cycles between lines of the CPI stack time series "
+			"given with option '--x86-cpi-stack'.");
+
 	// Option --x86-help
 	command_line->RegisterBool("--x86-help", help,
 			"Display a help message describing the format of the x86 Cpu context "
@@ -639,6 +856,12 @@ void Timing::ProcessOptions()
 					report_file.c_str()));
 	}
 
+	// Check CPI stack interval
+	if (cpi_stack_interval < 1)
+		throw Error(misc::fmt("Invalid value for option "
+				"'--x86-cpi-stack-interval' (%d)",
+				cpi_stack_interval));
+
 	// Print x86 configuration INI format
 	if (help)
 	{
@@ -646,12 +869,39 @@ void Timing::ProcessOptions()
 		exit(0);
 	}
 
+	// Check valid file in '--x86-branch-eval'
+	if (!branch_eval_file.empty())
+	{
+		std::ifstream is(branch_eval_file);
+		if (!is)
+			throw Error(misc::fmt("%s: Cannot open branch trace",
+					branch_eval_file.c_str()));
+	}
+
 	// Debuggers
 	TraceCache::debug.setPath(TraceCache::debug_file);
 	RegisterFile::debug.setPath(RegisterFile::debug_file);
 }
 
 
+void Timing::EvaluateBranchPredictor(std::ostream &os)
+{
+	// Branch predictor configuration
+	misc::IniFile ini_file;
+	if (!config_file.empty())
+		ini_file.Load(config_file);
+	BranchPredictor::ParseConfiguration(&ini_file);
+
+	// Run trace
+	std::ifstream is(branch_eval_file);
+	if (!is)
+		throw Error(misc::fmt("%s: Cannot open branch trace",
+				branch_eval_file.c_str()));
+	BranchPredictor branch_predictor("BranchPredictor");
+	branch_predictor.Evaluate(is, os);
+}
+
+
 void Timing::ParseConfiguration(misc::IniFile *ini_file)
 {
 	// Parse configuration by their sections
@@ -664,6 +914,13 @@ void Timing::ParseConfiguration(misc::IniFile *ini_file)
 
 	// Parse CPU configuration by their sections
 	Cpu::ParseConfiguration(ini_file);
+	if (Cpu::getNumFunctionalWarmingInstructions() < 0 ||
+			Cpu::getNumFunctionalWarmingInstructions()
+			> Cpu::getNumFastForwardInstructions())
+		throw Error(misc::fmt("%s: The value for 'FunctionalWarming' "
+				"must be between 0 and the value for "
+				"'FastForward'.\n",
+				ini_file->getPath().c_str()));
 
 	// Parse register file configuration by their sections
 	RegisterFile::ParseConfiguration(ini_file);
@@ -671,11 +928,21 @@ void Timing::ParseConfiguration(misc::IniFile *ini_file)
 	// Parse branch predictor configuration by their sections
 	BranchPredictor::ParseConfiguration(ini_file);
 
+	// Parse memory dependence predictor configuration
+	MemoryDependencePredictor::ParseConfiguration(ini_file);
+
 	// Parse trace cache configuration by their sections
 	TraceCache::ParseConfiguration(ini_file);
 
+	// Parse uop cache and loop stream detector configuration
+	UopCache::ParseConfiguration(ini_file);
+	LoopStreamDetector::ParseConfiguration(ini_file);
+
 	// Parse ALU configuration by their sections
 	Alu::ParseConfiguration(ini_file);
+
+	// Parse sampling configuration
+	Sampling::ParseConfiguration(ini_file);
 }
 
 
@@ -727,6 +994,10 @@ void Timing::DumpSummary(std::ostream &os) const
 			/ cpu->getNumBranches()
 			: 0.0;
 	os << misc::fmt("BranchPredictionAccuracy = %.4g\n", branch_accuracy);
+
+	// Sampled simulation estimates
+	if (sampling)
+		sampling->DumpSummary(os);
 }
 
 
@@ -784,6 +1055,33 @@ void Timing::DumpUopReport(std::ostream &os, const long long *uop_stats,
 }
 
 
+void Timing::DumpCpiStack(std::ostream &os, const long long *num_commit_slots,
+		long long num_instructions, int num_slots_per_cycle) const
+{
+	// Header
+	os << "; CPI stack. Commit slots (sum = cycles * commit width) are\n";
+	os << "; attributed to committed uops, or to the reason why the uop at\n";
+	os << "; the head of the reorder buffer could not commit. The\n";
+	os << "; contributions of all categories add up to the CPI.\n";
+	os << misc::fmt("Commit.Instructions = %lld\n", num_instructions);
+	os << misc::fmt("CPI = %.4f\n", num_instructions ?
+			(double) getCycle() / num_instructions : 0.0);
+
+	// Slots and contribution to the CPI for each category
+	for (int stall = Thread::CommitStallUsed;
+			stall < Thread::CommitStallMax; stall++)
+	{
+		const char *name = Thread::commit_stall_map[stall];
+		os << misc::fmt("Commit.Slots.%s = %lld\n", name,
+				num_commit_slots[stall]);
+		os << misc::fmt("CPI.%s = %.4f\n", name, num_instructions ?
+				(double) num_commit_slots[stall] /
+				num_slots_per_cycle / num_instructions : 0.0);
+	}
+	os << '\n';
+}
+
+
 void Timing::DumpReport() const
 {
 	// Ignore if no report file was specified
@@ -816,6 +1114,10 @@ void Timing::DumpReport() const
 	os << misc::fmt("CyclesPerSecond = %.0f\n", now ?
 			(double) getCycle() / now * 1e6 : 0.0);
 	os << '\n';
+
+	// Sampled simulation
+	if (sampling)
+		sampling->DumpReport(os);
 	
 	// Dispatch stage
 	os << "; Dispatch stage\n";
@@ -847,6 +1149,17 @@ void Timing::DumpReport() const
 			/ cpu->getNumBranches() : 0.0);
 	os << '\n';
 
+	// CPI stack
+	long long num_commit_slots[Thread::CommitStallMax] = {};
+	for (int i = 0; i < Cpu::getNumCores(); i++)
+		for (int stall = Thread::CommitStallUsed;
+				stall < Thread::CommitStallMax; stall++)
+			num_commit_slots[stall] += cpu->getCore(i)->
+					getNumCommitSlots((Thread::CommitStall) stall);
+	DumpCpiStack(os, num_commit_slots, cpu->getNumCommittedInstructions(),
+			Cpu::getCommitWidth() * Cpu::getNumThreads()
+			* Cpu::getNumCores());
+
 	// Report for each core
 	for (int i = 0; i < Cpu::getNumCores(); i++)
 	{
@@ -907,6 +1220,15 @@ void Timing::DumpReport() const
 				/ core->getNumBranches() : 0.0);
 		os << '\n';
 
+		// CPI stack
+		for (int stall = Thread::CommitStallUsed;
+				stall < Thread::CommitStallMax; stall++)
+			num_commit_slots[stall] = core->getNumCommitSlots(
+					(Thread::CommitStall) stall);
+		DumpCpiStack(os, num_commit_slots,
+				core->getNumCommittedInstructions(),
+				Cpu::getCommitWidth() * Cpu::getNumThreads());
+
 		// Occupancy statistics
 		os << "; Structure statistics (reorder buffer, instruction queue,\n";
 		os << "; load-store queue, and integer/floating-point/XMM register file)\n";
@@ -993,6 +1315,27 @@ void Timing::DumpReport() const
 					/ thread->getNumBranches() : 0.0);
 			os << '\n';
 
+			// CPI stack
+			for (int stall = Thread::CommitStallUsed;
+					stall < Thread::CommitStallMax; stall++)
+				num_commit_slots[stall] = thread->getNumCommitSlots(
+						(Thread::CommitStall) stall);
+			DumpCpiStack(os, num_commit_slots,
+					thread->getNumCommittedInstructions(),
+					Cpu::getCommitWidth());
+
+			// Memory dependences
+			MemoryDependencePredictor *memory_dependence_predictor =
+					thread->getMemoryDependencePredictor();
+			os << "; Memory dependences\n";
+			os << ";    Forwarded - Loads obtaining their data from the store queue\n";
+			os << ";    Violations - Loads issued before an older store to the same location\n";
+			os << misc::fmt("LSQ.Forwarded = %lld\n", thread->getNumForwardedLoads());
+			os << misc::fmt("LSQ.Violations = %lld\n", thread->getNumMemoryViolations());
+			os << misc::fmt("LSQ.DependenceLookups = %lld\n", memory_dependence_predictor->getNumLookups());
+			os << misc::fmt("LSQ.DependenceWaits = %lld\n", memory_dependence_predictor->getNumWaitPredictions());
+			os << '\n';
+
 			// Occupancy statistics
 			os << "; Structure statistics (reorder buffer, instruction queue,\n";
 			os << "; load-store queue, integer/floating-point/XMM register file,\n";
@@ -1049,6 +1392,7 @@ void Timing::DumpReport() const
 			os << misc::fmt("RAT.FpWrites = %lld\n", register_file->getNumFloatingPointRatWrites());
 			os << misc::fmt("RAT.XmmReads = %lld\n", register_file->getNumXmmRatReads());
 			os << misc::fmt("RAT.XmmWrites = %lld\n", register_file->getNumXmmRatWrites());
+			os << misc::fmt("RAT.CheckpointRecoveries = %lld\n", register_file->getNumCheckpointRecoveries());
 
 			// Branch target buffer statistics
 			os << misc::fmt("BTB.Reads = %lld\n", thread->getNumBtbReads());
@@ -1061,6 +1405,17 @@ void Timing::DumpReport() const
 			TraceCache *trace_cache = thread->getTraceCache();
 			if (TraceCache::isPresent() && trace_cache)
 				trace_cache->DumpReport(os);
+
+			// Uop cache statistics
+			UopCache *uop_cache = thread->getUopCache();
+			if (uop_cache)
+				uop_cache->DumpReport(os);
+
+			// Loop stream detector statistics
+			LoopStreamDetector *loop_stream_detector =
+					thread->getLoopStreamDetector();
+			if (loop_stream_detector)
+				loop_stream_detector->DumpReport(os);
 		}
 	}
 }
@@ -1074,6 +1429,7 @@ void Timing::DumpConfiguration(std::ofstream &os) const
 	os << misc::fmt("Cores = %d\n", cpu->getNumCores());
 	os << misc::fmt("Threads = %d\n", cpu->getNumThreads());
 	os << misc::fmt("FastForward = %lld\n", cpu->getNumFastForwardInstructions());
+	os << misc::fmt("FunctionalWarming = %lld\n", cpu->getNumFunctionalWarmingInstructions());
 	os << misc::fmt("ContextQuantum = %d\n", cpu->getContextQuantum());
 	os << misc::fmt("ThreadQuantum = %d\n", cpu->getThreadQuantum());
 	os << misc::fmt("ThreadSwitchPenalty = %d\n", cpu->getThreadSwitchPenalty());
@@ -1104,6 +1460,7 @@ void Timing::DumpConfiguration(std::ofstream &os) const
 	os << misc::fmt("IqSize = %d\n", cpu->getInstructionQueueSize());
 	os << misc::fmt("LsqKind = %s\n", cpu->load_store_queue_kind_map[cpu->getLoadStoreQueueKind()]);
 	os << misc::fmt("LsqSize = %d\n", cpu->getLoadStoreQueueSize());
+	os << misc::fmt("LsqForwardLatency = %d\n", cpu->getLoadStoreQueueForwardLatency());
 	os << misc::fmt("RfKind = %s\n", RegisterFile::KindMap[RegisterFile::getKind()]);
 	os << misc::fmt("RfIntSize = %d\n", RegisterFile::getIntegerSize());
 	os << misc::fmt("RfFpSize = %d\n", RegisterFile::getFloatingPointSize());
@@ -1120,6 +1477,25 @@ void Timing::DumpConfiguration(std::ofstream &os) const
 	os << misc::fmt("QueueSize = %d\n", TraceCache::getQueueSize());
 	os << misc::fmt("\n");
 
+	// Uop cache
+	os << misc::fmt("[ Config.UopCache ]\n");
+	os << misc::fmt("Present = %s\n", UopCache::isPresent() ? "True" : "False");
+	os << misc::fmt("Sets = %d\n", UopCache::getNumSets());
+	os << misc::fmt("Assoc = %d\n", UopCache::getNumWays());
+	os << misc::fmt("WindowSize = %d\n", UopCache::getWindowSize());
+	os << misc::fmt("MaxUops = %d\n", UopCache::getMaxUops());
+	os << misc::fmt("Width = %d\n", UopCache::getWidth());
+	os << misc::fmt("QueueSize = %d\n", UopCache::getQueueSize());
+	os << misc::fmt("\n");
+
+	// Loop stream detector
+	os << misc::fmt("[ Config.LoopStreamDetector ]\n");
+	os << misc::fmt("Present = %s\n", LoopStreamDetector::isPresent() ? "True" : "False");
+	os << misc::fmt("Size = %d\n", LoopStreamDetector::getSize());
+	os << misc::fmt("LockIterations = %d\n", LoopStreamDetector::getNumLockIterations());
+	os << misc::fmt("Width = %d\n", LoopStreamDetector::getWidth());
+	os << misc::fmt("\n");
+
 	// ALU
 	Alu::DumpConfiguration(os);
 
@@ -1135,8 +1511,33 @@ void Timing::DumpConfiguration(std::ofstream &os) const
 	os << misc::fmt("TwoLevel.L2Size = %d\n", BranchPredictor::getTwoLevelL2Size());
 	os << misc::fmt("TwoLevel.L2Height = %d\n", BranchPredictor::getTwoLevelL2Height());
 	os << misc::fmt("TwoLevel.HistorySize = %d\n", BranchPredictor::getTwoLevelHistorySize());
+	os << misc::fmt("TAGE.NumTables = %d\n", BranchPredictor::getTageNumTables());
+	os << misc::fmt("TAGE.TableSize = %d\n", BranchPredictor::getTageTableSize());
+	os << misc::fmt("TAGE.TagBits = %d\n", BranchPredictor::getTageTagBits());
+	os << misc::fmt("TAGE.MinHistory = %d\n", BranchPredictor::getTageMinHistory());
+	os << misc::fmt("TAGE.MaxHistory = %d\n", BranchPredictor::getTageMaxHistory());
+	os << misc::fmt("Perceptron.NumTables = %d\n", BranchPredictor::getPerceptronNumTables());
+	os << misc::fmt("Perceptron.TableSize = %d\n", BranchPredictor::getPerceptronTableSize());
+	os << misc::fmt("Perceptron.HistorySize = %d\n", BranchPredictor::getPerceptronHistorySize());
+	os << misc::fmt("Indirect = %s\n", BranchPredictor::IndirectKindMap[BranchPredictor::getIndirectKind()]);
+	os << misc::fmt("ITTAGE.NumTables = %d\n", BranchPredictor::getIttageNumTables());
+	os << misc::fmt("ITTAGE.TableSize = %d\n", BranchPredictor::getIttageTableSize());
+	os << misc::fmt("ITTAGE.TagBits = %d\n", BranchPredictor::getIttageTagBits());
+	os << misc::fmt("ITTAGE.MinHistory = %d\n", BranchPredictor::getIttageMinHistory());
+	os << misc::fmt("ITTAGE.MaxHistory = %d\n", BranchPredictor::getIttageMaxHistory());
+	os << misc::fmt("\n");
+
+	// Memory dependence predictor
+	os << misc::fmt("[ Config.MemoryDependencePredictor ]\n");
+	os << misc::fmt("Kind = %s\n", MemoryDependencePredictor::KindMap[MemoryDependencePredictor::getKind()]);
+	os << misc::fmt("LoadWait.Size = %d\n", MemoryDependencePredictor::getLoadWaitSize());
+	os << misc::fmt("LoadWait.ClearInterval = %d\n", MemoryDependencePredictor::getLoadWaitClearInterval());
+	os << misc::fmt("ViolationPenalty = %d\n", MemoryDependencePredictor::getViolationPenalty());
 	os << misc::fmt("\n");
 
+	// Sampling
+	Sampling::DumpConfiguration(os);
+
 	// End of configuration
 	os << '\n';
 }
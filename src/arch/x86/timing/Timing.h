@@ -20,6 +20,8 @@
 #ifndef ARCH_X86_TIMING_TIMING_H
 #define ARCH_X86_TIMING_TIMING_H
 
+#include <fstream>
+
 #include <lib/cpp/String.h>
 #include <lib/cpp/Debug.h>
 #include <lib/cpp/CommandLine.h>
@@ -30,6 +32,7 @@
 
 #include "BranchPredictor.h"
 #include "Cpu.h"
+#include "Sampling.h"
 #include "TraceCache.h"
 
 
@@ -61,6 +64,15 @@ class Timing : public comm::Timing
 	// Report file name
 	static std::string report_file;
 
+	// Branch trace file passed with option '--x86-branch-eval'
+	static std::string branch_eval_file;
+
+	// CPI stack time series file passed with option '--x86-cpi-stack'
+	static std::string cpi_stack_file;
+
+	// Number of cycles between lines of the CPI stack time series
+	static int cpi_stack_interval;
+
 	// If true, show a message describing the format for the x86
 	// configuration file. Passed with option --x86-help.
 	static bool help;
@@ -80,13 +92,25 @@ class Timing : public comm::Timing
 	// CPU object
 	std::unique_ptr<Cpu> cpu;
 
+	// Sampling controller, or nullptr if sampling is not enabled
+	std::unique_ptr<Sampling> sampling;
+
 	// List of entry modules to the memory hierarchy
 	std::vector<mem::Module *> entry_modules;
 
+	// Output stream for the CPI stack time series
+	std::ofstream cpi_stack_os;
+
 	// Dump a specific part of a statistics report related with uops.
 	void DumpUopReport(std::ostream &os, const long long *uop_stats,
 			const std::string &prefix, int peak_ipc) const;
 
+	// Dump the CPI stack given the number of commit slots attributed to
+	// each category, the number of committed instructions, and the number
+	// of commit slots per cycle.
+	void DumpCpiStack(std::ostream &os, const long long *num_commit_slots,
+			long long num_instructions, int num_slots_per_cycle) const;
+
 public:
 
 	//
@@ -143,6 +167,12 @@ public:
 	/// Fast forward instructions set up by the user
 	void FastForward();
 
+	/// Run the last instructions of the fast-forward, as given by
+	/// variable 'FunctionalWarming' in section [ General ], warming up the
+	/// caches and predictors of the hardware threads that contexts are
+	/// mapped to.
+	void FunctionalWarming();
+
 	/// Run one iteration of the cpu timing simuation.
 	/// \return This function \c true if the iteration had a useful
 	/// timing simulation, and \c false if all timing simulation finished
@@ -207,8 +237,25 @@ public:
 	/// Parse the configuration file
 	static void ParseConfiguration(misc::IniFile *ini_file);
 
+	/// Return whether option '--x86-branch-eval' was given. In this case,
+	/// the branch predictor is evaluated with EvaluateBranchPredictor()
+	/// instead of running a simulation.
+	static bool isBranchEvaluation() { return !branch_eval_file.empty(); }
+
+	/// Run the branch predictor described in the configuration file on
+	/// the branch trace given with option '--x86-branch-eval', and dump
+	/// a report of its accuracy into \a os.
+	static void EvaluateBranchPredictor(std::ostream &os = std::cout);
+
 	/// Return the simulation level set by command-line options '--x86-sim'
 	static comm::Arch::SimKind getSimKind() { return sim_kind; }
+
+	/// Override the simulation level set by command-line option
+	/// '--x86-sim'. This must be invoked before ProcessOptions().
+	static void setSimKind(comm::Arch::SimKind sim_kind)
+	{
+		Timing::sim_kind = sim_kind;
+	}
 };
 
 } //namespace x86
@@ -36,9 +36,9 @@ Uop::Uop(Thread *thread,
 		uinst(uinst)
 {
 	// Initialize
-	core = thread->getCore();
+	core = thread ? thread->getCore() : nullptr;
 	id = ++id_counter;
-	id_in_core = core->getUopId();
+	id_in_core = core ? core->getUopId() : 0;
 
 	// Assign flags from associated micro-instruction
 	flags = uinst->getFlags();
@@ -25,10 +25,16 @@
 #include <arch/x86/emulator/Uinst.h>
 #include <arch/x86/emulator/Context.h>
 #include <lib/cpp/Misc.h>
+#include <lib/cpp/Slab.h>
 
 #include "BranchPredictor.h"
 
 
+namespace mem
+{
+class Module;
+}
+
 namespace x86
 {
 
@@ -37,8 +43,9 @@ class Core;
 class Thread;
 
 
-// Class Uop
-class Uop
+// Class Uop. Uops created by the pipeline are allocated in the slab of
+// their core and referenced with misc::SlabPtr handles.
+class Uop : public misc::SlabObject
 {
 	//
 	// Static fields
@@ -126,7 +133,8 @@ public:
 	/// Constructor
 	///
 	/// \param thread
-	///	Hardware thread that this uop belongs to.
+	///	Hardware thread that this uop belongs to, or `nullptr` for uops
+	///	created to run the branch predictor outside of the pipeline.
 	///
 	/// \param context
 	///	Emulator context that this uop is associated with.
@@ -169,6 +177,14 @@ public:
 	/// Get flags
 	int getFlags() const { return flags; }
 
+	/// Return whether the uop was fetched already decoded, from the trace
+	/// cache, the uop cache, or the loop stream detector.
+	bool isDecoded() const
+	{
+		return from_trace_cache || from_uop_cache ||
+				from_loop_stream_detector;
+	}
+
 	/// Set input physical register dependency
 	void setInput(int index, int physical_register)
 	{
@@ -265,36 +281,27 @@ public:
 	/// True if the instruction is currently in the fetch queue
 	bool in_fetch_queue = false;
 
-	/// Position of the uop in the thread's fetch queue
-	std::list<std::shared_ptr<Uop>>::iterator fetch_queue_iterator;
-
 	/// True if the instruction is currently in the uop queue
 	bool in_uop_queue = false;
 
-	/// Position of the uop in the thread's uop queue
-	std::list<std::shared_ptr<Uop>>::iterator uop_queue_iterator;
-
 	/// True if the instruction is currently in the core's event queue
 	bool in_event_queue = false;
 
 	/// Position of the uop in the core's event queue, or past-the-end
 	/// iterator to this queue if not present.
-	std::list<std::shared_ptr<Uop>>::iterator event_queue_iterator;
+	std::list<misc::SlabPtr<Uop>>::iterator event_queue_iterator;
 
 	/// True if the instruction is currently present in the thread's
 	/// reorder buffer
 	bool in_reorder_buffer = false;
 
-	/// Position of the uop in the reorder buffer, if present
-	std::list<std::shared_ptr<Uop>>::iterator reorder_buffer_iterator;
-
 	/// True if the instruction is currently present in the thread's
 	/// instruction queue
 	bool in_instruction_queue = false;
 
 	/// Position of the uop in the thread's instruction queue, or past-the-
 	/// end iterator to this queue if not present.
-	std::list<std::shared_ptr<Uop>>::iterator instruction_queue_iterator;
+	std::list<misc::SlabPtr<Uop>>::iterator instruction_queue_iterator;
 
 	/// True if the instruction is currently present in the thread's
 	/// load queue
@@ -302,7 +309,7 @@ public:
 
 	/// Position of the uop in the thread's load queue, or past-the-end
 	/// iterator to this queue if not present.
-	std::list<std::shared_ptr<Uop>>::iterator load_queue_iterator;
+	std::list<misc::SlabPtr<Uop>>::iterator load_queue_iterator;
 
 	/// True if the instruction is currently present in the thread's
 	/// store queue
@@ -310,14 +317,14 @@ public:
 
 	/// Position of the uop in the thread's store queue, or past-the-end
 	/// iterator to this queue if not present.
-	std::list<std::shared_ptr<Uop>>::iterator store_queue_iterator;
+	std::list<misc::SlabPtr<Uop>>::iterator store_queue_iterator;
 
 	/// True if the instruction is currently present in the uop trace list
 	/// of the CPU
 	bool in_trace_list = false;
 
 	/// Position of the uop in the CPU's trace list, if present
-	std::list<std::shared_ptr<Uop>>::iterator trace_list_iterator;
+	std::list<misc::SlabPtr<Uop>>::iterator trace_list_iterator;
 
 
 
@@ -360,6 +367,13 @@ public:
 
 	/// Flag indicating whether the uop was fetched from the trace cache
 	bool from_trace_cache = false;
+
+	/// Flag indicating whether the uop was fetched from the uop cache
+	bool from_uop_cache = false;
+
+	/// Flag indicating whether the uop was streamed by the loop stream
+	/// detector
+	bool from_loop_stream_detector = false;
 	
 	/// Physical address that this uop was fetched from
 	unsigned fetch_address = 0;
@@ -370,6 +384,27 @@ public:
 	// For memory uops, unique identifier of memory access
 	long long memory_access = 0;
 
+	/// For loads, cycle until which commit is delayed to model the replay
+	/// of a load that issued before an older store writing to the same
+	/// location, or 0 if no memory ordering violation was detected.
+	long long replay_when = 0;
+
+	/// Level of the memory hierarchy supplying the data of a load
+	enum MemoryLevel
+	{
+		MemoryLevelInvalid = 0,		// Load not issued yet
+		MemoryLevelL1,			// First-level cache or store queue
+		MemoryLevelL2,			// Second-level cache
+		MemoryLevelLlc,			// Any lower-level cache
+		MemoryLevelMemory		// Main memory
+	};
+
+	/// For loads, deepest module of the memory hierarchy reached by the
+	/// access while in flight, and module that supplied the data once
+	/// completed. Loads forwarded from the store queue use the data
+	/// cache. Updated by the memory system.
+	mem::Module *memory_module = nullptr;
+
 	/// Access identifier for instruction fetch
 	long long fetch_access = 0;
 
@@ -413,6 +448,33 @@ public:
 
 	/// Prediction in the combined branch predictor
 	BranchPredictor::Prediction choice_prediction = BranchPredictor::PredictionNotTaken;
+
+	/// Indexes into the tables of the TAGE, perceptron, or ITTAGE
+	/// predictors
+	int predictor_index[BranchPredictor::MaxTables];
+
+	/// Tags computed for the tables of the TAGE or ITTAGE predictors
+	unsigned short predictor_tag[BranchPredictor::MaxTables];
+
+	/// Tagged table of the TAGE or ITTAGE predictors providing the
+	/// prediction, or -1 if no tagged entry matched
+	int predictor_provider = -1;
+
+	/// Tagged table of the TAGE predictor providing the alternate
+	/// prediction, or -1 if it came from the bimodal table
+	int tage_alt_provider = -1;
+
+	/// Prediction of the TAGE provider entry
+	BranchPredictor::Prediction tage_provider_prediction = BranchPredictor::PredictionNotTaken;
+
+	/// Alternate TAGE prediction
+	BranchPredictor::Prediction tage_alt_prediction = BranchPredictor::PredictionNotTaken;
+
+	/// Output of the perceptron predictor
+	int perceptron_output = 0;
+
+	/// True if the ITTAGE predictor was looked up for this uop
+	bool ittage_lookup = false;
 	
 	
 	
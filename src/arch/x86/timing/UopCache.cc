@@ -0,0 +1,222 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cassert>
+
+#include <lib/cpp/Misc.h>
+#include <lib/cpp/String.h>
+
+#include "UopCache.h"
+
+
+namespace x86
+{
+
+bool UopCache::present;
+int UopCache::num_sets;
+int UopCache::num_ways;
+int UopCache::window_size;
+int UopCache::max_uops;
+int UopCache::width;
+int UopCache::queue_size;
+
+
+void UopCache::ParseConfiguration(misc::IniFile *ini_file)
+{
+	// Section
+	std::string section = "UopCache";
+
+	// Read variables
+	present = ini_file->ReadBool(section, "Present", false);
+	num_sets = ini_file->ReadInt(section, "Sets", 32);
+	num_ways = ini_file->ReadInt(section, "Assoc", 8);
+	window_size = ini_file->ReadInt(section, "WindowSize", 32);
+	max_uops = ini_file->ReadInt(section, "MaxUops", 18);
+	width = ini_file->ReadInt(section, "Width", 6);
+	queue_size = ini_file->ReadInt(section, "QueueSize", 32);
+
+	// Integrity checks
+	if ((num_sets & (num_sets - 1)) || num_sets < 1)
+		throw Error(misc::fmt("%s: 'Sets' must be a power of 2 greater than 0", section.c_str()));
+	if (num_ways < 1)
+		throw Error(misc::fmt("%s: 'Assoc' must be greater than 0", section.c_str()));
+	if ((window_size & (window_size - 1)) || window_size < 1)
+		throw Error(misc::fmt("%s: 'WindowSize' must be a power of 2 greater than 0", section.c_str()));
+	if (max_uops < 1)
+		throw Error(misc::fmt("%s: Invalid value for 'MaxUops'", section.c_str()));
+	if (width < 1)
+		throw Error(misc::fmt("%s: Invalid value for 'Width'", section.c_str()));
+	if (queue_size < 1)
+		throw Error(misc::fmt("%s: Invalid value for 'QueueSize'", section.c_str()));
+}
+
+
+void UopCache::DumpConfiguration(std::ostream &os)
+{
+	os << "; Uop cache - parameters\n";
+	os << misc::fmt("UopCache.Sets = %d\n", num_sets);
+	os << misc::fmt("UopCache.Assoc = %d\n", num_ways);
+	os << misc::fmt("UopCache.WindowSize = %d\n", window_size);
+	os << misc::fmt("UopCache.MaxUops = %d\n", max_uops);
+	os << misc::fmt("UopCache.Width = %d\n", width);
+	os << misc::fmt("UopCache.QueueSize = %d\n", queue_size);
+	os << '\n';
+}
+
+
+UopCache::UopCache(const std::string &name) :
+		name(name)
+{
+	// Initialize entries and LRU counters
+	entries = misc::new_unique_array<Entry>(num_sets * num_ways);
+	for (int set = 0; set < num_sets; set++)
+		for (int way = 0; way < num_ways; way++)
+			entries[set * num_ways + way].counter = way;
+}
+
+
+void UopCache::DumpReport(std::ostream &os)
+{
+	// Dump the configuration
+	DumpConfiguration(os);
+
+	// Statistics
+	os << "; Uop cache - statistics\n";
+	os << misc::fmt("UopCache.Accesses = %lld\n", num_accesses);
+	os << misc::fmt("UopCache.Hits = %lld\n", num_hits);
+	os << misc::fmt("UopCache.HitRatio = %.4g\n", num_accesses ?
+			(double) num_hits / num_accesses : 0.0);
+	os << misc::fmt("UopCache.Fills = %lld\n", num_fills);
+	os << misc::fmt("UopCache.Evictions = %lld\n", num_evictions);
+	os << misc::fmt("UopCache.Fetched = %lld\n", num_fetched_uinsts);
+	os << misc::fmt("UopCache.Committed = %lld\n", num_committed_uinsts);
+	os << '\n';
+}
+
+
+bool UopCache::Lookup(unsigned eip)
+{
+	// Stats
+	num_accesses++;
+
+	// Search window
+	unsigned tag = getWindow(eip);
+	int set = (tag / window_size) & (num_sets - 1);
+	Entry *found = nullptr;
+	for (int way = 0; way < num_ways; way++)
+	{
+		Entry *entry = &entries[set * num_ways + way];
+		if (entry->valid && entry->tag == tag && eip >= entry->start)
+		{
+			found = entry;
+			break;
+		}
+	}
+
+	// Miss
+	if (!found)
+		return false;
+
+	// Update LRU counters
+	for (int way = 0; way < num_ways; way++)
+	{
+		Entry *entry = &entries[set * num_ways + way];
+		if (entry->counter > found->counter)
+			entry->counter--;
+	}
+	found->counter = num_ways - 1;
+
+	// Hit
+	num_hits++;
+	return true;
+}
+
+
+void UopCache::Fill()
+{
+	// Nothing to insert, or window exceeding capacity
+	if (!fill_num_uops || fill_num_uops > max_uops)
+		return;
+
+	// Look for the window, or replace the LRU entry
+	int set = (fill_window / window_size) & (num_sets - 1);
+	Entry *found = nullptr;
+	for (int way = 0; way < num_ways; way++)
+	{
+		Entry *entry = &entries[set * num_ways + way];
+		if (entry->valid && entry->tag == fill_window)
+			found = entry;
+		else if (!found && entry->counter == 0)
+			found = entry;
+	}
+	assert(found);
+
+	// A window already present only grows when decoded from an earlier
+	// entry point.
+	if (found->valid && found->tag == fill_window)
+	{
+		if (fill_start >= found->start)
+			return;
+	}
+	else if (found->valid)
+	{
+		num_evictions++;
+	}
+
+	// Update LRU counters
+	for (int way = 0; way < num_ways; way++)
+	{
+		Entry *entry = &entries[set * num_ways + way];
+		if (entry->counter > found->counter)
+			entry->counter--;
+	}
+	found->counter = num_ways - 1;
+
+	// Insert
+	found->valid = true;
+	found->tag = fill_window;
+	found->start = fill_start;
+	found->num_uops = fill_num_uops;
+	num_fills++;
+}
+
+
+void UopCache::RecordUop(Uop *uop)
+{
+	// Only the first uop of each macro-instruction is considered
+	if (uop->mop_index)
+		return;
+
+	// The instruction does not follow the previous one in the window being
+	// filled. Insert that window and start a new one.
+	unsigned window = getWindow(uop->eip);
+	if (window != fill_window || uop->eip != fill_neip)
+	{
+		Fill();
+		fill_window = window;
+		fill_start = uop->eip;
+		fill_num_uops = 0;
+	}
+
+	// Add uops of the macro-instruction
+	fill_num_uops += uop->mop_count;
+	fill_neip = uop->eip + uop->mop_size;
+}
+
+}  // namespace x86
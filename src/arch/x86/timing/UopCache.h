@@ -0,0 +1,232 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef ARCH_X86_TIMING_UOP_CACHE_H
+#define ARCH_X86_TIMING_UOP_CACHE_H
+
+#include <lib/cpp/Error.h>
+#include <lib/cpp/IniFile.h>
+
+#include "Uop.h"
+
+
+namespace x86
+{
+
+/// Cache of decoded micro-instructions. Each entry holds the uops decoded
+/// from one aligned window of instruction bytes. Instructions fetched from
+/// a window present in the uop cache bypass the instruction cache and the
+/// decode stage. Entries are filled in the decode stage with the uops
+/// produced by the decoders.
+class UopCache
+{
+public:
+
+	/// Exception for the x86 uop cache
+	class Error : public misc::Error
+	{
+	public:
+
+		Error(const std::string &message) : misc::Error(message)
+		{
+			AppendPrefix("x86 uop cache");
+		}
+	};
+
+private:
+
+	//
+	// Static fields
+	//
+
+	// Flag indicating whether the uop cache is present
+	static bool present;
+
+	// Number of sets
+	static int num_sets;
+
+	// Associativity
+	static int num_ways;
+
+	// Size of the instruction windows in bytes
+	static int window_size;
+
+	// Maximum number of uops in one window
+	static int max_uops;
+
+	// Number of uops that can be delivered per cycle
+	static int width;
+
+	// Size of the queue of uops delivered by the uop cache
+	static int queue_size;
+
+
+
+
+	//
+	// Class members
+	//
+
+	// Uop cache entry
+	struct Entry
+	{
+		// Window address
+		unsigned tag = 0;
+
+		// Address of the first instruction decoded in the window
+		unsigned start = 0;
+
+		// Number of uops in the window
+		int num_uops = 0;
+
+		// Valid entry
+		bool valid = false;
+
+		// LRU counter
+		int counter = 0;
+	};
+
+	// Name of the uop cache
+	std::string name;
+
+	// Entries (num_sets * num_ways elements)
+	std::unique_ptr<Entry[]> entries;
+
+	// Window being filled by the decode stage, the address of its first
+	// instruction, the address expected for the next instruction decoded,
+	// and the number of uops decoded in it so far.
+	unsigned fill_window = 0;
+	unsigned fill_start = 0;
+	unsigned fill_neip = 0;
+	int fill_num_uops = 0;
+
+	// Insert the window being filled into the uop cache
+	void Fill();
+
+
+
+
+	//
+	// Statistics
+	//
+
+	// Number of accesses
+	long long num_accesses = 0;
+
+	// Number of hits
+	long long num_hits = 0;
+
+	// Number of windows inserted
+	long long num_fills = 0;
+
+	// Number of valid windows replaced
+	long long num_evictions = 0;
+
+	// Number of fetched micro-instructions
+	long long num_fetched_uinsts = 0;
+
+	// Number of committed micro-instructions coming from the uop cache
+	long long num_committed_uinsts = 0;
+
+public:
+
+	//
+	// Static members
+	//
+
+	/// Read uop cache configuration from configuration file
+	static void ParseConfiguration(misc::IniFile *ini_file);
+
+	/// Dump configuration
+	static void DumpConfiguration(std::ostream &os = std::cout);
+
+	/// Return whether the uop cache was configured as present
+	static bool isPresent() { return present; }
+
+	/// Return the number of sets, as configured by the user
+	static int getNumSets() { return num_sets; }
+
+	/// Return the number of ways, as configured by the user
+	static int getNumWays() { return num_ways; }
+
+	/// Return the window size in bytes, as configured by the user
+	static int getWindowSize() { return window_size; }
+
+	/// Return the maximum number of uops in a window
+	static int getMaxUops() { return max_uops; }
+
+	/// Return the number of uops delivered per cycle
+	static int getWidth() { return width; }
+
+	/// Return the size of the queue of uops delivered by the uop cache
+	static int getQueueSize() { return queue_size; }
+
+	/// Return the address of the window containing address \a eip
+	static unsigned getWindow(unsigned eip) { return eip & ~(window_size - 1); }
+
+
+
+
+	//
+	// Class members
+	//
+
+	/// Constructor
+	UopCache(const std::string &name = "");
+
+	/// Dump the uop cache report
+	void DumpReport(std::ostream &os = std::cout);
+
+	/// Look up the window containing the instruction at address \a eip.
+	/// The function returns true if the window is present, and its uops
+	/// include the instruction.
+	bool Lookup(unsigned eip);
+
+	/// Record a uop produced by the decoders. The uops of consecutive
+	/// instructions in the same window are collected, and inserted into
+	/// the uop cache when decoding leaves the window.
+	void RecordUop(Uop *uop);
+
+
+
+
+	//
+	// Statistics
+	//
+
+	/// Increment number of fetched micro-instructions
+	void incNumFetchedUinsts() { num_fetched_uinsts++; }
+
+	/// Increment the number of committed micro-instructions coming from
+	/// the uop cache
+	void incNumCommittedUinsts() { num_committed_uinsts++; }
+
+	/// Return the number of accesses
+	long long getNumAccesses() const { return num_accesses; }
+
+	/// Return the number of hits
+	long long getNumHits() const { return num_hits; }
+
+	/// Return the number of windows inserted
+	long long getNumFills() const { return num_fills; }
+};
+
+}  // namespace x86
+
+#endif
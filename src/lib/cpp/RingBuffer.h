@@ -0,0 +1,196 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LIB_CPP_RING_BUFFER_H
+#define LIB_CPP_RING_BUFFER_H
+
+#include <cassert>
+#include <utility>
+#include <vector>
+
+
+namespace misc
+{
+
+/// Double-ended queue stored in a circular buffer, supporting insertion at
+/// the tail and extraction at both ends. The buffer is allocated once with
+/// the capacity given in the constructor, typically the size of a hardware
+/// structure, and it only grows in the rare case where more elements than
+/// that are inserted.
+template<typename T> class RingBuffer
+{
+	// Storage, with a number of elements that is a power of two
+	std::vector<T> buffer;
+
+	// Mask applied to positions to wrap them around the buffer
+	int mask = 0;
+
+	// Position of the first element
+	int head = 0;
+
+	// Number of elements in the buffer
+	int size = 0;
+
+	// Double the capacity of the buffer, moving all elements to the
+	// beginning of the new storage.
+	void Grow()
+	{
+		std::vector<T> new_buffer(buffer.size() * 2);
+		for (int i = 0; i < size; i++)
+			new_buffer[i] = std::move(buffer[(head + i) & mask]);
+		buffer.swap(new_buffer);
+		mask = buffer.size() - 1;
+		head = 0;
+	}
+
+public:
+
+	/// Iterator to an element of the ring buffer, traversing it from head
+	/// to tail.
+	class Iterator
+	{
+		// Ring buffer
+		RingBuffer *ring_buffer;
+
+		// Index of the element, relative to the head
+		int index;
+
+	public:
+
+		/// Constructor
+		Iterator(RingBuffer *ring_buffer, int index) :
+				ring_buffer(ring_buffer),
+				index(index)
+		{
+		}
+
+		/// Return the element pointed to by the iterator
+		T &operator*() const { return (*ring_buffer)[index]; }
+
+		/// Access a field of the element pointed to by the iterator
+		T *operator->() const { return &(*ring_buffer)[index]; }
+
+		/// Advance to the next element
+		Iterator &operator++()
+		{
+			index++;
+			return *this;
+		}
+
+		/// Compare iterators
+		bool operator==(const Iterator &other) const
+		{
+			return index == other.index;
+		}
+
+		/// Compare iterators
+		bool operator!=(const Iterator &other) const
+		{
+			return index != other.index;
+		}
+	};
+
+	/// Constructor, allocating space for at least the given number of
+	/// elements.
+	explicit RingBuffer(int capacity = 16)
+	{
+		int buffer_size = 1;
+		while (buffer_size < capacity)
+			buffer_size <<= 1;
+		buffer.resize(buffer_size);
+		mask = buffer_size - 1;
+	}
+
+	/// Return the number of elements in the buffer
+	int getSize() const { return size; }
+
+	/// Return whether the buffer is empty
+	bool isEmpty() const { return !size; }
+
+	/// Return the number of elements that fit in the buffer before it
+	/// needs to grow.
+	int getCapacity() const { return buffer.size(); }
+
+	/// Return the element in the given position, counting from the head
+	T &operator[](int index)
+	{
+		assert(index >= 0 && index < size);
+		return buffer[(head + index) & mask];
+	}
+
+	/// Return the element in the given position, counting from the head
+	const T &operator[](int index) const
+	{
+		assert(index >= 0 && index < size);
+		return buffer[(head + index) & mask];
+	}
+
+	/// Return the element at the head of the buffer
+	T &Front() { return (*this)[0]; }
+
+	/// Return the element at the tail of the buffer
+	T &Back() { return (*this)[size - 1]; }
+
+	/// Return an iterator to the element at the head
+	Iterator begin() { return Iterator(this, 0); }
+
+	/// Return a past-the-end iterator
+	Iterator end() { return Iterator(this, size); }
+
+	/// Insert an element at the tail of the buffer
+	void PushBack(T value)
+	{
+		if (size == (int) buffer.size())
+			Grow();
+		buffer[(head + size) & mask] = std::move(value);
+		size++;
+	}
+
+	/// Remove the element at the head of the buffer. The slot is reset,
+	/// so that resources held by the element are released.
+	void PopFront()
+	{
+		assert(size > 0);
+		buffer[head] = T();
+		head = (head + 1) & mask;
+		size--;
+	}
+
+	/// Remove the element at the tail of the buffer. The slot is reset,
+	/// so that resources held by the element are released.
+	void PopBack()
+	{
+		assert(size > 0);
+		size--;
+		buffer[(head + size) & mask] = T();
+	}
+
+	/// Remove all elements
+	void Clear()
+	{
+		while (size)
+			PopBack();
+		head = 0;
+	}
+};
+
+
+}  // namespace misc
+
+#endif
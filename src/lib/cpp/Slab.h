@@ -0,0 +1,277 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LIB_CPP_SLAB_H
+#define LIB_CPP_SLAB_H
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+
+namespace misc
+{
+
+/// Allocator of fixed-size memory blocks. Blocks are carved out of large
+/// chunks of memory, and freed blocks are kept in a free list to be reused
+/// by later allocations, avoiding a call to the heap allocator per object
+/// for objects that are created and destroyed at a high rate. The block
+/// size is fixed by the first allocation. Memory is only returned to the
+/// heap when the slab is destroyed, so all objects allocated from it must
+/// have been destroyed by then.
+class Slab
+{
+	// Free block, storing a pointer to the next one in its first bytes
+	struct FreeBlock
+	{
+		FreeBlock *next;
+	};
+
+	// Size of each block in bytes, or 0 before the first allocation
+	size_t block_size = 0;
+
+	// Number of blocks per chunk
+	int blocks_per_chunk;
+
+	// Chunks of memory
+	std::vector<std::unique_ptr<char[]>> chunks;
+
+	// List of free blocks
+	FreeBlock *free_list = nullptr;
+
+	// Allocate a new chunk and add its blocks to the free list
+	void AddChunk()
+	{
+		char *chunk = new char[block_size * blocks_per_chunk];
+		chunks.emplace_back(chunk);
+		for (int i = blocks_per_chunk - 1; i >= 0; i--)
+		{
+			FreeBlock *block = (FreeBlock *) (chunk + i * block_size);
+			block->next = free_list;
+			free_list = block;
+		}
+	}
+
+public:
+
+	/// Constructor
+	explicit Slab(int blocks_per_chunk = 256) :
+			blocks_per_chunk(blocks_per_chunk)
+	{
+	}
+
+	/// Allocate a block of the given size, which must be the same for
+	/// all allocations.
+	void *Allocate(size_t size)
+	{
+		// Fix block size on first allocation, rounded up to preserve
+		// the alignment of all blocks in a chunk
+		if (!block_size)
+		{
+			size_t alignment = alignof(std::max_align_t);
+			block_size = std::max(size, sizeof(FreeBlock));
+			block_size = (block_size + alignment - 1) /
+					alignment * alignment;
+		}
+		assert(size <= block_size);
+
+		// Take block from free list
+		if (!free_list)
+			AddChunk();
+		FreeBlock *block = free_list;
+		free_list = block->next;
+		return block;
+	}
+
+	/// Return a block to the slab
+	void Free(void *pointer)
+	{
+		FreeBlock *block = (FreeBlock *) pointer;
+		block->next = free_list;
+		free_list = block;
+	}
+};
+
+
+template<typename T> class SlabPtr;
+
+
+/// Base class of objects allocated in a slab and referenced with SlabPtr
+/// handles. The reference count is kept in the object itself, so handles
+/// are the size of a plain pointer and copying them does not touch any
+/// other memory. The count is not atomic: all handles of an object must be
+/// used by one host thread at a time.
+class SlabObject
+{
+	template<typename T> friend class SlabPtr;
+
+	// Slab that the object was allocated from
+	Slab *slab = nullptr;
+
+	// Number of handles pointing to the object
+	int num_references = 0;
+
+public:
+
+	/// Constructor
+	SlabObject() = default;
+
+	/// Copying an object does not copy its slab block or its handles
+	SlabObject(const SlabObject &other)
+	{
+	}
+
+	/// Copying an object does not copy its slab block or its handles
+	SlabObject &operator=(const SlabObject &other)
+	{
+		return *this;
+	}
+};
+
+
+/// Handle to an object allocated in a slab with SlabPtr::New(). The object
+/// is destroyed and its block returned to the slab when the last handle
+/// pointing to it is destroyed or reset. Type T must derive from
+/// SlabObject.
+template<typename T> class SlabPtr
+{
+	// Object pointed to, or null
+	T *pointer = nullptr;
+
+	// Drop the reference to the current object, if any
+	void Release()
+	{
+		if (pointer && !--pointer->num_references)
+		{
+			Slab *slab = pointer->slab;
+			pointer->~T();
+			slab->Free(pointer);
+		}
+		pointer = nullptr;
+	}
+
+public:
+
+	/// Create a null handle
+	SlabPtr() = default;
+
+	/// Create a null handle
+	SlabPtr(std::nullptr_t)
+	{
+	}
+
+	/// Create a new handle to an object that is already referenced by
+	/// other handles, given a raw pointer to it.
+	explicit SlabPtr(T *pointer) : pointer(pointer)
+	{
+		if (pointer)
+		{
+			assert(pointer->slab);
+			pointer->num_references++;
+		}
+	}
+
+	/// Copy constructor
+	SlabPtr(const SlabPtr &other) : SlabPtr(other.pointer)
+	{
+	}
+
+	/// Move constructor
+	SlabPtr(SlabPtr &&other) : pointer(other.pointer)
+	{
+		other.pointer = nullptr;
+	}
+
+	/// Destructor
+	~SlabPtr()
+	{
+		Release();
+	}
+
+	/// Copy assignment
+	SlabPtr &operator=(const SlabPtr &other)
+	{
+		SlabPtr copy(other);
+		std::swap(pointer, copy.pointer);
+		return *this;
+	}
+
+	/// Move assignment
+	SlabPtr &operator=(SlabPtr &&other)
+	{
+		if (this != &other)
+		{
+			Release();
+			pointer = other.pointer;
+			other.pointer = nullptr;
+		}
+		return *this;
+	}
+
+	/// Reset the handle
+	SlabPtr &operator=(std::nullptr_t)
+	{
+		Release();
+		return *this;
+	}
+
+	/// Construct an object in a block of the given slab, and return the
+	/// first handle to it.
+	template<typename... Args> static SlabPtr New(Slab *slab,
+			Args&&... args)
+	{
+		void *block = slab->Allocate(sizeof(T));
+		T *object = new (block) T(std::forward<Args>(args)...);
+		object->slab = slab;
+		return SlabPtr(object);
+	}
+
+	/// Return the object pointed to
+	T *get() const { return pointer; }
+
+	/// Access a member of the object pointed to
+	T *operator->() const { return pointer; }
+
+	/// Return the object pointed to
+	T &operator*() const { return *pointer; }
+
+	/// Return whether the handle is not null
+	explicit operator bool() const { return pointer; }
+
+	/// Compare handles
+	bool operator==(const SlabPtr &other) const
+	{
+		return pointer == other.pointer;
+	}
+
+	/// Compare handles
+	bool operator!=(const SlabPtr &other) const
+	{
+		return pointer != other.pointer;
+	}
+};
+
+
+}  // namespace misc
+
+#endif
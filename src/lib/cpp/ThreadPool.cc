@@ -0,0 +1,172 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "Error.h"
+#include "String.h"
+#include "ThreadPool.h"
+
+
+namespace misc
+{
+
+
+ThreadPool::ThreadPool(int num_threads)
+{
+	// Check number of threads
+	if (num_threads < 1)
+		throw Error(fmt("Invalid number of host threads (%d)",
+				num_threads));
+
+	// Initialize synchronization primitives
+	pthread_mutex_init(&mutex, nullptr);
+	pthread_cond_init(&start_cond, nullptr);
+	pthread_cond_init(&finish_cond, nullptr);
+
+	// Create worker threads. The thread invoking Run() is the extra one.
+	threads.resize(num_threads - 1);
+	for (auto &thread : threads)
+		if (pthread_create(&thread, nullptr, ThreadMain, this))
+			throw Error("Cannot create host thread");
+}
+
+
+ThreadPool::~ThreadPool()
+{
+	// Wake up workers and tell them to exit
+	pthread_mutex_lock(&mutex);
+	exit = true;
+	__atomic_store_n(&batch, batch + 1, __ATOMIC_RELEASE);
+	pthread_cond_broadcast(&start_cond);
+	pthread_mutex_unlock(&mutex);
+
+	// Wait for them
+	for (auto &thread : threads)
+		pthread_join(thread, nullptr);
+
+	// Free synchronization primitives
+	pthread_cond_destroy(&finish_cond);
+	pthread_cond_destroy(&start_cond);
+	pthread_mutex_destroy(&mutex);
+}
+
+
+void *ThreadPool::ThreadMain(void *arg)
+{
+	ThreadPool *thread_pool = (ThreadPool *) arg;
+	thread_pool->Worker();
+	return nullptr;
+}
+
+
+void ThreadPool::Worker()
+{
+	long long last_batch = 0;
+	for (;;)
+	{
+		// Spin for a while waiting for a new batch
+		for (int i = 0; i < max_spin_iterations; i++)
+			if (__atomic_load_n(&batch, __ATOMIC_ACQUIRE) != last_batch)
+				break;
+
+		// Block until there is a new batch
+		pthread_mutex_lock(&mutex);
+		while (batch == last_batch && !exit)
+			pthread_cond_wait(&start_cond, &mutex);
+
+		// Pool destroyed
+		if (exit)
+		{
+			pthread_mutex_unlock(&mutex);
+			return;
+		}
+
+		// Participate in the batch
+		last_batch = batch;
+		RunTasks();
+		pthread_mutex_unlock(&mutex);
+	}
+}
+
+
+void ThreadPool::RunTasks()
+{
+	while (next_task < num_tasks)
+	{
+		// Pick up next task
+		int task = next_task++;
+		pthread_mutex_unlock(&mutex);
+
+		// Run it, capturing any exception
+		std::exception_ptr task_exception;
+		try
+		{
+			(*function)(task);
+		}
+		catch (...)
+		{
+			task_exception = std::current_exception();
+		}
+
+		// Record completion. The last task wakes up the invoking thread.
+		pthread_mutex_lock(&mutex);
+		if (task_exception && !exception)
+			exception = task_exception;
+		if (--num_pending_tasks == 0)
+			pthread_cond_signal(&finish_cond);
+	}
+}
+
+
+void ThreadPool::Run(int num_tasks, const std::function<void(int)> &function)
+{
+	// Run tasks right away if there are no workers
+	if (threads.empty())
+	{
+		for (int i = 0; i < num_tasks; i++)
+			function(i);
+		return;
+	}
+
+	// Start batch
+	pthread_mutex_lock(&mutex);
+	this->function = &function;
+	this->num_tasks = num_tasks;
+	next_task = 0;
+	num_pending_tasks = num_tasks;
+	__atomic_store_n(&batch, batch + 1, __ATOMIC_RELEASE);
+	pthread_cond_broadcast(&start_cond);
+
+	// Participate, then wait for the rest of the tasks
+	RunTasks();
+	while (num_pending_tasks)
+		pthread_cond_wait(&finish_cond, &mutex);
+
+	// Finish batch
+	this->function = nullptr;
+	std::exception_ptr batch_exception = exception;
+	exception = nullptr;
+	pthread_mutex_unlock(&mutex);
+
+	// Propagate exception
+	if (batch_exception)
+		std::rethrow_exception(batch_exception);
+}
+
+
+}  // namespace misc
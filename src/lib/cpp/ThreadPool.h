@@ -0,0 +1,122 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LIB_CPP_THREAD_POOL_H
+#define LIB_CPP_THREAD_POOL_H
+
+#include <exception>
+#include <functional>
+#include <pthread.h>
+#include <vector>
+
+
+namespace misc
+{
+
+
+/// Pool of host threads running batches of independent tasks. A batch is
+/// started with a call to Run(), which returns only after all tasks in the
+/// batch have completed, acting as a barrier. The thread invoking Run()
+/// participates in the execution of the batch.
+///
+/// Workers spin for a short time waiting for the next batch before they
+/// block, since batches are usually started back to back (e.g., once per
+/// simulation cycle).
+class ThreadPool
+{
+	// Worker threads, not including the thread invoking Run()
+	std::vector<pthread_t> threads;
+
+	// Mutex protecting the fields below
+	pthread_mutex_t mutex;
+
+	// Condition variable signaled when a new batch is started or the
+	// pool is destroyed
+	pthread_cond_t start_cond;
+
+	// Condition variable signaled when the last task of a batch finishes
+	pthread_cond_t finish_cond;
+
+	// Function run by the tasks of the current batch
+	const std::function<void(int)> *function = nullptr;
+
+	// Number of tasks in the current batch
+	int num_tasks = 0;
+
+	// Index of the next task to be picked up by a thread
+	int next_task = 0;
+
+	// Number of tasks of the current batch that have not finished yet
+	int num_pending_tasks = 0;
+
+	// Identifier of the current batch, incremented every time Run() is
+	// invoked. Workers poll this value atomically while spinning.
+	long long batch = 0;
+
+	// Flag set when the pool is being destroyed
+	bool exit = false;
+
+	// First exception thrown by a task of the current batch
+	std::exception_ptr exception;
+
+	// Number of times a worker polls for a new batch before blocking
+	static const int max_spin_iterations = 20000;
+
+	// Entry point of worker threads
+	static void *ThreadMain(void *arg);
+
+	// Main loop of a worker thread
+	void Worker();
+
+	// Pick up and run tasks of the current batch until none is left.
+	// The mutex must be locked when calling this function, and it is
+	// locked again when it returns.
+	void RunTasks();
+
+public:
+
+	/// Create a pool with the given number of host threads, including
+	/// the thread that will be invoking Run().
+	explicit ThreadPool(int num_threads);
+
+	/// Destructor. Worker threads are joined.
+	~ThreadPool();
+
+	/// Return the number of host threads, including the invoking one
+	int getNumThreads() const { return threads.size() + 1; }
+
+	/// Run a batch of tasks and wait for all of them to complete.
+	///
+	/// \param num_tasks
+	///	Number of tasks in the batch.
+	///
+	/// \param function
+	///	Function run for each task, taking the task index in the range
+	///	[0, \a num_tasks) as its argument. Tasks can be executed in any
+	///	order and by any thread.
+	///
+	/// If any task throws an exception, the first exception thrown is
+	/// propagated to the caller once the whole batch has completed.
+	void Run(int num_tasks, const std::function<void(int)> &function);
+};
+
+
+}  // namespace misc
+
+#endif
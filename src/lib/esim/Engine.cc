@@ -32,6 +32,10 @@ misc::Debug Engine::debug;
 
 std::unique_ptr<Engine> Engine::instance;
 
+int Engine::num_host_threads = 1;
+
+thread_local int Engine::partition = 0;
+
 const char *engine_err_finalization =
 	"The finalization process of the event-driven simulation is trying to "
 	"empty the event heap by scheduling all pending events. If the number of "
@@ -302,6 +306,16 @@ void Engine::Schedule(Event *event,
 		int after,
 		int period)
 {
+	// Defer within parallel regions
+	if (parallel)
+	{
+		Defer([this, event, frame, after, period]()
+		{
+			Schedule(event, frame, after, period);
+		});
+		return;
+	}
+
 	// Sanity
 	assert(after >= 0);
 	assert(frame != nullptr);
@@ -493,6 +507,45 @@ void Engine::ProcessAllEvents()
 }
 
 
+void Engine::setNumHostThreads(int num_host_threads)
+{
+	if (num_host_threads < 1)
+		throw Error(misc::fmt("Invalid number of host threads (%d)",
+				num_host_threads));
+	Engine::num_host_threads = num_host_threads;
+}
+
+
+void Engine::BeginParallel(int num_partitions)
+{
+	// Sanity
+	assert(!parallel);
+	assert(num_partitions > 0);
+
+	// Start region
+	deferred_actions.resize(num_partitions);
+	parallel = true;
+}
+
+
+void Engine::EndParallel()
+{
+	// Sanity
+	assert(parallel);
+
+	// Close region
+	parallel = false;
+
+	// Run deferred actions in partition order
+	for (auto &actions : deferred_actions)
+	{
+		for (auto &action : actions)
+			action();
+		actions.clear();
+	}
+}
+
+
 
 }  // namespace esim
 
@@ -21,6 +21,7 @@
 #define LIB_CPP_ESIM_ENGINE_H
 
 #include <cassert>
+#include <functional>
 #include <memory>
 #include <list>
 #include <queue>
@@ -144,6 +145,20 @@ class Engine
 	// Process all events scheduled with a previous call to EndEvent()
 	void ProcessEndEvents();
 
+	// Number of host threads that timing simulators can use to run their
+	// components in parallel, as set by command-line option
+	// '--host-threads'.
+	static int num_host_threads;
+
+	// Partition run by the current host thread within a parallel region
+	static thread_local int partition;
+
+	// Flag set while a parallel region is active
+	bool parallel = false;
+
+	// Actions deferred by each partition of the current parallel region
+	std::vector<std::vector<std::function<void()>>> deferred_actions;
+
 public:
 
 	// Constructor
@@ -155,9 +170,15 @@ public:
 	/// Destroy the singleton if allocated.
 	static void Destroy() { instance = nullptr; }
 
-	/// Force end of simulation with a specific reason.
+	/// Force end of simulation with a specific reason. Within a parallel
+	/// region, the call is deferred until the end of the region.
 	void Finish(const std::string &reason)
 	{
+		if (parallel)
+		{
+			Defer([this, reason]() { Finish(reason); });
+			return;
+		}
 		finish = true;
 		finish_reason = reason;
 	}
@@ -415,6 +436,58 @@ public:
 		debug.setPath(path);
 		debug.setPrefix("[esim]");
 	}
+
+
+
+
+	//
+	// Parallel regions
+	//
+
+	/// Set the number of host threads available to timing simulators
+	static void setNumHostThreads(int num_host_threads);
+
+	/// Return the number of host threads available to timing simulators
+	static int getNumHostThreads() { return num_host_threads; }
+
+	/// Begin a parallel region. Within the region, the components of a
+	/// timing simulator are divided into \a num_partitions disjoint
+	/// partitions, each of them run by one host thread. Partitions can
+	/// modify their own state freely, but any action with an effect on
+	/// shared state (e.g., scheduling an event) must be deferred with a
+	/// call to Defer(). Calls to Schedule() and Finish() are deferred
+	/// automatically.
+	void BeginParallel(int num_partitions);
+
+	/// End a parallel region, running all actions deferred during the
+	/// region. Actions are run in partition order, and in the order they
+	/// were deferred within each partition. The outcome of the simulation
+	/// is thus independent of the number of host threads used, as long as
+	/// partitions are defined consistently.
+	void EndParallel();
+
+	/// Return whether a parallel region is active
+	bool isParallel() const { return parallel; }
+
+	/// Set the partition run by the calling host thread. This function
+	/// must be invoked by every host thread before running a partition
+	/// in a parallel region.
+	static void setPartition(int partition) { Engine::partition = partition; }
+
+	/// Run an action with an effect on state shared among partitions.
+	/// Outside of a parallel region, the action runs right away. Within a
+	/// parallel region, it is queued for the current partition and runs
+	/// when the region ends.
+	void Defer(std::function<void()> action)
+	{
+		if (!parallel)
+		{
+			action();
+			return;
+		}
+		assert(partition >= 0 && partition < (int) deferred_actions.size());
+		deferred_actions[partition].push_back(std::move(action));
+	}
 };
 
 
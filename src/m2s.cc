@@ -17,6 +17,7 @@
  *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <csignal>
 #include <cstdlib>
 #include <iostream>
 #include <sys/time.h>
@@ -27,6 +28,7 @@
 #include <arch/kepler/disassembler/Disassembler.h>
 #include <arch/kepler/driver/Driver.h>
 #include <arch/kepler/emulator/Emulator.h>
+#include <arch/kepler/timing/Timing.h>
 #include <arch/mips/disassembler/Disassembler.h>
 #include <arch/mips/emulator/Context.h>
 #include <arch/mips/emulator/Emulator.h>
@@ -82,6 +84,9 @@ std::string m2s_debug_callstack;
 // Maximum simulation time
 long long m2s_max_time = 0;
 
+// Number of host threads for timing simulation
+int m2s_host_threads = 1;
+
 // Binary file for OpenCL runtime
 std::string m2s_opencl_binary;
 
@@ -286,6 +291,28 @@ void RegisterOptions()
 			"Dump debug information related with the event-driven "
 			"simulation engine.");
 	
+	// Host threads
+	command_line->RegisterInt32("--host-threads <num> (default = 1)",
+			m2s_host_threads,
+			"Number of host threads used to run the cores of the "
+			"x86 timing simulator and the compute units of the "
+			"Southern Islands timing simulator in parallel. With "
+			"one thread, each core or compute unit runs all its "
+			"pipeline stages before the next one. With more "
+			"threads, each stage runs for all cores or compute "
+			"units before the next stage; the stages that do not "
+			"invoke the functional emulator run concurrently on "
+			"disjoint groups of cores or compute units, and their "
+			"interactions with shared state are replayed in a fixed "
+			"order at the end of the stages. Multi-core results can "
+			"thus differ from a single-threaded run, but they do not "
+			"depend on the number of threads beyond one. Groups are "
+			"run one at a time while pipeline traces or debug "
+			"information are generated. "
+			"The x86 functional emulator also uses these threads to "
+			"run guest contexts concurrently (see options "
+			"'--x86-host-quantum' and '--x86-deterministic').");
+
 	// Debugger for Inifile parser
 	command_line->RegisterString("--inifile-debug <file>",
 			m2s_debug_inifile,
@@ -404,6 +431,9 @@ void ProcessOptions()
 	if (!m2s_opencl_binary.empty())
 		environment->addVariable("M2S_OPENCL_BINARY", m2s_opencl_binary);
 
+	// Host threads
+	esim::Engine::setNumHostThreads(m2s_host_threads);
+
 	// Trace file
 	if (!m2s_trace_file.empty())
 	{
@@ -579,41 +609,9 @@ void DumpReports()
 }
 
 
-int MainProgram(int argc, char **argv)
+// Run the simulation, once the command line has been read
+void RunSimulation()
 {
-	// Print welcome message in standard error output
-	WelcomeMessage(std::cerr);
-
-	// Read command line
-	RegisterOptions();
-	HSA::Disassembler::RegisterOptions();
-	HSA::Driver::RegisterOptions();
-	HSA::Emulator::RegisterOptions();
-	Kepler::Disassembler::RegisterOptions();
-	Kepler::Driver::RegisterOptions();
-	Kepler::Emulator::RegisterOptions();
-	mem::Mmu::RegisterOptions();
-	mem::Manager::RegisterOptions();
-	MIPS::Disassembler::RegisterOptions();
-	MIPS::Emulator::RegisterOptions();
-	SI::Driver::RegisterOptions();
-	SI::Disassembler::RegisterOptions();
-	SI::Emulator::RegisterOptions();
-	SI::Timing::RegisterOptions();
-	x86::Disassembler::RegisterOptions();
-	x86::Emulator::RegisterOptions();
-	x86::Timing::RegisterOptions();
-	mem::System::RegisterOptions();
-	dram::System::RegisterOptions();
-	net::System::RegisterOptions();
-	ARM::Disassembler::RegisterOptions();
-	ARM::Emulator::RegisterOptions();
-
-	// Process command line. Return to C version of Multi2Sim if a
-	// command-line option was not recognized.
-	misc::CommandLine *command_line = misc::CommandLine::getInstance();
-	command_line->Process(argc, argv, false);
-	
 	// Process command line
 	ProcessOptions();
 	HSA::Disassembler::ProcessOptions();
@@ -622,6 +620,7 @@ int MainProgram(int argc, char **argv)
 	Kepler::Disassembler::ProcessOptions();
 	Kepler::Driver::ProcessOptions();
 	Kepler::Emulator::ProcessOptions();
+	Kepler::Timing::ProcessOptions();
 	mem::Mmu::ProcessOptions();
 	mem::Manager::ProcessOptions();
 	MIPS::Disassembler::ProcessOptions();
@@ -639,6 +638,20 @@ int MainProgram(int argc, char **argv)
 	ARM::Disassembler::ProcessOptions();
 	ARM::Emulator::ProcessOptions();
 
+	// Select x86 simulation points instead of running a simulation
+	if (x86::Emulator::isSimPointSelection())
+	{
+		x86::Emulator::SelectSimPoints();
+		return;
+	}
+
+	// Evaluate the x86 branch predictor instead of running a simulation
+	if (x86::Timing::isBranchEvaluation())
+	{
+		x86::Timing::EvaluateBranchPredictor();
+		return;
+	}
+
 	// Initialize memory system, only if there is at least one timing
 	// simulation active. Check this in the architecture pool after all
 	// '--xxx-sim' command-line options have been processed.
@@ -688,6 +701,47 @@ int MainProgram(int argc, char **argv)
 
 	// Reports
 	DumpReports();
+}
+
+
+int MainProgram(int argc, char **argv)
+{
+	// Print welcome message in standard error output
+	WelcomeMessage(std::cerr);
+
+	// Read command line
+	RegisterOptions();
+	HSA::Disassembler::RegisterOptions();
+	HSA::Driver::RegisterOptions();
+	HSA::Emulator::RegisterOptions();
+	Kepler::Disassembler::RegisterOptions();
+	Kepler::Driver::RegisterOptions();
+	Kepler::Emulator::RegisterOptions();
+	Kepler::Timing::RegisterOptions();
+	mem::Mmu::RegisterOptions();
+	mem::Manager::RegisterOptions();
+	MIPS::Disassembler::RegisterOptions();
+	MIPS::Emulator::RegisterOptions();
+	SI::Driver::RegisterOptions();
+	SI::Disassembler::RegisterOptions();
+	SI::Emulator::RegisterOptions();
+	SI::Timing::RegisterOptions();
+	x86::Disassembler::RegisterOptions();
+	x86::Emulator::RegisterOptions();
+	x86::Timing::RegisterOptions();
+	mem::System::RegisterOptions();
+	dram::System::RegisterOptions();
+	net::System::RegisterOptions();
+	ARM::Disassembler::RegisterOptions();
+	ARM::Emulator::RegisterOptions();
+
+	// Process command line. Return to C version of Multi2Sim if a
+	// command-line option was not recognized.
+	misc::CommandLine *command_line = misc::CommandLine::getInstance();
+	command_line->Process(argc, argv, false);
+
+	// Run simulation
+	RunSimulation();
 
 	// Success
 	return 0;
@@ -103,6 +103,11 @@ public:
 	/// over.
 	int *witness = nullptr;
 
+	/// Pointer to a variable updated with the deepest module reached by
+	/// a load as it misses in the memory hierarchy. Once the access
+	/// completes, it points to the module that supplied the data.
+	Module **source_module = nullptr;
+
 	/// Iterator to the current position of this frame in
 	/// Module::accesses.
 	std::list<Frame *>::iterator accesses_iterator;
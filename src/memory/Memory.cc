@@ -37,6 +37,9 @@ const unsigned Memory::PageMask;
 
 bool Memory::safe_mode = true;
 
+// Zero-filled buffer returned for reads of pages with no data
+static const char zero_page[Memory::PageSize] = {};
+
 
 Memory::Page *Memory::getPage(unsigned address)
 {
@@ -154,33 +157,29 @@ char *Memory::getBuffer(unsigned address, unsigned size, AccessType access)
 		throw Error(misc::fmt("[0x%x] Permission denied", address));
 	
 	// Return pointer to page data
+	if (concurrent && !page->getData())
+		throw Conflict();
 	page->AllocateData();
 	return page->getData() + offset;
 }
 
 
-void Memory::AccessAtPageBoundary(unsigned address, unsigned size,
-		char *buffer, AccessType access)
+Memory::Page *Memory::PrepareAccess(unsigned address, AccessType access)
 {
-	// Find memory page and compute offset.
-	Page *page = getPage(address);
-	unsigned offset = address & (PageSize - 1);
-	assert(offset + size <= PageSize);
-
 	// On nonexistent page, raise segmentation fault in safe mode,
 	// or create page with full privileges for writes in unsafe mode.
+	Page *page = getPage(address);
 	if (!page)
 	{
 		if (safe)
 			throw Error(misc::fmt("[0x%x] Segmentation fault in "
 					"guest program", address));
 		if (access == AccessRead || access == AccessExec)
-		{
-			memset(buffer, 0, size);
-			return;
-		}
+			return nullptr;
 		if (access == AccessWrite || access == AccessInit)
 		{
+			if (concurrent)
+				throw Conflict();
 			page = newPage(address, AccessRead |
 				AccessWrite | AccessExec |
 				AccessInit);
@@ -188,19 +187,42 @@ void Memory::AccessAtPageBoundary(unsigned address, unsigned size,
 	}
 	assert(page);
 
+	// Check permissions in safe mode
+	unsigned perm = page->getPerm() | (access == AccessWrite ?
+			AccessModified : 0);
+	if (safe && (perm & access) != access)
+		throw Error(misc::fmt("[0x%x] Permission denied", address));
+
 	// If it is a write access, set the 'modified' flag in the page
 	// attributes (perm). This is not done for 'initialize' access.
-	if (access == AccessWrite)
-		page->addPerm(AccessModified);
+	// Writes in concurrent mode are only allowed on pages already
+	// modified and allocated.
+	if (access == AccessWrite || access == AccessInit)
+	{
+		if (concurrent && (perm != page->getPerm() || !page->getData()))
+			throw Conflict();
+		if (perm != page->getPerm())
+			page->setPerm(perm);
+		page->AllocateData();
+	}
 
-	// Check permissions in safe mode
-	if (safe && (page->getPerm() & access) != access)
-		throw Error(misc::fmt("[0x%x] Permission denied", address));
+	// Done
+	return page;
+}
+
+
+void Memory::AccessAtPageBoundary(unsigned address, unsigned size,
+		char *buffer, AccessType access)
+{
+	// Find memory page and compute offset.
+	Page *page = PrepareAccess(address, access);
+	unsigned offset = address & (PageSize - 1);
+	assert(offset + size <= PageSize);
 
 	// Read/execute access
 	if (access == AccessRead || access == AccessExec)
 	{
-		if (page->getData())
+		if (page && page->getData())
 			memcpy(buffer, page->getData() + offset, size);
 		else
 			memset(buffer, 0, size);
@@ -210,7 +232,6 @@ void Memory::AccessAtPageBoundary(unsigned address, unsigned size,
 	// Write/initialize access
 	if (access == AccessWrite || access == AccessInit)
 	{
-		page->AllocateData();
 		memcpy(page->getData() + offset, buffer, size);
 		return;
 	}
@@ -220,10 +241,80 @@ void Memory::AccessAtPageBoundary(unsigned address, unsigned size,
 }
 
 
+void Memory::CopyFrom(unsigned address, Memory &src, unsigned src_address,
+		unsigned size)
+{
+	// Overlapping regions in the same memory object are copied through an
+	// intermediate buffer.
+	if (&src == this && ((src_address < address &&
+			src_address + size > address) ||
+			(address < src_address && address + size > src_address)))
+	{
+		auto buffer = misc::new_unique_array<char>(size);
+		Read(src_address, size, buffer.get());
+		Write(address, size, buffer.get());
+		return;
+	}
+
+	// Copy one source page at a time
+	while (size)
+	{
+		unsigned offset = src_address & (PageSize - 1);
+		unsigned chunk_size = std::min(size, PageSize - offset);
+		Page *page = src.PrepareAccess(src_address, AccessRead);
+		const char *data = page && page->getData() ?
+				page->getData() + offset : zero_page;
+		Write(address, chunk_size, data);
+
+		size -= chunk_size;
+		address += chunk_size;
+		src_address += chunk_size;
+	}
+}
+
+
+void Memory::getSpans(unsigned address, unsigned size, AccessType access,
+		std::vector<struct iovec> &spans)
+{
+	assert(access == AccessRead || access == AccessWrite);
+	if (!concurrent)
+		last_address = address;
+	while (size)
+	{
+		unsigned offset = address & (PageSize - 1);
+		unsigned chunk_size = std::min(size, PageSize - offset);
+		Page *page = PrepareAccess(address, access);
+
+		struct iovec span;
+		span.iov_base = page && page->getData() ?
+				page->getData() + offset :
+				const_cast<char *>(zero_page);
+		span.iov_len = chunk_size;
+		spans.push_back(span);
+
+		size -= chunk_size;
+		address += chunk_size;
+	}
+}
+
+
 void Memory::Access(unsigned address, unsigned size, char *buf,
 			AccessType access)
 {
-	last_address = address;
+	// In concurrent mode, a write crossing a page boundary must not be
+	// applied partially if the access to the second page conflicts.
+	if (concurrent && (access == AccessWrite || access == AccessInit) &&
+			(address & (PageSize - 1)) + size > PageSize)
+	{
+		Page *page = getPage(address + size - 1);
+		if (!page || !page->getData() ||
+				!(page->getPerm() & AccessModified))
+			throw Conflict();
+	}
+
+	// Access page by page
+	if (!concurrent)
+		last_address = address;
 	while (size)
 	{
 		unsigned offset = address & (PageSize - 1);
@@ -23,7 +23,9 @@
 #include <cassert>
 #include <iostream>
 #include <memory>
+#include <sys/uio.h>
 #include <unordered_map>
+#include <vector>
 
 #include <lib/cpp/Error.h>
 #include <lib/cpp/Misc.h>
@@ -32,8 +34,10 @@
 namespace mem
 {
 
-/// A 32-bit virtual memory space
-class Memory
+/// A 32-bit virtual memory space. Memories of guest contexts are owned
+/// through shared pointers, so that drivers keeping references to guest
+/// memory beyond an ABI call can detect when the guest program exits.
+class Memory : public std::enable_shared_from_this<Memory>
 {
 public:
 
@@ -59,6 +63,14 @@ public:
 		}
 	};
 
+	/// Exception thrown by a memory object in concurrent mode when an
+	/// access would modify the page table or allocate page data. The
+	/// memory is left unmodified by the access causing the conflict, which
+	/// must be retried once the memory is no longer accessed concurrently.
+	class Conflict
+	{
+	};
+
 	/// Types of memory accesses
 	enum AccessType
 	{
@@ -134,6 +146,9 @@ private:
 	/// Safe mode
 	bool safe;
 
+	// Flag set while the memory is accessed by multiple host threads
+	bool concurrent = false;
+
 	/// Heap break for CPU contexts
 	unsigned heap_break = 0;
 
@@ -144,6 +159,12 @@ private:
 	/// \a perm is an *or*'ed bitmap of AccessType flags.
 	Page *newPage(unsigned address, unsigned perm);
 
+	// Check permissions for an access to the page containing \a address,
+	// creating the page for writes in unsafe mode, and allocating its data
+	// for writes. The function returns null if the page does not exist
+	// and the access is a read in unsafe mode, which returns zeros.
+	Page *PrepareAccess(unsigned address, AccessType access);
+
 	// Access memory without exceeding page boundaries
 	void AccessAtPageBoundary(unsigned address, unsigned size, char *buffer,
 			AccessType access);
@@ -168,6 +189,15 @@ public:
 	/// Return whether the safe mode is on
 	bool getSafe() const { return safe; }
 
+	/// Set the concurrent mode. While in concurrent mode, the memory can
+	/// be read and written by multiple host threads, as long as the page
+	/// table and the page permissions are left unchanged. Accesses that
+	/// need to change them throw a Memory::Conflict exception instead.
+	void setConcurrent(bool concurrent) { this->concurrent = concurrent; }
+
+	/// Return whether the memory is in concurrent mode
+	bool isConcurrent() const { return concurrent; }
+
 	/// Clear content of memory
 	void Clear() { pages.clear(); }
 
@@ -275,6 +305,56 @@ public:
 	///	region does not have write permissions.
 	void Copy(unsigned dest, unsigned src, unsigned size);
 
+	/// Copy a region from another memory object, or from another region
+	/// of this memory object, with no alignment or size restrictions.
+	/// Data is copied directly between the pages of both memory objects,
+	/// without an intermediate buffer.
+	///
+	/// \param address
+	///	Destination address in this memory object
+	///
+	/// \param src
+	///	Source memory object
+	///
+	/// \param src_address
+	///	Source address in \a src
+	///
+	/// \param size
+	///	Number of bytes to copy
+	///
+	/// \throw
+	///	A Memory::Error is thrown in safe mode if the source region does
+	///	not have read permissions in \a src, or the destination region
+	///	does not have write permissions.
+	void CopyFrom(unsigned address, Memory &src, unsigned src_address,
+			unsigned size);
+
+	/// Obtain pointers to the memory content of a region with no alignment
+	/// or size restrictions, as one host I/O vector per page. The vectors
+	/// are appended to \a spans, and can be passed directly to host calls
+	/// such as \c readv or \c writev for zero-copy transfers.
+	///
+	/// \param address
+	///	Memory address
+	///
+	/// \param size
+	///	Number of bytes
+	///
+	/// \param access
+	///	Type of access, either \c AccessRead or \c AccessWrite. For
+	///	writes, the pages are marked as modified. For reads, the vectors
+	///	of pages with no data point to a shared zero-filled buffer, and
+	///	must not be written.
+	///
+	/// \param spans
+	///	Output list of I/O vectors
+	///
+	/// \throw
+	///	A Memory::Error is thrown in safe mode if the pages are not
+	///	allocated, or do not have the permissions requested in \a access.
+	void getSpans(unsigned address, unsigned size, AccessType access,
+			std::vector<struct iovec> &spans);
+
  	/// Access memory at any address and size, without page boundary
 	/// restrictions.
 	///
@@ -157,7 +157,8 @@ bool Module::canAccess(int address) const
 long long Module::Access(AccessType access_type,
 		unsigned address,
 		int *witness,
-		esim::Event *return_event)
+		esim::Event *return_event,
+		Module **source_module)
 {
 	// Create a new event frame
 	auto frame = misc::new_shared<Frame>(
@@ -165,6 +166,9 @@ long long Module::Access(AccessType access_type,
 			this,
 			address);
 	frame->witness = witness;
+	frame->source_module = source_module;
+	if (source_module)
+		*source_module = this;
 
 	// Select initial event type
 	esim::Event *event;
@@ -974,6 +978,257 @@ void Module::UpdateStats(Frame *frame)
 }
 
 
+bool Module::WarmAccess(AccessType access_type, unsigned address)
+{
+	// Only caches and main memory modules keep coherent contents
+	if (type == TypeLocalMemory)
+		return false;
+
+	// Check whether the access hits with enough permissions
+	int set;
+	int way;
+	int tag;
+	Cache::BlockState state;
+	bool exclusive = access_type != AccessLoad;
+	bool hit = FindBlock(address, set, way, tag, state);
+	if (hit && exclusive)
+		hit = state == Cache::BlockModified ||
+				state == Cache::BlockExclusive;
+
+	// Bring the block
+	if (!WarmFetch(address, exclusive, set, way))
+		return hit;
+
+	// A store leaves the block in modified state
+	if (exclusive)
+		cache->setBlock(set, way, tag, Cache::BlockModified);
+	return hit;
+}
+
+
+bool Module::WarmFetch(unsigned address, bool exclusive, int &set, int &way)
+{
+	// Look for the block
+	int tag;
+	Cache::BlockState state;
+	bool hit = FindBlock(address, set, way, tag, state);
+	if (hit && directory->isEntryLocked(set, way))
+		return false;
+
+	// Main memory modules always hold the data, so any valid copy has
+	// enough permissions. Caches need an exclusive copy for writes.
+	if (hit && (type == TypeMainMemory || !exclusive ||
+			state == Cache::BlockModified ||
+			state == Cache::BlockExclusive))
+	{
+		cache->AccessBlock(set, way);
+		return true;
+	}
+
+	// Make room for the block on a miss
+	if (!hit)
+	{
+		way = cache->ReplaceBlock(set);
+		if (directory->isEntryLocked(set, way))
+			return false;
+		WarmEvict(set, way);
+	}
+
+	// Main memory modules allocate the block in exclusive state
+	Cache::BlockState new_state = Cache::BlockExclusive;
+	if (type != TypeMainMemory)
+	{
+		Module *low_module = getLowModuleServingAddress(tag);
+		if (!low_module || !low_module->WarmRequest(this, tag,
+				exclusive, new_state))
+			return false;
+	}
+
+	// Set the new block
+	cache->setBlock(set, way, tag, new_state);
+	cache->AccessBlock(set, way);
+	return true;
+}
+
+
+bool Module::WarmRequest(Module *requester,
+		unsigned address,
+		bool exclusive,
+		Cache::BlockState &state)
+{
+	// Bring the block into this module first
+	int set;
+	int way;
+	if (!WarmFetch(address, exclusive, set, way))
+		return false;
+
+	// Update the directory entries covered by the requester's block
+	bool dirty = false;
+	bool shared = false;
+	unsigned tag = address & ~cache->getBlockMask();
+	unsigned src_tag = address & ~(requester->getBlockSize() - 1);
+	for (int z = 0; z < directory->getNumSubBlocks(); z++)
+	{
+		// Skip other sub-blocks
+		unsigned directory_entry_tag = tag + z * sub_block_size;
+		if (directory_entry_tag < src_tag || directory_entry_tag >=
+				src_tag + (unsigned) requester->getBlockSize())
+			continue;
+
+		// A write invalidates all other sharers, while a read
+		// downgrades the owner, if any.
+		for (Module *high_module : high_modules)
+		{
+			if (high_module == requester ||
+					!isSharer(set, way, z, high_module))
+				continue;
+			if (exclusive)
+			{
+				dirty |= high_module->WarmInvalidate(
+						directory_entry_tag);
+				directory->clearSharer(set, way, z,
+						getSharerIndex(high_module));
+			}
+			else if (getOwner(set, way, z) == high_module)
+			{
+				dirty |= high_module->WarmDowngrade(
+						directory_entry_tag);
+			}
+		}
+
+		// Set the requester as a sharer, and as the owner if nobody
+		// else has a copy of the sub-block.
+		setSharer(set, way, z, requester);
+		if (getNumSharers(set, way, z) > 1)
+		{
+			shared = true;
+			setOwner(set, way, z, nullptr);
+		}
+		else
+		{
+			setOwner(set, way, z, requester);
+		}
+	}
+
+	// Dirty data received from higher-level copies
+	unsigned block_tag;
+	Cache::BlockState block_state;
+	cache->getBlock(set, way, block_tag, block_state);
+	if (dirty && block_state == Cache::BlockExclusive)
+		cache->setBlock(set, way, block_tag, Cache::BlockModified);
+
+	// State for the requester's copy
+	state = shared ? Cache::BlockShared : Cache::BlockExclusive;
+	return true;
+}
+
+
+bool Module::WarmInvalidate(unsigned address)
+{
+	// Nothing to do if the block is not present
+	int set;
+	int way;
+	int tag;
+	Cache::BlockState state;
+	if (!FindBlock(address, set, way, tag, state) || !state)
+		return false;
+
+	// Invalidate copies in higher-level modules
+	bool dirty = state == Cache::BlockModified ||
+			state == Cache::BlockOwned ||
+			state == Cache::BlockNonCoherent;
+	for (int z = 0; z < directory->getNumSubBlocks(); z++)
+	{
+		unsigned directory_entry_tag = tag + z * sub_block_size;
+		for (Module *high_module : high_modules)
+			if (isSharer(set, way, z, high_module))
+				dirty |= high_module->WarmInvalidate(
+						directory_entry_tag);
+		directory->clearAllSharers(set, way, z);
+		setOwner(set, way, z, nullptr);
+	}
+
+	// Invalidate block
+	cache->setBlock(set, way, 0, Cache::BlockInvalid);
+	return dirty;
+}
+
+
+bool Module::WarmDowngrade(unsigned address)
+{
+	// Nothing to do if the block is not present
+	int set;
+	int way;
+	int tag;
+	Cache::BlockState state;
+	if (!FindBlock(address, set, way, tag, state) || !state)
+		return false;
+
+	// Downgrade the owners in higher-level modules
+	bool dirty = state == Cache::BlockModified ||
+			state == Cache::BlockOwned;
+	for (int z = 0; z < directory->getNumSubBlocks(); z++)
+	{
+		Module *owner = getOwner(set, way, z);
+		if (owner)
+			dirty |= owner->WarmDowngrade(tag + z * sub_block_size);
+		setOwner(set, way, z, nullptr);
+	}
+
+	// Downgrade block
+	cache->setBlock(set, way, tag, Cache::BlockShared);
+	return dirty;
+}
+
+
+void Module::WarmEvict(int set, int way)
+{
+	// Nothing to do for invalid blocks
+	unsigned tag;
+	Cache::BlockState state;
+	cache->getBlock(set, way, tag, state);
+	if (!state)
+		return;
+
+	// Invalidate the block here and in all higher-level modules
+	bool dirty = WarmInvalidate(tag);
+
+	// Main memory modules have no lower-level module to update
+	Module *low_module = getLowModuleServingAddress(tag);
+	if (type == TypeMainMemory || !low_module)
+		return;
+
+	// Remove this module as a sharer and owner in the lower-level module
+	int low_set;
+	int low_way;
+	int low_tag;
+	Cache::BlockState low_state;
+	if (!low_module->FindBlock(tag, low_set, low_way, low_tag, low_state))
+		return;
+	Directory *low_directory = low_module->getDirectory();
+	for (int z = 0; z < low_directory->getNumSubBlocks(); z++)
+	{
+		// Skip other sub-blocks
+		unsigned directory_entry_tag = low_tag +
+				z * low_module->getSubBlockSize();
+		if (directory_entry_tag < tag || directory_entry_tag >=
+				tag + (unsigned) block_size)
+			continue;
+
+		// Clear sharer and owner
+		low_directory->clearSharer(low_set, low_way, z,
+				low_module->getSharerIndex(this));
+		if (low_module->getOwner(low_set, low_way, z) == this)
+			low_module->setOwner(low_set, low_way, z, nullptr);
+	}
+
+	// Write back dirty data
+	if (dirty && low_state == Cache::BlockExclusive)
+		low_module->getCache()->setBlock(low_set, low_way, low_tag,
+				Cache::BlockModified);
+}
+
+
 int Module::getRetryLatency() const
 {
 	// To support a data latency of zero, we must ensure that at least
@@ -251,7 +251,42 @@ private:
 	// List of next-level modules, closer to main memory
 	std::vector<Module *> low_modules;
 
-	
+
+
+
+	//
+	// Functional warming
+	//
+
+	// Bring the block containing the given address into the cache with
+	// read or write permissions, updating the directories of the lower
+	// levels. Return false if the block could not be warmed because a
+	// directory entry in its path was locked by an in-flight access.
+	bool WarmFetch(unsigned address, bool exclusive, int &set, int &way);
+
+	// Serve a warming request coming from the given higher-level module.
+	// The state that the requester should assign to its copy of the
+	// block is returned in argument 'state'.
+	bool WarmRequest(Module *requester,
+			unsigned address,
+			bool exclusive,
+			Cache::BlockState &state);
+
+	// Invalidate the block containing the given address, together with
+	// all copies in higher-level modules. Return true if any of the
+	// invalidated copies was dirty.
+	bool WarmInvalidate(unsigned address);
+
+	// Downgrade the block containing the given address to the shared
+	// state, together with all copies in higher-level modules. Return
+	// true if any of the downgraded copies was dirty.
+	bool WarmDowngrade(unsigned address);
+
+	// Evict the block in the given set and way, invalidating copies in
+	// higher-level modules and updating the directory of the lower-level
+	// module.
+	void WarmEvict(int set, int way);
+
 
 
 	//
@@ -641,6 +676,12 @@ public:
 	///	current frame will be available within the event handler of
 	///	\a return_event. Use \c nullptr (default) for no return event.
 	///
+	/// \param source_module
+	///	For loads, pointer to a variable updated with the deepest
+	///	module reached by the access while it is in flight, and with
+	///	the module that supplied the data once it completes. This
+	///	argument is optional, and can be set to \c nullptr.
+	///
 	/// \return frame_id
 	///	The function returns a unique identifier of the new memory
 	///	access.
@@ -648,8 +689,27 @@ public:
 	long long Access(AccessType access_type,
 			unsigned address,
 			int *witness = nullptr,
-			esim::Event *return_event = nullptr);
+			esim::Event *return_event = nullptr,
+			Module **source_module = nullptr);
 	
+	/// Access the module functionally, with no latency and no statistics.
+	/// The cache contents and the directories of this module and all
+	/// modules below it are updated as if the access had gone through the
+	/// coherence protocol. This is used to warm up the memory hierarchy
+	/// while the timing simulation is skipped, for example during the
+	/// functional phases of a sampled simulation.
+	///
+	/// \param access_type
+	///	Type of access: load, store, nc-store
+	///
+	/// \param address
+	///	Physical address.
+	///
+	/// \return
+	///	The function returns true if the access hit in the module.
+	///
+	bool WarmAccess(AccessType access_type, unsigned address);
+
 	/// Add the given frame to the list of in-flight accesses, and record
 	/// its access type. This function is invoked internally by the event
 	/// handlers of the first NMOESI event for an access.
@@ -196,6 +196,11 @@ void System::EventLoadHandler(esim::Event *event, esim::Frame *esim_frame)
 			return;
 		}
 
+		// The data is supplied by this module unless the access
+		// misses. A retried access starts over from this module.
+		if (frame->source_module)
+			*frame->source_module = module;
+
 		// Call "find_and_lock" event chain
 		auto new_frame = misc::new_shared<Frame>(
 				frame->getId(),
@@ -258,6 +263,7 @@ void System::EventLoadHandler(esim::Event *event, esim::Frame *esim_frame)
 				frame->tag);
 		new_frame->target_module = module->getLowModuleServingAddress(frame->tag);
 		new_frame->request_direction = Frame::RequestDirectionUpDown;
+		new_frame->source_module = frame->source_module;
 		esim_engine->Call(event_read_request,
 				new_frame,
 				event_load_miss);
@@ -2572,6 +2578,11 @@ void System::EventReadRequestHandler(esim::Event *event,
 			net::EndNode *node = target_module->getLowNetworkNode();
 			network->Receive(node, frame->message);
 		}
+
+		// Record the module reached by the load that started the
+		// request
+		if (frame->source_module)
+			*frame->source_module = target_module;
 		
 		// Call 'find-and-lock'
 		// TODO Read requests should always be able to be blocking.  
@@ -2743,6 +2754,7 @@ void System::EventReadRequestHandler(esim::Event *event,
 					frame->tag);
 			new_frame->target_module = target_module->getLowModuleServingAddress(frame->tag);
 			new_frame->request_direction = Frame::RequestDirectionUpDown;
+			new_frame->source_module = frame->source_module;
 			esim_engine->Call(event_read_request,
 					new_frame,
 					event_read_request_updown_miss);
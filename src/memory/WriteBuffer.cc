@@ -0,0 +1,145 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+#include <lib/cpp/String.h>
+
+#include "WriteBuffer.h"
+
+
+namespace mem
+{
+
+const unsigned WriteBuffer::LogLineSize;
+const unsigned WriteBuffer::LineSize;
+const unsigned WriteBuffer::LineMask;
+
+
+void WriteBuffer::AccessLine(unsigned address, unsigned size, char *buffer,
+		Memory::AccessType access)
+{
+	// Offset in the line
+	unsigned tag = address & LineMask;
+	unsigned offset = address & ~LineMask;
+	assert(offset + size <= LineSize);
+
+	// Read
+	if (access == Memory::AccessRead)
+	{
+		// Nothing buffered for this line
+		auto it = lines.find(tag);
+		if (it == lines.end())
+			return;
+
+		// Overwrite bytes read from memory with buffered bytes
+		Line &line = it->second;
+		for (unsigned i = 0; i < size; i++)
+			if (line.mask & (1ull << (offset + i)))
+				buffer[i] = line.data[offset + i];
+		return;
+	}
+
+	// Write
+	assert(access == Memory::AccessWrite);
+	Line &line = lines[tag];
+	memcpy(line.data + offset, buffer, size);
+	for (unsigned i = 0; i < size; i++)
+		line.mask |= 1ull << (offset + i);
+}
+
+
+void WriteBuffer::Read(unsigned address, unsigned size, char *buffer)
+{
+	// Read from memory
+	memory->Read(address, size, buffer);
+
+	// Apply buffered writes
+	while (size)
+	{
+		unsigned offset = address & ~LineMask;
+		unsigned chunk_size = std::min(size, LineSize - offset);
+		AccessLine(address, chunk_size, buffer, Memory::AccessRead);
+		size -= chunk_size;
+		buffer += chunk_size;
+		address += chunk_size;
+	}
+}
+
+
+void WriteBuffer::Write(unsigned address, unsigned size, char *buffer)
+{
+	while (size)
+	{
+		// Check page permissions in safe mode
+		unsigned offset = address & ~LineMask;
+		unsigned chunk_size = std::min(size, LineSize - offset);
+		if (memory->getSafe())
+		{
+			Memory::Page *page = memory->getPage(address);
+			if (!page)
+				throw Memory::Error(misc::fmt("[0x%x] Segmentation "
+						"fault in guest program", address));
+			if (!(page->getPerm() & Memory::AccessWrite))
+				throw Memory::Error(misc::fmt("[0x%x] Permission "
+						"denied", address));
+		}
+
+		// Buffer data
+		AccessLine(address, chunk_size, buffer, Memory::AccessWrite);
+		size -= chunk_size;
+		buffer += chunk_size;
+		address += chunk_size;
+	}
+}
+
+
+void WriteBuffer::Commit()
+{
+	for (auto &it : lines)
+	{
+		// Write each run of consecutive written bytes
+		Line &line = it.second;
+		unsigned i = 0;
+		while (i < LineSize)
+		{
+			// Skip bytes not written
+			if (!(line.mask & (1ull << i)))
+			{
+				i++;
+				continue;
+			}
+
+			// Find end of run
+			unsigned start = i;
+			while (i < LineSize && (line.mask & (1ull << i)))
+				i++;
+			memory->Write(it.first + start, i - start,
+					line.data + start);
+		}
+	}
+
+	// Empty buffer
+	lines.clear();
+}
+
+
+}  // namespace mem
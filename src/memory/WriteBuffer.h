@@ -0,0 +1,98 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MEMORY_WRITE_BUFFER_H
+#define MEMORY_WRITE_BUFFER_H
+
+#include <map>
+
+#include "Memory.h"
+
+
+namespace mem
+{
+
+/// Private buffer of memory writes. Writes are kept in the buffer instead of
+/// being applied to the associated memory object, and subsequent reads
+/// observe them, combined with the contents of the memory for those bytes
+/// that were not written. The buffered writes are applied to the memory with
+/// a call to Commit().
+///
+/// Write buffers are used to let multiple contexts sharing a memory object
+/// run concurrently without observing each other's writes, so that their
+/// execution is deterministic. Unlike class SpecMem, writes are tracked at a
+/// byte granularity, so that committing them does not overwrite bytes
+/// written by other contexts.
+class WriteBuffer
+{
+	// Size of a buffer line
+	static const unsigned LogLineSize = 6;
+	static const unsigned LineSize = 1 << LogLineSize;
+	static const unsigned LineMask = ~(LineSize - 1);
+
+	// Line of buffered data
+	struct Line
+	{
+		// Mask of bytes written in the line
+		unsigned long long mask = 0;
+
+		// Written data
+		char data[LineSize];
+	};
+
+	// Associated memory
+	Memory *memory;
+
+	// Buffered lines, indexed by address. An ordered map is used so that
+	// lines are committed in ascending address order.
+	std::map<unsigned, Line> lines;
+
+	// Access a region contained in one line
+	void AccessLine(unsigned address, unsigned size, char *buffer,
+			Memory::AccessType access);
+
+public:
+
+	/// Create a write buffer associated with a memory object
+	WriteBuffer(Memory *memory) : memory(memory)
+	{
+	}
+
+	/// Read from the memory, observing buffered writes
+	void Read(unsigned address, unsigned size, char *buffer);
+
+	/// Buffer a write into the memory. The write permissions of the
+	/// memory pages are checked right away in safe mode, without modifying
+	/// the memory object.
+	void Write(unsigned address, unsigned size, char *buffer);
+
+	/// Apply all buffered writes to the memory, and empty the buffer
+	void Commit();
+
+	/// Discard all buffered writes
+	void Clear() { lines.clear(); }
+
+	/// Return whether the buffer contains no writes
+	bool isEmpty() const { return lines.empty(); }
+};
+
+
+}  // namespace mem
+
+#endif
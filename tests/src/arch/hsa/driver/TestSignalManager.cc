@@ -0,0 +1,148 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "gtest/gtest.h"
+
+#include <arch/hsa/driver/SignalManager.h>
+#include <arch/x86/emulator/Context.h>
+#include <arch/x86/emulator/Emulator.h>
+#include <arch/x86/timing/Timing.h>
+#include <memory/Manager.h>
+
+#include "../../../../../runtime/include/hsa.h"
+
+
+namespace HSA
+{
+
+// Create an x86 context with a 64-bit buffer in its memory, returned in
+// argument 'value_ptr'.
+static x86::Context *CreateContext(unsigned &value_ptr)
+{
+	x86::Timing::setSimKind(comm::Arch::SimFunctional);
+	x86::Emulator *emulator = x86::Emulator::getInstance();
+	x86::Context *context = emulator->newContext();
+	context->Initialize();
+	mem::Memory *memory = context->getMemory();
+	memory->setHeapBreak(misc::RoundUp(memory->getHeapBreak(),
+			mem::Memory::PageSize));
+	mem::Manager manager(memory);
+	value_ptr = manager.Allocate(8, 8);
+	int64_t value = -1;
+	memory->Write(value_ptr, sizeof value, (char *) &value);
+	context->setState(x86::Context::StateRunning);
+	return context;
+}
+
+
+// Read the value returned by a wait
+static int64_t ReadValue(x86::Context *context, unsigned value_ptr)
+{
+	int64_t value;
+	context->getMemory()->Read(value_ptr, sizeof value, (char *) &value);
+	return value;
+}
+
+
+TEST(TestSignalManager, wait_satisfied)
+{
+	// Condition satisfied right away
+	x86::Emulator::Destroy();
+	unsigned value_ptr;
+	x86::Context *context = CreateContext(value_ptr);
+	SignalManager signal_manager;
+	uint64_t handler = signal_manager.CreateSignal(3);
+	signal_manager.Wait(context, context->getMemory(), value_ptr,
+			handler, HSA_SIGNAL_CONDITION_GTE, 2, UINT64_MAX);
+	EXPECT_FALSE(context->isSuspended());
+	EXPECT_EQ(0, signal_manager.getNumWaiters());
+	EXPECT_EQ(3, ReadValue(context, value_ptr));
+
+	// Invalid signal
+	EXPECT_THROW(signal_manager.Wait(context, context->getMemory(),
+			value_ptr, handler + 1, HSA_SIGNAL_CONDITION_EQ, 0,
+			UINT64_MAX), misc::Error);
+	x86::Emulator::Destroy();
+}
+
+
+TEST(TestSignalManager, wait_change_value)
+{
+	// Context suspended until the value satisfies the condition
+	x86::Emulator::Destroy();
+	unsigned value_ptr;
+	x86::Context *context = CreateContext(value_ptr);
+	SignalManager signal_manager;
+	uint64_t handler = signal_manager.CreateSignal(1);
+	signal_manager.Wait(context, context->getMemory(), value_ptr,
+			handler, HSA_SIGNAL_CONDITION_EQ, 0, UINT64_MAX);
+	EXPECT_TRUE(context->isSuspended());
+	EXPECT_EQ(1, signal_manager.getNumWaiters());
+
+	// Value not satisfying the condition
+	signal_manager.ChangeValue(handler, 2);
+	EXPECT_TRUE(context->isSuspended());
+	EXPECT_EQ(-1, ReadValue(context, value_ptr));
+
+	// Value satisfying the condition
+	signal_manager.ChangeValue(handler, 0);
+	EXPECT_FALSE(context->isSuspended());
+	EXPECT_EQ(0, signal_manager.getNumWaiters());
+	EXPECT_EQ(0, ReadValue(context, value_ptr));
+	x86::Emulator::Destroy();
+}
+
+
+TEST(TestSignalManager, destroy_signal)
+{
+	// Destroying the signal releases its waiters
+	x86::Emulator::Destroy();
+	unsigned value_ptr;
+	x86::Context *context = CreateContext(value_ptr);
+	SignalManager signal_manager;
+	uint64_t handler = signal_manager.CreateSignal(5);
+	signal_manager.Wait(context, context->getMemory(), value_ptr,
+			handler, HSA_SIGNAL_CONDITION_LT, 5, UINT64_MAX);
+	EXPECT_TRUE(context->isSuspended());
+	signal_manager.DestorySignal(handler);
+	EXPECT_FALSE(context->isSuspended());
+	EXPECT_EQ(0, signal_manager.getNumWaiters());
+	EXPECT_EQ(5, ReadValue(context, value_ptr));
+	x86::Emulator::Destroy();
+}
+
+
+TEST(TestSignalManager, destroyed_context)
+{
+	// A context destroyed while waiting is not woken up
+	x86::Emulator::Destroy();
+	unsigned value_ptr;
+	x86::Context *context = CreateContext(value_ptr);
+	SignalManager signal_manager;
+	uint64_t handler = signal_manager.CreateSignal(1);
+	signal_manager.Wait(context, context->getMemory(), value_ptr,
+			handler, HSA_SIGNAL_CONDITION_EQ, 0, UINT64_MAX);
+	x86::Emulator::Destroy();
+	x86::Emulator::getInstance();
+	signal_manager.ChangeValue(handler, 0);
+	EXPECT_EQ(0, signal_manager.getNumWaiters());
+	x86::Emulator::Destroy();
+}
+
+}  // namespace HSA
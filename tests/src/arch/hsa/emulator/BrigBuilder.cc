@@ -0,0 +1,261 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cstddef>
+#include <cstring>
+
+#include "BrigBuilder.h"
+
+
+namespace HSA
+{
+
+void BrigBuilder::InitializeSection(std::vector<char> &section,
+		const std::string &name)
+{
+	// Header with the name, padded to 4 bytes
+	unsigned header_size = (offsetof(BrigSectionHeader, name) +
+			name.size() + 3) & ~3;
+	section.assign(header_size, 0);
+	BrigSectionHeader *header = (BrigSectionHeader *) section.data();
+	header->headerByteCount = header_size;
+	header->nameLength = name.size();
+	memcpy(header->name, name.data(), name.size());
+}
+
+
+unsigned BrigBuilder::Append(std::vector<char> &section, const void *entry,
+		unsigned size)
+{
+	unsigned offset = section.size();
+	section.resize(offset + ((size + 3) & ~3), 0);
+	memcpy(section.data() + offset, entry, size);
+	return offset;
+}
+
+
+BrigBuilder::BrigBuilder()
+{
+	InitializeSection(data, "hsa_data");
+	InitializeSection(code, "hsa_code");
+	InitializeSection(operands, "hsa_operand");
+}
+
+
+unsigned BrigBuilder::addString(const std::string &string)
+{
+	std::vector<char> entry(sizeof(uint32_t) + string.size());
+	*(uint32_t *) entry.data() = string.size();
+	memcpy(entry.data() + sizeof(uint32_t), string.data(), string.size());
+	return Append(data, entry.data(), entry.size());
+}
+
+
+unsigned BrigBuilder::addList(const std::vector<unsigned> &offsets)
+{
+	std::vector<uint32_t> entry;
+	entry.push_back(offsets.size() * sizeof(uint32_t));
+	entry.insert(entry.end(), offsets.begin(), offsets.end());
+	return Append(data, entry.data(), entry.size() * sizeof(uint32_t));
+}
+
+
+unsigned BrigBuilder::addRegister(BrigRegisterKind kind,
+		unsigned short number)
+{
+	BrigOperandRegister operand = {};
+	operand.base.byteCount = sizeof operand;
+	operand.base.kind = BRIG_KIND_OPERAND_REGISTER;
+	operand.regKind = kind;
+	operand.regNum = number;
+	return Append(operands, &operand, sizeof operand);
+}
+
+
+unsigned BrigBuilder::addImmediate(BrigType type, const void *value,
+		unsigned size)
+{
+	BrigOperandConstantBytes operand = {};
+	operand.base.byteCount = sizeof operand;
+	operand.base.kind = BRIG_KIND_OPERAND_CONSTANT_BYTES;
+	operand.type = type;
+	operand.bytes = addString(std::string((const char *) value, size));
+	return Append(operands, &operand, sizeof operand);
+}
+
+
+unsigned BrigBuilder::addCodeRef(unsigned code_offset)
+{
+	BrigOperandCodeRef operand = {};
+	operand.base.byteCount = sizeof operand;
+	operand.base.kind = BRIG_KIND_OPERAND_CODE_REF;
+	operand.ref = code_offset;
+	return Append(operands, &operand, sizeof operand);
+}
+
+
+void BrigBuilder::setCodeRef(unsigned operand_offset, unsigned code_offset)
+{
+	BrigOperandCodeRef *operand = (BrigOperandCodeRef *)
+			(operands.data() + operand_offset);
+	operand->ref = code_offset;
+}
+
+
+unsigned BrigBuilder::addAddress(unsigned symbol, unsigned reg,
+		uint64_t offset)
+{
+	BrigOperandAddress operand = {};
+	operand.base.byteCount = sizeof operand;
+	operand.base.kind = BRIG_KIND_OPERAND_ADDRESS;
+	operand.symbol = symbol;
+	operand.reg = reg;
+	operand.offset.lo = offset;
+	operand.offset.hi = offset >> 32;
+	return Append(operands, &operand, sizeof operand);
+}
+
+
+unsigned BrigBuilder::addOperandList(const std::vector<unsigned> &elements)
+{
+	BrigOperandOperandList operand = {};
+	operand.base.byteCount = sizeof operand;
+	operand.base.kind = BRIG_KIND_OPERAND_OPERAND_LIST;
+	operand.elements = addList(elements);
+	return Append(operands, &operand, sizeof operand);
+}
+
+
+unsigned BrigBuilder::addKernel(const std::string &name)
+{
+	BrigDirectiveExecutable directive = {};
+	directive.base.byteCount = sizeof directive;
+	directive.base.kind = BRIG_KIND_DIRECTIVE_KERNEL;
+	directive.name = addString(name);
+	directive.firstInArg = code.size() + sizeof directive;
+	directive.firstCodeBlockEntry = code.size() + sizeof directive;
+	directive.modifier.allBits = BRIG_EXECUTABLE_DEFINITION;
+	return Append(code, &directive, sizeof directive);
+}
+
+
+void BrigBuilder::endExecutable(unsigned executable_offset)
+{
+	BrigDirectiveExecutable *directive = (BrigDirectiveExecutable *)
+			(code.data() + executable_offset);
+	directive->nextModuleEntry = code.size();
+}
+
+
+unsigned BrigBuilder::addLabel(const std::string &name)
+{
+	BrigDirectiveLabel directive = {};
+	directive.base.byteCount = sizeof directive;
+	directive.base.kind = BRIG_KIND_DIRECTIVE_LABEL;
+	directive.name = addString(name);
+	return Append(code, &directive, sizeof directive);
+}
+
+
+unsigned BrigBuilder::addVariable(const std::string &name, BrigType type,
+		BrigSegment segment)
+{
+	BrigDirectiveVariable directive = {};
+	directive.base.byteCount = sizeof directive;
+	directive.base.kind = BRIG_KIND_DIRECTIVE_VARIABLE;
+	directive.name = addString(name);
+	directive.type = type;
+	directive.segment = segment;
+	directive.modifier.allBits = BRIG_VARIABLE_DEFINITION;
+	return Append(code, &directive, sizeof directive);
+}
+
+
+unsigned BrigBuilder::addInstruction(BrigOpcode opcode, BrigType type,
+		const std::vector<unsigned> &operands)
+{
+	BrigInstBasic inst = {};
+	inst.base.base.byteCount = sizeof inst;
+	inst.base.base.kind = BRIG_KIND_INST_BASIC;
+	inst.base.opcode = opcode;
+	inst.base.type = type;
+	inst.base.operands = addList(operands);
+	return Append(code, &inst, sizeof inst);
+}
+
+
+unsigned BrigBuilder::addBranch(BrigOpcode opcode, BrigType type,
+		const std::vector<unsigned> &operands)
+{
+	BrigInstBr inst = {};
+	inst.base.base.byteCount = sizeof inst;
+	inst.base.base.kind = BRIG_KIND_INST_BR;
+	inst.base.opcode = opcode;
+	inst.base.type = type;
+	inst.base.operands = addList(operands);
+	inst.width = BRIG_WIDTH_1;
+	return Append(code, &inst, sizeof inst);
+}
+
+
+unsigned BrigBuilder::addCompare(BrigCompareOperation compare, BrigType type,
+		BrigType source_type, const std::vector<unsigned> &operands)
+{
+	BrigInstCmp inst = {};
+	inst.base.base.byteCount = sizeof inst;
+	inst.base.base.kind = BRIG_KIND_INST_CMP;
+	inst.base.opcode = BRIG_OPCODE_CMP;
+	inst.base.type = type;
+	inst.base.operands = addList(operands);
+	inst.sourceType = source_type;
+	inst.compare = compare;
+	return Append(code, &inst, sizeof inst);
+}
+
+
+const char *BrigBuilder::Build()
+{
+	// Set section sizes
+	std::vector<char> *sections[] = { &data, &code, &operands };
+	for (std::vector<char> *section : sections)
+		((BrigSectionHeader *) section->data())->byteCount =
+				section->size();
+
+	// Module header, followed by the section index and the sections
+	module.assign(sizeof(BrigModuleHeader) + sizeof(uint64_t) * 3, 0);
+	uint64_t section_index[3];
+	for (unsigned i = 0; i < 3; i++)
+	{
+		section_index[i] = module.size();
+		module.insert(module.end(), sections[i]->begin(),
+				sections[i]->end());
+	}
+	memcpy(module.data() + sizeof(BrigModuleHeader), section_index,
+			sizeof section_index);
+
+	// Fill in the header
+	BrigModuleHeader *header = (BrigModuleHeader *) module.data();
+	memcpy(header->identification, "HSA BRIG", 8);
+	header->byteCount = module.size();
+	header->sectionCount = 3;
+	header->sectionIndex = sizeof(BrigModuleHeader);
+	return module.data();
+}
+
+}  // namespace HSA
@@ -0,0 +1,127 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef ARCH_HSA_EMULATOR_BRIG_BUILDER_H
+#define ARCH_HSA_EMULATOR_BRIG_BUILDER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <arch/hsa/disassembler/Brig.h>
+
+
+namespace HSA
+{
+
+/// Assembles a BRIG module in memory, entry by entry, for tests that need
+/// functions to load without going through the HSAIL finalizer. All
+/// functions return the offset of the new entry in its section.
+class BrigBuilder
+{
+	// Data, code, and operand sections, including their headers
+	std::vector<char> data;
+	std::vector<char> code;
+	std::vector<char> operands;
+
+	// Module buffer returned by the last call to Build()
+	std::vector<char> module;
+
+	// Initialize a section with its header
+	static void InitializeSection(std::vector<char> &section,
+			const std::string &name);
+
+	// Append an entry to a section, padded to 4 bytes
+	static unsigned Append(std::vector<char> &section, const void *entry,
+			unsigned size);
+
+	// Add a list of offsets in the data section
+	unsigned addList(const std::vector<unsigned> &offsets);
+
+public:
+
+	/// Constructor
+	BrigBuilder();
+
+	/// Add a string in the data section
+	unsigned addString(const std::string &string);
+
+	/// Add a register operand
+	unsigned addRegister(BrigRegisterKind kind, unsigned short number);
+
+	/// Add an immediate operand with the bytes of a value
+	unsigned addImmediate(BrigType type, const void *value, unsigned size);
+
+	/// Add a code reference operand to an entry in the code section.
+	/// The entry can be set later with setCodeRef().
+	unsigned addCodeRef(unsigned code_offset = 0);
+
+	/// Make a code reference operand point to an entry in the code
+	/// section
+	void setCodeRef(unsigned operand_offset, unsigned code_offset);
+
+	/// Add an address operand, given the offset of a variable
+	/// directive in the code section (0 for none), the offset of a
+	/// register operand (0 for none), and a constant offset
+	unsigned addAddress(unsigned symbol, unsigned reg, uint64_t offset);
+
+	/// Add an operand list
+	unsigned addOperandList(const std::vector<unsigned> &elements);
+
+	/// Add a kernel directive with no arguments. Its first code block
+	/// entry is the entry added next, and its end is set with
+	/// endExecutable().
+	unsigned addKernel(const std::string &name);
+
+	/// Set the end of a kernel at the next entry added to the code
+	/// section
+	void endExecutable(unsigned executable_offset);
+
+	/// Add a label directive
+	unsigned addLabel(const std::string &name);
+
+	/// Add a variable definition directive
+	unsigned addVariable(const std::string &name, BrigType type,
+			BrigSegment segment);
+
+	/// Add an instruction of format BrigInstBasic
+	unsigned addInstruction(BrigOpcode opcode, BrigType type,
+			const std::vector<unsigned> &operands);
+
+	/// Add a branch instruction
+	unsigned addBranch(BrigOpcode opcode, BrigType type,
+			const std::vector<unsigned> &operands);
+
+	/// Add a compare instruction
+	unsigned addCompare(BrigCompareOperation compare, BrigType type,
+			BrigType source_type,
+			const std::vector<unsigned> &operands);
+
+	/// Return the offset that the next entry in the code section will
+	/// have
+	unsigned getNextCodeOffset() const { return code.size(); }
+
+	/// Assemble the module and return a buffer with it. The buffer is
+	/// valid until the next call to this function.
+	const char *Build();
+};
+
+}  // namespace HSA
+
+#endif
@@ -0,0 +1,180 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "gtest/gtest.h"
+
+#include <arch/hsa/disassembler/BrigCodeEntry.h>
+#include <arch/hsa/driver/HsaExecutable.h>
+#include <arch/hsa/emulator/Emulator.h>
+#include <arch/hsa/emulator/Function.h>
+
+#include "BrigBuilder.h"
+
+
+namespace HSA
+{
+
+// Offsets of the body entries of the kernel built by BuildKernel()
+static std::vector<unsigned> offsets;
+
+// Build a module with a kernel with the following body, and record the
+// offsets of its entries:
+//
+//	@begin:
+//	mov_u32 $s0, 42;
+//	cbr_b1 $c0, @end;
+//	br @begin;
+//	private_u32 %var;
+//	lda_u32 $s1, [%var+4];
+//	@end:
+//	add_u32 $s1, $s1, $s0;
+//
+static const char *BuildKernel(BrigBuilder &builder)
+{
+	unsigned kernel = builder.addKernel("&kernel");
+	unsigned s0 = builder.addRegister(BRIG_REGISTER_KIND_SINGLE, 0);
+	unsigned s1 = builder.addRegister(BRIG_REGISTER_KIND_SINGLE, 1);
+	unsigned c0 = builder.addRegister(BRIG_REGISTER_KIND_CONTROL, 0);
+	unsigned value = 42;
+	unsigned immediate = builder.addImmediate(BRIG_TYPE_U32, &value,
+			sizeof value);
+	unsigned end = builder.addCodeRef();
+
+	offsets.clear();
+	unsigned begin = builder.addLabel("@begin");
+	offsets.push_back(begin);
+	offsets.push_back(builder.addInstruction(BRIG_OPCODE_MOV,
+			BRIG_TYPE_U32, { s0, immediate }));
+	offsets.push_back(builder.addBranch(BRIG_OPCODE_CBR, BRIG_TYPE_B1,
+			{ c0, end }));
+	offsets.push_back(builder.addBranch(BRIG_OPCODE_BR, BRIG_TYPE_NONE,
+			{ builder.addCodeRef(begin) }));
+	unsigned var = builder.addVariable("%var", BRIG_TYPE_U32,
+			BRIG_SEGMENT_PRIVATE);
+	offsets.push_back(var);
+	offsets.push_back(builder.addInstruction(BRIG_OPCODE_LDA,
+			BRIG_TYPE_U32, { s1, builder.addAddress(var, 0, 4) }));
+	unsigned end_label = builder.addLabel("@end");
+	builder.setCodeRef(end, end_label);
+	offsets.push_back(end_label);
+	offsets.push_back(builder.addInstruction(BRIG_OPCODE_ADD,
+			BRIG_TYPE_U32, { s1, s1, s0 }));
+	builder.endExecutable(kernel);
+	return builder.Build();
+}
+
+
+TEST(TestFunction, lower_entries)
+{
+	BrigBuilder builder;
+	HsaExecutable executable;
+	executable.AddModule(BuildKernel(builder));
+	Function *function = executable.getFunction("&kernel");
+
+	// Entries are indexed by their position in the function body
+	ASSERT_EQ(offsets.size(), function->getCodeSize());
+	for (unsigned i = 0; i < offsets.size(); i++)
+	{
+		EXPECT_EQ(offsets[i], function->getCodeEntry(i)->getOffset());
+		EXPECT_EQ(function->getCodeEntry(i),
+				function->getInstruction(i)->entry.get());
+	}
+	EXPECT_EQ(nullptr, function->getCodeEntry(offsets.size()));
+	EXPECT_EQ(nullptr, function->getInstruction(offsets.size()));
+}
+
+
+TEST(TestFunction, lower_branches)
+{
+	BrigBuilder builder;
+	HsaExecutable executable;
+	executable.AddModule(BuildKernel(builder));
+	Function *function = executable.getFunction("&kernel");
+
+	// Forward conditional branch to @end, backward branch to @begin
+	EXPECT_EQ(6u, function->getBranchTarget(2));
+	EXPECT_EQ(0u, function->getBranchTarget(3));
+
+	// Other entries are not branches
+	EXPECT_THROW(function->getBranchTarget(1), misc::Panic);
+	EXPECT_THROW(function->getBranchTarget(0), misc::Panic);
+}
+
+
+TEST(TestFunction, lower_operands)
+{
+	BrigBuilder builder;
+	HsaExecutable executable;
+	executable.AddModule(BuildKernel(builder));
+	Function *function = executable.getFunction("&kernel");
+
+	// Immediate
+	const LoweredInstruction *mov = function->getInstruction(1);
+	ASSERT_EQ(2u, mov->operands.size());
+	const LoweredOperand &immediate = mov->operands[1];
+	EXPECT_EQ(BRIG_KIND_OPERAND_CONSTANT_BYTES, immediate.kind);
+	ASSERT_EQ(4u, immediate.immediate.size());
+	unsigned value = 0;
+	memcpy(&value, immediate.immediate.data(), sizeof value);
+	EXPECT_EQ(42u, value);
+
+	// Address with a symbol and no register
+	const LoweredInstruction *lda = function->getInstruction(5);
+	ASSERT_EQ(2u, lda->operands.size());
+	const LoweredOperand &address = lda->operands[1];
+	EXPECT_EQ(BRIG_KIND_OPERAND_ADDRESS, address.kind);
+	EXPECT_EQ("%var", address.symbol);
+	EXPECT_EQ(0u, address.reg.size);
+	EXPECT_EQ(4u, address.offset);
+
+	// Labels are code references, and directives have no operands
+	const LoweredInstruction *br = function->getInstruction(3);
+	ASSERT_EQ(1u, br->operands.size());
+	EXPECT_EQ(BRIG_KIND_OPERAND_CODE_REF, br->operands[0].kind);
+	EXPECT_TRUE(function->getInstruction(4)->operands.empty());
+}
+
+
+TEST(TestFunction, label_out_of_function)
+{
+	// The first kernel branches to a label in the second one
+	BrigBuilder builder;
+	unsigned label = builder.addCodeRef();
+	unsigned first = builder.addKernel("&first");
+	builder.addBranch(BRIG_OPCODE_BR, BRIG_TYPE_NONE, { label });
+	builder.endExecutable(first);
+	unsigned second = builder.addKernel("&second");
+	builder.setCodeRef(label, builder.addLabel("@far"));
+	builder.addBranch(BRIG_OPCODE_BR, BRIG_TYPE_NONE, { label });
+	builder.endExecutable(second);
+
+	HsaExecutable executable;
+	try
+	{
+		executable.AddModule(builder.Build());
+		FAIL() << "Expected an error";
+	}
+	catch (Error &error)
+	{
+		EXPECT_NE(std::string::npos, error.getMessage().find(
+				"Label @far out of function &first"));
+	}
+}
+
+}  // namespace HSA
@@ -0,0 +1,214 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "gtest/gtest.h"
+
+#include <arch/hsa/disassembler/BrigCodeEntry.h>
+#include <arch/hsa/driver/HsaExecutable.h>
+#include <arch/hsa/emulator/Function.h>
+#include <arch/hsa/emulator/OperandValueRetriever.h>
+#include <arch/hsa/emulator/OperandValueWriter.h>
+#include <arch/hsa/emulator/StackFrame.h>
+
+#include "BrigBuilder.h"
+
+
+namespace HSA
+{
+
+// Load a kernel with the following body:
+//
+//	add_u32 $s2, $s0, $s1;
+//	mov_b64 $d1, $d0;
+//	ld_v2_u32 ($s3, $s4), [$d1+8];
+//	cmp_lt_b1_u32 $c1, $s0, $s1;
+//	mov_b128 $q0, $q1;
+//
+static Function *LoadKernel(HsaExecutable &executable)
+{
+	BrigBuilder builder;
+	unsigned kernel = builder.addKernel("&kernel");
+	unsigned s[5];
+	for (unsigned i = 0; i < 5; i++)
+		s[i] = builder.addRegister(BRIG_REGISTER_KIND_SINGLE, i);
+	unsigned d0 = builder.addRegister(BRIG_REGISTER_KIND_DOUBLE, 0);
+	unsigned d1 = builder.addRegister(BRIG_REGISTER_KIND_DOUBLE, 1);
+	unsigned c1 = builder.addRegister(BRIG_REGISTER_KIND_CONTROL, 1);
+	unsigned q0 = builder.addRegister(BRIG_REGISTER_KIND_QUAD, 0);
+	unsigned q1 = builder.addRegister(BRIG_REGISTER_KIND_QUAD, 1);
+	builder.addInstruction(BRIG_OPCODE_ADD, BRIG_TYPE_U32,
+			{ s[2], s[0], s[1] });
+	builder.addInstruction(BRIG_OPCODE_MOV, BRIG_TYPE_B64, { d1, d0 });
+	builder.addInstruction(BRIG_OPCODE_LD, BRIG_TYPE_U32,
+			{ builder.addOperandList({ s[3], s[4] }),
+			builder.addAddress(0, d1, 8) });
+	builder.addCompare(BRIG_COMPARE_LT, BRIG_TYPE_B1, BRIG_TYPE_U32,
+			{ c1, s[0], s[1] });
+	builder.addInstruction(BRIG_OPCODE_MOV, BRIG_TYPE_B128, { q0, q1 });
+	builder.endExecutable(kernel);
+	executable.AddModule(builder.Build());
+	return executable.getFunction("&kernel");
+}
+
+
+TEST(TestStackFrame, register_slots)
+{
+	HsaExecutable executable;
+	Function *function = LoadKernel(executable);
+
+	// Operands are resolved into the slots of their registers
+	const LoweredInstruction *add = function->getInstruction(0);
+	ASSERT_EQ(3u, add->operands.size());
+	for (unsigned i = 0; i < 3; i++)
+	{
+		RegisterSlot slot = function->getRegisterSlot(
+				BRIG_REGISTER_KIND_SINGLE, (2 + i) % 3);
+		EXPECT_EQ(BRIG_KIND_OPERAND_REGISTER,
+				add->operands[i].kind);
+		EXPECT_EQ(slot.offset, add->operands[i].reg.offset);
+		EXPECT_EQ(4u, add->operands[i].reg.size);
+	}
+
+	// Address operands keep the slot of their base register, and
+	// operand lists the slots of their elements
+	const LoweredInstruction *ld = function->getInstruction(2);
+	ASSERT_EQ(2u, ld->operands.size());
+	ASSERT_EQ(2u, ld->operands[0].elements.size());
+	EXPECT_EQ(function->getRegisterSlot(BRIG_REGISTER_KIND_SINGLE,
+			3).offset, ld->operands[0].elements[0].offset);
+	EXPECT_EQ(function->getRegisterSlot(BRIG_REGISTER_KIND_SINGLE,
+			4).offset, ld->operands[0].elements[1].offset);
+	EXPECT_EQ(BRIG_KIND_OPERAND_ADDRESS, ld->operands[1].kind);
+	EXPECT_EQ(function->getRegisterSlot(BRIG_REGISTER_KIND_DOUBLE,
+			1).offset, ld->operands[1].reg.offset);
+	EXPECT_EQ(8u, ld->operands[1].reg.size);
+
+	// Slots are aligned to their size and do not overlap
+	std::vector<bool> used(function->getRegisterSize(), false);
+	const unsigned counts[] = { 2, 5, 2, 2 };
+	for (unsigned kind = 0; kind < 4; kind++)
+	{
+		for (unsigned number = 0; number < counts[kind]; number++)
+		{
+			RegisterSlot slot = function->getRegisterSlot(
+					(BrigRegisterKind) kind, number);
+			EXPECT_EQ(0u, slot.offset % slot.size);
+			ASSERT_LE(slot.offset + slot.size, used.size());
+			for (unsigned i = 0; i < slot.size; i++)
+			{
+				EXPECT_FALSE(used[slot.offset + i]);
+				used[slot.offset + i] = true;
+			}
+		}
+	}
+	EXPECT_THROW(function->getRegisterSlot(BRIG_REGISTER_KIND_SINGLE, 5),
+			misc::Panic);
+}
+
+
+TEST(TestStackFrame, register_access)
+{
+	HsaExecutable executable;
+	Function *function = LoadKernel(executable);
+	StackFrame frame(function, nullptr, nullptr);
+
+	// Values set through slots are read by name, and the other way
+	// around
+	RegisterSlot s2 = function->getRegisterSlot(
+			BRIG_REGISTER_KIND_SINGLE, 2);
+	RegisterSlot c1 = function->getRegisterSlot(
+			BRIG_REGISTER_KIND_CONTROL, 1);
+	unsigned s2_value = 0x12345678;
+	unsigned char c1_value = 1;
+	frame.setRegisterValue(s2, &s2_value);
+	frame.setRegisterValue(c1, &c1_value);
+	unsigned value = 0;
+	unsigned char condition = 0;
+	frame.getRegisterValue("$s2", &value);
+	frame.getRegisterValue("$c1", &condition);
+	EXPECT_EQ(s2_value, value);
+	EXPECT_EQ(c1_value, condition);
+
+	unsigned long long d0_value = 0x0123456789abcdefull;
+	unsigned long long double_value = 0;
+	frame.setRegisterValue("$d0", &d0_value);
+	frame.getRegisterValue(function->getRegisterSlot(
+			BRIG_REGISTER_KIND_DOUBLE, 0), &double_value);
+	EXPECT_EQ(d0_value, double_value);
+}
+
+
+TEST(TestStackFrame, operand_access)
+{
+	HsaExecutable executable;
+	Function *function = LoadKernel(executable);
+	StackFrame frame(function, nullptr, nullptr);
+	OperandValueRetriever retriever(nullptr, &frame);
+	OperandValueWriter writer(nullptr, &frame);
+
+	// Register operands of add_u32 $s2, $s0, $s1
+	unsigned s0 = 3;
+	unsigned s1 = 4;
+	frame.setRegisterValue("$s0", &s0);
+	frame.setRegisterValue("$s1", &s1);
+	retriever.Bind(nullptr, &frame);
+	writer.Bind(nullptr, &frame);
+	BrigCodeEntry *add = frame.getPc();
+	unsigned src0 = 0;
+	unsigned src1 = 0;
+	retriever.Retrieve(add, 1, &src0);
+	retriever.Retrieve(add, 2, &src1);
+	EXPECT_EQ(s0, src0);
+	EXPECT_EQ(s1, src1);
+	unsigned dst = src0 + src1;
+	writer.Write(add, 0, &dst);
+	unsigned s2 = 0;
+	frame.getRegisterValue("$s2", &s2);
+	EXPECT_EQ(7u, s2);
+
+	// Operand list and address operands of ld_v2_u32 ($s3, $s4),
+	// [$d1+8]
+	frame.setPc(2);
+	retriever.Bind(nullptr, &frame);
+	writer.Bind(nullptr, &frame);
+	BrigCodeEntry *ld = frame.getPc();
+	unsigned values[2] = { 10, 20 };
+	writer.Write(ld, 0, values);
+	unsigned s3 = 0;
+	unsigned s4 = 0;
+	frame.getRegisterValue("$s3", &s3);
+	frame.getRegisterValue("$s4", &s4);
+	EXPECT_EQ(10u, s3);
+	EXPECT_EQ(20u, s4);
+	unsigned list[2] = { 0, 0 };
+	retriever.Retrieve(ld, 0, list);
+	EXPECT_EQ(10u, list[0]);
+	EXPECT_EQ(20u, list[1]);
+
+	unsigned long long d1 = 0x1000;
+	frame.setRegisterValue("$d1", &d1);
+	unsigned address = 0;
+	retriever.Retrieve(ld, 1, &address);
+	EXPECT_EQ(0x1008u, address);
+
+	// Operands are only valid for the bound instruction
+	EXPECT_THROW(retriever.Retrieve(ld, 2, &address), misc::Panic);
+}
+
+}  // namespace HSA
@@ -0,0 +1,183 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "gtest/gtest.h"
+
+#include <arch/hsa/disassembler/BrigCodeEntry.h>
+#include <arch/hsa/driver/HsaExecutable.h>
+#include <arch/hsa/driver/HsaExecutableSymbol.h>
+#include <arch/hsa/emulator/AQLPacket.h>
+#include <arch/hsa/emulator/Component.h>
+#include <arch/hsa/emulator/Emulator.h>
+#include <arch/hsa/emulator/Grid.h>
+#include <arch/hsa/emulator/Wavefront.h>
+#include <arch/hsa/emulator/WorkGroup.h>
+#include <arch/hsa/emulator/WorkItem.h>
+#include <memory/Memory.h>
+
+#include "BrigBuilder.h"
+
+
+namespace HSA
+{
+
+// Number of lanes in the wavefront
+static const unsigned num_lanes = 4;
+
+// Build a module with a kernel in which lanes 0 and 1 take a branch and
+// lanes 2 and 3 fall through, before all of them reconverge:
+//
+//	 0	workitemabsid_u32 $s0, 0;
+//	 1	cmp_lt_b1_u32 $c0, $s0, 2;
+//	 2	cbr_b1 $c0, @else;
+//	 3	add_u32 $s1, $s0, 100;
+//	 4	br @end;
+//	 5	@else:
+//	 6	add_u32 $s1, $s0, 200;
+//	 7	@end:
+//	 8	add_u32 $s2, $s1, 1;
+//
+static const char *BuildKernel(BrigBuilder &builder)
+{
+	unsigned kernel = builder.addKernel("&kernel");
+	unsigned s0 = builder.addRegister(BRIG_REGISTER_KIND_SINGLE, 0);
+	unsigned s1 = builder.addRegister(BRIG_REGISTER_KIND_SINGLE, 1);
+	unsigned s2 = builder.addRegister(BRIG_REGISTER_KIND_SINGLE, 2);
+	unsigned c0 = builder.addRegister(BRIG_REGISTER_KIND_CONTROL, 0);
+	unsigned values[] = { 0, 2, 100, 200, 1 };
+	unsigned immediates[5];
+	for (unsigned i = 0; i < 5; i++)
+		immediates[i] = builder.addImmediate(BRIG_TYPE_U32,
+				&values[i], sizeof values[i]);
+	unsigned else_ref = builder.addCodeRef();
+	unsigned end_ref = builder.addCodeRef();
+
+	builder.addInstruction(BRIG_OPCODE_WORKITEMABSID, BRIG_TYPE_U32,
+			{ s0, immediates[0] });
+	builder.addCompare(BRIG_COMPARE_LT, BRIG_TYPE_B1, BRIG_TYPE_U32,
+			{ c0, s0, immediates[1] });
+	builder.addBranch(BRIG_OPCODE_CBR, BRIG_TYPE_B1, { c0, else_ref });
+	builder.addInstruction(BRIG_OPCODE_ADD, BRIG_TYPE_U32,
+			{ s1, s0, immediates[2] });
+	builder.addBranch(BRIG_OPCODE_BR, BRIG_TYPE_NONE, { end_ref });
+	builder.setCodeRef(else_ref, builder.addLabel("@else"));
+	builder.addInstruction(BRIG_OPCODE_ADD, BRIG_TYPE_U32,
+			{ s1, s0, immediates[3] });
+	builder.setCodeRef(end_ref, builder.addLabel("@end"));
+	builder.addInstruction(BRIG_OPCODE_ADD, BRIG_TYPE_U32,
+			{ s2, s1, immediates[4] });
+	builder.endExecutable(kernel);
+	return builder.Build();
+}
+
+
+// Return the execution mask of the last instruction as a string with one
+// character per lane
+static std::string getExecMask(const Wavefront &wavefront)
+{
+	std::string mask;
+	for (unsigned lane = 0; lane < num_lanes; lane++)
+		mask += wavefront.isLaneActive(lane) ? '1' : '0';
+	return mask;
+}
+
+
+TEST(TestWavefront, divergence)
+{
+	// Load the kernel
+	BrigBuilder builder;
+	HsaExecutable executable;
+	executable.AddModule(BuildKernel(builder));
+	Function *function = executable.getFunction("&kernel");
+	std::unique_ptr<HsaExecutableSymbol> symbol(
+			executable.getSymbol("&kernel"));
+
+	// Grid with one work group of one wavefront
+	mem::Memory memory;
+	Emulator::getInstance()->setMemory(&memory);
+	Component component(0);
+	component.setWavesize(num_lanes);
+	AQLDispatchPacket packet;
+	packet.setDimension(1);
+	packet.setWorkGroupSize(num_lanes, 1, 1);
+	packet.setGridSize(num_lanes, 1, 1);
+	packet.setKernalObjectAddress((unsigned long long) symbol.get());
+	Grid grid(&component, &packet);
+	WorkGroup work_group(&grid, 0, 0, 0, 0);
+	Wavefront wavefront(0, &work_group);
+	for (unsigned lane = 0; lane < num_lanes; lane++)
+	{
+		auto work_item = misc::new_unique<WorkItem>();
+		work_item->Initialize(&work_group, 0, lane, 0, 0, function);
+		wavefront.addWorkItem(std::move(work_item));
+	}
+
+	// Uniform instructions run on all lanes
+	for (unsigned pc = 0; pc < 3; pc++)
+	{
+		ASSERT_TRUE(wavefront.Execute());
+		EXPECT_EQ(function->getCodeEntry(pc),
+				wavefront.getInstruction());
+		EXPECT_EQ("1111", getExecMask(wavefront));
+	}
+
+	// Lanes 2 and 3 run the fall-through path first, since it has the
+	// lowest program counter, while lanes 0 and 1 wait at @else
+	ASSERT_TRUE(wavefront.Execute());
+	EXPECT_EQ(function->getCodeEntry(3), wavefront.getInstruction());
+	EXPECT_EQ("0011", getExecMask(wavefront));
+	ASSERT_TRUE(wavefront.Execute());
+	EXPECT_EQ(function->getCodeEntry(4), wavefront.getInstruction());
+	EXPECT_EQ("0011", getExecMask(wavefront));
+
+	// Lanes 0 and 1 run the taken path, while lanes 2 and 3 wait at @end
+	for (unsigned pc = 5; pc < 7; pc++)
+	{
+		ASSERT_TRUE(wavefront.Execute());
+		EXPECT_EQ(function->getCodeEntry(pc),
+				wavefront.getInstruction());
+		EXPECT_EQ("1100", getExecMask(wavefront));
+	}
+
+	// All lanes reconverge at @end
+	for (unsigned pc = 7; pc < 9; pc++)
+	{
+		ASSERT_TRUE(wavefront.Execute());
+		EXPECT_EQ(function->getCodeEntry(pc),
+				wavefront.getInstruction());
+		EXPECT_EQ("1111", getExecMask(wavefront));
+	}
+	EXPECT_FALSE(wavefront.Execute());
+
+	// Register values of all lanes are contiguous in the register file
+	const unsigned *s1 = (const unsigned *) wavefront.getRegister(
+			function->getRegisterSlot(BRIG_REGISTER_KIND_SINGLE, 1));
+	const unsigned *s2 = (const unsigned *) wavefront.getRegister(
+			function->getRegisterSlot(BRIG_REGISTER_KIND_SINGLE, 2));
+	ASSERT_NE(nullptr, s1);
+	ASSERT_NE(nullptr, s2);
+	const unsigned expected[num_lanes] = { 200, 201, 102, 103 };
+	for (unsigned lane = 0; lane < num_lanes; lane++)
+	{
+		EXPECT_EQ(expected[lane], s1[lane]);
+		EXPECT_EQ(expected[lane] + 1, s2[lane]);
+	}
+}
+
+}  // namespace HSA
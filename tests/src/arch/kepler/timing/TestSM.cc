@@ -0,0 +1,311 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cstring>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <arch/kepler/emulator/Emulator.h>
+#include <arch/kepler/emulator/Grid.h>
+#include <arch/kepler/emulator/Thread.h>
+#include <arch/kepler/emulator/ThreadBlock.h>
+#include <arch/kepler/emulator/Warp.h>
+#include <arch/kepler/timing/Timing.h>
+#include <lib/cpp/IniFile.h>
+#include <lib/esim/Engine.h>
+#include <memory/System.h>
+#include <network/System.h>
+
+namespace Kepler
+{
+
+// Instruction encodings
+static const unsigned long long inst_control = 0x0800000000000000ull;
+static const unsigned long long inst_s2r_r0_tid = 0x86400000109c0002ull;
+static const unsigned long long inst_iscadd_r4 = 0x60c00800289c0012ull;
+static const unsigned long long inst_ld_r0 = 0xc4000000001c1000ull;
+static const unsigned long long inst_ld_r3 = 0xc4000000001c100cull;
+static const unsigned long long inst_iadd = 0xe0800000001c0c02ull;
+static const unsigned long long inst_exit = 0x18000000001c003cull;
+
+// Offset in the constant memory of the first kernel argument, used by
+// instruction 'ISCADD R4, R0, c[0x0][0x144], 0x2'
+static const unsigned argument_address = 0x144;
+
+// One streaming multiprocessor with a single warp scheduler, where
+// instructions are ready one cycle after they leave the operand collector.
+// The scheduling policy is given in the format argument.
+const char *config_format =
+		"[ Device ]\n"
+		"Frequency = 1000\n"
+		"NumSMs = 1\n"
+		"[ SM ]\n"
+		"NumWarpSchedulers = 1\n"
+		"MaxThreadBlocks = 16\n"
+		"MaxWarps = 64\n"
+		"SchedulingPolicy = %s\n"
+		"AluLatency = 1\n"
+		"BranchLatency = 1\n"
+		"[ LdStUnit ]\n"
+		"Width = 4\n";
+
+// L1 cache connected to main memory
+const std::string mem_config =
+		"[ CacheGeometry geo-l1 ]\n"
+		"Sets = 16\n"
+		"Assoc = 2\n"
+		"BlockSize = 128\n"
+		"Latency = 1\n"
+		"Policy = LRU\n"
+		"\n"
+		"[ Module mod-l1 ]\n"
+		"Type = Cache\n"
+		"Geometry = geo-l1\n"
+		"LowNetwork = net-l1-mm\n"
+		"LowModules = mod-mm\n"
+		"\n"
+		"[ Module mod-mm ]\n"
+		"Type = MainMemory\n"
+		"BlockSize = 128\n"
+		"Latency = 100\n"
+		"HighNetwork = net-l1-mm\n"
+		"\n"
+		"[ Network net-l1-mm ]\n"
+		"DefaultInputBufferSize = 1056\n"
+		"DefaultOutputBufferSize = 1056\n"
+		"DefaultBandwidth = 528\n"
+		"\n"
+		"[ Entry sm-0 ]\n"
+		"Arch = Kepler\n"
+		"SM = 0\n"
+		"Module = mod-l1\n";
+
+static void Cleanup()
+{
+	esim::Engine::Destroy();
+	net::System::Destroy();
+	mem::System::Destroy();
+	Timing::Destroy();
+	Emulator::Destroy();
+	comm::ArchPool::Destroy();
+}
+
+// Create the timing simulator and the memory hierarchy with the given
+// scheduling policy
+static void Initialize(const std::string &scheduling_policy)
+{
+	// Cleanup singleton instances
+	Cleanup();
+
+	// Timing simulator
+	misc::IniFile ini_file;
+	ini_file.LoadFromString(misc::fmt(config_format,
+			scheduling_policy.c_str()));
+	Timing::ParseConfiguration(&ini_file);
+	Timing::getInstance();
+
+	// Memory hierarchy
+	misc::IniFile ini_file_mem;
+	ini_file_mem.LoadFromString(mem_config);
+	mem::System::getInstance()->ReadConfiguration(&ini_file_mem);
+}
+
+// Return the ISA section of a kernel made of the given instructions,
+// inserting scheduling control words every 64 bytes
+static std::string getKernel(const std::vector<unsigned long long> &insts)
+{
+	std::vector<unsigned long long> words;
+	for (unsigned long long inst : insts)
+	{
+		if (words.size() % 8 == 0)
+			words.push_back(inst_control);
+		words.push_back(inst);
+	}
+	std::string text(words.size() * sizeof(unsigned long long), '\0');
+	memcpy(&text[0], words.data(), text.size());
+	return text;
+}
+
+// Run one cycle of the timing simulator and the memory hierarchy
+static void RunCycle()
+{
+	int num_active_emulators;
+	int num_active_timing_simulators;
+	comm::ArchPool::getInstance()->Run(num_active_emulators,
+			num_active_timing_simulators);
+	esim::Engine::getInstance()->ProcessEvents();
+}
+
+// Run a grid with one thread-block of the given size to completion, and
+// return the number of cycles it took
+static long long RunGrid(const std::string &text, unsigned thread_block_size)
+{
+	Grid grid("kernel", text.data(), text.size());
+	unsigned thread_block_count3[3] = { 1, 1, 1 };
+	unsigned thread_block_size3[3] = { thread_block_size, 1, 1 };
+	grid.SetupSize(thread_block_count3, thread_block_size3);
+	Emulator::getInstance()->PushPendingGrid(&grid);
+
+	Timing *timing = Timing::getInstance();
+	long long start = timing->getCycle();
+	while (!grid.isFinished() && timing->getCycle() - start < 100000)
+		RunCycle();
+	EXPECT_TRUE(grid.isFinished());
+
+	// Let the GPU release the grid
+	RunCycle();
+	return timing->getCycle() - start;
+}
+
+
+// Three warps with one-cycle instructions. A greedy-then-oldest scheduler
+// alternates between the two oldest warps, which are always ready again
+// when the other one stalls, and leaves the youngest waiting. A loose
+// round-robin scheduler gives each warp a turn.
+static void RunSchedulingPolicy(const std::string &scheduling_policy,
+		std::vector<unsigned> &pcs)
+{
+	Initialize(scheduling_policy);
+
+	// Kernel
+	std::vector<unsigned long long> insts(20, inst_iadd);
+	insts.push_back(inst_exit);
+	std::string text = getKernel(insts);
+
+	// Run until the first warp finishes
+	Grid grid("kernel", text.data(), text.size());
+	unsigned thread_block_count3[3] = { 1, 1, 1 };
+	unsigned thread_block_size3[3] = { 3 * Emulator::warp_size, 1, 1 };
+	grid.SetupSize(thread_block_count3, thread_block_size3);
+	Emulator::getInstance()->PushPendingGrid(&grid);
+	Timing *timing = Timing::getInstance();
+	bool finished = false;
+	while (!finished && timing->getCycle() < 100000)
+	{
+		RunCycle();
+		for (auto it = grid.getRunningThreadBlocksBegin(),
+				e = grid.getRunningThreadBlocksEnd(); it != e; ++it)
+			for (auto warp = (*it)->WarpsBegin(),
+					warp_end = (*it)->WarpsEnd();
+					warp != warp_end; ++warp)
+				if ((*warp)->getFinishedEmu())
+					finished = true;
+	}
+	ASSERT_TRUE(finished);
+
+	// Program counters of the warps
+	ASSERT_EQ(grid.getRunningThreadBlocksize(), 1u);
+	ThreadBlock *thread_block = grid.getRunningThreadBlocksBegin()->get();
+	for (auto warp = thread_block->WarpsBegin(),
+			warp_end = thread_block->WarpsEnd();
+			warp != warp_end; ++warp)
+		pcs.push_back((*warp)->getPC());
+
+	// Finish the grid
+	while (!grid.isFinished() && timing->getCycle() < 100000)
+		RunCycle();
+	EXPECT_TRUE(grid.isFinished());
+	RunCycle();
+}
+
+
+TEST(TestSM, warp_scheduler_gto)
+{
+	std::vector<unsigned> pcs;
+	RunSchedulingPolicy("GTO", pcs);
+	ASSERT_EQ(pcs.size(), 3u);
+
+	// The youngest warp did not issue while the others ran
+	EXPECT_GE(pcs[0], 8u * 20);
+	EXPECT_GE(pcs[1], 8u * 20);
+	EXPECT_LE(pcs[2], 8u);
+}
+
+
+TEST(TestSM, warp_scheduler_lrr)
+{
+	std::vector<unsigned> pcs;
+	RunSchedulingPolicy("LRR", pcs);
+	ASSERT_EQ(pcs.size(), 3u);
+
+	// All warps advanced at the same pace
+	EXPECT_GE(pcs[1], 8u * 20);
+	EXPECT_GE(pcs[2], 8u * 20);
+}
+
+
+// Loads of a warp coalesced into one cache block. The first load misses in
+// the L1 cache and waits for main memory, while a second load to the same
+// block hits.
+TEST(TestSM, ldst_unit_hit_miss_latency)
+{
+	// Kernel computing the address of each thread without loads, with
+	// one load, and with two loads of the same address
+	std::vector<unsigned long long> insts = {
+		inst_s2r_r0_tid,
+		inst_iscadd_r4
+	};
+	std::vector<unsigned long long> insts_0 = insts;
+	insts_0.push_back(inst_exit);
+	std::vector<unsigned long long> insts_1 = insts;
+	insts_1.push_back(inst_ld_r0);
+	insts_1.push_back(inst_exit);
+	std::vector<unsigned long long> insts_2 = insts;
+	insts_2.push_back(inst_ld_r0);
+	insts_2.push_back(inst_ld_r3);
+	insts_2.push_back(inst_exit);
+
+	// Block-aligned argument
+	unsigned address = 0x10000;
+
+	// Run each kernel on a cold cache
+	long long cycles[3];
+	long long cache_accesses[3];
+	std::vector<unsigned long long> *kernels[3] = {
+		&insts_0,
+		&insts_1,
+		&insts_2
+	};
+	for (int i = 0; i < 3; i++)
+	{
+		Initialize("GTO");
+		Emulator::getInstance()->WriteConstantMemory(argument_address,
+				sizeof address, (const char *) &address);
+		cycles[i] = RunGrid(getKernel(*kernels[i]),
+				Emulator::warp_size);
+		cache_accesses[i] = Timing::getInstance()->getGpu()->
+				getSM(0)->num_cache_accesses;
+	}
+
+	// One cache access per load
+	EXPECT_EQ(cache_accesses[0], 0);
+	EXPECT_EQ(cache_accesses[1], 1);
+	EXPECT_EQ(cache_accesses[2], 2);
+
+	// The miss pays the main memory latency, the hit does not
+	long long miss_latency = cycles[1] - cycles[0];
+	long long hit_latency = cycles[2] - cycles[1];
+	EXPECT_GE(miss_latency, 100);
+	EXPECT_GT(hit_latency, 0);
+	EXPECT_LT(hit_latency, 20);
+}
+
+
+} // namespace Kepler
@@ -0,0 +1,162 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <gtest/gtest.h>
+
+#include <arch/kepler/emulator/Emulator.h>
+#include <arch/kepler/emulator/Grid.h>
+#include <arch/kepler/emulator/Thread.h>
+#include <arch/kepler/emulator/Warp.h>
+#include <arch/kepler/timing/Timing.h>
+#include <lib/cpp/IniFile.h>
+#include <lib/esim/Engine.h>
+
+namespace Kepler
+{
+
+// Kernel made of a scheduling control word and an EXIT instruction
+static const unsigned long long exit_kernel[] =
+{
+	0x0800000000000000ull,	// Control word
+	0x18000000001c003cull	// EXIT
+};
+
+static void Cleanup()
+{
+	esim::Engine::Destroy();
+	Timing::Destroy();
+	Emulator::Destroy();
+	comm::ArchPool::Destroy();
+}
+
+
+// This test checks that the number of streaming multiprocessors and their
+// residency limits given in the configuration file are the ones used both
+// by the emulator and by the timing model
+TEST(TestTiming, config_section_sm_residency)
+{
+	// Cleanup singleton instances
+	Cleanup();
+
+	// Create config file
+	std::string config =
+			"[ Device ]\n"
+			"NumSMs = 2\n"
+			"[ SM ]\n"
+			"MaxThreadBlocks = 4\n"
+			"MaxWarps = 8";
+
+	// Load config file
+	misc::IniFile ini_file;
+	ini_file.LoadFromString(config);
+	Timing::ParseConfiguration(&ini_file);
+	EXPECT_EQ(Emulator::getNumSms(), 2);
+	EXPECT_EQ(Emulator::getMaxThreadBlocksPerSm(), 4);
+	EXPECT_EQ(Emulator::getMaxWarpsPerSm(), 8);
+
+	// Thread-blocks of 2 warps are limited by the number of thread-blocks
+	Emulator *emulator = Emulator::getInstance();
+	Grid grid("exit", (const char *) exit_kernel, sizeof exit_kernel);
+	unsigned thread_block_count[3] = { 16, 1, 1 };
+	unsigned thread_block_size[3] = { 64, 1, 1 };
+	grid.SetupSize(thread_block_count, thread_block_size);
+	EXPECT_EQ(emulator->getMaxResidentThreadBlocks(&grid), 8u);
+
+	// Thread-blocks of 3 warps are limited by the number of warps
+	thread_block_size[0] = 96;
+	grid.SetupSize(thread_block_count, thread_block_size);
+	EXPECT_EQ(emulator->getMaxResidentThreadBlocks(&grid), 4u);
+
+	// The timing model has one streaming multiprocessor per entry
+	Gpu *gpu = Timing::getInstance()->getGpu();
+	EXPECT_EQ(gpu->getSMsEnd() - gpu->getSMsBegin(), 2);
+}
+
+
+// This test checks to see if the correct error message is returned when
+// the number of streaming multiprocessors is not positive
+TEST(TestTiming, config_section_device_num_sms)
+{
+	// Cleanup singleton instances
+	Cleanup();
+
+	// Create config file
+	std::string config =
+			"[ Device ]\n"
+			"NumSMs = 0";
+
+	// Load config file
+	misc::IniFile ini_file;
+	ini_file.LoadFromString(config);
+
+	// Try ParseConfiguration for invalid number of SMs
+	std::string message;
+	try
+	{
+		Timing::ParseConfiguration(&ini_file);
+	}
+	catch (misc::Error &error)
+	{
+		message = error.getMessage();
+	}
+
+	// Check error message
+	EXPECT_REGEX_MATCH(misc::fmt(".*%s: section \\[Device\\]: invalid "
+			"value for 'NumSMs' \\(0\\).*",
+			ini_file.getPath().c_str()).c_str(),
+			message.c_str());
+}
+
+
+// This test checks to see if the correct error message is returned when
+// the maximum number of resident warps is not positive
+TEST(TestTiming, config_section_sm_max_warps)
+{
+	// Cleanup singleton instances
+	Cleanup();
+
+	// Create config file
+	std::string config =
+			"[ SM ]\n"
+			"MaxWarps = -1";
+
+	// Load config file
+	misc::IniFile ini_file;
+	ini_file.LoadFromString(config);
+
+	// Try ParseConfiguration for invalid number of warps
+	std::string message;
+	try
+	{
+		Timing::ParseConfiguration(&ini_file);
+	}
+	catch (misc::Error &error)
+	{
+		message = error.getMessage();
+	}
+
+	// Check error message
+	EXPECT_REGEX_MATCH(misc::fmt(".*%s: section \\[SM\\]: invalid "
+			"value for 'MaxWarps' \\(-1\\).*",
+			ini_file.getPath().c_str()).c_str(),
+			message.c_str());
+}
+
+
+} // namespace Kepler
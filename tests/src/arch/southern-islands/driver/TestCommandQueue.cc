@@ -0,0 +1,371 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "gtest/gtest.h"
+
+#include <arch/southern-islands/driver/CommandQueue.h>
+#include <arch/southern-islands/driver/Driver.h>
+#include <arch/southern-islands/emulator/Emulator.h>
+#include <arch/southern-islands/emulator/NDRange.h>
+#include <arch/southern-islands/emulator/WorkGroup.h>
+#include <arch/x86/emulator/Context.h>
+#include <arch/x86/emulator/Emulator.h>
+#include <arch/x86/timing/Timing.h>
+#include <memory/Manager.h>
+
+
+namespace SI
+{
+
+// ABI call codes, as listed in Driver.def
+static const int CallCodeMemAlloc = 2;
+static const int CallCodeCommandQueueCreate = 25;
+static const int CallCodeCommandQueueWait = 26;
+static const int CallCodeCommandQueueFree = 27;
+
+// Number of packets in the ring
+static const unsigned num_packets = 4;
+
+
+// Guest program using a command queue
+class Guest
+{
+	// Memory allocator
+	std::unique_ptr<mem::Manager> manager;
+
+public:
+
+	// x86 context
+	x86::Context *context;
+
+	// Memory of the context
+	mem::Memory *memory;
+
+	// Ring address
+	unsigned ring_ptr;
+
+	// Buffer for ABI call arguments
+	unsigned args_ptr;
+
+	// Completion words, one per packet index
+	unsigned completion_ptr;
+
+	// Command queue identifier
+	int id;
+
+	// Create an x86 context and a command queue in its memory
+	Guest();
+
+	// Invoke an ABI call with two arguments
+	int Call(int code, unsigned arg0, unsigned arg1 = 0);
+
+	// Allocate guest memory
+	unsigned Allocate(unsigned size)
+	{
+		return manager->Allocate(size, 16);
+	}
+
+	// Append a packet to the ring, returning its index
+	unsigned AddPacket(unsigned type, unsigned flags, unsigned arg0,
+			unsigned arg1 = 0, unsigned arg2 = 0);
+
+	// Return whether the completion word of a packet is set
+	bool isCompleted(unsigned index);
+};
+
+
+Guest::Guest()
+{
+	// Context
+	x86::Timing::setSimKind(comm::Arch::SimFunctional);
+	x86::Emulator *emulator = x86::Emulator::getInstance();
+	context = emulator->newContext();
+	context->Initialize();
+	context->setState(x86::Context::StateRunning);
+	memory = context->getMemory();
+	memory->setHeapBreak(misc::RoundUp(memory->getHeapBreak(),
+			mem::Memory::PageSize));
+	manager = misc::new_unique<mem::Manager>(memory);
+
+	// Ring, arguments, and completion words
+	unsigned ring_size = sizeof(CommandQueue::Header) +
+			num_packets * sizeof(CommandQueue::Packet);
+	ring_ptr = Allocate(ring_size);
+	memory->Zero(ring_ptr, ring_size);
+	args_ptr = Allocate(8);
+	completion_ptr = Allocate(16 * 4);
+	memory->Zero(completion_ptr, 16 * 4);
+
+	// Command queue
+	id = Call(CallCodeCommandQueueCreate, ring_ptr, num_packets);
+}
+
+
+int Guest::Call(int code, unsigned arg0, unsigned arg1)
+{
+	memory->Write(args_ptr, 4, (char *) &arg0);
+	memory->Write(args_ptr + 4, 4, (char *) &arg1);
+	return Driver::getInstance()->Call(context, memory, code, args_ptr);
+}
+
+
+unsigned Guest::AddPacket(unsigned type, unsigned flags, unsigned arg0,
+		unsigned arg1, unsigned arg2)
+{
+	// Write packet
+	CommandQueue::Header header;
+	memory->Read(ring_ptr, sizeof header, (char *) &header);
+	unsigned index = header.write_index;
+	CommandQueue::Packet packet = {};
+	packet.type = type;
+	packet.flags = flags;
+	packet.args[0] = arg0;
+	packet.args[1] = arg1;
+	packet.args[2] = arg2;
+	packet.completion_ptr = completion_ptr + index * 4;
+	memory->Write(ring_ptr + sizeof header + (index % num_packets) *
+			sizeof packet, sizeof packet, (char *) &packet);
+
+	// Publish it
+	header.write_index++;
+	memory->Write(ring_ptr, 4, (char *) &header.write_index);
+	return index;
+}
+
+
+bool Guest::isCompleted(unsigned index)
+{
+	unsigned value;
+	memory->Read(completion_ptr + index * 4, 4, (char *) &value);
+	return value;
+}
+
+
+// Create an ND-Range with the given number of work groups, as done by ABI
+// call 'NDRangeCreate'
+static NDRange *CreateNDRange(unsigned num_work_groups)
+{
+	NDRange *ndrange = Emulator::getInstance()->addNDRange();
+	unsigned local_size = WorkGroup::WavefrontSize;
+	unsigned global_size = num_work_groups * local_size;
+	ndrange->SetupSize(&global_size, &local_size, 1);
+	return ndrange;
+}
+
+
+// Complete all work groups of an ND-Range without running them
+static void FinishNDRange(NDRange *ndrange)
+{
+	while (!ndrange->isWaitingWorkGroupsEmpty())
+		ndrange->GetWaitingWorkGroup();
+}
+
+
+// Start every test with a fresh emulator and driver
+static void Reset()
+{
+	Driver::Destroy();
+	Emulator::Destroy();
+	x86::Emulator::Destroy();
+}
+
+
+TEST(TestCommandQueue, memory_transfers)
+{
+	Reset();
+	Guest guest;
+	Emulator *emulator = Emulator::getInstance();
+
+	// Device buffer and host buffers
+	unsigned size = 3 * mem::Memory::PageSize;
+	unsigned device_ptr = guest.Call(CallCodeMemAlloc, 2 * size);
+	unsigned src_ptr = guest.Allocate(size);
+	unsigned dest_ptr = guest.Allocate(size);
+	std::vector<char> data(size);
+	for (unsigned i = 0; i < size; i++)
+		data[i] = i * 3;
+	guest.memory->Write(src_ptr, size, data.data());
+
+	// Host to device, device to device, device to host
+	unsigned index_0 = guest.AddPacket(CommandQueue::PacketMemWrite,
+			CommandQueue::FlagBarrier, device_ptr, src_ptr, size);
+	unsigned index_1 = guest.AddPacket(CommandQueue::PacketMemCopy,
+			CommandQueue::FlagBarrier, device_ptr + size,
+			device_ptr, size);
+	unsigned index_2 = guest.AddPacket(CommandQueue::PacketMemRead,
+			CommandQueue::FlagBarrier, dest_ptr, device_ptr + size,
+			size);
+	EXPECT_FALSE(emulator->ProcessCommandQueues());
+	EXPECT_TRUE(guest.isCompleted(index_0));
+	EXPECT_TRUE(guest.isCompleted(index_1));
+	EXPECT_TRUE(guest.isCompleted(index_2));
+	std::vector<char> result(size);
+	guest.memory->Read(dest_ptr, size, result.data());
+	EXPECT_EQ(data, result);
+
+	// Read index published
+	CommandQueue::Header header;
+	guest.memory->Read(guest.ring_ptr, sizeof header, (char *) &header);
+	EXPECT_EQ(3u, header.read_index);
+
+	// Ring wraps around
+	for (int i = 0; i < 6; i++)
+	{
+		unsigned index = guest.AddPacket(CommandQueue::PacketMemWrite,
+				CommandQueue::FlagBarrier, device_ptr,
+				src_ptr, 16);
+		emulator->ProcessCommandQueues();
+		EXPECT_TRUE(guest.isCompleted(index));
+	}
+
+	// Free queue
+	EXPECT_EQ(0, guest.Call(CallCodeCommandQueueFree, guest.id));
+	EXPECT_FALSE(Driver::getInstance()->getCommandQueueById(guest.id));
+	Reset();
+}
+
+
+TEST(TestCommandQueue, ndranges_in_flight)
+{
+	Reset();
+	Guest guest;
+	Emulator *emulator = Emulator::getInstance();
+	unsigned device_ptr = guest.Call(CallCodeMemAlloc, 64);
+	unsigned host_ptr = guest.Allocate(64);
+
+	// Two concurrent launches, and a barrier behind them
+	NDRange *ndrange_0 = CreateNDRange(2);
+	NDRange *ndrange_1 = CreateNDRange(3);
+	unsigned index_0 = guest.AddPacket(CommandQueue::PacketNDRangeLaunch,
+			0, ndrange_0->getId());
+	unsigned index_1 = guest.AddPacket(CommandQueue::PacketNDRangeLaunch,
+			0, ndrange_1->getId());
+	unsigned index_2 = guest.AddPacket(CommandQueue::PacketMemWrite,
+			CommandQueue::FlagBarrier, device_ptr, host_ptr, 64);
+	EXPECT_TRUE(emulator->ProcessCommandQueues());
+	EXPECT_EQ(2, emulator->getNumNDRangesRunning());
+	EXPECT_EQ(2u, ndrange_0->getNumWaitingWorkgroups());
+	EXPECT_EQ(3u, ndrange_1->getNumWaitingWorkgroups());
+	EXPECT_FALSE(guest.isCompleted(index_0));
+	EXPECT_FALSE(guest.isCompleted(index_2));
+
+	// Launches retire out of order. The barrier waits for both.
+	FinishNDRange(ndrange_1);
+	EXPECT_TRUE(emulator->ProcessCommandQueues());
+	EXPECT_TRUE(guest.isCompleted(index_1));
+	EXPECT_FALSE(guest.isCompleted(index_0));
+	EXPECT_FALSE(guest.isCompleted(index_2));
+	EXPECT_EQ(1, emulator->getNumNDRangesRunning());
+	FinishNDRange(ndrange_0);
+	EXPECT_FALSE(emulator->ProcessCommandQueues());
+	EXPECT_TRUE(guest.isCompleted(index_0));
+	EXPECT_TRUE(guest.isCompleted(index_2));
+	EXPECT_EQ(0, emulator->getNumNDRangesRunning());
+	EXPECT_EQ(0, emulator->getNumNDRanges());
+	Reset();
+}
+
+
+TEST(TestCommandQueue, wait)
+{
+	Reset();
+	Guest guest;
+	Emulator *emulator = Emulator::getInstance();
+
+	// Waiting on a launch suspends the context
+	NDRange *ndrange = CreateNDRange(1);
+	unsigned index = guest.AddPacket(CommandQueue::PacketNDRangeLaunch,
+			0, ndrange->getId());
+	guest.Call(CallCodeCommandQueueWait, guest.id, index);
+	EXPECT_TRUE(guest.context->isSuspended());
+	EXPECT_TRUE(emulator->ProcessCommandQueues());
+	EXPECT_TRUE(guest.context->isSuspended());
+
+	// Context resumed when the launch retires
+	FinishNDRange(ndrange);
+	emulator->ProcessCommandQueues();
+	EXPECT_FALSE(guest.context->isSuspended());
+
+	// Waiting on a completed packet returns right away
+	guest.Call(CallCodeCommandQueueWait, guest.id, index);
+	EXPECT_FALSE(guest.context->isSuspended());
+
+	// Waiting on a packet not written yet
+	EXPECT_THROW(guest.Call(CallCodeCommandQueueWait, guest.id,
+			index + 1), Driver::Error);
+	Reset();
+}
+
+
+TEST(TestCommandQueue, destroyed_waiter)
+{
+	Reset();
+	Guest guest;
+	Emulator *emulator = Emulator::getInstance();
+
+	// Keep the guest memory alive, but destroy the waiting context
+	std::shared_ptr<mem::Memory> memory =
+			guest.memory->shared_from_this();
+	NDRange *ndrange = CreateNDRange(1);
+	unsigned index = guest.AddPacket(CommandQueue::PacketNDRangeLaunch,
+			0, ndrange->getId());
+	guest.Call(CallCodeCommandQueueWait, guest.id, index);
+	x86::Emulator::Destroy();
+
+	// Retiring the launch does not touch the context
+	FinishNDRange(ndrange);
+	EXPECT_FALSE(emulator->ProcessCommandQueues());
+	EXPECT_TRUE(guest.isCompleted(index));
+	Reset();
+}
+
+
+TEST(TestCommandQueue, orphan)
+{
+	Reset();
+	Guest guest;
+	Emulator *emulator = Emulator::getInstance();
+
+	// Launch an ND-Range, and let a work group run
+	NDRange *ndrange = CreateNDRange(4);
+	guest.AddPacket(CommandQueue::PacketNDRangeLaunch, 0,
+			ndrange->getId());
+	EXPECT_TRUE(emulator->ProcessCommandQueues());
+	EXPECT_EQ(1, emulator->getNumNDRangesRunning());
+	WorkGroup *work_group = ndrange->ScheduleWorkGroup(
+			ndrange->GetWaitingWorkGroup());
+
+	// Guest program exits. Work groups not scheduled yet are discarded,
+	// but the queue stays until the running one finishes.
+	x86::Emulator::Destroy();
+	EXPECT_TRUE(emulator->ProcessCommandQueues());
+	EXPECT_TRUE(Driver::getInstance()->getCommandQueueById(guest.id));
+	EXPECT_TRUE(ndrange->isWaitingWorkGroupsEmpty());
+	EXPECT_EQ(1, emulator->getNumNDRangesRunning());
+
+	// The ND-Range is retired and the queue freed
+	ndrange->RemoveWorkGroup(work_group);
+	EXPECT_FALSE(emulator->ProcessCommandQueues());
+	EXPECT_FALSE(Driver::getInstance()->getCommandQueueById(guest.id));
+	EXPECT_EQ(0, emulator->getNumNDRangesRunning());
+	EXPECT_EQ(0, emulator->getNumNDRanges());
+	Reset();
+}
+
+}  // namespace SI
@@ -0,0 +1,201 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <gtest/gtest.h>
+
+#include <arch/southern-islands/emulator/Emulator.h>
+#include <arch/southern-islands/emulator/NDRange.h>
+#include <arch/southern-islands/emulator/Wavefront.h>
+#include <arch/southern-islands/emulator/WorkGroup.h>
+#include <arch/southern-islands/timing/ComputeUnit.h>
+#include <arch/southern-islands/timing/FetchBuffer.h>
+#include <arch/southern-islands/timing/Timing.h>
+#include <arch/southern-islands/timing/WavefrontPool.h>
+#include <arch/southern-islands/timing/WavefrontScheduler.h>
+#include <lib/cpp/Misc.h>
+#include <lib/esim/Engine.h>
+
+namespace SI
+{
+
+static void Cleanup()
+{
+	esim::Engine::Destroy();
+	Timing::Destroy();
+	Emulator::Destroy();
+	comm::ArchPool::Destroy();
+}
+
+
+// Uops of three wavefronts of a work-group, stored in the fetch buffer of
+// the first compute unit
+class FetchBufferTest
+{
+	// ND-Range
+	NDRange ndrange;
+
+	// Work-group with three wavefronts
+	std::unique_ptr<WorkGroup> work_group;
+
+	// Wavefront pool and entry the uops are fetched from
+	std::unique_ptr<WavefrontPool> wavefront_pool;
+	std::unique_ptr<WavefrontPoolEntry> wavefront_pool_entry;
+
+public:
+
+	/// Compute unit
+	ComputeUnit *compute_unit;
+
+	/// Fetch buffer
+	std::unique_ptr<FetchBuffer> fetch_buffer;
+
+	/// Constructor
+	FetchBufferTest()
+	{
+		unsigned global_size[1] = { 3 * WorkGroup::WavefrontSize };
+		unsigned local_size[1] = { 3 * WorkGroup::WavefrontSize };
+		ndrange.SetupSize(global_size, local_size, 1);
+		work_group = misc::new_unique<WorkGroup>(&ndrange, 0);
+
+		compute_unit = Timing::getInstance()->getGpu()->
+				getComputeUnit(0);
+		wavefront_pool = misc::new_unique<WavefrontPool>(0,
+				compute_unit);
+		wavefront_pool_entry = misc::new_unique<WavefrontPoolEntry>(0,
+				wavefront_pool.get());
+		fetch_buffer = misc::new_unique<FetchBuffer>(0, compute_unit);
+	}
+
+	/// Add a uop of the given wavefront to an issue queue, ready for
+	/// issue in the given cycle, and return it
+	Uop *AddUop(FetchBuffer::QueueType queue_type, int wavefront_id,
+			long long fetch_ready)
+	{
+		Wavefront *wavefront = work_group->getWavefront(wavefront_id);
+		auto uop = misc::new_unique<Uop>(wavefront,
+				wavefront_pool_entry.get(), 0,
+				work_group.get(), 0);
+		uop->fetch_ready = fetch_ready;
+		Uop *uop_ptr = uop.get();
+		fetch_buffer->addUop(queue_type, std::move(uop));
+		return uop_ptr;
+	}
+};
+
+
+// Uops are stored in the issue queue of their execution unit, each queue
+// ordered by wavefront age and keeping the fetch order of each wavefront
+TEST(TestFetchBuffer, issue_queue_order)
+{
+	// Cleanup singleton instances
+	Cleanup();
+
+	// Add uops out of age order
+	FetchBufferTest test;
+	Uop *scalar_2 = test.AddUop(FetchBuffer::QueueScalar, 2, 0);
+	Uop *simd_0 = test.AddUop(FetchBuffer::QueueSimd, 0, 0);
+	Uop *scalar_1a = test.AddUop(FetchBuffer::QueueScalar, 1, 0);
+	Uop *scalar_0 = test.AddUop(FetchBuffer::QueueScalar, 0, 0);
+	Uop *scalar_1b = test.AddUop(FetchBuffer::QueueScalar, 1, 0);
+	EXPECT_EQ(test.fetch_buffer->getSize(), 5);
+
+	// Scalar queue
+	FetchBuffer::Queue &scalar_queue = test.fetch_buffer->getQueue(
+			FetchBuffer::QueueScalar);
+	ASSERT_EQ(scalar_queue.size(), 4u);
+	EXPECT_EQ(scalar_queue[0].get(), scalar_0);
+	EXPECT_EQ(scalar_queue[1].get(), scalar_1a);
+	EXPECT_EQ(scalar_queue[2].get(), scalar_1b);
+	EXPECT_EQ(scalar_queue[3].get(), scalar_2);
+
+	// SIMD queue
+	FetchBuffer::Queue &simd_queue = test.fetch_buffer->getQueue(
+			FetchBuffer::QueueSimd);
+	ASSERT_EQ(simd_queue.size(), 1u);
+	EXPECT_EQ(simd_queue[0].get(), simd_0);
+
+	// Other queues are empty
+	EXPECT_TRUE(test.fetch_buffer->getQueue(
+			FetchBuffer::QueueBranch).empty());
+	EXPECT_TRUE(test.fetch_buffer->getQueue(
+			FetchBuffer::QueueVectorMemory).empty());
+	EXPECT_TRUE(test.fetch_buffer->getQueue(
+			FetchBuffer::QueueLds).empty());
+	EXPECT_TRUE(test.fetch_buffer->getQueue(
+			FetchBuffer::QueueOther).empty());
+
+	// Remove a uop
+	std::unique_ptr<Uop> uop = test.fetch_buffer->Remove(
+			FetchBuffer::QueueScalar, scalar_queue.begin() + 1);
+	EXPECT_EQ(uop.get(), scalar_1a);
+	EXPECT_EQ(test.fetch_buffer->getSize(), 4);
+	ASSERT_EQ(scalar_queue.size(), 3u);
+	EXPECT_EQ(scalar_queue[1].get(), scalar_1b);
+}
+
+
+// The oldest-first scheduler selects the oldest ready uop of the given issue
+// queue, regardless of the uops in other queues
+TEST(TestFetchBuffer, select_oldest_ready)
+{
+	// Cleanup singleton instances
+	Cleanup();
+
+	// Uops of the oldest wavefront are not fetched until cycle 10
+	FetchBufferTest test;
+	Uop *scalar_0 = test.AddUop(FetchBuffer::QueueScalar, 0, 10);
+	Uop *scalar_1 = test.AddUop(FetchBuffer::QueueScalar, 1, 0);
+	Uop *simd_0 = test.AddUop(FetchBuffer::QueueSimd, 0, 0);
+	Uop *simd_2 = test.AddUop(FetchBuffer::QueueSimd, 2, 0);
+
+	// Scheduler
+	WavefrontScheduler::policy = WavefrontScheduler::PolicyOldest;
+	std::unique_ptr<WavefrontScheduler> scheduler =
+			WavefrontScheduler::Create(test.compute_unit);
+	FetchBuffer *fetch_buffer = test.fetch_buffer.get();
+
+	// Scalar queue, before and after the oldest uop is fetched
+	auto it = scheduler->Select(fetch_buffer, FetchBuffer::QueueScalar, 5);
+	ASSERT_TRUE(it != fetch_buffer->getQueue(
+			FetchBuffer::QueueScalar).end());
+	EXPECT_EQ(it->get(), scalar_1);
+	it = scheduler->Select(fetch_buffer, FetchBuffer::QueueScalar, 10);
+	ASSERT_TRUE(it != fetch_buffer->getQueue(
+			FetchBuffer::QueueScalar).end());
+	EXPECT_EQ(it->get(), scalar_0);
+
+	// SIMD queue
+	it = scheduler->Select(fetch_buffer, FetchBuffer::QueueSimd, 5);
+	ASSERT_TRUE(it != fetch_buffer->getQueue(
+			FetchBuffer::QueueSimd).end());
+	EXPECT_EQ(it->get(), simd_0);
+	fetch_buffer->Remove(FetchBuffer::QueueSimd, it);
+	it = scheduler->Select(fetch_buffer, FetchBuffer::QueueSimd, 5);
+	ASSERT_TRUE(it != fetch_buffer->getQueue(
+			FetchBuffer::QueueSimd).end());
+	EXPECT_EQ(it->get(), simd_2);
+
+	// Empty queue
+	it = scheduler->Select(fetch_buffer, FetchBuffer::QueueLds, 5);
+	EXPECT_TRUE(it == fetch_buffer->getQueue(
+			FetchBuffer::QueueLds).end());
+}
+
+
+} // namespace SI
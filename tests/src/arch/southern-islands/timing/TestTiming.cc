@@ -19,9 +19,15 @@
 
 #include <gtest/gtest.h>
 
+#include <vector>
+
+#include <arch/southern-islands/emulator/Emulator.h>
+#include <arch/southern-islands/emulator/NDRange.h>
 #include <arch/southern-islands/timing/Timing.h>
 #include <lib/cpp/IniFile.h>
 #include <lib/esim/Engine.h>
+#include <memory/System.h>
+#include <network/System.h>
 
 namespace SI 
 {
@@ -29,7 +35,10 @@ namespace SI
 static void Cleanup()
 {
         esim::Engine::Destroy();
+        net::System::Destroy();
+        mem::System::Destroy();
         Timing::Destroy();
+        Emulator::Destroy();
         comm::ArchPool::Destroy();
 }
 
@@ -104,4 +113,105 @@ TEST(TestTiming, config_section_device_frequency_1)
 }
 
 
+
+// This test checks to see if the correct error message is returned when
+// the active set of the two-level issue policy is empty
+TEST(TestTiming, config_section_front_end_two_level_active_wavefronts)
+{
+	// Cleanup singleton instances
+	Cleanup();
+
+	// Create config file
+	std::string config =
+		"[ Device ]\n"
+		"Frequency = 1000\n"
+		"[ FrontEnd ]\n"
+		"IssuePolicy = TwoLevel\n"
+		"TwoLevelActiveWavefronts = 0";
+
+	// Load config file
+	misc::IniFile ini_file;
+	ini_file.LoadFromString(config);
+
+	// Try ParseConfiguration for invalid active set size
+	std::string message;
+	try
+	{
+		Timing::ParseConfiguration(&ini_file);
+	}
+	catch(misc::Error &error)
+	{
+		message = error.getMessage();
+	}
+
+	// Check error message
+	EXPECT_REGEX_MATCH(misc::fmt(".*%s: The value for "
+			"'TwoLevelActiveWavefronts' must be greater than 0.\n.*",
+			ini_file.getPath().c_str()).c_str(),
+			message.c_str());
+}
+
+
+// This test runs a work-group of four wavefronts, all mapped to the same
+// wavefront pool, through a sequence of barriers with the two-level issue
+// policy and an active set of one wavefront. Wavefronts waiting at a barrier
+// must leave the active set, so that the rest of the work-group reaches it.
+TEST(TestTiming, two_level_barrier)
+{
+	// Cleanup singleton instances
+	Cleanup();
+
+	// Create config file
+	std::string config =
+		"[ Device ]\n"
+		"Frequency = 1000\n"
+		"[ FrontEnd ]\n"
+		"IssuePolicy = TwoLevel\n"
+		"TwoLevelActiveWavefronts = 1";
+
+	// Load config file
+	misc::IniFile ini_file;
+	ini_file.LoadFromString(config);
+	Timing::ParseConfiguration(&ini_file);
+
+	// Timing simulator and default memory hierarchy
+	Timing *timing = Timing::getInstance();
+	mem::System::getInstance()->ReadConfiguration();
+
+	// Kernel with eight barriers
+	std::vector<unsigned> kernel(8, 0xbf8a0000);	// s_barrier
+	kernel.push_back(0xbf810000);			// s_endpgm
+
+	// ND-Range with one work-group of four wavefronts
+	Emulator *emulator = Emulator::getInstance();
+	NDRange *ndrange = emulator->addNDRange();
+	ndrange->SetupInstructionMemory((const char *) kernel.data(),
+			kernel.size() * sizeof(unsigned), 0);
+	unsigned global_size[1] = { 4 * WorkGroup::WavefrontSize };
+	unsigned local_size[1] = { 4 * WorkGroup::WavefrontSize };
+	ndrange->SetupSize(global_size, local_size, 1);
+	Gpu *gpu = timing->getGpu();
+	gpu->MapNDRange(ndrange);
+	ndrange->address_space = gpu->getMmu()->newSpace("Southern Islands");
+	ndrange->AddWorkgroupIdToWaitingList(0);
+	ndrange->setLastWorkgroupSent(true);
+
+	// Run until the work-group finishes
+	comm::ArchPool *arch_pool = comm::ArchPool::getInstance();
+	esim::Engine *esim_engine = esim::Engine::getInstance();
+	int num_active_emulators;
+	int num_active_timing_simulators;
+	while (timing->getCycle() < 100000 &&
+			!(ndrange->isWaitingWorkGroupsEmpty() &&
+			ndrange->isRunningWorkGroupsEmpty()))
+	{
+		arch_pool->Run(num_active_emulators,
+				num_active_timing_simulators);
+		esim_engine->ProcessEvents();
+	}
+	EXPECT_TRUE(ndrange->isWaitingWorkGroupsEmpty());
+	EXPECT_TRUE(ndrange->isRunningWorkGroupsEmpty());
+}
+
+
 } // namespace SI
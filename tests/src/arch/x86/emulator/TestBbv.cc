@@ -0,0 +1,70 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "gtest/gtest.h"
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <unistd.h>
+
+#include <arch/x86/emulator/Bbv.h>
+
+
+namespace x86
+{
+
+TEST(TestBbv, intervals)
+{
+	// Temporary output file
+	char path[] = "/tmp/m2s-test-XXXXXX";
+	close(mkstemp(path));
+
+	// Intervals of 10 instructions, closed at basic block boundaries
+	{
+		Bbv bbv(path, 10);
+		bbv.Record(0x1000, 4);
+		bbv.Record(0x2000, 4);
+		bbv.Record(0x1000, 4);
+		EXPECT_EQ(1, bbv.getNumIntervals());
+		bbv.Record(0x3000, 3);
+		bbv.Record(0x2000, 2);
+		EXPECT_EQ(1, bbv.getNumIntervals());
+		EXPECT_EQ(3, bbv.getNumBlocks());
+	}
+
+	// The last incomplete interval is dumped by the destructor. Blocks
+	// are numbered in order of first execution.
+	std::ifstream f(path);
+	std::string line;
+	ASSERT_TRUE((bool) std::getline(f, line));
+	EXPECT_EQ("T:1:8 :2:4 ", line);
+	ASSERT_TRUE((bool) std::getline(f, line));
+	EXPECT_EQ("T:2:2 :3:3 ", line);
+	EXPECT_FALSE((bool) std::getline(f, line));
+	remove(path);
+}
+
+
+TEST(TestBbv, invalid_interval)
+{
+	EXPECT_THROW(Bbv("/tmp/m2s-test-bbv", 0), Bbv::Error);
+}
+
+}  // namespace x86
@@ -0,0 +1,175 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "gtest/gtest.h"
+
+#include <arch/x86/emulator/Context.h>
+#include <arch/x86/emulator/Emulator.h>
+#include <arch/x86/timing/Timing.h>
+#include <lib/cpp/Misc.h>
+#include <lib/esim/Engine.h>
+#include <memory/Manager.h>
+
+
+namespace x86
+{
+
+// Number of loop iterations run by each context
+static const unsigned num_iterations = 5000;
+
+// Result of a run
+struct Result
+{
+	// Value of the counter incremented without synchronization
+	unsigned counter = 0;
+
+	// Value of the counter incremented atomically
+	unsigned atomic_counter = 0;
+
+	// Number of instructions run by the emulator
+	long long num_instructions = 0;
+};
+
+
+// Write a 32-bit value into a code buffer
+static void setWord(unsigned char *code, unsigned value)
+{
+	for (int i = 0; i < 4; i++)
+		code[i] = value >> (i * 8);
+}
+
+
+// Run two contexts sharing their memory on the given number of host
+// threads. Both contexts increment a counter without synchronization and
+// another one with a 'lock' prefix in a loop, and then spin.
+static Result RunCounters(int num_threads, bool deterministic)
+{
+	// Set up emulator for functional simulation
+	Emulator::Destroy();
+	Timing::setSimKind(comm::Arch::SimFunctional);
+	esim::Engine::setNumHostThreads(num_threads);
+	Emulator::setHostQuantum(100);
+	Emulator::setDeterministic(deterministic);
+	Emulator *emulator = Emulator::getInstance();
+
+	// Parent context
+	Context *parent = emulator->newContext();
+	parent->Initialize();
+	mem::Memory *memory = parent->getMemory();
+	memory->setHeapBreak(misc::RoundUp(memory->getHeapBreak(),
+			mem::Memory::PageSize));
+	mem::Manager manager(memory);
+	unsigned data = manager.Allocate(8, 128);
+	unsigned zeros[2] = { 0, 0 };
+	memory->Write(data, sizeof zeros, (const char *) zeros);
+
+	// Code
+	//	mov ecx, num_iterations
+	// loop:
+	//	mov eax, [data]
+	//	inc eax
+	//	mov [data], eax
+	//	lock inc dword [data + 4]
+	//	dec ecx
+	//	jnz loop
+	// spin:
+	//	jmp spin
+	unsigned char code[] = {
+		0xb9, 0, 0, 0, 0,
+		0x8b, 0x05, 0, 0, 0, 0,
+		0x40,
+		0x89, 0x05, 0, 0, 0, 0,
+		0xf0, 0xff, 0x05, 0, 0, 0, 0,
+		0x49,
+		0x75, 0xe9,
+		0xeb, 0xfe
+	};
+	setWord(code + 1, num_iterations);
+	setWord(code + 7, data);
+	setWord(code + 14, data);
+	setWord(code + 21, data + 4);
+	unsigned eip = manager.Allocate(sizeof code, 128);
+	memory->Write(eip, sizeof code, (const char *) code);
+	unsigned spin_eip = eip + sizeof code - 2;
+	parent->getRegs().setEip(eip);
+	parent->setState(Context::StateRunning);
+
+	// Child context, sharing the memory of the parent
+	Context *child = emulator->newContext();
+	child->Clone(parent);
+	child->setState(Context::StateRunning);
+
+	// Run until both contexts spin
+	for (int i = 0; i < 100000; i++)
+	{
+		if (parent->getRegs().getEip() == spin_eip &&
+				child->getRegs().getEip() == spin_eip)
+			break;
+		emulator->Run();
+	}
+	EXPECT_EQ(spin_eip, parent->getRegs().getEip());
+	EXPECT_EQ(spin_eip, child->getRegs().getEip());
+
+	// Read counters
+	Result result;
+	memory->Read(data, 4, (char *) &result.counter);
+	memory->Read(data + 4, 4, (char *) &result.atomic_counter);
+	result.num_instructions = emulator->getNumInstructions();
+	return result;
+}
+
+
+TEST(TestConcurrent, atomic_instructions)
+{
+	// Atomic increments are never lost, in either mode
+	for (int num_threads = 2; num_threads <= 4; num_threads++)
+	{
+		Result result = RunCounters(num_threads, false);
+		EXPECT_EQ(2 * num_iterations, result.atomic_counter);
+		EXPECT_LE(result.counter, 2 * num_iterations);
+		result = RunCounters(num_threads, true);
+		EXPECT_EQ(2 * num_iterations, result.atomic_counter);
+	}
+	Emulator::Destroy();
+}
+
+
+TEST(TestConcurrent, deterministic)
+{
+	// The outcome of the unsynchronized increments depends on how
+	// contexts interleave. In deterministic mode, it is the same in every
+	// run and for any number of host threads.
+	Result expected = RunCounters(2, true);
+	for (int num_threads = 2; num_threads <= 4; num_threads++)
+	{
+		for (int run = 0; run < 3; run++)
+		{
+			Result result = RunCounters(num_threads, true);
+			EXPECT_EQ(expected.counter, result.counter);
+			EXPECT_EQ(expected.atomic_counter,
+					result.atomic_counter);
+			EXPECT_EQ(expected.num_instructions,
+					result.num_instructions);
+		}
+	}
+	Emulator::Destroy();
+	esim::Engine::setNumHostThreads(1);
+}
+
+}  // namespace x86
@@ -0,0 +1,170 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <cstdio>
+#include <poll.h>
+#include <unistd.h>
+
+#include <arch/x86/emulator/HostReactor.h>
+#include <lib/cpp/Error.h>
+
+
+namespace x86
+{
+
+// Contexts are only used as keys by the reactor
+static Context *const context_0 = (Context *) 0x1000;
+static Context *const context_1 = (Context *) 0x2000;
+
+
+// Wait up to 5 seconds until a context is no longer watched. Return
+// whether its watch fired.
+static bool WaitFired(HostReactor &reactor, Context *context)
+{
+	for (int i = 0; i < 5000; i++)
+	{
+		if (!reactor.isWatching(context))
+			return true;
+		usleep(1000);
+	}
+	return false;
+}
+
+
+TEST(TestHostReactor, file_descriptor)
+{
+	std::atomic<int> num_notifications(0);
+	HostReactor reactor([&]() { num_notifications++; });
+	int fds[2];
+	ASSERT_EQ(0, pipe(fds));
+
+	// Pipe not readable yet
+	EXPECT_TRUE(reactor.Add(context_0, fds[0], POLLIN, -1));
+	EXPECT_TRUE(reactor.isWatching(context_0));
+	usleep(10000);
+	EXPECT_TRUE(reactor.isWatching(context_0));
+	EXPECT_EQ(0, num_notifications);
+
+	// Watch fires once data is written
+	ASSERT_EQ(1, write(fds[1], "x", 1));
+	EXPECT_TRUE(WaitFired(reactor, context_0));
+	EXPECT_EQ(1, num_notifications);
+
+	// Pipe writable right away
+	EXPECT_TRUE(reactor.Add(context_1, fds[1], POLLOUT, -1));
+	EXPECT_TRUE(WaitFired(reactor, context_1));
+	close(fds[0]);
+	close(fds[1]);
+}
+
+
+TEST(TestHostReactor, same_file_descriptor)
+{
+	// Two contexts watching the same descriptor are both notified
+	HostReactor reactor([]() {});
+	int fds[2];
+	ASSERT_EQ(0, pipe(fds));
+	EXPECT_TRUE(reactor.Add(context_0, fds[0], POLLIN, -1));
+	EXPECT_TRUE(reactor.Add(context_1, fds[0], POLLIN, -1));
+	ASSERT_EQ(1, write(fds[1], "x", 1));
+	EXPECT_TRUE(WaitFired(reactor, context_0));
+	EXPECT_TRUE(WaitFired(reactor, context_1));
+	close(fds[0]);
+	close(fds[1]);
+}
+
+
+TEST(TestHostReactor, timeout)
+{
+	std::atomic<int> num_notifications(0);
+	HostReactor reactor([&]() { num_notifications++; });
+
+	// Timeout only
+	EXPECT_TRUE(reactor.Add(context_0, -1, 0, 20000));
+	EXPECT_TRUE(WaitFired(reactor, context_0));
+	EXPECT_GE(num_notifications, 1);
+
+	// Descriptor that never becomes ready, with a timeout
+	int fds[2];
+	ASSERT_EQ(0, pipe(fds));
+	EXPECT_TRUE(reactor.Add(context_1, fds[0], POLLIN, 20000));
+	EXPECT_TRUE(WaitFired(reactor, context_1));
+	close(fds[0]);
+	close(fds[1]);
+}
+
+
+TEST(TestHostReactor, cancel)
+{
+	std::atomic<int> num_notifications(0);
+	HostReactor reactor([&]() { num_notifications++; });
+	int fds[2];
+	ASSERT_EQ(0, pipe(fds));
+
+	// Canceled watches never fire
+	EXPECT_TRUE(reactor.Add(context_0, fds[0], POLLIN, -1));
+	EXPECT_TRUE(reactor.Add(context_1, -1, 0, 1000));
+	reactor.Cancel(context_0);
+	reactor.Cancel(context_1);
+	EXPECT_FALSE(reactor.isWatching(context_0));
+	EXPECT_FALSE(reactor.isWatching(context_1));
+	ASSERT_EQ(1, write(fds[1], "x", 1));
+	usleep(20000);
+	EXPECT_EQ(0, num_notifications);
+
+	// A new watch replaces the previous one of the same context
+	EXPECT_TRUE(reactor.Add(context_0, -1, 0, 10000000));
+	EXPECT_TRUE(reactor.Add(context_0, fds[0], POLLIN, -1));
+	EXPECT_TRUE(WaitFired(reactor, context_0));
+	close(fds[0]);
+	close(fds[1]);
+}
+
+
+TEST(TestHostReactor, regular_file)
+{
+	// Regular files never block, so no watch is added
+	HostReactor reactor([]() {});
+	FILE *f = tmpfile();
+	ASSERT_TRUE(f != nullptr);
+	EXPECT_FALSE(reactor.Add(context_0, fileno(f), POLLIN, 1000000));
+	EXPECT_FALSE(reactor.isWatching(context_0));
+	fclose(f);
+}
+
+
+TEST(TestHostReactor, invalid_file_descriptor)
+{
+	// A failed watch is reported to the caller, and leaves the reactor
+	// usable
+	HostReactor reactor([]() {});
+	int fds[2];
+	ASSERT_EQ(0, pipe(fds));
+	close(fds[0]);
+	close(fds[1]);
+	EXPECT_THROW(reactor.Add(context_0, fds[0], POLLIN, -1), misc::Panic);
+	EXPECT_FALSE(reactor.isWatching(context_0));
+	EXPECT_TRUE(reactor.Add(context_1, -1, 0, 1000));
+	EXPECT_TRUE(WaitFired(reactor, context_1));
+}
+
+}  // namespace x86
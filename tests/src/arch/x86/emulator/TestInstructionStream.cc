@@ -0,0 +1,229 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "gtest/gtest.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <arch/x86/emulator/Context.h>
+#include <arch/x86/emulator/Emulator.h>
+#include <arch/x86/emulator/InstructionStream.h>
+#include <arch/x86/emulator/Uinst.h>
+#include <arch/x86/timing/Timing.h>
+#include <lib/cpp/Misc.h>
+#include <memory/Manager.h>
+
+
+namespace x86
+{
+
+// Return a temporary file name
+static std::string getTemporaryFile()
+{
+	char path[] = "/tmp/m2s-test-XXXXXX";
+	int fd = mkstemp(path);
+	close(fd);
+	return path;
+}
+
+
+// Initialize a record
+static void setRecord(InstructionStream::Record &record, unsigned eip,
+		const char *bytes, int size, unsigned neip,
+		unsigned target_eip)
+{
+	record.pid = 100;
+	record.eip = eip;
+	record.size = size;
+	memcpy(record.bytes, bytes, size);
+	record.neip = neip;
+	record.target_eip = target_eip;
+	record.finished = false;
+	record.exit_code = 0;
+	record.uinsts.clear();
+}
+
+
+// Create a context in the emulator running the given code
+static Context *newContext(Emulator *emulator, const unsigned char *code,
+		int size)
+{
+	Context *context = emulator->newContext();
+	context->Initialize();
+	mem::Memory *memory = context->getMemory();
+	memory->setHeapBreak(misc::RoundUp(memory->getHeapBreak(),
+			mem::Memory::PageSize));
+	mem::Manager manager(memory);
+	unsigned eip = manager.Allocate(size, 128);
+	memory->Write(eip, size, (const char *) code);
+	context->getRegs().setEip(eip);
+	context->setState(Context::StateRunning);
+	return context;
+}
+
+
+TEST(TestInstructionStream, capture_and_replay)
+{
+	// Records of a loop with a load and a backward branch, run twice
+	std::string path = getTemporaryFile();
+	std::vector<InstructionStream::Record> records(4);
+	setRecord(records[0], 0x1000, "\x8b\x03", 2, 0x1002, 0);
+	auto load = misc::new_shared<Uinst>(Uinst::OpcodeLoad);
+	load->setIDep(0, Uinst::DepEbx);
+	load->setODep(0, Uinst::DepEax);
+	load->setMemoryAccess(0x8000, 4);
+	records[0].uinsts.push_back(load);
+	setRecord(records[1], 0x1002, "\x75\xfc", 2, 0x1000, 0x1000);
+	auto branch = misc::new_shared<Uinst>(Uinst::OpcodeBranch);
+	branch->setIDep(0, Uinst::DepZps);
+	records[1].uinsts.push_back(branch);
+	records[2] = records[0];
+	records[3] = records[1];
+	records[3].neip = 0x1004;
+	records[3].finished = true;
+	records[3].exit_code = -2;
+
+	// Capture
+	{
+		InstructionStream output(path, true);
+		for (auto &record : records)
+			output.Write(record);
+		EXPECT_EQ(4, output.getNumRecords());
+	}
+
+	// Replay
+	InstructionStream input(path, false);
+	InstructionStream::Record record;
+	for (auto &expected : records)
+	{
+		ASSERT_TRUE(input.Read(record));
+		EXPECT_EQ(expected.pid, record.pid);
+		EXPECT_EQ(expected.eip, record.eip);
+		ASSERT_EQ(expected.size, record.size);
+		EXPECT_EQ(0, memcmp(expected.bytes, record.bytes, record.size));
+		EXPECT_EQ(expected.neip, record.neip);
+		EXPECT_EQ(expected.target_eip, record.target_eip);
+		EXPECT_EQ(expected.finished, record.finished);
+		EXPECT_EQ(expected.exit_code, record.exit_code);
+		ASSERT_EQ(1, (int) record.uinsts.size());
+		Uinst *uinst = record.uinsts[0].get();
+		Uinst *expected_uinst = expected.uinsts[0].get();
+		EXPECT_EQ(expected_uinst->getOpcode(), uinst->getOpcode());
+		for (int i = 0; i < Uinst::MaxDeps; i++)
+			EXPECT_EQ(expected_uinst->getDep(i), uinst->getDep(i));
+		EXPECT_EQ(expected_uinst->getAddress(), uinst->getAddress());
+		EXPECT_EQ(expected_uinst->getSize(), uinst->getSize());
+	}
+	EXPECT_FALSE(input.Read(record));
+	remove(path.c_str());
+}
+
+
+TEST(TestInstructionStream, invalid_stream)
+{
+	// File that is not an instruction stream
+	std::string path = getTemporaryFile();
+	std::ofstream f(path);
+	f << "not a stream\n";
+	f.close();
+
+	// Error reading first record
+	std::string message;
+	try
+	{
+		InstructionStream input(path, false);
+		InstructionStream::Record record;
+		input.Read(record);
+	}
+	catch (InstructionStream::Error &error)
+	{
+		message = error.getMessage();
+	}
+	EXPECT_NE(std::string::npos, message.find("Not an x86 instruction "
+			"stream"));
+	remove(path.c_str());
+}
+
+
+TEST(TestInstructionStream, coupled)
+{
+	// Pipe from the emulator writing the stream to the one reading it
+	int fds[2];
+	ASSERT_EQ(0, pipe(fds));
+
+	// Code run by the writer
+	//	mov ebx, 3
+	//	mov eax, 1
+	//	int 0x80
+	unsigned char code[] = {
+		0xbb, 0x03, 0x00, 0x00, 0x00,
+		0xb8, 0x01, 0x00, 0x00, 0x00,
+		0xcd, 0x80
+	};
+
+	// The writer runs in a separate process, so that both contexts get
+	// the same identifier
+	Emulator::Destroy();
+	Timing::setSimKind(comm::Arch::SimFunctional);
+	pid_t pid = fork();
+	ASSERT_GE(pid, 0);
+	if (!pid)
+	{
+		close(fds[0]);
+		Emulator::addInstructionStreamOutput(fds[1]);
+		Emulator *emulator = Emulator::getInstance();
+		Context *context = newContext(emulator, code, sizeof code);
+		for (int i = 0; i < 10 && !context->getState(
+				Context::StateFinished); i++)
+			context->Execute();
+		emulator->CloseInstructionStreams();
+		_exit(context->getExitCode() == 3 ? 0 : 1);
+	}
+	close(fds[1]);
+
+	// Reader, with a different exit code in its copy of the program.
+	// It follows the stream and finishes with the exit code of the
+	// writer, after the same instructions.
+	Emulator::setInstructionStreamInput(fds[0]);
+	Emulator *emulator = Emulator::getInstance();
+	code[1] = 7;
+	Context *context = newContext(emulator, code, sizeof code);
+	unsigned eip = context->getRegs().getEip();
+	for (int i = 0; i < 10 && !context->getState(Context::StateFinished);
+			i++)
+		context->Execute();
+	ASSERT_TRUE(context->getState(Context::StateFinished));
+	EXPECT_EQ(3, context->getExitCode());
+	EXPECT_EQ(3, emulator->getNumInstructions());
+	EXPECT_EQ(eip + sizeof code, context->getRegs().getEip());
+	EXPECT_EQ(0u, context->getRegs().getEbx());
+	Emulator::Destroy();
+
+	// Writer finished successfully
+	int status;
+	ASSERT_EQ(pid, waitpid(pid, &status, 0));
+	EXPECT_TRUE(WIFEXITED(status));
+	EXPECT_EQ(0, WEXITSTATUS(status));
+}
+
+}  // namespace x86
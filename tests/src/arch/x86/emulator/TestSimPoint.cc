@@ -0,0 +1,131 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "gtest/gtest.h"
+
+#include <sstream>
+
+#include <arch/x86/emulator/SimPoint.h>
+#include <lib/cpp/String.h>
+
+
+namespace x86
+{
+
+// Return a basic block vector line with all instructions in one basic block,
+// except for a few in a second block.
+static std::string getVector(int block_id, int other_block_id, int count)
+{
+	return misc::fmt("T:%d:%d :%d:%d\n", block_id, 100 - count,
+			other_block_id, count);
+}
+
+
+TEST(TestSimPoint, separable_phases)
+{
+	// Three phases running different basic blocks, with some noise. The
+	// first phase covers half of the intervals.
+	std::ostringstream os;
+	for (int i = 0; i < 10; i++)
+		os << getVector(1, 4, i % 5);
+	for (int i = 0; i < 5; i++)
+		os << getVector(2, 5, i);
+	for (int i = 0; i < 5; i++)
+		os << getVector(3, 6, i);
+	std::istringstream is(os.str());
+	SimPoint simpoint;
+	simpoint.Read(is);
+	EXPECT_EQ(20, simpoint.getNumIntervals());
+	EXPECT_EQ(2000, simpoint.getNumInstructions());
+
+	// One simulation point per phase, weighted by the size of the phase
+	simpoint.Cluster(6);
+	ASSERT_EQ(3, simpoint.getNumClusters());
+	const std::vector<SimPoint::Point> &points = simpoint.getPoints();
+	ASSERT_EQ(3, (int) points.size());
+	EXPECT_LT(points[0].interval, 10);
+	EXPECT_GE(points[1].interval, 10);
+	EXPECT_LT(points[1].interval, 15);
+	EXPECT_GE(points[2].interval, 15);
+	EXPECT_DOUBLE_EQ(0.5, points[0].weight);
+	EXPECT_DOUBLE_EQ(0.25, points[1].weight);
+	EXPECT_DOUBLE_EQ(0.25, points[2].weight);
+	for (auto &point : points)
+	{
+		EXPECT_EQ(point.interval * 100, point.start);
+		EXPECT_EQ(100, point.length);
+	}
+}
+
+
+TEST(TestSimPoint, single_phase)
+{
+	// All intervals run the same code. The BIC score chooses one cluster
+	// even when more are allowed.
+	std::ostringstream os;
+	for (int i = 0; i < 12; i++)
+		os << getVector(1, 2, 10);
+	std::istringstream is(os.str());
+	SimPoint simpoint;
+	simpoint.Read(is);
+	simpoint.Cluster(6);
+	EXPECT_EQ(1, simpoint.getNumClusters());
+	ASSERT_EQ(1, (int) simpoint.getPoints().size());
+	EXPECT_DOUBLE_EQ(1.0, simpoint.getPoints()[0].weight);
+}
+
+
+TEST(TestSimPoint, more_clusters_than_phases)
+{
+	// Allowing as many clusters as intervals must not produce empty or
+	// duplicate simulation points.
+	std::ostringstream os;
+	for (int i = 0; i < 4; i++)
+		os << getVector(1, 3, 0);
+	for (int i = 0; i < 4; i++)
+		os << getVector(2, 3, 0);
+	std::istringstream is(os.str());
+	SimPoint simpoint;
+	simpoint.Read(is);
+	simpoint.Cluster(8);
+	EXPECT_EQ(2, simpoint.getNumClusters());
+	double weight = 0.0;
+	for (auto &point : simpoint.getPoints())
+		weight += point.weight;
+	EXPECT_DOUBLE_EQ(1.0, weight);
+}
+
+
+TEST(TestSimPoint, invalid_vector)
+{
+	std::istringstream is("T:1:100\nX:1:100\n");
+	SimPoint simpoint;
+	std::string message;
+	try
+	{
+		simpoint.Read(is);
+	}
+	catch (SimPoint::Error &error)
+	{
+		message = error.getMessage();
+	}
+	EXPECT_NE(std::string::npos, message.find("Line 2"));
+}
+
+}  // namespace x86
@@ -19,9 +19,14 @@
 
 #include "gtest/gtest.h"
 
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <unistd.h>
 #include <vector>
 
 #include <lib/cpp/IniFile.h>
+#include <arch/x86/emulator/BranchTrace.h>
 #include <arch/x86/emulator/Emulator.h>
 #include <arch/x86/emulator/Uinst.h>
 #include <arch/x86/timing/BranchPredictor.h>
@@ -593,8 +598,215 @@ TEST(TestBranchPredictor, test_combined_branch_predictor_1)
 }
 
 
+TEST(TestBranchPredictor, read_ini_configuration_file_tage)
+{
+	// Setup configuration file
+	std::string config =
+		"[ BranchPredictor ]\n"
+		"Kind = TAGE\n"
+		"TAGE.NumTables = 4\n"
+		"TAGE.TableSize = 512\n"
+		"TAGE.TagBits = 8\n"
+		"TAGE.MinHistory = 4\n"
+		"TAGE.MaxHistory = 64\n"
+		"Perceptron.NumTables = 4\n"
+		"Perceptron.TableSize = 256\n"
+		"Perceptron.HistorySize = 24\n"
+		"Indirect = ITTAGE\n"
+		"ITTAGE.NumTables = 2\n"
+		"ITTAGE.TableSize = 128\n"
+		"ITTAGE.TagBits = 7\n"
+		"ITTAGE.MinHistory = 2\n"
+		"ITTAGE.MaxHistory = 32";
+
+	// Set up INI file
+	misc::IniFile ini_file;
+	ini_file.LoadFromString(config);
+	BranchPredictor::ParseConfiguration(&ini_file);
+
+	// Assertions
+	EXPECT_EQ(BranchPredictor::KindTage, BranchPredictor::getKind());
+	EXPECT_EQ(4, BranchPredictor::getTageNumTables());
+	EXPECT_EQ(512, BranchPredictor::getTageTableSize());
+	EXPECT_EQ(8, BranchPredictor::getTageTagBits());
+	EXPECT_EQ(4, BranchPredictor::getTageMinHistory());
+	EXPECT_EQ(64, BranchPredictor::getTageMaxHistory());
+	EXPECT_EQ(4, BranchPredictor::getPerceptronNumTables());
+	EXPECT_EQ(256, BranchPredictor::getPerceptronTableSize());
+	EXPECT_EQ(24, BranchPredictor::getPerceptronHistorySize());
+	EXPECT_EQ(BranchPredictor::IndirectKindIttage, BranchPredictor::getIndirectKind());
+	EXPECT_EQ(2, BranchPredictor::getIttageNumTables());
+	EXPECT_EQ(128, BranchPredictor::getIttageTableSize());
+	EXPECT_EQ(7, BranchPredictor::getIttageTagBits());
+	EXPECT_EQ(2, BranchPredictor::getIttageMinHistory());
+	EXPECT_EQ(32, BranchPredictor::getIttageMaxHistory());
+
+	// Invalid configuration
+	misc::IniFile invalid_ini_file;
+	invalid_ini_file.LoadFromString("[ BranchPredictor ]\nTAGE.TableSize = 100");
+	EXPECT_THROW(BranchPredictor::ParseConfiguration(&invalid_ini_file),
+			BranchPredictor::Error);
+}
+
+
+TEST(TestBranchPredictor, test_history_branch_predictors_1)
+{
+	// A branch alternating between taken and not taken cannot be learnt
+	// by a bimodal predictor, but it is learnt by predictors using the
+	// global history.
+	const char *kinds[] = { "TAGE", "Perceptron" };
+	for (const char *kind : kinds)
+	{
+		// Setup configuration
+		misc::IniFile ini_file;
+		ini_file.LoadFromString(misc::fmt("[ BranchPredictor ]\n"
+				"Kind = %s", kind));
+		BranchPredictor::ParseConfiguration(&ini_file);
+		BranchPredictor branch_predictor;
+
+		// Run branch
+		auto uinst = misc::new_shared<Uinst>(Uinst::OpcodeBranch);
+		int num_mispredictions = 0;
+		for (int i = 0; i < 200; i++)
+		{
+			Uop uop(nullptr, nullptr, uinst);
+			uop.eip = 0x1000;
+			uop.mop_size = 2;
+			uop.neip = i % 2 ? 0x1000 + 2 : 0x2000;
+			bool taken = branch_predictor.Lookup(&uop) ==
+					BranchPredictor::PredictionTaken;
+			uop.predicted_neip = taken ? 0x2000 : 0x1000 + 2;
+			branch_predictor.Update(&uop);
+
+			// Check last iterations
+			if (i >= 100 && uop.predicted_neip != uop.neip)
+				num_mispredictions++;
+		}
+		EXPECT_EQ(0, num_mispredictions) << kind;
+	}
 }
 
+TEST(TestBranchPredictor, test_ittage_target_prediction)
+{
+	// An indirect jump whose target depends on the outcome of the
+	// previous conditional branch always misses in the BTB, which
+	// records the last target only. The ITTAGE predictor learns the
+	// target from the global history.
+	const char *indirect_kinds[] = { "BTB", "ITTAGE" };
+	int num_mispredictions[2] = {};
+	for (int k = 0; k < 2; k++)
+	{
+		// Setup configuration
+		misc::IniFile ini_file;
+		ini_file.LoadFromString(misc::fmt("[ BranchPredictor ]\n"
+				"Kind = TAGE\n"
+				"Indirect = %s", indirect_kinds[k]));
+		BranchPredictor::ParseConfiguration(&ini_file);
+		BranchPredictor branch_predictor;
+
+		// Conditional branch alternating between taken and not taken,
+		// followed by an indirect jump with alternating targets
+		auto branch = misc::new_shared<Uinst>(Uinst::OpcodeBranch);
+		auto jump = misc::new_shared<Uinst>(Uinst::OpcodeJump);
+		jump->setIDep(0, Uinst::DepEax);
+		for (int i = 0; i < 400; i++)
+		{
+			// Conditional branch
+			Uop branch_uop(nullptr, nullptr, branch);
+			branch_uop.eip = 0x1000;
+			branch_uop.mop_size = 2;
+			branch_uop.neip = i % 2 ? 0x1000 + 2 : 0x1010;
+			unsigned target = branch_predictor.LookupBtb(&branch_uop);
+			bool taken = branch_predictor.Lookup(&branch_uop) ==
+					BranchPredictor::PredictionTaken && target;
+			branch_uop.predicted_neip = taken ? target : 0x1000 + 2;
+			branch_predictor.Update(&branch_uop);
+			branch_predictor.UpdateBtb(&branch_uop);
+
+			// Indirect jump
+			Uop jump_uop(nullptr, nullptr, jump);
+			jump_uop.eip = 0x1100;
+			jump_uop.mop_size = 2;
+			jump_uop.neip = i % 2 ? 0x4000 : 0x3000;
+			target = branch_predictor.LookupBtb(&jump_uop);
+			taken = branch_predictor.Lookup(&jump_uop) ==
+					BranchPredictor::PredictionTaken && target;
+			jump_uop.predicted_neip = taken ? target : 0x1100 + 2;
+			branch_predictor.Update(&jump_uop);
+			branch_predictor.UpdateBtb(&jump_uop);
+
+			// Check last iterations
+			if (i >= 300 && jump_uop.predicted_neip != jump_uop.neip)
+				num_mispredictions[k]++;
+		}
+	}
+	EXPECT_EQ(100, num_mispredictions[0]);
+	EXPECT_EQ(0, num_mispredictions[1]);
+}
 
 
+TEST(TestBranchPredictor, test_evaluate_branch_trace)
+{
+	// Temporary trace file
+	char path[] = "/tmp/m2s-test-XXXXXX";
+	close(mkstemp(path));
 
+	// Record a loop of 100 iterations with 4 instructions in its body,
+	// the last one being the loop branch, followed by a call and a
+	// return.
+	{
+		BranchTrace branch_trace(path);
+		for (int i = 0; i < 100; i++)
+		{
+			for (int j = 0; j < 4; j++)
+				branch_trace.incNumInstructions();
+			branch_trace.Record(BranchTrace::KindBranch, 0x1010, 2,
+					i < 99 ? 0x1000 : 0x1012);
+		}
+		branch_trace.incNumInstructions();
+		branch_trace.Record(BranchTrace::KindCall, 0x1012, 5, 0x2000);
+		branch_trace.incNumInstructions();
+		branch_trace.Record(BranchTrace::KindRet, 0x2000, 1, 0x1017);
+	}
+
+	// The entries are read back as recorded
+	std::ifstream f(path);
+	BranchTrace::Entry entry;
+	ASSERT_TRUE(BranchTrace::Read(f, entry));
+	EXPECT_EQ(BranchTrace::KindBranch, entry.kind);
+	EXPECT_EQ(0x1010u, entry.eip);
+	EXPECT_EQ(2, entry.size);
+	EXPECT_EQ(0x1000u, entry.neip);
+	EXPECT_EQ(4, entry.num_instructions);
+
+	// Evaluate a bimodal predictor on the whole trace
+	misc::IniFile ini_file;
+	ini_file.LoadFromString("[ BranchPredictor ]\nKind = Bimodal");
+	BranchPredictor::ParseConfiguration(&ini_file);
+	BranchPredictor branch_predictor("BranchPredictor");
+	f.clear();
+	f.seekg(0);
+	std::ostringstream report;
+	branch_predictor.Evaluate(f, report);
+	remove(path);
+
+	// Parse report
+	misc::IniFile report_ini_file;
+	report_ini_file.LoadFromString(report.str());
+	std::string section = "BranchPredictor";
+	EXPECT_EQ("Bimodal", report_ini_file.ReadString(section, "Kind"));
+	EXPECT_EQ(402, report_ini_file.ReadInt(section, "Instructions"));
+	EXPECT_EQ(102, report_ini_file.ReadInt(section, "Branches"));
+	EXPECT_EQ(100, report_ini_file.ReadInt(section, "Branch.Count"));
+	EXPECT_EQ(1, report_ini_file.ReadInt(section, "Call.Count"));
+	EXPECT_EQ(1, report_ini_file.ReadInt(section, "Ret.Count"));
+
+	// The loop branch misses in the BTB the first time it is taken, and
+	// is mispredicted again on the loop exit
+	int num_mispredictions = report_ini_file.ReadInt(section,
+			"Branch.Mispredictions");
+	EXPECT_GE(num_mispredictions, 2);
+	EXPECT_LE(num_mispredictions, 3);
+}
+
+}
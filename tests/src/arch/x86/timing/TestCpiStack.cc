@@ -0,0 +1,301 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <sstream>
+
+#include <gtest/gtest.h>
+
+#include <arch/common/Arch.h>
+#include <arch/x86/emulator/Emulator.h>
+#include <arch/x86/timing/Cpu.h>
+#include <arch/x86/timing/Thread.h>
+#include <arch/x86/timing/Timing.h>
+#include <lib/cpp/IniFile.h>
+#include <lib/cpp/String.h>
+#include <lib/esim/Engine.h>
+#include <memory/Manager.h>
+#include <memory/Mmu.h>
+#include <memory/System.h>
+#include <network/System.h>
+
+
+namespace x86
+{
+
+// L1 cache shared by instructions and data, on top of an L2 cache and main
+// memory
+static const std::string mem_config =
+	"[ CacheGeometry geo-l1 ]\n"
+	"Sets = 64\n"
+	"Assoc = 2\n"
+	"BlockSize = 64\n"
+	"Latency = 1\n"
+	"Policy = LRU\n"
+	"\n"
+	"[ CacheGeometry geo-l2 ]\n"
+	"Sets = 128\n"
+	"Assoc = 4\n"
+	"BlockSize = 64\n"
+	"Latency = 10\n"
+	"Policy = LRU\n"
+	"\n"
+	"[ Module mod-l1 ]\n"
+	"Type = Cache\n"
+	"Geometry = geo-l1\n"
+	"LowNetwork = net-l1-l2\n"
+	"LowModules = mod-l2\n"
+	"\n"
+	"[ Module mod-l2 ]\n"
+	"Type = Cache\n"
+	"Geometry = geo-l2\n"
+	"HighNetwork = net-l1-l2\n"
+	"LowNetwork = net-l2-mm\n"
+	"LowModules = mod-mm\n"
+	"\n"
+	"[ Module mod-mm ]\n"
+	"Type = MainMemory\n"
+	"BlockSize = 64\n"
+	"Latency = 100\n"
+	"HighNetwork = net-l2-mm\n"
+	"\n"
+	"[ Network net-l1-l2 ]\n"
+	"DefaultInputBufferSize = 1024\n"
+	"DefaultOutputBufferSize = 1024\n"
+	"DefaultBandwidth = 256\n"
+	"\n"
+	"[ Network net-l2-mm ]\n"
+	"DefaultInputBufferSize = 1024\n"
+	"DefaultOutputBufferSize = 1024\n"
+	"DefaultBandwidth = 256\n"
+	"\n"
+	"[ Entry core-0 ]\n"
+	"Arch = x86\n"
+	"Core = 0\n"
+	"Thread = 0\n"
+	"Module = mod-l1\n";
+
+
+// Loop loading the 64 blocks of a 4KB buffer pointed to by esi:
+//
+//	loop:	mov eax, [esi + ebx]
+//		add ebx, 64
+//		and ebx, 0xfff
+//		jmp loop
+//
+static const std::vector<unsigned char> code_loads =
+{
+	0x8b, 0x04, 0x1e,
+	0x83, 0xc3, 0x40,
+	0x81, 0xe3, 0xff, 0x0f, 0x00, 0x00,
+	0xeb, 0xf2
+};
+
+
+static void Cleanup()
+{
+	esim::Engine::Destroy();
+	net::System::Destroy();
+	mem::System::Destroy();
+	Timing::Destroy();
+	Emulator::Destroy();
+	comm::ArchPool::Destroy();
+}
+
+
+// Configure the CPU and the memory hierarchy, and create a context running
+// the load loop. If 'module_name' is not empty, the data buffer is brought
+// into that module and all modules below it before the simulation starts.
+static Thread *Initialize(const std::string &module_name)
+{
+	// CPU configuration
+	misc::IniFile cpu_ini;
+	cpu_ini.LoadFromString("[ TraceCache ]\n"
+			"Present = f\n");
+	Timing::ParseConfiguration(&cpu_ini);
+	Emulator *emulator = Emulator::getInstance();
+	Timing::getInstance();
+
+	// Memory configuration
+	misc::IniFile mem_ini;
+	mem_ini.LoadFromString(mem_config);
+	mem::System *memory_system = mem::System::getInstance();
+	memory_system->ReadConfiguration(&mem_ini);
+
+	// Context
+	Context *context = emulator->newContext();
+	context->Initialize();
+	mem::Memory *memory = context->getMemory();
+	memory->setHeapBreak(misc::RoundUp(memory->getHeapBreak(),
+			mem::Memory::PageSize));
+
+	// Code and data
+	mem::Manager manager(memory);
+	unsigned eip = manager.Allocate(code_loads.size(), 64);
+	memory->Write(eip, code_loads.size(),
+			(const char *) code_loads.data());
+	unsigned data = manager.Allocate(4096, 4096);
+
+	// Start running
+	context->setUinstActive(true);
+	context->setState(Context::StateRunning);
+	context->getRegs().setEip(eip);
+	context->getRegs().setEsi(data);
+	context->getRegs().setEbx(0);
+	Cpu *cpu = Timing::getInstance()->getCpu();
+	cpu->Schedule();
+
+	// Warm up the data buffer
+	if (!module_name.empty())
+	{
+		mem::Module *module = memory_system->getModule(module_name);
+		for (unsigned address = data; address < data + 4096;
+				address += 64)
+			module->WarmAccess(mem::Module::AccessLoad,
+					context->getMmu()->TranslateVirtualAddress(
+					context->getMmuSpace(), address));
+	}
+	return cpu->getThread(0, 0);
+}
+
+
+// Return the number of commit slots of the thread attributed to any
+// category of the CPI stack
+static long long getNumCommitSlots(Thread *thread)
+{
+	long long num_slots = 0;
+	for (int stall = Thread::CommitStallUsed;
+			stall < Thread::CommitStallMax; stall++)
+		num_slots += thread->getNumCommitSlots(
+				(Thread::CommitStall) stall);
+	return num_slots;
+}
+
+
+// Run the given number of cycles and check that every commit slot was
+// attributed to exactly one category of the CPI stack
+static void RunCycles(Thread *thread, int num_cycles)
+{
+	Timing *timing = Timing::getInstance();
+	esim::Engine *esim_engine = esim::Engine::getInstance();
+	long long num_slots = getNumCommitSlots(thread);
+	for (int i = 0; i < num_cycles; i++)
+	{
+		timing->Run();
+		esim_engine->ProcessEvents();
+	}
+	EXPECT_EQ(getNumCommitSlots(thread) - num_slots,
+			num_cycles * Cpu::getCommitWidth());
+}
+
+
+TEST(TestX86TimingCpiStack, memory)
+{
+	// Loads miss in both caches
+	Cleanup();
+	Thread *thread = Initialize("");
+	RunCycles(thread, 1000);
+	EXPECT_GT(thread->getNumCommitSlots(Thread::CommitStallUsed), 0);
+	EXPECT_GT(thread->getNumCommitSlots(Thread::CommitStallMemory),
+			thread->getNumCommitSlots(Thread::CommitStallL2));
+	EXPECT_EQ(thread->getNumCommitSlots(Thread::CommitStallLlc), 0);
+	Cleanup();
+}
+
+
+TEST(TestX86TimingCpiStack, l2)
+{
+	// Loads hit in the L2 cache, and then in the L1 cache
+	Cleanup();
+	Thread *thread = Initialize("mod-l2");
+	RunCycles(thread, 1000);
+	EXPECT_GT(thread->getNumCommitSlots(Thread::CommitStallUsed), 0);
+	EXPECT_GT(thread->getNumCommitSlots(Thread::CommitStallL2), 0);
+	EXPECT_EQ(thread->getNumCommitSlots(Thread::CommitStallLlc), 0);
+	EXPECT_EQ(thread->getNumCommitSlots(Thread::CommitStallMemory), 0);
+	Cleanup();
+}
+
+
+TEST(TestX86TimingCpiStack, l1)
+{
+	// Loads hit in the L1 cache
+	Cleanup();
+	Thread *thread = Initialize("mod-l1");
+	RunCycles(thread, 1000);
+	EXPECT_GT(thread->getNumCommitSlots(Thread::CommitStallUsed), 0);
+	EXPECT_EQ(thread->getNumCommitSlots(Thread::CommitStallL2), 0);
+	EXPECT_EQ(thread->getNumCommitSlots(Thread::CommitStallLlc), 0);
+	EXPECT_EQ(thread->getNumCommitSlots(Thread::CommitStallMemory), 0);
+	Cleanup();
+}
+
+
+TEST(TestX86TimingCpiStack, time_series)
+{
+	Cleanup();
+	Thread *thread = Initialize("");
+	std::ostringstream os;
+
+	// Two intervals. The contributions of the categories in each line
+	// add up to the CPI of the interval.
+	long long num_instructions = 0;
+	for (int interval = 1; interval <= 2; interval++)
+	{
+		RunCycles(thread, 500);
+		thread->DumpCpiStackInterval(os);
+		std::istringstream is(os.str());
+		os.str("");
+		long long cycle;
+		int core;
+		int thread_id;
+		long long interval_instructions;
+		is >> cycle >> core >> thread_id >> interval_instructions;
+		EXPECT_EQ(cycle, Timing::getInstance()->getCycle());
+		EXPECT_EQ(core, 0);
+		EXPECT_EQ(thread_id, 0);
+		EXPECT_EQ(interval_instructions,
+				thread->getNumCommittedInstructions() -
+				num_instructions);
+		ASSERT_GT(interval_instructions, 0);
+		num_instructions = thread->getNumCommittedInstructions();
+		double cpi = 0;
+		for (int stall = Thread::CommitStallUsed;
+				stall < Thread::CommitStallMax; stall++)
+		{
+			double value;
+			is >> value;
+			ASSERT_FALSE(is.fail());
+			cpi += value;
+		}
+		EXPECT_NEAR(cpi, 500.0 / interval_instructions, 0.01);
+	}
+
+	// No instructions in an empty interval
+	thread->DumpCpiStackInterval(os);
+	std::string line = misc::fmt("%lld 0 0 0",
+			Timing::getInstance()->getCycle());
+	for (int stall = Thread::CommitStallUsed;
+			stall < Thread::CommitStallMax; stall++)
+		line += " -";
+	EXPECT_EQ(os.str(), line + "\n");
+	Cleanup();
+}
+
+
+}  // namespace x86
@@ -0,0 +1,219 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <gtest/gtest.h>
+
+#include <arch/common/Arch.h>
+#include <arch/x86/emulator/Emulator.h>
+#include <arch/x86/timing/Cpu.h>
+#include <arch/x86/timing/Timing.h>
+#include <lib/cpp/IniFile.h>
+#include <lib/esim/Engine.h>
+#include <memory/Manager.h>
+#include <memory/Mmu.h>
+#include <memory/System.h>
+#include <network/System.h>
+
+
+namespace x86
+{
+
+// One L1 cache shared by instructions and data, on top of main memory
+static const std::string mem_config =
+	"[ CacheGeometry geo-l1 ]\n"
+	"Sets = 64\n"
+	"Assoc = 2\n"
+	"BlockSize = 64\n"
+	"Latency = 1\n"
+	"Policy = LRU\n"
+	"\n"
+	"[ Module mod-l1 ]\n"
+	"Type = Cache\n"
+	"Geometry = geo-l1\n"
+	"LowNetwork = net-l1-mm\n"
+	"LowModules = mod-mm\n"
+	"\n"
+	"[ Module mod-mm ]\n"
+	"Type = MainMemory\n"
+	"BlockSize = 64\n"
+	"Latency = 10\n"
+	"HighNetwork = net-l1-mm\n"
+	"\n"
+	"[ Network net-l1-mm ]\n"
+	"DefaultInputBufferSize = 1024\n"
+	"DefaultOutputBufferSize = 1024\n"
+	"DefaultBandwidth = 256\n"
+	"\n"
+	"[ Entry core-0 ]\n"
+	"Arch = x86\n"
+	"Core = 0\n"
+	"Thread = 0\n"
+	"Module = mod-l1\n";
+
+
+static void Cleanup()
+{
+	esim::Engine::Destroy();
+	net::System::Destroy();
+	mem::System::Destroy();
+	Timing::Destroy();
+	Emulator::Destroy();
+	comm::ArchPool::Destroy();
+}
+
+
+// Configure the CPU, with the given variables in section [ General ], and
+// the memory hierarchy, and create a context running the given code. The context is returned, and the virtual address of a
+// 4KB data buffer is returned in 'data'.
+static Context *Initialize(const std::string &general,
+		const std::vector<unsigned char> &code,
+		unsigned &data)
+{
+	// CPU configuration
+	misc::IniFile cpu_ini;
+	cpu_ini.LoadFromString("[ General ]\n" + general +
+			"[ TraceCache ]\n"
+			"Present = f\n");
+	Timing::ParseConfiguration(&cpu_ini);
+	Emulator *emulator = Emulator::getInstance();
+	Timing::getInstance();
+
+	// Memory configuration
+	misc::IniFile mem_ini;
+	mem_ini.LoadFromString(mem_config);
+	mem::System::getInstance()->ReadConfiguration(&mem_ini);
+
+	// Context
+	Context *context = emulator->newContext();
+	context->Initialize();
+	mem::Memory *memory = context->getMemory();
+	memory->setHeapBreak(misc::RoundUp(memory->getHeapBreak(),
+			mem::Memory::PageSize));
+
+	// Code and data
+	mem::Manager manager(memory);
+	unsigned eip = manager.Allocate(code.size(), 64);
+	memory->Write(eip, code.size(), (const char *) code.data());
+	data = manager.Allocate(4096, 4096);
+
+	// Start running
+	context->setState(Context::StateRunning);
+	context->getRegs().setEip(eip);
+	context->getRegs().setEsi(data);
+	return context;
+}
+
+
+// Return whether the block containing the given virtual address of the
+// context is present in the L1 cache
+static bool isCached(Context *context, unsigned address)
+{
+	mem::Module *module = mem::System::getInstance()->getModule("mod-l1");
+	unsigned physical_address = context->getMmu()->TranslateVirtualAddress(
+			context->getMmuSpace(), address);
+	int set;
+	int way;
+	int tag;
+	mem::Cache::BlockState state;
+	return module->FindBlock(physical_address, set, way, tag, state);
+}
+
+
+// Loop loading one 64-byte block per iteration:
+//
+//	loop:	mov eax, [esi]
+//		add esi, 64
+//		jmp loop
+//
+static const std::vector<unsigned char> code_loads =
+{
+	0x8b, 0x06,
+	0x83, 0xc6, 0x40,
+	0xeb, 0xf9
+};
+
+
+TEST(TestX86TimingFunctionalWarming, run_functional)
+{
+	Cleanup();
+	unsigned data;
+	Context *context = Initialize("", code_loads, data);
+	Emulator *emulator = Emulator::getInstance();
+	Cpu *cpu = Timing::getInstance()->getCpu();
+	cpu->Schedule();
+	ASSERT_EQ(context->thread, cpu->getThread(0, 0));
+
+	// Without warming, four iterations leave the cache untouched
+	EXPECT_EQ(cpu->RunFunctional(12, false), 12);
+	EXPECT_EQ(emulator->getNumInstructions(), 12);
+	for (int i = 0; i < 4; i++)
+		EXPECT_FALSE(isCached(context, data + i * 64));
+
+	// With warming, the next four iterations bring their blocks in
+	EXPECT_EQ(cpu->RunFunctional(12, true), 12);
+	EXPECT_EQ(emulator->getNumInstructions(), 24);
+	for (int i = 0; i < 4; i++)
+		EXPECT_FALSE(isCached(context, data + i * 64));
+	for (int i = 4; i < 8; i++)
+		EXPECT_TRUE(isCached(context, data + i * 64));
+	EXPECT_FALSE(isCached(context, data + 8 * 64));
+	Cleanup();
+}
+
+
+TEST(TestX86TimingFunctionalWarming, run_functional_exit)
+{
+	// mov eax, 1
+	// int 0x80
+	Cleanup();
+	unsigned data;
+	Initialize("", { 0xb8, 0x01, 0x00, 0x00, 0x00, 0xcd, 0x80 }, data);
+	Emulator *emulator = Emulator::getInstance();
+	Cpu *cpu = Timing::getInstance()->getCpu();
+
+	// Functional simulation stops when the context finishes
+	EXPECT_EQ(cpu->RunFunctional(100, false), 2);
+	EXPECT_EQ(emulator->getNumInstructions(), 2);
+	EXPECT_EQ(emulator->getNumRunningContexts(), 0);
+	Cleanup();
+}
+
+
+TEST(TestX86TimingFunctionalWarming, fast_forward)
+{
+	// Fast-forward 10 iterations, warming up with the last 5
+	Cleanup();
+	unsigned data;
+	Context *context = Initialize("FastForward = 30\n"
+			"FunctionalWarming = 15\n", code_loads, data);
+	Emulator *emulator = Emulator::getInstance();
+	Timing::getInstance()->FastForward();
+	EXPECT_EQ(emulator->getNumInstructions(), 30);
+	EXPECT_EQ(context->getRegs().getEsi(), data + 10 * 64);
+
+	// Only loads in the warming interval reached the cache
+	for (int i = 0; i < 5; i++)
+		EXPECT_FALSE(isCached(context, data + i * 64));
+	for (int i = 5; i < 10; i++)
+		EXPECT_TRUE(isCached(context, data + i * 64));
+	Cleanup();
+}
+
+
+}  // namespace x86
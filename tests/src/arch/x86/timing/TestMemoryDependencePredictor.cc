@@ -0,0 +1,91 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "gtest/gtest.h"
+
+#include <lib/cpp/IniFile.h>
+#include <arch/x86/emulator/Uinst.h>
+#include <arch/x86/timing/MemoryDependencePredictor.h>
+#include <arch/x86/timing/Uop.h>
+
+#include "ObjectPool.h"
+
+namespace x86
+{
+
+TEST(TestMemoryDependencePredictor, read_ini_configuration_file)
+{
+	// Setup configuration file
+	std::string config =
+		"[ MemoryDependencePredictor ]\n"
+		"Kind = Conservative\n"
+		"LoadWait.Size = 256\n"
+		"LoadWait.ClearInterval = 1000\n"
+		"ViolationPenalty = 20";
+
+	// Set up INI file
+	misc::IniFile ini_file;
+	ini_file.LoadFromString(config);
+
+	// Parse configuration
+	MemoryDependencePredictor::ParseConfiguration(&ini_file);
+
+	// Assertions
+	EXPECT_EQ(MemoryDependencePredictor::KindConservative,
+			MemoryDependencePredictor::getKind());
+	EXPECT_EQ(256, MemoryDependencePredictor::getLoadWaitSize());
+	EXPECT_EQ(1000, MemoryDependencePredictor::getLoadWaitClearInterval());
+	EXPECT_EQ(20, MemoryDependencePredictor::getViolationPenalty());
+}
+
+
+TEST(TestMemoryDependencePredictor, test_load_wait_table)
+{
+	// Setup configuration file
+	std::string config =
+		"[ MemoryDependencePredictor ]\n"
+		"Kind = LoadWait\n"
+		"LoadWait.Size = 16\n"
+		"LoadWait.ClearInterval = 100";
+
+	// Set up INI file
+	misc::IniFile ini_file;
+	ini_file.LoadFromString(config);
+	MemoryDependencePredictor::ParseConfiguration(&ini_file);
+
+	// Mock load micro-instruction
+	ObjectPool *object_pool = ObjectPool::getInstance();
+	auto uinst = misc::new_shared<Uinst>(Uinst::OpcodeLoad);
+	Uop uop(object_pool->getThread(), object_pool->getContext(), uinst);
+	uop.eip = 0x1000;
+
+	// Loads issue early until they cause a violation
+	MemoryDependencePredictor predictor;
+	EXPECT_FALSE(predictor.Lookup(&uop, 10));
+	predictor.Update(&uop);
+	EXPECT_TRUE(predictor.Lookup(&uop, 20));
+	EXPECT_EQ(1, predictor.getNumViolations());
+	EXPECT_EQ(2, predictor.getNumLookups());
+	EXPECT_EQ(1, predictor.getNumWaitPredictions());
+
+	// The table is cleared after the clear interval
+	EXPECT_FALSE(predictor.Lookup(&uop, 150));
+}
+
+}
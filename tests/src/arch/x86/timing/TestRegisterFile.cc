@@ -992,6 +992,83 @@ TEST(TestRegisterFile, undo_uop_2)
 
 
 
+// Test UndoUop() with a checkpoint: renames two speculative uops, the first
+// of them starting a sequence of speculative uops, and undoes them. The
+// aliasing tables must be restored from the checkpoint.
+TEST(TestRegisterFile, undo_uop_checkpoint)
+{
+	// Cleanup singleton instances
+	ObjectPool::Destroy();
+
+	// Get object pool instance
+	ObjectPool *object_pool = ObjectPool::getInstance();
+
+	// Create uinsts
+	auto uinst_read = misc::new_shared<Uinst>(Uinst::OpcodeAdd);
+	auto uinst_write = misc::new_shared<Uinst>(Uinst::OpcodeAdd);
+
+	// Set dependencies
+	uinst_read->setIDep(0, 1);
+	uinst_read->setIDep(1, 23);
+	uinst_read->setIDep(2, 34);
+	uinst_write->setODep(0, 1);
+	uinst_write->setODep(1, 23);
+	uinst_write->setODep(2, 34);
+
+	// Create uops
+	auto uop_read_0 = misc::new_unique<Uop>(object_pool->getThread(),
+			object_pool->getContext(),
+			uinst_read);
+	auto uop_0 = misc::new_unique<Uop>(object_pool->getThread(),
+			object_pool->getContext(),
+			uinst_write);
+	auto uop_1 = misc::new_unique<Uop>(object_pool->getThread(),
+			object_pool->getContext(),
+			uinst_write);
+	auto uop_read_1 = misc::new_unique<Uop>(object_pool->getThread(),
+			object_pool->getContext(),
+			uinst_read);
+	uop_0->speculative_mode = true;
+	uop_0->first_speculative_mode = true;
+	uop_1->speculative_mode = true;
+
+	// Get register file
+	auto register_file = object_pool->getThread()->getRegisterFile();
+
+	// Record initial mappings
+	register_file->Rename(uop_read_0.get());
+
+	// Rename and write speculative uops
+	register_file->Rename(uop_0.get());
+	register_file->Rename(uop_1.get());
+	register_file->WriteUop(uop_0.get());
+	register_file->WriteUop(uop_1.get());
+
+	// Undo them from youngest to oldest
+	register_file->UndoUop(uop_1.get());
+	register_file->UndoUop(uop_0.get());
+	EXPECT_EQ(1, register_file->getNumCheckpointRecoveries());
+
+	// Check that the physical registers have been deallocated
+	for (int dep = 0; dep < 3; dep++)
+	{
+		EXPECT_NE(uop_0->getOutput(dep), uop_read_0->getInput(dep));
+		EXPECT_NE(uop_1->getOutput(dep), uop_read_0->getInput(dep));
+	}
+	EXPECT_TRUE(register_file->isIntegerRegisterFree(uop_1->getOutput(0)));
+	EXPECT_TRUE(register_file->isFloatingPointRegisterFree(uop_1->getOutput(1)));
+	EXPECT_TRUE(register_file->isXmmRegisterFree(uop_1->getOutput(2)));
+
+	// Check that the initial mappings are back
+	register_file->Rename(uop_read_1.get());
+	for (int dep = 0; dep < 3; dep++)
+		EXPECT_EQ(uop_read_0->getInput(dep), uop_read_1->getInput(dep));
+	register_file->CheckRegisterFile();
+}
+
+
+
+
 //
 // CommitUop() Tests
 //
@@ -0,0 +1,174 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "gtest/gtest.h"
+
+#include <string>
+
+#include <lib/cpp/IniFile.h>
+#include <arch/x86/emulator/Uinst.h>
+#include <arch/x86/timing/LoopStreamDetector.h>
+#include <arch/x86/timing/Uop.h>
+#include <arch/x86/timing/UopCache.h>
+
+#include "ObjectPool.h"
+
+
+namespace x86
+{
+
+// Record a macro-instruction decoded into the given number of uops
+static void RecordInstruction(UopCache *uop_cache, unsigned eip, int size,
+		int num_uops)
+{
+	ObjectPool *object_pool = ObjectPool::getInstance();
+	auto uinst = misc::new_shared<Uinst>(Uinst::OpcodeMove);
+	Uop uop(object_pool->getThread(), object_pool->getContext(), uinst);
+	uop.eip = eip;
+	uop.mop_size = size;
+	uop.mop_count = num_uops;
+	uop_cache->RecordUop(&uop);
+}
+
+
+TEST(TestUopCache, read_ini_configuration_file)
+{
+	// Setup configuration file
+	std::string config =
+			"[ UopCache ]\n"
+			"Present = True\n"
+			"Sets = 64\n"
+			"Assoc = 4\n"
+			"WindowSize = 64\n"
+			"MaxUops = 24\n"
+			"Width = 4\n"
+			"QueueSize = 16\n"
+			"[ LoopStreamDetector ]\n"
+			"Present = True\n"
+			"Size = 56\n"
+			"LockIterations = 4\n"
+			"Width = 6";
+
+	// Set up INI file
+	misc::IniFile ini_file;
+	ini_file.LoadFromString(config);
+
+	// Parse configuration
+	UopCache::ParseConfiguration(&ini_file);
+	LoopStreamDetector::ParseConfiguration(&ini_file);
+
+	// Assertions
+	EXPECT_EQ(true, UopCache::isPresent());
+	EXPECT_EQ(64, UopCache::getNumSets());
+	EXPECT_EQ(4, UopCache::getNumWays());
+	EXPECT_EQ(64, UopCache::getWindowSize());
+	EXPECT_EQ(24, UopCache::getMaxUops());
+	EXPECT_EQ(4, UopCache::getWidth());
+	EXPECT_EQ(16, UopCache::getQueueSize());
+	EXPECT_EQ(true, LoopStreamDetector::isPresent());
+	EXPECT_EQ(56, LoopStreamDetector::getSize());
+	EXPECT_EQ(4, LoopStreamDetector::getNumLockIterations());
+	EXPECT_EQ(6, LoopStreamDetector::getWidth());
+
+	// Invalid number of sets
+	misc::IniFile invalid_ini_file;
+	invalid_ini_file.LoadFromString("[ UopCache ]\nSets = 24");
+	EXPECT_THROW(UopCache::ParseConfiguration(&invalid_ini_file),
+			UopCache::Error);
+}
+
+
+TEST(TestUopCache, fill_and_lookup)
+{
+	// Default configuration: 32 sets, 2 ways, 32-byte windows
+	misc::IniFile ini_file;
+	ini_file.LoadFromString("[ UopCache ]\nPresent = True\nAssoc = 2");
+	UopCache::ParseConfiguration(&ini_file);
+	UopCache uop_cache;
+
+	// Decode window 0x1000 from 0x1004, then jump to another window,
+	// which inserts the first one.
+	EXPECT_FALSE(uop_cache.Lookup(0x1004));
+	RecordInstruction(&uop_cache, 0x1004, 4, 2);
+	RecordInstruction(&uop_cache, 0x1008, 2, 1);
+	RecordInstruction(&uop_cache, 0x2000, 4, 1);
+	EXPECT_EQ(1, uop_cache.getNumFills());
+	EXPECT_TRUE(uop_cache.Lookup(0x1004));
+	EXPECT_TRUE(uop_cache.Lookup(0x1008));
+
+	// Entering the window before its first decoded instruction misses
+	EXPECT_FALSE(uop_cache.Lookup(0x1000));
+
+	// Windows decoding to too many uops are not cached
+	RecordInstruction(&uop_cache, 0x3000, 4, 20);
+	RecordInstruction(&uop_cache, 0x4000, 4, 1);
+	EXPECT_FALSE(uop_cache.Lookup(0x3000));
+	EXPECT_TRUE(uop_cache.Lookup(0x2000));
+
+	// Windows mapping to the same set evict the LRU ones
+	RecordInstruction(&uop_cache, 0x1400, 4, 1);
+	RecordInstruction(&uop_cache, 0x1800, 4, 1);
+	RecordInstruction(&uop_cache, 0x5000, 4, 1);
+	EXPECT_FALSE(uop_cache.Lookup(0x1004));
+	EXPECT_TRUE(uop_cache.Lookup(0x1400));
+	EXPECT_TRUE(uop_cache.Lookup(0x1800));
+}
+
+
+TEST(TestUopCache, loop_stream_detector_lock)
+{
+	// Loops up to 8 uops, locked after 2 iterations
+	misc::IniFile ini_file;
+	ini_file.LoadFromString("[ LoopStreamDetector ]\n"
+			"Present = True\nSize = 8\nLockIterations = 2");
+	LoopStreamDetector::ParseConfiguration(&ini_file);
+	LoopStreamDetector loop_stream_detector;
+
+	// Forward branches are ignored
+	loop_stream_detector.RecordTakenBranch(0x1000, 0x1100);
+	EXPECT_FALSE(loop_stream_detector.isLocked());
+
+	// Loop from 0x2000 to 0x2010, 6 uops per iteration
+	for (int i = 0; i < 3; i++)
+	{
+		EXPECT_FALSE(loop_stream_detector.isLocked());
+		for (int j = 0; j < 6; j++)
+			loop_stream_detector.RecordUop();
+		loop_stream_detector.RecordTakenBranch(0x2010, 0x2000);
+	}
+	EXPECT_TRUE(loop_stream_detector.isInLoop(0x2008));
+	EXPECT_FALSE(loop_stream_detector.isInLoop(0x2014));
+	EXPECT_EQ(1, loop_stream_detector.getNumLocks());
+
+	// Unlocking forgets the loop
+	loop_stream_detector.Unlock();
+	EXPECT_FALSE(loop_stream_detector.isInLoop(0x2008));
+
+	// Loop bodies too large are never locked
+	for (int i = 0; i < 5; i++)
+	{
+		for (int j = 0; j < 9; j++)
+			loop_stream_detector.RecordUop();
+		loop_stream_detector.RecordTakenBranch(0x3010, 0x3000);
+	}
+	EXPECT_FALSE(loop_stream_detector.isLocked());
+}
+
+
+}
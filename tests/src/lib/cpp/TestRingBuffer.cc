@@ -0,0 +1,121 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <memory>
+
+#include <gtest/gtest.h>
+
+#include <lib/cpp/RingBuffer.h>
+
+namespace misc
+{
+
+TEST(TestRingBuffer, capacity)
+{
+	// Capacity is rounded up to a power of two
+	RingBuffer<int> ring_buffer(5);
+	EXPECT_EQ(ring_buffer.getCapacity(), 8);
+	EXPECT_TRUE(ring_buffer.isEmpty());
+	EXPECT_EQ(ring_buffer.getSize(), 0);
+	EXPECT_TRUE(ring_buffer.begin() == ring_buffer.end());
+}
+
+
+TEST(TestRingBuffer, full_empty)
+{
+	// Fill the buffer up to its capacity
+	RingBuffer<int> ring_buffer(4);
+	for (int i = 0; i < 4; i++)
+		ring_buffer.PushBack(i);
+	EXPECT_EQ(ring_buffer.getSize(), 4);
+	EXPECT_EQ(ring_buffer.getCapacity(), 4);
+	EXPECT_EQ(ring_buffer.Front(), 0);
+	EXPECT_EQ(ring_buffer.Back(), 3);
+
+	// Drain it from both ends
+	ring_buffer.PopFront();
+	ring_buffer.PopBack();
+	EXPECT_EQ(ring_buffer.Front(), 1);
+	EXPECT_EQ(ring_buffer.Back(), 2);
+	ring_buffer.PopFront();
+	ring_buffer.PopFront();
+	EXPECT_TRUE(ring_buffer.isEmpty());
+	EXPECT_EQ(ring_buffer.getCapacity(), 4);
+}
+
+
+TEST(TestRingBuffer, wraparound)
+{
+	// Advance the head so that new elements wrap around the end of
+	// the underlying storage
+	RingBuffer<int> ring_buffer(4);
+	for (int i = 0; i < 3; i++)
+		ring_buffer.PushBack(i);
+	ring_buffer.PopFront();
+	ring_buffer.PopFront();
+	for (int i = 3; i < 6; i++)
+		ring_buffer.PushBack(i);
+	EXPECT_EQ(ring_buffer.getCapacity(), 4);
+	ASSERT_EQ(ring_buffer.getSize(), 4);
+	for (int i = 0; i < 4; i++)
+		EXPECT_EQ(ring_buffer[i], i + 2);
+
+	// Iterators follow logical order
+	int expected = 2;
+	for (int value : ring_buffer)
+		EXPECT_EQ(value, expected++);
+	EXPECT_EQ(expected, 6);
+}
+
+
+TEST(TestRingBuffer, grow_when_full)
+{
+	// Pushing into a full, wrapped buffer doubles its capacity and
+	// keeps the elements in order
+	RingBuffer<int> ring_buffer(4);
+	for (int i = 0; i < 4; i++)
+		ring_buffer.PushBack(i);
+	ring_buffer.PopFront();
+	ring_buffer.PushBack(4);
+	ring_buffer.PushBack(5);
+	EXPECT_EQ(ring_buffer.getCapacity(), 8);
+	ASSERT_EQ(ring_buffer.getSize(), 5);
+	for (int i = 0; i < 5; i++)
+		EXPECT_EQ(ring_buffer[i], i + 1);
+}
+
+
+TEST(TestRingBuffer, pop_releases_element)
+{
+	// Popped and cleared elements release their values
+	RingBuffer<std::shared_ptr<int>> ring_buffer(4);
+	std::shared_ptr<int> a = std::make_shared<int>(1);
+	std::shared_ptr<int> b = std::make_shared<int>(2);
+	ring_buffer.PushBack(a);
+	ring_buffer.PushBack(b);
+	EXPECT_EQ(a.use_count(), 2);
+	ring_buffer.PopFront();
+	EXPECT_EQ(a.use_count(), 1);
+	ring_buffer.Clear();
+	EXPECT_EQ(b.use_count(), 1);
+	EXPECT_TRUE(ring_buffer.isEmpty());
+}
+
+
+}  // namespace misc
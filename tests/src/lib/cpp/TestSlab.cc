@@ -0,0 +1,126 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <memory>
+#include <set>
+
+#include <gtest/gtest.h>
+
+#include <lib/cpp/Slab.h>
+
+namespace misc
+{
+
+// Object allocated from a slab, counting live instances
+struct Counted : public SlabObject
+{
+	static int count;
+	long long values[3];
+	Counted(long long value) { values[0] = value; count++; }
+	~Counted() { count--; }
+};
+
+int Counted::count = 0;
+
+
+TEST(TestSlab, allocate_distinct_aligned)
+{
+	// Allocate more blocks than fit in one chunk
+	Slab slab(4);
+	std::set<void *> pointers;
+	for (int i = 0; i < 10; i++)
+	{
+		void *pointer = slab.Allocate(24);
+		EXPECT_EQ((size_t) pointer % alignof(std::max_align_t), 0u);
+		pointers.insert(pointer);
+	}
+
+	// All blocks are different
+	EXPECT_EQ(pointers.size(), 10u);
+}
+
+
+TEST(TestSlab, free_reuse)
+{
+	// Freed blocks are reused, last freed first
+	Slab slab(4);
+	void *a = slab.Allocate(8);
+	void *b = slab.Allocate(8);
+	void *c = slab.Allocate(8);
+	slab.Free(a);
+	slab.Free(c);
+	EXPECT_EQ(slab.Allocate(8), c);
+	EXPECT_EQ(slab.Allocate(8), a);
+
+	// A new block is different from the ones in use
+	void *d = slab.Allocate(8);
+	EXPECT_NE(d, a);
+	EXPECT_NE(d, b);
+	EXPECT_NE(d, c);
+}
+
+
+TEST(TestSlab, small_blocks)
+{
+	// Blocks smaller than a pointer still hold the free list
+	Slab slab(2);
+	char *a = (char *) slab.Allocate(1);
+	char *b = (char *) slab.Allocate(1);
+	char *c = (char *) slab.Allocate(1);
+	EXPECT_GE(a < b ? b - a : a - b, (long) sizeof(void *));
+	slab.Free(b);
+	slab.Free(a);
+	EXPECT_EQ(slab.Allocate(1), a);
+	EXPECT_EQ(slab.Allocate(1), b);
+	EXPECT_NE(slab.Allocate(1), c);
+}
+
+
+TEST(TestSlab, slab_ptr)
+{
+	// Objects are destroyed when their last handle goes away
+	Slab slab;
+	SlabPtr<Counted> object = SlabPtr<Counted>::New(&slab, 10);
+	SlabPtr<Counted> copy = object;
+	Counted *pointer = object.get();
+	EXPECT_EQ(10, copy->values[0]);
+	EXPECT_EQ(1, Counted::count);
+	object = nullptr;
+	EXPECT_FALSE(object);
+	EXPECT_EQ(1, Counted::count);
+
+	// A handle created from a raw pointer adds a reference
+	SlabPtr<Counted> raw_copy(pointer);
+	copy = nullptr;
+	EXPECT_EQ(1, Counted::count);
+	SlabPtr<Counted> moved = std::move(raw_copy);
+	EXPECT_FALSE(raw_copy);
+	moved = nullptr;
+	EXPECT_EQ(0, Counted::count);
+
+	// The block of the destroyed object is reused by the next one
+	object = SlabPtr<Counted>::New(&slab, 20);
+	EXPECT_EQ(1, Counted::count);
+	EXPECT_EQ(pointer, object.get());
+	object = nullptr;
+	EXPECT_EQ(0, Counted::count);
+}
+
+
+}  // namespace misc
@@ -0,0 +1,64 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <lib/cpp/Error.h>
+#include <lib/cpp/ThreadPool.h>
+
+namespace misc
+{
+
+// Tests that a thread pool runs every task of every batch exactly once,
+// and propagates exceptions thrown by tasks
+TEST(TestThreadPool, run)
+{
+	ThreadPool thread_pool(4);
+	EXPECT_EQ(4, thread_pool.getNumThreads());
+
+	// Batches of different sizes
+	for (int num_tasks = 1; num_tasks <= 16; num_tasks++)
+	{
+		std::vector<int> counts(num_tasks, 0);
+		thread_pool.Run(num_tasks, [&counts](int task)
+		{
+			counts[task]++;
+		});
+		for (int count : counts)
+			EXPECT_EQ(1, count);
+	}
+
+	// Exception thrown by one task, after all tasks finish
+	std::vector<int> counts(8, 0);
+	EXPECT_THROW(thread_pool.Run(8, [&counts](int task)
+	{
+		counts[task]++;
+		if (task == 5)
+			throw Error("Task failed");
+	}), Error);
+	for (int count : counts)
+		EXPECT_EQ(1, count);
+
+	// Invalid number of threads
+	EXPECT_THROW(ThreadPool(0), Error);
+}
+
+}  // namespace misc
@@ -21,6 +21,7 @@
 
 #include <lib/cpp/Misc.h>
 #include <lib/cpp/Error.h>
+#include <lib/cpp/ThreadPool.h>
 #include <lib/esim/Engine.h>
 #include <lib/esim/Event.h>
 #include <lib/esim/Queue.h>
@@ -516,9 +517,104 @@ TEST(TestEngine, test_event_queue_priority)
 	}
 }
 
-}
 
 
+//
+// Test 5
+//
+
+// Frame of the events scheduled by a component
+class DummyFrame_5 : public Frame
+{
+public:
+	int id = 0;
+};
 
+// Log of the events and deferred actions, in execution order
+std::vector<int> log_5;
 
+// Event handler
+void testHandler_5(Event *event, Frame *frame)
+{
+	DummyFrame_5 *data = dynamic_cast<DummyFrame_5 *>(frame);
+	log_5.push_back(data->id);
+}
 
+// Simulate cycles of a set of components in parallel regions, each of them
+// scheduling events and deferring actions, and return the log.
+static std::vector<int> RunComponents_5(int num_threads)
+{
+	// Set up esim engine
+	Cleanup();
+	log_5.clear();
+	Engine *engine = Engine::getInstance();
+	FrequencyDomain *domain = engine->RegisterFrequencyDomain(
+			"Test frequency domain", 1e3);
+	Event *event = engine->RegisterEvent("test event", testHandler_5,
+			domain);
+
+	// Thread pool, or none for a sequential run
+	std::unique_ptr<misc::ThreadPool> thread_pool;
+	if (num_threads > 1)
+		thread_pool = misc::new_unique<misc::ThreadPool>(num_threads);
+
+	// Simulate cycles
+	const int num_components = 10;
+	for (int cycle = 0; cycle < 20; cycle++)
+	{
+		auto run_group = [&](int partition)
+		{
+			Engine::setPartition(partition);
+			int first = partition * num_components / num_threads;
+			int last = (partition + 1) * num_components / num_threads;
+			for (int i = first; i < last; i++)
+			{
+				// Events with different latencies
+				for (int j = 0; j < 3; j++)
+				{
+					auto frame = misc::new_shared<DummyFrame_5>();
+					frame->id = cycle * 1000 + i * 10 + j;
+					engine->Call(event, frame, nullptr,
+							(cycle + i + j) % 4, 0);
+				}
+
+				// Action on shared state
+				engine->Defer([cycle, i]()
+				{
+					log_5.push_back(-(cycle * 1000 + i));
+				});
+			}
+		};
+		engine->BeginParallel(num_threads);
+		if (thread_pool)
+			thread_pool->Run(num_threads, run_group);
+		else
+			run_group(0);
+		engine->EndParallel();
+		engine->ProcessEvents();
+	}
+
+	// Finish pending events
+	engine->ProcessAllEvents();
+	return log_5;
+}
+
+// Tests that events scheduled and actions deferred in parallel regions run
+// in the same order for any number of host threads
+TEST(TestEngine, test_parallel_region)
+{
+	try
+	{
+		std::vector<int> sequential = RunComponents_5(1);
+		EXPECT_EQ(20 * 10 * 4, (int) sequential.size());
+		for (int num_threads = 2; num_threads <= 4; num_threads++)
+			EXPECT_EQ(sequential, RunComponents_5(num_threads));
+	}
+	catch (misc::Exception &e)
+	{
+		e.Dump();
+		FAIL();
+	}
+}
+
+}
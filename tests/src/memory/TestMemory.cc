@@ -0,0 +1,184 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "gtest/gtest.h"
+
+#include <sys/uio.h>
+#include <unistd.h>
+#include <vector>
+
+#include <memory/Memory.h>
+
+
+namespace mem
+{
+
+// Fill a buffer with a pattern depending on a seed
+static std::vector<char> getPattern(unsigned size, int seed)
+{
+	std::vector<char> buffer(size);
+	for (unsigned i = 0; i < size; i++)
+		buffer[i] = (char) (i * 7 + seed);
+	return buffer;
+}
+
+
+TEST(TestMemory, copy_from)
+{
+	// Unaligned region spanning three pages in both memory objects
+	Memory src;
+	Memory dest;
+	unsigned size = 2 * Memory::PageSize + 100;
+	src.Map(0x10000, 4 * Memory::PageSize, Memory::AccessRead |
+			Memory::AccessWrite);
+	dest.Map(0x40000, 4 * Memory::PageSize, Memory::AccessRead |
+			Memory::AccessWrite);
+	std::vector<char> data = getPattern(size, 1);
+	src.Write(0x10000 + 123, size, data.data());
+	dest.CopyFrom(0x40000 + 3000, src, 0x10000 + 123, size);
+
+	std::vector<char> result(size);
+	dest.Read(0x40000 + 3000, size, result.data());
+	EXPECT_EQ(data, result);
+
+	// Bytes around the destination region are not modified
+	char before, after;
+	dest.Read(0x40000 + 2999, 1, &before);
+	dest.Read(0x40000 + 3000 + size, 1, &after);
+	EXPECT_EQ(0, before);
+	EXPECT_EQ(0, after);
+}
+
+
+TEST(TestMemory, copy_from_unallocated)
+{
+	// Source pages with no data read as zeros
+	Memory src;
+	Memory dest;
+	src.Map(0x10000, 2 * Memory::PageSize, Memory::AccessRead);
+	dest.Map(0x10000, 2 * Memory::PageSize, Memory::AccessRead |
+			Memory::AccessWrite);
+	std::vector<char> data = getPattern(2 * Memory::PageSize, 2);
+	dest.Write(0x10000, data.size(), data.data());
+	dest.CopyFrom(0x10000, src, 0x10000, data.size());
+
+	std::vector<char> result(data.size());
+	dest.Read(0x10000, result.size(), result.data());
+	EXPECT_EQ(std::vector<char>(data.size(), 0), result);
+}
+
+
+TEST(TestMemory, copy_from_overlap)
+{
+	// Overlapping regions in the same memory object, both directions
+	for (int direction = 0; direction < 2; direction++)
+	{
+		Memory memory;
+		memory.Map(0x10000, 4 * Memory::PageSize,
+				Memory::AccessRead | Memory::AccessWrite);
+		unsigned size = Memory::PageSize + 500;
+		std::vector<char> data = getPattern(size, 3);
+		unsigned src_address = direction ? 0x10000 + 1000 : 0x10000;
+		unsigned address = direction ? 0x10000 : 0x10000 + 1000;
+		memory.Write(src_address, size, data.data());
+		memory.CopyFrom(address, memory, src_address, size);
+
+		std::vector<char> result(size);
+		memory.Read(address, size, result.data());
+		EXPECT_EQ(data, result);
+	}
+}
+
+
+TEST(TestMemory, copy_from_permissions)
+{
+	// Safe mode checks source and destination permissions
+	Memory src;
+	Memory dest;
+	src.setSafe(true);
+	dest.setSafe(true);
+	src.Map(0x10000, Memory::PageSize, Memory::AccessWrite);
+	dest.Map(0x10000, Memory::PageSize, Memory::AccessRead);
+	EXPECT_THROW(dest.CopyFrom(0x10000, src, 0x10000, 16), Memory::Error);
+	src.Protect(0x10000, Memory::PageSize, Memory::AccessRead);
+	EXPECT_THROW(dest.CopyFrom(0x10000, src, 0x10000, 16), Memory::Error);
+	dest.Protect(0x10000, Memory::PageSize, Memory::AccessWrite);
+	EXPECT_NO_THROW(dest.CopyFrom(0x10000, src, 0x10000, 16));
+
+	// Unmapped source
+	EXPECT_THROW(dest.CopyFrom(0x10000, src, 0x20000, 16), Memory::Error);
+}
+
+
+TEST(TestMemory, spans)
+{
+	// One span per page
+	Memory memory;
+	memory.Map(0x10000, 4 * Memory::PageSize, Memory::AccessRead |
+			Memory::AccessWrite);
+	unsigned address = 0x10000 + Memory::PageSize - 10;
+	unsigned size = Memory::PageSize + 20;
+	std::vector<struct iovec> spans;
+	memory.getSpans(address, size, Memory::AccessWrite, spans);
+	ASSERT_EQ(3u, spans.size());
+	EXPECT_EQ(10u, spans[0].iov_len);
+	EXPECT_EQ(Memory::PageSize, spans[1].iov_len);
+	EXPECT_EQ(10u, spans[2].iov_len);
+
+	// Fill the spans through a pipe, and read them back
+	int fds[2];
+	ASSERT_EQ(0, pipe(fds));
+	std::vector<char> data = getPattern(size, 4);
+	ASSERT_EQ((ssize_t) size, write(fds[1], data.data(), size));
+	ASSERT_EQ((ssize_t) size, readv(fds[0], spans.data(), spans.size()));
+	std::vector<char> result(size);
+	memory.Read(address, size, result.data());
+	EXPECT_EQ(data, result);
+
+	// Read spans feed host writes
+	spans.clear();
+	memory.getSpans(address, size, Memory::AccessRead, spans);
+	ASSERT_EQ((ssize_t) size, writev(fds[1], spans.data(), spans.size()));
+	std::vector<char> host(size);
+	ASSERT_EQ((ssize_t) size, read(fds[0], host.data(), size));
+	EXPECT_EQ(data, host);
+	close(fds[0]);
+	close(fds[1]);
+}
+
+
+TEST(TestMemory, spans_unallocated)
+{
+	// Read spans of pages with no data are zero-filled
+	Memory memory;
+	memory.Map(0x10000, Memory::PageSize, Memory::AccessRead);
+	std::vector<struct iovec> spans;
+	memory.getSpans(0x10000, 64, Memory::AccessRead, spans);
+	ASSERT_EQ(1u, spans.size());
+	ASSERT_EQ(64u, spans[0].iov_len);
+	for (unsigned i = 0; i < 64; i++)
+		EXPECT_EQ(0, ((char *) spans[0].iov_base)[i]);
+
+	// Spans of unmapped pages in safe mode
+	memory.setSafe(true);
+	EXPECT_THROW(memory.getSpans(0x20000, 64, Memory::AccessRead, spans),
+			Memory::Error);
+}
+
+}  // namespace mem
@@ -85,11 +85,78 @@ const std::string mem_config_1 =
                 "DefaultBandwidth = 256"; 
 
 
+const std::string mem_config_2 =
+		"[ CacheGeometry geo-l1 ]\n"
+		"Sets = 4\n"
+		"Assoc = 1\n"
+		"BlockSize = 64\n"
+		"Latency = 1\n"
+		"Policy = LRU\n"
+		"\n"
+		"[ CacheGeometry geo-l2 ]\n"
+		"Sets = 8\n"
+		"Assoc = 2\n"
+		"BlockSize = 64\n"
+		"Latency = 2\n"
+		"Policy = LRU\n"
+		"\n"
+		"[ Module mod-l1-0 ]\n"
+		"Type = Cache\n"
+		"Geometry = geo-l1\n"
+		"LowNetwork = net-l1-l2\n"
+		"LowModules = mod-l2\n"
+		"\n"
+		"[ Module mod-l1-1 ]\n"
+		"Type = Cache\n"
+		"Geometry = geo-l1\n"
+		"LowNetwork = net-l1-l2\n"
+		"LowModules = mod-l2\n"
+		"\n"
+		"[ Module mod-l2 ]\n"
+		"Type = Cache\n"
+		"Geometry = geo-l2\n"
+		"HighNetwork = net-l1-l2\n"
+		"LowNetwork = net-l2-mm\n"
+		"LowModules = mod-mm\n"
+		"\n"
+		"[ Module mod-mm ]\n"
+		"Type = MainMemory\n"
+		"BlockSize = 64\n"
+		"Latency = 8\n"
+		"HighNetwork = net-l2-mm\n"
+		"\n"
+		"[ Entry core-0 ]\n"
+		"Arch = x86\n"
+		"Core = 0\n"
+		"Thread = 0\n"
+		"Module = mod-l1-0\n"
+		"\n"
+		"[ Entry core-1 ]\n"
+		"Arch = x86\n"
+		"Core = 1\n"
+		"Thread = 0\n"
+		"Module = mod-l1-1\n"
+		"\n"
+		"[ Network net-l1-l2 ]\n"
+		"DefaultInputBufferSize = 1024\n"
+		"DefaultOutputBufferSize = 1024\n"
+		"DefaultBandwidth = 256\n"
+		"\n"
+		"[ Network net-l2-mm ]\n"
+		"DefaultInputBufferSize = 1024\n"
+		"DefaultOutputBufferSize = 1024\n"
+		"DefaultBandwidth = 256\n";
+
 const std::string x86_config_0 =
 		"[ General ]\n"
 		"Cores = 1\n"
 		"Threads = 1\n";
 
+const std::string x86_config_1 =
+		"[ General ]\n"
+		"Cores = 2\n"
+		"Threads = 1\n";
+
 static void Cleanup()
 {
 	esim::Engine::Destroy();
@@ -419,5 +486,84 @@ TEST(TestModule, can_access_2)
 }
 
 
+// This test checks that functional accesses with WarmAccess() update the
+// caches and directories as the coherence protocol would, with no events
+// scheduled in the simulation engine.
+TEST(TestModule, warm_access)
+{
+	try
+	{
+		// Cleanup singleton instances
+		Cleanup();
+
+		// Load configuration file
+		misc::IniFile ini_file_mem;
+		misc::IniFile ini_file_x86;
+		ini_file_mem.LoadFromString(mem_config_2);
+		ini_file_x86.LoadFromString(x86_config_1);
+
+		// Set up x86 timing simulator
+		x86::Timing::ParseConfiguration(&ini_file_x86);
+		x86::Timing::getInstance();
+
+		// Set up memory system
+		System *memory_system = System::getInstance();
+		memory_system->ReadConfiguration(&ini_file_mem);
+
+		// Get modules
+		Module *module_l1_0 = memory_system->getModule("mod-l1-0");
+		Module *module_l1_1 = memory_system->getModule("mod-l1-1");
+		Module *module_l2 = memory_system->getModule("mod-l2");
+		ASSERT_NE(module_l1_0, nullptr);
+		ASSERT_NE(module_l1_1, nullptr);
+		ASSERT_NE(module_l2, nullptr);
+		int set;
+		int way;
+		int tag;
+		Cache::BlockState state;
+
+		// Load from L1-0 misses, and brings the block in exclusive state
+		EXPECT_FALSE(module_l1_0->WarmAccess(Module::AccessLoad, 0x400));
+		EXPECT_TRUE(module_l1_0->FindBlock(0x400, set, way, tag, state));
+		EXPECT_EQ(Cache::BlockExclusive, state);
+		EXPECT_TRUE(module_l1_0->WarmAccess(Module::AccessLoad, 0x404));
+		ASSERT_TRUE(module_l2->FindBlock(0x400, set, way, tag, state));
+		EXPECT_TRUE(module_l2->isSharer(set, way, 0, module_l1_0));
+		EXPECT_EQ(module_l1_0, module_l2->getOwner(set, way, 0));
+
+		// Load from L1-1 makes both copies shared
+		EXPECT_FALSE(module_l1_1->WarmAccess(Module::AccessLoad, 0x400));
+		module_l1_0->FindBlock(0x400, set, way, tag, state);
+		EXPECT_EQ(Cache::BlockShared, state);
+		module_l1_1->FindBlock(0x400, set, way, tag, state);
+		EXPECT_EQ(Cache::BlockShared, state);
+		module_l2->FindBlock(0x400, set, way, tag, state);
+		EXPECT_EQ(2, module_l2->getNumSharers(set, way, 0));
+		EXPECT_EQ(nullptr, module_l2->getOwner(set, way, 0));
+
+		// Store from L1-1 invalidates the copy in L1-0
+		EXPECT_FALSE(module_l1_1->WarmAccess(Module::AccessStore, 0x400));
+		module_l1_1->FindBlock(0x400, set, way, tag, state);
+		EXPECT_EQ(Cache::BlockModified, state);
+		EXPECT_FALSE(module_l1_0->FindBlock(0x400, set, way, tag, state));
+		module_l2->FindBlock(0x400, set, way, tag, state);
+		EXPECT_EQ(1, module_l2->getNumSharers(set, way, 0));
+		EXPECT_EQ(module_l1_1, module_l2->getOwner(set, way, 0));
+
+		// Conflicting block in L1-1 evicts the dirty block into L2
+		EXPECT_FALSE(module_l1_1->WarmAccess(Module::AccessLoad, 0x500));
+		module_l2->FindBlock(0x400, set, way, tag, state);
+		EXPECT_EQ(Cache::BlockModified, state);
+		EXPECT_EQ(0, module_l2->getNumSharers(set, way, 0));
+		EXPECT_EQ(nullptr, module_l2->getOwner(set, way, 0));
+	}
+	catch (misc::Exception &e)
+	{
+		e.Dump();
+		FAIL();
+	}
+}
+
+
 } // Namespace mem
 
@@ -4093,6 +4093,81 @@ TEST(TestSystemEvents, config_0_store_1)
 }
 
 
+// l1_0, l2_0, and mm have address 0 in E, l2_0 has address 0x100 in E
+// l1_0 reads addresses 0, 0x100, and 0x1000 one after another, which are
+// supplied by l1_0, l2_0, and mm, respectively.
+TEST(TestSystemEvents, config_0_load_source_module)
+{
+	try
+	{
+		Cleanup();
+
+		// Load configuration files
+		misc::IniFile ini_file_mem;
+		misc::IniFile ini_file_x86;
+		misc::IniFile ini_file_net;
+		ini_file_mem.LoadFromString(mem_config_0);
+		ini_file_x86.LoadFromString(x86_config);
+		ini_file_net.LoadFromString(net_config);
+
+		// Set up x86 timing simulator
+		x86::Timing::ParseConfiguration(&ini_file_x86);
+		x86::Timing::getInstance();
+
+		// Set up network system
+		net::System *network_system = net::System::getInstance();
+		network_system->ParseConfiguration(&ini_file_net);
+
+		// Set up memory system
+		System *memory_system = System::getInstance();
+		memory_system->ReadConfiguration(&ini_file_mem);
+
+		// Get modules
+		Module *module_l1_0 = memory_system->getModule("mod-l1-0");
+		Module *module_l2_0 = memory_system->getModule("mod-l2-0");
+		Module *module_mm = memory_system->getModule("mod-mm");
+		ASSERT_NE(module_l1_0, nullptr);
+		ASSERT_NE(module_l2_0, nullptr);
+		ASSERT_NE(module_mm, nullptr);
+
+		// Set block states
+		module_l1_0->getCache()->getBlock(0, 0)->setStateTag(Cache::BlockExclusive, 0x0);
+		module_l2_0->getCache()->getBlock(0, 0)->setStateTag(Cache::BlockExclusive, 0x0);
+		module_l2_0->getCache()->getBlock(2, 0)->setStateTag(Cache::BlockExclusive, 0x100);
+		module_mm->getCache()->getBlock(0, 0)->setStateTag(Cache::BlockExclusive, 0x0);
+		module_l2_0->setOwner(0, 0, 0, module_l1_0);
+		module_l2_0->setSharer(0, 0, 0, module_l1_0);
+		module_mm->setOwner(0, 0, 0, module_l2_0);
+		module_mm->setSharer(0, 0, 0, module_l2_0);
+
+		// Accesses
+		esim::Engine *esim_engine = esim::Engine::getInstance();
+		unsigned addresses[3] = { 0x0, 0x100, 0x1000 };
+		Module *source_modules[3] = { module_l1_0, module_l2_0, module_mm };
+		for (int i = 0; i < 3; i++)
+		{
+			int witness = -1;
+			Module *source_module = nullptr;
+			module_l1_0->Access(Module::AccessLoad, addresses[i],
+					&witness, nullptr, &source_module);
+			EXPECT_EQ(source_module, module_l1_0);
+
+			// Simulation loop
+			while (witness < 0)
+				esim_engine->ProcessEvents();
+
+			// Check source module
+			EXPECT_EQ(source_module, source_modules[i]);
+		}
+	}
+	catch (misc::Exception &e)
+	{
+		e.Dump();
+		FAIL();
+	}
+}
+
+
 // l1_0, l2_0, l3_0, and mm have address 0 in E
 // Cycle 1 - l1_0 writes address 0 (block in l1_0 turns M)
 // Cycle 2 - l1_1 reads address 0x200 (conflict in l1_0 and l2_0, but not in l3)